@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Performance regression check of an OpenIFEM benchmark.
+
+The benchmark is run at the size of its test for a few time steps with the
+timing report and the solver log enabled. The maximum wall time over the
+ranks of every timer section and the total iterations of every solver are
+compared against a baseline:
+
+  measured time <= baseline time * (1 + time tolerance)
+  measured iterations <= baseline iterations * (1 + iteration tolerance)
+
+Sections that take less than the minimum time in the baseline are not
+checked, their timings are mostly noise.
+
+A baseline stores the rank count, the number of steps and the tolerances,
+which are used by the later checks. The timings are only meaningful on the
+machine they were recorded on, so they are recorded with --update on the
+nodes the check runs on. The iteration counts do not depend on the machine,
+baselines that only hold iterations are recorded with --update
+--iterations-only and can be committed to benchmarks/baselines.
+
+A missing baseline fails the check. With --allow-missing-baseline the check
+exits with code 77 instead, which CTest reports as skipped.
+"""
+
+import argparse
+import csv
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from run_scaling import edit_parameters  # noqa: E402
+
+SKIP = 77
+
+
+def measure(args, ranks, n_steps):
+    """Run the benchmark and return its timer sections and iterations."""
+    directory = os.path.join(args.output, args.benchmark)
+    if os.path.isdir(directory):
+        shutil.rmtree(directory)
+    os.makedirs(directory)
+    source = os.path.join(args.tests, args.benchmark, args.benchmark + '.prm')
+    with open(source) as f:
+        text, _ = edit_parameters(f.read(), 0, n_steps)
+    if re.search(r'set\s+Solver log', text):
+        text = re.sub(r'(set\s+Solver log\s*=\s*)\S+',
+                      lambda m: m.group(1) + 'true', text)
+    else:
+        text = re.sub(r'(subsection Simulation\n)',
+                      r'\1  set Solver log = true\n', text, count=1)
+    prm = os.path.join(directory, args.benchmark + '.prm')
+    with open(prm, 'w') as f:
+        f.write(text)
+
+    executable = os.path.join(args.bin, 'bench_' + args.benchmark)
+    command = args.mpirun.split() + ['-n', str(ranks), executable, prm]
+    print(' '.join(command), flush=True)
+    with open(os.path.join(directory, 'output.txt'), 'w') as log:
+        subprocess.run(command, cwd=directory, stdout=log,
+                       stderr=subprocess.STDOUT, check=True)
+
+    sections = {}
+    for filename in glob.glob(os.path.join(directory, 'timing-*.json')):
+        with open(filename) as f:
+            timer = json.load(f)
+        for name, section in timer['sections'].items():
+            sections['%s/%s' % (timer['name'], name)] = section['max']
+
+    iterations = {}
+    for filename in glob.glob(os.path.join(directory, '*_solver_log.csv')):
+        solver = os.path.basename(filename)[:-len('_solver_log.csv')]
+        with open(filename) as f:
+            for row in csv.DictReader(f):
+                for column, value in row.items():
+                    if column.endswith('_iterations') or \
+                       column == 'linear_solves':
+                        key = '%s/%s' % (solver, column)
+                        iterations[key] = iterations.get(key, 0) + int(value)
+    return sections, iterations
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('benchmark')
+    parser.add_argument('--baseline', required=True,
+                        help='baseline file of the benchmark')
+    parser.add_argument('--update', action='store_true',
+                        help='record the baseline instead of checking it')
+    parser.add_argument('--iterations-only', action='store_true',
+                        help='record the iterations but not the timings')
+    parser.add_argument('--allow-missing-baseline', action='store_true',
+                        help='skip instead of failing without a baseline')
+    parser.add_argument('--ranks', type=int, default=2,
+                        help='rank count of a recorded baseline')
+    parser.add_argument('--steps', type=int, default=5,
+                        help='number of time steps of a recorded baseline')
+    parser.add_argument('--time-tolerance', type=float, default=0.2)
+    parser.add_argument('--iteration-tolerance', type=float, default=0.1)
+    parser.add_argument('--minimum-time', type=float, default=0.1,
+                        help='sections shorter than this are not checked')
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--bin', required=True,
+                        help='directory of the bench_* executables')
+    parser.add_argument('--tests', required=True,
+                        help='directory of the test input files')
+    parser.add_argument('--output', default='performance')
+    args = parser.parse_args()
+
+    if args.update:
+        sections, iterations = measure(args, args.ranks, args.steps)
+        if args.iterations_only:
+            sections = {}
+        baseline = {'ranks': args.ranks,
+                    'steps': args.steps,
+                    'time_tolerance': args.time_tolerance,
+                    'iteration_tolerance': args.iteration_tolerance,
+                    'minimum_time': args.minimum_time,
+                    'sections': sections,
+                    'iterations': iterations}
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)),
+                    exist_ok=True)
+        with open(args.baseline, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+        print('Recorded %s' % args.baseline)
+        return 0
+
+    if not os.path.isfile(args.baseline):
+        print('No baseline %s, record it with --update.' % args.baseline)
+        return SKIP if args.allow_missing_baseline else 1
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    sections, iterations = measure(args, baseline['ranks'], baseline['steps'])
+
+    failures = []
+    print('%-60s %10s %10s %8s' % ('section', 'baseline', 'measured',
+                                   'ratio'))
+    for name, reference in sorted(baseline['sections'].items()):
+        if reference < baseline['minimum_time']:
+            continue
+        if name not in sections:
+            failures.append('%s is missing' % name)
+            continue
+        ratio = sections[name] / reference
+        print('%-60s %10.3f %10.3f %8.2f' %
+              (name, reference, sections[name], ratio))
+        if ratio > 1 + baseline['time_tolerance']:
+            failures.append('%s took %.3f s instead of %.3f s' %
+                            (name, sections[name], reference))
+    for name, reference in sorted(baseline['iterations'].items()):
+        if name not in iterations:
+            failures.append('%s is missing' % name)
+            continue
+        print('%-60s %10d %10d' % (name, reference, iterations[name]))
+        limit = reference * (1 + baseline['iteration_tolerance'])
+        if iterations[name] > limit:
+            failures.append('%s is %d instead of %d' %
+                            (name, iterations[name], reference))
+
+    for failure in failures:
+        print('FAILED: ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
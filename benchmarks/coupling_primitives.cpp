@@ -0,0 +1,327 @@
+/**
+ * Microbenchmarks of the primitives that dominate the FSI coupling:
+ * GridInterpolator, BatchedGridInterpolator, CellLocator::search,
+ * SPHInterpolator and the inside tests behind FSI::point_in_solid, which are
+ * BoundaryCrossingIndex in 2D and CellBucketGrid in 3D.
+ *
+ * A fluid box with a Q2-Q1 element and a smaller solid box with a Q1 element
+ * are built, like fsi_leaflet. The query points are random points in the
+ * solid box. The hint of a point is the cell that contains it, moved by a
+ * random walk of the given number of steps through the cell neighbors, so
+ * hint distance 0 is a perfect hint; a negative distance uses
+ * begin_active(), which is what the solvers pass when they have no hint.
+ *
+ * The wall time and the number of heap allocations per query are reported.
+ *
+ * Usage:
+ *   bench_coupling_primitives [dim] [refinements] [queries] [hint distance]
+ * where dim 0 runs both dimensions.
+ */
+#include "utilities.h"
+
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/grid/grid_generator.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+
+namespace
+{
+  // The number of heap allocations since the start of the program.
+  std::atomic<std::size_t> n_allocations(0);
+} // namespace
+
+void *operator new(std::size_t size)
+{
+  ++n_allocations;
+  if (void *p = std::malloc(size ? size : 1))
+    {
+      return p;
+    }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+using namespace dealii;
+
+/// Run a function over n queries and report the cost per query.
+template <typename Function>
+void measure(const std::string &name, const unsigned int n, Function &&f)
+{
+  const std::size_t allocations = n_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns =
+    std::chrono::duration<double, std::nano>(stop - start).count();
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1) << ns / n
+            << " ns/query" << std::setw(10) << std::setprecision(2)
+            << static_cast<double>(n_allocations - allocations) / n
+            << " allocs/query" << std::endl;
+}
+
+template <int dim>
+void run(const unsigned int refinements,
+         const unsigned int n_queries,
+         const int hint_distance)
+{
+  // The fluid box is [0, 4] x [0, 1] (x [0, 1]), the solid box is in the
+  // middle of it, as in fsi_leaflet.
+  Point<dim> fluid_lower, fluid_upper, solid_lower, solid_upper;
+  std::vector<unsigned int> fluid_subdivisions(dim, 4),
+    solid_subdivisions(dim, 2);
+  for (unsigned int d = 0; d < dim; ++d)
+    {
+      fluid_upper[d] = 1.0;
+      solid_lower[d] = 0.3;
+      solid_upper[d] = 0.7;
+    }
+  fluid_upper[0] = 4.0;
+  fluid_subdivisions[0] = 16;
+  solid_lower[0] = 1.0;
+  solid_upper[0] = 1.2;
+  solid_subdivisions[1] = 4;
+
+  Triangulation<dim> fluid_tria, solid_tria;
+  GridGenerator::subdivided_hyper_rectangle(
+    fluid_tria, fluid_subdivisions, fluid_lower, fluid_upper);
+  GridGenerator::subdivided_hyper_rectangle(
+    solid_tria, solid_subdivisions, solid_lower, solid_upper);
+  fluid_tria.refine_global(refinements);
+  solid_tria.refine_global(refinements + 1);
+
+  FESystem<dim> fluid_fe(FE_Q<dim>(2), dim, FE_Q<dim>(1), 1);
+  FESystem<dim> solid_fe(FE_Q<dim>(1), dim);
+  DoFHandler<dim> fluid_dh(fluid_tria), solid_dh(solid_tria);
+  fluid_dh.distribute_dofs(fluid_fe);
+  solid_dh.distribute_dofs(solid_fe);
+
+  Vector<double> fluid_solution(fluid_dh.n_dofs()),
+    solid_solution(solid_dh.n_dofs());
+  for (unsigned int i = 0; i < fluid_solution.size(); ++i)
+    fluid_solution[i] = std::sin(1e-3 * i);
+  for (unsigned int i = 0; i < solid_solution.size(); ++i)
+    solid_solution[i] = std::cos(1e-3 * i);
+
+  std::cout << dim << "D: " << fluid_tria.n_active_cells()
+            << " fluid cells, " << solid_tria.n_active_cells()
+            << " solid cells, " << n_queries << " queries, hint distance "
+            << hint_distance << std::endl;
+
+  // The query points and their hints.
+  std::mt19937 generator(2019);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<Point<dim>> points(n_queries);
+  for (auto &p : points)
+    {
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] = solid_lower[d] + unit(generator) * (solid_upper[d] -
+                                                   solid_lower[d]);
+    }
+  Utils::CellBucketGrid<dim> fluid_cells;
+  fluid_cells.reinit(fluid_dh);
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> hints(
+    n_queries, fluid_dh.begin_active());
+  if (hint_distance >= 0)
+    {
+      std::uniform_int_distribution<unsigned int> face(
+        0, GeometryInfo<dim>::faces_per_cell - 1);
+      for (unsigned int i = 0; i < n_queries; ++i)
+        {
+          auto cell = fluid_cells.find_cell(points[i]);
+          Assert(cell.state() == IteratorState::valid, ExcInternalError());
+          // The meshes are uniform, so the neighbors are active.
+          for (int step = 0; step < hint_distance;)
+            {
+              const unsigned int f = face(generator);
+              if (!cell->at_boundary(f))
+                {
+                  cell = cell->neighbor(f);
+                  ++step;
+                }
+            }
+          hints[i] = cell;
+        }
+    }
+
+  Vector<double> value(dim + 1);
+  double checksum = 0;
+
+  measure("GridInterpolator", n_queries, [&]() {
+    for (const auto &p : points)
+      {
+        Utils::GridInterpolator<dim, Vector<double>> interpolator(fluid_dh, p);
+        interpolator.point_value(fluid_solution, value);
+        checksum += value[0];
+      }
+  });
+
+  Utils::CellLocator<dim, DoFHandler<dim>> locator(fluid_dh);
+  measure("CellLocator::search", n_queries, [&]() {
+    for (unsigned int i = 0; i < n_queries; ++i)
+      {
+        checksum += locator.search(points[i], hints[i])->active_cell_index();
+      }
+  });
+
+  measure("CellLocator + GridInterpolator", n_queries, [&]() {
+    for (unsigned int i = 0; i < n_queries; ++i)
+      {
+        const auto cell = locator.search(points[i], hints[i]);
+        Utils::GridInterpolator<dim, Vector<double>> interpolator(
+          fluid_dh, points[i], {}, cell);
+        interpolator.point_value(fluid_solution, value);
+        checksum += value[0];
+      }
+  });
+
+  Utils::BatchedGridInterpolator<dim, Vector<double>> batched(fluid_dh);
+  std::vector<std::vector<Vector<double>>> values;
+  measure("BatchedGridInterpolator", n_queries, [&]() {
+    batched.reinit(points);
+    batched.point_values({&fluid_solution}, values);
+    checksum += values[0][0][0];
+  });
+
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells(
+    n_queries);
+  for (unsigned int i = 0; i < n_queries; ++i)
+    cells[i] = locator.search(points[i], hints[i]);
+  measure("BatchedGridInterpolator (located)", n_queries, [&]() {
+    batched.reinit(points, cells);
+    batched.point_values({&fluid_solution}, values);
+    checksum += values[0][0][0];
+  });
+
+  // Looping over all the solid cells is expensive, only a few points
+  // are used.
+  const unsigned int n_sph = std::min(n_queries, 1000u);
+  Vector<double> solid_value(dim);
+  measure("SPHInterpolator", n_sph, [&]() {
+    for (unsigned int i = 0; i < n_sph; ++i)
+      {
+        Utils::SPHInterpolator<dim, Vector<double>> interpolator(solid_dh,
+                                                                 points[i]);
+        interpolator.point_value(solid_solution, solid_value);
+        checksum += solid_value[0];
+      }
+  });
+
+  Utils::CellCenterHash<dim> solid_hash;
+  solid_hash.reinit(solid_dh);
+  measure("SPHInterpolator (hashed)", n_queries, [&]() {
+    for (const auto &p : points)
+      {
+        Utils::SPHInterpolator<dim, Vector<double>> interpolator(
+          solid_dh, p, solid_hash);
+        interpolator.point_value(solid_solution, solid_value);
+        checksum += solid_value[0];
+      }
+  });
+
+  // The inside test of FSI::point_in_solid, queried at points in and
+  // around the solid.
+  std::vector<Point<dim>> fluid_points(n_queries);
+  for (auto &p : fluid_points)
+    {
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] = 1.5 * solid_lower[d] - 0.5 * solid_upper[d] +
+               2 * unit(generator) * (solid_upper[d] - solid_lower[d]);
+    }
+  unsigned int n_inside = 0;
+  if (dim == 2)
+    {
+      std::list<typename Triangulation<dim>::face_iterator> faces;
+      for (auto cell = solid_tria.begin_active(); cell != solid_tria.end();
+           ++cell)
+        {
+          for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+               ++f)
+            {
+              if (cell->face(f)->at_boundary())
+                faces.push_back(cell->face(f));
+            }
+        }
+      Utils::BoundaryCrossingIndex<dim> boundary_index;
+      boundary_index.reinit(faces);
+      measure("point_in_solid (BoundaryCrossingIndex)", n_queries, [&]() {
+        for (const auto &p : fluid_points)
+          n_inside += boundary_index.point_inside(p);
+      });
+    }
+  else
+    {
+      Utils::CellBucketGrid<dim> solid_cells;
+      solid_cells.reinit(solid_dh);
+      measure("point_in_solid (CellBucketGrid)", n_queries, [&]() {
+        for (const auto &p : fluid_points)
+          n_inside += solid_cells.point_inside(p);
+      });
+    }
+
+  // Printed so that the work is not optimized away.
+  std::cout << "checksum " << std::scientific << checksum << ", "
+            << n_inside << " points inside" << std::endl
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+      const int dim = argc > 1 ? std::stoi(argv[1]) : 0;
+      const unsigned int refinements = argc > 2 ? std::stoi(argv[2]) : 3;
+      const unsigned int n_queries = argc > 3 ? std::stoi(argv[3]) : 100000;
+      const int hint_distance = argc > 4 ? std::stoi(argv[4]) : 1;
+      AssertThrow(dim == 0 || dim == 2 || dim == 3,
+                  ExcMessage("The dimension must be 2 or 3!"));
+      AssertThrow(n_queries > 0, ExcMessage("There must be some queries!"));
+
+      // If both dimensions are run, the 3D mesh is refined once less.
+      if (dim != 3)
+        run<2>(refinements, n_queries, hint_distance);
+      if (dim != 2)
+        run<3>(dim == 0 && refinements > 0 ? refinements - 1 : refinements,
+               n_queries,
+               hint_distance);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Place the marked OpenIFEM kernels on a roofline.
+
+Build with -DOPENIFEM_WITH_likwid=ON and measure the flops and the memory
+traffic of the kernels with the MEM_DP group, writing CSV:
+
+  likwid-perfctr -C S0:0 -g MEM_DP -m -O -o kernels.csv bench_<test> <prm>
+
+(likwid-mpirun -g MEM_DP -m -O for the MPI runs, one file per rank). This
+script reads the files, adds the flops, the bytes and the time of every
+region over the threads and the files, and prints the operational intensity
+of every kernel, its attainable performance
+
+  min(peak flops, intensity * bandwidth)
+
+and the fraction of it that is reached. The bandwidth and the peak are
+measured with likwid-bench on the same node unless they are given.
+"""
+
+import argparse
+import collections
+import re
+import subprocess
+import sys
+
+
+def number(text):
+    try:
+        return float(text)
+    except ValueError:
+        return None
+
+
+def read_regions(filenames):
+    """Return the runtime, flops and bytes of every region."""
+    regions = collections.defaultdict(collections.Counter)
+    for filename in filenames:
+        # The metrics of every region of the file. The STAT table, whose
+        # first column is the sum over the threads, replaces the sum of the
+        # columns of the plain table when there is one.
+        tables = collections.defaultdict(dict)
+        region, stat = None, False
+        with open(filename) as f:
+            for line in f:
+                fields = [x.strip() for x in line.rstrip('\n').split(',')]
+                if fields[0] == 'TABLE':
+                    match = re.match(r'Region (\S+)', fields[1])
+                    is_metric = len(fields) > 2 and 'Metric' in fields[2]
+                    region = match.group(1) if match and is_metric else None
+                    stat = is_metric and 'STAT' in fields[2]
+                    continue
+                if region is None or fields[0] in ('Metric', ''):
+                    continue
+                values = [v for v in map(number, fields[1:]) if v is not None]
+                if values and (stat or fields[0] not in tables[region]):
+                    tables[region][fields[0]] = \
+                        values[0] if stat else sum(values)
+
+        for name, metrics in tables.items():
+            def metric(pattern):
+                for m, v in metrics.items():
+                    if re.match(pattern, m):
+                        return v
+                return 0.0
+            # The kernels run on one thread per process, so the thread time
+            # is the time of the kernel.
+            runtime = metric(r'Runtime \(RDTSC\) \[s\]')
+            mflops = metric(r'DP \[?MFLOP/s')
+            bandwidth = metric(r'Memory bandwidth \[MBytes/s\]')
+            volume = metric(r'Memory data volume \[GBytes\]')
+            regions[name]['runtime'] += runtime
+            regions[name]['flops'] += mflops * 1e6 * runtime
+            regions[name]['bytes'] += (volume * 1e9 if volume else
+                                       bandwidth * 1e6 * runtime)
+    return regions
+
+
+def likwid_bench(test, workgroup, pattern):
+    output = subprocess.run(['likwid-bench', '-t', test, '-w', workgroup],
+                            stdout=subprocess.PIPE, universal_newlines=True,
+                            check=True).stdout
+    match = re.search(pattern + r':\s*([\d.]+)', output)
+    if not match:
+        raise RuntimeError('Cannot read the output of likwid-bench!')
+    return float(match.group(1))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('files', nargs='+',
+                        help='likwid-perfctr CSV output of the MEM_DP group')
+    parser.add_argument('--bandwidth', type=float,
+                        help='memory bandwidth in GB/s, measured by default')
+    parser.add_argument('--peak', type=float,
+                        help='peak GFLOP/s, measured by default')
+    parser.add_argument('--bandwidth-test', default='load',
+                        help='likwid-bench test of the bandwidth')
+    parser.add_argument('--peak-test', default='peakflops',
+                        help='likwid-bench test of the peak')
+    parser.add_argument('--workgroup', default='S0:1GB:1',
+                        help='likwid-bench workgroup of the bandwidth')
+    args = parser.parse_args()
+
+    # The kernels run on one thread per process, so are the ceilings.
+    bandwidth = args.bandwidth
+    if bandwidth is None:
+        bandwidth = likwid_bench(args.bandwidth_test, args.workgroup,
+                                 r'MByte/s') / 1e3
+    peak = args.peak
+    if peak is None:
+        peak = likwid_bench(args.peak_test, 'S0:32kB:1', r'MFlops/s') / 1e3
+    ridge = peak / bandwidth
+    print('Bandwidth %.2f GB/s, peak %.2f GFLOP/s, ridge point %.3f '
+          'FLOP/byte' % (bandwidth, peak, ridge))
+
+    regions = read_regions(args.files)
+    if not regions:
+        print('No marker regions found!')
+        return 1
+    print('%-28s %10s %10s %10s %10s %12s %8s %8s' %
+          ('kernel', 'time [s]', 'GFLOP/s', 'GB/s', 'FLOP/byte',
+           'roof GFLOP/s', 'fraction', 'bound'))
+    for name, r in sorted(regions.items(), key=lambda x: -x[1]['runtime']):
+        if r['runtime'] <= 0:
+            continue
+        gflops = r['flops'] / r['runtime'] / 1e9
+        gbytes = r['bytes'] / r['runtime'] / 1e9
+        intensity = r['flops'] / r['bytes'] if r['bytes'] else float('inf')
+        roof = min(peak, intensity * bandwidth)
+        print('%-28s %10.3f %10.3f %10.3f %10.3f %12.3f %8.2f %8s' %
+              (name, r['runtime'], gflops, gbytes, intensity, roof,
+               gflops / roof, 'memory' if intensity < ridge else 'compute'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Strong and weak scaling sweeps of the OpenIFEM benchmarks.
+
+Every benchmark is one of the MPI tests built without its reference checks.
+The input file of the test is copied into a run directory with the global
+refinements raised, the timing report enabled and, optionally, the number of
+time steps limited, and the executable is run with mpirun for every rank
+count.
+
+In a strong scaling sweep the refinement is fixed. In a weak scaling sweep
+it is raised by one, which multiplies the cells by 2^dim, every time the
+rank count is multiplied by 2^dim, so the load per rank stays (roughly)
+constant; the rank counts should be powers of 2^dim times the smallest one.
+
+The number of degrees of freedom is read from the output of the solvers and
+the number of steps from timing_steps.csv. The throughput is
+dofs * steps / wall time; the parallel efficiency is relative to the smallest
+rank count. A summary is printed and written to <output>/<benchmark>.json
+together with the timing-*.json files of every run.
+"""
+
+import argparse
+import csv
+import glob
+import json
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+
+def edit_parameters(text, refinement_offset, n_steps):
+    """Return the input file with the benchmark settings applied."""
+
+    def raise_refinements(match):
+        levels = [int(x) + refinement_offset for x in match.group(2).split(',')]
+        return match.group(1) + ', '.join(str(x) for x in levels)
+
+    text, n = re.subn(r'(set\s+Global refinements\s*=\s*)([\d,\s]*\d)',
+                      raise_refinements, text)
+    if n != 1:
+        raise RuntimeError('Cannot find the global refinements!')
+
+    time_step = float(re.search(r'set\s+Time step size\s*=\s*(\S+)',
+                                text).group(1))
+    if n_steps is not None:
+        text = re.sub(r'(set\s+End time\s*=\s*)\S+',
+                      lambda m: m.group(1) + repr(n_steps * time_step), text)
+    end_time = float(re.search(r'set\s+End time\s*=\s*(\S+)', text).group(1))
+    # Neither output nor checkpoints are part of the measurement.
+    for entry in ('Output interval', 'Save interval'):
+        text = re.sub(r'(set\s+%s\s*=\s*)\S+' % entry,
+                      lambda m: m.group(1) + repr(2 * end_time), text)
+    if re.search(r'set\s+Timing report', text):
+        text = re.sub(r'(set\s+Timing report\s*=\s*)\S+',
+                      lambda m: m.group(1) + 'true', text)
+    else:
+        text = re.sub(r'(subsection Simulation\n)',
+                      r'\1  set Timing report = true\n', text, count=1)
+    return text, int(round(end_time / time_step))
+
+
+def run(args, benchmark, ranks, refinement_offset):
+    directory = os.path.join(args.output, benchmark,
+                             'n%d_r%d' % (ranks, refinement_offset))
+    if os.path.isdir(directory):
+        shutil.rmtree(directory)
+    os.makedirs(directory)
+    source = os.path.join(args.tests, benchmark, benchmark + '.prm')
+    with open(source) as f:
+        text, n_steps = edit_parameters(f.read(), refinement_offset,
+                                        args.steps)
+    prm = os.path.join(directory, benchmark + '.prm')
+    with open(prm, 'w') as f:
+        f.write(text)
+
+    executable = os.path.join(args.bin, 'bench_' + benchmark)
+    command = args.mpirun.split() + ['-n', str(ranks), executable, prm]
+    print('  ' + ' '.join(command), flush=True)
+    start = time.time()
+    with open(os.path.join(directory, 'output.txt'), 'w') as log:
+        subprocess.run(command, cwd=directory, stdout=log,
+                       stderr=subprocess.STDOUT, check=True)
+    wall_time = time.time() - start
+
+    with open(os.path.join(directory, 'output.txt')) as log:
+        # The solvers print their sizes after every setup, the last one of
+        # each solver is the one that ran. The fluid indents the line by
+        # three spaces and the solid by two.
+        dofs = {}
+        for line in log:
+            match = re.search(r'Number of degrees of freedom:\s*(\d+)', line)
+            if match:
+                dofs[line.startswith('   ')] = int(match.group(1))
+    n_dofs = sum(dofs.values())
+
+    steps = set()
+    steps_file = os.path.join(directory, 'timing_steps.csv')
+    if os.path.isfile(steps_file):
+        with open(steps_file) as f:
+            steps = {row['timestep'] for row in csv.DictReader(f)}
+    n_steps = len(steps) if steps else n_steps
+
+    timers = {}
+    for filename in glob.glob(os.path.join(directory, 'timing-*.json')):
+        with open(filename) as f:
+            timer = json.load(f)
+        timers[timer['name']] = timer['sections']
+
+    return {'ranks': ranks,
+            'refinement_offset': refinement_offset,
+            'dofs': n_dofs,
+            'steps': n_steps,
+            'wall_time': wall_time,
+            'throughput': n_dofs * n_steps / wall_time,
+            'timers': timers}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('mode', choices=['strong', 'weak'])
+    parser.add_argument('benchmarks', nargs='+')
+    parser.add_argument('--ranks', default='1,2,4,8',
+                        help='comma separated rank counts')
+    parser.add_argument('--refinement', type=int, default=1,
+                        help='refinements added at the smallest rank count')
+    parser.add_argument('--dimension', type=int, default=2,
+                        help='dimension of the benchmarks, for weak scaling')
+    parser.add_argument('--steps', type=int, default=None,
+                        help='number of time steps, the input file by default')
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--bin', required=True,
+                        help='directory of the bench_* executables')
+    parser.add_argument('--tests', required=True,
+                        help='directory of the test input files')
+    parser.add_argument('--output', default='scaling')
+    args = parser.parse_args()
+
+    ranks = sorted(int(x) for x in args.ranks.split(','))
+    for benchmark in args.benchmarks:
+        print('%s scaling of %s' % (args.mode, benchmark), flush=True)
+        results = []
+        for n in ranks:
+            offset = args.refinement
+            if args.mode == 'weak':
+                offset += int(round(math.log(n / ranks[0], 2) /
+                                    args.dimension))
+            results.append(run(args, benchmark, n, offset))
+
+        base = results[0]
+        print('%8s %6s %12s %6s %10s %14s %10s' %
+              ('ranks', 'refine', 'dofs', 'steps', 'wall [s]',
+               'dofs*steps/s', 'efficiency'))
+        for r in results:
+            # Strong: speedup over the ideal one. Weak: throughput per rank
+            # relative to the smallest run, which also holds when the load
+            # per rank is not exactly constant.
+            if args.mode == 'strong':
+                r['efficiency'] = (base['wall_time'] * base['ranks'] /
+                                   (r['wall_time'] * r['ranks']))
+            else:
+                r['efficiency'] = ((r['throughput'] / r['ranks']) /
+                                   (base['throughput'] / base['ranks']))
+            print('%8d %6d %12d %6d %10.3f %14.4g %10.3f' %
+                  (r['ranks'], r['refinement_offset'], r['dofs'], r['steps'],
+                   r['wall_time'], r['throughput'], r['efficiency']))
+        with open(os.path.join(args.output, benchmark + '.json'), 'w') as f:
+            json.dump({'mode': args.mode, 'runs': results}, f, indent=2)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
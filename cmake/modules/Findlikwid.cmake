@@ -0,0 +1,29 @@
+# A very simple script to find likwid
+#
+# This moudle exports:
+#   likwid_FOUND
+#   likwid_LIBRARY
+#   likwid_INCLUDE_DIR
+#
+message("Trying to find likwid..")
+
+set(likwid_SEARCH_PATHS
+    /usr/local
+    /usr
+    /opt/local
+    /opt
+    ${likwid_DIR})
+
+find_library(likwid_LIBRARY
+  NAMES likwid
+  HINTS ${likwid_DIR}
+  PATH_SUFFIXES lib
+  PATHS ${likwid_SEARCH_PATHS})
+
+find_path(likwid_INCLUDE_DIR likwid-marker.h
+  HINTS ${likwid_DIR}
+  PATH_SUFFIXES include
+  PATHS ${likwid_SEARCH_PATHS})
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(likwid REQUIRED_VARS likwid_LIBRARY likwid_INCLUDE_DIR)
@@ -8,6 +8,7 @@
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/lac/affine_constraints.h>
 #include <deal.II/lac/block_sparse_matrix.h>
@@ -78,7 +79,7 @@ namespace Fluid
     virtual void run() = 0;
 
     //! Destructor
-    ~FluidSolver() { timer.print_summary(); }
+    ~FluidSolver() { Utils::TimingReport::instance().remove(timer); }
 
     //! Return the solution for testing.
     BlockVector<double> get_current_solution() const;
@@ -104,15 +105,51 @@ namespace Fluid
     /// the dofs and constraints.
     virtual void initialize_system();
 
+    /// Compute the approximate Schur complement \f$B diag(M_u)^{-1}B^T\f$
+    /// into mass_schur. It depends on neither the solution nor the time step,
+    /// so it is only recomputed after the mesh or the constrained dofs have
+    /// changed. Return whether it was recomputed.
+    bool update_mass_schur();
+
     /// Mesh adaption.
     void refine_mesh(const unsigned int, const unsigned int);
 
     /// Output in vtu format.
     void output_results(const unsigned int) const;
 
+    /// Record the present solution in the steady state monitor. Once the run
+    /// is steady, write the final output if it has not been written at this
+    /// step and return true.
+    bool reached_steady_state();
+
     /// Update stress to output
     virtual void update_stress();
 
+    /// The largest CFL number of the present solution over the cells,
+    /// with the cell size taken as the minimum vertex distance divided by
+    /// the velocity degree.
+    double compute_cfl();
+
+    /// Choose the size of the next time step from the CFL number and the
+    /// Newton iterations of the last one, only in Fluid simulations and if
+    /// told so in the input file.
+    void adapt_time_step(const unsigned int newton_iterations);
+
+    /// Prepare the time derivative of the step that has just begun, see the
+    /// parallel FluidSolver. Must be called after time.increment().
+    void update_time_history();
+
+    /// The solution the time derivative of the step is taken from.
+    const BlockVector<double> &time_history() const;
+
+    /// The step size the time derivative is divided by, which also scales
+    /// the mass in the matrix and in the preconditioners.
+    double effective_delta_t() const;
+
+    /// Keep the present solution as the previous one before it is
+    /// replaced by the solution of the step, only with BDF2.
+    void record_previous_solution();
+
     std::vector<types::global_dof_index> dofs_per_block;
 
     Triangulation<dim> &triangulation;
@@ -131,12 +168,26 @@ namespace Fluid
     BlockSparseMatrix<double> mass_matrix;
     SparsityPattern mass_schur_pattern;
     SparseMatrix<double> mass_schur;
+    /// Set when the mesh changes, so that mass_schur is recomputed.
+    bool mass_schur_outdated = true;
+    /// The dofs constrained by zero_constraints when mass_schur was
+    /// computed.
+    IndexSet mass_schur_constraints;
 
     /// The latest known solution.
     BlockVector<double> present_solution;
     BlockVector<double> solution_increment;
     BlockVector<double> system_rhs;
 
+    /// The solution of the step before present_solution and the size of the
+    /// step between them, only kept with BDF2 and transferred along with
+    /// present_solution. A previous_delta_t of 0 means there is none.
+    BlockVector<double> previous_solution;
+    double previous_delta_t = 0;
+
+    /// The history of the BDF2 time derivative, see update_time_history().
+    BlockVector<double> bdf2_history;
+
     /**
      * Nodal strain and stress obtained by taking the average of surrounding
      * cell-averaged strains and stresses. Their sizes are
@@ -150,6 +201,25 @@ namespace Fluid
 
     Parameters::AllParameters parameters;
 
+    /// The policy of reusing the block preconditioner across linear solves.
+    Utils::PreconditionerReuse preconditioner_reuse;
+
+    /// The per-cell FE data of the assembly, only stored if told so in the
+    /// input file, otherwise computed cell by cell.
+    Utils::CellFEDataCache<dim> cell_fe_data;
+
+    /// The policy of the adaptive time step size.
+    Utils::TimeStepController time_step_controller;
+
+    /// The initial guesses of the time steps.
+    Utils::SolutionPredictor<BlockVector<double>> solution_predictor;
+
+    /// The fields and region to write.
+    Utils::OutputControl output_control;
+
+    /// Stops the standalone run at a steady state.
+    Utils::SteadyStateMonitor<BlockVector<double>> steady_state;
+
     CellDataStorage<typename Triangulation<dim>::active_cell_iterator,
                     CellProperty>
       cell_property;
@@ -2,6 +2,8 @@
 #define FSI_H
 
 #include <deal.II/base/table_indices.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/physics/elasticity/standard_tensors.h>
 
 #include "fluid_solver.h"
@@ -18,8 +20,18 @@ extern template class Utils::GridInterpolator<2, Vector<double>>;
 extern template class Utils::GridInterpolator<3, Vector<double>>;
 extern template class Utils::GridInterpolator<2, BlockVector<double>>;
 extern template class Utils::GridInterpolator<3, BlockVector<double>>;
+extern template class Utils::BatchedGridInterpolator<2, BlockVector<double>>;
+extern template class Utils::BatchedGridInterpolator<3, BlockVector<double>>;
+extern template class Utils::CellCenterHash<2>;
+extern template class Utils::CellCenterHash<3>;
 extern template class Utils::SPHInterpolator<2, Vector<double>>;
 extern template class Utils::SPHInterpolator<3, Vector<double>>;
+extern template class Utils::BoundaryCrossingIndex<2>;
+extern template class Utils::BoundaryCrossingIndex<3>;
+extern template class Utils::CellBucketGrid<2>;
+extern template class Utils::CellBucketGrid<3>;
+extern template class Utils::CellLocator<2, DoFHandler<2, 2>>;
+extern template class Utils::CellLocator<3, DoFHandler<3, 3>>;
 
 template <int dim>
 class FSI
@@ -33,9 +45,16 @@ public:
   ~FSI();
 
 private:
-  /// Define a smallest rectangle (or hex in 3d) that contains the solid.
+  /// Collect all the boundary lines in solid triangulation.
+  void collect_solid_boundaries();
+
+  /// Define a smallest rectangle (or hex in 3d) that contains the solid,
+  /// and rebuild the spatial indices of the solid.
   void update_solid_box();
 
+  /// Reset the solid cell hints of every fluid cell.
+  void setup_cell_hints();
+
   /// Check if a point is inside a mesh.
   bool point_in_solid(const DoFHandler<dim> &, const Point<dim> &);
 
@@ -87,6 +106,11 @@ private:
   /// Mesh adaption.
   void refine_mesh(const unsigned int, const unsigned int);
 
+  /// Record the fluid and solid solutions in their steady state monitors.
+  /// Once both are steady, write the final output of the solvers if it has
+  /// not been written at this step and return true.
+  bool reached_steady_state();
+
   Fluid::FluidSolver<dim> &fluid_solver;
   Solid::SolidSolver<dim> &solid_solver;
   Parameters::AllParameters parameters;
@@ -97,6 +121,37 @@ private:
   // The point stored is in the order of:
   // (x_min, x_max, y_min, y_max, z_min, z_max)
   Vector<double> solid_box;
+
+  // This vector collects the solid boundaries for the ray-crossing test.
+  std::list<typename Triangulation<dim>::face_iterator> solid_boundaries;
+
+  // Spatial index of solid_boundaries in the current configuration.
+  Utils::BoundaryCrossingIndex<dim> boundary_index;
+
+  // Spatial index of the solid cells in the current configuration, which
+  // is queried by point_in_solid in 3D.
+  Utils::CellBucketGrid<dim> solid_cell_index;
+
+  // The solid cells that the support points of every fluid cell were last
+  // found in, the last hint of a cell is for its center. The first solid
+  // cell means no hint.
+  CellDataStorage<typename Triangulation<dim>::active_cell_iterator,
+                  typename DoFHandler<dim>::active_cell_iterator>
+    cell_hints;
+
+  // The BFS locator that searches for the solid cells from cell_hints, and
+  // its copies for the threads in find_fluid_bc.
+  Utils::CellLocator<dim, DoFHandler<dim>> solid_locator;
+  Threads::ThreadLocalStorage<Utils::CellLocator<dim, DoFHandler<dim>>>
+    thread_locators;
+
+  // The fluid cell that every solid boundary face center of find_solid_bc
+  // was last found in, or an invalid iterator, and the BFS locator that
+  // searches from them.
+  std::vector<typename DoFHandler<dim>::active_cell_iterator>
+    solid_boundary_hints;
+  Utils::CellLocator<dim, DoFHandler<dim>> fluid_locator;
+
   bool use_dirichlet_bc;
 };
 
@@ -1,6 +1,7 @@
 #ifndef HYPO_ELASTICITY
 #define HYPO_ELASTICITY
 
+#include <array>
 #include <memory>
 
 #include <deal.II/base/symmetric_tensor.h>
@@ -84,6 +85,16 @@ namespace Solid
 
     std::vector<int> vertex_mapping;
 
+    /// The dofs of every particle, built with the particles.
+    std::vector<std::array<types::global_dof_index, dim>> particle_dofs;
+
+    /**
+     * The cell property of every boundary face in the order of the face
+     * quadrature points, which holds the FSI traction to push.
+     */
+    std::vector<std::shared_ptr<typename SolidSolver<dim>::CellProperty>>
+      face_properties;
+
     void construct_particles();
 
     void synchronize();
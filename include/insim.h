@@ -27,6 +27,9 @@ namespace Fluid
    * to solve the nonlinear system, thus the actual dofs being solved is the
    * velocity and pressure increment.
    *
+   * The time derivative is backward Euler or, if told so in the input file,
+   * the variable-step BDF2.
+   *
    * The final linear system to be solved is nonsymmetric. GMRES solver with
    * Grad-Div right preconditioner is applied, which does modify the linear
    * system
@@ -74,10 +77,19 @@ namespace Fluid
     using FluidSolver<dim>::mass_matrix;
     using FluidSolver<dim>::mass_schur_pattern;
     using FluidSolver<dim>::mass_schur;
+    using FluidSolver<dim>::update_mass_schur;
     using FluidSolver<dim>::present_solution;
+    using FluidSolver<dim>::update_time_history;
+    using FluidSolver<dim>::time_history;
+    using FluidSolver<dim>::effective_delta_t;
+    using FluidSolver<dim>::record_previous_solution;
     using FluidSolver<dim>::solution_increment;
     using FluidSolver<dim>::system_rhs;
     using FluidSolver<dim>::time;
+    using FluidSolver<dim>::preconditioner_reuse;
+    using FluidSolver<dim>::cell_fe_data;
+    using FluidSolver<dim>::adapt_time_step;
+    using FluidSolver<dim>::solution_predictor;
     using FluidSolver<dim>::timer;
     using FluidSolver<dim>::parameters;
     using FluidSolver<dim>::cell_property;
@@ -90,7 +102,7 @@ namespace Fluid
 
     /*! \brief Assemble the system matrix, mass mass matrix, and the RHS.
      *
-     *  Since backward Euler method is used, the linear system must be
+     *  Since an implicit method is used, the linear system must be
      * reassembled
      *  at every Newton iteration. The Dirichlet BCs are applied at the same
      * time
@@ -180,7 +192,7 @@ namespace Fluid
                                double dt,
                                const BlockSparseMatrix<double> &system,
                                const BlockSparseMatrix<double> &mass,
-                               SparseMatrix<double> &schur);
+                               const SparseMatrix<double> &schur);
 
       /// The matrix-vector multiplication must be defined.
       void vmult(BlockVector<double> &dst,
@@ -209,7 +221,7 @@ namespace Fluid
        * Based on my tests, the first approach is more than 10 times faster so I
        * go with this route.
        */
-      const SmartPointer<SparseMatrix<double>> mass_schur;
+      const SmartPointer<const SparseMatrix<double>> mass_schur;
 
       /// The direct solver used for \f$\tilde{A}\f$. We declare it as a member
       /// so that it can be initialized only once for many applications of the
@@ -73,9 +73,14 @@ namespace Fluid
     using FluidSolver<dim>::mass_matrix;
     using FluidSolver<dim>::mass_schur_pattern;
     using FluidSolver<dim>::mass_schur;
+    using FluidSolver<dim>::update_mass_schur;
     using FluidSolver<dim>::present_solution;
     using FluidSolver<dim>::system_rhs;
     using FluidSolver<dim>::time;
+    using FluidSolver<dim>::preconditioner_reuse;
+    using FluidSolver<dim>::cell_fe_data;
+    using FluidSolver<dim>::adapt_time_step;
+    using FluidSolver<dim>::solution_predictor;
     using FluidSolver<dim>::timer;
     using FluidSolver<dim>::parameters;
     using FluidSolver<dim>::cell_property;
@@ -104,7 +109,14 @@ namespace Fluid
     std::pair<unsigned int, double> solve(bool use_nonzero_constraints,
                                           bool assemble_system);
 
-    /// Run the simulation for one time step.
+    /*! \brief Run the simulation for one time step.
+     *
+     *  The system matrix only depends on the mesh, the constraints and the
+     *  time step, so it is cached and only the RHS is assembled, unless the
+     *  nonzero constraints are applied: their inhomogeneities need the cell
+     *  matrices, and in FSI they change at every time step. The second
+     *  argument is therefore ignored.
+     */
     void run_one_step(bool apply_nonzero_constraints,
                       bool assemble_system = true) override;
 
@@ -114,6 +126,11 @@ namespace Fluid
     /// The BlockSchurPreconditioner for the entire system.
     std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+    /// Set when the mesh changes, the system matrix must be reassembled.
+    bool matrix_outdated;
+    /// The time step size the system matrix was assembled with.
+    double matrix_delta_t;
+
     /** \brief Block preconditioner for the system
      *
      * A right block preconditioner is defined here:
@@ -158,7 +175,7 @@ namespace Fluid
                                double dt,
                                const BlockSparseMatrix<double> &system,
                                const BlockSparseMatrix<double> &mass,
-                               SparseMatrix<double> &schur);
+                               const SparseMatrix<double> &schur);
 
       /// The matrix-vector multiplication must be defined.
       void vmult(BlockVector<double> &dst,
@@ -187,7 +204,7 @@ namespace Fluid
        * Based on my tests, the first approach is more than 10 times faster so I
        * go with this route.
        */
-      const SmartPointer<SparseMatrix<double>> mass_schur;
+      const SmartPointer<const SparseMatrix<double>> mass_schur;
     };
   };
 } // namespace Fluid
@@ -0,0 +1,40 @@
+#ifndef INSTRUMENTATION
+#define INSTRUMENTATION
+
+/*! \file
+ * Hardware counter markers around the kernels that dominate a step: the
+ * fluid and solid assembly, the stress recovery and the FSI coupling.
+ *
+ * With -DOPENIFEM_WITH_likwid=ON every OPENIFEM_KERNEL_SCOPE is a LIKWID
+ * marker region, so that likwid-perfctr -m reports the flops and the memory
+ * traffic of every kernel; benchmarks/roofline.py places them on a
+ * roofline. The counters are those of the thread that enters the region,
+ * so the threaded serial kernels should be measured with one thread.
+ * Without LIKWID the macro expands to nothing.
+ */
+#ifdef OPENIFEM_WITH_LIKWID
+#include <likwid-marker.h>
+
+namespace Utils
+{
+  /// A LIKWID marker region that lasts as long as the object.
+  class KernelScope
+  {
+  public:
+    explicit KernelScope(const char *name) : name(name)
+    {
+      LIKWID_MARKER_START(name);
+    }
+    ~KernelScope() { LIKWID_MARKER_STOP(name); }
+
+  private:
+    const char *name;
+  };
+} // namespace Utils
+
+#define OPENIFEM_KERNEL_SCOPE(name) Utils::KernelScope kernel_scope(name)
+#else
+#define OPENIFEM_KERNEL_SCOPE(name)
+#endif
+
+#endif
@@ -22,6 +22,29 @@ namespace Solid
      */
     LinearElasticMaterial(double, double, double);
     dealii::SymmetricTensor<4, dim> get_elasticity() const;
+    /**
+     * The stress of a strain, \f$\lambda tr(\epsilon)I + 2\mu\epsilon\f$.
+     * Equivalent to get_elasticity() * strain without the contraction of
+     * the rank 4 tensor.
+     */
+    dealii::SymmetricTensor<2, dim>
+    get_stress(const dealii::SymmetricTensor<2, dim> &strain) const
+    {
+      return lambda * dealii::trace(strain) *
+               dealii::unit_symmetric_tensor<dim>() +
+             2 * mu * strain;
+    }
+    /**
+     * The elastic energy product of two strains,
+     * \f$\lambda tr(\epsilon_a)tr(\epsilon_b) + 2\mu\epsilon_a:\epsilon_b\f$,
+     * which is an entry of the stiffness matrix if the strains are the
+     * symmetric gradients of two shape functions.
+     */
+    double get_stiffness(const dealii::SymmetricTensor<2, dim> &a,
+                         const dealii::SymmetricTensor<2, dim> &b) const
+    {
+      return lambda * dealii::trace(a) * dealii::trace(b) + 2 * mu * (a * b);
+    }
 
   protected:
     double E;      //!< Young's modulus
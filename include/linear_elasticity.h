@@ -4,6 +4,12 @@
 #include "linear_elastic_material.h"
 #include "solid_solver.h"
 
+#ifdef OPENIFEM_WITH_CUDA
+#include <deal.II/base/cuda.h>
+#include <deal.II/lac/cuda_sparse_matrix.h>
+#include <deal.II/lac/cuda_vector.h>
+#endif
+
 template <int>
 class FSI;
 
@@ -68,8 +74,10 @@ namespace Solid
     using SolidSolver<dim>::strain;
     using SolidSolver<dim>::stress;
     using SolidSolver<dim>::time;
+    using SolidSolver<dim>::neumann_table;
     using SolidSolver<dim>::timer;
     using SolidSolver<dim>::cell_property;
+    using SolidSolver<dim>::inverse_lumped_mass;
 
     /**
      * Assembles lhs and rhs. At time step 0, the lhs is the mass matrix;
@@ -89,6 +97,11 @@ namespace Solid
      */
     void assemble_rhs();
 
+    /**
+     * Assembles the external minus the internal force, not any matrix.
+     */
+    virtual void assemble_explicit_rhs() override;
+
     /**
      * Update the strain and stress, used in output_results and FSI.
      */
@@ -99,7 +112,64 @@ namespace Solid
      */
     void run_one_step(bool);
 
+    /**
+     * Solve the effective system for the current acceleration. Unless
+     * disabled in the parameters, the system matrix is factorized at the
+     * first call and reused until it is invalidated.
+     */
+    std::pair<unsigned int, double>
+    solve_effective_system(const Vector<double> &);
+
+#ifdef OPENIFEM_WITH_CUDA
+    /**
+     * Upload the stiffness, the inverse lumped mass, the external force and
+     * the state of the last step to the device. Return false if there are
+     * constraints other than homogeneous Dirichlet ones, which the device
+     * steps cannot apply.
+     */
+    bool setup_device();
+
+    /**
+     * Assemble the external force and upload it to the device.
+     */
+    void upload_external_force();
+
+    /**
+     * Copy the state from the device into the current and previous vectors
+     * and update the strain and stress.
+     */
+    void download_state();
+
+    /**
+     * Run one explicit central difference step on the device. The state
+     * stays on the device and is only copied to the host when it is needed
+     * for output, coupling, monitoring or refinement.
+     */
+    void run_one_device_step();
+
+    Utilities::CUDA::Handle cuda_handle;
+    CUDAWrappers::SparseMatrix<double> device_stiffness;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_inverse_mass;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_external_force;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_displacement;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_velocity;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_acceleration;
+    LinearAlgebra::CUDAWrappers::Vector<double> device_buffer;
+    /// Whether the device holds the state of the last step.
+    bool device_ready = false;
+    /// False once the constraints turned out to be unsupported.
+    bool device_supported = true;
+#endif
+
+    /// Leave the internal force out of the explicit rhs, which is then
+    /// only the external force.
+    bool external_force_only = false;
+
     std::vector<LinearElasticMaterial<dim>> material;
+
+    SparseDirectUMFPACK system_factorization;
+    double factorized_delta_t; //!< The time step of the factorization,
+                               //! 0 if there is none.
   };
 } // namespace Solid
 
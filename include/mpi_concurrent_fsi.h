@@ -0,0 +1,116 @@
+#ifndef MPI_CONCURRENT_FSI
+#define MPI_CONCURRENT_FSI
+
+#include <deal.II/fe/mapping_q_generic.h>
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include "mpi_fluid_solver.h"
+#include "mpi_shared_solid_solver.h"
+
+using namespace dealii;
+
+extern template class Fluid::MPI::FluidSolver<2>;
+extern template class Fluid::MPI::FluidSolver<3>;
+extern template class Solid::MPI::SharedSolidSolver<2>;
+extern template class Solid::MPI::SharedSolidSolver<3>;
+extern template class Utils::RemotePointEvaluator<2, Vector<double>>;
+extern template class Utils::RemotePointEvaluator<3, Vector<double>>;
+extern template class Utils::RemotePointEvaluator<
+  2,
+  PETScWrappers::MPI::BlockVector>;
+extern template class Utils::RemotePointEvaluator<
+  3,
+  PETScWrappers::MPI::BlockVector>;
+
+namespace MPI
+{
+  /*! \brief Solve the solid and the fluid at the same time on disjoint
+   * groups of processes.
+   *
+   * The first parameters.concurrent_solid_processes processes solve the
+   * solid on the communicator returned by Utils::split_communicator, and the
+   * other processes solve the fluid on the rest. Every process passes the
+   * solver of its own group and a null pointer for the other one. The first
+   * solid process gathers the solid state and serves it to the fluid
+   * processes through Utils::RemotePointEvaluator, and it queries the fluid
+   * stress at the solid boundary vertices in the same way, which it then
+   * broadcasts to the other solid processes.
+   *
+   * The exchange at the beginning of every time step is the only
+   * synchronization between the groups, after which both solves start from
+   * the state at the beginning of the step. The solid is loaded by the
+   * current fluid stress as in FSI, but the fluid cannot wait for the new
+   * solid, so it is coupled to the solid displacement and velocity
+   * extrapolated to the end of the step with the current acceleration. The
+   * coupling is weak, and the meshes are not adapted.
+   */
+  template <int dim>
+  class ConcurrentFSI
+  {
+  public:
+    ConcurrentFSI(Fluid::MPI::FluidSolver<dim> *,
+                  Solid::MPI::SharedSolidSolver<dim> *,
+                  const Parameters::AllParameters &,
+                  bool use_dirichlet_bc = false);
+    void run();
+
+    //! Destructor
+    ~ConcurrentFSI();
+
+  private:
+    /// Gather the solid state on the first solid process and extrapolate
+    /// it to the end of the time step. Collective over the solid processes.
+    void update_solid_state();
+
+    /// Move the solid mesh of the first solid process either forward or
+    /// backward by the predicted displacement.
+    void move_solid_mesh(bool);
+
+    /// Set the indicator of every locally owned fluid cell to 1 if all of
+    /// its vertices are found in the predicted solid, otherwise 0.
+    void update_indicator();
+
+    /// Compute the Dirichlet BCs or the FSI acceleration of the artificial
+    /// fluid from the predicted solid velocity, in the same way as
+    /// DistributedFSI::find_fluid_bc.
+    void find_fluid_bc();
+
+    /// Interpolate the fluid stress at the boundary vertices of the current
+    /// solid, and broadcast it to the solid processes.
+    void find_solid_bc();
+
+    Fluid::MPI::FluidSolver<dim> *fluid_solver;
+    Solid::MPI::SharedSolidSolver<dim> *solid_solver;
+    Parameters::AllParameters parameters;
+    MPI_Comm mpi_communicator;
+    ConditionalOStream pcout;
+    Utils::Time time;
+    mutable TimerOutput timer;
+
+    /// Whether this is the first solid process, which serves the solid.
+    bool solid_leader;
+
+    // Locate points in the fluid and in the solid on any process, the
+    // processes of the other group only query.
+    std::unique_ptr<
+      Utils::RemotePointEvaluator<dim, PETScWrappers::MPI::BlockVector>>
+      fluid_evaluator;
+    std::unique_ptr<Utils::RemotePointEvaluator<dim, Vector<double>>>
+      solid_evaluator;
+
+    // The solid state at the beginning of the time step, and the
+    // displacement and velocity predicted at its end, on the solid processes.
+    Vector<double> solid_displacement;
+    Vector<double> solid_velocity;
+    Vector<double> solid_acceleration;
+    Vector<double> predicted_displacement;
+    Vector<double> predicted_velocity;
+
+    // The FSI acceleration at the fluid dofs, before it is ghosted.
+    PETScWrappers::MPI::BlockVector fsi_acceleration;
+
+    bool use_dirichlet_bc;
+  };
+} // namespace MPI
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef MPI_DISTRIBUTED_FSI
+#define MPI_DISTRIBUTED_FSI
+
+#include <deal.II/fe/mapping_q_generic.h>
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include "mpi_fluid_solver.h"
+#include "mpi_solid_solver.h"
+
+using namespace dealii;
+
+extern template class Fluid::MPI::FluidSolver<2>;
+extern template class Fluid::MPI::FluidSolver<3>;
+extern template class Solid::MPI::SolidSolver<2>;
+extern template class Solid::MPI::SolidSolver<3>;
+extern template class Utils::RemotePointEvaluator<2,
+                                                  PETScWrappers::MPI::Vector>;
+extern template class Utils::RemotePointEvaluator<3,
+                                                  PETScWrappers::MPI::Vector>;
+extern template class Utils::RemotePointEvaluator<
+  2,
+  PETScWrappers::MPI::BlockVector>;
+extern template class Utils::RemotePointEvaluator<
+  3,
+  PETScWrappers::MPI::BlockVector>;
+
+namespace MPI
+{
+  /*! \brief Couple a distributed fluid solver with a distributed solid.
+   *
+   * Unlike FSI, no process stores the whole solid: the solid is a
+   * Solid::MPI::SolidSolver on a parallel::distributed::Triangulation, which
+   * must run on the same processes as the fluid. The two meshes query each
+   * other through Utils::RemotePointEvaluator, so only the interface points
+   * that fall into the cells of other processes, and the values at them, are
+   * exchanged. The quadrature points on the solid boundary are located in
+   * the fluid for the traction, and the fluid vertices and support points
+   * are located in the solid for the indicator and the velocity.
+   *
+   * The coupling is weak, i.e., the solid and the fluid are solved once per
+   * time step, and the meshes are not adapted.
+   */
+  template <int dim>
+  class DistributedFSI
+  {
+  public:
+    DistributedFSI(Fluid::MPI::FluidSolver<dim> &,
+                   Solid::MPI::SolidSolver<dim> &,
+                   const Parameters::AllParameters &,
+                   bool use_dirichlet_bc = false);
+    void run();
+
+    //! Destructor
+    ~DistributedFSI();
+
+  private:
+    /// Move the locally owned and ghost solid cells either forward or
+    /// backward using the ghosted displacement.
+    void move_solid_mesh(bool);
+
+    /// Import the solid displacement, velocity and acceleration of the
+    /// locally relevant dofs after the solid is solved.
+    void update_solid_state();
+
+    /// Set the indicator of every locally owned fluid cell to 1 if all of
+    /// its vertices are found in the solid, otherwise 0.
+    void update_indicator();
+
+    /*! \brief Compute the Dirichlet BCs or the FSI acceleration of the
+     * artificial fluid from the solid velocity and acceleration.
+     *
+     *  The velocity support points are selected in the same way as
+     *  FSI::find_fluid_bc, but all of them are located in the solid in one
+     *  batch, and the points not found in the solid are skipped.
+     */
+    void find_fluid_bc();
+
+    /*! \brief Compute the fluid traction on the solid boundary.
+     *
+     *  The fluid stress is interpolated at the face quadrature points of the
+     *  boundary faces of the locally owned solid cells in the current
+     *  configuration. The traction is zero at the points outside the fluid.
+     */
+    void find_solid_bc();
+
+    Fluid::MPI::FluidSolver<dim> &fluid_solver;
+    Solid::MPI::SolidSolver<dim> &solid_solver;
+    Parameters::AllParameters parameters;
+    MPI_Comm mpi_communicator;
+    ConditionalOStream pcout;
+    Utils::Time time;
+    mutable TimerOutput timer;
+
+    // Locate points in the fluid and in the solid on any process.
+    Utils::RemotePointEvaluator<dim, PETScWrappers::MPI::BlockVector>
+      fluid_evaluator;
+    Utils::RemotePointEvaluator<dim, PETScWrappers::MPI::Vector>
+      solid_evaluator;
+
+    // The solid state ghosted on the locally relevant solid dofs.
+    PETScWrappers::MPI::Vector solid_displacement;
+    PETScWrappers::MPI::Vector solid_velocity;
+    PETScWrappers::MPI::Vector solid_acceleration;
+
+    // The FSI acceleration at the fluid dofs, before it is ghosted.
+    PETScWrappers::MPI::BlockVector fsi_acceleration;
+
+    bool use_dirichlet_bc;
+  };
+} // namespace MPI
+
+#endif
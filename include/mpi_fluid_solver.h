@@ -55,9 +55,12 @@
 #include <deal.II/distributed/solution_transfer.h>
 #include <deal.II/distributed/tria.h>
 
+#include <cstring>
 #include <experimental/filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <numeric>
 #include <sstream>
 
 #include "parameters.h"
@@ -69,6 +72,10 @@ namespace MPI
 {
   template <int dim>
   class FSI;
+  template <int dim>
+  class DistributedFSI;
+  template <int dim>
+  class ConcurrentFSI;
 }
 
 namespace Fluid
@@ -84,6 +91,8 @@ namespace Fluid
     public:
       //! FSI solver need access to the private members of this solver.
       friend ::MPI::FSI<dim>;
+      friend ::MPI::DistributedFSI<dim>;
+      friend ::MPI::ConcurrentFSI<dim>;
 
       //! Constructor.
       FluidSolver(parallel::distributed::Triangulation<dim> &,
@@ -101,6 +110,10 @@ namespace Fluid
       //! Return the solution for testing.
       PETScWrappers::MPI::BlockVector get_current_solution() const;
 
+      //! Print the memory of the solver components over the ranks.
+      //! Collective.
+      void print_memory_usage() const;
+
     protected:
       class BoundaryValues;
       struct CellProperty;
@@ -115,6 +128,12 @@ namespace Fluid
       //! Set up the nonzero and zero constraints.
       void make_constraints();
 
+      /// Reset the constraints to the hanging node and Dirichlet constraints
+      /// of the mesh, which make_constraints() keeps, without building them
+      /// again. The nonzero constraints are the zero ones unless requested.
+      /// Used by FSI to layer the interface constraints of every step on top.
+      void restore_constraints(const bool use_nonzero_constraints);
+
       //! Initialize the cell properties, which only matters in FSI
       //! applications.
       void setup_cell_property();
@@ -123,21 +142,142 @@ namespace Fluid
       /// the dofs and constraints.
       virtual void initialize_system();
 
+      /// Compute the approximate Schur complement \f$B diag(M_u)^{-1}B^T\f$
+      /// into mass_schur. It depends on neither the solution nor the time
+      /// step, so it is only recomputed after the mesh or the constrained
+      /// dofs have changed. Return whether it was recomputed. Collective.
+      bool update_mass_schur();
+
       /// Mesh adaption.
       void refine_mesh(const unsigned int, const unsigned int);
 
+      /// Repartition the mesh with the cell weights connected to the
+      /// triangulation, and transfer the solution. The cell properties are
+      /// reset.
+      void repartition();
+
       /// Output in vtu format.
       void output_results(const unsigned int) const;
 
-      /// Update stress to output
-      virtual void update_stress();
+      /// Compute the nodal stress, which is only done when it is written.
+      virtual void update_stress() const;
+
+      /// Add the memory of the components on this rank to a report.
+      virtual void add_memory_usage(Utils::MemoryReport &) const;
+
+      /// Append the probe values and the forces and fluxes on the monitored
+      /// boundaries to the monitor file if it is time to. Collective.
+      void write_monitors();
+
+      /// The largest CFL number of the present solution over all the
+      /// locally owned cells of all processes, with the cell size taken as
+      /// the minimum vertex distance divided by the velocity degree.
+      double compute_cfl();
+
+      /// Choose the size of the next time step from the CFL number and the
+      /// Newton iterations of the last one, only in Fluid simulations and if
+      /// told so in the input file.
+      void adapt_time_step(const unsigned int newton_iterations);
+
+      /*! \brief Prepare the time derivative of the step that has just begun.
+       *
+       *  The implicit solvers discretize the time derivative as (u -
+       *  time_history()) / effective_delta_t(). For backward Euler these are
+       *  u_n and the step size. The variable-step BDF2 derivative, see
+       *  Utils::bdf2_coefficients, is written the same way with the history
+       *  u_n + a_2 / a_0 (u_n - u_{n-1}) and the step size divided by a_0,
+       *  which is computed here. BDF2 falls back to backward Euler while
+       *  there is no previous solution. Must be called after time.increment().
+       */
+      void update_time_history();
+
+      /// The solution the time derivative of the step is taken from, ghosted.
+      const PETScWrappers::MPI::BlockVector &time_history() const;
+
+      /// The step size the time derivative is divided by, which also scales
+      /// the mass in the matrix and in the preconditioners.
+      double effective_delta_t() const;
 
-      /// Save checkpoint for restart.
+      /// Keep the present solution as the previous one before it is
+      /// replaced by the solution of the step, only with BDF2.
+      void record_previous_solution();
+
+      /**
+       * Save checkpoint for restart. Every rank writes a part with its
+       * active cells and their solution, in the background if the
+       * checkpoints are asynchronous. The parts do not depend on the
+       * partition, and they are known to be complete once every rank has
+       * reached the next save. Collective.
+       */
       void save_checkpoint(const int);
 
-      /// Load from checkpoint to restart.
+      /// Load from checkpoint to restart, from the buddy checkpoint if it
+      /// is newer than the one on disk.
       bool load_checkpoint();
 
+      /// Load the parts of a checkpoint saved by the given number of
+      /// processes. Collective.
+      void load_checkpoint_parts(const int, const unsigned int);
+
+      /// Load a checkpoint saved by the triangulation, before the checkpoints
+      /// were written in parts. Collective.
+      void load_triangulation_checkpoint(const int);
+
+      /// The number of parts of a checkpoint if they are all written, and 0
+      /// otherwise.
+      unsigned int checkpoint_parts(const int) const;
+
+      /// Remove the files of a checkpoint.
+      void remove_checkpoint(const int) const;
+
+      /// The header of a checkpoint part: the number of vectors, the number
+      /// of cells, the previous step size, then the time step, the current
+      /// and previous times and the step size.
+      using CheckpointHeader = std::array<double, 7>;
+
+      /// The part of the disk and buddy checkpoints kept by this rank: the
+      /// header followed by the owned active cells and their dof values.
+      std::vector<char> checkpoint_part() const;
+
+      /// Stop with an error if a checkpoint with the given number of
+      /// vectors was saved with another time integration.
+      void check_time_integration(const double saved_vectors) const;
+
+      /// Refine the coarse mesh to the saved active cells and set up the
+      /// system on it. Collective.
+      void refine_to_saved_cells(
+        const std::map<CellId, std::pair<unsigned int, unsigned int>> &);
+
+      /// Take the present solution, and the previous one with BDF2, from
+      /// the vectors of a checkpoint.
+      void
+      restore_solutions(const std::vector<PETScWrappers::MPI::BlockVector> &,
+                        const double saved_previous_delta_t);
+
+      /// Keep the solution of this step in the buddy checkpoints on the
+      /// nodes, by the active cells so that it does not depend on the
+      /// partition. Collective.
+      void save_buddy_checkpoint(const int);
+
+      /// Refine the coarse mesh to the saved active cells and take the
+      /// solution of every cell from the rank that saved it.
+      void load_buddy_checkpoint(const int);
+
+      /// Advance the time and the .pvd records to a loaded checkpoint, whose
+      /// output was written by the given number of processes. The step size
+      /// is taken to be constant, which holds for the checkpoints saved by
+      /// the triangulation.
+      void replay_time(const int, const unsigned int saved_processes);
+
+      /// Set the time to the one saved in the header of a checkpoint part,
+      /// and take the .pvd records up to it from the .pvd file.
+      void restore_time(const CheckpointHeader &);
+
+      /// Record the present solution in the steady state monitor. Once the
+      /// run is steady, write the final output and checkpoint if they have
+      /// not been written at this step and return true. Collective.
+      bool reached_steady_state();
+
       std::vector<types::global_dof_index> dofs_per_block;
 
       parallel::distributed::Triangulation<dim> &triangulation;
@@ -150,28 +290,47 @@ namespace Fluid
 
       AffineConstraints<double> zero_constraints;
       AffineConstraints<double> nonzero_constraints;
+      /// The closed constraints of the mesh from make_constraints(), which
+      /// are kept until the mesh or the boundary values change.
+      AffineConstraints<double> mesh_zero_constraints;
+      AffineConstraints<double> mesh_nonzero_constraints;
 
-      BlockSparsityPattern sparsity_pattern;
       PETScWrappers::MPI::BlockSparseMatrix system_matrix;
       PETScWrappers::MPI::BlockSparseMatrix mass_matrix;
       PETScWrappers::MPI::BlockSparseMatrix mass_schur;
+      /// Set when the mesh changes, so that mass_schur is recomputed.
+      bool mass_schur_outdated = true;
+      /// The locally relevant dofs constrained by zero_constraints when
+      /// mass_schur was computed.
+      IndexSet mass_schur_constraints;
 
       /// The latest known solution.
       PETScWrappers::MPI::BlockVector present_solution;
       PETScWrappers::MPI::BlockVector solution_increment;
       PETScWrappers::MPI::BlockVector system_rhs;
 
+      /// The solution of the step before present_solution and the size of
+      /// the step between them, only kept with BDF2 and transferred along
+      /// with present_solution. A previous_delta_t of 0 means there is none.
+      PETScWrappers::MPI::BlockVector previous_solution;
+      double previous_delta_t = 0;
+
+      /// The history of the BDF2 time derivative, see update_time_history().
+      PETScWrappers::MPI::BlockVector bdf2_history;
+
       /// FSI acceleration vector, which is attached on the solution dof
       /// handloer
       PETScWrappers::MPI::BlockVector fsi_acceleration;
 
       /**
-       * Nodal strain and stress obtained by taking the average of surrounding
-       * cell-averaged strains and stresses. Their sizes are
-       * [dim, dim, scalar_dof_handler.n_dofs()], i.e., stress[i][j][k]
-       * denotes sigma_{ij} at vertex k.
+       * Nodal stress obtained by taking the average of surrounding
+       * cell-averaged stresses. Only the independent components are stored,
+       * in the unrolled order of SymmetricTensor, i.e., stress[c][k] denotes
+       * sigma_{ij} at scalar dof k, where (i, j) is
+       * SymmetricTensor<2, dim>::unrolled_to_component_indices(c). It holds
+       * the stress of the last output, and is empty after the mesh changes.
        */
-      mutable std::vector<std::vector<PETScWrappers::MPI::Vector>> stress;
+      mutable std::vector<PETScWrappers::MPI::Vector> stress;
 
       Parameters::AllParameters parameters;
 
@@ -201,27 +360,143 @@ namespace Fluid
       mutable TimerOutput timer;
       mutable TimerOutput timer2;
 
-      CellDataStorage<
-        typename parallel::distributed::Triangulation<dim>::cell_iterator,
-        CellProperty>
-        cell_property;
+      /// The policy of reusing the block preconditioner across linear solves.
+      Utils::PreconditionerReuse preconditioner_reuse;
 
-      /// Hard-coded boundary values, only used when told so in the input
-      /// parameters.
-      std::shared_ptr<Function<dim>> boundary_values;
+      /// The per-cell FE data of the assembly, only stored if told so in the
+      /// input file, otherwise computed cell by cell.
+      Utils::CellFEDataCache<dim> cell_fe_data;
+
+      /// The locally owned cells whose dofs are all locally owned, which are
+      /// assembled while the ghost values are exchanged, and the other
+      /// locally owned cells. Both are set up with the dofs.
+      std::vector<typename DoFHandler<dim>::active_cell_iterator>
+        interior_cells, ghost_touching_cells;
+
+      /// The policy of the adaptive time step size.
+      Utils::TimeStepController time_step_controller;
+
+      /// The tolerances of the linear solves in the Newton iterations.
+      Utils::ForcingTerm forcing_term;
 
-      /// A data structure that caches the real/artificial fluid indicator,
-      /// FSI stress, and FSI acceleration terms at quadrature points, that
-      /// will only be used in FSI simulations.
+      /// The initial guesses of the time steps.
+      Utils::SolutionPredictor<PETScWrappers::MPI::BlockVector>
+        solution_predictor;
+
+      /// Writes the part of this rank of the checkpoints, in the background
+      /// if told so.
+      Utils::BackgroundTask checkpoint_writer;
+
+      /// The latest fluid checkpoint.
+      Utils::CheckpointIndex checkpoint_index;
+
+      /// The frequent node-local checkpoints.
+      Utils::BuddyCheckpoint buddy_checkpoint;
+
+      /// The latest checkpoint whose parts may still be written, and the
+      /// latest complete one, or -1.
+      int pending_checkpoint;
+      int complete_checkpoint;
+
+      /// The HDF5 output, used if it is chosen over VTU.
+      mutable Utils::XDMFOutput xdmf_output;
+
+      /// The VTU time series, appended to at every output.
+      mutable Utils::PVDRecord pvd_record;
+
+      /// The fields and region to write.
+      Utils::OutputControl output_control;
+
+      /// Writes the VTU files and the .pvd record. It is destroyed, hence
+      /// finishes writing, before pvd_record.
+      mutable Utils::WriterQueue output_writer;
+
+      /// Stops the standalone run at a steady state.
+      Utils::SteadyStateMonitor<PETScWrappers::MPI::BlockVector> steady_state;
+
+      /// Locates the fluid probes, reset whenever the mesh changes.
+      std::unique_ptr<
+        Utils::RemotePointEvaluator<dim, PETScWrappers::MPI::BlockVector>>
+        probe_evaluator;
+      Utils::MonitorFile monitor_file;
+
+      /// The iterations and preconditioner setups of every time step.
+      Utils::SolverLog solver_log;
+
+      /// The FSI terms of an artificial fluid cell at quadrature points,
+      /// only used in FSI simulations.
       struct CellProperty
       {
-        int indicator; //!< Domain indicator: 1 for artificial fluid 0 for real
-                       //! fluid.
         Tensor<1, dim>
           fsi_acceleration; //!< The acceleration term in FSI force.
         SymmetricTensor<2, dim> fsi_stress; //!< The stress term in FSI force.
         int material_id; //!< The material id of the surrounding solid cell.
       };
+
+      /*! \brief Compact storage of the real/artificial fluid indicator and
+       *  the FSI terms.
+       *
+       *  The indicators of all the active cells are kept in a dense array
+       *  indexed by the active cell index, one byte per cell so that the
+       *  indicators of different cells can be set on multiple threads. Only
+       *  the artificial fluid band carries FSI terms, which are packed into
+       *  one array for the band cells by update_band(). Every other cell
+       *  reads the zero terms without any search.
+       */
+      class CellPropertyStorage
+      {
+      public:
+        /// Reset all the cells to real fluid with an empty band.
+        void reinit(const unsigned int n_active_cells);
+        /// Domain indicator: 1 for artificial fluid 0 for real fluid.
+        template <typename Iterator>
+        int indicator(const Iterator &cell) const
+        {
+          return indicators[cell->active_cell_index()];
+        }
+        template <typename Iterator>
+        void set_indicator(const Iterator &cell, const int indicator)
+        {
+          indicators[cell->active_cell_index()] = indicator;
+        }
+        /// Pack the FSI terms of the artificial fluid cells, the cells that
+        /// stay in the band keep their terms and the new ones start from
+        /// zero. Called after the indicators are updated.
+        void update_band();
+        /// The FSI terms of a cell, zero if it is not in the band.
+        template <typename Iterator>
+        const CellProperty &get_data(const Iterator &cell) const
+        {
+          const unsigned int k = band_index(cell->active_cell_index());
+          return k == numbers::invalid_unsigned_int ? zero_property
+                                                    : band_data[k];
+        }
+        /// The FSI terms of a cell in the band to write into, or nullptr.
+        template <typename Iterator>
+        CellProperty *get_band_data(const Iterator &cell)
+        {
+          const unsigned int k = band_index(cell->active_cell_index());
+          return k == numbers::invalid_unsigned_int ? nullptr : &band_data[k];
+        }
+        unsigned int n_band_cells() const { return band_cells.size(); }
+        std::size_t memory_consumption() const;
+
+      private:
+        /// The position of a cell in band_cells, or an invalid index.
+        unsigned int band_index(const unsigned int cell_index) const;
+
+        std::vector<unsigned char> indicators;
+        /// The sorted active cell indices of the band and their FSI terms.
+        std::vector<unsigned int> band_cells;
+        std::vector<CellProperty> band_data;
+        CellProperty zero_property;
+      };
+
+      CellPropertyStorage cell_property;
+
+      /// Hard-coded boundary values, only used when told so in the input
+      /// parameters.
+      std::shared_ptr<Function<dim>> boundary_values;
     };
   } // namespace MPI
 } // namespace Fluid
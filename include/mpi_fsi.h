@@ -2,6 +2,10 @@
 #define MPI_FSI
 
 #include <deal.II/base/table_indices.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/work_stream.h>
+#include <deal.II/fe/mapping_q_eulerian.h>
+#include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/physics/elasticity/standard_tensors.h>
 
 #include "mpi_fluid_solver.h"
@@ -19,6 +23,22 @@ extern template class Utils::GridInterpolator<2,
                                               PETScWrappers::MPI::BlockVector>;
 extern template class Utils::GridInterpolator<3,
                                               PETScWrappers::MPI::BlockVector>;
+extern template class Utils::BatchedGridInterpolator<2, Vector<double>>;
+extern template class Utils::BatchedGridInterpolator<3, Vector<double>>;
+extern template class Utils::BatchedGridInterpolator<
+  2,
+  PETScWrappers::MPI::BlockVector>;
+extern template class Utils::BatchedGridInterpolator<
+  3,
+  PETScWrappers::MPI::BlockVector>;
+extern template class Utils::BatchedGridInterpolator<
+  2,
+  PETScWrappers::MPI::Vector>;
+extern template class Utils::BatchedGridInterpolator<
+  3,
+  PETScWrappers::MPI::Vector>;
+extern template class Utils::CellCenterHash<2>;
+extern template class Utils::CellCenterHash<3>;
 extern template class Utils::SPHInterpolator<2, Vector<double>>;
 extern template class Utils::SPHInterpolator<3, Vector<double>>;
 extern template class Utils::SPHInterpolator<2,
@@ -27,9 +47,21 @@ extern template class Utils::SPHInterpolator<3,
                                              PETScWrappers::MPI::BlockVector>;
 extern template class Utils::CellLocator<2, DoFHandler<2, 2>>;
 extern template class Utils::CellLocator<3, DoFHandler<3, 3>>;
+extern template class Utils::BoundaryCrossingIndex<2>;
+extern template class Utils::BoundaryCrossingIndex<3>;
+extern template class Utils::CellBucketGrid<2>;
+extern template class Utils::CellBucketGrid<3>;
 
 namespace MPI
 {
+  /*! \brief Couple a distributed fluid solver with a SharedSolidSolver.
+   *
+   * Every process stores the whole solid mesh and reads localized solid
+   * vectors. A Solid::MPI::SolidSolver on a parallel::distributed
+   * triangulation is coupled by DistributedFSI instead. The solid and the
+   * fluid are solved one after the other on every process, ConcurrentFSI
+   * solves them at the same time on disjoint processes.
+   */
   template <int dim>
   class FSI
   {
@@ -43,6 +75,10 @@ namespace MPI
     //! Destructor
     ~FSI();
 
+    //! Print the memory of the fluid, the solid and the coupling over the
+    //! ranks. Collective.
+    void print_memory_usage() const;
+
   private:
     /// Collect all the boundary lines in solid triangulation.
     void collect_solid_boundaries();
@@ -50,10 +86,19 @@ namespace MPI
     /// Setup the hints for searching for each fluid cell.
     void setup_cell_hints();
 
-    /// Define a smallest rectangle (or hex in 3d) that contains the solid.
+    /// Size the coupling workspace for the current fluid mesh.
+    void setup_coupling_workspace();
+
+    /// Define a smallest rectangle (or hex in 3d) that contains the solid,
+    /// and rebuild the spatial indices of the solid.
     void update_solid_box();
 
-    /// Find the vertices that are onwed by the local process.
+    /// Collect the solid dofs of the solid cells that overlap the local
+    /// fluid cells, which must be called with the solid mesh moved forward.
+    void update_solid_coupling_dofs();
+
+    /// Find the vertices that are onwed by the local process and their
+    /// bounding box, and drop the fluid cell hints of the solid boundary.
     void update_vertices_mask();
 
     /// Check if a point is inside a mesh.
@@ -66,13 +111,26 @@ namespace MPI
      * updated as a whole: they are either all 1 or all 0. The criteria is
      * that whether all of the vertices are in solid mesh (because later on
      * Dirichlet BCs obtained from the solid will be applied).
+     *
+     *  In the narrow band mode, only the fluid cells overlapping the solid box
+     *  plus a margin of the maximum solid velocity times the time step are
+     *  re-classified, the rest keep their indicators.
      */
     void update_indicator();
 
     /// Move solid triangulation either forward or backward using
-    /// displacements,
+    /// displacements. With the Eulerian mapping, the triangulation is not
+    /// touched: moving forward updates the mapping and the deformed
+    /// vertices, moving backward does nothing.
     void move_solid_mesh(bool);
 
+    /// Localize the solid displacement into the Eulerian mapping and
+    /// compute the deformed solid vertices.
+    void update_solid_mapping();
+
+    /// The current position of a solid vertex, deformed or moved.
+    const Point<dim> &solid_vertex(const unsigned int) const;
+
     /*! \brief Compute the fluid traction on solid boundaries.
      *
      *  The implementation is straight-forward: loop over the faces on the
@@ -101,12 +159,73 @@ namespace MPI
      * stress itself and the acceleration are separately cached onto the fluid
      * quadrature
      *  points to be used by the fluid solver.
+     *
+     *  The fluid cells are located in the solid on multiple threads with
+     *  WorkStream, while the PETSc vectors are only read and written by the
+     *  copier, which runs in the order of the cells.
      */
     void find_fluid_bc();
 
+    /*! \brief Assemble the solid-to-fluid transfer operator.
+     *
+     *  Every row of the operator corresponds to an artificial fluid support
+     *  point that find_fluid_bc sets, and holds the solid shape function
+     *  weights of the velocity component of that support point. Therefore
+     *  interpolating the solid velocity or acceleration to all these points
+     *  is a single mat-vec. The support points are selected in the same way as
+     *  find_fluid_bc, so the solid mesh must have been moved forward.
+     */
+    void assemble_transfer_operator();
+
+    /// Whether the transfer operator must be rebuilt, i.e., the fluid mesh
+    /// has changed or the solid has moved more than the rebuild distance
+    /// since the operator was built.
+    bool transfer_operator_outdated() const;
+
+    /// Save the solver states at the beginning of a time step.
+    void save_step_state();
+
+    /// Restore the solver states saved by save_step_state, so that the time
+    /// step can be repeated.
+    void restore_step_state();
+
+    /*! \brief Relax the FSI stress of a strongly coupled iteration.
+     *
+     *  The residual is the change of the FSI stress from the one that the
+     *  solid was last solved with. Unless it is below the coupling tolerance,
+     *  the FSI stress is replaced by the last one plus the residual scaled by
+     *  the dynamic Aitken factor. Return whether the iterations converged.
+     *  The relative change is kept in stress_change.
+     */
+    bool relax_interface_stress(const unsigned int iteration);
+
     /// Mesh adaption.
     void refine_mesh(const unsigned int, const unsigned int);
 
+    /// Record the fluid and solid solutions in their steady state monitors.
+    /// Once both are steady, write the final output and checkpoints if they
+    /// have not been written at this step and return true.
+    bool reached_steady_state();
+
+    /*! \brief Update the extra weight of the artificial fluid cells.
+     *
+     *  Unless it is given in the parameters, the extra cost of an artificial
+     *  fluid cell relative to a plain one is measured as the time spent on
+     *  the coupling per artificial cell over the time spent on the fluid
+     *  solver per cell, which are summed over all processes.
+     */
+    void update_cell_weight();
+
+    /// The weight of a fluid cell in repartitioning, which is connected to
+    /// the cell_weight signal of the fluid triangulation.
+    unsigned int cell_weight(
+      const typename parallel::distributed::Triangulation<dim>::cell_iterator &,
+      const typename parallel::distributed::Triangulation<dim>::CellStatus)
+      const;
+
+    /// Repartition the fluid mesh with the weights of the coupling cost.
+    void repartition();
+
     // For MPI FSI, the solid solver uses shared trianulation. i.e.,
     // each process has the entire graph, for the ease of looping.
     Fluid::MPI::FluidSolver<dim> &fluid_solver;
@@ -126,16 +245,150 @@ namespace MPI
     // number.
     std::list<typename Triangulation<dim>::face_iterator> solid_boundaries;
 
+    // Spatial index of solid_boundaries in the current configuration, which
+    // is queried by the ray-crossing test in point_in_solid.
+    Utils::BoundaryCrossingIndex<dim> boundary_index;
+
+    // Spatial index of the solid cells in the current configuration, which
+    // is queried by point_in_solid in 3D.
+    Utils::CellBucketGrid<dim> solid_cell_index;
+
+    // The deformed solid geometry when the Eulerian mapping is used: the
+    // localized displacement, the degree 1 mapping on it, and the deformed
+    // position of every vertex of the solid triangulation, which can be
+    // shared by the ranks of a node. Without the Eulerian mapping,
+    // solid_mapping is null and solid_vertices is empty.
+    Vector<double> solid_euler_displacement;
+    std::unique_ptr<MappingQEulerian<dim, Vector<double>>> solid_mapping;
+    Utils::NodeSharedArray<Point<dim>> solid_vertices;
+
+    // The processes that solve every solid subdomain. The solid can be solved
+    // redundantly by several groups of processes, which all read the FSI
+    // stress of their subdomains.
+    std::vector<std::vector<unsigned int>> solid_subdomain_processes;
+
     // A mask that marks local fluid vertices for solid bc interpolation
     // searching.
     std::vector<bool> vertices_mask;
 
+    // The smallest box that contains the locally owned fluid cells, in the
+    // same order as solid_box. Solid boundary points outside of it are left
+    // to the processes that own their fluid cells.
+    Vector<double> fluid_owned_box;
+
+    // The fluid cell that every solid boundary vertex of find_solid_bc was
+    // last found in, or an invalid iterator, and the BFS locator that
+    // searches from them.
+    std::vector<typename DoFHandler<dim>::active_cell_iterator>
+      solid_boundary_hints;
+    Utils::CellLocator<dim, DoFHandler<dim>> fluid_locator;
+
     // Cell storage that stores hints of cell searching from last time step.
     CellDataStorage<
       typename parallel::distributed::Triangulation<dim>::active_cell_iterator,
       typename DoFHandler<dim>::active_cell_iterator>
       cell_hints;
 
+    // The BFS locator that searches for the solid cells from cell_hints,
+    // which keeps its buffers across searches.
+    Utils::CellLocator<dim, DoFHandler<dim>> solid_locator;
+    // Copies of solid_locator for the threads in find_fluid_bc, which also
+    // keep their buffers across time steps.
+    Threads::ThreadLocalStorage<Utils::CellLocator<dim, DoFHandler<dim>>>
+      thread_locators;
+
+    // The solid-to-fluid transfer operator, only used when the
+    // transfer rebuild distance is positive.
+    SparsityPattern transfer_sparsity;
+    SparseMatrix<double> transfer_matrix;
+    // The fluid cell and the index of the support point of every row.
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> transfer_cells;
+    std::vector<unsigned int> transfer_support;
+    // The solid displacement when the transfer operator was built.
+    PETScWrappers::MPI::Vector transfer_displacement;
+    // Set when the fluid mesh changes.
+    bool transfer_outdated;
+
+    // The solid dofs that find_fluid_bc may read on this process, and the
+    // solid velocity and acceleration ghosted on them. They replace the
+    // localized copies of the entire solid state.
+    IndexSet solid_coupling_dofs;
+    PETScWrappers::MPI::Vector coupled_solid_velocity;
+    PETScWrappers::MPI::Vector coupled_solid_acceleration;
+
+    // The buffers of the coupling routines, which are sized once per mesh
+    // by setup_coupling_workspace() and reused in every time step.
+    struct CouplingWorkspace
+    {
+      // A fluid cell and the support points it sets in find_fluid_bc,
+      // together with its local fluid solution if the FSI acceleration is
+      // computed.
+      struct Job
+      {
+        typename DoFHandler<dim>::active_cell_iterator cell;
+        std::vector<unsigned int> support;
+        Vector<double> fluid_values;
+      };
+      // Whether a locally relevant fluid dof has been set, indexed by its
+      // position in the locally relevant dofs instead of the global index.
+      std::vector<unsigned char> dof_touched;
+      // The jobs of find_fluid_bc, of which the first n_jobs are used.
+      std::vector<Job> jobs;
+      unsigned int n_jobs;
+      PETScWrappers::MPI::BlockVector fsi_acceleration;
+      // The solid state interpolated by the transfer operator or by the
+      // batched interpolators.
+      Vector<double> solid_acc;
+      Vector<double> solid_vel;
+      std::vector<std::vector<Vector<double>>> solid_values;
+      // The entire solid displacement and the solid vertices visited, for
+      // moving the solid mesh, and the displacement that
+      // update_solid_displacement computes.
+      Vector<double> solid_displacement;
+      std::vector<bool> vertex_touched;
+      Vector<double> updated_displacement;
+      // The fluid solution at a single point.
+      Vector<double> point_value;
+    };
+    CouplingWorkspace workspace;
+
+    // Spatial index of the fluid cells, and the locally owned fluid cells
+    // re-classified by the last narrow band update of the indicator.
+    Utils::CellBucketGrid<dim> fluid_cell_index;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> indicator_band;
+    // Set when the fluid mesh changes, the next update is a full pass.
+    bool indicator_band_outdated;
+
+    // The solver states and times at the beginning of the time step, and the
+    // number of output records at that time, for the strongly coupled
+    // iterations.
+    PETScWrappers::MPI::Vector step_displacement;
+    PETScWrappers::MPI::Vector step_velocity;
+    PETScWrappers::MPI::Vector step_acceleration;
+    PETScWrappers::MPI::BlockVector step_fluid_solution;
+    PETScWrappers::MPI::BlockVector step_fluid_increment;
+    PETScWrappers::MPI::BlockVector step_fluid_previous;
+    double step_fluid_previous_delta_t;
+    Utils::Time::State step_solid_time;
+    Utils::Time::State step_fluid_time;
+    unsigned int step_solid_records;
+    unsigned int step_fluid_records;
+    // The FSI stress the solid was last solved with, its last residual, and
+    // the Aitken relaxation factor.
+    std::vector<Vector<double>> relaxed_stress;
+    std::vector<Vector<double>> stress_residual;
+    double relaxation;
+    // The last relative stress change, and the coupling iterations of every
+    // strongly coupled time step with it in fsi_coupling_log.csv.
+    double stress_change;
+    Utils::MonitorFile coupling_log;
+
+    // The extra weight of the artificial fluid cells in repartitioning, on
+    // top of the weight of 1000 that every cell has, and the connection to
+    // the fluid triangulation.
+    unsigned int artificial_weight;
+    boost::signals2::connection cell_weight_connection;
+
     bool use_dirichlet_bc;
   };
 } // namespace MPI
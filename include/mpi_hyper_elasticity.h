@@ -11,60 +11,8 @@
 
 #include "mpi_solid_solver.h"
 #include "neo_hookean.h"
-
-namespace Internal
-{
-  using namespace dealii;
-
-  /** \brief Data to store at the quadrature points.
-   *
-   * We cache the kinematics information at quadrature points
-   * by storing a PointHistory at each cell,
-   * so that they can be conveniently accessed in the assembly
-   * or post processing. We also store a material pointer
-   * in case different material properties are used at
-   * different locations.
-   */
-  template <int dim>
-  class PointHistory
-  {
-    using ST = Physics::Elasticity::StandardTensors<dim>;
-
-  public:
-    PointHistory()
-      : F_inv(ST::I),
-        tau(SymmetricTensor<2, dim>()),
-        Jc(SymmetricTensor<4, dim>()),
-        dPsi_vol_dJ(0.0),
-        d2Psi_vol_dJ2(0.0)
-    {
-    }
-    virtual ~PointHistory() {}
-    /** Initialize the members with the input parameters */
-    void setup(const Parameters::AllParameters &, const unsigned int &);
-    /**
-     * Update the state with the displacement gradient
-     * in the reference configuration.
-     */
-    void update(const Parameters::AllParameters &, const Tensor<2, dim> &);
-    double get_det_F() const { return material->get_det_F(); }
-    const Tensor<2, dim> &get_F_inv() const { return F_inv; }
-    const SymmetricTensor<2, dim> &get_tau() const { return tau; }
-    const SymmetricTensor<4, dim> &get_Jc() const { return Jc; }
-    double get_density() const { return material->get_density(); }
-    double get_dPsi_vol_dJ() const { return dPsi_vol_dJ; }
-    double get_d2Psi_vol_dJ2() const { return d2Psi_vol_dJ2; }
-
-  private:
-    /** The specific hyperelastic material to use. */
-    std::shared_ptr<Solid::HyperElasticMaterial<dim>> material;
-    Tensor<2, dim> F_inv;
-    SymmetricTensor<2, dim> tau;
-    SymmetricTensor<4, dim> Jc;
-    double dPsi_vol_dJ;
-    double d2Psi_vol_dJ2;
-  };
-} // namespace Internal
+#include "point_history.h"
+#include "preconditioner_pilut.h"
 
 namespace Solid
 {
@@ -87,6 +35,10 @@ namespace Solid
      *
      * Based on dealii tutorial [step-44]
      * (http://www.dealii.org/8.5.0/doxygen/deal.II/step_44.html)
+     *
+     * With the Matrix-free tangent, the Newton systems are solved by CG with
+     * the tangent applied cell by cell from the PointHistory. The tangent is
+     * only assembled once per mesh to build the preconditioner.
      */
     template <int dim>
     class HyperElasticity : public SolidSolver<dim>
@@ -118,15 +70,35 @@ namespace Solid
       using SolidSolver<dim>::mpi_communicator;
       using SolidSolver<dim>::pcout;
       using SolidSolver<dim>::time;
+      using SolidSolver<dim>::neumann_table;
       using SolidSolver<dim>::timer;
       using SolidSolver<dim>::locally_owned_dofs;
       using SolidSolver<dim>::locally_relevant_dofs;
+      using SolidSolver<dim>::solver_log;
 
       void initialize_system() override;
 
-      /** Assemble the lhs and rhs at the same time. */
+      /**
+       * Assemble the lhs and rhs at the same time. With the matrix-free
+       * tangent, the tangent is only assembled if there is no
+       * preconditioner.
+       */
       void assemble_system(bool);
 
+      /**
+       * The action of the Newton tangent
+       * \f$ \rho M / (\beta\Delta{t}^2) + K_t \f$ at the current
+       * PointHistory, with the rows of the identity for the constrained
+       * dofs, which is what the assembled tangent solves for.
+       */
+      void apply_tangent(PETScWrappers::MPI::Vector &,
+                         const PETScWrappers::MPI::Vector &) const;
+
+      /// Solve a Newton system with the matrix-free tangent.
+      std::pair<unsigned int, double>
+      solve_matrix_free(PETScWrappers::MPI::Vector &,
+                        const PETScWrappers::MPI::Vector &);
+
       /** Set up the quadrature point history. */
       void setup_qph();
 
@@ -142,13 +114,26 @@ namespace Solid
       void run_one_step(bool);
 
       /**
-       * We store a PointHistory structure at every quadrature point,
+       * We store the history of every quadrature point,
        * so that kinematics information like F as well as material properties
        * can be cached.
        */
-      CellDataStorage<typename Triangulation<dim>::cell_iterator,
-                      Internal::PointHistory<dim>>
-        quad_point_history;
+      Internal::HyperElasticPointHistory<dim> quad_point_history;
+
+      /// Whether the tangent is applied instead of assembled.
+      const bool matrix_free;
+
+      /// The preconditioner of the matrix-free tangent, reset with the mesh.
+      std::unique_ptr<PETScWrappers::PreconditionerBase>
+        tangent_preconditioner;
+
+      /// The locally owned constrained dofs.
+      std::vector<types::global_dof_index> constrained_dofs;
+
+      /// The argument of apply_tangent without the constrained entries, and
+      /// ghosted.
+      mutable PETScWrappers::MPI::Vector tangent_owned;
+      mutable PETScWrappers::MPI::Vector tangent_ghosted;
 
       double error_residual; //!< Norm of the residual at a Newton iteration.
       double initial_error_residual; //!< Norm of the residual at the first
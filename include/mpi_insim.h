@@ -1,7 +1,13 @@
 #ifndef MPI_INSIM
 #define MPI_INSIM
 
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/matrix_free.h>
+
 #include "mpi_fluid_solver.h"
+#include "multigrid_preconditioner.h"
+#include "preconditioner_pilut.h"
 
 namespace Fluid
 {
@@ -25,6 +31,9 @@ namespace Fluid
      * applied to solve the nonlinear system, thus the actual dofs being solved
      * is the velocity and pressure increment.
      *
+     * The time derivative is backward Euler or, if told so in the input file,
+     * the variable-step BDF2.
+     *
      * The final linear system to be solved is nonsymmetric. GMRES solver with
      * Grad-Div right preconditioner is applied, which does modify the linear
      * system
@@ -48,15 +57,19 @@ namespace Fluid
 
     private:
       class BlockSchurPreconditioner;
+      class SystemOperator;
 
       using FluidSolver<dim>::setup_dofs;
       using FluidSolver<dim>::make_constraints;
       using FluidSolver<dim>::setup_cell_property;
       using FluidSolver<dim>::initialize_system;
       using FluidSolver<dim>::refine_mesh;
+      using FluidSolver<dim>::print_memory_usage;
       using FluidSolver<dim>::output_results;
+      using FluidSolver<dim>::write_monitors;
       using FluidSolver<dim>::update_stress;
       using FluidSolver<dim>::save_checkpoint;
+      using FluidSolver<dim>::save_buddy_checkpoint;
       using FluidSolver<dim>::load_checkpoint;
 
       using FluidSolver<dim>::dofs_per_block;
@@ -69,11 +82,15 @@ namespace Fluid
       using FluidSolver<dim>::face_quad_formula;
       using FluidSolver<dim>::zero_constraints;
       using FluidSolver<dim>::nonzero_constraints;
-      using FluidSolver<dim>::sparsity_pattern;
       using FluidSolver<dim>::system_matrix;
       using FluidSolver<dim>::mass_matrix;
       using FluidSolver<dim>::mass_schur;
+      using FluidSolver<dim>::update_mass_schur;
       using FluidSolver<dim>::present_solution;
+      using FluidSolver<dim>::update_time_history;
+      using FluidSolver<dim>::time_history;
+      using FluidSolver<dim>::effective_delta_t;
+      using FluidSolver<dim>::record_previous_solution;
       using FluidSolver<dim>::solution_increment;
       using FluidSolver<dim>::system_rhs;
       using FluidSolver<dim>::fsi_acceleration;
@@ -88,8 +105,16 @@ namespace Fluid
       using FluidSolver<dim>::locally_relevant_scalar_dofs;
       using FluidSolver<dim>::times_and_names;
       using FluidSolver<dim>::time;
+      using FluidSolver<dim>::preconditioner_reuse;
+      using FluidSolver<dim>::cell_fe_data;
+      using FluidSolver<dim>::interior_cells;
+      using FluidSolver<dim>::ghost_touching_cells;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::solution_predictor;
+      using FluidSolver<dim>::forcing_term;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::solver_log;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::boundary_values;
 
@@ -97,9 +122,12 @@ namespace Fluid
       /// the dofs and constraints.
       void initialize_system() override;
 
+      /// Add the preconditioner to the memory of the base solver.
+      void add_memory_usage(Utils::MemoryReport &) const override;
+
       /*! \brief Assemble the system matrix, mass mass matrix, and the RHS.
        *
-       *  Since backward Euler method is used, the linear system must be
+       *  Since an implicit method is used, the linear system must be
        * reassembled
        *  at every Newton iteration. The Dirichlet BCs are applied at the same
        * time
@@ -140,9 +168,30 @@ namespace Fluid
        */
       PETScWrappers::MPI::BlockVector evaluation_point;
 
+      /// The ghost values of evaluation_point after a Newton update, which
+      /// arrive during the assembly of the interior cells.
+      Utils::GhostUpdate evaluation_point_update;
+
       /// The BlockSchurPreconditioner for the entire system.
       std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+      /// The matrix-free system operator, only used if told so in the input
+      /// parameters.
+      std::shared_ptr<SystemOperator> system_operator;
+
+      /// The geometric multigrid of the velocity block and of the pressure
+      /// Laplacian, only built if chosen in the input parameters. Their
+      /// hierarchies are rebuilt in initialize_system().
+      std::shared_ptr<PreconditionGMG<dim, dim>> velocity_multigrid;
+      std::shared_ptr<PreconditionGMG<dim, 1>> pressure_multigrid;
+
+      /// The mass term that keeps the pressure Laplacian nonsingular.
+      double pressure_multigrid_mass;
+
+      /// The preconditioner of the CG solve of the mass Schur complement,
+      /// which is rebuilt with it.
+      std::shared_ptr<PETScWrappers::PreconditionerBase> schur_preconditioner;
+
       /** \brief Block preconditioner for the system
        *
        * A right block preconditioner is defined here:
@@ -153,9 +202,8 @@ namespace Fluid
        * \f}
        *
        * \f$\tilde{A}\f$ is unsymmetric thanks to the convection term.
-       * We do not have a nice way to deal with other than using a direct
-       * solver. (Geometric multigrid is the right way to go if only you are
-       * brave enough to implement it.)
+       * It is either solved directly, or approximated by AMG or by geometric
+       * multigrid of its symmetric part, optionally within GMRES.
        *
        * \f$\tilde{S}^{-1}\f$ is the inverse of the total Schur complement,
        * which consists of a reaction term, a diffusion term, a Grad-Div term
@@ -191,12 +239,39 @@ namespace Fluid
           const std::vector<IndexSet> &owned_partitioning,
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           const PETScWrappers::MPI::BlockSparseMatrix &mass,
-          PETScWrappers::MPI::BlockSparseMatrix &schur);
+          const PETScWrappers::MPI::BlockSparseMatrix &schur,
+          const Parameters::PreconditionerSettings &velocity_preconditioner,
+          std::shared_ptr<PETScWrappers::PreconditionerBase> velocity_multigrid,
+          std::shared_ptr<PETScWrappers::PreconditionerBase>
+            schur_preconditioner,
+          double velocity_tolerance,
+          bool lagged);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
                    const PETScWrappers::MPI::BlockVector &src) const;
 
+        /// The number of applications of \f$\tilde{A}^{-1}\f$ and the total
+        /// number of AMG preconditioned GMRES iterations in them.
+        std::pair<unsigned int, unsigned int> velocity_statistics() const
+        {
+          return {velocity_applications, velocity_iterations};
+        }
+
+        /// The total iterations of the inner solves, one per application
+        /// for MUMPS.
+        std::map<std::string, unsigned int> inner_iterations() const
+        {
+          return {{"Mp", mp_iterations},
+                  {"Sm", sm_iterations},
+                  {"A", A_amg ? velocity_iterations : velocity_applications}};
+        }
+
+        /// The memory of the lagged velocity block and the temporary
+        /// vectors. The MUMPS factors are not visible through
+        /// SparseDirectMUMPS.
+        std::size_t memory_consumption() const;
+
       private:
         TimerOutput &timer2;
         const double gamma;
@@ -218,9 +293,13 @@ namespace Fluid
          * computation to construct the matrix, but leads to slow convergence in
          * CG solver because of the absence of preconditioner. Based on my
          * tests, the first approach is more than 10 times faster so I go with
-         * this route.
+         * this route. It is computed by the solver, see update_mass_schur().
          */
-        const SmartPointer<PETScWrappers::MPI::BlockSparseMatrix> mass_schur;
+        const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
+          mass_schur;
+
+        /// The preconditioner of the CG solve of the mass Schur complement.
+        std::shared_ptr<PETScWrappers::PreconditionerBase> Sm_preconditioner;
 
         /// A dummy solver control object for MUMPS solver
         SolverControl dummy_sc;
@@ -231,6 +310,114 @@ namespace Fluid
          * reset and the matrix does not change.
          */
         mutable PETScWrappers::SparseDirectMUMPS A_inverse;
+
+        /**
+         * If the preconditioner is reused while the system matrix changes,
+         * MUMPS factorizes this copy of the velocity block instead, so that
+         * the factorization is kept.
+         */
+        PETScWrappers::MPI::SparseMatrix A_lagged;
+        const PETScWrappers::MPI::SparseMatrix *A_matrix;
+
+        /**
+         * The alternative to A_inverse built by make_preconditioner(), e.g.
+         * hypre BoomerAMG or Trilinos ML or MueLu, or the geometric multigrid
+         * of the solver, applied either once or as the preconditioner of
+         * GMRES with the given relative tolerance.
+         */
+        const double velocity_tolerance;
+        std::shared_ptr<PETScWrappers::PreconditionerBase> A_amg;
+        mutable unsigned int velocity_applications;
+        mutable unsigned int velocity_iterations;
+        mutable unsigned int mp_iterations;
+        mutable unsigned int sm_iterations;
+
+        /// Temporary vectors of the velocity and pressure blocks, allocated
+        /// with the partitioning at construction and reused by every vmult.
+        mutable PETScWrappers::MPI::Vector utmp;
+        mutable PETScWrappers::MPI::Vector ptmp;
+      };
+
+      /** \brief Matrix-free application of the linearized system.
+       *
+       * The operator is the same as the assembled system matrix: the
+       * linearized diffusion, convection, Grad-Div, continuity and inertial
+       * terms are evaluated with sum factorization at the quadrature points
+       * of the cells. The velocity and its gradient at the linearization
+       * point are cached at the quadrature points by update().
+       *
+       * The hanging node constraints are resolved by MatrixFree, while the
+       * Dirichlet constraints change at every time step in FSI. Therefore the
+       * rows of all the constrained dofs are taken from the diagonal of the
+       * assembled matrix, and their columns are zeroed, which is what
+       * distribute_local_to_global does to the assembled matrix.
+       *
+       * MatrixFree works on LinearAlgebra::distributed vectors, so the
+       * PETSc vectors are copied in and out of them in vmult.
+       */
+      class SystemOperator : public Subscriptor
+      {
+      public:
+        /// Set up the MatrixFree data, which must be called after the mesh
+        /// changes.
+        void reinit(const DoFHandler<dim> &dof_handler,
+                    const std::vector<IndexSet> &owned_partitioning,
+                    const IndexSet &locally_relevant_dofs,
+                    const unsigned int velocity_degree);
+
+        /// Cache the linearization point and the constrained rows.
+        void update(const PETScWrappers::MPI::BlockVector &evaluation_point,
+                    const AffineConstraints<double> &constraints,
+                    const PETScWrappers::MPI::BlockSparseMatrix &system,
+                    double viscosity,
+                    double gamma,
+                    double rho,
+                    double dt);
+
+        /// The matrix-vector multiplication used by the Krylov solver.
+        void vmult(PETScWrappers::MPI::BlockVector &dst,
+                   const PETScWrappers::MPI::BlockVector &src) const;
+
+      private:
+        using VectorType = LinearAlgebra::distributed::Vector<double>;
+
+        /// Apply the operator on a range of cell batches.
+        void local_apply(const MatrixFree<dim, double> &data,
+                         VectorType &dst,
+                         const VectorType &src,
+                         const std::pair<unsigned int, unsigned int> &range)
+          const;
+
+        /// Copy the locally owned entries between the vector types.
+        void copy_to(const PETScWrappers::MPI::BlockVector &, VectorType &)
+          const;
+        void copy_from(const VectorType &,
+                       PETScWrappers::MPI::BlockVector &) const;
+
+        MatrixFree<dim, double> matrix_free;
+        AffineConstraints<double> hanging_node_constraints;
+
+        /// The global indices of the locally owned dofs of every block.
+        std::vector<std::vector<types::global_dof_index>> block_indices;
+        std::vector<types::global_dof_index> block_offsets;
+
+        /// The velocity and its gradient at the linearization point.
+        Table<2, Tensor<1, dim, VectorizedArray<double>>> velocity_values;
+        Table<2, Tensor<2, dim, VectorizedArray<double>>> velocity_gradients;
+
+        /// The locally owned constrained dofs and their diagonal entries.
+        std::vector<types::global_dof_index> constrained_dofs;
+        std::vector<double> constrained_diagonal;
+
+        double viscosity;
+        double gamma;
+        double rho;
+        double dt;
+
+        mutable VectorType src_buffer;
+        mutable VectorType dst_buffer;
+        mutable std::vector<double> values_buffer;
+        mutable std::vector<double> constrained_values;
       };
     };
   } // namespace MPI
@@ -2,6 +2,7 @@
 #define MPI_INS_IMEX
 
 #include "mpi_fluid_solver.h"
+#include "preconditioner_pilut.h"
 
 namespace Fluid
 {
@@ -50,9 +51,12 @@ namespace Fluid
       using FluidSolver<dim>::setup_cell_property;
       using FluidSolver<dim>::initialize_system;
       using FluidSolver<dim>::refine_mesh;
+      using FluidSolver<dim>::print_memory_usage;
       using FluidSolver<dim>::output_results;
+      using FluidSolver<dim>::write_monitors;
       using FluidSolver<dim>::update_stress;
       using FluidSolver<dim>::save_checkpoint;
+      using FluidSolver<dim>::save_buddy_checkpoint;
       using FluidSolver<dim>::load_checkpoint;
 
       using FluidSolver<dim>::dofs_per_block;
@@ -65,10 +69,10 @@ namespace Fluid
       using FluidSolver<dim>::face_quad_formula;
       using FluidSolver<dim>::zero_constraints;
       using FluidSolver<dim>::nonzero_constraints;
-      using FluidSolver<dim>::sparsity_pattern;
       using FluidSolver<dim>::system_matrix;
       using FluidSolver<dim>::mass_matrix;
       using FluidSolver<dim>::mass_schur;
+      using FluidSolver<dim>::update_mass_schur;
       using FluidSolver<dim>::present_solution;
       using FluidSolver<dim>::system_rhs;
       using FluidSolver<dim>::fsi_acceleration;
@@ -82,8 +86,13 @@ namespace Fluid
       using FluidSolver<dim>::locally_relevant_scalar_dofs;
       using FluidSolver<dim>::times_and_names;
       using FluidSolver<dim>::time;
+      using FluidSolver<dim>::preconditioner_reuse;
+      using FluidSolver<dim>::cell_fe_data;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::solution_predictor;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::solver_log;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::boundary_values;
 
@@ -110,7 +119,14 @@ namespace Fluid
       std::pair<unsigned int, double> solve(bool use_nonzero_constraints,
                                             bool assemble_system);
 
-      /// Run the simulation for one time step.
+      /*! \brief Run the simulation for one time step.
+       *
+       *  The system matrix only depends on the mesh, the constraints and the
+       *  time step, so it is cached and only the RHS is assembled, unless the
+       *  nonzero constraints are applied: their inhomogeneities need the cell
+       *  matrices, and in FSI they change at every time step. The second
+       *  argument is therefore ignored.
+       */
       void run_one_step(bool apply_nonzero_constraints,
                         bool assemble_system = true) override;
 
@@ -120,6 +136,11 @@ namespace Fluid
       /// The BlockSchurPreconditioner for the entire system.
       std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+      /// Set when the mesh changes, the system matrix must be reassembled.
+      bool matrix_outdated;
+      /// The time step size the system matrix was assembled with.
+      double matrix_delta_t;
+
       /** \brief Block preconditioner for the system
        *
        * A right block preconditioner is defined here:
@@ -166,12 +187,21 @@ namespace Fluid
           const std::vector<IndexSet> &owned_partitioning,
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           const PETScWrappers::MPI::BlockSparseMatrix &mass,
-          PETScWrappers::MPI::BlockSparseMatrix &schur);
+          const PETScWrappers::MPI::BlockSparseMatrix &schur,
+          const Parameters::PreconditionerSettings &velocity_preconditioner);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
                    const PETScWrappers::MPI::BlockVector &src) const;
 
+        /// The total iterations of the inner CG solves.
+        std::map<std::string, unsigned int> inner_iterations() const
+        {
+          return {{"Mp", mp_iterations},
+                  {"Sm", sm_iterations},
+                  {"A", a_iterations}};
+        }
+
       private:
         TimerOutput &timer2;
         const double gamma;
@@ -196,7 +226,20 @@ namespace Fluid
          * I
          * go with this route.
          */
-        const SmartPointer<PETScWrappers::MPI::BlockSparseMatrix> mass_schur;
+        const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
+          mass_schur;
+
+        /// The preconditioner of the inner CG solves of the velocity block.
+        std::unique_ptr<PETScWrappers::PreconditionerBase> A_preconditioner;
+
+        /// Temporary vectors of the velocity and pressure blocks, allocated
+        /// with the partitioning at construction and reused by every vmult.
+        mutable PETScWrappers::MPI::Vector utmp;
+        mutable PETScWrappers::MPI::Vector ptmp;
+
+        mutable unsigned int mp_iterations;
+        mutable unsigned int sm_iterations;
+        mutable unsigned int a_iterations;
       };
     };
   } // namespace MPI
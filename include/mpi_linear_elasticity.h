@@ -70,6 +70,7 @@ namespace Solid
       using SolidSolver<dim>::mpi_communicator;
       using SolidSolver<dim>::pcout;
       using SolidSolver<dim>::time;
+      using SolidSolver<dim>::neumann_table;
       using SolidSolver<dim>::timer;
       using SolidSolver<dim>::locally_owned_dofs;
       using SolidSolver<dim>::locally_relevant_dofs;
@@ -26,6 +26,9 @@ namespace Fluid
      * applied to solve the nonlinear system, thus the actual dofs being solved
      * is the velocity and pressure increment.
      *
+     * The time derivative is backward Euler or, if told so in the input file,
+     * the variable-step BDF2.
+     *
      * The final linear system to be solved is nonsymmetric. GMRES solver with
      * SUPG incomplete Schur complement right preconditioner is applied, which
      * does modify the linear system a little bit, and requires the velocity
@@ -58,8 +61,11 @@ namespace Fluid
       using FluidSolver<dim>::make_constraints;
       using FluidSolver<dim>::setup_cell_property;
       using FluidSolver<dim>::refine_mesh;
+      using FluidSolver<dim>::print_memory_usage;
       using FluidSolver<dim>::output_results;
+      using FluidSolver<dim>::write_monitors;
       using FluidSolver<dim>::save_checkpoint;
+      using FluidSolver<dim>::save_buddy_checkpoint;
       using FluidSolver<dim>::load_checkpoint;
       using FluidSolver<dim>::update_stress;
 
@@ -73,9 +79,15 @@ namespace Fluid
       using FluidSolver<dim>::face_quad_formula;
       using FluidSolver<dim>::zero_constraints;
       using FluidSolver<dim>::nonzero_constraints;
-      using FluidSolver<dim>::sparsity_pattern;
       using FluidSolver<dim>::system_matrix;
       using FluidSolver<dim>::present_solution;
+      using FluidSolver<dim>::previous_solution;
+      using FluidSolver<dim>::previous_delta_t;
+      using FluidSolver<dim>::bdf2_history;
+      using FluidSolver<dim>::update_time_history;
+      using FluidSolver<dim>::time_history;
+      using FluidSolver<dim>::effective_delta_t;
+      using FluidSolver<dim>::record_previous_solution;
       using FluidSolver<dim>::solution_increment;
       using FluidSolver<dim>::system_rhs;
       using FluidSolver<dim>::fsi_acceleration;
@@ -90,8 +102,16 @@ namespace Fluid
       using FluidSolver<dim>::locally_relevant_scalar_dofs;
       using FluidSolver<dim>::times_and_names;
       using FluidSolver<dim>::time;
+      using FluidSolver<dim>::preconditioner_reuse;
+      using FluidSolver<dim>::cell_fe_data;
+      using FluidSolver<dim>::interior_cells;
+      using FluidSolver<dim>::ghost_touching_cells;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::solution_predictor;
+      using FluidSolver<dim>::forcing_term;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::solver_log;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::boundary_values;
 
@@ -99,9 +119,13 @@ namespace Fluid
       /// the dofs and constraints.
       virtual void initialize_system() override;
 
+      /// Evaluate sigma_pml_field at the quadrature points of the cells once
+      /// per mesh, keeping the values of the cells inside the PML only.
+      void setup_pml();
+
       /*! \brief Assemble the system matrix, mass mass matrix, and the RHS.
        *
-       *  Since backward Euler method is used, the linear system must be
+       *  Since an implicit method is used, the linear system must be
        * reassembled
        *  at every Newton iteration. The Dirichlet BCs are applied at the same
        * time
@@ -153,6 +177,10 @@ namespace Fluid
        */
       PETScWrappers::MPI::BlockVector evaluation_point;
 
+      /// The ghost values of evaluation_point after a Newton update, which
+      /// arrive during the assembly of the interior cells.
+      Utils::GhostUpdate evaluation_point_update;
+
       /// The BlockIncompSchurPreconditioner for the entire system.
       std::shared_ptr<BlockIncompSchurPreconditioner> preconditioner;
 
@@ -164,6 +192,11 @@ namespace Fluid
        */
       std::shared_ptr<Function<dim>> sigma_pml_field;
 
+      /// The sigma PML values at the quadrature points of the active cells,
+      /// indexed by the active cell index. It is empty for the cells outside
+      /// the PML, where sigma vanishes.
+      std::vector<std::vector<double>> cell_sigma_pml;
+
       /// Hard-coded body force. It will be added onto gravity.
       std::shared_ptr<TensorFunction<1, dim>> body_force;
 
@@ -194,7 +227,9 @@ namespace Fluid
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           PETScWrappers::MPI::SparseMatrix &absA,
           PETScWrappers::MPI::SparseMatrix &schur,
-          PETScWrappers::MPI::SparseMatrix &B2pp);
+          PETScWrappers::MPI::SparseMatrix &B2pp,
+          const Parameters::PreconditionerSettings &velocity_preconditioner,
+          const Parameters::PreconditionerSettings &pressure_preconditioner);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
@@ -234,12 +269,20 @@ namespace Fluid
         const SmartPointer<PETScWrappers::MPI::SparseMatrix> schur_matrix;
         const SmartPointer<PETScWrappers::MPI::SparseMatrix> B2pp_matrix;
 
-        PreconditionEuclid Pvv_inverse;
-        PreconditionEuclid B2pp_inverse;
+        /// Built by make_preconditioner(), Euclid ILU by default.
+        std::unique_ptr<PETScWrappers::PreconditionerBase> Pvv_inverse;
+        std::unique_ptr<PETScWrappers::PreconditionerBase> B2pp_inverse;
 
         std::shared_ptr<SchurComplementTpp> Tpp;
         // iteration counter for solving Tpp
         mutable int Tpp_itr;
+        /// Temporary vectors of the velocity and pressure blocks, allocated
+        /// with the partitioning at construction and reused by every vmult.
+        mutable PETScWrappers::MPI::Vector utmp1;
+        mutable PETScWrappers::MPI::Vector utmp2;
+        mutable PETScWrappers::MPI::Vector ptmp;
+        mutable PETScWrappers::MPI::Vector guess;
+        mutable PETScWrappers::MPI::Vector Tpp_guess;
         class SchurComplementTpp : public Subscriptor
         {
         public:
@@ -256,7 +299,10 @@ namespace Fluid
           const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
             system_matrix;
           const PETScWrappers::PreconditionerBase *Pvv_inverse;
-          PETScWrappers::MPI::BlockVector dumb_vector;
+          /// Temporary vectors reused by every vmult.
+          mutable PETScWrappers::MPI::Vector tmp1;
+          mutable PETScWrappers::MPI::Vector tmp2;
+          mutable PETScWrappers::MPI::Vector tmp3;
         };
       };
     };
@@ -11,60 +11,7 @@
 
 #include "mpi_shared_solid_solver.h"
 #include "neo_hookean.h"
-
-namespace Internal
-{
-  using namespace dealii;
-
-  /** \brief Data to store at the quadrature points.
-   *
-   * We cache the kinematics information at quadrature points
-   * by storing a PointHistory at each cell,
-   * so that they can be conveniently accessed in the assembly
-   * or post processing. We also store a material pointer
-   * in case different material properties are used at
-   * different locations.
-   */
-  template <int dim>
-  class PointHistory
-  {
-    using ST = Physics::Elasticity::StandardTensors<dim>;
-
-  public:
-    PointHistory()
-      : F_inv(ST::I),
-        tau(SymmetricTensor<2, dim>()),
-        Jc(SymmetricTensor<4, dim>()),
-        dPsi_vol_dJ(0.0),
-        d2Psi_vol_dJ2(0.0)
-    {
-    }
-    virtual ~PointHistory() {}
-    /** Initialize the members with the input parameters */
-    void setup(const Parameters::AllParameters &, const unsigned int &);
-    /**
-     * Update the state with the displacement gradient
-     * in the reference configuration.
-     */
-    void update(const Parameters::AllParameters &, const Tensor<2, dim> &);
-    double get_det_F() const { return material->get_det_F(); }
-    const Tensor<2, dim> &get_F_inv() const { return F_inv; }
-    const SymmetricTensor<2, dim> &get_tau() const { return tau; }
-    const SymmetricTensor<4, dim> &get_Jc() const { return Jc; }
-    double get_density() const { return material->get_density(); }
-    double get_dPsi_vol_dJ() const { return dPsi_vol_dJ; }
-    double get_d2Psi_vol_dJ2() const { return d2Psi_vol_dJ2; }
-
-  private:
-    /** The specific hyperelastic material to use. */
-    std::shared_ptr<Solid::HyperElasticMaterial<dim>> material;
-    Tensor<2, dim> F_inv;
-    SymmetricTensor<2, dim> tau;
-    SymmetricTensor<4, dim> Jc;
-    double dPsi_vol_dJ;
-    double d2Psi_vol_dJ2;
-  };
-} // namespace Internal
+#include "point_history.h"
 
 namespace Solid
 {
@@ -93,7 +40,8 @@ namespace Solid
     {
     public:
       SharedHyperElasticity(Triangulation<dim> &,
-                            const Parameters::AllParameters &);
+                            const Parameters::AllParameters &,
+                            MPI_Comm communicator = MPI_COMM_WORLD);
       ~SharedHyperElasticity() {}
 
     private:
@@ -123,18 +71,49 @@ namespace Solid
       using SharedSolidSolver<dim>::this_mpi_process;
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
+      using SharedSolidSolver<dim>::neumann_table;
       using SharedSolidSolver<dim>::timer;
+      using SharedSolidSolver<dim>::solver_log;
       using SharedSolidSolver<dim>::locally_owned_dofs;
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
       using SharedSolidSolver<dim>::times_and_names;
+      using SharedSolidSolver<dim>::recover_strain_and_stress;
 
       void initialize_system() override;
 
       virtual void update_strain_and_stress() override;
 
+      /// Add the quadrature point history to the memory of the base solver.
+      void add_memory_usage(Utils::MemoryReport &) const override;
+
+      /**
+       * Assemble the lhs and rhs at the same time. If assemble_matrix is false,
+       * only the rhs is assembled and the system matrix is left untouched.
+       */
+      void assemble(bool initial_step, bool assemble_matrix);
+
       /** Assemble the lhs and rhs at the same time. */
-      void assemble_system(bool);
+      void assemble_system(bool initial_step);
+
+      /** Assemble only the rhs, the tangent is kept. */
+      void assemble_rhs();
+
+      /**
+       * Update the quadrature point history with current_displacement and
+       * assemble the external minus the internal force.
+       */
+      virtual void assemble_explicit_rhs() override;
+
+      /**
+       * Apply a Newton update to the current displacement with a backtracking
+       * line search on the residual norm, and update the quadrature point
+       * history. Returns the accepted step length.
+       */
+      double
+      line_search(const PETScWrappers::MPI::Vector &predicted_displacement,
+                  const PETScWrappers::MPI::Vector &newton_update,
+                  unsigned int &n_residual_assemblies);
 
       /** Set up the quadrature point history. */
       void setup_qph();
@@ -151,13 +130,14 @@ namespace Solid
       void run_one_step(bool);
 
       /**
-       * We store a PointHistory structure at every quadrature point,
+       * We store the history of every quadrature point,
        * so that kinematics information like F as well as material properties
        * can be cached.
        */
-      CellDataStorage<typename Triangulation<dim>::cell_iterator,
-                      Internal::PointHistory<dim>>
-        quad_point_history;
+      Internal::HyperElasticPointHistory<dim> quad_point_history;
+
+      /// Decide when the tangent is reassembled in the Newton iterations.
+      Utils::PreconditionerReuse tangent_reuse;
 
       double error_residual; //!< Norm of the residual at a Newton iteration.
       double initial_error_residual; //!< Norm of the residual at the first
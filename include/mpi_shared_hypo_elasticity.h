@@ -32,7 +32,8 @@ namespace Solid
       SharedHypoElasticity(Triangulation<dim> &,
                            const Parameters::AllParameters &,
                            double dx,
-                           double hdx);
+                           double hdx,
+                           MPI_Comm communicator = MPI_COMM_WORLD);
       ~SharedHypoElasticity() {}
 
     private:
@@ -60,6 +61,7 @@ namespace Solid
       using SharedSolidSolver<dim>::mpi_communicator;
       using SharedSolidSolver<dim>::n_mpi_processes;
       using SharedSolidSolver<dim>::this_mpi_process;
+      using SharedSolidSolver<dim>::writes_output;
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
       using SharedSolidSolver<dim>::timer;
@@ -67,8 +69,14 @@ namespace Solid
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
       using SharedSolidSolver<dim>::times_and_names;
+      using SharedSolidSolver<dim>::restored_state;
 
-      void initialize_system() override;
+      /// The particles on every process read the FSI stress on all the
+      /// boundary faces of their body.
+      bool fsi_stress_rows_owned_only() const override { return false; }
+
+      /// The particles keep their own state which cannot be restored.
+      bool step_repeatable() const override { return false; }
 
       virtual void update_strain_and_stress() override;
 
@@ -78,27 +86,60 @@ namespace Solid
       /// Run one time step.
       void run_one_step(bool);
 
-      virtual void save_checkpoint(const int) override;
+      /// Save the stress at the quadrature points with the solution.
+      virtual void
+      stage_checkpoint(std::vector<Vector<double>> &) const override;
 
       virtual bool load_checkpoint() override;
 
+      /**
+       * The particles of this process: the vertices and quadrature points of
+       * its own cells and of the halo around them, which is deep enough for
+       * its own particles to be stepped as in the whole body.
+       */
       std::unique_ptr<body<dim>> m_body;
 
+      /// The particle of every vertex in the body, -1 for the others.
       std::vector<int> vertex_mapping;
 
+      /// Whether every active cell is in the body.
+      std::vector<bool> local_cells;
+
+      /// Build the body of this process and the exchange of its halo.
+      /// Collective.
       void construct_particles();
 
+      /// Copy the particles and quadrature points of the halo from their
+      /// owners after a step. Collective.
+      void update_halo();
+
       void synchronize();
 
-      double dx;
+      /// Write the nodal values of the owned dofs to the distributed vectors.
+      void distribute();
 
-      double hdx;
+      /// Write the particles of the body, the halo included.
+      void output_particles() const;
 
-      Vector<double> serialized_displacement;
+      double dx;
 
-      Vector<double> serialized_velocity;
+      double hdx;
 
-      Vector<double> serialized_acceleration;
+      /// The owned dofs, and the particle and component each is read from.
+      std::vector<PETScWrappers::MPI::Vector::size_type> owned_dofs;
+      std::vector<std::pair<unsigned int, unsigned int>> owned_dof_particles;
+
+      /// The particles and quadrature points of the body exchanged with
+      /// another process, in the same order on both sides.
+      struct HaloPart
+      {
+        std::vector<unsigned int> particles;
+        std::vector<unsigned int> quad_points;
+      };
+      /// Those this process owns and sends, and those of the halo it
+      /// receives, by process.
+      std::map<unsigned int, HaloPart> halo_sent;
+      std::map<unsigned int, HaloPart> halo_received;
     };
   } // namespace MPI
 } // namespace Solid
@@ -3,6 +3,7 @@
 
 #include "linear_elastic_material.h"
 #include "mpi_shared_solid_solver.h"
+#include "preconditioner_pilut.h"
 
 namespace Solid
 {
@@ -44,7 +45,8 @@ namespace Solid
        * Also we use a parameter handler to specify all the input parameters.
        */
       SharedLinearElasticity(Triangulation<dim> &,
-                             const Parameters::AllParameters &);
+                             const Parameters::AllParameters &,
+                             MPI_Comm communicator = MPI_COMM_WORLD);
       /*! \brief Destructor. */
       ~SharedLinearElasticity() {}
 
@@ -75,18 +77,33 @@ namespace Solid
       using SharedSolidSolver<dim>::this_mpi_process;
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
+      using SharedSolidSolver<dim>::neumann_table;
       using SharedSolidSolver<dim>::timer;
+      using SharedSolidSolver<dim>::solver_log;
       using SharedSolidSolver<dim>::locally_owned_dofs;
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
       using SharedSolidSolver<dim>::times_and_names;
+      using SharedSolidSolver<dim>::recover_strain_and_stress;
 
       /**
        * Assembles lhs and rhs. At time step 0, the lhs is the mass matrix;
        * at all the following steps, it is \f$ M + \beta{\Delta{t}}^2K \f$.
+       * If assemble_matrix is false, only the rhs is assembled, which
+       * includes the internal force with the explicit integrator.
+       */
+      void assemble(bool is_initial, bool assemble_matrix);
+
+      /**
+       * Assembles both the LHS and RHS of the system.
        */
       void assemble_system(bool is_initial);
 
+      /**
+       * Assembles the external minus the internal force, not any matrix.
+       */
+      virtual void assemble_explicit_rhs() override;
+
       /**
        * Update the strain and stress, used in output_results and FSI.
        */
@@ -94,7 +111,19 @@ namespace Solid
 
       void run_one_step(bool first_step);
 
+      /**
+       * Solve the effective system for the current acceleration. Unless
+       * disabled in the parameters, the system matrix is factorized at the
+       * first call and reused until it is invalidated.
+       */
+      std::pair<unsigned int, double>
+      solve_effective_system(const PETScWrappers::MPI::Vector &);
+
       std::vector<LinearElasticMaterial<dim>> material;
+
+      PreconditionMUMPS system_factorization;
+      double factorized_delta_t; //!< The time step of the factorization,
+                                 //! 0 if there is none.
     };
   } // namespace MPI
 } // namespace Solid
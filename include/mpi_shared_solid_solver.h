@@ -9,6 +9,7 @@
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/dofs/dof_handler.h>
@@ -22,6 +23,7 @@
 #include <deal.II/fe/fe_tools.h>
 #include <deal.II/fe/fe_values.h>
 
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_in.h>
 #include <deal.II/grid/grid_out.h>
@@ -41,6 +43,7 @@
 #include <deal.II/lac/precondition.h>
 #include <deal.II/lac/solver_cg.h>
 #include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
 #include <deal.II/lac/sparsity_tools.h>
 #include <deal.II/lac/vector.h>
 
@@ -55,11 +58,16 @@
 #include <deal.II/distributed/solution_transfer.h>
 #include <deal.II/distributed/tria.h>
 
+#include <cstdint>
+#include <cstring>
 #include <experimental/filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 
 #include "parameters.h"
+#include "preconditioner_pilut.h"
 #include "utilities.h"
 
 namespace fs = std::experimental::filesystem;
@@ -68,6 +76,8 @@ namespace MPI
 {
   template <int dim>
   class FSI;
+  template <int dim>
+  class ConcurrentFSI;
 }
 
 namespace Solid
@@ -83,12 +93,25 @@ namespace Solid
     public:
       //! FSI solver need access to the private members of this solver.
       friend ::MPI::FSI<spacedim>;
+      friend ::MPI::ConcurrentFSI<spacedim>;
 
+      /**
+       * All the linear algebra of the solid runs on the given communicator.
+       * MPI::FSI requires it to span all the processes, or to be one of
+       * equal groups that cover them, and runs the solid and the fluid one
+       * after the other on every process. MPI::ConcurrentFSI requires it to
+       * be the first processes, which solve the solid while the others solve
+       * the fluid.
+       */
       SharedSolidSolver(Triangulation<dim, spacedim> &,
-                        const Parameters::AllParameters &);
+                        const Parameters::AllParameters &,
+                        MPI_Comm communicator = MPI_COMM_WORLD);
       ~SharedSolidSolver();
       void run();
       PETScWrappers::MPI::Vector get_current_solution() const;
+      /// Print the memory of the solver components over the ranks.
+      /// Collective.
+      void print_memory_usage() const;
 
     protected:
       struct CellProperty;
@@ -110,10 +133,16 @@ namespace Solid
       virtual void assemble_system(bool) = 0;
 
       /**
-       * Update the cached strain and stress to output.
+       * Update the cached strain and stress to output. Only called by
+       * output_results when they are written.
        */
       virtual void update_strain_and_stress() = 0;
 
+      /**
+       * Add the memory of the components on this rank to a report.
+       */
+      virtual void add_memory_usage(Utils::MemoryReport &) const;
+
       /**
        * Run one time step.
        */
@@ -128,27 +157,127 @@ namespace Solid
             PETScWrappers::MPI::Vector &,
             const PETScWrappers::MPI::Vector &);
 
+      /**
+       * Build the preconditioner selected in the parameters for a matrix.
+       * If it is to be reused, it is built on a copy of the matrix, which
+       * keeps it valid while the matrix is reassembled.
+       */
+      void setup_preconditioner(const PETScWrappers::MPI::SparseMatrix &);
+
+      /**
+       * Assemble the external force minus the internal force at
+       * current_displacement into system_rhs, which is what the explicit
+       * time integrator needs. Solvers without it throw.
+       */
+      virtual void assemble_explicit_rhs();
+
+      /**
+       * Assemble the row-sum lumped mass matrix and store its inverse.
+       */
+      void assemble_lumped_mass();
+
+      /**
+       * Estimate the critical time step of the central difference method
+       * from the smallest node spacing and the dilatational wave speed.
+       */
+      double estimate_stable_time_step() const;
+
+      /**
+       * Run one time step with the explicit central difference method,
+       * which is the Newmark method with \f$\beta = 0\f$ and a lumped mass.
+       */
+      void run_one_explicit_step(bool);
+
+      /**
+       * Evaluate the strain and the stress at the quadrature points of a
+       * locally owned cell. The evaluator is called from several threads at
+       * once, each with its own FEValues on fe, which is not reinitialized
+       * and can compute the gradients.
+       */
+      using QuadratureEvaluator = std::function<void(
+        const typename DoFHandler<dim, spacedim>::active_cell_iterator &,
+        FEValues<dim, spacedim> &,
+        std::vector<Tensor<2, spacedim>> &,
+        std::vector<Tensor<2, spacedim>> &)>;
+
+      /**
+       * Recover the nodal strain and stress from their values at the
+       * quadrature points in a single pass over the locally owned cells.
+       * All the components and the weight of every scalar dof are
+       * accumulated together in one multi-component vector, then scattered
+       * to strain and stress.
+       */
+      void recover_strain_and_stress(const QuadratureEvaluator &);
+
       /**
        * Output the time-dependent solution in vtu format.
        */
       void output_results(const unsigned int);
 
+      /**
+       * Record the displacement in the steady state monitor. Once the run is
+       * steady, write the final output and checkpoint if they have not been
+       * written at this step and return true. Collective.
+       */
+      bool reached_steady_state();
+
+      /**
+       * Append the displacement at the probes to the monitor file if it is
+       * time to. Collective.
+       */
+      void write_monitors();
+
       /**
        * Refine mesh and transfer solution.
        */
       void refine_mesh(const unsigned int, const unsigned int);
 
+      /**
+       * Whether this process only reads fsi_stress_rows on the boundary faces
+       * of its locally owned cells. If so the FSI solver only sends it these
+       * entries, otherwise every process receives the whole vectors.
+       */
+      virtual bool fsi_stress_rows_owned_only() const { return true; }
+
+      /**
+       * Whether a time step can be repeated after restoring the displacement,
+       * velocity and acceleration, which is required by strong coupling.
+       */
+      virtual bool step_repeatable() const { return true; }
+
       /**
        * Save the checkpoint for restart (only global refinement supported)
+       * The dof vectors are saved in the order of checkpoint_numbering(), so
+       * the checkpoint can be loaded on any number of processes.
        */
       virtual void save_checkpoint(const int);
 
       /**
-       * Load from checkpoint to restart
+       * Load from checkpoint to restart, from the buddy checkpoint if it is
+       * newer than the one on disk.
        * Made virtual for RKPM solver
        */
       virtual bool load_checkpoint();
 
+      /**
+       * Keep the state of this step in the buddy checkpoints on the nodes.
+       * Every rank has the whole state and keeps an equal slice of it, so
+       * this is collective over checkpoint_communicator().
+       */
+      void save_buddy_checkpoint(const int);
+
+      /**
+       * The processes that share the buddy checkpoints, which include all
+       * the groups of processes that FSI may run the solid on, i.e.,
+       * MPI_COMM_WORLD, unless MPI::ConcurrentFSI leaves the other processes
+       * to the fluid.
+       */
+      MPI_Comm checkpoint_communicator() const;
+
+      /// Gather the slices of the buddy checkpoint of the given step into
+      /// restored_state.
+      void load_buddy_checkpoint(const int);
+
       Triangulation<dim, spacedim> &triangulation;
       Parameters::AllParameters parameters;
       DoFHandler<dim, spacedim> dof_handler;
@@ -188,6 +317,12 @@ namespace Solid
       PETScWrappers::MPI::Vector previous_acceleration;
       PETScWrappers::MPI::Vector previous_velocity;
       PETScWrappers::MPI::Vector previous_displacement;
+
+      /**
+       * The inverse of the lumped mass used by the explicit time integrator,
+       * zero at the constrained dofs.
+       */
+      PETScWrappers::MPI::Vector inverse_lumped_mass;
       std::vector<Vector<double>> fsi_stress_rows;
 
       /**
@@ -199,9 +334,24 @@ namespace Solid
       mutable std::vector<std::vector<PETScWrappers::MPI::Vector>> strain,
         stress;
 
+      /**
+       * Buffers of recover_strain_and_stress(), allocated with the system.
+       * The components of a scalar dof k are stored from k * n_components,
+       * strain first, then stress, then the weight.
+       */
+      PETScWrappers::MPI::Vector recovery_values;
+      FullMatrix<double> qpt_to_dof; //!< L2 projection on a cell.
+      std::vector<PETScWrappers::MPI::Vector::size_type>
+        owned_recovery_indices, owned_scalar_indices;
+      std::vector<PetscScalar> owned_recovery_entries, owned_component_values;
+
       MPI_Comm mpi_communicator;
       const unsigned int n_mpi_processes;
       const unsigned int this_mpi_process;
+      /// Whether the communicator contains the world rank 0. The solid may be
+      /// solved redundantly by several groups of ranks, of which only this
+      /// one prints and writes files.
+      const bool writes_output;
       ConditionalOStream pcout;
       Utils::Time time;
       mutable TimerOutput timer;
@@ -210,6 +360,114 @@ namespace Solid
       IndexSet locally_relevant_dofs;
       mutable std::vector<std::pair<double, std::string>> times_and_names;
 
+      std::unique_ptr<PETScWrappers::PreconditionerBase> preconditioner;
+      /// The matrix the preconditioner was built for.
+      const PETScWrappers::MPI::SparseMatrix *preconditioned_matrix;
+      /// The copy a reused preconditioner is built on.
+      PETScWrappers::MPI::SparseMatrix lagged_matrix;
+      Utils::PreconditionerReuse preconditioner_reuse;
+
+      /// Writes the checkpoint files on rank 0, in the background if told so.
+      Utils::BackgroundTask checkpoint_writer;
+
+      /// The latest solid checkpoint.
+      Utils::CheckpointIndex checkpoint_index;
+
+      /// The frequent node-local checkpoints.
+      Utils::BuddyCheckpoint buddy_checkpoint;
+
+      /// The HDF5 output, used if it is chosen over VTU.
+      Utils::XDMFOutput xdmf_output;
+
+      /// The VTU time series, appended to at every output.
+      Utils::PVDRecord pvd_record;
+
+      /// The fields and region to write.
+      Utils::OutputControl output_control;
+
+      /// Writes the VTU files and the .pvd record. It is destroyed, hence
+      /// finishes writing, before pvd_record.
+      Utils::WriterQueue output_writer;
+
+      /// The time-varying Neumann values, if any.
+      Utils::BoundaryDataTable neumann_table;
+
+      /// Stops the standalone run at a steady state.
+      Utils::SteadyStateMonitor<PETScWrappers::MPI::Vector> steady_state;
+
+      /// The cells and unit points of the solid probes, located again after
+      /// the mesh changes. The cell is end() if a probe is outside the mesh.
+      std::vector<
+        std::pair<typename DoFHandler<dim, spacedim>::active_cell_iterator,
+                  Point<dim>>>
+        probe_cells;
+      Utils::MonitorFile monitor_file;
+
+      /// The iterations and preconditioner setups of every time step.
+      Utils::SolverLog solver_log;
+
+      /**
+       * The partition, dof numbering and sparsity pattern saved with the
+       * checkpoints, so that a restart on the same mesh and number of
+       * processes does not compute them again. It is only valid between
+       * read_setup_cache() and the next initialize_system().
+       */
+      struct SetupCache
+      {
+        std::uint64_t checksum = 0;
+        std::vector<types::subdomain_id> subdomains; //!< Per active cell.
+        /// The final index of every dof in the order of distribute_dofs.
+        std::vector<types::global_dof_index> dof_numbering;
+        SparsityPattern sparsity;
+        bool valid = false;
+      } setup_cache;
+
+      /// A hash of the mesh and the settings the setup depends on.
+      std::uint64_t setup_checksum() const;
+
+      /// Read the setup cache, which is used if its checksum matches.
+      void read_setup_cache();
+
+      /// Write the setup cache on rank 0 if checkpoints are saved.
+      void write_setup_cache(const DynamicSparsityPattern &) const;
+
+      /**
+       * Append the extra state of a derived solver to the vectors saved in a
+       * checkpoint, after the displacement, velocity and acceleration. It is
+       * called on all the ranks, which all have the whole state.
+       */
+      virtual void stage_checkpoint(std::vector<Vector<double>> &) const {}
+
+      /**
+       * The vectors of a checkpoint in the order of checkpoint_numbering(),
+       * followed by the extra state of stage_checkpoint(). Collective.
+       */
+      std::vector<Vector<double>> checkpoint_state() const;
+
+      /// The vectors read from the latest checkpoint, in the saved order.
+      std::vector<Vector<double>> restored_state;
+
+      /**
+       * The step of the latest checkpoint written before the index existed,
+       * as separate .solid_checkpoint_displacement, _velocity, _acceleration
+       * and _stress files, or -1. Collective.
+       */
+      int find_legacy_checkpoint() const;
+
+      /**
+       * Read a checkpoint found by find_legacy_checkpoint() into
+       * restored_state. Its vectors are in the dof numbering of the run that
+       * saved them, so it must be loaded on the same number of processes.
+       */
+      void read_legacy_checkpoint(const int);
+
+      /**
+       * The index of every dof in the order the active cells first see it,
+       * which only depends on the mesh and the finite element. Unlike the
+       * dof numbering, it does not change with the number of processes.
+       */
+      std::vector<types::global_dof_index> checkpoint_numbering() const;
+
       /**
        * The fluid traction in FSI simulation, which should be set by the FSI.
        */
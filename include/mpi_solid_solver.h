@@ -61,6 +61,12 @@
 #include "parameters.h"
 #include "utilities.h"
 
+namespace MPI
+{
+  template <int dim>
+  class DistributedFSI;
+}
+
 namespace Solid
 {
   namespace MPI
@@ -72,6 +78,10 @@ namespace Solid
     class SolidSolver
     {
     public:
+      //! The FSI solver for a distributed solid needs access to the private
+      //! members of this solver.
+      friend ::MPI::DistributedFSI<dim>;
+
       SolidSolver(parallel::distributed::Triangulation<dim> &,
                   const Parameters::AllParameters &);
       ~SolidSolver();
@@ -115,11 +125,35 @@ namespace Solid
        */
       void output_results(const unsigned int) const;
 
+      /**
+       * Record the displacement in the steady state monitor. Once the run is
+       * steady, write the final output if it has not been written at this
+       * step and return true. Collective.
+       */
+      bool reached_steady_state();
+
       /**
        * Refine mesh and transfer solution.
        */
       void refine_mesh(const unsigned int, const unsigned int);
 
+      /**
+       * Number the face quadrature points of the boundary faces of the
+       * locally owned cells, which is the layout of fsi_traction, and reset
+       * the traction to zero. Called by setup_dofs in FSI simulations.
+       */
+      void setup_fsi_traction();
+
+      /**
+       * Add the FSI traction on a boundary face of a locally owned cell to
+       * the local rhs.
+       */
+      void add_fsi_traction(
+        const typename DoFHandler<dim>::active_cell_iterator &,
+        const unsigned int face,
+        const FEFaceValues<dim> &,
+        Vector<double> &local_rhs) const;
+
       parallel::distributed::Triangulation<dim> &triangulation;
       Parameters::AllParameters parameters;
       DoFHandler<dim> dof_handler;
@@ -165,8 +199,34 @@ namespace Solid
       ConditionalOStream pcout;
       Utils::Time time;
       mutable TimerOutput timer;
+
+      /// The HDF5 output, used if it is chosen over VTU.
+      mutable Utils::XDMFOutput xdmf_output;
+
+      /// The fields and region to write.
+      Utils::OutputControl output_control;
+
+      /// The time-varying Neumann values, if any.
+      Utils::BoundaryDataTable neumann_table;
+
+      /// Stops the standalone run at a steady state.
+      Utils::SteadyStateMonitor<PETScWrappers::MPI::Vector> steady_state;
+
+      /// The iterations of every time step.
+      Utils::SolverLog solver_log;
+
       IndexSet locally_owned_dofs;
       IndexSet locally_relevant_dofs;
+
+      /**
+       * The fluid traction times the area element of the deformed face at
+       * the face quadrature points of the boundary faces of the locally
+       * owned cells, which MPI::DistributedFSI sets. The points of a face
+       * start from fsi_traction_offset[active_cell_index * faces_per_cell +
+       * face], which is invalid for the other faces.
+       */
+      std::vector<Tensor<1, dim>> fsi_traction;
+      std::vector<unsigned int> fsi_traction_offset;
     };
   } // namespace MPI
 } // namespace Solid
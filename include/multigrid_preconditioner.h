@@ -0,0 +1,201 @@
+#ifndef MULTIGRID_PRECONDITIONER
+#define MULTIGRID_PRECONDITIONER
+
+#include <deal.II/base/mg_level_object.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/component_mask.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/petsc_matrix_base.h>
+#include <deal.II/lac/petsc_precondition.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/operators.h>
+#include <deal.II/multigrid/mg_coarse.h>
+#include <deal.II/multigrid/mg_constrained_dofs.h>
+#include <deal.II/multigrid/mg_matrix.h>
+#include <deal.II/multigrid/mg_smoother.h>
+#include <deal.II/multigrid/mg_transfer_matrix_free.h>
+#include <deal.II/multigrid/multigrid.h>
+#include <map>
+#include <memory>
+#include <petscpc.h>
+
+using namespace dealii;
+
+/**
+ * Matrix-free operator on one level of the multigrid hierarchy,
+ * \f$aM + bK + cD\f$ where \f$M\f$ is the mass matrix, \f$K\f$ the vector
+ * Laplacian and \f$D\f$ the Grad-Div matrix, which only exists if the field
+ * has dim components. It is applied in single precision.
+ */
+template <int dim, int n_components>
+class MultigridLevelOperator
+  : public MatrixFreeOperators::Base<dim,
+                                     LinearAlgebra::distributed::Vector<float>>
+{
+public:
+  using VectorType = LinearAlgebra::distributed::Vector<float>;
+
+  /// Set the coefficients of the mass, the Laplacian and the Grad-Div terms.
+  void set_coefficients(const double mass,
+                        const double laplace,
+                        const double grad_div);
+
+  /// Compute the inverse diagonal used by the Chebyshev smoother.
+  void compute_diagonal() override;
+
+private:
+  void apply_add(VectorType &dst, const VectorType &src) const override;
+
+  void local_apply(const MatrixFree<dim, float> &data,
+                   VectorType &dst,
+                   const VectorType &src,
+                   const std::pair<unsigned int, unsigned int> &range) const;
+
+  void local_compute_diagonal(
+    const MatrixFree<dim, float> &data,
+    VectorType &dst,
+    const unsigned int &,
+    const std::pair<unsigned int, unsigned int> &range) const;
+
+  /// The operation at the quadrature points of a cell, shared by the
+  /// application and the diagonal.
+  void apply_quadrature(FEEvaluation<dim, -1, 0, n_components, float> &) const;
+
+  float mass_coefficient = 0;
+  float laplace_coefficient = 1;
+  float grad_div_coefficient = 0;
+};
+
+/**
+ * Geometric multigrid on the level hierarchy of a parallel::distributed
+ * triangulation, as a PETSc preconditioner for one block of a system.
+ * The block is a field of n_components components of the same FE_Q, such as
+ * the velocity or the pressure of the fluid. The levels are matrix-free
+ * MultigridLevelOperator smoothed by Chebyshev iterations, so no matrix is
+ * assembled on any level. Every application copies the vectors in and out
+ * through a PETSc shell.
+ *
+ * The hierarchy only depends on the mesh, so reinit() is called after the
+ * mesh changes and initialize() whenever the coefficients change.
+ */
+template <int dim, int n_components>
+class PreconditionGMG : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * Standardized data struct to pipe additional flags to the
+   * preconditioner.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor.
+     */
+    AdditionalData(const double mass_coefficient = 0,
+                   const double laplace_coefficient = 1,
+                   const double grad_div_coefficient = 0,
+                   const unsigned int smoothing_degree = 5);
+
+    double mass_coefficient;
+
+    double laplace_coefficient;
+
+    double grad_div_coefficient;
+
+    /**
+     * Degree of the Chebyshev smoother on the levels above the coarsest,
+     * which is solved by Chebyshev iterations to a relative accuracy of
+     * 1e-3.
+     */
+    unsigned int smoothing_degree;
+  };
+
+  /**
+   * Empty Constructor. You need to call reinit() and initialize() before
+   * using this object.
+   */
+  PreconditionGMG() = default;
+
+  /**
+   * Distribute the level dofs of the field that starts at first_component
+   * of the system, build the matrix-free operators of all levels and map
+   * the locally owned dofs of its block of the system, which are numbered
+   * from block_offset on, to the dofs of the hierarchy. The components of
+   * the field masked on the given boundaries are zero on every level.
+   */
+  void reinit(const DoFHandler<dim> &system_dof_handler,
+              const unsigned int first_component,
+              const IndexSet &owned_block_dofs,
+              const types::global_dof_index block_offset,
+              const std::map<types::boundary_id, ComponentMask>
+                &dirichlet_boundaries);
+
+  /**
+   * Set the coefficients, compute the smoothers and create the PETSc shell.
+   * The matrix of the block only provides the sizes to PETSc.
+   */
+  void initialize(const PETScWrappers::MatrixBase &matrix,
+                  const AdditionalData &additional_data = AdditionalData());
+
+  /**
+   * The memory of the level operators, the transfer and the vectors.
+   */
+  std::size_t memory_consumption() const;
+
+  friend PETScWrappers::MatrixBase;
+
+private:
+  using LevelOperator = MultigridLevelOperator<dim, n_components>;
+  using VectorType = typename LevelOperator::VectorType;
+  using SmootherType = PreconditionChebyshev<LevelOperator, VectorType>;
+
+  /**
+   * The apply function of the PETSc shell.
+   */
+  static PetscErrorCode apply(PC pc, Vec src, Vec dst);
+
+  AdditionalData additional_data;
+
+  std::unique_ptr<FESystem<dim>> fe;
+
+  DoFHandler<dim> dof_handler;
+
+  MGConstrainedDoFs mg_constrained_dofs;
+
+  MGLevelObject<LevelOperator> level_operators;
+
+  MGLevelObject<MatrixFreeOperators::MGInterfaceOperator<LevelOperator>>
+    interface_operators;
+
+  MGTransferMatrixFree<dim, float> mg_transfer;
+
+  mg::Matrix<VectorType> mg_matrix;
+
+  mg::Matrix<VectorType> mg_interface;
+
+  mg::SmootherRelaxation<SmootherType, VectorType> mg_smoother;
+
+  MGCoarseGridApplySmoother<VectorType> mg_coarse;
+
+  std::unique_ptr<Multigrid<VectorType>> multigrid;
+
+  std::unique_ptr<
+    PreconditionMG<dim, VectorType, MGTransferMatrixFree<dim, float>>>
+    preconditioner;
+
+  /**
+   * The local index in the vectors of the hierarchy of every locally owned
+   * dof of the block, in the order of PETSc.
+   */
+  std::vector<unsigned int> petsc_to_mg;
+
+  mutable LinearAlgebra::distributed::Vector<double> src_buffer;
+
+  mutable LinearAlgebra::distributed::Vector<double> dst_buffer;
+};
+
+#endif
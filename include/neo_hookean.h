@@ -1,6 +1,12 @@
 #ifndef NEO_HOOKEAN
 #define NEO_HOOKEAN
 
+#include <deal.II/base/symmetric_tensor.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/vectorization.h>
+
+#include <cmath>
+
 #include "hyper_elastic_material.h"
 
 namespace Solid
@@ -12,6 +18,11 @@ namespace Solid
    *
    * The isotropic part of the strain energy in the Neo-Hookean
    * model is written as \f$ C_1(\bar{I}_1 -3) \f$.
+   *
+   * Besides the virtual interface, it offers evaluate() which computes the
+   * stress and the elasticity tensor in closed form without any virtual call
+   * or intermediate state, so that it can be called with
+   * VectorizedArray<double> to process several quadrature points at once.
    */
   template <int dim>
   class NeoHookean : public HyperElasticMaterial<dim>
@@ -33,9 +44,87 @@ namespace Solid
       return dealii::SymmetricTensor<4, dim>();
     }
 
+    /**
+     * Evaluate the material at a deformation gradient.
+     * Number is either double or VectorizedArray<double>.
+     * \param[out] J The determinant of F.
+     * \param[out] p The derivative of the volumetric potential w.r.t J.
+     * \param[out] tau The Kirchhoff stress.
+     * \param[out] Jc The spatial elasticity tensor multiplied with J.
+     */
+    template <typename Number>
+    void evaluate(const dealii::Tensor<2, dim, Number> &F,
+                  Number &J,
+                  Number &p,
+                  dealii::SymmetricTensor<2, dim, Number> &tau,
+                  dealii::SymmetricTensor<4, dim, Number> &Jc) const;
+
   private:
     double c1;
   };
+
+  template <int dim>
+  template <typename Number>
+  inline void
+  NeoHookean<dim>::evaluate(const dealii::Tensor<2, dim, Number> &F,
+                            Number &J,
+                            Number &p,
+                            dealii::SymmetricTensor<2, dim, Number> &tau,
+                            dealii::SymmetricTensor<4, dim, Number> &Jc) const
+  {
+    J = dealii::determinant(F);
+    p = this->kappa * (J - 1.0);
+    const Number p_tilde = p + J * this->kappa;
+    const Number scale = (2.0 * c1) * std::pow(J, -2.0 / dim);
+
+    // tau_bar = 2 * c1 * b_bar, tau_iso = dev(tau_bar), tau_vol = J * p * I
+    dealii::SymmetricTensor<2, dim, Number> tau_iso;
+    Number trace_tau_bar;
+    trace_tau_bar = 0.0;
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        for (unsigned int j = i; j < dim; ++j)
+          {
+            Number b = F[i][0] * F[j][0];
+            for (unsigned int k = 1; k < dim; ++k)
+              {
+                b += F[i][k] * F[j][k];
+              }
+            tau_iso[i][j] = scale * b;
+          }
+        trace_tau_bar += tau_iso[i][i];
+      }
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        tau_iso[i][i] -= trace_tau_bar / static_cast<double>(dim);
+      }
+    tau = tau_iso;
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        tau[i][i] += J * p;
+      }
+
+    // Jc_iso = 2/dim * tr(tau_bar) * dev_P - 2/dim * (tau_iso x I + I x
+    // tau_iso), since cc_bar vanishes, and Jc_vol = J * (p_tilde * I x I -
+    // 2 * p * S).
+    for (unsigned int i = 0; i < dim; ++i)
+      for (unsigned int j = i; j < dim; ++j)
+        for (unsigned int k = 0; k < dim; ++k)
+          for (unsigned int l = k; l < dim; ++l)
+            {
+              const double S = 0.5 * ((i == k && j == l ? 1.0 : 0.0) +
+                                      (i == l && j == k ? 1.0 : 0.0));
+              const double IxI = (i == j && k == l) ? 1.0 : 0.0;
+              Number value =
+                (2.0 / dim) * (S - IxI / dim) * trace_tau_bar +
+                J * (IxI * p_tilde - (2.0 * S) * p);
+              if (k == l)
+                value -= (2.0 / dim) * tau_iso[i][j];
+              if (i == j)
+                value -= (2.0 / dim) * tau_iso[k][l];
+              Jc[i][j][k][l] = value;
+            }
+  }
 } // namespace Solid
 
 #endif
@@ -17,12 +17,51 @@ namespace Parameters
     std::string simulation_type;
     int dimension;
     std::vector<int> global_refinements;
+    std::string mesh_cache; //!< Directory of refined meshes, empty if none.
     double end_time;
     double time_step;
     double output_interval;
     double refinement_interval;
+    std::string refinement_indicator; //!< Kelly or Vorticity.
+    double refinement_fraction; //!< Fraction of the estimated error to
+                                //! refine.
+    double coarsening_fraction; //!< Fraction of the estimated error to
+                                //! coarsen.
+    unsigned int refinement_levels; //!< Levels above the global refinement.
+    unsigned int target_fluid_cells; //!< Number of fluid cells the adaptive
+                                     //! refinement stays under, 0 for none.
     double save_interval;
+    double steady_state_tolerance; //!< Rate of change of the solution below
+                                   //! which the run stops, 0 to disable.
+    unsigned int steady_state_steps;
+    bool async_checkpoint; //!< Finish writing checkpoints in the background.
+    double buddy_checkpoint_interval; //!< 0 disables the buddy checkpoints.
+    std::string buddy_checkpoint_directory; //!< Node-local directory.
+    unsigned int output_queue_depth; //!< 0 writes the output in the loop.
+    std::string output_format; //!< VTU or HDF5 with an XDMF file.
+    bool output_mesh_once; //!< Write an unchanged HDF5 mesh only once.
+    std::vector<std::string> output_fields; //!< Empty means all the fields.
+    double stress_output_interval; //!< 0 means with every output.
+    std::vector<double> output_box; //!< Lower and upper corners, or empty.
+    std::vector<int> output_material_ids; //!< Empty means all the cells.
+    std::string output_compression;
     std::vector<double> gravity;
+    std::string dof_renumbering; //!< None, Cuthill-McKee, Hierarchical or
+                                 //! Hilbert ordering of the dofs.
+    bool adaptive_time_step; //!< Choose the fluid time step size from the
+                             //! CFL number in Fluid simulations.
+    double target_cfl;
+    double time_step_growth; //!< Largest ratio between successive steps.
+    double time_step_shrink; //!< Smallest ratio between successive steps.
+    double min_time_step;
+    double max_time_step; //!< 0 means no upper bound.
+    unsigned int target_newton_iterations; //!< Also shrink the step if the
+                                           //! last one took more Newton
+                                           //! iterations, 0 to disable.
+    bool timing_report; //!< Write timing-*.json and timing_steps.csv.
+    bool memory_report; //!< Print the memory of the solver components.
+    bool solver_log;    //!< Write the solver statistics of every step.
+    bool trace;         //!< Write the timeline of the solver phases.
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -48,6 +87,39 @@ namespace Parameters
     double grad_div;
     unsigned int fluid_max_iterations;
     double fluid_tolerance;
+    bool fluid_matrix_free; //!< Apply the system operator without the
+                            //! assembled matrix in the Krylov solver.
+    double velocity_block_tolerance; //!< Relative tolerance of the AMG
+                                     //! preconditioned GMRES, 0 means a
+                                     //! single V-cycle.
+    unsigned int preconditioner_max_age; //!< Number of linear solves a
+                                         //! preconditioner is reused for.
+    unsigned int preconditioner_max_iterations; //!< Krylov iterations above
+                                                //! which it is rebuilt.
+    double preconditioner_rebuild_threshold; //!< Relative change of the
+                                             //! velocity block norm above
+                                             //! which it is rebuilt.
+    bool fluid_cache_fe_data; //!< Keep the per-cell FE data between
+                              //! refinements in the assembly.
+    std::string fluid_forcing_term; //!< Constant or Eisenstat-Walker
+                                    //! tolerance of the Newton steps.
+    double fluid_min_forcing_term;
+    double fluid_max_forcing_term;
+    bool fluid_single_precision; //!< Apply the inner parts of the serial
+                                 //! SCnsIM preconditioner in float.
+    unsigned int fluid_predictor_order; //!< Extrapolation order of the
+                                        //! initial guesses, 0 to disable.
+    std::string fluid_time_integration; //!< Backward Euler or BDF2 of the
+                                        //! InsIM and SCnsIM solvers.
+    std::string fluid_reduced_order; //!< None, Offline to collect a POD
+                                     //! basis, or Online to use it.
+    std::string fluid_reduced_basis; //!< File of the POD basis.
+    unsigned int fluid_reduced_modes; //!< Maximum number of POD modes.
+    double fluid_reduced_energy; //!< Fraction of the snapshot energy that
+                                 //! the modes hold.
+    double fluid_reduced_tolerance; //!< Full residual relative to the one at
+                                    //! the start of a step above which the
+                                    //! reduced step is rejected.
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -109,6 +181,20 @@ namespace Parameters
                                        //! hyperelastic only.
     double tol_f;                      //!< Force tolerance
     double tol_d; //!< Displacement tolerance, hyperelastic only.
+    unsigned int solid_preconditioner_max_age;
+    unsigned int solid_preconditioner_max_iterations;
+    double solid_preconditioner_rebuild_threshold;
+    bool solid_factorize_linear_system; //!< Factorize the constant Newmark
+                                        //! matrix of linear elasticity once.
+    std::string solid_newton_method; //!< Full or Modified, hyperelastic only.
+    unsigned int solid_tangent_max_age; //!< Newton iterations a tangent is
+                                        //! reused for in modified Newton.
+    unsigned int solid_line_search_steps; //!< Max number of step halvings,
+                                          //! 0 disables the line search.
+    std::string solid_stress_recovery; //!< Averaging or Lumped projection.
+    std::string solid_time_integrator; //!< Newmark or Central difference.
+    std::string solid_tangent; //!< Assembled or Matrix-free, parallel
+                               //! hyperelastic only.
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -139,6 +225,9 @@ namespace Parameters
      * if pressure is given, then the vector length should be 1.
      */
     std::map<unsigned int, std::vector<double>> solid_neumann_bcs;
+    /// A binary table of time-varying values, which replace the constant
+    /// ones on the boundaries it contains. Empty if there is none.
+    std::string solid_neumann_table;
     /**
      * We have to know how many components are expected in traction vector.
      * Although the dimension is specified in the Geometry subsection,
@@ -151,6 +240,105 @@ namespace Parameters
     void parseParameters(ParameterHandler &);
   };
 
+  struct FSISolver
+  {
+    double transfer_rebuild_distance; //!< Max solid displacement before the
+                                      //! solid-to-fluid transfer is rebuilt,
+                                      //! 0 means relocating every time step.
+    bool narrow_band_indicator; //!< Only re-classify the fluid cells near
+                                //! the solid when updating the indicator.
+    bool solid_eulerian_mapping; //!< Evaluate the deformed solid through a
+                                 //! MappingQEulerian instead of moving
+                                 //! the solid vertices.
+    bool node_shared_solid_geometry; //!< Store the deformed solid vertices
+                                     //! once per node in shared memory.
+    unsigned int solid_group_size; //!< Number of ranks of every group that
+                                   //! solves the solid, 0 means all.
+    unsigned int concurrent_solid_processes; //!< Number of first ranks that
+                                             //! solve the solid while the
+                                             //! rest solve the fluid, 0
+                                             //! means one after the other.
+    unsigned int solid_substeps; //!< Number of solid time steps within one
+                                 //! fluid time step.
+    std::string traction_evaluation; //!< Where the fluid stress on the solid
+                                     //! is evaluated, Vertices or
+                                     //! Quadrature points.
+    unsigned int coupling_iterations; //!< Max number of strongly coupled
+                                      //! iterations per time step, 1 means
+                                      //! staggered.
+    double coupling_tolerance; //!< Relative change of the interface stress
+                               //! for the coupling iterations to converge.
+    double initial_relaxation; //!< Relaxation factor of the first Aitken
+                               //! iteration.
+    double repartition_interval; //!< Interval of repartitioning the fluid
+                                 //! mesh with the coupling cost.
+    double artificial_cell_weight; //!< Extra cost of an artificial fluid cell
+                                   //! relative to a plain one, 0 means
+                                   //! measured.
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
+  /**
+   * The type and the tuning of one preconditioner of the parallel solvers,
+   * declared in a subsection of "Preconditioners" and built by
+   * make_preconditioner().
+   */
+  struct PreconditionerSettings
+  {
+    std::string type; //!< None, Jacobi, Block Jacobi, Pilut, Euclid, AMG,
+                      //! ML, MueLu, MUMPS or GMG.
+    unsigned int ilu_levels;     //!< Fill levels of Euclid.
+    double amg_strong_threshold; //!< Strength threshold of BoomerAMG, 0
+                                 //! chooses it by the dimension.
+    double amg_aggregation_threshold; //!< Aggregation threshold of ML
+                                      //! and MueLu.
+    unsigned int pilut_max_iterations;
+    unsigned int pilut_row_size;       //!< Max nonzeros per row of the factors.
+    double pilut_tolerance;            //!< Drop tolerance of Pilut.
+    unsigned int gmg_smoothing_degree; //!< Chebyshev degree of GMG.
+    static void declareParameters(ParameterHandler &,
+                                  const std::string &subsection,
+                                  const std::string &default_type,
+                                  const std::string &types);
+    void parseParameters(ParameterHandler &, const std::string &subsection);
+  };
+
+  struct Preconditioners
+  {
+    /// The CG preconditioner of the shared memory solid solver, whose Direct
+    /// type replaces CG with MUMPS.
+    PreconditionerSettings solid_preconditioner;
+    /// The velocity blocks of the parallel InsIM, InsIMEX and SCnsIM block
+    /// preconditioners, and the pressure Schur complement block of SCnsIM.
+    PreconditionerSettings velocity_block_preconditioner;
+    PreconditionerSettings imex_velocity_block_preconditioner;
+    PreconditionerSettings scnsim_velocity_block_preconditioner;
+    PreconditionerSettings scnsim_pressure_block_preconditioner;
+    /// The CG solve of the mass Schur complement in the InsIM block
+    /// preconditioner.
+    PreconditionerSettings pressure_schur_preconditioner;
+    /// The CG solve of the matrix-free tangent of the parallel hyperelastic
+    /// solver.
+    PreconditionerSettings solid_tangent_preconditioner;
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
+  struct Monitors
+  {
+    double monitor_interval; //!< 0 means every time step.
+    /// The coordinates of the fluid and solid probes, dim per point.
+    std::vector<double> fluid_probes;
+    std::vector<double> solid_probes;
+    /// The boundaries whose fluid force and flux are monitored.
+    std::vector<int> fluid_monitor_boundaries;
+    /// Copied from the dimension to check the coordinates of the probes.
+    int monitor_dim;
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
   struct AllParameters : public Simulation,
                          public FluidFESystem,
                          public FluidMaterial,
@@ -161,9 +349,18 @@ namespace Parameters
                          public SolidMaterial,
                          public SolidSolver,
                          public SolidDirichlet,
-                         public SolidNeumann
+                         public SolidNeumann,
+                         public FSISolver,
+                         public Preconditioners,
+                         public Monitors
   {
-    AllParameters(const std::string &);
+    /**
+     * Parse the input file, then apply the overrides in order. An override
+     * has the form "Subsection/Entry = value", where nested subsections are
+     * separated by slashes as well.
+     */
+    AllParameters(const std::string &,
+                  const std::vector<std::string> &overrides = {});
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -0,0 +1,120 @@
+#ifndef POINT_HISTORY
+#define POINT_HISTORY
+
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/symmetric_tensor.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/physics/elasticity/kinematics.h>
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <vector>
+
+#include "neo_hookean.h"
+#include "parameters.h"
+
+namespace Internal
+{
+  using namespace dealii;
+
+  /** \brief The quadrature point history of the hyperelastic solvers.
+   *
+   * The kinematics and the stress state at the quadrature points are cached
+   * so that they can be accessed in the assembly and post processing. They
+   * are stored as structure of arrays: every quantity lives in one contiguous
+   * array indexed by the point, and the points of a cell are consecutive,
+   * starting from first_point(cell).
+   *
+   * The material type is a template parameter so that the constitutive law
+   * is evaluated without virtual calls through MaterialType::evaluate(),
+   * batching the points of a cell in VectorizedArray<double>. Only one
+   * material object per solid part is kept.
+   */
+  template <int dim, typename MaterialType = Solid::NeoHookean<dim>>
+  class HyperElasticPointHistory
+  {
+  public:
+    /**
+     * Allocate the history of the locally owned active cells of a
+     * triangulation, and set it to the undeformed state. If a subdomain
+     * is given, only the cells in it are considered, which is needed for
+     * serial triangulations partitioned by hand.
+     */
+    void initialize(
+      const Triangulation<dim> &,
+      const Parameters::AllParameters &,
+      const unsigned int n_q_points,
+      const types::subdomain_id subdomain = numbers::invalid_subdomain_id);
+
+    /// The index of the first quadrature point of a locally owned cell.
+    template <typename CellIteratorType>
+    unsigned int first_point(const CellIteratorType &cell) const
+    {
+      Assert(cell_first_point[cell->active_cell_index()] !=
+               numbers::invalid_unsigned_int,
+             ExcMessage("The cell has no quadrature point history!"));
+      return cell_first_point[cell->active_cell_index()];
+    }
+
+    /**
+     * Update the state of a point with the displacement gradient
+     * in the reference configuration.
+     */
+    void update(const unsigned int point, const Tensor<2, dim> &Grad_u);
+
+    /**
+     * Update the consecutive points starting from first with the
+     * displacement gradients at them, several points at a time.
+     */
+    void update(const unsigned int first,
+                const std::vector<Tensor<2, dim>> &Grad_u);
+
+    double get_det_F(const unsigned int point) const { return det_F[point]; }
+    const Tensor<2, dim> &get_F_inv(const unsigned int point) const
+    {
+      return F_inv[point];
+    }
+    const SymmetricTensor<2, dim> &get_tau(const unsigned int point) const
+    {
+      return tau[point];
+    }
+    const SymmetricTensor<4, dim> &get_Jc(const unsigned int point) const
+    {
+      return Jc[point];
+    }
+    double get_density(const unsigned int point) const
+    {
+      return densities[point_part[point]];
+    }
+    double get_dPsi_vol_dJ(const unsigned int point) const
+    {
+      return dPsi_vol_dJ[point];
+    }
+    double get_d2Psi_vol_dJ2(const unsigned int point) const
+    {
+      return kappas[point_part[point]];
+    }
+
+    /// The memory of the history in bytes.
+    std::size_t memory_consumption() const;
+
+  private:
+    /// One material per solid part, used to evaluate the stress.
+    std::vector<MaterialType> materials;
+    std::vector<double> densities;
+    /// The bulk modulus of every part, which is d2Psi_vol_dJ2.
+    std::vector<double> kappas;
+    /// The first point of every active cell, invalid if it is not owned.
+    std::vector<unsigned int> cell_first_point;
+    /// The solid part of every point.
+    std::vector<unsigned char> point_part;
+    std::vector<Tensor<2, dim>> F_inv;
+    std::vector<SymmetricTensor<2, dim>> tau;
+    std::vector<SymmetricTensor<4, dim>> Jc;
+    std::vector<double> det_F;
+    std::vector<double> dPsi_vol_dJ;
+  };
+} // namespace Internal
+
+#endif
@@ -9,9 +9,19 @@
 #include <deal.II/lac/petsc_precondition.h>
 #include <deal.II/lac/petsc_solver.h>
 #include <deal.II/lac/petsc_vector_base.h>
+#include <memory>
 #include <petscconf.h>
 #include <petscpc.h>
 
+#include "parameters.h"
+
+#ifdef OPENIFEM_WITH_TRILINOS
+#include <deal.II/lac/trilinos_precondition.h>
+#include <deal.II/lac/trilinos_sparse_matrix.h>
+#include <Epetra_Operator.h>
+#include <Epetra_Vector.h>
+#endif
+
 using namespace dealii;
 
 class PreconditionPilut : public PETScWrappers::PreconditionerBase
@@ -85,9 +95,10 @@ public:
 
   /**
    * Constructor. Take the matrix which is used to form the preconditioner,
-   * and additional flags if there are any.
+   * and the fill levels of the ILU(k) factorization.
    */
-  PreconditionEuclid(const PETScWrappers::MatrixBase &matrix);
+  PreconditionEuclid(const PETScWrappers::MatrixBase &matrix,
+                     const unsigned int levels = 1);
 
   /**
    * Initialize the preconditioner object and calculate all data that is
@@ -95,9 +106,147 @@ public:
    * called when calling the constructor with the same arguments and is only
    * used if you create the preconditioner without arguments.
    */
+  void initialize(const PETScWrappers::MatrixBase &matrix,
+                  const unsigned int levels = 1);
+
+  friend PETScWrappers::MatrixBase;
+};
+
+/**
+ * A sparse LU factorization computed by MUMPS. Applying it does the forward
+ * and back substitutions, so it solves the system exactly and can be applied
+ * repeatedly without refactorizing. The factorization is kept even if the
+ * values of the matrix are changed afterwards.
+ */
+class PreconditionMUMPS : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * Empty Constructor. You need to call initialize() before using this
+   * object.
+   */
+  PreconditionMUMPS() = default;
+
+  /**
+   * Constructor. Take the matrix to factorize.
+   */
+  PreconditionMUMPS(const PETScWrappers::MatrixBase &matrix);
+
+  /**
+   * Factorize the matrix. This function is automatically called when calling
+   * the constructor with the same arguments and is only used if you create
+   * the preconditioner without arguments.
+   */
   void initialize(const PETScWrappers::MatrixBase &matrix);
 
   friend PETScWrappers::MatrixBase;
 };
 
+#ifdef OPENIFEM_WITH_TRILINOS
+/**
+ * Algebraic multigrid from Trilinos, ML or MueLu, as a PETSc preconditioner.
+ * The matrix is copied into an Epetra matrix once, on construction, outside
+ * of the Krylov iterations. Every application goes through a PETSc shell that
+ * views the local entries of the PETSc vectors as Epetra vectors, so nothing
+ * is copied per iteration, and it can be used by the PETSc and the deal.II
+ * Krylov solvers alike. Like MUMPS, the hierarchy is kept if the values of
+ * the matrix are changed afterwards.
+ */
+class PreconditionTrilinosAMG : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * Standardized data struct to pipe additional flags to the
+   * preconditioner.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor.
+     */
+    AdditionalData(const bool muelu = false,
+                   const bool elliptic = true,
+                   const bool higher_order_elements = false,
+                   const double aggregation_threshold = 1e-4);
+
+    /**
+     * Use MueLu instead of ML.
+     */
+    bool muelu;
+
+    /**
+     * Whether the operator is close to the Laplacian, which selects
+     * Chebyshev smoothers instead of ILU.
+     */
+    bool elliptic;
+
+    /**
+     * Whether the matrix comes from elements of degree higher than one.
+     */
+    bool higher_order_elements;
+
+    /**
+     * Threshold of the strength of connection in the aggregation.
+     */
+    double aggregation_threshold;
+  };
+
+  /**
+   * Empty Constructor. You need to call initialize() before using this
+   * object.
+   */
+  PreconditionTrilinosAMG() = default;
+
+  /**
+   * Constructor. Take the matrix which is used to form the preconditioner,
+   * and additional flags if there are any.
+   */
+  PreconditionTrilinosAMG(
+    const PETScWrappers::MatrixBase &matrix,
+    const AdditionalData &additional_data = AdditionalData());
+
+  /**
+   * Copy the matrix and build the multigrid hierarchy. This function is
+   * automatically called when calling the constructor with the same
+   * arguments and is only used if you create the preconditioner without
+   * arguments.
+   */
+  void initialize(const PETScWrappers::MatrixBase &matrix,
+                  const AdditionalData &additional_data = AdditionalData());
+
+  /**
+   * The memory of the Epetra copy of the matrix. The hierarchy is not
+   * visible through the deal.II wrappers.
+   */
+  std::size_t memory_consumption() const;
+
+  friend PETScWrappers::MatrixBase;
+
+private:
+  /**
+   * The apply function of the PETSc shell.
+   */
+  static PetscErrorCode apply(PC pc, Vec src, Vec dst);
+
+  AdditionalData additional_data;
+
+  TrilinosWrappers::SparseMatrix trilinos_matrix;
+
+  std::unique_ptr<TrilinosWrappers::PreconditionBase> amg;
+};
+#endif
+
+/**
+ * Build the preconditioner of the given settings for the matrix, so that
+ * every block of every parallel solver can be chosen in the parameter file.
+ * BoomerAMG, ML and MueLu are told whether the operator is symmetric, and
+ * the dimension chooses the default strength threshold of BoomerAMG.
+ */
+std::unique_ptr<PETScWrappers::PreconditionerBase>
+make_preconditioner(const PETScWrappers::MatrixBase &matrix,
+                    const Parameters::PreconditionerSettings &settings,
+                    const unsigned int dim,
+                    const bool symmetric,
+                    const bool higher_order_elements = false);
+
 #endif
@@ -28,6 +28,9 @@ namespace Fluid
    * to solve the nonlinear system, thus the actual dofs being solved is the
    * velocity and pressure increment.
    *
+   * The time derivative is backward Euler or, if told so in the input file,
+   * the variable-step BDF2.
+   *
    * The final linear system to be solved is nonsymmetric. GMRES solver with
    * SUPG incomplete Schur complement right preconditioner is applied, which
    * does modify the linear system a little bit, and requires the velocity shape
@@ -73,10 +76,21 @@ namespace Fluid
     using FluidSolver<dim>::sparsity_pattern;
     using FluidSolver<dim>::system_matrix;
     using FluidSolver<dim>::present_solution;
+    using FluidSolver<dim>::previous_solution;
+    using FluidSolver<dim>::previous_delta_t;
+    using FluidSolver<dim>::bdf2_history;
+    using FluidSolver<dim>::update_time_history;
+    using FluidSolver<dim>::time_history;
+    using FluidSolver<dim>::effective_delta_t;
+    using FluidSolver<dim>::record_previous_solution;
     using FluidSolver<dim>::solution_increment;
     using FluidSolver<dim>::system_rhs;
     using FluidSolver<dim>::stress;
     using FluidSolver<dim>::time;
+    using FluidSolver<dim>::preconditioner_reuse;
+    using FluidSolver<dim>::cell_fe_data;
+    using FluidSolver<dim>::adapt_time_step;
+    using FluidSolver<dim>::solution_predictor;
     using FluidSolver<dim>::timer;
     using FluidSolver<dim>::parameters;
     using FluidSolver<dim>::cell_property;
@@ -86,9 +100,13 @@ namespace Fluid
     /// the dofs and constraints.
     virtual void initialize_system() override;
 
+    /// Evaluate sigma_pml_field at the quadrature points of the cells once
+    /// per mesh, keeping the values of the cells inside the PML only.
+    void setup_pml();
+
     /*! \brief Assemble the system matrix, mass mass matrix, and the RHS.
      *
-     *  Since backward Euler method is used, the linear system must be
+     *  Since an implicit method is used, the linear system must be
      * reassembled
      *  at every Newton iteration. The Dirichlet BCs are applied at the same
      * time
@@ -120,10 +138,25 @@ namespace Fluid
     void run_one_step(bool apply_nonzero_constraints,
                       bool assemble_system = true) override;
 
+    /*! \brief Run the Newton iterations of a step in the space of the POD
+     *  modes.
+     *
+     *  The Jacobian and the residual are assembled in full and projected
+     *  onto the modes, and the reduced system is solved directly. Once the
+     *  reduced residual has converged, the full residual indicates the
+     *  error of the reduced space: the step is rejected if it is larger than
+     *  the reduced order tolerance times the one at the start of the step.
+     *  Return whether the step was accepted, with the solution in
+     *  evaluation_point.
+     */
+    bool run_reduced_step(const bool apply_nonzero_constraints,
+                          unsigned int &iterations);
+
     /// The sparsity pattern and matrices that are used in the preconditioner.
-    SparsityPattern schur_pattern;
-    SparseMatrix<double> schur_matrix;
+    /// Both matrices share Tpp_pattern, which contains the pattern of the
+    /// Schur complement.
     SparsityPattern Tpp_pattern;
+    SparseMatrix<double> schur_matrix;
     SparseMatrix<double> B2pp_matrix;
 
     /// The increment at a certain Newton iteration.
@@ -134,6 +167,9 @@ namespace Fluid
      */
     BlockVector<double> evaluation_point;
 
+    /// The snapshots collected offline, or the modes used online.
+    Utils::PODBasis pod_basis;
+
     /// The BlockIncompSchurPreconditioner for the entire system.
     std::shared_ptr<BlockIncompSchurPreconditioner> preconditioner;
 
@@ -145,6 +181,11 @@ namespace Fluid
      */
     std::shared_ptr<Function<dim>> sigma_pml_field;
 
+    /// The sigma PML values at the quadrature points of the active cells,
+    /// indexed by the active cell index. It is empty for the cells outside
+    /// the PML, where sigma vanishes.
+    std::vector<std::vector<double>> cell_sigma_pml;
+
     /** \brief Incomplete Schur Complement Block Preconditioner
      * The format of this preconditioner is as follow:
      *
@@ -161,6 +202,11 @@ namespace Fluid
      * T. Washio et al., A robust preconditioner for fluid–structure
      * interaction problems, Comput. Methods Appl. Mech. Engrg.
      * 194 (2005) 4027–4047
+     *
+     * In single precision, Pvv, B2pp and the blocks used in Tpp are stored
+     * in float and Tpp^-1 is solved with float vectors to a looser
+     * tolerance, which halves the memory traffic of the preconditioner.
+     * The outer FGMRES is still in double.
      */
     class BlockIncompSchurPreconditioner : public Subscriptor
     {
@@ -168,7 +214,8 @@ namespace Fluid
       BlockIncompSchurPreconditioner(TimerOutput &timer,
                                      const BlockSparseMatrix<double> &system,
                                      SparseMatrix<double> &schur,
-                                     SparseMatrix<double> &B2pp);
+                                     SparseMatrix<double> &B2pp,
+                                     const bool single_precision = false);
       void vmult(BlockVector<double> &dst,
                  const BlockVector<double> &src) const;
       const SparseMatrix<double> &Avv() const
@@ -191,46 +238,59 @@ namespace Fluid
       void Erase_Tpp_count() { Tpp_itr = 0; }
 
     private:
+      template <typename number>
       class SchurComplementTpp;
 
+      /// Apply the ILU(0) of Avv in the chosen precision.
+      void apply_Pvv_inverse(Vector<double> &dst,
+                             const Vector<double> &src) const;
+
+      /// Solve Tpp * dst = src with GMRES preconditioned by B2pp.
+      template <typename number>
+      void solve_Tpp(const SchurComplementTpp<number> &Tpp_operator,
+                     const SparseILU<number> &B2pp_preconditioner,
+                     const double tolerance,
+                     Vector<number> &dst,
+                     const Vector<number> &src) const;
+
       /// We would like to time the BlockSchuPreconditioner in detail.
       TimerOutput &timer;
 
       const SmartPointer<const BlockSparseMatrix<double>> system_matrix;
       const SmartPointer<SparseMatrix<double>> schur_matrix;
       const SmartPointer<SparseMatrix<double>> B2pp_matrix;
+      const bool single_precision;
       SparseILU<double> Pvv_inverse;
       SparseILU<double> B2pp_inverse;
-      std::shared_ptr<SchurComplementTpp> Tpp;
+      std::shared_ptr<SchurComplementTpp<double>> Tpp;
+      /// The single precision copies, only used if told so.
+      SparseMatrix<float> Avp_float;
+      SparseMatrix<float> Apv_float;
+      SparseMatrix<float> App_float;
+      SparseILU<float> Pvv_inverse_float;
+      SparseILU<float> B2pp_inverse_float;
+      std::shared_ptr<SchurComplementTpp<float>> Tpp_float;
       mutable int Tpp_itr; // iteration counter for solving Tpp
+
+      /// Tpp = App - Apv * Pvv^-1 * Avp applied in the given precision.
+      template <typename number>
       class SchurComplementTpp : public Subscriptor
       {
       public:
         SchurComplementTpp(TimerOutput &timer,
-                           const BlockSparseMatrix<double> &system,
-                           const SparseILU<double> &Pvvinv);
-        void vmult(Vector<double> &dst, const Vector<double> &src) const;
-        const SparseMatrix<double> &Avv() const
-        {
-          return system_matrix->block(0, 0);
-        }
-        const SparseMatrix<double> &Avp() const
-        {
-          return system_matrix->block(0, 1);
-        }
-        const SparseMatrix<double> &Apv() const
-        {
-          return system_matrix->block(1, 0);
-        }
-        const SparseMatrix<double> &App() const
-        {
-          return system_matrix->block(1, 1);
-        }
+                           const SparseMatrix<number> &Avp,
+                           const SparseMatrix<number> &Apv,
+                           const SparseMatrix<number> &App,
+                           const SparseILU<number> &Pvvinv);
+        void vmult(Vector<number> &dst, const Vector<number> &src) const;
 
       private:
         TimerOutput &timer;
-        const SmartPointer<const BlockSparseMatrix<double>> system_matrix;
-        const SmartPointer<const SparseILU<double>> Pvv_inverse;
+        const SmartPointer<const SparseMatrix<number>> Avp;
+        const SmartPointer<const SparseMatrix<number>> Apv;
+        const SmartPointer<const SparseMatrix<number>> App;
+        const SmartPointer<const SparseILU<number>> Pvv_inverse;
+        mutable Vector<number> tmp1, tmp2, tmp3;
       };
     };
   };
@@ -5,6 +5,7 @@
 #include "solid_solver.h"
 #include <deal.II/lac/block_sparse_matrix.h>
 #include <deal.II/lac/block_vector.h>
+#include <array>
 
 template <int>
 class FSI;
@@ -95,6 +96,17 @@ namespace Solid
 
     Vector<double> current_drilling;
 
+    /**
+     * The displacement dofs and the scalar dof of every vertex, which is
+     * also the node id in m_mesh. Built once with the system, so that the
+     * copies between m_shell and the deal.II vectors are flat loops.
+     */
+    std::vector<std::array<types::global_dof_index, 3>> vertex_dofs;
+    std::vector<types::global_dof_index> vertex_scalar_dofs;
+
+    /// The buffer handed to m_shell by push_solution, kept across steps.
+    std::vector<libMesh::Number> pushed_solution;
+
     std::unique_ptr<ShellSolid::shellsolid> m_shell;
   };
 } // namespace Solid
@@ -6,6 +6,7 @@
 #include <deal.II/base/quadrature_point_data.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/timer.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/dofs/dof_handler.h>
@@ -32,6 +33,7 @@
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/precondition.h>
 #include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/sparse_direct.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/vector.h>
 
@@ -44,6 +46,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 #include "parameters.h"
 #include "utilities.h"
@@ -105,11 +108,42 @@ namespace Solid
                                           Vector<double> &,
                                           const Vector<double> &);
 
+    /**
+     * Assemble the external force minus the internal force at
+     * current_displacement into system_rhs, which is what the explicit
+     * time integrator needs. Solvers without it throw.
+     */
+    virtual void assemble_explicit_rhs();
+
+    /**
+     * Assemble the row-sum lumped mass matrix and store its inverse.
+     */
+    void assemble_lumped_mass();
+
+    /**
+     * Estimate the critical time step of the central difference method
+     * from the smallest node spacing and the dilatational wave speed.
+     */
+    double estimate_stable_time_step() const;
+
+    /**
+     * Run one time step with the explicit central difference method,
+     * which is the Newmark method with \f$\beta = 0\f$ and a lumped mass.
+     */
+    void run_one_explicit_step(bool);
+
     /**
      * Output the time-dependent solution in vtu format.
      */
     void output_results(const unsigned int);
 
+    /**
+     * Record the displacement in the steady state monitor. Once the run is
+     * steady, write the final output if it has not been written at this
+     * step and return true.
+     */
+    bool reached_steady_state();
+
     /**
      * Refine mesh and transfer solution.
      */
@@ -155,6 +189,12 @@ namespace Solid
     Vector<double> previous_velocity;
     Vector<double> previous_displacement;
 
+    /**
+     * The inverse of the lumped mass used by the explicit time integrator,
+     * zero at the constrained dofs.
+     */
+    Vector<double> inverse_lumped_mass;
+
     /**
      * Nodal strain and stress obtained by taking the average of surrounding
      * cell-averaged strains and stresses. Their sizes are
@@ -166,6 +206,15 @@ namespace Solid
     Utils::Time time;
     mutable TimerOutput timer;
 
+    /// The fields and region to write.
+    Utils::OutputControl output_control;
+
+    /// The time-varying Neumann values, if any.
+    Utils::BoundaryDataTable neumann_table;
+
+    /// Stops the standalone run at a steady state.
+    Utils::SteadyStateMonitor<Vector<double>> steady_state;
+
     CellDataStorage<typename Triangulation<dim, spacedim>::cell_iterator,
                     CellProperty>
       cell_property;
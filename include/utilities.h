@@ -1,6 +1,13 @@
 #ifndef UTILITIES
 #define UTILITIES
 
+#include <deal.II/base/data_out_base.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_refinement.h>
@@ -10,17 +17,44 @@
 #include <deal.II/grid/tria_accessor.h>
 #include <deal.II/grid/tria_iterator.h>
 #include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/petsc_block_sparse_matrix.h>
 #include <deal.II/lac/petsc_block_vector.h>
+#include <deal.II/numerics/data_out.h>
 #include <deal.II/numerics/vector_tools.h>
 
-#include <queue>
-#include <unordered_set>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "instrumentation.h"
+#include "parameters.h"
 
 namespace Utils
 {
   using namespace dealii;
 
-  /// This class manages simulation time and output frequency.
+  /*! \brief This class manages simulation time and the output, refinement and
+   *  save schedules.
+   *
+   *  The schedules are based on the simulated time: it is time to output,
+   *  refine or save if the last increment has reached or passed a multiple of
+   *  the corresponding interval, so they still hold if the step size changes.
+   */
   class Time
   {
   public:
@@ -31,6 +65,7 @@ namespace Utils
          const double save_interval)
       : timestep(0),
         time_current(0.0),
+        time_previous(0.0),
         delta_t(delta_t),
         time_end(time_end),
         output_interval(output_interval),
@@ -45,12 +80,41 @@ namespace Utils
     bool time_to_output() const;
     bool time_to_refine() const;
     bool time_to_save() const;
+    /// Whether a checkpoint with an interval of its own is saved, which is
+    /// never the case with an interval of 0.
+    bool time_to_save(const double interval) const;
+    /**
+     * Whether an output group with an interval of its own is written, the
+     * interval being a multiple of the output interval. Everything is
+     * written at the start and with an interval of 0.
+     */
+    bool time_to_output(const double interval) const;
     void increment();
     void set_delta_t(double delta);
 
+    /// The time that changes from step to step, all of it so that a step
+    /// can be repeated and a restart goes on with the step sizes it stopped
+    /// at.
+    struct State
+    {
+      unsigned int timestep;
+      double time_current;
+      double time_previous;
+      double delta_t;
+    };
+    State get_state() const
+    {
+      return {timestep, time_current, time_previous, delta_t};
+    }
+    void set_state(const State &state);
+
   private:
+    /// Whether the last increment has reached a multiple of the interval.
+    bool reached(const double interval) const;
+
     unsigned int timestep;
     double time_current;
+    double time_previous;
     double delta_t;
     const double time_end;
     const double output_interval;
@@ -58,6 +122,1075 @@ namespace Utils
     const double save_interval;
   };
 
+  /*! \brief Choose the time step size from the CFL number and the Newton
+   *  iterations of the last step.
+   *
+   *  The step is scaled by the ratio of the target CFL number to the last
+   *  one, and further by the ratio of the target number of Newton iterations
+   *  to the last one if the last step took more. The scaling is limited to
+   *  [min_factor, max_factor], and the step size to [min_delta_t,
+   *  max_delta_t] where a max_delta_t of 0 means no upper bound. A target of
+   *  0 iterations disables the Newton feedback.
+   */
+  class TimeStepController
+  {
+  public:
+    TimeStepController(const double target_cfl,
+                       const double min_factor,
+                       const double max_factor,
+                       const double min_delta_t,
+                       const double max_delta_t,
+                       const unsigned int target_iterations)
+      : target_cfl(target_cfl),
+        min_factor(min_factor),
+        max_factor(max_factor),
+        min_delta_t(min_delta_t),
+        max_delta_t(max_delta_t),
+        target_iterations(target_iterations)
+    {
+    }
+    /// The size of the next step given the size, the largest CFL number and
+    /// the number of Newton iterations of the last one.
+    double next_delta_t(const double delta_t,
+                        const double cfl,
+                        const unsigned int iterations) const;
+
+  private:
+    const double target_cfl;
+    const double min_factor;
+    const double max_factor;
+    const double min_delta_t;
+    const double max_delta_t;
+    const unsigned int target_iterations;
+  };
+
+  /*! \brief The coefficients of the variable-step BDF2 time derivative.
+   *
+   *  The derivative at t_{n+1} is (a_0 u_{n+1} + a_1 u_n + a_2 u_{n-1}) /
+   *  delta_t, where delta_t = t_{n+1} - t_n and previous_delta_t = t_n -
+   *  t_{n-1}. With the ratio w = delta_t / previous_delta_t, a_0 = (1 + 2w) /
+   *  (1 + w), a_1 = -(1 + w) and a_2 = w^2 / (1 + w), which is 3/2, -2, 1/2
+   *  for a constant step. A previous_delta_t of 0 means there is no u_{n-1}
+   *  and gives backward Euler, 1, -1, 0.
+   */
+  std::array<double, 3> bdf2_coefficients(const double delta_t,
+                                          const double previous_delta_t);
+
+  /*! \brief Decide when a lagged preconditioner has to be rebuilt.
+   *
+   *  A preconditioner is kept across linear solves, even if the matrix has
+   *  been reassembled, until it has been used in max_age solves, a solve
+   *  has taken more than max_iterations iterations, the time step size
+   *  has changed, or the Frobenius norm of the matrix it was built for has
+   *  changed by more than the relative threshold. A max_age of 1 rebuilds
+   *  it before every solve, and a max_iterations or a threshold of 0
+   *  disables the corresponding criterion.
+   */
+  class PreconditionerReuse
+  {
+  public:
+    PreconditionerReuse(const unsigned int max_age,
+                        const unsigned int max_iterations,
+                        const double threshold = 0)
+      : max_age(max_age),
+        max_iterations(max_iterations),
+        threshold(threshold),
+        age(0),
+        delta_t(0),
+        norm(0),
+        outdated(true)
+    {
+    }
+    /// Whether the preconditioner is kept for more than one solve.
+    bool lagged() const { return max_age > 1; }
+    /// Whether the preconditioner must be rebuilt before the next solve.
+    bool need_rebuild(const double delta) const;
+    /// Same as above, also checking the change of the matrix, whose norm is
+    /// only computed if there is a threshold.
+    template <typename MatrixType>
+    bool need_rebuild(const double delta, const MatrixType &matrix) const
+    {
+      return need_rebuild(delta) ||
+             (threshold > 0 &&
+              std::abs(matrix.frobenius_norm() - norm) > threshold * norm);
+    }
+    /// Record that the preconditioner has been rebuilt.
+    void rebuilt(const double delta);
+    /// Record that the preconditioner has been rebuilt for the matrix.
+    template <typename MatrixType>
+    void rebuilt(const double delta, const MatrixType &matrix)
+    {
+      rebuilt(delta);
+      if (threshold > 0)
+        {
+          norm = matrix.frobenius_norm();
+        }
+    }
+    /// Record the number of iterations of a solve.
+    void record(const unsigned int iterations);
+    /// Force a rebuild before the next solve.
+    void invalidate() { outdated = true; }
+
+  private:
+    const unsigned int max_age;
+    const unsigned int max_iterations;
+    const double threshold;
+    unsigned int age;
+    double delta_t;
+    double norm;
+    bool outdated;
+  };
+
+  /*! \brief Run tasks one at a time on a background thread.
+   *
+   *  Used to finish writing checkpoints while the time loop goes on. A task
+   *  waits for the previous one before it starts, and the destructor waits
+   *  for the last one. An exception thrown by a task is rethrown by the next
+   *  wait(). The tasks must not call MPI or touch the solver state.
+   */
+  class BackgroundTask
+  {
+  public:
+    ~BackgroundTask();
+    /// Run a task, on the background thread if asynchronous is true.
+    void run(std::function<void()> task, const bool asynchronous);
+    /// Wait for the running task to finish.
+    void wait();
+
+  private:
+    std::thread worker;
+    std::exception_ptr error;
+  };
+
+  /*! \brief A bounded queue of tasks run in order on one writer thread.
+   *
+   *  Used to format and write the output files while the time loop goes on.
+   *  push() blocks while depth tasks are pending, so a writer that falls
+   *  behind holds the time loop back instead of piling up snapshots. With a
+   *  depth of 0 the tasks are run right away. Like BackgroundTask, an
+   *  exception thrown by a task is rethrown by the next push() or wait(), and
+   *  the tasks must not call MPI or touch the solver state.
+   */
+  class WriterQueue
+  {
+  public:
+    explicit WriterQueue(const unsigned int depth);
+    /// Finish the pending tasks.
+    ~WriterQueue();
+    /// Queue a task, after waiting for a free slot.
+    void push(std::function<void()> task);
+    /// Wait for all the pending tasks to finish.
+    void wait();
+
+  private:
+    void work();
+    const unsigned int depth;
+    /// The pending tasks, the front one is running.
+    std::deque<std::function<void()>> tasks;
+    bool stop;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread worker;
+    std::exception_ptr error;
+  };
+
+  /*! \brief The index of the latest checkpoint of a solver.
+   *
+   *  The index is a small file named after the solver which holds the number
+   *  of the latest complete checkpoint, so that a restart opens it directly
+   *  instead of scanning the working directory. It is replaced atomically
+   *  after a checkpoint has been written, hence it never refers to a partial
+   *  one.
+   */
+  class CheckpointIndex
+  {
+  public:
+    /// The index is stored in name.checkpoint_index.
+    explicit CheckpointIndex(const std::string &name);
+    /**
+     * The number of the latest checkpoint, -1 if there is none. It is read
+     * by rank 0 and broadcast, so it must be called by all the ranks.
+     */
+    int latest(const MPI_Comm &) const;
+    /**
+     * Make a checkpoint the latest one and return the number of the
+     * previous one, -1 if there is none. Only called by the writer.
+     */
+    int record(const int output_index) const;
+
+  private:
+    const std::string filename;
+  };
+
+  /*! \brief Checkpoints kept on the nodes, each rank with a copy on another
+   *  node.
+   *
+   *  Every rank writes its part of the state to a node-local directory,
+   *  typically the RAM disk /dev/shm, and sends it to its keeper, the rank
+   *  one node further, which writes it next to its own. A job restarted with
+   *  one of the nodes replaced gets the parts of the lost ranks back from
+   *  their keepers. The restart needs the same number of ranks placed on the
+   *  nodes in the same way. Only the latest checkpoint is kept.
+   */
+  class BuddyCheckpoint
+  {
+  public:
+    /// The parts are stored in directory/name.buddy.rank.step, which is
+    /// collective over the communicator.
+    BuddyCheckpoint(const std::string &name,
+                    const std::string &directory,
+                    const MPI_Comm &mpi_communicator);
+    /**
+     * Write the part of this rank and the copy of the part it keeps, then
+     * remove the older checkpoint. Collective.
+     */
+    void save(const int step, const std::vector<char> &part) const;
+    /**
+     * The latest step that all the parts can be restored from, either from
+     * their owner or their keeper, -1 if there is none. Collective.
+     */
+    int latest() const;
+    /// The part of this rank at the given step. Collective.
+    std::vector<char> load(const int step) const;
+
+  private:
+    std::string filename(const unsigned int owner, const int step) const;
+    /// The steps of the parts of the owner that are found on this node.
+    std::vector<int> find(const unsigned int owner) const;
+
+    const std::string name;
+    const std::string directory;
+    const MPI_Comm mpi_communicator;
+    const unsigned int rank;
+    /// The rank that keeps the copy of the part of this rank.
+    unsigned int keeper;
+    /// The rank whose part this rank keeps.
+    unsigned int kept;
+  };
+
+  /*! \brief A 64-bit FNV-1a checksum of raw data.
+   *
+   *  Used to key the files cached between runs on what they were computed
+   *  from. It is not meant to be collision resistant against crafted input.
+   */
+  class Checksum
+  {
+  public:
+    void add(const void *data, const std::size_t size)
+    {
+      const unsigned char *bytes = static_cast<const unsigned char *>(data);
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+    template <typename T>
+    void add(const T &value)
+    {
+      add(&value, sizeof(T));
+    }
+    std::uint64_t value() const { return hash; }
+
+  private:
+    std::uint64_t hash = 14695981039346656037ull;
+  };
+
+  /*! \brief Parallel HDF5 output with an XDMF file to read it.
+   *
+   *  Every rank writes its own patches collectively to one HDF5 file per
+   *  output, and name.xdmf lists all of them with their times. If the mesh
+   *  is reused, it is written to a file of its own once and only the fields
+   *  are written after that, until the mesh is invalidated. The rewritten
+   *  XDMF file only lists the outputs since the start of the run.
+   */
+  class XDMFOutput
+  {
+  public:
+    XDMFOutput(const std::string &name, const bool reuse_mesh);
+    /// Write the mesh again in the next output, called when it changes.
+    void invalidate_mesh() { mesh_filename.clear(); }
+    /// Write the built patches, collective over the communicator.
+    template <int dim, int spacedim>
+    void write(const DataOutInterface<dim, spacedim> &,
+               const unsigned int output_index,
+               const double time,
+               const MPI_Comm &);
+
+  private:
+    const std::string name;
+    const bool reuse_mesh;
+    /// The file holding the current mesh, empty if it is out of date.
+    std::string mesh_filename;
+    std::vector<XDMFEntry> entries;
+  };
+
+  /*! \brief A scalar time series appended to a CSV file.
+   *
+   *  Rank 0 writes the header when it creates the file and then one row per
+   *  record, which is flushed so that the file can be followed while the
+   *  simulation runs. An existing file is appended to, e.g. after a restart.
+   *  The other ranks do nothing.
+   */
+  class MonitorFile
+  {
+  public:
+    MonitorFile(const std::string &filename, const MPI_Comm &);
+    /// Write a row of values, the column names are only used for the header.
+    void write(const double time,
+               const std::vector<std::string> &columns,
+               const std::vector<double> &values);
+
+  private:
+    const std::string filename;
+    const bool writer;
+    std::ofstream out;
+  };
+
+  /*! \brief A per-step log of the nonlinear and linear solvers.
+   *
+   *  A solver records its Newton iterations, outer linear solves, the
+   *  iterations of the inner solves of its preconditioner by name, and the
+   *  number and wall time of the preconditioner setups. write_step() appends
+   *  them as one row of a CSV file through a MonitorFile and starts the next
+   *  step. The inner solves become columns the first time they are recorded,
+   *  so a solver must record all of them in the first step it writes, zero
+   *  if need be. The counts are the same on all the ranks, the setup time is
+   *  the one of rank 0, which writes the file. Nothing is done if the log is
+   *  disabled.
+   */
+  class SolverLog
+  {
+  public:
+    SolverLog(const std::string &filename,
+              const MPI_Comm &,
+              const bool enabled);
+    bool enabled() const { return active; }
+    /// Record a Newton iteration with the nonlinear residual after it.
+    void add_newton_iteration(const double residual);
+    /// Record an outer linear solve.
+    void add_linear_solve(const unsigned int iterations, const double residual);
+    /// Record the iterations of an inner solve of the preconditioner.
+    void add_inner_iterations(const std::string &solve,
+                              const unsigned int iterations);
+    /// Record a preconditioner setup, or factorization, and its wall time.
+    void add_preconditioner_setup(const double wall_time);
+    /// Append the row of the step and reset the counters.
+    void write_step(const unsigned int timestep, const double time);
+
+  private:
+    const bool active;
+    MonitorFile file;
+    unsigned int newton_iterations;
+    unsigned int linear_solves;
+    unsigned int linear_iterations;
+    std::vector<std::pair<std::string, unsigned int>> inner_iterations;
+    unsigned int preconditioner_setups;
+    double preconditioner_setup_time;
+    double linear_residual;
+    double residual;
+  };
+
+  /*! \brief The registry of the solver timers, which reports them across
+   *  the ranks.
+   *
+   *  Every solver registers its TimerOutput under a name when it is
+   *  constructed and removes it when it is destroyed, which prints the
+   *  usual summary. If the report is enabled, the minimum, maximum and mean
+   *  of the wall time of every section over the ranks are also written to
+   *  timing-<name>.json, and record_step() appends the time spent in every
+   *  section during the last step to timing_steps.csv. The statistics are
+   *  collective over the communicator of a timer, whose sections are
+   *  entered by all of its ranks anyway. The files are written by rank 0.
+   */
+  class TimingReport
+  {
+  public:
+    static TimingReport &instance();
+
+    void add(const std::string &name,
+             const TimerOutput &,
+             const MPI_Comm &,
+             const bool enabled);
+
+    /// Print the summary of a timer, write its report and unregister it.
+    void remove(const TimerOutput &);
+
+    /// The name a timer is registered under, empty if it is not.
+    std::string name(const TimerOutput &) const;
+
+    /**
+     * Record the time of every section of the enabled timers since the last
+     * call. Called by the driver of the time loop after every step.
+     */
+    void record_step(const unsigned int timestep, const double time);
+
+  private:
+    struct Entry
+    {
+      std::string name;
+      const TimerOutput *timer;
+      MPI_Comm mpi_communicator;
+      bool enabled;
+      /// The total wall time of every section at the last record.
+      std::map<std::string, double> recorded;
+    };
+
+    TimingReport() = default;
+
+    /// The statistics of a quantity of every section over the ranks.
+    static std::map<std::string, Utilities::MPI::MinMaxAvg>
+    statistics(const std::map<std::string, double> &, const MPI_Comm &);
+
+    std::list<Entry> entries;
+    std::ofstream steps;
+  };
+
+  /*! \brief The timeline of the solver phases, in the Chrome trace format.
+   *
+   *  While it is enabled, every TraceScope records a complete event with its
+   *  begin and duration, the rank as the process and the thread. write()
+   *  gathers the events of all the ranks and writes trace.json on rank 0,
+   *  which can be opened in chrome://tracing or Perfetto to see the stalls
+   *  and the imbalance that the totals of the timers average out. The clocks
+   *  of the ranks are started at a barrier, so they are aligned to the
+   *  latency of the barrier.
+   */
+  class Tracer
+  {
+  public:
+    static Tracer &instance();
+
+    /// Start recording if requested and not already recording, collective.
+    void enable(const bool requested, const MPI_Comm &);
+    bool enabled() const { return active; }
+    /// The time since the start in microseconds.
+    double now() const;
+    void record(const std::string &name,
+                const std::string &category,
+                const double begin,
+                const double end);
+    /// Write all the events so far to trace.json, collective.
+    void write(const MPI_Comm &) const;
+
+  private:
+    struct Event
+    {
+      std::string name;
+      std::string category;
+      double begin;
+      double duration;
+      unsigned int thread;
+    };
+
+    Tracer() : active(false) {}
+
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    std::vector<Event> events;
+    /// The threads are numbered in the order they record their first event.
+    std::map<std::thread::id, unsigned int> threads;
+    mutable std::mutex mutex;
+  };
+
+  /// A phase that is recorded by the Tracer from construction to
+  /// destruction if it is enabled.
+  class TraceScope
+  {
+  public:
+    TraceScope(const std::string &name, const std::string &category);
+    ~TraceScope();
+
+  private:
+    const bool active;
+    std::string name;
+    std::string category;
+    double begin;
+  };
+
+  /*! \brief The breakdown of the time from the start of the program to the
+   *  end of the first time step.
+   *
+   *  The initialization path (mesh refinement, dof setup, constraints,
+   *  sparsity, system initialization, checkpoint loading, FSI setup) is
+   *  marked with StartupScopes, which are recorded until the report. The
+   *  driver calls begin_steps() before its time loop and report() after the
+   *  first step, which prints the minimum and maximum over the ranks of
+   *  every section, the unmarked rest, which includes the mesh generation in
+   *  main(), and the first step with the sections it entered, e.g. the
+   *  preconditioner setup. The later steps are the steady state, which is
+   *  reported by the TimingReport. report() is collective, and the sections
+   *  must be entered in the same order on all the ranks, which holds for
+   *  the collective initialization functions.
+   */
+  class StartupProfile
+  {
+  public:
+    static StartupProfile &instance();
+
+    /// Whether the sections are still recorded.
+    bool recording() const { return !reported; }
+    /// Enter a section and return its nesting depth.
+    unsigned int enter();
+    void leave(const std::string &section,
+               const unsigned int depth,
+               const double wall_time);
+    /// Mark the start of the time loop.
+    void begin_steps();
+    /// Print the summary once, after the first step.
+    void report(const MPI_Comm &, std::ostream &);
+
+  private:
+    struct Section
+    {
+      std::string name;
+      unsigned int depth;
+      bool in_first_step;
+      unsigned int calls;
+      double wall_time;
+    };
+
+    StartupProfile();
+
+    /// The seconds since the start of the program.
+    double elapsed() const;
+
+    std::chrono::steady_clock::time_point start;
+    std::vector<Section> sections;
+    unsigned int depth;
+    double steps_begin;
+    bool reported;
+  };
+
+  /// A section of the initialization path, recorded by the StartupProfile
+  /// and traced, until the startup is reported.
+  class StartupScope
+  {
+  public:
+    explicit StartupScope(const std::string &section);
+    ~StartupScope();
+
+  private:
+    const bool active;
+    std::string section;
+    unsigned int depth;
+    Timer timer;
+    TraceScope trace;
+  };
+
+  /*! \brief A TimerOutput::Scope that also pushes a PETSc log stage.
+   *
+   *  The stage is named "<timer>: <section>" after the name the timer is
+   *  registered under in the TimingReport, so -log_view breaks the flops,
+   *  messages and reductions of PETSc down like the timer sections. The
+   *  stages are registered the first time they are entered, which gives
+   *  them the same ids on all the ranks as long as the sections are entered
+   *  in the same order, as the collective ones are. Nested sections push
+   *  nested stages. Without PETSc logging this is a TimerOutput::Scope.
+   *  The section is also a TraceScope with the timer name as category.
+   */
+  class TimerScope
+  {
+  public:
+    TimerScope(TimerOutput &timer, const std::string &section);
+    ~TimerScope();
+
+  private:
+#ifdef PETSC_USE_LOG
+    /// The stage of a name, registered on first use.
+    static PetscLogStage stage(const std::string &name);
+#endif
+    TimerOutput::Scope scope;
+    TraceScope trace;
+  };
+
+  /*! \brief An array stored once per node in an MPI-3 shared memory window.
+   *
+   *  The ranks of a node share a single copy, which only the first rank of
+   *  the node writes, and all the ranks of the node read after
+   *  synchronize(). Without sharing, every rank has a private copy and
+   *  writes it itself. T must be trivially copyable.
+   */
+  template <typename T>
+  class NodeSharedArray
+  {
+  public:
+    NodeSharedArray() = default;
+    NodeSharedArray(const NodeSharedArray &) = delete;
+    NodeSharedArray &operator=(const NodeSharedArray &) = delete;
+    ~NodeSharedArray() { free(); }
+
+    /// Allocate n entries, collective over the communicator if shared.
+    void reinit(const MPI_Comm &mpi_communicator,
+                const std::size_t n,
+                const bool shared)
+    {
+      free();
+      n_entries = n;
+      if (!shared)
+        {
+          private_values.resize(n);
+          values = private_values.data();
+          writer = true;
+          return;
+        }
+      int ierr = MPI_Comm_split_type(mpi_communicator,
+                                     MPI_COMM_TYPE_SHARED,
+                                     0,
+                                     MPI_INFO_NULL,
+                                     &node_communicator);
+      AssertThrowMPI(ierr);
+      writer = (Utilities::MPI::this_mpi_process(node_communicator) == 0);
+      // Only the writer allocates, the others map its segment.
+      T *base = nullptr;
+      ierr = MPI_Win_allocate_shared(writer ? n * sizeof(T) : 0,
+                                     sizeof(T),
+                                     MPI_INFO_NULL,
+                                     node_communicator,
+                                     &base,
+                                     &window);
+      AssertThrowMPI(ierr);
+      MPI_Aint bytes;
+      int disp_unit;
+      ierr = MPI_Win_shared_query(window, 0, &bytes, &disp_unit, &values);
+      AssertThrowMPI(ierr);
+      ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+      AssertThrowMPI(ierr);
+    }
+
+    /// Whether this rank writes the entries.
+    bool is_writer() const { return writer; }
+
+    /// Make the entries written by the writer visible to the node, which is
+    /// collective over the node.
+    void synchronize()
+    {
+      if (window == MPI_WIN_NULL)
+        return;
+      int ierr = MPI_Win_sync(window);
+      AssertThrowMPI(ierr);
+      ierr = MPI_Barrier(node_communicator);
+      AssertThrowMPI(ierr);
+      ierr = MPI_Win_sync(window);
+      AssertThrowMPI(ierr);
+    }
+
+    std::size_t size() const { return n_entries; }
+    const T *data() const { return values; }
+    T *data() { return values; }
+    const T &operator[](const std::size_t i) const { return values[i]; }
+    T &operator[](const std::size_t i) { return values[i]; }
+
+    /// The bytes held by this rank, the shared copy counts for its writer.
+    std::size_t memory_consumption() const
+    {
+      return writer ? n_entries * sizeof(T) : 0;
+    }
+
+  private:
+    void free()
+    {
+      if (window != MPI_WIN_NULL)
+        {
+          MPI_Win_unlock_all(window);
+          MPI_Win_free(&window);
+          MPI_Comm_free(&node_communicator);
+        }
+      private_values.clear();
+      values = nullptr;
+      n_entries = 0;
+      writer = false;
+    }
+
+    MPI_Comm node_communicator = MPI_COMM_NULL;
+    MPI_Win window = MPI_WIN_NULL;
+    std::vector<T> private_values;
+    T *values = nullptr;
+    std::size_t n_entries = 0;
+    bool writer = false;
+  };
+
+  /*! \brief The memory of the components of a solver over the ranks.
+   *
+   *  The components are added with the bytes they use on this rank, mostly
+   *  from their memory_consumption(). print() prints the minimum, maximum and
+   *  total of every component over the ranks, then the current and peak
+   *  resident set sizes of the processes. The part of the resident set that
+   *  is not in any component, such as the MUMPS factors, the temporaries and
+   *  the other solvers in the process, is printed as untracked. The last
+   *  line is the memory of the nodes, the sum of the proportional set sizes
+   *  of their ranks, which counts the pages shared on a node once. print()
+   *  is collective, so the components must be added in the same order on
+   *  all the ranks.
+   */
+  class MemoryReport
+  {
+  public:
+    MemoryReport(const std::string &title, const MPI_Comm &);
+    /// Add the memory of a component on this rank in bytes.
+    void add(const std::string &component, const std::size_t bytes);
+    /// Print the report on rank 0.
+    void print(std::ostream &) const;
+
+  private:
+    const std::string title;
+    MPI_Comm mpi_communicator;
+    std::vector<std::pair<std::string, double>> components;
+  };
+
+  /*! \brief A .pvd file that grows with the output instead of being
+   *  rewritten.
+   *
+   *  The offsets of the records in the file are kept, so a new output only
+   *  writes its own records and the closing tags over the old ones. If the
+   *  list shrinks, e.g. when a time step is repeated, the file is cut back
+   *  to the records that are kept. The first write of a run starts the
+   *  file over from the whole list, which is how a restart resumes it.
+   */
+  class PVDRecord
+  {
+  public:
+    explicit PVDRecord(const std::string &filename);
+    /// Bring the file up to date with the list, whose leading records
+    /// must not have changed since the last write.
+    void write(const std::vector<std::pair<double, std::string>> &);
+
+  private:
+    const std::string filename;
+    /// The offset of every record written, then that of the closing tags.
+    std::vector<std::uint64_t> offsets;
+  };
+
+  /*! \brief Time-varying boundary values read from a memory-mapped table.
+   *
+   *  The binary file consists of
+   *  - the 8 characters OIFEMBDT,
+   *  - the numbers of boundaries, components and times as 64-bit integers,
+   *  - the boundary ids as 64-bit integers,
+   *  - the increasing times as doubles,
+   *  - the values as doubles, by time, then boundary, then component.
+   *
+   *  The file is mapped rather than read, so opening it costs nothing and
+   *  only the pages around the current time are ever loaded. The values are
+   *  interpolated linearly in time and held constant outside the table.
+   *  The interval of the last query is remembered, so stepping forward in
+   *  time does not search the table.
+   */
+  class BoundaryDataTable
+  {
+  public:
+    /// Map a table, an empty filename means an empty table.
+    explicit BoundaryDataTable(const std::string &filename);
+    ~BoundaryDataTable();
+    BoundaryDataTable(const BoundaryDataTable &) = delete;
+    BoundaryDataTable &operator=(const BoundaryDataTable &) = delete;
+
+    bool has_boundary(const unsigned int boundary_id) const;
+    unsigned int n_components() const { return components; }
+
+    /**
+     * Overwrite the values with those of a boundary at the given time. They
+     * are left untouched if the boundary is not in the table, otherwise
+     * their number must match the components of the table.
+     */
+    void value(const unsigned int boundary_id,
+               const double time,
+               std::vector<double> &values) const;
+
+    /// Write a table, the values are ordered as in the file.
+    static void write(const std::string &filename,
+                      const std::vector<unsigned int> &boundary_ids,
+                      const std::vector<double> &times,
+                      const std::vector<double> &values);
+
+  private:
+    void *mapping = nullptr;
+    std::size_t mapping_size = 0;
+    unsigned int components = 0;
+    /// The position of every boundary id in the table.
+    std::map<unsigned int, unsigned int> boundaries;
+    const double *times = nullptr;
+    std::size_t n_times = 0;
+    const double *values = nullptr;
+    /// The interval of the last query, queries may come from several threads.
+    mutable std::atomic<std::size_t> interval{0};
+  };
+
+  /*! \brief DataOut restricted to the active cells that pass a filter.
+   *
+   *  Used to clip the output to a region, and by the solvers on serial
+   *  triangulations partitioned by hand so that every rank builds the
+   *  patches of its own cells only. On a distributed triangulation only the
+   *  locally owned cells that pass are output.
+   */
+  template <int dim, int spacedim = dim>
+  class FilteredDataOut : public DataOut<dim, DoFHandler<dim, spacedim>>
+  {
+  public:
+    using cell_iterator =
+      typename DataOut<dim, DoFHandler<dim, spacedim>>::cell_iterator;
+    using Filter = std::function<bool(const cell_iterator &)>;
+    explicit FilteredDataOut(const Filter &filter) : filter(filter) {}
+    virtual cell_iterator first_cell() override;
+    virtual cell_iterator next_cell(const cell_iterator &) override;
+    /**
+     * A task that writes the built patches to a VTU file. It works on a copy
+     * of the patches, so it can run on a WriterQueue while the mesh and the
+     * vectors change.
+     */
+    std::function<void()> vtu_task(const std::string &filename,
+                                   const DataOutBase::VtkFlags &) const;
+
+  private:
+    /// The first active cell that passes from a cell on.
+    cell_iterator
+    skip(typename Triangulation<dim, spacedim>::active_cell_iterator) const;
+    const Filter filter;
+  };
+
+  /*! \brief The output controls of the solvers.
+   *
+   *  A field is written if the list of output fields is empty or names it,
+   *  and the stress and strain only every stress output interval. The cells
+   *  are clipped to the output box and material ids if they are given. The
+   *  compression applies to the VTU output, the data is always written in
+   *  single precision by DataOut.
+   */
+  class OutputControl
+  {
+  public:
+    explicit OutputControl(const Parameters::AllParameters &);
+    bool write_field(const std::string &name) const;
+    /// Whether the stress and strain fields are written at this time.
+    bool write_stress(const Time &) const;
+    /// Whether a cell is in the output region.
+    template <typename CellIteratorType>
+    bool write_cell(const CellIteratorType &cell) const
+    {
+      if (!material_ids.empty() &&
+          std::find(material_ids.begin(),
+                    material_ids.end(),
+                    static_cast<int>(cell->material_id())) ==
+            material_ids.end())
+        {
+          return false;
+        }
+      const auto center = cell->center();
+      const unsigned int n = std::min<unsigned int>(box.size() / 2,
+                                                    center.dimension);
+      for (unsigned int d = 0; d < n; ++d)
+        {
+          if (center[d] < box[d] || center[d] > box[n + d])
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+    /// The VTU flags with the compression.
+    DataOutBase::VtkFlags vtk_flags() const;
+    /// Apply the compression to a DataOut.
+    template <int dim, int spacedim>
+    void set_flags(DataOutInterface<dim, spacedim> &) const;
+
+  private:
+    const std::vector<std::string> fields;
+    const std::vector<double> box;
+    const std::vector<int> material_ids;
+    const std::string compression;
+    const double stress_interval;
+  };
+
+  /*! \brief The Eisenstat-Walker forcing terms of an inexact Newton method.
+   *
+   *  The k-th linear solve of a Newton loop is solved to a relative tolerance
+   *  eta_k = gamma * (|r_k| / |r_{k-1}|)^alpha, choice 2 of Eisenstat and
+   *  Walker (1996) with gamma = 0.9 and alpha = (1 + sqrt(5)) / 2, safeguarded
+   *  against dropping much faster than the previous term. It is not smaller
+   *  than needed to reach the nonlinear tolerance relative to |r_0|, and is
+   *  limited to [min_eta, max_eta]. The first solve of a loop is solved to
+   *  min(0.3, max_eta).
+   */
+  class ForcingTerm
+  {
+  public:
+    ForcingTerm(const double min_eta,
+                const double max_eta,
+                const double nonlinear_tolerance)
+      : min_eta(min_eta),
+        max_eta(max_eta),
+        nonlinear_tolerance(nonlinear_tolerance),
+        initial_residual(0),
+        previous_residual(0),
+        eta(0)
+    {
+    }
+    /// Start a new Newton loop.
+    void reset() { previous_residual = 0; }
+    /// The relative tolerance of the next linear solve given the norm of its
+    /// right-hand side, i.e. the current nonlinear residual.
+    double next(const double residual);
+
+  private:
+    const double min_eta;
+    const double max_eta;
+    const double nonlinear_tolerance;
+    double initial_residual;
+    double previous_residual;
+    double eta;
+  };
+
+  /*! \brief Extrapolate the initial guess of a time step from the solutions
+   *  of the previous ones.
+   *
+   *  The guess is the polynomial through the last order + 1 solutions,
+   *  evaluated at the end of the step. With order 1 it is
+   *  u_n + (dt_n / dt_{n-1}) (u_n - u_{n-1}), which is 2 u_n - u_{n-1} with
+   *  a constant time step size, and with order 2 it is
+   *  3 u_n - 3 u_{n-1} + u_{n-2} with a constant one. Order 0 disables the
+   *  prediction. The recorded solutions must be non-ghosted, and the history
+   *  has to be cleared whenever the dofs change.
+   */
+  template <typename VectorType>
+  class SolutionPredictor
+  {
+  public:
+    SolutionPredictor(const unsigned int order) : order(order) {}
+    /// Record the converged solution of a time step of the given size.
+    void record(const VectorType &solution, const double delta_t);
+    /// Extrapolate the solution at the end of the next time step, of the
+    /// given size, into a non-ghosted vector, return false if the history is
+    /// too short to do so.
+    bool predict(VectorType &guess, const double delta_t) const;
+    /// Forget the history, e.g., after the mesh is refined.
+    void clear()
+    {
+      history.clear();
+      step_sizes.clear();
+    }
+
+  private:
+    const unsigned int order;
+    /// The latest solutions, the most recent one first.
+    std::list<VectorType> history;
+    /// The sizes of the steps that led to them.
+    std::list<double> step_sizes;
+  };
+
+  /*! \brief Detect that a transient run has reached a steady state.
+   *
+   *  The rate of change of the solution, ||u_n - u_{n-1}|| /
+   *  ((t_n - t_{n-1}) ||u_n||), is compared with the tolerance after every
+   *  step, which may have a size of its own, and the run is steady
+   *  once it has stayed below it for n_steps consecutive steps. A tolerance
+   *  of 0 disables the monitor. The solutions may be ghosted, the monitor
+   *  keeps a non-ghosted copy of the last one and starts over whenever the
+   *  dofs change.
+   */
+  template <typename VectorType>
+  class SteadyStateMonitor
+  {
+  public:
+    SteadyStateMonitor(const double tolerance, const unsigned int n_steps)
+      : tolerance(tolerance),
+        n_steps(n_steps),
+        count(0),
+        last_rate(0),
+        previous_time(0)
+    {
+    }
+    /// Record the solution at the given time, return whether the run is
+    /// steady.
+    bool record(const VectorType &solution, const double time);
+    /// The rate of change of the last step.
+    double rate() const { return last_rate; }
+
+  private:
+    const double tolerance;
+    const unsigned int n_steps;
+    /// Number of consecutive steps below the tolerance.
+    unsigned int count;
+    double last_rate;
+    double previous_time;
+    VectorType previous;
+    VectorType change;
+  };
+
+  /*! \brief A proper orthogonal decomposition basis of solution snapshots.
+   *
+   *  The modes are computed with the method of snapshots: the eigenvectors
+   *  of the correlation matrix of the snapshots, whose size is the number of
+   *  snapshots, combine them into orthonormal modes. The modes of the
+   *  largest eigenvalues are kept until they hold the requested fraction of
+   *  the energy, i.e., of the sum of the eigenvalues. The basis is saved
+   *  with the sizes of the blocks, so it cannot be loaded on another mesh.
+   */
+  class PODBasis
+  {
+  public:
+    /// Add a snapshot, all of them must be on the same mesh.
+    void add_snapshot(const BlockVector<double> &snapshot);
+    /// Compute at most max_modes modes that hold the given fraction of the
+    /// energy, and release the snapshots.
+    void compute(const double energy, const unsigned int max_modes);
+    unsigned int n_modes() const { return modes.size(); }
+    const BlockVector<double> &mode(const unsigned int i) const
+    {
+      return modes[i];
+    }
+    /// Whether there are modes of the block sizes of the given vector.
+    bool matches(const BlockVector<double> &layout) const;
+    void save(const std::string &filename) const;
+    /// Load the basis, return false if there is no file or it does not
+    /// match the block sizes of the given vector.
+    bool load(const std::string &filename, const BlockVector<double> &layout);
+
+  private:
+    std::vector<BlockVector<double>> snapshots;
+    std::vector<BlockVector<double>> modes;
+  };
+
+  /*! \brief Run the cases of a parameter sweep on groups of processes.
+   *
+   *  Every line of the case file is a case, given as overrides of the base
+   *  input file separated by semicolons, e.g.
+   *  "Fluid material/Viscosity = 0.01; Simulation/End time = 2". Empty lines
+   *  and lines starting with # are skipped. The processes are split into
+   *  n_groups sub-communicators, and the cases are dealt out to the groups
+   *  round robin, each of them running in a directory case_<k> of its own.
+   *
+   *  The solvers set up their dofs in run(), so what the cases of a group
+   *  share goes through the caches: the globally refined meshes are kept in
+   *  the mesh cache, which defaults to mesh_cache/group_<g> in the working
+   *  directory, and the solid setup cache of a case is carried into the
+   *  next one. The refinement, the solid partition, dof numbering and
+   *  sparsity are thus computed once per group for cases on the same mesh.
+   */
+  class Ensemble
+  {
+  public:
+    Ensemble(const std::string &case_file,
+             const MPI_Comm comm,
+             const unsigned int n_groups);
+    ~Ensemble();
+    /// The communicator of the group of this process, which the cases
+    /// build their triangulations on.
+    MPI_Comm get_communicator() const { return group_communicator; }
+    /// The number of cases.
+    unsigned int n_cases() const { return cases.size(); }
+    /// Run the cases of this group one after another. The runner gets the
+    /// parameters of the base input file with the overrides of the case,
+    /// and the index of the case.
+    void run(const std::string &infile,
+             const std::function<void(const Parameters::AllParameters &,
+                                      const unsigned int)> &runner) const;
+
+  private:
+    std::vector<std::vector<std::string>> cases;
+    const unsigned int n_groups;
+    unsigned int group;
+    MPI_Comm group_communicator;
+  };
+
   /*! \brief A helper class to generate triangulations and specify boundary ids.
    *
    *  dealii::GridGenerator can be used to generate a few standard grids such as
@@ -142,11 +1275,347 @@ namespace Utils
       cell_point;
   };
 
+  /*! \brief Closed-form shape functions of FE_Q elements of degree 1 and 2.
+   *
+   *  If all the base elements of an element are FE_Q of degree 1 or 2, like
+   *  the Taylor-Hood fluid and the linear solid, its shape functions are
+   *  tensor products of the 1D Lagrange polynomials on 0, 1/2 and 1. They are
+   *  evaluated here from the closed forms of the polynomials, which saves the
+   *  virtual call and the evaluation of the polynomials that
+   *  FiniteElement::shape_value does for every shape function. Other
+   *  elements are not supported, which reinit() reports.
+   */
+  template <int dim>
+  class TensorProductShapes
+  {
+  public:
+    /// Set up for an element, false if it is not supported.
+    bool reinit(const FiniteElement<dim> &);
+    bool supported() const { return fe != nullptr; }
+    /// The values and the gradients on the unit cell of all the shape
+    /// functions at a unit point, either of which may be null.
+    void evaluate(const Point<dim> &,
+                  double *values,
+                  Tensor<1, dim> *gradients) const;
+
+  private:
+    const FiniteElement<dim> *fe = nullptr;
+    /// The degree of every shape function and its 1D indices, in the order
+    /// of the coordinates, in every direction.
+    std::vector<unsigned int> degrees;
+    std::vector<std::array<unsigned int, dim>> indices;
+  };
+
+  /*! \brief Interpolate the solution at a set of points in one pass.
+   *
+   * This is the batched counterpart of GridInterpolator. The points are
+   * located once in reinit, the ones in the same cell are grouped together,
+   * and the shape functions at every point are evaluated on the reference
+   * cell and cached. Evaluating a source vector then only reads the dof
+   * values of each cell once and sums up the cached shape values, so several
+   * vectors can be interpolated without repeating the mapping work.
+   *
+   * The object is meant to be reused: reinit does not free the memory of the
+   * previous batch. Like GridInterpolator, the points that are not found or
+   * are found on cells that are not locally owned get zero values.
+   * Only primitive finite elements and mappings of degree 1 are supported,
+   * by default MappingQ1. A given mapping, e.g. a MappingQEulerian on the
+   * displacement, must outlive the object.
+   *
+   * The points in parallelogram or parallelepiped cells are mapped back to
+   * the unit cell in closed form, and the shape functions of FE_Q elements
+   * of degree 1 and 2 are evaluated by TensorProductShapes. The other cells
+   * and elements go through the Mapping and the FiniteElement.
+   */
+  template <int dim, typename VectorType>
+  class BatchedGridInterpolator
+  {
+  public:
+    typedef typename VectorType::value_type Number;
+
+    BatchedGridInterpolator(const DoFHandler<dim> &,
+                            const std::vector<bool> &mask = {},
+                            const Mapping<dim> *mapping = nullptr);
+    /**
+     * Locate the points (optionally starting from given cells, in which
+     * case the points are assumed to be inside them) and cache the
+     * reference data requested by the flags. Only update_values and
+     * update_gradients are meaningful.
+     */
+    void reinit(
+      const std::vector<Point<dim>> &,
+      const std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells =
+        {},
+      const UpdateFlags flags = update_values);
+    /// Interpolate several vectors at all the points, values[v][p] is the
+    /// value of the v-th vector at the p-th point.
+    void point_values(const std::vector<const VectorType *> &,
+                      std::vector<std::vector<Vector<Number>>> &values) const;
+    /// Interpolate the gradient of a vector at all the points,
+    /// gradients[p][c] is the gradient of the c-th component at point p.
+    void point_gradients(
+      const VectorType &,
+      std::vector<std::vector<Tensor<1, dim, Number>>> &gradients) const;
+
+    /// The dofs and the shape values of one component at a point, so that
+    /// the interpolation can be assembled into a matrix. Empty if the point
+    /// has no value.
+    void point_weights(const unsigned int,
+                       const unsigned int component,
+                       std::vector<types::global_dof_index> &dofs,
+                       std::vector<double> &weights) const;
+
+    unsigned int n_points() const { return cell_points.size(); }
+    bool found_cell(const unsigned int i) const
+    {
+      return cell_points[i].first != dof_handler.end();
+    }
+    const typename DoFHandler<dim>::active_cell_iterator
+    get_cell(const unsigned int i) const
+    {
+      return cell_points[i].first;
+    }
+
+  private:
+    /// The given mapping, or MappingQ1 if there is none.
+    const Mapping<dim> &get_mapping() const
+    {
+      return mapping ? *mapping : q1_mapping;
+    }
+
+    /// The unit point of a point in a cell, without the Newton iteration of
+    /// the mapping if the mapped cell is affine.
+    Point<dim> transform_real_to_unit_cell(
+      const typename DoFHandler<dim>::active_cell_iterator &,
+      const Point<dim> &) const;
+
+    const DoFHandler<dim> &dof_handler;
+    const std::vector<bool> mask;
+    MappingQ1<dim> q1_mapping;
+    const Mapping<dim> *mapping;
+    UpdateFlags update_flags;
+    /// The cell and the unit point of every point.
+    std::vector<
+      std::pair<typename DoFHandler<dim>::active_cell_iterator, Point<dim>>>
+      cell_points;
+    /// The points in group g are grouped_points[group_begin[g],
+    /// group_begin[g + 1]), they are in the same locally owned cell.
+    std::vector<unsigned int> grouped_points;
+    std::vector<unsigned int> group_begin;
+    /// The component of every shape function.
+    std::vector<unsigned int> shape_components;
+    /// Shape values and real-space gradients at every point, stored
+    /// contiguously with dofs_per_cell entries per point.
+    std::vector<double> shape_values;
+    std::vector<Tensor<1, dim>> shape_gradients;
+    TensorProductShapes<dim> tensor_product_shapes;
+  };
+
+  /*! \brief Take the number of threads per MPI rank from the command line.
+   *
+   * "--threads N" or "--threads=N" is removed from argv, so the positional
+   * arguments keep their places, and the result is meant for
+   * Utilities::MPI::MPI_InitFinalize. Without the option every rank runs a
+   * single thread as before. With N = 0 every rank uses all the cores
+   * available to it, which should be bound per rank by the MPI launcher.
+   */
+  unsigned int extract_n_threads(int &argc, char **argv);
+
+  /// The ranks of the communicator and the threads of each rank, for the
+  /// header of a run.
+  std::string parallel_configuration(const MPI_Comm &);
+
+  /**
+   * Split the communicator into groups of group_size consecutive ranks and
+   * return the group of this rank, which the caller must free. With a
+   * group size of 0, or not smaller than the communicator, the communicator
+   * is duplicated. The number of ranks must be a multiple of the group size.
+   */
+  MPI_Comm group_communicator(const MPI_Comm &, const unsigned int group_size);
+
+  /**
+   * Split the communicator into its first n_first ranks and the rest, and
+   * return the part of this rank, which the caller must free. Both parts
+   * must be nonempty.
+   */
+  MPI_Comm split_communicator(const MPI_Comm &, const unsigned int n_first);
+
+  /// Exchange vectors of doubles with a few ranks through
+  /// Utilities::MPI::some_to_some, the message to this rank itself is copied
+  /// directly. This function is collective.
+  std::map<unsigned int, std::vector<double>>
+  exchange_doubles(MPI_Comm,
+                   const std::map<unsigned int, std::vector<double>> &);
+
+  /*! \brief Renumber the dofs for locality.
+   *
+   *  The scheme is None, Cuthill-McKee, Hierarchical (the cells in the
+   *  Z-order of the refinement tree) or Hilbert (the cells along a Hilbert
+   *  curve through their centers). The cells of a distributed triangulation
+   *  are already partitioned along a Z-curve and cannot be renumbered across
+   *  ranks, so Hilbert means Hierarchical there.
+   */
+  template <int dim, int spacedim>
+  void renumber_dofs(DoFHandler<dim, spacedim> &, const std::string &scheme);
+
+  /*! \brief Refine a coarse mesh globally through a cache of refined meshes.
+   *
+   *  The cached meshes are named after a checksum of the coarse mesh and
+   *  the refinement level, so a mesh created with other parameters never
+   *  matches. A distributed triangulation is saved and loaded with its own
+   *  forest files. For a serial triangulation only the refined vertices are
+   *  cached: the mesh is refined with flat manifolds, which is cheap, and
+   *  the vertices are moved to the cached positions. The manifolds are
+   *  restored either way, so the mesh can be refined further. An empty
+   *  directory disables the cache. This is collective over the
+   *  communicator of a distributed triangulation.
+   */
+  template <int dim, int spacedim>
+  void refine_global_cached(Triangulation<dim, spacedim> &,
+                            const unsigned int n_refinements,
+                            const std::string &cache_directory);
+
+  /*! \brief Interpolate a distributed solution at points owned by any rank.
+   *
+   * This is the building block for coupling with a solver whose mesh is a
+   * parallel::distributed::Triangulation, where a query point usually falls
+   * into a cell owned by another rank. Every rank publishes the bounding box
+   * of its locally owned cells, and a query point is only sent to the ranks
+   * whose boxes contain it. These ranks locate the points in their locally
+   * owned cells with a BatchedGridInterpolator and report back, the lowest
+   * rank that finds a point owns it. Evaluating a vector then only exchanges
+   * the values at the points between the involved ranks, so no rank ever
+   * needs the whole mesh or a localized copy of the solution.
+   *
+   * A rank may also have no mesh at all, e.g. when it belongs to another
+   * group of processes that runs a different solver. It only queries points
+   * and is never sent any, and it passes null pointers as source vectors.
+   *
+   * reinit, point_values and point_gradients are collective. The source
+   * vectors must be ghosted because the dof values of locally owned cells are
+   * read.
+   */
+  template <int dim, typename VectorType>
+  class RemotePointEvaluator
+  {
+  public:
+    RemotePointEvaluator(const DoFHandler<dim> &, MPI_Comm);
+    /// A rank without the mesh, which only queries the values with the given
+    /// number of components.
+    RemotePointEvaluator(const unsigned int n_components, MPI_Comm);
+    /// Locate the local query points on all the ranks. The gradients can
+    /// only be evaluated if update_gradients is among the flags.
+    void reinit(const std::vector<Point<dim>> &,
+                const UpdateFlags flags = update_values);
+    /// Interpolate several vectors at the local query points,
+    /// values[v][p] is the value of the v-th vector at the p-th point,
+    /// zero if the point is not found on any rank.
+    void point_values(const std::vector<const VectorType *> &,
+                      std::vector<std::vector<Vector<double>>> &values);
+    /// Interpolate the gradient of a vector at the local query points,
+    /// gradients[p][c] is the gradient of the c-th component at point p,
+    /// zero if the point is not found on any rank.
+    void point_gradients(const VectorType *,
+                         std::vector<std::vector<Tensor<1, dim>>> &gradients);
+    bool found_cell(const unsigned int i) const
+    {
+      return point_owner[i] != numbers::invalid_unsigned_int;
+    }
+
+  private:
+    /// The mesh of this rank, null if it only queries.
+    const DoFHandler<dim> *dof_handler;
+    const unsigned int n_components;
+    MPI_Comm mpi_communicator;
+    const unsigned int this_mpi_process;
+    /// Whether the i-th received point is in a locally owned cell.
+    bool found_locally(const unsigned int) const;
+
+    /// Locates the points received from all the ranks, rebuilt in every
+    /// reinit because its vertex mask depends on the partition.
+    std::unique_ptr<BatchedGridInterpolator<dim, VectorType>> interpolator;
+    /// The bounding boxes of the locally owned cells of every rank.
+    std::vector<std::pair<Point<dim>, Point<dim>>> rank_boxes;
+    /// The local points sent to every rank, in the order they are sent.
+    std::map<unsigned int, std::vector<unsigned int>> requested;
+    /// The number of points received from every rank, the points from rank r
+    /// are located in the interpolator starting from served_begin[r].
+    std::map<unsigned int, unsigned int> served_begin;
+    std::map<unsigned int, unsigned int> served_size;
+    /// The rank that owns every local point.
+    std::vector<unsigned int> point_owner;
+    /// The position of every local point among the points owned by its owner
+    /// that are reported to this rank.
+    std::vector<unsigned int> point_position;
+  };
+
+  /*! \brief A spatial hash of the cell centers for SPH interpolation.
+   *
+   * The cubic spline kernel of a source cell with diameter h vanishes beyond
+   * 2h from its center, so the centers are hashed into a uniform grid whose
+   * spacing is twice the largest diameter. The sources of a target point are
+   * then among the cells in the 3^dim buckets around it, instead of all the
+   * cells in the mesh. Only locally owned cells are considered, the same as
+   * SPHInterpolator. The hash must be rebuilt whenever the mesh changes.
+   */
+  template <int dim>
+  class CellCenterHash
+  {
+  public:
+    CellCenterHash() = default;
+    /// Hash the locally owned active cells.
+    void reinit(const DoFHandler<dim> &);
+    /// The cells with nonzero kernel values at a point.
+    void find_sources(
+      const Point<dim> &,
+      std::vector<
+        std::pair<typename DoFHandler<dim>::active_cell_iterator, double>> &)
+      const;
+    /**
+     * The batched version of find_sources. The sources of target i are
+     * sources[offsets[i], offsets[i + 1]), the kernel value is NOT multiplied
+     * by the cell measure.
+     */
+    void kernel_weights(
+      const std::vector<Point<dim>> &targets,
+      std::vector<unsigned int> &offsets,
+      std::vector<
+        std::pair<typename DoFHandler<dim>::active_cell_iterator, double>>
+        &sources) const;
+    /// The cubic spline kernel with support radius 2h.
+    static double
+    cubic_spline(const Point<dim> &, const Point<dim> &, const double h);
+
+  private:
+    /// The hash of a bucket given by its integer coordinates.
+    unsigned int hash(const std::array<int, dim> &) const;
+    /// Append the sources of a point to the vector.
+    void append_sources(
+      const Point<dim> &,
+      std::vector<
+        std::pair<typename DoFHandler<dim>::active_cell_iterator, double>> &)
+      const;
+
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    std::vector<Point<dim>> centers;
+    std::vector<double> diameters;
+    /// The cells hashed to h are table_cells[table_begin[h],
+    /// table_begin[h + 1]).
+    std::vector<unsigned int> table_begin;
+    std::vector<unsigned int> table_cells;
+    double spacing = 0;
+  };
+
   template <int dim, typename VectorType>
   class SPHInterpolator
   {
   public:
     SPHInterpolator(const DoFHandler<dim> &, const Point<dim> &);
+    /// Find the sources through a hash of the cell centers, which is much
+    /// cheaper than looping over all the cells when there are many targets.
+    SPHInterpolator(const DoFHandler<dim> &,
+                    const Point<dim> &,
+                    const CellCenterHash<dim> &);
     void point_value(const VectorType &,
                      Vector<typename VectorType::value_type> &);
     void point_gradient(
@@ -170,23 +1639,403 @@ namespace Utils
     double cubic_spline(const Point<dim> &, const Point<dim> &, double);
   };
 
+  /*! \brief Spatial index of the solid boundary for the 2D ray-crossing test.
+   *
+   * The inside test casts a ray from the query point in the positive
+   * x-direction and counts the boundary faces it crosses. Only the faces whose
+   * y-extent contains the y-coordinate of the point can be crossed, so the
+   * faces are sorted into uniform horizontal slabs and a query only visits the
+   * slab that contains the point.
+   *
+   * The face coordinates are copied when the index is built, therefore it must
+   * be rebuilt whenever the solid mesh moves.
+   */
+  template <int dim>
+  class BoundaryCrossingIndex
+  {
+  public:
+    BoundaryCrossingIndex();
+    /// Build the index from the boundary faces at their current position,
+    /// or at the given positions of all the vertices of the triangulation.
+    void reinit(const std::list<typename Triangulation<dim>::face_iterator> &,
+                const Point<dim> *vertices = nullptr);
+    /// Check if a point is inside the boundary, points on it are included.
+    bool point_inside(const Point<dim> &) const;
+
+  private:
+    /// The slab that a y-coordinate falls into.
+    unsigned int slab_index(const double) const;
+
+    /// End points of the boundary faces.
+    std::vector<std::pair<Point<dim>, Point<dim>>> segments;
+    /// The faces in slab i are slab_faces[slab_begin[i], slab_begin[i + 1]).
+    std::vector<unsigned int> slab_begin;
+    std::vector<unsigned int> slab_faces;
+    double y_min;
+    double y_max;
+    double slab_height;
+  };
+
+  /*! \brief A uniform bucket grid of cell bounding boxes.
+   *
+   * Every active cell is inserted into the buckets that overlap its bounding
+   * box, so locating a point only tests the cells in the bucket it falls
+   * into instead of every cell in the mesh. The answer is the same as looping
+   * over all cells with cell->point_inside.
+   *
+   * Like BoundaryCrossingIndex, the bounding boxes are computed from the
+   * vertices at the time of building, so the grid must be rebuilt whenever
+   * the mesh moves. With a mapping, the cells are taken as mapped by it
+   * instead, the mapping must outlive the grid.
+   */
+  template <int dim>
+  class CellBucketGrid
+  {
+  public:
+    CellBucketGrid() = default;
+    /// Build the grid from the active cells at their current position.
+    void reinit(const DoFHandler<dim> &, const Mapping<dim> *mapping = nullptr);
+    /// Return the first cell that contains the point, or an invalid iterator.
+    typename DoFHandler<dim>::active_cell_iterator
+    find_cell(const Point<dim> &) const;
+    /// Check if a point is inside any cell.
+    bool point_inside(const Point<dim> &p) const
+    {
+      return find_cell(p).state() == IteratorState::valid;
+    }
+    /// Collect the cells whose bounding boxes overlap the box [lower, upper].
+    void find_cells(
+      const Point<dim> &lower,
+      const Point<dim> &upper,
+      std::vector<typename DoFHandler<dim>::active_cell_iterator> &) const;
+
+  private:
+    /// The bucket that a point falls into, or -1 if it is out of the grid.
+    int bucket_index(const Point<dim> &) const;
+    /// The bucket index in one direction, clamped to the grid.
+    unsigned int clamped_index(const double, const unsigned int) const;
+
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    const Mapping<dim> *mapping = nullptr;
+    /// The enlarged bounding box of every cell.
+    std::vector<std::pair<Point<dim>, Point<dim>>> boxes;
+    /// The cells in bucket i are bucket_cells[bucket_begin[i],
+    /// bucket_begin[i + 1]).
+    std::vector<unsigned int> bucket_begin;
+    std::vector<unsigned int> bucket_cells;
+    Point<dim> lower;
+    Point<dim> upper;
+    Tensor<1, dim> bucket_size;
+    unsigned int n_per_dim = 0;
+  };
+
+  /*! \brief Per-cell FE data of the fluid mesh, cached between refinements.
+   *
+   * The fluid mesh does not move, so the JxW values, quadrature points and
+   * shape function gradients of a cell are the same in every assembly until
+   * the mesh changes. If reinit is called with a DoFHandler, the data of all
+   * the locally owned cells are computed once and stored contiguously,
+   * slotted by active cell index. The gradients are stored per scalar base
+   * function, so the copies of a vector-valued base element share them.
+   * Otherwise reinit with a cell computes the data of that cell only.
+   *
+   * The shape functions must be primitive, and their values must not depend
+   * on the mapping, which holds for the FE_Q systems of the fluid solvers.
+   * Components 0 to dim - 1 are read as the velocity and component dim as the
+   * pressure.
+   *
+   * A copy shares the stored data but has its own current cell, so each
+   * thread of a WorkStream assembly can work on a copy.
+   */
+  template <int dim>
+  class CellFEDataCache
+  {
+  public:
+    CellFEDataCache(const FiniteElement<dim> &, const Quadrature<dim> &);
+    CellFEDataCache(const CellFEDataCache<dim> &);
+    /// Compute and store the data of all the locally owned cells.
+    void reinit(const DoFHandler<dim> &);
+    /// Drop the stored data, which must be called when the mesh changes.
+    void clear();
+    /// The memory of the stored data, which is shared by the copies.
+    std::size_t memory_consumption() const;
+    /// Make the data of a cell current, computing them if not stored.
+    void reinit(const typename DoFHandler<dim>::active_cell_iterator &);
+
+    double JxW(const unsigned int q) const { return current_JxW[q]; }
+    const std::vector<Point<dim>> &get_quadrature_points() const
+    {
+      return current_points;
+    }
+    /// The value of the only nonzero component of shape function k.
+    double shape_value(const unsigned int k, const unsigned int q) const
+    {
+      return shape_values[k * n_q_points + q];
+    }
+    /// The gradient of the only nonzero component of shape function k.
+    const Tensor<1, dim> &shape_grad(const unsigned int k,
+                                     const unsigned int q) const
+    {
+      return current_gradients[base_function[k] * n_q_points + q];
+    }
+
+    /// The velocity view of shape function k, zero for pressure functions.
+    Tensor<1, dim> velocity_value(const unsigned int k,
+                                  const unsigned int q) const;
+    Tensor<2, dim> velocity_gradient(const unsigned int k,
+                                     const unsigned int q) const;
+    double velocity_divergence(const unsigned int k,
+                               const unsigned int q) const;
+    /// The pressure view of shape function k, zero for velocity functions.
+    double pressure_value(const unsigned int k, const unsigned int q) const;
+    Tensor<1, dim> pressure_gradient(const unsigned int k,
+                                     const unsigned int q) const;
+
+    /// Evaluate the solution given by the local dof values of the current
+    /// cell at the quadrature points.
+    void get_velocity_values(const Vector<double> &,
+                             std::vector<Tensor<1, dim>> &) const;
+    void get_velocity_gradients(const Vector<double> &,
+                                std::vector<Tensor<2, dim>> &) const;
+    void get_velocity_divergences(const Vector<double> &,
+                                  std::vector<double> &) const;
+    void get_pressure_values(const Vector<double> &,
+                             std::vector<double> &) const;
+    void get_pressure_gradients(const Vector<double> &,
+                                std::vector<Tensor<1, dim>> &) const;
+
+  private:
+    /// The data of the stored cells, which are not changed once computed.
+    struct Storage
+    {
+      /// The slot of every active cell, invalid if it is not stored.
+      std::vector<unsigned int> cell_slot;
+      std::vector<double> JxW;
+      std::vector<Point<dim>> points;
+      std::vector<Tensor<1, dim>> gradients;
+    };
+
+    /// Copy the data of the cell that fe_values is reinitialized on.
+    void copy_from_fe_values(double *, Tensor<1, dim> *) const;
+
+    FEValues<dim> fe_values;
+    const unsigned int dofs_per_cell;
+    const unsigned int n_q_points;
+    /// The component and the scalar base function of every shape function,
+    /// and one shape function of every base function.
+    std::vector<unsigned int> components;
+    std::vector<unsigned int> base_function;
+    std::vector<unsigned int> representative;
+    std::vector<double> shape_values;
+
+    std::shared_ptr<const Storage> storage;
+    // The data of the last cell that is not stored.
+    std::vector<double> scratch_JxW;
+    std::vector<Tensor<1, dim>> scratch_gradients;
+
+    const double *current_JxW;
+    const Tensor<1, dim> *current_gradients;
+    std::vector<Point<dim>> current_points;
+  };
+
+  /// A locally owned cell and the dof values that the worker of
+  /// run_on_locally_owned_cells reads.
+  template <int dim>
+  struct CellJob
+  {
+    typename DoFHandler<dim>::active_cell_iterator cell;
+    std::vector<Vector<double>> dof_values;
+  };
+
+  /// Process the first n_jobs of a chunk of cells with a WorkStream.
+  template <int dim,
+            typename Worker,
+            typename Copier,
+            typename ScratchData,
+            typename CopyData>
+  void run_cell_jobs(const std::vector<CellJob<dim>> &jobs,
+                     const unsigned int n_jobs,
+                     const Worker &worker,
+                     const Copier &copier,
+                     const ScratchData &sample_scratch,
+                     const CopyData &sample_copy)
+  {
+    typedef typename std::vector<CellJob<dim>>::const_iterator Iterator;
+    WorkStream::run(
+      jobs.cbegin(),
+      jobs.cbegin() + n_jobs,
+      [&worker](const Iterator &job, ScratchData &scratch, CopyData &copy) {
+        worker(*job, scratch, copy);
+      },
+      copier,
+      sample_scratch,
+      sample_copy);
+  }
+
+  /*! \brief Run a WorkStream over the locally owned cells of a mesh whose
+   * solution is stored in PETSc vectors.
+   *
+   * PETSc vectors are not thread-safe, so the workers must not read them.
+   * The cells are taken in chunks: read extracts the n_vectors sets of dof
+   * values of every cell in a chunk on the calling thread, then the workers
+   * process the chunk on multiple threads and the copier distributes the
+   * local contributions in the order of the cells. With a single thread,
+   * this is a plain loop over the cells.
+   */
+  template <int dim,
+            typename Reader,
+            typename Worker,
+            typename Copier,
+            typename ScratchData,
+            typename CopyData>
+  void run_on_locally_owned_cells(const DoFHandler<dim> &dof_handler,
+                                  const unsigned int n_vectors,
+                                  const Reader &read,
+                                  const Worker &worker,
+                                  const Copier &copier,
+                                  const ScratchData &sample_scratch,
+                                  const CopyData &sample_copy,
+                                  const unsigned int chunk_size = 1024)
+  {
+    const unsigned int dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
+    std::vector<CellJob<dim>> jobs(chunk_size);
+    for (auto &job : jobs)
+      {
+        job.dof_values.assign(n_vectors, Vector<double>(dofs_per_cell));
+      }
+    auto cell = dof_handler.begin_active();
+    while (cell != dof_handler.end())
+      {
+        unsigned int n_jobs = 0;
+        for (; cell != dof_handler.end() && n_jobs < chunk_size; ++cell)
+          {
+            if (!cell->is_locally_owned())
+              continue;
+            jobs[n_jobs].cell = cell;
+            read(cell, jobs[n_jobs].dof_values);
+            ++n_jobs;
+          }
+        run_cell_jobs(
+          jobs, n_jobs, worker, copier, sample_scratch, sample_copy);
+      }
+  }
+
+  /// The same as run_on_locally_owned_cells, over a given list of locally
+  /// owned cells.
+  template <int dim,
+            typename Reader,
+            typename Worker,
+            typename Copier,
+            typename ScratchData,
+            typename CopyData>
+  void
+  run_on_cells(const std::vector<typename DoFHandler<dim>::active_cell_iterator>
+                 &cells,
+               const unsigned int n_vectors,
+               const Reader &read,
+               const Worker &worker,
+               const Copier &copier,
+               const ScratchData &sample_scratch,
+               const CopyData &sample_copy,
+               const unsigned int chunk_size = 1024)
+  {
+    if (cells.empty())
+      return;
+    const unsigned int dofs_per_cell = cells.front()->get_fe().dofs_per_cell;
+    std::vector<CellJob<dim>> jobs(std::min<std::size_t>(chunk_size,
+                                                         cells.size()));
+    for (auto &job : jobs)
+      {
+        job.dof_values.assign(n_vectors, Vector<double>(dofs_per_cell));
+      }
+    auto cell = cells.cbegin();
+    while (cell != cells.cend())
+      {
+        unsigned int n_jobs = 0;
+        for (; cell != cells.cend() && n_jobs < jobs.size(); ++cell, ++n_jobs)
+          {
+            jobs[n_jobs].cell = *cell;
+            read(*cell, jobs[n_jobs].dof_values);
+          }
+        run_cell_jobs(
+          jobs, n_jobs, worker, copier, sample_scratch, sample_copy);
+      }
+  }
+
+  /*! \brief Split-phase update of the ghost values of a PETSc block vector.
+   *
+   * Assigning to a ghosted vector waits until all its ghost values have
+   * arrived. start() only copies the owned values and sends the ghost
+   * values, so that the work which reads owned values only, such as the
+   * assembly of the cells whose dofs are all locally owned, overlaps with
+   * the exchange. finish() waits for the ghost values and does nothing if
+   * no update is in flight. The vector must not be written in between.
+   */
+  class GhostUpdate
+  {
+  public:
+    void start(PETScWrappers::MPI::BlockVector &ghosted,
+               const PETScWrappers::MPI::BlockVector &owned);
+    void finish();
+
+  private:
+    PETScWrappers::MPI::BlockVector *vector = nullptr;
+  };
+
+  /*! \brief Compress the PETSc block matrices and vectors after an assembly
+   * with add.
+   *
+   * deal.II compresses one block at a time, each waiting for its own
+   * off-process entries. Here the assembly of every block is begun before
+   * any is ended, so that all the exchanges are in flight together. PETSc
+   * does not allow to add entries between the two phases, so the exchanges
+   * cannot overlap with the assembly itself. This function is collective.
+   */
+  void
+  compress_add(std::initializer_list<PETScWrappers::MPI::BlockSparseMatrix *>,
+               std::initializer_list<PETScWrappers::MPI::BlockVector *>);
+
+  /*! \brief Locate points with a breadth first search from hint cells.
+   *
+   * The locator is meant to live across many searches: the visited cells are
+   * marked with a generation stamp indexed by the active cell index, the BFS
+   * queue is kept between calls, and the active neighbors of every cell are
+   * cached the first time the cell is visited. Once warmed up, a search does
+   * not allocate any memory. The cache is dropped automatically if the
+   * number of active cells changes, otherwise reinit must be called after
+   * the mesh is refined.
+   */
   template <int dim, typename MeshType>
   class CellLocator
   {
   public:
-    CellLocator(DoFHandler<dim> &,
-                const Point<dim> &,
-                const typename MeshType::active_cell_iterator &);
+    CellLocator(DoFHandler<dim> &);
     // Use breadth first search from the hint to find and return the iterator
-    // of the cell where the point is inside.
-    const typename MeshType::active_cell_iterator search();
+    // of the cell where the point is inside, the cells are taken as mapped
+    // by the mapping if there is one.
+    const typename MeshType::active_cell_iterator
+    search(const Point<dim> &,
+           const typename MeshType::active_cell_iterator &hint,
+           const Mapping<dim> *mapping = nullptr);
     bool found_cell() const { return cell_found; };
+    /// Drop the cached neighbors.
+    void reinit();
 
   private:
+    /// The active neighbors of a cell, computed on the first request.
+    const std::vector<typename MeshType::active_cell_iterator> &
+    get_neighbors(const typename MeshType::active_cell_iterator &);
+
     DoFHandler<dim> &dof_handler;
-    const Point<dim> &point;
-    const typename MeshType::active_cell_iterator hint;
     bool cell_found;
+    /// A cell is visited in the current search if its stamp equals the
+    /// current generation.
+    unsigned int generation;
+    std::vector<unsigned int> visited;
+    std::vector<typename MeshType::active_cell_iterator> cell_queue;
+    std::vector<std::vector<typename MeshType::active_cell_iterator>>
+      neighbor_cache;
+    std::vector<bool> neighbor_cached;
   };
 } // namespace Utils
 
@@ -31,8 +31,24 @@ namespace Fluid
            parameters.save_interval),
       timer(std::cout, TimerOutput::never, TimerOutput::wall_times),
       parameters(parameters),
+      preconditioner_reuse(parameters.preconditioner_max_age,
+                           parameters.preconditioner_max_iterations,
+                           parameters.preconditioner_rebuild_threshold),
+      cell_fe_data(fe, volume_quad_formula),
+      time_step_controller(parameters.target_cfl,
+                           parameters.time_step_shrink,
+                           parameters.time_step_growth,
+                           parameters.min_time_step,
+                           parameters.max_time_step,
+                           parameters.target_newton_iterations),
+      solution_predictor(parameters.fluid_predictor_order),
+      output_control(parameters),
+      steady_state(parameters.steady_state_tolerance,
+                   parameters.steady_state_steps),
       boundary_values(bc)
   {
+    Utils::TimingReport::instance().add(
+      "fluid", timer, MPI_COMM_SELF, parameters.timing_report);
   }
 
   template <int dim>
@@ -45,7 +61,7 @@ namespace Fluid
     // We renumber the components to have all velocity DoFs come before
     // the pressure DoFs to be able to split the solution vector in two blocks
     // which are separately accessed in the block preconditioner.
-    DoFRenumbering::Cuthill_McKee(dof_handler);
+    Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
     std::vector<unsigned int> block_component(dim + 1, 0);
     block_component[dim] = 1;
     DoFRenumbering::component_wise(dof_handler, block_component);
@@ -193,6 +209,13 @@ namespace Fluid
     present_solution.reinit(dofs_per_block);
     solution_increment.reinit(dofs_per_block);
     system_rhs.reinit(dofs_per_block);
+    // The previous solution is lost unless it is transferred.
+    previous_delta_t = 0;
+    if (parameters.fluid_time_integration == "BDF2")
+      {
+        previous_solution.reinit(dofs_per_block);
+        bdf2_history.reinit(dofs_per_block);
+      }
 
     // Compute the sparsity pattern for mass schur in advance.
     // It should be the same as \f$BB^T\f$.
@@ -201,16 +224,61 @@ namespace Fluid
                                         sparsity_pattern.block(0, 1));
     mass_schur_pattern.copy_from(schur_pattern);
     mass_schur.reinit(mass_schur_pattern);
+    mass_schur_outdated = true;
 
     // Cell property
     setup_cell_property();
 
+    // The mesh or the dofs have changed, so must the cached FE data, and the
+    // recorded solutions no longer match.
+    solution_predictor.clear();
+    if (parameters.fluid_cache_fe_data)
+      {
+        cell_fe_data.reinit(dof_handler);
+      }
+    else
+      {
+        cell_fe_data.clear();
+      }
+
     stress = std::vector<std::vector<Vector<double>>>(
       dim,
       std::vector<Vector<double>>(dim,
                                   Vector<double>(scalar_dof_handler.n_dofs())));
   }
 
+  template <int dim>
+  bool FluidSolver<dim>::update_mass_schur()
+  {
+    IndexSet constrained_dofs(dof_handler.n_dofs());
+    for (types::global_dof_index i = 0; i < dof_handler.n_dofs(); ++i)
+      {
+        if (zero_constraints.is_constrained(i))
+          {
+            constrained_dofs.add_index(i);
+          }
+      }
+    if (!mass_schur_outdated && constrained_dofs == mass_schur_constraints)
+      {
+        return false;
+      }
+    TimerOutput::Scope timer_section(timer, "Mass Schur complement");
+    Vector<double> tmp1(mass_matrix.block(0, 0).m()), tmp2(tmp1);
+    tmp1 = 1;
+    tmp2 = 0;
+    // Jacobi preconditioner of matrix A is by definition inverse diag(A),
+    // this is exactly what we want to compute.
+    // Note that the mass matrix and mass schur do not include the density.
+    mass_matrix.block(0, 0).precondition_Jacobi(tmp2, tmp1);
+    // The sparsity pattern has already been set correctly, so explicitly
+    // tell mmult not to rebuild the sparsity pattern.
+    system_matrix.block(1, 0).mmult(
+      mass_schur, system_matrix.block(0, 1), tmp2, false);
+    mass_schur_outdated = false;
+    mass_schur_constraints = constrained_dofs;
+    return true;
+  }
+
   template <int dim>
   void FluidSolver<dim>::refine_mesh(const unsigned int min_grid_level,
                                      const unsigned int max_grid_level)
@@ -246,7 +314,13 @@ namespace Fluid
         cell->clear_coarsen_flag();
       }
 
-    BlockVector<double> buffer(present_solution);
+    // The previous solution of BDF2 is transferred along.
+    const double history_delta_t = previous_delta_t;
+    std::vector<BlockVector<double>> buffer{present_solution};
+    if (history_delta_t > 0)
+      {
+        buffer.push_back(previous_solution);
+      }
     SolutionTransfer<dim, BlockVector<double>> solution_transfer(dof_handler);
 
     triangulation.prepare_coarsening_and_refinement();
@@ -258,8 +332,16 @@ namespace Fluid
     make_constraints();
     initialize_system();
 
-    solution_transfer.interpolate(buffer, present_solution);
+    std::vector<BlockVector<double>> solutions(buffer.size(),
+                                               present_solution);
+    solution_transfer.interpolate(buffer, solutions);
+    present_solution = solutions[0];
     nonzero_constraints.distribute(present_solution);
+    if (history_delta_t > 0)
+      {
+        previous_solution = solutions[1];
+        previous_delta_t = history_delta_t;
+      }
   }
 
   template <int dim>
@@ -276,33 +358,45 @@ namespace Fluid
         dim, DataComponentInterpretation::component_is_part_of_vector);
     data_component_interpretation.push_back(
       DataComponentInterpretation::component_is_scalar);
-    DataOut<dim> data_out;
+    Utils::FilteredDataOut<dim> data_out(
+      [this](const auto &cell) { return output_control.write_cell(cell); });
     data_out.attach_dof_handler(dof_handler);
-    data_out.add_data_vector(present_solution,
-                             solution_names,
-                             DataOut<dim>::type_dof_data,
-                             data_component_interpretation);
+    if (output_control.write_field("velocity") ||
+        output_control.write_field("pressure"))
+      {
+        data_out.add_data_vector(present_solution,
+                                 solution_names,
+                                 DataOut<dim>::type_dof_data,
+                                 data_component_interpretation);
+      }
 
     // Indicator
     Vector<float> ind(triangulation.n_active_cells());
-    int i = 0;
-    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
-         ++cell)
+    if (output_control.write_field("indicator"))
       {
-        auto p = cell_property.get_data(cell);
-        ind[i++] = p[0]->indicator;
+        int i = 0;
+        for (auto cell = triangulation.begin_active();
+             cell != triangulation.end();
+             ++cell)
+          {
+            auto p = cell_property.get_data(cell);
+            ind[i++] = p[0]->indicator;
+          }
+        data_out.add_data_vector(ind, "Indicator");
       }
-    data_out.add_data_vector(ind, "Indicator");
 
     // stress
-    data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
-    data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
-    data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
-    if (dim == 3)
+    if (output_control.write_stress(time))
       {
-        data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
-        data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
-        data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
+        data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
+        if (dim == 3)
+          {
+            data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
+            data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
+            data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+          }
       }
 
     data_out.build_patches(parameters.fluid_pressure_degree);
@@ -312,12 +406,13 @@ namespace Fluid
       basename + "-" + Utilities::int_to_string(output_index, 6) + ".vtu";
 
     std::ofstream output(filename);
+    output_control.set_flags(data_out);
     data_out.write_vtu(output);
 
     static std::vector<std::pair<double, std::string>> times_and_names;
+    static Utils::PVDRecord pvd_record(basename + ".pvd");
     times_and_names.push_back({time.current(), filename});
-    std::ofstream pvd_output(basename + ".pvd");
-    DataOutBase::write_pvd_record(pvd_output, times_and_names);
+    pvd_record.write(times_and_names);
   }
 
   template <int dim>
@@ -414,6 +509,111 @@ namespace Fluid
       }
   }
 
+  template <int dim>
+  double FluidSolver<dim>::compute_cfl()
+  {
+    std::vector<Tensor<1, dim>> current_velocity_values(
+      volume_quad_formula.size());
+    Vector<double> current_dof_values(fe.dofs_per_cell);
+
+    double cfl = 0;
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        cell_fe_data.reinit(cell);
+        cell->get_dof_values(present_solution, current_dof_values);
+        cell_fe_data.get_velocity_values(current_dof_values,
+                                         current_velocity_values);
+        const double h = cell->minimum_vertex_distance() /
+                         parameters.fluid_velocity_degree;
+        for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
+          {
+            cfl = std::max(
+              cfl, current_velocity_values[q].norm() * time.get_delta_t() / h);
+          }
+      }
+    return cfl;
+  }
+
+  template <int dim>
+  void FluidSolver<dim>::adapt_time_step(const unsigned int newton_iterations)
+  {
+    // In FSI the fluid and solid steps are coupled, so leave them alone.
+    if (!parameters.adaptive_time_step ||
+        parameters.simulation_type != "Fluid")
+      {
+        return;
+      }
+    const double cfl = compute_cfl();
+    double delta_t = time_step_controller.next_delta_t(
+      time.get_delta_t(), cfl, newton_iterations);
+    // Do not step past the end time.
+    const double remaining = time.end() - time.current();
+    if (remaining > 1e-12)
+      {
+        delta_t = std::min(delta_t, remaining);
+      }
+    if (delta_t != time.get_delta_t())
+      {
+        std::cout << "CFL = " << cfl << ", next time step size = " << delta_t
+                  << std::endl;
+        time.set_delta_t(delta_t);
+      }
+  }
+
+  template <int dim>
+  void FluidSolver<dim>::update_time_history()
+  {
+    if (previous_delta_t <= 0)
+      {
+        return;
+      }
+    const auto a =
+      Utils::bdf2_coefficients(time.get_delta_t(), previous_delta_t);
+    bdf2_history = present_solution;
+    bdf2_history.sadd(1 + a[2] / a[0], -a[2] / a[0], previous_solution);
+  }
+
+  template <int dim>
+  const BlockVector<double> &FluidSolver<dim>::time_history() const
+  {
+    return previous_delta_t > 0 ? bdf2_history : present_solution;
+  }
+
+  template <int dim>
+  double FluidSolver<dim>::effective_delta_t() const
+  {
+    return time.get_delta_t() /
+           Utils::bdf2_coefficients(time.get_delta_t(), previous_delta_t)[0];
+  }
+
+  template <int dim>
+  void FluidSolver<dim>::record_previous_solution()
+  {
+    if (parameters.fluid_time_integration != "BDF2")
+      {
+        return;
+      }
+    previous_solution = present_solution;
+    previous_delta_t = time.get_delta_t();
+  }
+
+  template <int dim>
+  bool FluidSolver<dim>::reached_steady_state()
+  {
+    if (!steady_state.record(present_solution, time.current()))
+      {
+        return false;
+      }
+    std::cout << "Steady state reached at t = " << time.current()
+              << ", rate of change = " << steady_state.rate() << std::endl;
+    if (!time.time_to_output())
+      {
+        output_results(time.get_timestep());
+      }
+    return true;
+  }
+
   template class FluidSolver<2>;
   template class FluidSolver<3>;
 } // namespace Fluid
@@ -5,7 +5,7 @@
 template <int dim>
 FSI<dim>::~FSI()
 {
-  timer.print_summary();
+  Utils::TimingReport::instance().remove(timer);
 }
 
 template <int dim>
@@ -22,9 +22,16 @@ FSI<dim>::FSI(Fluid::FluidSolver<dim> &f,
          parameters.refinement_interval,
          parameters.save_interval),
     timer(std::cout, TimerOutput::never, TimerOutput::wall_times),
+    solid_locator(solid_solver.dof_handler),
+    thread_locators(solid_locator),
+    fluid_locator(fluid_solver.dof_handler),
     use_dirichlet_bc(use_dirichlet_bc)
 {
   solid_box.reinit(2 * dim);
+  solid_solver.time.set_delta_t(parameters.time_step /
+                                parameters.solid_substeps);
+  Utils::TimingReport::instance().add(
+    "fsi", timer, MPI_COMM_SELF, parameters.timing_report);
 }
 
 template <int dim>
@@ -61,6 +68,24 @@ void FSI<dim>::move_solid_mesh(bool move_forward)
     }
 }
 
+template <int dim>
+void FSI<dim>::collect_solid_boundaries()
+{
+  if (dim == 2)
+    for (auto cell = solid_solver.triangulation.begin_active();
+         cell != solid_solver.triangulation.end();
+         ++cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (cell->face(f)->at_boundary())
+              {
+                solid_boundaries.push_back(cell->face(f));
+              }
+          }
+      }
+}
+
 template <int dim>
 void FSI<dim>::update_solid_box()
 {
@@ -85,11 +110,15 @@ void FSI<dim>::update_solid_box()
             solid_box(2 * i + 1) = (*v)(i);
         }
     }
+  if (dim == 2)
+    boundary_index.reinit(solid_boundaries);
+  else
+    solid_cell_index.reinit(solid_solver.dof_handler);
   move_solid_mesh(false);
 }
 
 template <int dim>
-bool FSI<dim>::point_in_solid(const DoFHandler<dim> &df,
+bool FSI<dim>::point_in_solid(const DoFHandler<dim> &,
                               const Point<dim> &point)
 {
   // Check whether the point is in the solid box first.
@@ -98,14 +127,35 @@ bool FSI<dim>::point_in_solid(const DoFHandler<dim> &df,
       if (point(i) < solid_box(2 * i) || point(i) > solid_box(2 * i + 1))
         return false;
     }
-  for (auto cell = df.begin_active(); cell != df.end(); ++cell)
+  // Count the boundary faces crossed by a ray from the point, only the
+  // faces close to the ray are visited.
+  if (dim == 2)
+    return boundary_index.point_inside(point);
+  // Otherwise only test the solid cells whose bounding boxes contain
+  // the point.
+  return solid_cell_index.point_inside(point);
+}
+
+template <int dim>
+void FSI<dim>::setup_cell_hints()
+{
+  // One hint per support point plus one for the cell center.
+  const unsigned int n_hints =
+    fluid_solver.fe.get_unit_support_points().size() + 1;
+  cell_hints.clear();
+  for (auto cell = fluid_solver.triangulation.begin_active();
+       cell != fluid_solver.triangulation.end();
+       ++cell)
     {
-      if (cell->point_inside(point))
+      cell_hints.initialize(cell, n_hints);
+      const std::vector<
+        std::shared_ptr<typename DoFHandler<dim>::active_cell_iterator>>
+        hints = cell_hints.get_data(cell);
+      for (unsigned int v = 0; v < n_hints; ++v)
         {
-          return true;
+          *(hints[v]) = solid_solver.dof_handler.begin_active();
         }
     }
-  return false;
 }
 
 template <int dim>
@@ -150,15 +200,29 @@ template <int dim>
 void FSI<dim>::update_indicator()
 {
   TimerOutput::Scope timer_section(timer, "Update indicator");
+  OPENIFEM_KERNEL_SCOPE("fsi_update_indicator");
   move_solid_mesh(true);
+  // Every cell only writes its own indicator, so the cells are classified on
+  // multiple threads.
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
   for (auto f_cell = fluid_solver.dof_handler.begin_active();
        f_cell != fluid_solver.dof_handler.end();
        ++f_cell)
     {
-      auto p = fluid_solver.cell_property.get_data(f_cell);
-      auto center = f_cell->center();
-      p[0]->indicator = point_in_solid(solid_solver.dof_handler, center);
+      cells.push_back(f_cell);
     }
+  parallel::apply_to_subranges(
+    0u,
+    static_cast<unsigned int>(cells.size()),
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int c = begin; c < end; ++c)
+        {
+          auto p = fluid_solver.cell_property.get_data(cells[c]);
+          auto center = cells[c]->center();
+          p[0]->indicator = point_in_solid(solid_solver.dof_handler, center);
+        }
+    },
+    64);
   move_solid_mesh(false);
 }
 
@@ -168,6 +232,7 @@ template <int dim>
 void FSI<dim>::find_fluid_bc()
 {
   TimerOutput::Scope timer_section(timer, "Find fluid BC");
+  OPENIFEM_KERNEL_SCOPE("fsi_find_fluid_bc");
   move_solid_mesh(true);
 
   // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
@@ -178,11 +243,6 @@ void FSI<dim>::find_fluid_bc()
 
   const FEValuesExtractors::Vector velocities(0);
   const FEValuesExtractors::Scalar pressure(dim);
-  std::vector<SymmetricTensor<2, dim>> sym_grad_v(1);
-  std::vector<double> p(1);
-  std::vector<Tensor<2, dim>> grad_v(1);
-  std::vector<Tensor<1, dim>> v(1);
-  std::vector<Tensor<1, dim>> dv(1);
 
   // Cell center in unit coordinate system
   Point<dim> unit_center;
@@ -192,53 +252,126 @@ void FSI<dim>::find_fluid_bc()
     }
   Quadrature<dim> quad(unit_center);
   MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
-  FEValues<dim> fe_values(mapping,
-                          fluid_solver.fe,
-                          quad,
-                          update_quadrature_points | update_values |
-                            update_gradients);
 
   const std::vector<Point<dim>> &unit_points =
     fluid_solver.fe.get_unit_support_points();
   Quadrature<dim> dummy_q(unit_points);
-  FEValues<dim> dummy_fe_values(
-    mapping, fluid_solver.fe, dummy_q, update_quadrature_points);
-  std::vector<types::global_dof_index> dof_indices(
-    fluid_solver.fe.dofs_per_cell);
 
-  for (auto f_cell = fluid_solver.dof_handler.begin_active();
-       f_cell != fluid_solver.dof_handler.end();
-       ++f_cell)
+  // Every thread evaluates the fluid cells with its own FEValues.
+  struct ScratchData
+  {
+    ScratchData(const Mapping<dim> &mapping,
+                const FiniteElement<dim> &fe,
+                const Quadrature<dim> &quad,
+                const Quadrature<dim> &dummy_q)
+      : fe_values(mapping,
+                  fe,
+                  quad,
+                  update_quadrature_points | update_values | update_gradients),
+        dummy_fe_values(mapping, fe, dummy_q, update_quadrature_points),
+        dof_indices(fe.dofs_per_cell),
+        sym_grad_v(1),
+        p(1),
+        grad_v(1),
+        v(1),
+        dv(1)
+    {
+    }
+    ScratchData(const ScratchData &scratch)
+      : fe_values(scratch.fe_values.get_mapping(),
+                  scratch.fe_values.get_fe(),
+                  scratch.fe_values.get_quadrature(),
+                  scratch.fe_values.get_update_flags()),
+        dummy_fe_values(scratch.dummy_fe_values.get_mapping(),
+                        scratch.dummy_fe_values.get_fe(),
+                        scratch.dummy_fe_values.get_quadrature(),
+                        scratch.dummy_fe_values.get_update_flags()),
+        dof_indices(scratch.dof_indices),
+        sym_grad_v(1),
+        p(1),
+        grad_v(1),
+        v(1),
+        dv(1)
     {
+    }
+    FEValues<dim> fe_values;
+    FEValues<dim> dummy_fe_values;
+    std::vector<types::global_dof_index> dof_indices;
+    std::vector<SymmetricTensor<2, dim>> sym_grad_v;
+    std::vector<double> p;
+    std::vector<Tensor<2, dim>> grad_v;
+    std::vector<Tensor<1, dim>> v;
+    std::vector<Tensor<1, dim>> dv;
+  };
+  // The Dirichlet BCs set by a fluid cell, as (line, inhomogeneity) pairs.
+  struct CopyData
+  {
+    std::vector<std::pair<types::global_dof_index, double>> dirichlet;
+  };
+
+  // A fluid cell only writes its own cell property, the Dirichlet BCs are
+  // added to the constraints in the order of the cells.
+  auto worker =
+    [&](const typename DoFHandler<dim>::active_cell_iterator &f_cell,
+        ScratchData &scratch,
+        CopyData &copy) {
+      copy.dirichlet.clear();
       auto ptr = fluid_solver.cell_property.get_data(f_cell);
+      // The hints of a fluid cell are only touched by the thread processing
+      // it, each point is searched by a BFS from the solid cell it was last
+      // found in. The interpolator falls back to the global search if there
+      // is no hint or the BFS fails.
+      auto hints = cell_hints.get_data(f_cell);
+      auto &locator = thread_locators.get();
+      auto locate = [&](const Point<dim> &point,
+                        typename DoFHandler<dim>::active_cell_iterator &hint) {
+        if (hint != solid_solver.dof_handler.begin_active())
+          {
+            hint = locator.search(point, hint);
+            if (!locator.found_cell())
+              {
+                hint = typename DoFHandler<dim>::active_cell_iterator();
+              }
+          }
+        else
+          {
+            hint = typename DoFHandler<dim>::active_cell_iterator();
+          }
+      };
       ptr[0]->fsi_acceleration = 0;
       ptr[0]->fsi_stress = 0;
       if (!use_dirichlet_bc && ptr[0]->indicator == 1)
         {
+          FEValues<dim> &fe_values = scratch.fe_values;
           fe_values.reinit(f_cell);
           // Fluid velocity increment at cell center
           fe_values[velocities].get_function_values(
-            fluid_solver.solution_increment, dv);
+            fluid_solver.solution_increment, scratch.dv);
           // Fluid velocity gradient at cell center
           fe_values[velocities].get_function_gradients(
-            fluid_solver.present_solution, grad_v);
+            fluid_solver.present_solution, scratch.grad_v);
           // Fluid symmetric velocity gradient at cell center
           fe_values[velocities].get_function_symmetric_gradients(
-            fluid_solver.present_solution, sym_grad_v);
+            fluid_solver.present_solution, scratch.sym_grad_v);
           // Fluid pressure at cell center
           fe_values[pressure].get_function_values(fluid_solver.present_solution,
-                                                  p);
+                                                  scratch.p);
           // Real coordinates of fluid cell center
           auto point = fe_values.get_quadrature_points()[0];
           // Solid acceleration at fluid cell center
+          auto &hint = *(hints[unit_points.size()]);
+          locate(point, hint);
+          Utils::GridInterpolator<dim, Vector<double>> interpolator(
+            solid_solver.dof_handler, point, {}, hint);
+          hint = interpolator.found_cell()
+                   ? interpolator.get_cell()
+                   : solid_solver.dof_handler.begin_active();
           Vector<double> solid_acc(dim);
-          VectorTools::point_value(solid_solver.dof_handler,
-                                   solid_solver.current_acceleration,
-                                   point,
+          interpolator.point_value(solid_solver.current_acceleration,
                                    solid_acc);
           // Fluid total acceleration at cell center
-          Tensor<1, dim> fluid_acc =
-            dv[0] / time.get_delta_t() + grad_v[0] * v[0];
+          Tensor<1, dim> fluid_acc = scratch.dv[0] / time.get_delta_t() +
+                                     scratch.grad_v[0] * scratch.v[0];
           (void)fluid_acc;
           // FSI acceleration term:
           for (unsigned int i = 0; i < dim; ++i)
@@ -251,9 +384,11 @@ void FSI<dim>::find_fluid_bc()
       // Dirichlet BCs
       if (use_dirichlet_bc)
         {
-          dummy_fe_values.reinit(f_cell);
+          std::vector<types::global_dof_index> &dof_indices =
+            scratch.dof_indices;
+          scratch.dummy_fe_values.reinit(f_cell);
           f_cell->get_dof_indices(dof_indices);
-          auto support_points = dummy_fe_values.get_quadrature_points();
+          auto support_points = scratch.dummy_fe_values.get_quadrature_points();
           // Loop over the support points to set Dirichlet BCs.
           for (unsigned int i = 0; i < unit_points.size(); ++i)
             {
@@ -280,22 +415,39 @@ void FSI<dim>::find_fluid_bc()
                      ExcMessage("Vector component should be less than dim!"));
               if (!point_in_solid(solid_solver.dof_handler, support_points[i]))
                 continue;
+              auto &hint = *(hints[i]);
+              locate(support_points[i], hint);
+              Utils::GridInterpolator<dim, Vector<double>> interpolator(
+                solid_solver.dof_handler, support_points[i], {}, hint);
+              hint = interpolator.found_cell()
+                       ? interpolator.get_cell()
+                       : solid_solver.dof_handler.begin_active();
               Vector<double> fluid_velocity(dim);
-              VectorTools::point_value(solid_solver.dof_handler,
-                                       solid_solver.current_velocity,
-                                       support_points[i],
+              interpolator.point_value(solid_solver.current_velocity,
                                        fluid_velocity);
               auto line = dof_indices[i];
-              inner_nonzero.add_line(line);
-              inner_zero.add_line(line);
               // Note that we are setting the value of the constraint to the
               // velocity delta!
-              inner_nonzero.set_inhomogeneity(
-                line,
-                fluid_velocity[index] - fluid_solver.present_solution(line));
+              copy.dirichlet.push_back(
+                {line,
+                 fluid_velocity[index] - fluid_solver.present_solution(line)});
             }
         }
-    }
+    };
+  auto copier = [&](const CopyData &copy) {
+    for (const auto &entry : copy.dirichlet)
+      {
+        inner_nonzero.add_line(entry.first);
+        inner_zero.add_line(entry.first);
+        inner_nonzero.set_inhomogeneity(entry.first, entry.second);
+      }
+  };
+  WorkStream::run(fluid_solver.dof_handler.begin_active(),
+                  fluid_solver.dof_handler.end(),
+                  worker,
+                  copier,
+                  ScratchData(mapping, fluid_solver.fe, quad, dummy_q),
+                  CopyData());
   if (use_dirichlet_bc)
     {
       inner_nonzero.close();
@@ -314,6 +466,7 @@ template <int dim>
 void FSI<dim>::find_solid_bc()
 {
   TimerOutput::Scope timer_section(timer, "Find solid BC");
+  OPENIFEM_KERNEL_SCOPE("fsi_find_solid_bc");
   // Must use the updated solid coordinates
   move_solid_mesh(true);
   // Fluid FEValues to do interpolation
@@ -331,6 +484,11 @@ void FSI<dim>::find_solid_bc()
                                    update_quadrature_points |
                                      update_normal_vectors);
 
+  // Collect the face centers first so that the fluid solution is
+  // interpolated at all of them in one batch.
+  std::vector<Point<dim>> points;
+  std::vector<Tensor<1, dim>> normals;
+  std::vector<Tensor<1, dim> *> tractions;
   for (auto s_cell = solid_solver.dof_handler.begin_active();
        s_cell != solid_solver.dof_handler.end();
        ++s_cell)
@@ -342,31 +500,66 @@ void FSI<dim>::find_solid_bc()
           if (s_cell->face(f)->at_boundary())
             {
               fe_face_values.reinit(s_cell, f);
-              Point<dim> q_point = fe_face_values.quadrature_point(0);
-              Tensor<1, dim> normal = fe_face_values.normal_vector(0);
-              Vector<double> value(dim + 1);
-              Utils::GridInterpolator<dim, BlockVector<double>> interpolator(
-                fluid_solver.dof_handler, q_point);
-              interpolator.point_value(fluid_solver.present_solution, value);
-              std::vector<Tensor<1, dim>> gradient(dim + 1, Tensor<1, dim>());
-              interpolator.point_gradient(fluid_solver.present_solution,
-                                          gradient);
-              SymmetricTensor<2, dim> sym_deformation;
-              for (unsigned int i = 0; i < dim; ++i)
-                {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      sym_deformation[i][j] =
-                        (gradient[i][j] + gradient[j][i]) / 2;
-                    }
-                }
-              // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
-              SymmetricTensor<2, dim> stress =
-                -value[dim] * Physics::Elasticity::StandardTensors<dim>::I +
-                2 * parameters.viscosity * sym_deformation;
-              ptr[f]->fsi_traction = stress * normal;
+              points.push_back(fe_face_values.quadrature_point(0));
+              normals.push_back(fe_face_values.normal_vector(0));
+              tractions.push_back(&ptr[f]->fsi_traction);
+            }
+        }
+    }
+  // Every face center is located by a BFS from the fluid cell it was found
+  // in last time, the interpolator falls back to the global search if there
+  // is no hint or the BFS fails.
+  if (solid_boundary_hints.size() != points.size())
+    {
+      solid_boundary_hints.assign(
+        points.size(), typename DoFHandler<dim>::active_cell_iterator());
+    }
+  for (unsigned int k = 0; k < points.size(); ++k)
+    {
+      auto &hint = solid_boundary_hints[k];
+      // The locator takes the first cell as no hint at all.
+      if (hint.state() == IteratorState::valid &&
+          hint != fluid_solver.dof_handler.begin_active())
+        {
+          hint = fluid_locator.search(points[k], hint);
+          if (!fluid_locator.found_cell())
+            {
+              hint = typename DoFHandler<dim>::active_cell_iterator();
+            }
+        }
+    }
+  Utils::BatchedGridInterpolator<dim, BlockVector<double>> interpolator(
+    fluid_solver.dof_handler);
+  interpolator.reinit(
+    points, solid_boundary_hints, update_values | update_gradients);
+  for (unsigned int k = 0; k < points.size(); ++k)
+    {
+      solid_boundary_hints[k] =
+        interpolator.found_cell(k)
+          ? interpolator.get_cell(k)
+          : typename DoFHandler<dim>::active_cell_iterator();
+    }
+  std::vector<std::vector<Vector<double>>> values;
+  interpolator.point_values({&fluid_solver.present_solution}, values);
+  std::vector<std::vector<Tensor<1, dim>>> gradients;
+  interpolator.point_gradients(fluid_solver.present_solution, gradients);
+  for (unsigned int k = 0; k < points.size(); ++k)
+    {
+      const Vector<double> &value = values[0][k];
+      const std::vector<Tensor<1, dim>> &gradient = gradients[k];
+      SymmetricTensor<2, dim> sym_deformation;
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+          for (unsigned int j = 0; j < dim; ++j)
+            {
+              sym_deformation[i][j] = (gradient[i][j] + gradient[j][i]) / 2;
             }
         }
+      // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+      SymmetricTensor<2, dim> stress =
+        -value[dim] * Physics::Elasticity::StandardTensors<dim>::I +
+        2 * parameters.viscosity * sym_deformation;
+      *tractions[k] = stress * normals[k];
     }
   move_solid_mesh(false);
 }
@@ -443,19 +636,55 @@ void FSI<dim>::refine_mesh(const unsigned int min_grid_level,
 
   solution_transfer.interpolate(buffer, fluid_solver.present_solution);
   fluid_solver.nonzero_constraints.distribute(fluid_solver.present_solution);
+
+  // The hints point to the cells of the old fluid mesh.
+  setup_cell_hints();
+  solid_boundary_hints.clear();
+  fluid_locator.reinit();
+}
+
+template <int dim>
+bool FSI<dim>::reached_steady_state()
+{
+  // Both solutions are recorded at every step.
+  const bool fluid_steady = fluid_solver.steady_state.record(
+    fluid_solver.present_solution, time.current());
+  const bool solid_steady = solid_solver.steady_state.record(
+    solid_solver.current_displacement, time.current());
+  if (!fluid_steady || !solid_steady)
+    {
+      return false;
+    }
+  std::cout << "Steady state reached at t = " << time.current() << std::endl;
+  if (!fluid_solver.time.time_to_output())
+    {
+      fluid_solver.output_results(fluid_solver.time.get_timestep());
+    }
+  if (!solid_solver.time.time_to_output())
+    {
+      solid_solver.output_results(solid_solver.time.get_timestep());
+    }
+  return true;
 }
 
 template <int dim>
 void FSI<dim>::run()
 {
-  solid_solver.triangulation.refine_global(parameters.global_refinements[1]);
+  Utils::refine_global_cached(solid_solver.triangulation,
+                              parameters.global_refinements[1],
+                              parameters.mesh_cache);
   solid_solver.setup_dofs();
   solid_solver.initialize_system();
-  fluid_solver.triangulation.refine_global(parameters.global_refinements[0]);
+  Utils::refine_global_cached(fluid_solver.triangulation,
+                              parameters.global_refinements[0],
+                              parameters.mesh_cache);
   fluid_solver.setup_dofs();
   fluid_solver.make_constraints();
   fluid_solver.initialize_system();
 
+  collect_solid_boundaries();
+  setup_cell_hints();
+
   std::cout << "Number of fluid active cells and dofs: ["
             << fluid_solver.triangulation.n_active_cells() << ", "
             << fluid_solver.dof_handler.n_dofs() << "]" << std::endl
@@ -476,7 +705,11 @@ void FSI<dim>::run()
       find_solid_bc();
       {
         TimerOutput::Scope timer_section(timer, "Run solid solver");
-        solid_solver.run_one_step(first_step);
+        // The solid is sub-cycled with the fluid traction held.
+        for (unsigned int n = 0; n < parameters.solid_substeps; ++n)
+          {
+            solid_solver.run_one_step(first_step && n == 0);
+          }
       }
       update_solid_box();
       update_indicator();
@@ -499,6 +732,12 @@ void FSI<dim>::run()
           refine_mesh(parameters.global_refinements[0],
                       parameters.global_refinements[0] + 1);
         }
+      Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                  time.current());
+      if (reached_steady_state())
+        {
+          break;
+        }
     }
 }
 
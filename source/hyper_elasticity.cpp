@@ -1,50 +1,5 @@
 #include "hyper_elasticity.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
-  {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
-
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
-      {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
-
 namespace Solid
 {
   using namespace dealii;
@@ -52,13 +7,23 @@ namespace Solid
   template <int dim>
   HyperElasticity<dim>::HyperElasticity(Triangulation<dim> &tria,
                                         const Parameters::AllParameters &params)
-    : SolidSolver<dim>(tria, params)
+    : SolidSolver<dim>(tria, params),
+      tangent_reuse(params.solid_newton_method == "Modified"
+                      ? params.solid_tangent_max_age
+                      : 1,
+                    0)
   {
   }
 
   template <int dim>
   void HyperElasticity<dim>::run_one_step(bool first_step)
   {
+    if (parameters.solid_time_integrator == "Central difference")
+      {
+        this->run_one_explicit_step(first_step);
+        return;
+      }
+
     double gamma = 0.5 + parameters.damping;
     double beta = gamma / 2;
 
@@ -67,6 +32,7 @@ namespace Solid
         // Solve for the initial acceleration
         assemble_system(true);
         this->solve(mass_matrix, previous_acceleration, system_rhs);
+        tangent_reuse.invalidate();
         this->output_results(time.get_timestep());
       }
 
@@ -99,6 +65,11 @@ namespace Solid
 
     std::cout << std::string(100, '_') << std::endl;
 
+    unsigned int n_tangent_assemblies = 0;
+    unsigned int n_residual_assemblies = 0;
+    unsigned int n_linear_solves = 0;
+    double previous_error_residual = 0;
+
     while ((normalized_error_update > parameters.tol_d ||
             normalized_error_residual > parameters.tol_f) &&
            error_residual > 1e-12 && error_update > 1e-12)
@@ -117,14 +88,27 @@ namespace Solid
                              current_acceleration);
 
         // Assemble the system, and modify the RHS to account for
-        // the time-discretization.
-        assemble_system(false);
+        // the time-discretization. The modified Newton method keeps the
+        // tangent of a previous iteration.
+        const bool new_tangent = tangent_reuse.need_rebuild(dt);
+        assemble(false, new_tangent);
+        if (new_tangent)
+          {
+            tangent_reuse.rebuilt(dt);
+            ++n_tangent_assemblies;
+          }
+        else
+          {
+            ++n_residual_assemblies;
+          }
         mass_matrix.vmult(tmp, current_acceleration);
         system_rhs -= tmp;
 
         // Solve linear system
         const std::pair<unsigned int, double> lin_solver_output =
           this->solve(system_matrix, newton_update, system_rhs);
+        tangent_reuse.record(lin_solver_output.first);
+        ++n_linear_solves;
 
         // Error evaluation
         {
@@ -143,16 +127,28 @@ namespace Solid
           normalized_error_update = error_update / initial_error_update;
         }
 
-        current_displacement += newton_update;
-        // Update the quadrature point history with the newest displacement
-        update_qph(current_displacement);
+        // A reused tangent is rebuilt once the convergence slows down.
+        if (newton_iteration > 0 &&
+            error_residual > 0.5 * previous_error_residual)
+          {
+            tangent_reuse.invalidate();
+          }
+        previous_error_residual = error_residual;
+
+        const double step = line_search(
+          predicted_displacement, newton_update, n_residual_assemblies);
 
         std::cout << "Newton iteration = " << newton_iteration
                   << ", CG itr = " << lin_solver_output.first << std::fixed
                   << std::setprecision(3) << std::setw(7) << std::scientific
                   << ", CG res = " << lin_solver_output.second
                   << ", res_F = " << error_residual
-                  << ", res_U = " << error_update << std::endl;
+                  << ", res_U = " << error_update;
+        if (parameters.solid_line_search_steps > 0)
+          {
+            std::cout << ", step = " << step;
+          }
+        std::cout << std::endl;
 
         newton_iteration++;
       }
@@ -172,6 +168,9 @@ namespace Solid
     previous_displacement = current_displacement;
 
     std::cout << std::string(100, '_') << std::endl
+              << "Tangent assemblies = " << n_tangent_assemblies
+              << ", residual assemblies = " << n_residual_assemblies
+              << ", linear solves = " << n_linear_solves << std::endl
               << "Relative errors:" << std::endl
               << "Displacement:\t" << normalized_error_update << std::endl
               << "Force: \t\t" << normalized_error_residual << std::endl;
@@ -189,28 +188,57 @@ namespace Solid
   {
     SolidSolver<dim>::initialize_system();
     setup_qph();
+    tangent_reuse.invalidate();
   }
 
   template <int dim>
-  void HyperElasticity<dim>::setup_qph()
+  double HyperElasticity<dim>::line_search(
+    const Vector<double> &predicted_displacement,
+    const Vector<double> &newton_update,
+    unsigned int &n_residual_assemblies)
   {
-    const unsigned int n_q_points = volume_quad_formula.size();
-    quad_point_history.initialize(
-      triangulation.begin_active(), triangulation.end(), n_q_points);
-    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
-         ++cell)
+    const double gamma = 0.5 + parameters.damping;
+    const double beta = gamma / 2;
+    const double dt = time.get_delta_t();
+    const Vector<double> start_displacement(current_displacement);
+    Vector<double> tmp(dof_handler.n_dofs());
+
+    double step = 1.0;
+    for (unsigned int i = 0;; ++i)
       {
-        unsigned int mat_id = cell->material_id();
-        if (parameters.n_solid_parts == 1)
-          mat_id = 1;
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
-        for (unsigned int q = 0; q < n_q_points; ++q)
+        current_displacement = start_displacement;
+        current_displacement.add(step, newton_update);
+        // Update the quadrature point history with the newest displacement
+        update_qph(current_displacement);
+        if (i == parameters.solid_line_search_steps)
+          {
+            break;
+          }
+
+        // Accept the step if it sufficiently decreases the residual.
+        current_acceleration = current_displacement;
+        current_acceleration -= predicted_displacement;
+        current_acceleration /= (beta * dt * dt);
+        assemble_rhs();
+        ++n_residual_assemblies;
+        mass_matrix.vmult(tmp, current_acceleration);
+        system_rhs -= tmp;
+        double trial_residual = 0;
+        get_error_residual(trial_residual);
+        if (trial_residual <= (1 - 1e-4 * step) * error_residual)
           {
-            lqph[q]->setup(parameters, mat_id);
+            break;
           }
+        step *= 0.5;
       }
+    return step;
+  }
+
+  template <int dim>
+  void HyperElasticity<dim>::setup_qph()
+  {
+    quad_point_history.initialize(
+      triangulation, parameters, volume_quad_formula.size());
   }
 
   template <int dim>
@@ -219,7 +247,6 @@ namespace Solid
     timer.enter_subsection("Update QPH data");
 
     // displacement gradient at quad points
-    const unsigned int n_q_points = volume_quad_formula.size();
     FEValuesExtractors::Vector displacement(0);
     std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
     FEValues<dim> fe_values(
@@ -228,18 +255,13 @@ namespace Solid
     for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
          ++cell)
       {
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first = quad_point_history.first_point(cell);
 
         fe_values.reinit(cell);
         fe_values[displacement].get_function_gradients(evaluation_point,
                                                        grad_u);
 
-        for (unsigned int q = 0; q < n_q_points; ++q)
-          {
-            lqph[q]->update(parameters, grad_u[q]);
-          }
+        quad_point_history.update(first, grad_u);
       }
     timer.leave_subsection();
   }
@@ -254,12 +276,10 @@ namespace Solid
          ++cell)
       {
         fe_values.reinit(cell);
-        const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-          lqph = quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first = quad_point_history.first_point(cell);
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
-            const double det = lqph[q]->get_det_F();
+            const double det = quad_point_history.get_det_F(first + q);
             const double JxW = fe_values.JxW(q);
             volume += det * JxW;
           }
@@ -301,7 +321,28 @@ namespace Solid
   template <int dim>
   void HyperElasticity<dim>::assemble_system(bool initial_step)
   {
-    timer.enter_subsection("Assemble tangent matrix");
+    assemble(initial_step, true);
+  }
+
+  template <int dim>
+  void HyperElasticity<dim>::assemble_rhs()
+  {
+    assemble(false, false);
+  }
+
+  template <int dim>
+  void HyperElasticity<dim>::assemble_explicit_rhs()
+  {
+    update_qph(current_displacement);
+    assemble_rhs();
+  }
+
+  template <int dim>
+  void HyperElasticity<dim>::assemble(bool initial_step, bool assemble_matrix)
+  {
+    OPENIFEM_KERNEL_SCOPE("hyper_elasticity_assemble");
+    Assert(assemble_matrix || !initial_step, ExcInternalError());
+    timer.enter_subsection(\"Assemble tangent matrix\");
 
     const unsigned int n_q_points = volume_quad_formula.size();
     const unsigned int n_f_q_points = face_quad_formula.size();
@@ -314,56 +355,103 @@ namespace Solid
       {
         mass_matrix = 0.0;
       }
-    system_matrix = 0.0;
+    if (assemble_matrix)
+      {
+        system_matrix = 0.0;
+      }
     system_rhs = 0.0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_JxW_values);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_JxW_values);
-
-    std::vector<std::vector<Tensor<1, dim>>> phi(
-      n_q_points, std::vector<Tensor<1, dim>>(dofs_per_cell));
-    std::vector<std::vector<Tensor<2, dim>>> grad_phi(
-      n_q_points, std::vector<Tensor<2, dim>>(dofs_per_cell));
-    std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi(
-      n_q_points, std::vector<SymmetricTensor<2, dim>>(dofs_per_cell));
-
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_mass(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
     Tensor<1, dim> gravity;
     for (unsigned int i = 0; i < dim; ++i)
       {
         gravity[i] = parameters.gravity[i];
       }
 
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    // Every thread evaluates the cells with its own FEValues and buffers.
+    struct ScratchData
+    {
+      ScratchData(const FiniteElement<dim> &fe,
+                  const Quadrature<dim> &quad,
+                  const Quadrature<dim - 1> &face_quad)
+        : fe_values(fe,
+                    quad,
+                    update_values | update_gradients | update_JxW_values),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_normal_vectors |
+                           update_JxW_values),
+          phi(quad.size(), std::vector<Tensor<1, dim>>(fe.dofs_per_cell)),
+          grad_phi(quad.size(), std::vector<Tensor<2, dim>>(fe.dofs_per_cell)),
+          sym_grad_phi(
+            quad.size(),
+            std::vector<SymmetricTensor<2, dim>>(fe.dofs_per_cell))
       {
+      }
+      ScratchData(const ScratchData &scratch)
+        : fe_values(scratch.fe_values.get_fe(),
+                    scratch.fe_values.get_quadrature(),
+                    scratch.fe_values.get_update_flags()),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          phi(scratch.phi),
+          grad_phi(scratch.grad_phi),
+          sym_grad_phi(scratch.sym_grad_phi)
+      {
+      }
+      FEValues<dim> fe_values;
+      FEFaceValues<dim> fe_face_values;
+      std::vector<std::vector<Tensor<1, dim>>> phi;
+      std::vector<std::vector<Tensor<2, dim>>> grad_phi;
+      std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi;
+    };
+    // The local contributions of a cell, which are distributed to the global
+    // system in the order of the cells.
+    struct CopyData
+    {
+      CopyData(const unsigned int dofs_per_cell)
+        : local_matrix(dofs_per_cell, dofs_per_cell),
+          local_mass(dofs_per_cell, dofs_per_cell),
+          local_rhs(dofs_per_cell),
+          local_dof_indices(dofs_per_cell)
+      {
+      }
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_mass;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
+
+    auto worker =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &copy) {
+        FEValues<dim> &fe_values = scratch.fe_values;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_mass = copy.local_mass;
+        Vector<double> &local_rhs = copy.local_rhs;
+        std::vector<std::vector<Tensor<1, dim>>> &phi = scratch.phi;
+        std::vector<std::vector<Tensor<2, dim>>> &grad_phi = scratch.grad_phi;
+        std::vector<std::vector<SymmetricTensor<2, dim>>> &sym_grad_phi =
+          scratch.sym_grad_phi;
+
         auto p = cell_property.get_data(cell);
         Assert(p.size() == GeometryInfo<dim>::faces_per_cell,
                ExcMessage("Wrong number of cell data!"));
         fe_values.reinit(cell);
-        cell->get_dof_indices(local_dof_indices);
+        cell->get_dof_indices(copy.local_dof_indices);
 
         local_mass = 0;
         local_matrix = 0;
         local_rhs = 0;
 
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first = quad_point_history.first_point(cell);
 
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
-            const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
+            const Tensor<2, dim> F_inv =
+              quad_point_history.get_F_inv(first + q);
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
                 phi[q][k] = fe_values[displacement].value(k, q);
@@ -371,9 +459,11 @@ namespace Solid
                 sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
               }
 
-            const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-            const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-            const double rho = lqph[q]->get_density();
+            const SymmetricTensor<2, dim> tau =
+              quad_point_history.get_tau(first + q);
+            const SymmetricTensor<4, dim> Jc =
+              quad_point_history.get_Jc(first + q);
+            const double rho = quad_point_history.get_density(first + q);
             const double dt = time.get_delta_t();
             const double JxW = fe_values.JxW(q);
 
@@ -381,7 +471,8 @@ namespace Solid
               {
                 const unsigned int component_i =
                   fe.system_to_component_index(i).first;
-                for (unsigned int j = 0; j <= i; ++j)
+                // Only the rhs is needed if the matrices are not assembled.
+                for (unsigned int j = 0; assemble_matrix && j <= i; ++j)
                   {
                     if (initial_step)
                       {
@@ -454,7 +545,8 @@ namespace Solid
               {
                 // In stand-alone simulation, the boundary value is prescribed
                 // by the user.
-                prescribed_value = parameters.solid_neumann_bcs[id];
+                prescribed_value = parameters.solid_neumann_bcs.at(id);
+                neumann_table.value(id, time.current(), prescribed_value);
               }
 
             if (parameters.simulation_type != "FSI" &&
@@ -492,23 +584,38 @@ namespace Solid
               }
           }
 
-        if (initial_step)
-          {
-            constraints.distribute_local_to_global(local_mass,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   mass_matrix,
-                                                   system_rhs);
-          }
-        else
-          {
-            constraints.distribute_local_to_global(local_matrix,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   system_matrix,
-                                                   system_rhs);
-          }
-      }
+      };
+
+    auto copier = [&](const CopyData &copy) {
+      if (initial_step)
+        {
+          constraints.distribute_local_to_global(copy.local_mass,
+                                                 copy.local_rhs,
+                                                 copy.local_dof_indices,
+                                                 mass_matrix,
+                                                 system_rhs);
+        }
+      else if (assemble_matrix)
+        {
+          constraints.distribute_local_to_global(copy.local_matrix,
+                                                 copy.local_rhs,
+                                                 copy.local_dof_indices,
+                                                 system_matrix,
+                                                 system_rhs);
+        }
+      else
+        {
+          constraints.distribute_local_to_global(
+            copy.local_rhs, copy.local_dof_indices, system_rhs);
+        }
+    };
+
+    WorkStream::run(dof_handler.begin_active(),
+                    dof_handler.end(),
+                    worker,
+                    copier,
+                    ScratchData(fe, volume_quad_formula, face_quad_formula),
+                    CopyData(dofs_per_cell));
 
     timer.leave_subsection();
   }
@@ -516,6 +623,7 @@ namespace Solid
   template <int dim>
   void HyperElasticity<dim>::update_strain_and_stress()
   {
+    OPENIFEM_KERNEL_SCOPE("hyper_elasticity_stress");
     for (unsigned int i = 0; i < dim; ++i)
       {
         for (unsigned int j = 0; j < dim; ++j)
@@ -561,14 +669,15 @@ namespace Solid
       {
         scalar_cell->get_dof_indices(dof_indices);
         fe_values.reinit(cell);
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
+        const unsigned int first = quad_point_history.first_point(cell);
 
         for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
           {
-            const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-            const Tensor<2, dim> F = invert(lqph[q]->get_F_inv());
-            const double J = lqph[q]->get_det_F();
+            const SymmetricTensor<2, dim> tau =
+              quad_point_history.get_tau(first + q);
+            const Tensor<2, dim> F =
+              invert(quad_point_history.get_F_inv(first + q));
+            const double J = quad_point_history.get_det_F(first + q);
             for (unsigned int i = 0; i < dim; ++i)
               {
                 for (unsigned int j = 0; j < dim; ++j)
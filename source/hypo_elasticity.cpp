@@ -95,46 +95,37 @@ namespace Solid
   template <int dim>
   void HypoElasticity<dim>::synchronize()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
-    unsigned int n_face_q_points = face_quad_formula.size();
-    unsigned int face_quad_point_id = 0;
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
-      {
-        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+    // Every particle writes its own dofs, so the gather runs in parallel.
+    auto particles = m_body->get_particles();
+    parallel::apply_to_subranges(
+      0u,
+      static_cast<unsigned int>(particle_dofs.size()),
+      [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int id = begin; id < end; ++id)
           {
-            if (!vertex_touched[cell->vertex_index(v)])
+            for (unsigned int n = 0; n < dim; ++n)
               {
-                vertex_touched[cell->vertex_index(v)] = true;
-                int id = vertex_mapping[cell->vertex_index(v)];
-                auto disp = m_body->get_particles()[id]->x -
-                            m_body->get_particles()[id]->X;
-                auto vel = m_body->get_particles()[id]->v;
-                auto acc = m_body->get_particles()[id]->a;
-                for (unsigned int n = 0; n < dim; ++n)
-                  {
-                    current_displacement(cell->vertex_dof_index(v, n)) =
-                      disp[n];
-                    current_velocity(cell->vertex_dof_index(v, n)) = vel[n];
-                    current_acceleration(cell->vertex_dof_index(v, n)) = acc[n];
-                  }
+                const types::global_dof_index dof = particle_dofs[id][n];
+                current_displacement(dof) =
+                  particles[id]->x[n] - particles[id]->X[n];
+                current_velocity(dof) = particles[id]->v[n];
+                current_acceleration(dof) = particles[id]->a[n];
               }
           }
-        auto ptr = cell_property.get_data(cell);
-        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+      },
+      256);
+
+    // The face quadrature points of a boundary face are consecutive.
+    auto face_quad_points = m_body->get_face_quad_points();
+    const unsigned int n_face_q_points = face_quad_formula.size();
+    for (unsigned int k = 0; k < face_properties.size(); ++k)
+      {
+        const Tensor<1, dim> &traction = face_properties[k]->fsi_traction;
+        for (unsigned int q = 0; q < n_face_q_points; ++q)
           {
-            if (cell->face(f)->at_boundary())
+            for (unsigned int n = 0; n < dim; ++n)
               {
-                for (unsigned int q = 0; q < n_face_q_points; ++q)
-                  {
-                    auto traction = ptr[f]->fsi_traction;
-                    for (unsigned int n = 0; n < dim; ++n)
-                      {
-                        m_body->get_face_quad_points()[face_quad_point_id]
-                          ->t[n] = traction[n];
-                      }
-                    face_quad_point_id++;
-                  }
+                face_quad_points[k * n_face_q_points + q]->t[n] = traction[n];
               }
           }
       }
@@ -151,6 +142,8 @@ namespace Solid
     particle<dim> **particles = new particle<dim> *[n_particles];
     unsigned int particle_id = 0;
     vertex_mapping = std::vector<int>(triangulation.n_vertices(), -1);
+    particle_dofs.resize(n_particles);
+    face_properties.clear();
     // Volume quadrature points, assuming 2nd order integration
     unsigned int n_vol_quad =
       volume_quad_formula.size() * triangulation.n_active_cells();
@@ -181,6 +174,11 @@ namespace Solid
                   cell->measure() * parameters.solid_rho;
                 particles[particle_id]->quad_weight =
                   particles[particle_id]->m / particles[particle_id]->rho;
+                for (unsigned int n = 0; n < dim; ++n)
+                  {
+                    particle_dofs[particle_id][n] =
+                      cell->vertex_dof_index(v, n);
+                  }
                 vertex_mapping[cell->vertex_index(v)] = particle_id++;
               }
           }
@@ -226,6 +224,7 @@ namespace Solid
           {
             if (cell->face(f)->at_boundary())
               {
+                face_properties.push_back(cell_property.get_data(cell)[f]);
                 std::vector<unsigned int> dirichlet_ids;
                 std::vector<unsigned int> neumann_ids;
                 for (unsigned int v = 0;
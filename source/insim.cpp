@@ -18,7 +18,7 @@ namespace Fluid
     double dt,
     const BlockSparseMatrix<double> &system,
     const BlockSparseMatrix<double> &mass,
-    SparseMatrix<double> &schur)
+    const SparseMatrix<double> &schur)
     : timer(timer),
       gamma(gamma),
       viscosity(viscosity),
@@ -28,25 +28,9 @@ namespace Fluid
       mass_matrix(&mass),
       mass_schur(&schur)
   {
-    {
-      // Factoring A is also part of the direct solver.
-      TimerOutput::Scope timer_section(timer, "UMFPACK for A_inv");
-      A_inverse.initialize(system_matrix->block(0, 0));
-    }
-    {
-      TimerOutput::Scope timer_section(timer, "CG for Sm");
-      Vector<double> tmp1(mass_matrix->block(0, 0).m()), tmp2(tmp1);
-      tmp1 = 1;
-      tmp2 = 0;
-      // Jacobi preconditioner of matrix A is by definition inverse diag(A),
-      // this is exactly what we want to compute.
-      // Note that the mass matrix and mass schur do not include the density.
-      mass_matrix->block(0, 0).precondition_Jacobi(tmp2, tmp1);
-      // The sparsity pattern has already been set correctly, so explicitly
-      // tell mmult not to rebuild the sparsity pattern.
-      system_matrix->block(1, 0).mmult(
-        *mass_schur, system_matrix->block(0, 1), tmp2, false);
-    }
+    // Factoring A is also part of the direct solver.
+    TimerOutput::Scope timer_section(timer, "UMFPACK for A_inv");
+    A_inverse.initialize(system_matrix->block(0, 0));
   }
 
   /**
@@ -142,9 +126,11 @@ namespace Fluid
   void InsIM<dim>::assemble(const bool use_nonzero_constraints)
   {
     TimerOutput::Scope timer_section(timer, "Assemble system");
+    OPENIFEM_KERNEL_SCOPE("insim_assemble");
 
     const double viscosity = parameters.viscosity;
     const double gamma = parameters.grad_div;
+    const double delta_t = effective_delta_t();
     Tensor<1, dim> gravity;
     for (unsigned int i = 0; i < dim; ++i)
       gravity[i] = parameters.gravity[i];
@@ -153,16 +139,6 @@ namespace Fluid
     mass_matrix = 0;
     system_rhs = 0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_quadrature_points |
-                              update_JxW_values | update_gradients);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_quadrature_points |
-                                       update_JxW_values);
-
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
     const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
     const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -173,48 +149,129 @@ namespace Fluid
                 ExcMessage("Wrong partitioning of dofs!"));
 
     const FEValuesExtractors::Vector velocities(0);
-    const FEValuesExtractors::Scalar pressure(dim);
-
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-    std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-    std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-    std::vector<double> current_pressure_values(n_q_points);
-    std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-
-    std::vector<double> div_phi_u(dofs_per_cell);
-    std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-    std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-    std::vector<double> phi_p(dofs_per_cell);
-
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    // Every thread evaluates the cells with its own copy of the cell FE data
+    // and its own buffers.
+    struct ScratchData
+    {
+      ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                  const FiniteElement<dim> &fe,
+                  const Quadrature<dim - 1> &face_quad,
+                  const unsigned int n_q_points)
+        : cell_fe_data(cell_fe_data),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_normal_vectors |
+                           update_quadrature_points | update_JxW_values),
+          current_dof_values(fe.dofs_per_cell),
+          present_dof_values(fe.dofs_per_cell),
+          current_velocity_values(n_q_points),
+          current_velocity_gradients(n_q_points),
+          current_pressure_values(n_q_points),
+          present_velocity_values(n_q_points),
+          div_phi_u(fe.dofs_per_cell),
+          phi_u(fe.dofs_per_cell),
+          grad_phi_u(fe.dofs_per_cell),
+          phi_p(fe.dofs_per_cell)
+      {
+      }
+      ScratchData(const ScratchData &scratch)
+        : cell_fe_data(scratch.cell_fe_data),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          current_dof_values(scratch.current_dof_values),
+          present_dof_values(scratch.present_dof_values),
+          current_velocity_values(scratch.current_velocity_values),
+          current_velocity_gradients(scratch.current_velocity_gradients),
+          current_pressure_values(scratch.current_pressure_values),
+          present_velocity_values(scratch.present_velocity_values),
+          div_phi_u(scratch.div_phi_u),
+          phi_u(scratch.phi_u),
+          grad_phi_u(scratch.grad_phi_u),
+          phi_p(scratch.phi_p)
+      {
+      }
+      Utils::CellFEDataCache<dim> cell_fe_data;
+      FEFaceValues<dim> fe_face_values;
+      Vector<double> current_dof_values;
+      Vector<double> present_dof_values;
+      std::vector<Tensor<1, dim>> current_velocity_values;
+      std::vector<Tensor<2, dim>> current_velocity_gradients;
+      std::vector<double> current_pressure_values;
+      std::vector<Tensor<1, dim>> present_velocity_values;
+      std::vector<double> div_phi_u;
+      std::vector<Tensor<1, dim>> phi_u;
+      std::vector<Tensor<2, dim>> grad_phi_u;
+      std::vector<double> phi_p;
+    };
+    // The local contributions of a cell, which are distributed to the global
+    // system in the order of the cells.
+    struct CopyData
+    {
+      CopyData(const unsigned int dofs_per_cell)
+        : local_matrix(dofs_per_cell, dofs_per_cell),
+          local_mass_matrix(dofs_per_cell, dofs_per_cell),
+          local_rhs(dofs_per_cell),
+          local_dof_indices(dofs_per_cell)
       {
+      }
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_mass_matrix;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
+
+    auto worker =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &copy) {
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_mass_matrix = copy.local_mass_matrix;
+        Vector<double> &local_rhs = copy.local_rhs;
+        Vector<double> &current_dof_values = scratch.current_dof_values;
+        Vector<double> &present_dof_values = scratch.present_dof_values;
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<Tensor<1, dim>> &present_velocity_values =
+          scratch.present_velocity_values;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
+
         auto p = cell_property.get_data(cell);
         const int ind = p[0]->indicator;
         const double rho = parameters.fluid_rho;
 
-        fe_values.reinit(cell);
+        cell_fe_data.reinit(cell);
 
         local_matrix = 0;
         local_mass_matrix = 0;
         local_rhs = 0;
 
-        fe_values[velocities].get_function_values(evaluation_point,
-                                                  current_velocity_values);
+        cell->get_dof_values(evaluation_point, current_dof_values);
+        // The history of the time derivative, which is the present solution
+        // unless BDF2 is used.
+        cell->get_dof_values(time_history(), present_dof_values);
 
-        fe_values[velocities].get_function_gradients(
-          evaluation_point, current_velocity_gradients);
+        cell_fe_data.get_velocity_values(current_dof_values,
+                                         current_velocity_values);
 
-        fe_values[pressure].get_function_values(evaluation_point,
-                                                current_pressure_values);
+        cell_fe_data.get_velocity_gradients(current_dof_values,
+                                            current_velocity_gradients);
 
-        fe_values[velocities].get_function_values(present_solution,
-                                                  present_velocity_values);
+        cell_fe_data.get_pressure_values(current_dof_values,
+                                         current_pressure_values);
+
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         present_velocity_values);
 
         // Assemble the system matrix and mass matrix simultaneouly.
         // The mass matrix only uses the (0, 0) and (1, 1) blocks.
@@ -223,10 +280,10 @@ namespace Fluid
           {
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
-                div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                phi_u[k] = fe_values[velocities].value(k, q);
-                phi_p[k] = fe_values[pressure].value(k, q);
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
               }
 
             for (unsigned int i = 0; i < dofs_per_cell; ++i)
@@ -251,11 +308,11 @@ namespace Fluid
                          rho -
                        div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
                        gamma * div_phi_u[j] * div_phi_u[i] * rho +
-                       phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
-                      fe_values.JxW(q);
+                       phi_u[i] * phi_u[j] / delta_t * rho) *
+                      cell_fe_data.JxW(q);
                     local_mass_matrix(i, j) +=
                       (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                   }
 
                 // RHS is \f$-(A_{current} + C_{current}) -
@@ -271,15 +328,15 @@ namespace Fluid
                     current_velocity_divergence * phi_p[i] -
                     gamma * current_velocity_divergence * div_phi_u[i] * rho) -
                    (current_velocity_values[q] - present_velocity_values[q]) *
-                     phi_u[i] / time.get_delta_t() * rho +
+                     phi_u[i] / delta_t * rho +
                    gravity * phi_u[i] * rho) *
-                  fe_values.JxW(q);
+                  cell_fe_data.JxW(q);
                 if (ind == 1)
                   {
                     local_rhs(i) +=
                       (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
                        p[0]->fsi_acceleration * phi_u[i]) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                   }
               }
           }
@@ -302,7 +359,7 @@ namespace Fluid
                     fe_face_values.reinit(cell, face_n);
                     unsigned int p_bc_id = cell->face(face_n)->boundary_id();
                     double boundary_values_p =
-                      parameters.fluid_neumann_bcs[p_bc_id];
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
                     for (unsigned int q = 0; q < n_face_q_points; ++q)
                       {
                         for (unsigned int i = 0; i < dofs_per_cell; ++i)
@@ -317,19 +374,29 @@ namespace Fluid
               }
           }
 
-        cell->get_dof_indices(local_dof_indices);
-
-        const AffineConstraints<double> &constraints_used =
-          use_nonzero_constraints ? nonzero_constraints : zero_constraints;
-        constraints_used.distribute_local_to_global(local_matrix,
-                                                    local_rhs,
-                                                    local_dof_indices,
-                                                    system_matrix,
-                                                    system_rhs,
-                                                    true);
-        constraints_used.distribute_local_to_global(
-          local_mass_matrix, local_dof_indices, mass_matrix);
-      }
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
+
+    const AffineConstraints<double> &constraints_used =
+      use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+    auto copier = [&](const CopyData &copy) {
+      constraints_used.distribute_local_to_global(copy.local_matrix,
+                                                  copy.local_rhs,
+                                                  copy.local_dof_indices,
+                                                  system_matrix,
+                                                  system_rhs,
+                                                  true);
+      constraints_used.distribute_local_to_global(
+        copy.local_mass_matrix, copy.local_dof_indices, mass_matrix);
+    };
+
+    WorkStream::run(
+      dof_handler.begin_active(),
+      dof_handler.end(),
+      worker,
+      copier,
+      ScratchData(cell_fe_data, fe, face_quad_formula, n_q_points),
+      CopyData(dofs_per_cell));
   }
 
   template <int dim>
@@ -337,15 +404,26 @@ namespace Fluid
   InsIM<dim>::solve(const bool use_nonzero_constraints)
   {
     TimerOutput::Scope timer_section(timer, "Solve linear system");
+    const double delta_t = effective_delta_t();
 
-    preconditioner.reset(new BlockSchurPreconditioner(timer,
-                                                      parameters.grad_div,
-                                                      parameters.viscosity,
-                                                      parameters.fluid_rho,
-                                                      time.get_delta_t(),
-                                                      system_matrix,
-                                                      mass_matrix,
-                                                      mass_schur));
+    // The factorization of the velocity block is kept by the preconditioner,
+    // so it lags behind the matrix if the preconditioner is reused.
+    if (!preconditioner ||
+        preconditioner_reuse.need_rebuild(delta_t, system_matrix.block(0, 0)))
+      {
+        // The mass Schur complement is kept until the mesh or the
+        // constrained dofs change.
+        update_mass_schur();
+        preconditioner.reset(new BlockSchurPreconditioner(timer,
+                                                          parameters.grad_div,
+                                                          parameters.viscosity,
+                                                          parameters.fluid_rho,
+                                                          delta_t,
+                                                          system_matrix,
+                                                          mass_matrix,
+                                                          mass_schur));
+        preconditioner_reuse.rebuilt(delta_t, system_matrix.block(0, 0));
+      }
 
     // NOTE: SolverFGMRES only applies the preconditioner from the right,
     // as opposed to SolverGMRES which allows both left and right
@@ -356,6 +434,7 @@ namespace Fluid
     SolverFGMRES<BlockVector<double>> gmres(solver_control, vector_memory);
 
     gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
+    preconditioner_reuse.record(solver_control.last_step());
 
     const AffineConstraints<double> &constraints_used =
       use_nonzero_constraints ? nonzero_constraints : zero_constraints;
@@ -381,6 +460,7 @@ namespace Fluid
     std::cout << std::string(96, '*') << std::endl
               << "Time step = " << time.get_timestep()
               << ", at t = " << std::scientific << time.current() << std::endl;
+    update_time_history();
 
     // Resetting
     double current_residual = 1.0;
@@ -388,6 +468,13 @@ namespace Fluid
     double relative_residual = 1.0;
     unsigned int outer_iteration = 0;
     evaluation_point = present_solution;
+    // Start from the extrapolated solution unless the boundary values are
+    // applied in this step, which assumes the present solution.
+    if (!apply_nonzero_constraints)
+      {
+        solution_predictor.predict(evaluation_point, time.get_delta_t());
+      }
+    unsigned int total_iterations = 0;
     while (relative_residual > parameters.fluid_tolerance &&
            current_residual > 1e-11)
       {
@@ -406,6 +493,7 @@ namespace Fluid
         assemble(apply_nonzero_constraints && outer_iteration == 0);
         auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
         current_residual = system_rhs.l2_norm();
+        total_iterations += state.first;
 
         // Update evaluation_point. Since newton_update has been set to
         // the correct bc values, there is no need to distribute the
@@ -427,13 +515,19 @@ namespace Fluid
 
         outer_iteration++;
       }
+    std::cout << " NEWTON_ITR = " << outer_iteration
+              << " TOTAL_GMRES_ITR = " << total_iterations << std::endl;
     // Update solution increment, which is used in FSI application.
     solution_increment = evaluation_point;
     solution_increment -= present_solution;
     // Newton iteration converges, update time and solution
+    record_previous_solution();
     present_solution = evaluation_point;
+    solution_predictor.record(present_solution, time.get_delta_t());
     // Update stress for output
     update_stress();
+    // Choose the next time step size
+    adapt_time_step(outer_iteration);
     // Output
     if (time.time_to_output())
       {
@@ -448,7 +542,8 @@ namespace Fluid
   template <int dim>
   void InsIM<dim>::run()
   {
-    triangulation.refine_global(parameters.global_refinements[0]);
+    Utils::refine_global_cached(
+      triangulation, parameters.global_refinements[0], parameters.mesh_cache);
     setup_dofs();
     make_constraints();
     initialize_system();
@@ -462,6 +557,12 @@ namespace Fluid
     while (time.end() - time.current() > 1e-12)
       {
         run_one_step(false);
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        if (reached_steady_state())
+          {
+            break;
+          }
       }
   }
 
@@ -11,7 +11,7 @@ namespace Fluid
     double dt,
     const BlockSparseMatrix<double> &system,
     const BlockSparseMatrix<double> &mass,
-    SparseMatrix<double> &schur)
+    const SparseMatrix<double> &schur)
     : timer(timer),
       gamma(gamma),
       viscosity(viscosity),
@@ -21,18 +21,6 @@ namespace Fluid
       mass_matrix(&mass),
       mass_schur(&schur)
   {
-    TimerOutput::Scope timer_section(timer, "CG for Sm");
-    Vector<double> tmp1(mass_matrix->block(0, 0).m()), tmp2(tmp1);
-    tmp1 = 1;
-    tmp2 = 0;
-    // Jacobi preconditioner of matrix A is by definition inverse diag(A),
-    // this is exactly what we want to compute.
-    // Note that the mass matrix and mass schur do not include the density.
-    mass_matrix->block(0, 0).precondition_Jacobi(tmp2, tmp1);
-    // The sparsity pattern has already been set correctly, so explicitly
-    // tell mmult not to rebuild the sparsity pattern.
-    system_matrix->block(1, 0).mmult(
-      *mass_schur, system_matrix->block(0, 1), tmp2, false);
   }
 
   /**
@@ -111,7 +99,9 @@ namespace Fluid
   InsIMEX<dim>::InsIMEX(Triangulation<dim> &tria,
                         const Parameters::AllParameters &parameters,
                         std::shared_ptr<Function<dim>> bc)
-    : FluidSolver<dim>(tria, parameters, bc)
+    : FluidSolver<dim>(tria, parameters, bc),
+      matrix_outdated(true),
+      matrix_delta_t(0)
   {
     Assert(
       parameters.fluid_velocity_degree - parameters.fluid_pressure_degree == 1,
@@ -123,6 +113,7 @@ namespace Fluid
   {
     FluidSolver<dim>::initialize_system();
     preconditioner.reset();
+    matrix_outdated = true;
     solution_increment.reinit(dofs_per_block);
   }
 
@@ -131,6 +122,7 @@ namespace Fluid
                               bool assemble_system)
   {
     TimerOutput::Scope timer_section(timer, "Assemble system");
+    OPENIFEM_KERNEL_SCOPE("insimex_assemble");
 
     const double viscosity = parameters.viscosity;
     const double gamma = parameters.grad_div;
@@ -145,16 +137,6 @@ namespace Fluid
       }
     system_rhs = 0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_quadrature_points |
-                              update_JxW_values | update_gradients);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_quadrature_points |
-                                       update_JxW_values);
-
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
     const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
     const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -165,32 +147,104 @@ namespace Fluid
                 ExcMessage("Wrong partitioning of dofs!"));
 
     const FEValuesExtractors::Vector velocities(0);
-    const FEValuesExtractors::Scalar pressure(dim);
-
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
-
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-    std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-    std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-    std::vector<double> current_velocity_divergences(n_q_points);
-    std::vector<double> current_pressure_values(n_q_points);
 
-    std::vector<double> div_phi_u(dofs_per_cell);
-    std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-    std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-    std::vector<double> phi_p(dofs_per_cell);
-
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    // Every thread evaluates the cells with its own copy of the cell FE data
+    // and its own buffers.
+    struct ScratchData
+    {
+      ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                  const FiniteElement<dim> &fe,
+                  const Quadrature<dim - 1> &face_quad,
+                  const unsigned int n_q_points)
+        : cell_fe_data(cell_fe_data),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_normal_vectors |
+                           update_quadrature_points | update_JxW_values),
+          present_dof_values(fe.dofs_per_cell),
+          current_velocity_values(n_q_points),
+          current_velocity_gradients(n_q_points),
+          current_velocity_divergences(n_q_points),
+          current_pressure_values(n_q_points),
+          div_phi_u(fe.dofs_per_cell),
+          phi_u(fe.dofs_per_cell),
+          grad_phi_u(fe.dofs_per_cell),
+          phi_p(fe.dofs_per_cell)
+      {
+      }
+      ScratchData(const ScratchData &scratch)
+        : cell_fe_data(scratch.cell_fe_data),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          present_dof_values(scratch.present_dof_values),
+          current_velocity_values(scratch.current_velocity_values),
+          current_velocity_gradients(scratch.current_velocity_gradients),
+          current_velocity_divergences(scratch.current_velocity_divergences),
+          current_pressure_values(scratch.current_pressure_values),
+          div_phi_u(scratch.div_phi_u),
+          phi_u(scratch.phi_u),
+          grad_phi_u(scratch.grad_phi_u),
+          phi_p(scratch.phi_p)
       {
+      }
+      Utils::CellFEDataCache<dim> cell_fe_data;
+      FEFaceValues<dim> fe_face_values;
+      Vector<double> present_dof_values;
+      std::vector<Tensor<1, dim>> current_velocity_values;
+      std::vector<Tensor<2, dim>> current_velocity_gradients;
+      std::vector<double> current_velocity_divergences;
+      std::vector<double> current_pressure_values;
+      std::vector<double> div_phi_u;
+      std::vector<Tensor<1, dim>> phi_u;
+      std::vector<Tensor<2, dim>> grad_phi_u;
+      std::vector<double> phi_p;
+    };
+    // The local contributions of a cell, which are distributed to the global
+    // system in the order of the cells.
+    struct CopyData
+    {
+      CopyData(const unsigned int dofs_per_cell)
+        : local_matrix(dofs_per_cell, dofs_per_cell),
+          local_mass_matrix(dofs_per_cell, dofs_per_cell),
+          local_rhs(dofs_per_cell),
+          local_dof_indices(dofs_per_cell)
+      {
+      }
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_mass_matrix;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
+
+    auto worker =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &copy) {
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_mass_matrix = copy.local_mass_matrix;
+        Vector<double> &local_rhs = copy.local_rhs;
+        Vector<double> &present_dof_values = scratch.present_dof_values;
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_velocity_divergences =
+          scratch.current_velocity_divergences;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
+
         auto p = cell_property.get_data(cell);
         const int ind = p[0]->indicator;
         const double rho = parameters.fluid_rho;
 
-        fe_values.reinit(cell);
+        cell_fe_data.reinit(cell);
 
         if (assemble_system)
           {
@@ -199,17 +253,19 @@ namespace Fluid
           }
         local_rhs = 0;
 
-        fe_values[velocities].get_function_values(present_solution,
-                                                  current_velocity_values);
+        cell->get_dof_values(present_solution, present_dof_values);
+
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         current_velocity_values);
 
-        fe_values[velocities].get_function_gradients(
-          present_solution, current_velocity_gradients);
+        cell_fe_data.get_velocity_gradients(present_dof_values,
+                                            current_velocity_gradients);
 
-        fe_values[pressure].get_function_values(present_solution,
-                                                current_pressure_values);
+        cell_fe_data.get_pressure_values(present_dof_values,
+                                         current_pressure_values);
 
-        fe_values[velocities].get_function_divergences(
-          present_solution, current_velocity_divergences);
+        cell_fe_data.get_velocity_divergences(present_dof_values,
+                                              current_velocity_divergences);
 
         // Assemble the system matrix and mass matrix simultaneouly.
         // The mass matrix only uses the (0, 0) and (1, 1) blocks.
@@ -218,10 +274,10 @@ namespace Fluid
           {
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
-                div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                phi_u[k] = fe_values[velocities].value(k, q);
-                phi_p[k] = fe_values[pressure].value(k, q);
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
               }
 
             for (unsigned int i = 0; i < dofs_per_cell; ++i)
@@ -234,10 +290,10 @@ namespace Fluid
                        div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
                        gamma * div_phi_u[j] * div_phi_u[i] * rho +
                        phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                     local_mass_matrix(i, j) +=
                       (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                   }
                 local_rhs(i) -=
                   (viscosity * scalar_product(current_velocity_gradients[q],
@@ -249,13 +305,13 @@ namespace Fluid
                    current_velocity_gradients[q] * current_velocity_values[q] *
                      phi_u[i] * rho -
                    gravity * phi_u[i] * rho) *
-                  fe_values.JxW(q);
+                  cell_fe_data.JxW(q);
                 if (ind == 1)
                   {
                     local_rhs(i) +=
                       (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
                        (p[0]->fsi_acceleration * rho * phi_u[i])) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                   }
               }
           }
@@ -278,7 +334,7 @@ namespace Fluid
                     fe_face_values.reinit(cell, face_n);
                     unsigned int p_bc_id = cell->face(face_n)->boundary_id();
                     double boundary_values_p =
-                      parameters.fluid_neumann_bcs[p_bc_id];
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
                     for (unsigned int q = 0; q < n_face_q_points; ++q)
                       {
                         for (unsigned int i = 0; i < dofs_per_cell; ++i)
@@ -293,28 +349,37 @@ namespace Fluid
               }
           }
 
-        cell->get_dof_indices(local_dof_indices);
-
-        const AffineConstraints<double> &constraints_used =
-          use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
 
-        if (assemble_system)
-          {
-            constraints_used.distribute_local_to_global(local_matrix,
-                                                        local_rhs,
-                                                        local_dof_indices,
-                                                        system_matrix,
-                                                        system_rhs,
-                                                        true);
-            constraints_used.distribute_local_to_global(
-              local_mass_matrix, local_dof_indices, mass_matrix);
-          }
-        else
-          {
-            constraints_used.distribute_local_to_global(
-              local_rhs, local_dof_indices, system_rhs);
-          }
-      }
+    const AffineConstraints<double> &constraints_used =
+      use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+    auto copier = [&](const CopyData &copy) {
+      if (assemble_system)
+        {
+          constraints_used.distribute_local_to_global(copy.local_matrix,
+                                                      copy.local_rhs,
+                                                      copy.local_dof_indices,
+                                                      system_matrix,
+                                                      system_rhs,
+                                                      true);
+          constraints_used.distribute_local_to_global(
+            copy.local_mass_matrix, copy.local_dof_indices, mass_matrix);
+        }
+      else
+        {
+          constraints_used.distribute_local_to_global(
+            copy.local_rhs, copy.local_dof_indices, system_rhs);
+        }
+    };
+
+    WorkStream::run(
+      dof_handler.begin_active(),
+      dof_handler.end(),
+      worker,
+      copier,
+      ScratchData(cell_fe_data, fe, face_quad_formula, n_q_points),
+      CopyData(dofs_per_cell));
   }
 
   template <int dim>
@@ -322,8 +387,15 @@ namespace Fluid
   InsIMEX<dim>::solve(bool use_nonzero_constraints, bool assemble_system)
   {
     TimerOutput::Scope timer_section(timer, "Solve linear system");
-    if (assemble_system)
+    // The preconditioner is only rebuilt with a new matrix.
+    if (!preconditioner ||
+        (assemble_system &&
+         preconditioner_reuse.need_rebuild(time.get_delta_t(),
+                                           system_matrix.block(0, 0))))
       {
+        // The mass Schur complement is kept until the mesh or the
+        // constrained dofs change.
+        update_mass_schur();
         preconditioner.reset(new BlockSchurPreconditioner(timer,
                                                           parameters.grad_div,
                                                           parameters.viscosity,
@@ -332,6 +404,8 @@ namespace Fluid
                                                           system_matrix,
                                                           mass_matrix,
                                                           mass_schur));
+        preconditioner_reuse.rebuilt(time.get_delta_t(),
+                                     system_matrix.block(0, 0));
       }
 
     SolverControl solver_control(
@@ -340,6 +414,7 @@ namespace Fluid
     SolverFGMRES<BlockVector<double>> gmres(solver_control, vector_memory);
 
     gmres.solve(system_matrix, solution_increment, system_rhs, *preconditioner);
+    preconditioner_reuse.record(solver_control.last_step());
 
     const AffineConstraints<double> &constraints_used =
       use_nonzero_constraints ? nonzero_constraints : zero_constraints;
@@ -367,15 +442,33 @@ namespace Fluid
 
     // Resetting
     solution_increment = 0;
-    assemble(apply_nonzero_constraints, assemble_system);
-    auto state = solve(apply_nonzero_constraints, assemble_system);
+    // Start from the extrapolated increment unless the boundary values are
+    // applied in this step.
+    if (!apply_nonzero_constraints &&
+        solution_predictor.predict(solution_increment, time.get_delta_t()))
+      {
+        solution_increment -= present_solution;
+      }
+    static_cast<void>(assemble_system);
+    const bool assemble_matrix = matrix_outdated || apply_nonzero_constraints ||
+                                 time.get_delta_t() != matrix_delta_t;
+    assemble(apply_nonzero_constraints, assemble_matrix);
+    if (assemble_matrix)
+      {
+        matrix_outdated = false;
+        matrix_delta_t = time.get_delta_t();
+      }
+    auto state = solve(apply_nonzero_constraints, assemble_matrix);
 
     present_solution += solution_increment;
+    solution_predictor.record(present_solution, time.get_delta_t());
 
     std::cout << std::scientific << std::left << " GMRES_ITR = " << std::setw(3)
               << state.first << " GMRES_RES = " << state.second << std::endl;
     // Update stress for output
     update_stress();
+    // Choose the next time step size
+    adapt_time_step(0);
     // Output
     if (time.time_to_output())
       {
@@ -390,7 +483,8 @@ namespace Fluid
   template <int dim>
   void InsIMEX<dim>::run()
   {
-    triangulation.refine_global(parameters.global_refinements[0]);
+    Utils::refine_global_cached(
+      triangulation, parameters.global_refinements[0], parameters.mesh_cache);
     setup_dofs();
     make_constraints();
     initialize_system();
@@ -398,7 +492,13 @@ namespace Fluid
     // Time loop.
     while (time.end() - time.current() > 1e-12)
       {
-        run_one_step(time.get_timestep() == 0, time.get_timestep() < 2);
+        run_one_step(time.get_timestep() == 0);
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        if (reached_steady_state())
+          {
+            break;
+          }
       }
   }
 
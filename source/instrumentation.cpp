@@ -0,0 +1,14 @@
+#include "instrumentation.h"
+
+#ifdef OPENIFEM_WITH_LIKWID
+namespace
+{
+  /// Initialize the markers when the library is loaded and write the
+  /// results when the program exits.
+  struct MarkerSession
+  {
+    MarkerSession() { LIKWID_MARKER_INIT; }
+    ~MarkerSession() { LIKWID_MARKER_CLOSE; }
+  } marker_session;
+} // namespace
+#endif
@@ -1,13 +1,41 @@
 #include "linear_elasticity.h"
 
+#ifdef OPENIFEM_WITH_CUDA
+#include <deal.II/lac/read_write_vector.h>
+#endif
+
 namespace Solid
 {
   using namespace dealii;
 
+#ifdef OPENIFEM_WITH_CUDA
+  namespace
+  {
+    void upload(const Vector<double> &src,
+                LinearAlgebra::CUDAWrappers::Vector<double> &dst)
+    {
+      LinearAlgebra::ReadWriteVector<double> buffer(
+        complete_index_set(src.size()));
+      std::copy(src.begin(), src.end(), buffer.begin());
+      dst.reinit(src.size(), true);
+      dst.import(buffer, VectorOperation::insert);
+    }
+
+    void download(const LinearAlgebra::CUDAWrappers::Vector<double> &src,
+                  Vector<double> &dst)
+    {
+      LinearAlgebra::ReadWriteVector<double> buffer(
+        complete_index_set(src.size()));
+      buffer.import(src, VectorOperation::insert);
+      std::copy(buffer.begin(), buffer.end(), dst.begin());
+    }
+  } // namespace
+#endif
+
   template <int dim>
   LinearElasticity<dim>::LinearElasticity(
     Triangulation<dim> &tria, const Parameters::AllParameters &parameters)
-    : SolidSolver<dim>(tria, parameters)
+    : SolidSolver<dim>(tria, parameters), factorized_delta_t(0)
   {
     material.resize(parameters.n_solid_parts, LinearElasticMaterial<dim>());
     for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
@@ -22,6 +50,7 @@ namespace Solid
   void LinearElasticity<dim>::assemble(bool is_initial, bool assemble_matrix)
   {
     TimerOutput::Scope timer_section(timer, "Assemble system");
+    OPENIFEM_KERNEL_SCOPE("linear_elasticity_assemble");
 
     double gamma = 0.5 + parameters.damping;
     double beta = gamma / 2;
@@ -33,18 +62,6 @@ namespace Solid
       }
     system_rhs = 0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_quadrature_points | update_JxW_values);
-
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_quadrature_points |
-                                       update_normal_vectors |
-                                       update_JxW_values);
-
-    SymmetricTensor<4, dim> elasticity;
     const double rho = material[0].get_density();
     const double dt = time.get_delta_t();
 
@@ -52,30 +69,91 @@ namespace Solid
     const unsigned int n_q_points = volume_quad_formula.size();
     const unsigned int n_f_q_points = face_quad_formula.size();
 
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_stiffness(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
+    // The explicit integrator moves the internal force to the rhs.
+    const bool internal_force =
+      !assemble_matrix && !external_force_only &&
+      parameters.solid_time_integrator == "Central difference";
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-    // The symmetric gradients of the displacement shape functions at a certain
-    // point.
-    // There are dofs_per_cell shape functions so the size is dofs_per_cell.
-    std::vector<SymmetricTensor<2, dim>> symmetric_grad_phi(dofs_per_cell);
-    // The shape functions at a certain point.
-    std::vector<Tensor<1, dim>> phi(dofs_per_cell);
     // A "viewer" to describe the nodal dofs as a vector.
     FEValuesExtractors::Vector displacements(0);
 
-    // Loop over cells
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    // Every thread evaluates the cells with its own FEValues and buffers.
+    struct ScratchData
+    {
+      ScratchData(const FiniteElement<dim> &fe,
+                  const Quadrature<dim> &quad,
+                  const Quadrature<dim - 1> &face_quad)
+        : fe_values(fe,
+                    quad,
+                    update_values | update_gradients |
+                      update_quadrature_points | update_JxW_values),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_quadrature_points |
+                           update_normal_vectors | update_JxW_values),
+          symmetric_grad_phi(fe.dofs_per_cell),
+          phi(fe.dofs_per_cell),
+          symmetric_grad_u(quad.size())
+      {
+      }
+      ScratchData(const ScratchData &scratch)
+        : fe_values(scratch.fe_values.get_fe(),
+                    scratch.fe_values.get_quadrature(),
+                    scratch.fe_values.get_update_flags()),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          symmetric_grad_phi(scratch.symmetric_grad_phi),
+          phi(scratch.phi),
+          symmetric_grad_u(scratch.symmetric_grad_u)
       {
+      }
+      FEValues<dim> fe_values;
+      FEFaceValues<dim> fe_face_values;
+      // The symmetric gradients of the displacement shape functions at a
+      // certain point.
+      // There are dofs_per_cell shape functions so the size is dofs_per_cell.
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_phi;
+      // The shape functions at a certain point.
+      std::vector<Tensor<1, dim>> phi;
+      // The strain at the quadrature points, only for the internal force.
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_u;
+    };
+    // The local contributions of a cell, which are distributed to the global
+    // system in the order of the cells.
+    struct CopyData
+    {
+      CopyData(const unsigned int dofs_per_cell)
+        : local_matrix(dofs_per_cell, dofs_per_cell),
+          local_stiffness(dofs_per_cell, dofs_per_cell),
+          local_rhs(dofs_per_cell),
+          local_dof_indices(dofs_per_cell)
+      {
+      }
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_stiffness;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
+
+    auto worker =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &copy) {
+        FEValues<dim> &fe_values = scratch.fe_values;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_stiffness = copy.local_stiffness;
+        Vector<double> &local_rhs = copy.local_rhs;
+        std::vector<SymmetricTensor<2, dim>> &symmetric_grad_phi =
+          scratch.symmetric_grad_phi;
+        std::vector<Tensor<1, dim>> &phi = scratch.phi;
+
         auto p = cell_property.get_data(cell);
         int mat_id = cell->material_id();
         if (material.size() == 1)
           mat_id = 1;
-        elasticity = material[mat_id - 1].get_elasticity();
+        const LinearElasticMaterial<dim> &cell_material = material[mat_id - 1];
         Assert(p.size() == GeometryInfo<dim>::faces_per_cell,
                ExcMessage("Wrong number of cell data!"));
         local_matrix = 0;
@@ -83,10 +161,19 @@ namespace Solid
         local_rhs = 0;
 
         fe_values.reinit(cell);
+        if (internal_force)
+          {
+            fe_values[displacements].get_function_symmetric_gradients(
+              current_displacement, scratch.symmetric_grad_u);
+          }
 
         // Loop over quadrature points
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
+            const SymmetricTensor<2, dim> sigma =
+              internal_force
+                ? cell_material.get_stress(scratch.symmetric_grad_u[q])
+                : SymmetricTensor<2, dim>();
             // Loop over the dofs once, to calculate the grad_ph_u
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
@@ -108,14 +195,15 @@ namespace Solid
                           }
                         else
                           {
+                            const double stiffness =
+                              cell_material.get_stiffness(
+                                symmetric_grad_phi[i], symmetric_grad_phi[j]);
                             local_matrix[i][j] +=
                               (rho * phi[i] * phi[j] +
-                               symmetric_grad_phi[i] * elasticity *
-                                 symmetric_grad_phi[j] * beta * dt * dt) *
+                               stiffness * beta * dt * dt) *
                               fe_values.JxW(q);
                             local_stiffness[i][j] +=
-                              symmetric_grad_phi[i] * elasticity *
-                              symmetric_grad_phi[j] * fe_values.JxW(q);
+                              stiffness * fe_values.JxW(q);
                           }
                       }
                   }
@@ -126,10 +214,16 @@ namespace Solid
                     gravity[i] = parameters.gravity[i];
                   }
                 local_rhs[i] += phi[i] * gravity * rho * fe_values.JxW(q);
+                if (internal_force)
+                  {
+                    // -internal force
+                    local_rhs[i] -=
+                      symmetric_grad_phi[i] * sigma * fe_values.JxW(q);
+                  }
               }
           }
 
-        cell->get_dof_indices(local_dof_indices);
+        cell->get_dof_indices(copy.local_dof_indices);
 
         // Neumann boundary conditions
         // If this is a stand-alone solid simulation, the Neumann boundary type
@@ -165,7 +259,8 @@ namespace Solid
               {
                 // In stand-alone simulation, the boundary value is prescribed
                 // by the user.
-                prescribed_value = parameters.solid_neumann_bcs[id];
+                prescribed_value = parameters.solid_neumann_bcs.at(id);
+                neumann_table.value(id, time.current(), prescribed_value);
               }
 
             if (parameters.simulation_type != "FSI" &&
@@ -206,24 +301,34 @@ namespace Solid
               }
           }
 
-        if (assemble_matrix)
-          {
-            // Now distribute local data to the system, and apply the
-            // hanging node constraints at the same time.
-            constraints.distribute_local_to_global(local_matrix,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   system_matrix,
-                                                   system_rhs);
-            constraints.distribute_local_to_global(
-              local_stiffness, local_dof_indices, stiffness_matrix);
-          }
-        else
-          {
-            constraints.distribute_local_to_global(
-              local_rhs, local_dof_indices, system_rhs);
-          }
-      }
+      };
+
+    auto copier = [&](const CopyData &copy) {
+      if (assemble_matrix)
+        {
+          // Now distribute local data to the system, and apply the
+          // hanging node constraints at the same time.
+          constraints.distribute_local_to_global(copy.local_matrix,
+                                                 copy.local_rhs,
+                                                 copy.local_dof_indices,
+                                                 system_matrix,
+                                                 system_rhs);
+          constraints.distribute_local_to_global(
+            copy.local_stiffness, copy.local_dof_indices, stiffness_matrix);
+        }
+      else
+        {
+          constraints.distribute_local_to_global(
+            copy.local_rhs, copy.local_dof_indices, system_rhs);
+        }
+    };
+
+    WorkStream::run(dof_handler.begin_active(),
+                    dof_handler.end(),
+                    worker,
+                    copier,
+                    ScratchData(fe, volume_quad_formula, face_quad_formula),
+                    CopyData(dofs_per_cell));
   }
 
   template <int dim>
@@ -239,12 +344,46 @@ namespace Solid
     assemble(false, false);
   }
 
+  template <int dim>
+  void LinearElasticity<dim>::assemble_explicit_rhs()
+  {
+    assemble(false, false);
+  }
+
   template <int dim>
   void LinearElasticity<dim>::run_one_step(bool first_step)
   {
     std::cout.precision(6);
     std::cout.width(12);
 
+    if (parameters.solid_time_integrator == "Central difference")
+      {
+#ifdef OPENIFEM_WITH_CUDA
+        // The first step and the one after a refinement run on the host,
+        // which computes the initial acceleration and the lumped mass.
+        if (!first_step && device_ready)
+          {
+            run_one_device_step();
+          }
+        else
+          {
+            this->run_one_explicit_step(first_step);
+            device_ready = device_supported && setup_device();
+          }
+#else
+        this->run_one_explicit_step(first_step);
+#endif
+        if (time.time_to_refine())
+          {
+            this->refine_mesh(1, 4);
+            this->assemble_lumped_mass();
+#ifdef OPENIFEM_WITH_CUDA
+            device_ready = false;
+#endif
+          }
+        return;
+      }
+
     double gamma = 0.5 + parameters.damping;
     double beta = gamma / 2;
 
@@ -256,6 +395,7 @@ namespace Solid
         this->solve(system_matrix, previous_acceleration, system_rhs);
         // Update the system_matrix
         assemble_system(false);
+        factorized_delta_t = 0;
         this->output_results(time.get_timestep());
       }
 
@@ -281,7 +421,7 @@ namespace Solid
     stiffness_matrix.vmult(tmp3, tmp2);
     tmp1 -= tmp3;
 
-    auto state = this->solve(system_matrix, current_acceleration, tmp1);
+    auto state = solve_effective_system(tmp1);
 
     // update the current velocity
     // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
@@ -316,12 +456,35 @@ namespace Solid
       {
         this->refine_mesh(1, 4);
         assemble_system(false);
+        factorized_delta_t = 0;
       }
   }
 
+  template <int dim>
+  std::pair<unsigned int, double>
+  LinearElasticity<dim>::solve_effective_system(const Vector<double> &rhs)
+  {
+    if (!parameters.solid_factorize_linear_system)
+      {
+        return this->solve(system_matrix, current_acceleration, rhs);
+      }
+
+    TimerOutput::Scope timer_section(timer, "Solve linear system");
+    if (factorized_delta_t != time.get_delta_t())
+      {
+        system_factorization.initialize(system_matrix);
+        factorized_delta_t = time.get_delta_t();
+      }
+    system_factorization.vmult(current_acceleration, rhs);
+    constraints.distribute(current_acceleration);
+
+    return {0, 0.0};
+  }
+
   template <int dim>
   void LinearElasticity<dim>::update_strain_and_stress()
   {
+    OPENIFEM_KERNEL_SCOPE("linear_elasticity_stress");
     for (unsigned int i = 0; i < dim; ++i)
       {
         for (unsigned int j = 0; j < dim; ++j)
@@ -360,7 +523,6 @@ namespace Solid
     FETools::compute_projection_from_quadrature_points_matrix(
       scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
 
-    SymmetricTensor<4, dim> elasticity;
     const FEValuesExtractors::Vector displacements(0);
 
     FEValues<dim> fe_values(fe,
@@ -379,7 +541,7 @@ namespace Solid
         int mat_id = cell->material_id();
         if (parameters.n_solid_parts == 1)
           mat_id = 1;
-        elasticity = material[mat_id - 1].get_elasticity();
+        const LinearElasticMaterial<dim> &cell_material = material[mat_id - 1];
 
         for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
           {
@@ -395,7 +557,7 @@ namespace Solid
                     quad_strain[i][j][q] = tmp_strain[i][j];
                   }
               }
-            tmp_stress = elasticity * tmp_strain;
+            tmp_stress = cell_material.get_stress(tmp_strain);
             for (unsigned int i = 0; i < dim; ++i)
               {
                 for (unsigned int j = 0; j < dim; ++j)
@@ -435,6 +597,105 @@ namespace Solid
       }
   }
 
+#ifdef OPENIFEM_WITH_CUDA
+  template <int dim>
+  bool LinearElasticity<dim>::setup_device()
+  {
+    // The inverse lumped mass is zero at the constrained dofs, which keeps
+    // them at zero only if they are homogeneous Dirichlet dofs.
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      {
+        if (constraints.is_constrained(i) &&
+            (!constraints.get_constraint_entries(i)->empty() ||
+             constraints.get_inhomogeneity(i) != 0))
+          {
+            std::cout << "The constraints are not homogeneous Dirichlet "
+                         "ones, the explicit steps stay on the host."
+                      << std::endl;
+            device_supported = false;
+            return false;
+          }
+      }
+    // The explicit steps do not use the system matrix assembled with K.
+    assemble(false, true);
+    device_stiffness.reinit(cuda_handle, stiffness_matrix);
+    upload(inverse_lumped_mass, device_inverse_mass);
+    upload_external_force();
+    upload(previous_displacement, device_displacement);
+    upload(previous_velocity, device_velocity);
+    upload(previous_acceleration, device_acceleration);
+    device_buffer.reinit(dof_handler.n_dofs());
+    return true;
+  }
+
+  template <int dim>
+  void LinearElasticity<dim>::upload_external_force()
+  {
+    external_force_only = true;
+    assemble_explicit_rhs();
+    external_force_only = false;
+    upload(system_rhs, device_external_force);
+  }
+
+  template <int dim>
+  void LinearElasticity<dim>::download_state()
+  {
+    download(device_displacement, current_displacement);
+    download(device_velocity, current_velocity);
+    download(device_acceleration, current_acceleration);
+    previous_displacement = current_displacement;
+    previous_velocity = current_velocity;
+    previous_acceleration = current_acceleration;
+    update_strain_and_stress();
+  }
+
+  template <int dim>
+  void LinearElasticity<dim>::run_one_device_step()
+  {
+    const double gamma = 0.5 + parameters.damping;
+    const double dt = time.get_delta_t();
+
+    time.increment();
+    std::cout << std::string(91, '*') << std::endl
+              << "Time step = " << time.get_timestep()
+              << ", at t = " << std::scientific << time.current() << std::endl;
+
+    // The FSI and the Neumann tractions may change every step.
+    if (parameters.simulation_type == "FSI" ||
+        !parameters.solid_neumann_bcs.empty())
+      {
+        upload_external_force();
+      }
+
+    {
+      TimerOutput::Scope timer_section(timer, "Device step");
+      // \f$ u_{n+1} = u_n + \Delta{t}v_n + \frac{1}{2}\Delta{t}^2a_n \f$
+      device_displacement.add(dt, device_velocity);
+      device_displacement.add(0.5 * dt * dt, device_acceleration);
+      // \f$ M_La_{n+1} = F - Ku_{n+1} \f$
+      device_stiffness.vmult(device_buffer, device_displacement);
+      device_buffer.sadd(-1.0, 1.0, device_external_force);
+      device_buffer.scale(device_inverse_mass);
+      // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n +
+      // \gamma\Delta{t}a_{n+1} \f$
+      device_velocity.add(dt * (1 - gamma), device_acceleration);
+      device_velocity.add(dt * gamma, device_buffer);
+      device_acceleration.equ(1.0, device_buffer);
+    }
+
+    if (parameters.simulation_type == "FSI" || time.time_to_output() ||
+        time.time_to_refine() || parameters.steady_state_tolerance > 0 ||
+        time.end() - time.current() <= 1e-12)
+      {
+        download_state();
+      }
+    if (time.time_to_output())
+      {
+        this->output_results(time.get_timestep());
+      }
+  }
+#endif
+
   template class LinearElasticity<2>;
   template class LinearElasticity<3>;
 } // namespace Solid
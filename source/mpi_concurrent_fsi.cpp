@@ -0,0 +1,566 @@
+#include "mpi_concurrent_fsi.h"
+#include <iostream>
+
+namespace MPI
+{
+  template <int dim>
+  ConcurrentFSI<dim>::~ConcurrentFSI()
+  {
+    Utils::TimingReport::instance().remove(timer);
+  }
+
+  template <int dim>
+  ConcurrentFSI<dim>::ConcurrentFSI(Fluid::MPI::FluidSolver<dim> *f,
+                                    Solid::MPI::SharedSolidSolver<dim> *s,
+                                    const Parameters::AllParameters &p,
+                                    bool use_dirichlet_bc)
+    : fluid_solver(f),
+      solid_solver(s),
+      parameters(p),
+      mpi_communicator(MPI_COMM_WORLD),
+      pcout(std::cout, Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
+      time(parameters.end_time,
+           parameters.time_step,
+           parameters.output_interval,
+           parameters.refinement_interval,
+           parameters.save_interval),
+      timer(
+        mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+      solid_leader(s && s->this_mpi_process == 0),
+      use_dirichlet_bc(use_dirichlet_bc)
+  {
+    AssertThrow((fluid_solver == nullptr) != (solid_solver == nullptr),
+                ExcMessage("MPI::ConcurrentFSI requires either the fluid or "
+                           "the solid on every process!"));
+    const unsigned int n_solid_processes =
+      parameters.concurrent_solid_processes;
+    const unsigned int this_mpi_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    // The groups must be the ones of Utils::split_communicator.
+    const unsigned int group_size =
+      solid_solver ? Utilities::MPI::n_mpi_processes(
+                       solid_solver->mpi_communicator)
+                   : Utilities::MPI::n_mpi_processes(
+                       fluid_solver->mpi_communicator);
+    AssertThrow(
+      (solid_solver != nullptr) == (this_mpi_process < n_solid_processes) &&
+        group_size ==
+          (solid_solver ? n_solid_processes
+                        : Utilities::MPI::n_mpi_processes(mpi_communicator) -
+                            n_solid_processes),
+      ExcMessage("MPI::ConcurrentFSI requires the solid on the first "
+                 "Concurrent solid processes and the fluid on the rest!"));
+    AssertThrow(parameters.coupling_iterations == 1,
+                ExcMessage("MPI::ConcurrentFSI does not support strong "
+                           "coupling!"));
+    AssertThrow(parameters.refinement_interval >= parameters.end_time,
+                ExcMessage("MPI::ConcurrentFSI does not support mesh "
+                           "refinement!"));
+    AssertThrow(parameters.traction_evaluation == "Vertices",
+                ExcMessage("MPI::ConcurrentFSI only evaluates the traction "
+                           "at the vertices!"));
+
+    // Only the first solid process serves the solid, the others have the
+    // same mesh and would find the same points.
+    if (solid_leader)
+      {
+        solid_evaluator.reset(
+          new Utils::RemotePointEvaluator<dim, Vector<double>>(
+            solid_solver->dof_handler, mpi_communicator));
+      }
+    else
+      {
+        solid_evaluator.reset(
+          new Utils::RemotePointEvaluator<dim, Vector<double>>(
+            dim, mpi_communicator));
+      }
+    if (solid_solver)
+      {
+        solid_solver->time.set_delta_t(parameters.time_step /
+                                       parameters.solid_substeps);
+      }
+    if (fluid_solver)
+      {
+        fluid_evaluator.reset(
+          new Utils::RemotePointEvaluator<dim,
+                                          PETScWrappers::MPI::BlockVector>(
+            fluid_solver->dof_handler, mpi_communicator));
+      }
+    else
+      {
+        fluid_evaluator.reset(
+          new Utils::RemotePointEvaluator<dim,
+                                          PETScWrappers::MPI::BlockVector>(
+            dim + 1, mpi_communicator));
+      }
+    Utils::TimingReport::instance().add(
+      "fsi", timer, mpi_communicator, parameters.timing_report);
+    Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::update_solid_state()
+  {
+    // Localizing is collective over the solid processes.
+    solid_displacement = solid_solver->current_displacement;
+    solid_velocity = solid_solver->current_velocity;
+    solid_acceleration = solid_solver->current_acceleration;
+    const double dt = time.get_delta_t();
+    predicted_displacement = solid_displacement;
+    predicted_displacement.add(
+      dt, solid_velocity, dt * dt / 2, solid_acceleration);
+    predicted_velocity = solid_velocity;
+    predicted_velocity.add(dt, solid_acceleration);
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::move_solid_mesh(bool move_forward)
+  {
+    // Not a timer section, which would synchronize all the processes.
+    if (!solid_leader)
+      {
+        return;
+      }
+    std::vector<bool> vertex_touched(solid_solver->triangulation.n_vertices(),
+                                     false);
+    for (auto cell = solid_solver->dof_handler.begin_active();
+         cell != solid_solver->dof_handler.end();
+         ++cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (vertex_touched[cell->vertex_index(v)])
+              {
+                continue;
+              }
+            vertex_touched[cell->vertex_index(v)] = true;
+            Point<dim> vertex_displacement;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                vertex_displacement[d] =
+                  predicted_displacement(cell->vertex_dof_index(v, d));
+              }
+            if (move_forward)
+              {
+                cell->vertex(v) += vertex_displacement;
+              }
+            else
+              {
+                cell->vertex(v) -= vertex_displacement;
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::update_indicator()
+  {
+    Utils::TimerScope timer_section(timer, "Update indicator");
+    move_solid_mesh(true);
+    // Every vertex of the locally owned fluid cells is located once, the
+    // solid processes have nothing to locate.
+    std::vector<unsigned int> vertex_point;
+    std::vector<Point<dim>> points;
+    if (fluid_solver)
+      {
+        vertex_point.assign(fluid_solver->triangulation.n_vertices(),
+                            numbers::invalid_unsigned_int);
+        for (auto f_cell = fluid_solver->dof_handler.begin_active();
+             f_cell != fluid_solver->dof_handler.end();
+             ++f_cell)
+          {
+            if (!f_cell->is_locally_owned())
+              {
+                continue;
+              }
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                auto &k = vertex_point[f_cell->vertex_index(v)];
+                if (k == numbers::invalid_unsigned_int)
+                  {
+                    k = points.size();
+                    points.push_back(f_cell->vertex(v));
+                  }
+              }
+          }
+      }
+    solid_evaluator->reinit(points);
+    move_solid_mesh(false);
+    if (!fluid_solver)
+      {
+        return;
+      }
+    for (auto f_cell = fluid_solver->dof_handler.begin_active();
+         f_cell != fluid_solver->dof_handler.end();
+         ++f_cell)
+      {
+        if (!f_cell->is_locally_owned())
+          {
+            continue;
+          }
+        bool inside = true;
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (!solid_evaluator->found_cell(
+                  vertex_point[f_cell->vertex_index(v)]))
+              {
+                inside = false;
+                break;
+              }
+          }
+        fluid_solver->cell_property.set_indicator(f_cell, inside ? 1 : 0);
+      }
+    // Only the new artificial fluid cells carry FSI terms.
+    fluid_solver->cell_property.update_band();
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::find_fluid_bc()
+  {
+    Utils::TimerScope timer_section(timer, "Find fluid BC");
+    if (!fluid_solver)
+      {
+        // The solid processes only serve the predicted solid, whose vectors
+        // are not read on the processes without the mesh.
+        move_solid_mesh(true);
+        solid_evaluator->reinit({});
+        std::vector<std::vector<Vector<double>>> solid_values;
+        solid_evaluator->point_values(
+          {&solid_acceleration, &predicted_velocity}, solid_values);
+        move_solid_mesh(false);
+        return;
+      }
+
+    // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
+    // BCs (to set the velocity increment) for the artificial fluid domain.
+    AffineConstraints<double> inner_nonzero, inner_zero;
+    inner_nonzero.reinit(fluid_solver->locally_relevant_dofs);
+    inner_zero.reinit(fluid_solver->locally_relevant_dofs);
+    fsi_acceleration = 0;
+
+    const std::vector<Point<dim>> &unit_points =
+      fluid_solver->fe.get_unit_support_points();
+    const FEValuesExtractors::Vector velocities(0);
+    std::vector<Tensor<2, dim>> grad_v(unit_points.size());
+    std::vector<Tensor<1, dim>> v(unit_points.size());
+    MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
+    Quadrature<dim> dummy_q(unit_points);
+    FEValues<dim> dummy_fe_values(mapping,
+                                  fluid_solver->fe,
+                                  dummy_q,
+                                  update_quadrature_points | update_values |
+                                    update_gradients);
+    std::vector<types::global_dof_index> dof_indices(
+      fluid_solver->fe.dofs_per_cell);
+
+    // Collect the velocity support points on the cell faces, a dof is set by
+    // the first cell that sees it. Together with every point, keep its dof,
+    // its velocity component, and the fluid velocity and convective
+    // acceleration there.
+    std::vector<unsigned char> dof_touched(
+      fluid_solver->locally_relevant_dofs.n_elements(), 0);
+    std::vector<Point<dim>> points;
+    std::vector<types::global_dof_index> lines;
+    std::vector<unsigned int> components;
+    std::vector<double> fluid_vel, convection;
+    for (auto f_cell = fluid_solver->dof_handler.begin_active();
+         f_cell != fluid_solver->dof_handler.end();
+         ++f_cell)
+      {
+        // Ghost cells must be taken care of to set correct Dirichlet BCs.
+        if (f_cell->is_artificial())
+          {
+            continue;
+          }
+        if (!use_dirichlet_bc &&
+            (!f_cell->is_locally_owned() ||
+             fluid_solver->cell_property.indicator(f_cell) == 0))
+          {
+            continue;
+          }
+        f_cell->get_dof_indices(dof_indices);
+        dummy_fe_values.reinit(f_cell);
+        if (!use_dirichlet_bc)
+          {
+            dummy_fe_values[velocities].get_function_values(
+              fluid_solver->present_solution, v);
+            dummy_fe_values[velocities].get_function_gradients(
+              fluid_solver->present_solution, grad_v);
+          }
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            auto &touched = dof_touched[fluid_solver->locally_relevant_dofs
+                                          .index_within_set(dof_indices[i])];
+            // Skip the already-set dofs and the pressure dofs.
+            if (touched != 0 ||
+                fluid_solver->fe.system_to_base_index(i).first.first == 1)
+              {
+                continue;
+              }
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            touched = 1;
+            const unsigned int index =
+              fluid_solver->fe.system_to_component_index(i).first;
+            points.push_back(dummy_fe_values.quadrature_point(i));
+            lines.push_back(dof_indices[i]);
+            components.push_back(index);
+            if (!use_dirichlet_bc)
+              {
+                fluid_vel.push_back(v[i][index]);
+                convection.push_back((grad_v[i] * v[i])[index]);
+              }
+          }
+      }
+
+    // Interpolate the solid acceleration and predicted velocity at all the
+    // points.
+    solid_evaluator->reinit(points);
+    std::vector<std::vector<Vector<double>>> solid_values;
+    solid_evaluator->point_values({&solid_acceleration, &predicted_velocity},
+                                  solid_values);
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        if (!solid_evaluator->found_cell(k))
+          {
+            continue;
+          }
+        const double solid_acc = solid_values[0][k][components[k]];
+        const double solid_vel = solid_values[1][k][components[k]];
+        const auto line = lines[k];
+        if (use_dirichlet_bc)
+          {
+            inner_nonzero.add_line(line);
+            inner_zero.add_line(line);
+            // Note that we are setting the value of the constraint to the
+            // velocity delta!
+            inner_nonzero.set_inhomogeneity(
+              line, solid_vel - fluid_solver->present_solution(line));
+          }
+        else
+          {
+            // Fluid total acceleration at support points
+            const double fluid_acc =
+              (solid_vel - fluid_vel[k]) / time.get_delta_t() + convection[k];
+            fsi_acceleration(line) = fluid_acc - solid_acc;
+          }
+      }
+    fsi_acceleration.compress(VectorOperation::insert);
+    fluid_solver->fsi_acceleration = fsi_acceleration;
+    if (use_dirichlet_bc)
+      {
+        inner_nonzero.close();
+        inner_zero.close();
+        fluid_solver->nonzero_constraints.merge(
+          inner_nonzero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+        fluid_solver->zero_constraints.merge(
+          inner_zero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+      }
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::find_solid_bc()
+  {
+    Utils::TimerScope timer_section(timer, "Find solid BC");
+    // The boundary vertices of the current solid, and the dofs of their
+    // first components, on the first solid process.
+    std::vector<Point<dim>> points;
+    std::vector<types::global_dof_index> lines;
+    if (solid_leader)
+      {
+        std::vector<bool> vertex_touched(
+          solid_solver->triangulation.n_vertices(), false);
+        for (auto s_cell = solid_solver->dof_handler.begin_active();
+             s_cell != solid_solver->dof_handler.end();
+             ++s_cell)
+          {
+            for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                 ++f)
+              {
+                if (!s_cell->face(f)->at_boundary())
+                  {
+                    continue;
+                  }
+                for (unsigned int v = 0;
+                     v < GeometryInfo<dim>::vertices_per_face;
+                     ++v)
+                  {
+                    if (vertex_touched[s_cell->face(f)->vertex_index(v)])
+                      {
+                        continue;
+                      }
+                    vertex_touched[s_cell->face(f)->vertex_index(v)] = true;
+                    const auto line = s_cell->face(f)->vertex_dof_index(v, 0);
+                    Point<dim> point = s_cell->face(f)->vertex(v);
+                    for (unsigned int d = 0; d < dim; ++d)
+                      {
+                        point[d] += solid_displacement(line + d);
+                      }
+                    lines.push_back(line);
+                    points.push_back(point);
+                  }
+              }
+          }
+      }
+
+    // Get interpolated solution from the fluid, whose solution is not read
+    // on the solid processes.
+    const PETScWrappers::MPI::BlockVector *fluid_solution =
+      fluid_solver ? &fluid_solver->present_solution : nullptr;
+    fluid_evaluator->reinit(points, update_values | update_gradients);
+    std::vector<std::vector<Vector<double>>> values;
+    fluid_evaluator->point_values({fluid_solution}, values);
+    std::vector<std::vector<Tensor<1, dim>>> gradients;
+    fluid_evaluator->point_gradients(fluid_solution, gradients);
+    if (!solid_solver)
+      {
+        return;
+      }
+
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        solid_solver->fsi_stress_rows[d] = 0;
+      }
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        // The stress is zero outside the fluid.
+        if (!fluid_evaluator->found_cell(k))
+          {
+            continue;
+          }
+        SymmetricTensor<2, dim> sym_deformation;
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            for (unsigned int j = 0; j < dim; ++j)
+              {
+                sym_deformation[i][j] =
+                  (gradients[k][i][j] + gradients[k][j][i]) / 2;
+              }
+          }
+        // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+        SymmetricTensor<2, dim> stress =
+          -values[0][k][dim] * Physics::Elasticity::StandardTensors<dim>::I +
+          2 * parameters.viscosity * sym_deformation;
+        for (unsigned int d1 = 0; d1 < dim; ++d1)
+          {
+            for (unsigned int d2 = 0; d2 < dim; ++d2)
+              {
+                solid_solver->fsi_stress_rows[d1][lines[k] + d2] =
+                  stress[d1][d2];
+              }
+          }
+      }
+    // Every solid process reads the whole vectors of the first one.
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        const int ierr = MPI_Bcast(solid_solver->fsi_stress_rows[d].begin(),
+                                   solid_solver->fsi_stress_rows[d].size(),
+                                   MPI_DOUBLE,
+                                   0,
+                                   solid_solver->mpi_communicator);
+        AssertThrowMPI(ierr);
+      }
+  }
+
+  template <int dim>
+  void ConcurrentFSI<dim>::run()
+  {
+    pcout << "Running with PETSc on "
+          << Utils::parallel_configuration(mpi_communicator) << ", "
+          << parameters.concurrent_solid_processes
+          << " of which solve the solid..." << std::endl;
+
+    // Each group sets up its own solver.
+    unsigned int n_fluid_cells = 0, n_fluid_dofs = 0;
+    unsigned int n_solid_cells = 0, n_solid_dofs = 0;
+    if (solid_solver)
+      {
+        Utils::refine_global_cached(solid_solver->triangulation,
+                                    parameters.global_refinements[1],
+                                    parameters.mesh_cache);
+        solid_solver->setup_dofs();
+        solid_solver->initialize_system();
+        n_solid_cells = solid_solver->triangulation.n_active_cells();
+        n_solid_dofs = solid_solver->dof_handler.n_dofs();
+      }
+    else
+      {
+        Utils::refine_global_cached(fluid_solver->triangulation,
+                                    parameters.global_refinements[0],
+                                    parameters.mesh_cache);
+        fluid_solver->setup_dofs();
+        fluid_solver->make_constraints();
+        fluid_solver->initialize_system();
+        fsi_acceleration.reinit(fluid_solver->owned_partitioning,
+                                fluid_solver->mpi_communicator);
+        n_fluid_cells = fluid_solver->triangulation.n_global_active_cells();
+        n_fluid_dofs = fluid_solver->dof_handler.n_dofs();
+      }
+
+    pcout << "Number of fluid active cells and dofs: ["
+          << Utilities::MPI::max(n_fluid_cells, mpi_communicator) << ", "
+          << Utilities::MPI::max(n_fluid_dofs, mpi_communicator) << "]"
+          << std::endl
+          << "Number of solid active cells and dofs: ["
+          << Utilities::MPI::max(n_solid_cells, mpi_communicator) << ", "
+          << Utilities::MPI::max(n_solid_dofs, mpi_communicator) << "]"
+          << std::endl;
+
+    bool first_step = true;
+    Utils::StartupProfile::instance().begin_steps();
+    while (time.end() - time.current() > 1e-12)
+      {
+        Utils::TraceScope step_trace(
+          "Time step " + std::to_string(time.get_timestep() + 1), "fsi");
+        // The exchange of the interface data, collective over all the
+        // processes.
+        if (solid_solver)
+          {
+            update_solid_state();
+          }
+        find_solid_bc();
+        update_indicator();
+        if (fluid_solver)
+          {
+            fluid_solver->restore_constraints(first_step);
+          }
+        find_fluid_bc();
+        {
+          // The groups do not communicate until the next exchange, so the
+          // solid and the fluid are solved at the same time.
+          Utils::TimerScope timer_section(timer, "Run solvers");
+          if (solid_solver)
+            {
+              // The solid is sub-cycled with the fluid traction held.
+              for (unsigned int n = 0; n < parameters.solid_substeps; ++n)
+                {
+                  solid_solver->run_one_step(first_step && n == 0);
+                }
+            }
+          else
+            {
+              fluid_solver->run_one_step(true);
+            }
+        }
+        first_step = false;
+        time.increment();
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
+      }
+    Utils::Tracer::instance().write(mpi_communicator);
+  }
+
+  template class ConcurrentFSI<2>;
+  template class ConcurrentFSI<3>;
+} // namespace MPI
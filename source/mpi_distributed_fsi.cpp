@@ -0,0 +1,431 @@
+#include "mpi_distributed_fsi.h"
+#include <iostream>
+
+namespace MPI
+{
+  template <int dim>
+  DistributedFSI<dim>::~DistributedFSI()
+  {
+    Utils::TimingReport::instance().remove(timer);
+  }
+
+  template <int dim>
+  DistributedFSI<dim>::DistributedFSI(Fluid::MPI::FluidSolver<dim> &f,
+                                      Solid::MPI::SolidSolver<dim> &s,
+                                      const Parameters::AllParameters &p,
+                                      bool use_dirichlet_bc)
+    : fluid_solver(f),
+      solid_solver(s),
+      parameters(p),
+      mpi_communicator(fluid_solver.mpi_communicator),
+      pcout(std::cout, Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
+      time(parameters.end_time,
+           parameters.time_step,
+           parameters.output_interval,
+           parameters.refinement_interval,
+           parameters.save_interval),
+      timer(
+        mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+      fluid_evaluator(fluid_solver.dof_handler, mpi_communicator),
+      solid_evaluator(solid_solver.dof_handler, mpi_communicator),
+      use_dirichlet_bc(use_dirichlet_bc)
+  {
+    // A point is located on every process of the other mesh, so both meshes
+    // must be distributed over the same processes in the same order.
+    int result;
+    MPI_Comm_compare(mpi_communicator, solid_solver.mpi_communicator, &result);
+    AssertThrow(result == MPI_IDENT || result == MPI_CONGRUENT,
+                ExcMessage("MPI::DistributedFSI requires the fluid and the "
+                           "solid to run on the same processes!"));
+    AssertThrow(parameters.coupling_iterations == 1,
+                ExcMessage("MPI::DistributedFSI does not support strong "
+                           "coupling!"));
+    AssertThrow(parameters.refinement_interval >= parameters.end_time,
+                ExcMessage("MPI::DistributedFSI does not support mesh "
+                           "refinement!"));
+    solid_solver.time.set_delta_t(parameters.time_step /
+                                  parameters.solid_substeps);
+    Utils::TimingReport::instance().add(
+      "fsi", timer, mpi_communicator, parameters.timing_report);
+    Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::move_solid_mesh(bool move_forward)
+  {
+    Utils::TimerScope timer_section(timer, "Move solid mesh");
+    // The ghost cells are moved too so that every process sees the same
+    // vertices on the partition boundaries. Their dofs are locally relevant.
+    std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
+                                     false);
+    for (auto cell = solid_solver.dof_handler.begin_active();
+         cell != solid_solver.dof_handler.end();
+         ++cell)
+      {
+        if (cell->is_artificial())
+          {
+            continue;
+          }
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (vertex_touched[cell->vertex_index(v)])
+              {
+                continue;
+              }
+            vertex_touched[cell->vertex_index(v)] = true;
+            Point<dim> vertex_displacement;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                vertex_displacement[d] =
+                  solid_displacement(cell->vertex_dof_index(v, d));
+              }
+            if (move_forward)
+              {
+                cell->vertex(v) += vertex_displacement;
+              }
+            else
+              {
+                cell->vertex(v) -= vertex_displacement;
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::update_solid_state()
+  {
+    solid_displacement = solid_solver.current_displacement;
+    solid_velocity = solid_solver.current_velocity;
+    solid_acceleration = solid_solver.current_acceleration;
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::update_indicator()
+  {
+    Utils::TimerScope timer_section(timer, "Update indicator");
+    move_solid_mesh(true);
+    // Every vertex of the locally owned fluid cells is located once.
+    std::vector<unsigned int> vertex_point(
+      fluid_solver.triangulation.n_vertices(), numbers::invalid_unsigned_int);
+    std::vector<Point<dim>> points;
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        if (!f_cell->is_locally_owned())
+          {
+            continue;
+          }
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            auto &k = vertex_point[f_cell->vertex_index(v)];
+            if (k == numbers::invalid_unsigned_int)
+              {
+                k = points.size();
+                points.push_back(f_cell->vertex(v));
+              }
+          }
+      }
+    solid_evaluator.reinit(points);
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        if (!f_cell->is_locally_owned())
+          {
+            continue;
+          }
+        bool inside = true;
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (!solid_evaluator.found_cell(
+                  vertex_point[f_cell->vertex_index(v)]))
+              {
+                inside = false;
+                break;
+              }
+          }
+        fluid_solver.cell_property.set_indicator(f_cell, inside ? 1 : 0);
+      }
+    // Only the new artificial fluid cells carry FSI terms.
+    fluid_solver.cell_property.update_band();
+    move_solid_mesh(false);
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::find_fluid_bc()
+  {
+    Utils::TimerScope timer_section(timer, "Find fluid BC");
+    move_solid_mesh(true);
+
+    // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
+    // BCs (to set the velocity increment) for the artificial fluid domain.
+    AffineConstraints<double> inner_nonzero, inner_zero;
+    inner_nonzero.reinit(fluid_solver.locally_relevant_dofs);
+    inner_zero.reinit(fluid_solver.locally_relevant_dofs);
+    fsi_acceleration = 0;
+
+    const std::vector<Point<dim>> &unit_points =
+      fluid_solver.fe.get_unit_support_points();
+    const FEValuesExtractors::Vector velocities(0);
+    std::vector<Tensor<2, dim>> grad_v(unit_points.size());
+    std::vector<Tensor<1, dim>> v(unit_points.size());
+    MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
+    Quadrature<dim> dummy_q(unit_points);
+    FEValues<dim> dummy_fe_values(mapping,
+                                  fluid_solver.fe,
+                                  dummy_q,
+                                  update_quadrature_points | update_values |
+                                    update_gradients);
+    std::vector<types::global_dof_index> dof_indices(
+      fluid_solver.fe.dofs_per_cell);
+
+    // Collect the velocity support points on the cell faces, a dof is set by
+    // the first cell that sees it. Together with every point, keep its dof,
+    // its velocity component, and the fluid velocity and convective
+    // acceleration there.
+    std::vector<unsigned char> dof_touched(
+      fluid_solver.locally_relevant_dofs.n_elements(), 0);
+    std::vector<Point<dim>> points;
+    std::vector<types::global_dof_index> lines;
+    std::vector<unsigned int> components;
+    std::vector<double> fluid_vel, convection;
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        // Ghost cells must be taken care of to set correct Dirichlet BCs.
+        if (f_cell->is_artificial())
+          {
+            continue;
+          }
+        if (!use_dirichlet_bc &&
+            (!f_cell->is_locally_owned() ||
+             fluid_solver.cell_property.indicator(f_cell) == 0))
+          {
+            continue;
+          }
+        f_cell->get_dof_indices(dof_indices);
+        dummy_fe_values.reinit(f_cell);
+        if (!use_dirichlet_bc)
+          {
+            dummy_fe_values[velocities].get_function_values(
+              fluid_solver.present_solution, v);
+            dummy_fe_values[velocities].get_function_gradients(
+              fluid_solver.present_solution, grad_v);
+          }
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            auto &touched = dof_touched[fluid_solver.locally_relevant_dofs
+                                          .index_within_set(dof_indices[i])];
+            // Skip the already-set dofs and the pressure dofs.
+            if (touched != 0 ||
+                fluid_solver.fe.system_to_base_index(i).first.first == 1)
+              {
+                continue;
+              }
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            touched = 1;
+            const unsigned int index =
+              fluid_solver.fe.system_to_component_index(i).first;
+            points.push_back(dummy_fe_values.quadrature_point(i));
+            lines.push_back(dof_indices[i]);
+            components.push_back(index);
+            if (!use_dirichlet_bc)
+              {
+                fluid_vel.push_back(v[i][index]);
+                convection.push_back((grad_v[i] * v[i])[index]);
+              }
+          }
+      }
+
+    // Interpolate the solid acceleration and velocity at all the points.
+    solid_evaluator.reinit(points);
+    std::vector<std::vector<Vector<double>>> solid_values;
+    solid_evaluator.point_values({&solid_acceleration, &solid_velocity},
+                                 solid_values);
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        if (!solid_evaluator.found_cell(k))
+          {
+            continue;
+          }
+        const double solid_acc = solid_values[0][k][components[k]];
+        const double solid_vel = solid_values[1][k][components[k]];
+        const auto line = lines[k];
+        if (use_dirichlet_bc)
+          {
+            inner_nonzero.add_line(line);
+            inner_zero.add_line(line);
+            // Note that we are setting the value of the constraint to the
+            // velocity delta!
+            inner_nonzero.set_inhomogeneity(
+              line, solid_vel - fluid_solver.present_solution(line));
+          }
+        else
+          {
+            // Fluid total acceleration at support points
+            const double fluid_acc =
+              (solid_vel - fluid_vel[k]) / time.get_delta_t() + convection[k];
+            fsi_acceleration(line) = fluid_acc - solid_acc;
+          }
+      }
+    fsi_acceleration.compress(VectorOperation::insert);
+    fluid_solver.fsi_acceleration = fsi_acceleration;
+    if (use_dirichlet_bc)
+      {
+        inner_nonzero.close();
+        inner_zero.close();
+        fluid_solver.nonzero_constraints.merge(
+          inner_nonzero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+        fluid_solver.zero_constraints.merge(
+          inner_zero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+      }
+    move_solid_mesh(false);
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::find_solid_bc()
+  {
+    Utils::TimerScope timer_section(timer, "Find solid BC");
+    // Must use the updated solid coordinates
+    move_solid_mesh(true);
+    FEFaceValues<dim> fe_face_values(solid_solver.fe,
+                                     solid_solver.face_quad_formula,
+                                     update_quadrature_points |
+                                       update_normal_vectors |
+                                       update_JxW_values);
+    // The points in the order of fsi_traction, and the normal vectors scaled
+    // by the area elements.
+    std::vector<Point<dim>> points;
+    std::vector<Tensor<1, dim>> normals;
+    for (auto s_cell = solid_solver.dof_handler.begin_active();
+         s_cell != solid_solver.dof_handler.end();
+         ++s_cell)
+      {
+        if (!s_cell->is_locally_owned())
+          {
+            continue;
+          }
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (!s_cell->face(f)->at_boundary())
+              {
+                continue;
+              }
+            fe_face_values.reinit(s_cell, f);
+            for (unsigned int q = 0; q < fe_face_values.n_quadrature_points;
+                 ++q)
+              {
+                points.push_back(fe_face_values.quadrature_point(q));
+                normals.push_back(fe_face_values.normal_vector(q) *
+                                  fe_face_values.JxW(q));
+              }
+          }
+      }
+    AssertDimension(points.size(), solid_solver.fsi_traction.size());
+
+    // Get interpolated solution from the fluid
+    fluid_evaluator.reinit(points, update_values | update_gradients);
+    std::vector<std::vector<Vector<double>>> values;
+    fluid_evaluator.point_values({&fluid_solver.present_solution}, values);
+    std::vector<std::vector<Tensor<1, dim>>> gradients;
+    fluid_evaluator.point_gradients(&fluid_solver.present_solution, gradients);
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        SymmetricTensor<2, dim> sym_deformation;
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            for (unsigned int j = 0; j < dim; ++j)
+              {
+                sym_deformation[i][j] =
+                  (gradients[k][i][j] + gradients[k][j][i]) / 2;
+              }
+          }
+        // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+        SymmetricTensor<2, dim> stress =
+          -values[0][k][dim] * Physics::Elasticity::StandardTensors<dim>::I +
+          2 * parameters.viscosity * sym_deformation;
+        solid_solver.fsi_traction[k] = stress * normals[k];
+      }
+    move_solid_mesh(false);
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::run()
+  {
+    pcout << "Running with PETSc on "
+          << Utils::parallel_configuration(mpi_communicator) << "..."
+          << std::endl;
+
+    Utils::refine_global_cached(solid_solver.triangulation,
+                                parameters.global_refinements[1],
+                                parameters.mesh_cache);
+    solid_solver.setup_dofs();
+    solid_solver.initialize_system();
+    Utils::refine_global_cached(fluid_solver.triangulation,
+                                parameters.global_refinements[0],
+                                parameters.mesh_cache);
+    fluid_solver.setup_dofs();
+    fluid_solver.make_constraints();
+    fluid_solver.initialize_system();
+
+    solid_displacement.reinit(solid_solver.locally_owned_dofs,
+                              solid_solver.locally_relevant_dofs,
+                              mpi_communicator);
+    solid_velocity.reinit(solid_displacement);
+    solid_acceleration.reinit(solid_displacement);
+    fsi_acceleration.reinit(fluid_solver.owned_partitioning, mpi_communicator);
+
+    pcout << "Number of fluid active cells and dofs: ["
+          << fluid_solver.triangulation.n_global_active_cells() << ", "
+          << fluid_solver.dof_handler.n_dofs() << "]" << std::endl
+          << "Number of solid active cells and dofs: ["
+          << solid_solver.triangulation.n_global_active_cells() << ", "
+          << solid_solver.dof_handler.n_dofs() << "]" << std::endl;
+
+    bool first_step = true;
+    Utils::StartupProfile::instance().begin_steps();
+    while (time.end() - time.current() > 1e-12)
+      {
+        Utils::TraceScope step_trace(
+          "Time step " + std::to_string(time.get_timestep() + 1), "fsi");
+        find_solid_bc();
+        {
+          Utils::TimerScope timer_section(timer, "Run solid solver");
+          // The solid is sub-cycled with the fluid traction held.
+          for (unsigned int n = 0; n < parameters.solid_substeps; ++n)
+            {
+              solid_solver.run_one_step(first_step && n == 0);
+            }
+        }
+        update_solid_state();
+        update_indicator();
+        fluid_solver.restore_constraints(first_step);
+        find_fluid_bc();
+        {
+          Utils::TimerScope timer_section(timer, "Run fluid solver");
+          fluid_solver.run_one_step(true);
+        }
+        first_step = false;
+        time.increment();
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
+      }
+    Utils::Tracer::instance().write(mpi_communicator);
+  }
+
+  template class DistributedFSI<2>;
+  template class DistributedFSI<3>;
+} // namespace MPI
@@ -7,8 +7,8 @@ namespace Fluid
     template <int dim>
     FluidSolver<dim>::~FluidSolver()
     {
-      timer.print_summary();
-      timer2.print_summary();
+      Utils::TimingReport::instance().remove(timer);
+      Utils::TimingReport::instance().remove(timer2);
     }
 
     template <int dim>
@@ -18,6 +18,42 @@ namespace Fluid
       return present_solution;
     }
 
+    template <int dim>
+    void FluidSolver<dim>::print_memory_usage() const
+    {
+      Utils::MemoryReport report("Fluid", mpi_communicator);
+      add_memory_usage(report);
+      report.print(std::cout);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::add_memory_usage(Utils::MemoryReport &report) const
+    {
+      report.add("fluid triangulation", triangulation.memory_consumption());
+      report.add("fluid dof handlers",
+                 dof_handler.memory_consumption() +
+                   scalar_dof_handler.memory_consumption());
+      report.add("fluid constraints",
+                 zero_constraints.memory_consumption() +
+                   nonzero_constraints.memory_consumption() +
+                   mesh_zero_constraints.memory_consumption() +
+                   mesh_nonzero_constraints.memory_consumption());
+      report.add("fluid system matrix", system_matrix.memory_consumption());
+      report.add("fluid mass matrices",
+                 mass_matrix.memory_consumption() +
+                   mass_schur.memory_consumption());
+      report.add("fluid vectors",
+                 present_solution.memory_consumption() +
+                   solution_increment.memory_consumption() +
+                   system_rhs.memory_consumption() +
+                   fsi_acceleration.memory_consumption() +
+                   previous_solution.memory_consumption() +
+                   bdf2_history.memory_consumption());
+      report.add("fluid stress", MemoryConsumption::memory_consumption(stress));
+      report.add("fluid cell property", cell_property.memory_consumption());
+      report.add("fluid FE data cache", cell_fe_data.memory_consumption());
+    }
+
     template <int dim>
     FluidSolver<dim>::FluidSolver(
       parallel::distributed::Triangulation<dim> &tria,
@@ -34,7 +70,7 @@ namespace Fluid
         volume_quad_formula(parameters.fluid_velocity_degree + 1),
         face_quad_formula(parameters.fluid_velocity_degree + 1),
         parameters(parameters),
-        mpi_communicator(MPI_COMM_WORLD),
+        mpi_communicator(tria.get_communicator()),
         pcout(std::cout,
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
         time(parameters.end_time,
@@ -46,21 +82,60 @@ namespace Fluid
           mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
         timer2(
           mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        preconditioner_reuse(parameters.preconditioner_max_age,
+                             parameters.preconditioner_max_iterations,
+                             parameters.preconditioner_rebuild_threshold),
+        cell_fe_data(fe, volume_quad_formula),
+        time_step_controller(parameters.target_cfl,
+                             parameters.time_step_shrink,
+                             parameters.time_step_growth,
+                             parameters.min_time_step,
+                             parameters.max_time_step,
+                             parameters.target_newton_iterations),
+        forcing_term(parameters.fluid_min_forcing_term,
+                     parameters.fluid_max_forcing_term,
+                     parameters.fluid_tolerance),
+        solution_predictor(parameters.fluid_predictor_order),
+        checkpoint_index("fluid"),
+        buddy_checkpoint("fluid",
+                         parameters.buddy_checkpoint_directory,
+                         mpi_communicator),
+        pending_checkpoint(-1),
+        complete_checkpoint(-1),
+        xdmf_output("fluid", parameters.output_mesh_once),
+        pvd_record("fluid.pvd"),
+        output_control(parameters),
+        output_writer(parameters.output_queue_depth),
+        steady_state(parameters.steady_state_tolerance,
+                     parameters.steady_state_steps),
+        monitor_file("fluid_monitor.csv", mpi_communicator),
+        solver_log(
+          "fluid_solver_log.csv", mpi_communicator, parameters.solver_log),
         boundary_values(bc)
     {
+      Utils::TimingReport::instance().add(
+        "fluid", timer, mpi_communicator, parameters.timing_report);
+      Utils::TimingReport::instance().add("fluid-preconditioner",
+                                          timer2,
+                                          mpi_communicator,
+                                          parameters.timing_report);
+      Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
     }
 
     template <int dim>
     void FluidSolver<dim>::setup_dofs()
     {
+      Utils::StartupScope startup("fluid setup_dofs");
       // The first step is to associate DoFs with a given mesh.
       dof_handler.distribute_dofs(fe);
+      xdmf_output.invalidate_mesh();
+      probe_evaluator.reset();
       scalar_dof_handler.distribute_dofs(scalar_fe);
 
       // We renumber the components to have all velocity DoFs come before
       // the pressure DoFs to be able to split the solution vector in two blocks
       // which are separately accessed in the block preconditioner.
-      DoFRenumbering::Cuthill_McKee(dof_handler);
+      Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
       std::vector<unsigned int> block_component(dim + 1, 0);
       block_component[dim] = 1;
       DoFRenumbering::component_wise(dof_handler, block_component);
@@ -93,6 +168,25 @@ namespace Fluid
       DoFTools::extract_locally_relevant_dofs(scalar_dof_handler,
                                               locally_relevant_scalar_dofs);
 
+      interior_cells.clear();
+      ghost_touching_cells.clear();
+      const IndexSet &locally_owned_dofs = dof_handler.locally_owned_dofs();
+      std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            continue;
+          cell->get_dof_indices(dof_indices);
+          const bool interior = std::all_of(
+            dof_indices.begin(),
+            dof_indices.end(),
+            [&](const types::global_dof_index i) {
+              return locally_owned_dofs.is_element(i);
+            });
+          (interior ? interior_cells : ghost_touching_cells).push_back(cell);
+        }
+
       pcout << "   Number of active fluid cells: "
             << triangulation.n_global_active_cells() << std::endl
             << "   Number of degrees of freedom: " << dof_handler.n_dofs()
@@ -102,6 +196,7 @@ namespace Fluid
     template <int dim>
     void FluidSolver<dim>::make_constraints()
     {
+      Utils::StartupScope startup("fluid make_constraints");
       // In Newton's scheme, we first apply the boundary condition on the
       // solution obtained from the initial step. To make sure the boundary
       // conditions remain satisfied during Newton's iteration, zero boundary
@@ -113,13 +208,14 @@ namespace Fluid
       // the input file. If time or space dependent Dirichlet BCs are
       // desired, they must be implemented in BoundaryValues.
       {
-        nonzero_constraints.clear();
-        zero_constraints.clear();
-        nonzero_constraints.reinit(locally_relevant_dofs);
-        zero_constraints.reinit(locally_relevant_dofs);
+        mesh_nonzero_constraints.clear();
+        mesh_zero_constraints.clear();
+        mesh_nonzero_constraints.reinit(locally_relevant_dofs);
+        mesh_zero_constraints.reinit(locally_relevant_dofs);
+        DoFTools::make_hanging_node_constraints(dof_handler,
+                                                mesh_nonzero_constraints);
         DoFTools::make_hanging_node_constraints(dof_handler,
-                                                nonzero_constraints);
-        DoFTools::make_hanging_node_constraints(dof_handler, zero_constraints);
+                                                mesh_zero_constraints);
         for (auto itr = parameters.fluid_dirichlet_bcs.begin();
              itr != parameters.fluid_dirichlet_bcs.end();
              ++itr)
@@ -186,7 +282,7 @@ namespace Fluid
                   dof_handler,
                   id,
                   *boundary_values,
-                  nonzero_constraints,
+                  mesh_nonzero_constraints,
                   ComponentMask(mask));
               }
             else
@@ -196,7 +292,7 @@ namespace Fluid
                   dof_handler,
                   id,
                   Functions::ConstantFunction<dim>(augmented_value),
-                  nonzero_constraints,
+                  mesh_nonzero_constraints,
                   ComponentMask(mask));
               }
             VectorTools::interpolate_boundary_values(
@@ -204,60 +300,124 @@ namespace Fluid
               dof_handler,
               id,
               Functions::ZeroFunction<dim>(dim + 1),
-              zero_constraints,
+              mesh_zero_constraints,
               ComponentMask(mask));
           }
       }
-      nonzero_constraints.close();
-      zero_constraints.close();
+      mesh_nonzero_constraints.close();
+      mesh_zero_constraints.close();
+      restore_constraints(true);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::restore_constraints(
+      const bool use_nonzero_constraints)
+    {
+      zero_constraints.clear();
+      zero_constraints.copy_from(mesh_zero_constraints);
+      nonzero_constraints.clear();
+      nonzero_constraints.copy_from(use_nonzero_constraints
+                                      ? mesh_nonzero_constraints
+                                      : mesh_zero_constraints);
     }
 
     template <int dim>
     void FluidSolver<dim>::setup_cell_property()
     {
       pcout << "   Setting up cell property..." << std::endl;
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
+      cell_property.reinit(triangulation.n_active_cells());
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::CellPropertyStorage::reinit(
+      const unsigned int n_active_cells)
+    {
+      indicators.assign(n_active_cells, 0);
+      band_cells.clear();
+      band_data.clear();
+      zero_property.fsi_acceleration = 0;
+      zero_property.fsi_stress = 0;
+      zero_property.material_id = 1;
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::CellPropertyStorage::update_band()
+    {
+      std::vector<unsigned int> new_cells;
+      std::vector<CellProperty> new_data;
+      // Both lists are sorted, so the terms of the cells that stay in the
+      // band are found by merging them.
+      unsigned int k = 0;
+      for (unsigned int i = 0; i < indicators.size(); ++i)
         {
-          if (cell->is_locally_owned())
-            {
-              cell_property.initialize(cell, 1);
-              const std::vector<std::shared_ptr<CellProperty>> p =
-                cell_property.get_data(cell);
-              p[0]->indicator = 0;
-              p[0]->fsi_acceleration = 0;
-              p[0]->fsi_stress = 0;
-              p[0]->material_id = 1;
-            }
+          if (indicators[i] != 1)
+            continue;
+          while (k < band_cells.size() && band_cells[k] < i)
+            ++k;
+          new_cells.push_back(i);
+          new_data.push_back(k < band_cells.size() && band_cells[k] == i
+                               ? band_data[k]
+                               : zero_property);
         }
+      band_cells.swap(new_cells);
+      band_data.swap(new_data);
+    }
+
+    template <int dim>
+    unsigned int FluidSolver<dim>::CellPropertyStorage::band_index(
+      const unsigned int cell_index) const
+    {
+      // Most cells are real fluid, which is told by the indicator alone.
+      if (indicators[cell_index] != 1)
+        return numbers::invalid_unsigned_int;
+      auto it =
+        std::lower_bound(band_cells.begin(), band_cells.end(), cell_index);
+      if (it == band_cells.end() || *it != cell_index)
+        return numbers::invalid_unsigned_int;
+      return it - band_cells.begin();
+    }
+
+    template <int dim>
+    std::size_t
+    FluidSolver<dim>::CellPropertyStorage::memory_consumption() const
+    {
+      return MemoryConsumption::memory_consumption(indicators) +
+             MemoryConsumption::memory_consumption(band_cells) +
+             band_data.capacity() * sizeof(CellProperty);
     }
 
     template <int dim>
     void FluidSolver<dim>::initialize_system()
     {
+      Utils::StartupScope startup("fluid initialize_system");
       system_matrix.clear();
       mass_matrix.clear();
       mass_schur.clear();
 
-      BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
-      DoFTools::make_sparsity_pattern(dof_handler, dsp, nonzero_constraints);
-      sparsity_pattern.copy_from(dsp);
-      SparsityTools::distribute_sparsity_pattern(
-        dsp,
-        dof_handler.locally_owned_dofs_per_processor(),
-        mpi_communicator,
-        locally_relevant_dofs);
+      {
+        Utils::StartupScope sparsity_section("fluid sparsity");
+        BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
+        DoFTools::make_sparsity_pattern(dof_handler, dsp, nonzero_constraints);
+
+        // Compute the sparsity pattern for mass schur in advance.
+        // The only nonzero block is (1, 1), which is the same as \f$BB^T\f$.
+        // It is computed from the local rows directly, compressing them first
+        // would allocate row offsets for all the dofs on every process.
+        BlockDynamicSparsityPattern schur_dsp(dofs_per_block, dofs_per_block);
+        schur_dsp.block(1, 1).compute_mmult_pattern(dsp.block(1, 0),
+                                                    dsp.block(0, 1));
 
-      system_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
-      mass_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
+        SparsityTools::distribute_sparsity_pattern(
+          dsp,
+          dof_handler.locally_owned_dofs_per_processor(),
+          mpi_communicator,
+          locally_relevant_dofs);
 
-      // Compute the sparsity pattern for mass schur in advance.
-      // The only nonzero block is (1, 1), which is the same as \f$BB^T\f$.
-      BlockDynamicSparsityPattern schur_dsp(dofs_per_block, dofs_per_block);
-      schur_dsp.block(1, 1).compute_mmult_pattern(sparsity_pattern.block(1, 0),
-                                                  sparsity_pattern.block(0, 1));
-      mass_schur.reinit(owned_partitioning, schur_dsp, mpi_communicator);
+        system_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
+        mass_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
+        mass_schur.reinit(owned_partitioning, schur_dsp, mpi_communicator);
+      }
+      mass_schur_outdated = true;
 
       // present_solution is ghosted because it is used in the
       // output and mesh refinement functions.
@@ -270,35 +430,147 @@ namespace Fluid
       // system_rhs is non-ghosted because it is only used in the linear
       // solver and residual evaluation.
       system_rhs.reinit(owned_partitioning, mpi_communicator);
+      // The previous solution is lost unless it is transferred.
+      previous_delta_t = 0;
+      if (parameters.fluid_time_integration == "BDF2")
+        {
+          previous_solution.reinit(
+            owned_partitioning, relevant_partitioning, mpi_communicator);
+          bdf2_history.reinit(
+            owned_partitioning, relevant_partitioning, mpi_communicator);
+        }
 
       // Cell property
       setup_cell_property();
 
-      stress = std::vector<std::vector<PETScWrappers::MPI::Vector>>(
-        dim,
-        std::vector<PETScWrappers::MPI::Vector>(
-          dim,
-          PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
-                                     mpi_communicator)));
+      // The mesh or the dofs have changed, so must the cached FE data, and the
+      // recorded solutions no longer match.
+      solution_predictor.clear();
+      if (parameters.fluid_cache_fe_data)
+        {
+          cell_fe_data.reinit(dof_handler);
+        }
+      else
+        {
+          cell_fe_data.clear();
+        }
+
+      // Computed again for the new mesh when it is written.
+      stress.clear();
+    }
+
+    template <int dim>
+    bool FluidSolver<dim>::update_mass_schur()
+    {
+      IndexSet constrained_dofs(dof_handler.n_dofs());
+      for (const auto i : locally_relevant_dofs)
+        {
+          if (zero_constraints.is_constrained(i))
+            {
+              constrained_dofs.add_index(i);
+            }
+        }
+      const bool outdated =
+        Utilities::MPI::max(
+          static_cast<unsigned int>(mass_schur_outdated ||
+                                    constrained_dofs != mass_schur_constraints),
+          mpi_communicator) == 1;
+      if (!outdated)
+        {
+          return false;
+        }
+      Utils::TimerScope timer_section(timer2, "Mass Schur complement");
+      PETScWrappers::MPI::BlockVector tmp1, tmp2;
+      tmp1.reinit(owned_partitioning, mpi_communicator);
+      tmp2.reinit(owned_partitioning, mpi_communicator);
+      tmp1 = 1;
+      tmp2 = 0;
+      // Jacobi preconditioner of matrix A is by definition inverse diag(A),
+      // this is exactly what we want to compute.
+      // Note that the mass matrix and mass schur do not include the density.
+      PETScWrappers::PreconditionJacobi jacobi(mass_matrix.block(0, 0));
+      jacobi.vmult(tmp2.block(0), tmp1.block(0));
+      // The sparsity pattern has already been set correctly, so explicitly
+      // tell mmult not to rebuild the sparsity pattern.
+      system_matrix.block(1, 0).mmult(
+        mass_schur.block(1, 1), system_matrix.block(0, 1), tmp2.block(0));
+      mass_schur_outdated = false;
+      mass_schur_constraints = constrained_dofs;
+      return true;
     }
 
     template <int dim>
     void FluidSolver<dim>::refine_mesh(const unsigned int min_grid_level,
                                        const unsigned int max_grid_level)
     {
-      TimerOutput::Scope timer_section(timer, "Refine mesh");
+      Utils::TimerScope timer_section(timer, "Refine mesh");
 
       Vector<float> estimated_error_per_cell(triangulation.n_active_cells());
       FEValuesExtractors::Vector velocity(0);
-      using type = std::map<types::boundary_id, const Function<dim, double> *>;
-      KellyErrorEstimator<dim>::estimate(dof_handler,
-                                         face_quad_formula,
-                                         type(),
-                                         present_solution,
-                                         estimated_error_per_cell,
-                                         fe.component_mask(velocity));
-      parallel::distributed::GridRefinement::refine_and_coarsen_fixed_fraction(
-        triangulation, estimated_error_per_cell, 0.6, 0.4);
+      if (parameters.refinement_indicator == "Vorticity")
+        {
+          // The vorticity is the antisymmetric part of the velocity gradient,
+          // its norm squared is the sum over the pairs of components.
+          FEValues<dim> fe_values(
+            fe, volume_quad_formula, update_gradients | update_JxW_values);
+          std::vector<Tensor<2, dim>> grad_v(volume_quad_formula.size());
+          for (auto cell = dof_handler.begin_active();
+               cell != dof_handler.end();
+               ++cell)
+            {
+              if (!cell->is_locally_owned())
+                {
+                  continue;
+                }
+              fe_values.reinit(cell);
+              fe_values[velocity].get_function_gradients(present_solution,
+                                                         grad_v);
+              double vorticity = 0;
+              for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
+                {
+                  for (unsigned int i = 0; i < dim; ++i)
+                    {
+                      for (unsigned int j = i + 1; j < dim; ++j)
+                        {
+                          const double w = grad_v[q][j][i] - grad_v[q][i][j];
+                          vorticity += w * w * fe_values.JxW(q);
+                        }
+                    }
+                }
+              estimated_error_per_cell[cell->active_cell_index()] =
+                cell->diameter() * std::sqrt(vorticity);
+            }
+        }
+      else
+        {
+          using type =
+            std::map<types::boundary_id, const Function<dim, double> *>;
+          KellyErrorEstimator<dim>::estimate(dof_handler,
+                                             face_quad_formula,
+                                             type(),
+                                             present_solution,
+                                             estimated_error_per_cell,
+                                             fe.component_mask(velocity));
+        }
+      if (parameters.target_fluid_cells > 0)
+        {
+          // Refine the fractions of the cells, as long as the mesh stays
+          // under the target.
+          parallel::distributed::GridRefinement::
+            refine_and_coarsen_fixed_number(triangulation,
+                                            estimated_error_per_cell,
+                                            parameters.refinement_fraction,
+                                            parameters.coarsening_fraction,
+                                            parameters.target_fluid_cells);
+        }
+      else
+        {
+          parallel::distributed::GridRefinement::
+            refine_and_coarsen_fixed_fraction(triangulation,
+                                              estimated_error_per_cell,
+                                              parameters.refinement_fraction,
+                                              parameters.coarsening_fraction);
+        }
       if (triangulation.n_levels() > max_grid_level)
         {
           for (auto cell = triangulation.begin_active(max_grid_level);
@@ -322,7 +594,15 @@ namespace Fluid
 
       triangulation.prepare_coarsening_and_refinement();
 
-      trans.prepare_for_coarsening_and_refinement(present_solution);
+      // The previous solution of BDF2 is transferred along.
+      const double history_delta_t = previous_delta_t;
+      std::vector<const PETScWrappers::MPI::BlockVector *> old_solutions{
+        &present_solution};
+      if (history_delta_t > 0)
+        {
+          old_solutions.push_back(&previous_solution);
+        }
+      trans.prepare_for_coarsening_and_refinement(old_solutions);
 
       // Refine the mesh
       triangulation.execute_coarsening_and_refinement();
@@ -333,19 +613,71 @@ namespace Fluid
       initialize_system();
 
       // Transfer solution
-      // Need a non-ghosted vector for interpolation
-      PETScWrappers::MPI::BlockVector tmp;
-      tmp.reinit(owned_partitioning, mpi_communicator);
-      tmp = 0;
-      trans.interpolate(tmp);
-      nonzero_constraints.distribute(tmp); // Is this line necessary?
-      present_solution = tmp;
+      // Need non-ghosted vectors for interpolation
+      std::vector<PETScWrappers::MPI::BlockVector> tmp(old_solutions.size());
+      std::vector<PETScWrappers::MPI::BlockVector *> new_solutions;
+      for (auto &v : tmp)
+        {
+          v.reinit(owned_partitioning, mpi_communicator);
+          new_solutions.push_back(&v);
+        }
+      trans.interpolate(new_solutions);
+      nonzero_constraints.distribute(tmp[0]); // Is this line necessary?
+      present_solution = tmp[0];
+      if (history_delta_t > 0)
+        {
+          previous_solution = tmp[1];
+          previous_delta_t = history_delta_t;
+        }
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::repartition()
+    {
+      Utils::TimerScope timer_section(timer, "Repartition");
+
+      parallel::distributed::SolutionTransfer<dim,
+                                              PETScWrappers::MPI::BlockVector>
+        trans(dof_handler);
+      const double history_delta_t = previous_delta_t;
+      std::vector<const PETScWrappers::MPI::BlockVector *> old_solutions{
+        &present_solution};
+      if (history_delta_t > 0)
+        {
+          old_solutions.push_back(&previous_solution);
+        }
+      trans.prepare_for_coarsening_and_refinement(old_solutions);
+      triangulation.repartition();
+
+      setup_dofs();
+      make_constraints();
+      initialize_system();
+
+      std::vector<PETScWrappers::MPI::BlockVector> tmp(old_solutions.size());
+      std::vector<PETScWrappers::MPI::BlockVector *> new_solutions;
+      for (auto &v : tmp)
+        {
+          v.reinit(owned_partitioning, mpi_communicator);
+          new_solutions.push_back(&v);
+        }
+      trans.interpolate(new_solutions);
+      nonzero_constraints.distribute(tmp[0]);
+      present_solution = tmp[0];
+      if (history_delta_t > 0)
+        {
+          previous_solution = tmp[1];
+          previous_delta_t = history_delta_t;
+        }
     }
 
     template <int dim>
     void FluidSolver<dim>::output_results(const unsigned int output_index) const
     {
-      TimerOutput::Scope timer_section(timer, "Output results");
+      Utils::TimerScope timer_section(timer, "Output results");
 
       pcout << "Writing results..." << std::endl;
       std::vector<std::string> solution_names(dim, "velocity");
@@ -354,100 +686,118 @@ namespace Fluid
       std::vector<std::string> fsi_force_names(dim, "fsi_force");
       fsi_force_names.push_back("dummy_fsi_force");
 
-      std::vector<std::vector<PETScWrappers::MPI::Vector>> tmp_stress =
-        std::vector<std::vector<PETScWrappers::MPI::Vector>>(
-          dim,
-          std::vector<PETScWrappers::MPI::Vector>(
-            dim,
-            PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
-                                       locally_relevant_scalar_dofs,
-                                       mpi_communicator)));
-      tmp_stress = stress;
-
       std::vector<DataComponentInterpretation::DataComponentInterpretation>
         data_component_interpretation(
           dim, DataComponentInterpretation::component_is_part_of_vector);
       data_component_interpretation.push_back(
         DataComponentInterpretation::component_is_scalar);
-      DataOut<dim> data_out;
+      Utils::FilteredDataOut<dim> data_out([this](const auto &cell) {
+        return output_control.write_cell(cell);
+      });
       data_out.attach_dof_handler(dof_handler);
       // vector to be output must be ghosted
-      data_out.add_data_vector(present_solution,
-                               solution_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
-      data_out.add_data_vector(fsi_acceleration,
-                               fsi_force_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
+      if (output_control.write_field("velocity") ||
+          output_control.write_field("pressure"))
+        {
+          data_out.add_data_vector(present_solution,
+                                   solution_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
+        }
 
       // Partition
       Vector<float> subdomain(triangulation.n_active_cells());
-      for (unsigned int i = 0; i < subdomain.size(); ++i)
+      if (output_control.write_field("subdomain"))
         {
-          subdomain(i) = triangulation.locally_owned_subdomain();
+          for (unsigned int i = 0; i < subdomain.size(); ++i)
+            {
+              subdomain(i) = triangulation.locally_owned_subdomain();
+            }
+          data_out.add_data_vector(subdomain, "subdomain");
         }
-      data_out.add_data_vector(subdomain, "subdomain");
 
       // Indicator
       Vector<float> ind(triangulation.n_active_cells());
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
+      if (output_control.write_field("indicator"))
         {
-          if (cell->is_locally_owned())
+          for (auto cell = triangulation.begin_active();
+               cell != triangulation.end();
+               ++cell)
             {
-              auto p = cell_property.get_data(cell);
-              ind[cell->active_cell_index()] = p[0]->indicator;
+              if (cell->is_locally_owned())
+                {
+                  ind[cell->active_cell_index()] =
+                    cell_property.indicator(cell);
+                }
             }
+          data_out.add_data_vector(ind, "Indicator");
         }
-      data_out.add_data_vector(ind, "Indicator");
       // FSI acceleration
       Vector<float> fsi_acc_x(triangulation.n_active_cells());
       Vector<float> fsi_acc_y(triangulation.n_active_cells());
       Vector<float> fsi_acc_z(triangulation.n_active_cells());
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
-            {
-              auto p = cell_property.get_data(cell);
-              fsi_acc_x[cell->active_cell_index()] = p[0]->fsi_acceleration[0];
-              fsi_acc_y[cell->active_cell_index()] = p[0]->fsi_acceleration[1];
-            }
-        }
-      data_out.add_data_vector(fsi_acc_x, "fsi_force_x");
-      data_out.add_data_vector(fsi_acc_y, "fsi_force_y");
-      if (dim == 3)
+      if (output_control.write_field("fsi_force"))
         {
+          data_out.add_data_vector(fsi_acceleration,
+                                   fsi_force_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
           for (auto cell = triangulation.begin_active();
                cell != triangulation.end();
                ++cell)
             {
               if (cell->is_locally_owned())
                 {
-                  auto p = cell_property.get_data(cell);
-                  fsi_acc_z[cell->active_cell_index()] =
-                    p[0]->fsi_acceleration[2];
+                  const auto &p = cell_property.get_data(cell);
+                  fsi_acc_x[cell->active_cell_index()] =
+                    p.fsi_acceleration[0];
+                  fsi_acc_y[cell->active_cell_index()] =
+                    p.fsi_acceleration[1];
+                  if (dim == 3)
+                    {
+                      fsi_acc_z[cell->active_cell_index()] =
+                        p.fsi_acceleration[2];
+                    }
                 }
             }
-          data_out.add_data_vector(fsi_acc_z, "fsi_force_z");
+          data_out.add_data_vector(fsi_acc_x, "fsi_force_x");
+          data_out.add_data_vector(fsi_acc_y, "fsi_force_y");
+          if (dim == 3)
+            {
+              data_out.add_data_vector(fsi_acc_z, "fsi_force_z");
+            }
         }
 
-      // stress
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][0], "Sxx");
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][1], "Sxy");
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[1][1], "Syy");
-      if (dim == 3)
+      // stress, which is only computed when it is written
+      std::vector<PETScWrappers::MPI::Vector> tmp_stress;
+      if (output_control.write_stress(time))
         {
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][2], "Sxz");
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[1][2], "Syz");
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[2][2], "Szz");
+          update_stress();
+          tmp_stress.resize(stress.size());
+          for (unsigned int c = 0; c < stress.size(); ++c)
+            {
+              const TableIndices<2> ij =
+                SymmetricTensor<2, dim>::unrolled_to_component_indices(c);
+              tmp_stress[c].reinit(locally_owned_scalar_dofs,
+                                   locally_relevant_scalar_dofs,
+                                   mpi_communicator);
+              tmp_stress[c] = stress[c];
+              data_out.add_data_vector(scalar_dof_handler,
+                                       tmp_stress[c],
+                                       std::string("S") + "xyz"[ij[0]] +
+                                         "xyz"[ij[1]]);
+            }
         }
 
       data_out.build_patches(parameters.fluid_pressure_degree);
 
+      if (parameters.output_format == "HDF5")
+        {
+          xdmf_output.write(
+            data_out, output_index, time.current(), mpi_communicator);
+          return;
+        }
+
       std::string basename =
         "fluid" + Utilities::int_to_string(output_index, 6) + "-";
 
@@ -456,10 +806,9 @@ namespace Fluid
         Utilities::int_to_string(triangulation.locally_owned_subdomain(), 4) +
         ".vtu";
 
-      std::ofstream output(filename);
-      data_out.write_vtu(output);
-
-      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      const bool write_record =
+        Utilities::MPI::this_mpi_process(mpi_communicator) == 0;
+      if (write_record)
         {
           for (unsigned int i = 0;
                i < Utilities::MPI::n_mpi_processes(mpi_communicator);
@@ -469,96 +818,655 @@ namespace Fluid
                 {time.current(),
                  basename + Utilities::int_to_string(i, 4) + ".vtu"});
             }
-          std::ofstream pvd_output("fluid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
         }
+      // The patches are formatted and written by the writer, the record
+      // after the file.
+      auto write_vtu = data_out.vtu_task(filename, output_control.vtk_flags());
+      output_writer.push(
+        [this, write_vtu, write_record, records = times_and_names]() {
+          write_vtu();
+          if (write_record)
+            {
+              pvd_record.write(records);
+            }
+        });
     }
 
     template <int dim>
     void FluidSolver<dim>::save_checkpoint(const int output_index)
     {
-      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      const unsigned int this_process =
+        Utilities::MPI::this_mpi_process(mpi_communicator);
+      // The parts of the pending checkpoint are all written once every rank
+      // has finished its own, then the checkpoint before it is removed. This
+      // is the only synchronization of the checkpoints.
+      auto complete = [this, this_process]() {
+        checkpoint_writer.wait();
+        if (pending_checkpoint < 0)
+          {
+            return;
+          }
+        MPI_Barrier(mpi_communicator);
+        if (this_process == 0 && complete_checkpoint >= 0 &&
+            complete_checkpoint != pending_checkpoint)
+          {
+            remove_checkpoint(complete_checkpoint);
+          }
+        complete_checkpoint = pending_checkpoint;
+        pending_checkpoint = -1;
+      };
+      complete();
+
+      // Name the checkpoint file
+      const std::string checkpoint_file =
+        Utilities::int_to_string(output_index, 6) + ".fluid_checkpoint";
+      // The solution is copied here, and written from the copy while the
+      // time loop goes on.
+      std::vector<char> part = checkpoint_part();
+      if (this_process == 0)
+        {
+          // The index already points to the checkpoint while its parts are
+          // written, the loader falls back to the previous one if they are
+          // not complete.
+          std::ofstream parts(checkpoint_file + ".parts");
+          parts << Utilities::MPI::n_mpi_processes(mpi_communicator)
+                << std::endl;
+          AssertThrow(parts,
+                      ExcMessage("Cannot write " + checkpoint_file +
+                                 ".parts!"));
+          checkpoint_index.record(output_index);
+        }
+      pending_checkpoint = output_index;
+      const std::string part_file =
+        checkpoint_file + "." + Utilities::int_to_string(this_process);
+      auto write = [part_file, part = std::move(part)]() {
+        // The part is only renamed once it is complete.
+        {
+          std::ofstream out(part_file + ".tmp", std::ios::binary);
+          out.write(part.data(), part.size());
+          AssertThrow(out, ExcMessage("Cannot write " + part_file + "!"));
+        }
+        fs::rename(part_file + ".tmp", part_file);
+      };
+      checkpoint_writer.run(std::move(write), parameters.async_checkpoint);
+
+      if (parameters.async_checkpoint)
+        {
+          pcout << "Checkpoint file being saved at time step "
+                << output_index << "!" << std::endl;
+        }
+      else
+        {
+          complete();
+          pcout << "Checkpoint file successfully saved at time step "
+                << output_index << "!" << std::endl;
+        }
+    }
+
+    template <int dim>
+    unsigned int FluidSolver<dim>::checkpoint_parts(const int step) const
+    {
+      const std::string checkpoint_file =
+        Utilities::int_to_string(step, 6) + ".fluid_checkpoint";
+      std::ifstream parts(checkpoint_file + ".parts");
+      unsigned int n_parts = 0;
+      if (!(parts >> n_parts))
         {
-          // Specify the current working path
-          fs::path local_path = fs::current_path();
-          // A set to store all the filenames for checkpoints
-          std::set<fs::path> checkpoints;
-          // Find the checkpoints and remove excess ones
-          // Only keep the latest one
-          for (const auto &p : fs::directory_iterator(local_path))
+          return 0;
+        }
+      for (unsigned int i = 0; i < n_parts; ++i)
+        {
+          if (!fs::exists(checkpoint_file + "." +
+                          Utilities::int_to_string(i)))
             {
-              if (p.path().extension() == ".fluid_checkpoint")
-                {
-                  checkpoints.insert(p.path());
-                }
+              return 0;
+            }
+        }
+      return n_parts;
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::remove_checkpoint(const int step) const
+    {
+      const std::string checkpoint_file =
+        Utilities::int_to_string(step, 6) + ".fluid_checkpoint";
+      pcout << "Removing " << checkpoint_file << std::endl;
+      unsigned int n_parts = 0;
+      {
+        std::ifstream parts(checkpoint_file + ".parts");
+        if (!(parts >> n_parts))
+          {
+            n_parts = 0;
+          }
+      }
+      if (n_parts > 0)
+        {
+          for (unsigned int i = 0; i < n_parts; ++i)
+            {
+              fs::remove(checkpoint_file + "." + Utilities::int_to_string(i));
+            }
+          fs::remove(checkpoint_file + ".parts");
+        }
+      else
+        {
+          // Saved by the triangulation.
+          fs::remove(checkpoint_file);
+          fs::remove(checkpoint_file + ".info");
+        }
+    }
+
+    template <int dim>
+    std::vector<char> FluidSolver<dim>::checkpoint_part() const
+    {
+      std::vector<const PETScWrappers::MPI::BlockVector *> solutions{
+        &present_solution};
+      // BDF2 checkpoints always hold a previous solution, which is the
+      // present one if there is none yet, so that they can be told apart.
+      if (parameters.fluid_time_integration == "BDF2")
+        {
+          solutions.push_back(previous_delta_t > 0 ? &previous_solution
+                                                   : &present_solution);
+        }
+      std::vector<CellId::binary_type> cells;
+      std::vector<double> values;
+      Vector<double> cell_values(fe.dofs_per_cell);
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
             }
-          while (checkpoints.size() > 1)
+          cells.push_back(cell->id().template to_binary<dim>());
+          for (const auto *solution : solutions)
             {
-              pcout << "Removing " << *checkpoints.begin() << std::endl;
-              fs::path to_be_removed(*checkpoints.begin());
-              fs::remove(to_be_removed);
-              to_be_removed.replace_extension(".fluid_checkpoint.info");
-              fs::remove(to_be_removed);
-              checkpoints.erase(checkpoints.begin());
+              cell->get_dof_values(*solution, cell_values);
+              values.insert(
+                values.end(), cell_values.begin(), cell_values.end());
             }
         }
-      // Name the checkpoint file
-      std::string checkpoint_file = Utilities::int_to_string(output_index, 6);
-      checkpoint_file.append(".fluid_checkpoint");
-      // Save the solution
-      parallel::distributed::SolutionTransfer<dim,
-                                              PETScWrappers::MPI::BlockVector>
-        sol_trans(dof_handler);
-      sol_trans.prepare_serialization(present_solution);
-      triangulation.save(checkpoint_file.c_str());
-      pcout << "Checkpoint file successfully saved at time step "
-            << output_index << "!" << std::endl;
+      // The part is a header, the active cells and their dof values. The
+      // time is saved since the step size may have changed on the way.
+      const Utils::Time::State state = time.get_state();
+      const CheckpointHeader header{{static_cast<double>(solutions.size()),
+                                     static_cast<double>(cells.size()),
+                                     previous_delta_t,
+                                     static_cast<double>(state.timestep),
+                                     state.time_current,
+                                     state.time_previous,
+                                     state.delta_t}};
+      std::vector<char> part(sizeof(header) +
+                             cells.size() * sizeof(CellId::binary_type) +
+                             values.size() * sizeof(double));
+      char *position = part.data();
+      std::memcpy(position, header.data(), sizeof(header));
+      position += sizeof(header);
+      std::memcpy(
+        position, cells.data(), cells.size() * sizeof(CellId::binary_type));
+      position += cells.size() * sizeof(CellId::binary_type);
+      std::memcpy(position, values.data(), values.size() * sizeof(double));
+      return part;
     }
 
     template <int dim>
     bool FluidSolver<dim>::load_checkpoint()
     {
-      // Specify the current working path
-      fs::path local_path = fs::current_path();
-      fs::path checkpoint_file(local_path);
-      // Find the latest checkpoint
-      for (const auto &p : fs::directory_iterator(local_path))
+      Utils::StartupScope startup("fluid load_checkpoint");
+      int latest = checkpoint_index.latest(mpi_communicator);
+      unsigned int saved_processes = 0;
+      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
-          if (p.path().extension() == ".fluid_checkpoint" &&
-              (std::string(p.path().stem()) >
-                 std::string(checkpoint_file.stem()) ||
-               checkpoint_file == local_path))
+          // Checkpoints saved before the index existed are found by their
+          // names, so are the complete ones if the parts of the latest are
+          // not all written. The triangulation saved the checkpoints before
+          // the parts.
+          if (latest < 0 ||
+              (fs::exists(Utilities::int_to_string(latest, 6) +
+                          ".fluid_checkpoint.parts") &&
+               checkpoint_parts(latest) == 0))
+            {
+              latest = -1;
+              for (const auto &p : fs::directory_iterator(fs::current_path()))
+                {
+                  if (p.path().extension() == ".fluid_checkpoint")
+                    {
+                      latest = std::max(
+                        latest, Utilities::string_to_int(p.path().stem()));
+                    }
+                  else if (p.path().extension() == ".parts")
+                    {
+                      const int step =
+                        Utilities::string_to_int(p.path().stem().stem());
+                      if (checkpoint_parts(step) > 0)
+                        {
+                          latest = std::max(latest, step);
+                        }
+                    }
+                }
+            }
+          if (latest >= 0)
             {
-              checkpoint_file = p.path();
+              saved_processes = checkpoint_parts(latest);
             }
         }
+      MPI_Bcast(&latest, 1, MPI_INT, 0, mpi_communicator);
+      MPI_Bcast(&saved_processes, 1, MPI_UNSIGNED, 0, mpi_communicator);
+      // The checkpoint on disk is removed once a newer one is complete.
+      complete_checkpoint = latest;
+      const int buddy_latest = parameters.buddy_checkpoint_interval > 0
+                                 ? buddy_checkpoint.latest()
+                                 : -1;
+      if (buddy_latest > latest)
+        {
+          load_buddy_checkpoint(buddy_latest);
+          return true;
+        }
       // if no restart file is found, return false
-      if (checkpoint_file == local_path)
+      if (latest < 0)
         {
           pcout
             << "Did not find fluid checkpoint files. Start from the beginning !"
             << std::endl;
           return false;
         }
-      // set time step load the checkpoint file
-      pcout << "Loading checkpoint file " << checkpoint_file.filename().c_str()
-            << "!" << std::endl;
-      triangulation.load(checkpoint_file.filename().c_str());
+      if (saved_processes > 0)
+        {
+          load_checkpoint_parts(latest, saved_processes);
+        }
+      else
+        {
+          load_triangulation_checkpoint(latest);
+        }
+      pcout << "Checkpoint file successfully loaded from time step "
+            << time.get_timestep() << "!" << std::endl;
+      return true;
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::load_checkpoint_parts(
+      const int latest, const unsigned int saved_processes)
+    {
+      const std::string checkpoint_file =
+        Utilities::int_to_string(latest, 6) + ".fluid_checkpoint";
+      pcout << "Loading checkpoint file " << checkpoint_file << "!"
+            << std::endl;
+      if (saved_processes != Utilities::MPI::n_mpi_processes(mpi_communicator))
+        {
+          pcout << "The checkpoint was saved on " << saved_processes
+                << " processes, redistributing it..." << std::endl;
+        }
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const bool bdf2 = parameters.fluid_time_integration == "BDF2";
+      const unsigned int n_vectors = bdf2 ? 2 : 1;
+      const std::size_t values_per_cell = n_vectors * dofs_per_cell;
+
+      // Every rank needs all the saved cells to refine the mesh. Rank 0 reads
+      // them from the parts and checks the sizes of the parts.
+      CheckpointHeader header{};
+      std::vector<unsigned int> n_cells(saved_processes);
+      std::vector<CellId::binary_type> cells;
+      unsigned int matching = 1;
+      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+        {
+          for (unsigned int i = 0; i < saved_processes; ++i)
+            {
+              const std::string part_file =
+                checkpoint_file + "." + Utilities::int_to_string(i);
+              std::ifstream in(part_file, std::ios::binary);
+              in.read(reinterpret_cast<char *>(header.data()), sizeof(header));
+              AssertThrow(in, ExcMessage("Cannot read " + part_file + "!"));
+              n_cells[i] = header[1];
+              const std::size_t n_read = cells.size();
+              cells.resize(n_read + n_cells[i]);
+              in.read(reinterpret_cast<char *>(cells.data() + n_read),
+                      n_cells[i] * sizeof(CellId::binary_type));
+              AssertThrow(in, ExcMessage("Cannot read " + part_file + "!"));
+              if (fs::file_size(part_file) !=
+                  sizeof(header) +
+                    n_cells[i] * (sizeof(CellId::binary_type) +
+                                  values_per_cell * sizeof(double)))
+                {
+                  matching = 0;
+                }
+            }
+        }
+      MPI_Bcast(header.data(), header.size(), MPI_DOUBLE, 0, mpi_communicator);
+      check_time_integration(header[0]);
+      MPI_Bcast(&matching, 1, MPI_UNSIGNED, 0, mpi_communicator);
+      AssertThrow(matching,
+                  ExcMessage("The fluid checkpoint does not match the "
+                             "elements!"));
+      MPI_Bcast(
+        n_cells.data(), saved_processes, MPI_UNSIGNED, 0, mpi_communicator);
+      cells.resize(std::accumulate(n_cells.begin(), n_cells.end(), 0ul));
+      MPI_Bcast(cells.data(),
+                cells.size() * std::tuple_size<CellId::binary_type>::value,
+                MPI_UNSIGNED,
+                0,
+                mpi_communicator);
+      std::map<CellId, std::pair<unsigned int, unsigned int>> saved_cells;
+      for (unsigned int part = 0, k = 0; part < saved_processes; ++part)
+        {
+          for (unsigned int i = 0; i < n_cells[part]; ++i, ++k)
+            {
+              saved_cells.emplace(CellId(cells[k]), std::make_pair(part, i));
+            }
+        }
+      cells.clear();
+      refine_to_saved_cells(saved_cells);
+
+      // Every rank reads the values of its cells from the parts they were
+      // saved in, in the saved order.
+      std::map<
+        unsigned int,
+        std::vector<std::pair<unsigned int,
+                              typename DoFHandler<dim>::active_cell_iterator>>>
+        requests;
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          const auto saved = saved_cells.find(cell->id());
+          AssertThrow(saved != saved_cells.end(),
+                      ExcMessage("The fluid checkpoint does not match "
+                                 "the mesh!"));
+          requests[saved->second.first].emplace_back(saved->second.second,
+                                                     cell);
+        }
+      // Only the owned dofs of the cells are written.
+      const IndexSet &owned_dofs = dof_handler.locally_owned_dofs();
+      std::vector<PETScWrappers::MPI::BlockVector> tmp(n_vectors);
+      for (auto &v : tmp)
+        {
+          v.reinit(owned_partitioning, mpi_communicator);
+        }
+      std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+      std::vector<double> cell_values(values_per_cell);
+      for (auto &request : requests)
+        {
+          const std::string part_file =
+            checkpoint_file + "." + Utilities::int_to_string(request.first);
+          std::ifstream in(part_file, std::ios::binary);
+          AssertThrow(in, ExcMessage("Cannot open " + part_file + "!"));
+          const std::size_t values_begin =
+            sizeof(header) +
+            n_cells[request.first] * sizeof(CellId::binary_type);
+          std::sort(request.second.begin(),
+                    request.second.end(),
+                    [](const auto &a, const auto &b) {
+                      return a.first < b.first;
+                    });
+          for (const auto &saved : request.second)
+            {
+              in.seekg(values_begin +
+                       saved.first * values_per_cell * sizeof(double));
+              in.read(reinterpret_cast<char *>(cell_values.data()),
+                      values_per_cell * sizeof(double));
+              AssertThrow(in, ExcMessage("Cannot read " + part_file + "!"));
+              saved.second->get_dof_indices(dof_indices);
+              auto value = cell_values.begin();
+              for (auto &v : tmp)
+                {
+                  for (unsigned int j = 0; j < dofs_per_cell; ++j, ++value)
+                    {
+                      if (owned_dofs.is_element(dof_indices[j]))
+                        {
+                          v(dof_indices[j]) = *value;
+                        }
+                    }
+                }
+            }
+        }
+      for (auto &v : tmp)
+        {
+          v.compress(VectorOperation::insert);
+        }
+      restore_solutions(tmp, header[2]);
+      restore_time(header);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::load_triangulation_checkpoint(const int latest)
+    {
+      const std::string checkpoint_file =
+        Utilities::int_to_string(latest, 6) + ".fluid_checkpoint";
+      pcout << "Loading checkpoint file " << checkpoint_file << "!"
+            << std::endl;
+      // The number of processes that saved is the second entry of the
+      // second line of the info file, which is written by deal.II.
+      unsigned int saved_processes =
+        Utilities::MPI::n_mpi_processes(mpi_communicator);
+      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+        {
+          std::ifstream info(checkpoint_file + ".info");
+          std::string header;
+          unsigned int version = 0, n_processes = 0;
+          if (std::getline(info, header) && info >> version >> n_processes)
+            {
+              saved_processes = n_processes;
+            }
+        }
+      MPI_Bcast(&saved_processes, 1, MPI_UNSIGNED, 0, mpi_communicator);
+      if (saved_processes != Utilities::MPI::n_mpi_processes(mpi_communicator))
+        {
+          pcout << "The checkpoint was saved on " << saved_processes
+                << " processes, redistributing it..." << std::endl;
+        }
+      // The cells are partitioned among the current processes on loading,
+      // with the weights if there are any, and the solution follows them.
+      triangulation.load(checkpoint_file.c_str(), true);
       setup_dofs();
       make_constraints();
       initialize_system();
       parallel::distributed::SolutionTransfer<dim,
                                               PETScWrappers::MPI::BlockVector>
         sol_trans(dof_handler);
-      PETScWrappers::MPI::BlockVector tmp;
-      tmp.reinit(owned_partitioning, mpi_communicator);
-      sol_trans.deserialize(tmp);
-      present_solution = tmp;
+      const bool bdf2 = parameters.fluid_time_integration == "BDF2";
+      std::vector<PETScWrappers::MPI::BlockVector> tmp(bdf2 ? 2 : 1);
+      std::vector<PETScWrappers::MPI::BlockVector *> solutions;
+      for (auto &v : tmp)
+        {
+          v.reinit(owned_partitioning, mpi_communicator);
+          solutions.push_back(&v);
+        }
+      sol_trans.deserialize(solutions);
+      // The time is replayed with a constant step below, which is the size
+      // of the step between the two solutions as well.
+      restore_solutions(tmp, time.get_delta_t());
+      replay_time(latest, saved_processes);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::check_time_integration(
+      const double saved_vectors) const
+    {
+      // A BDF2 checkpoint holds the previous solution as well.
+      const std::string saved = saved_vectors == 2   ? "BDF2"
+                                : saved_vectors == 1 ? "Backward Euler"
+                                                     : "unknown";
+      AssertThrow(saved == parameters.fluid_time_integration,
+                  ExcMessage("The fluid checkpoint was saved with " + saved +
+                             " time integration, but this run uses " +
+                             parameters.fluid_time_integration +
+                             ". Restart with the same Time integration!"));
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::refine_to_saved_cells(
+      const std::map<CellId, std::pair<unsigned int, unsigned int>>
+        &saved_cells)
+    {
+      // The triangulation is the coarse mesh, whose active cells that are
+      // not saved are ancestors of saved ones.
+      while (true)
+        {
+          unsigned int coarser = 0;
+          for (const auto &cell : triangulation.active_cell_iterators())
+            {
+              if (cell->is_locally_owned() &&
+                  saved_cells.find(cell->id()) == saved_cells.end())
+                {
+                  cell->set_refine_flag();
+                  coarser = 1;
+                }
+            }
+          if (Utilities::MPI::max(coarser, mpi_communicator) == 0)
+            {
+              break;
+            }
+          triangulation.execute_coarsening_and_refinement();
+        }
+      setup_dofs();
+      make_constraints();
+      initialize_system();
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::restore_solutions(
+      const std::vector<PETScWrappers::MPI::BlockVector> &solutions,
+      const double saved_previous_delta_t)
+    {
+      present_solution = solutions[0];
+      if (parameters.fluid_time_integration == "BDF2")
+        {
+          previous_solution = solutions[1];
+          previous_delta_t = saved_previous_delta_t;
+        }
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::save_buddy_checkpoint(const int output_index)
+    {
+      Utils::TimerScope timer_section(timer, "Buddy checkpoint");
+      buddy_checkpoint.save(output_index, checkpoint_part());
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::load_buddy_checkpoint(const int latest)
+    {
+      pcout << "Loading the buddy checkpoint of time step " << latest << "!"
+            << std::endl;
+      const std::vector<char> part = buddy_checkpoint.load(latest);
+      CheckpointHeader header;
+      AssertThrow(part.size() >= sizeof(header),
+                  ExcMessage("Incomplete fluid buddy checkpoint!"));
+      std::memcpy(header.data(), part.data(), sizeof(header));
+      check_time_integration(header[0]);
+      const unsigned int n_vectors = header[0];
+      const std::size_t n_cells = header[1];
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const std::size_t cells_size = n_cells * sizeof(CellId::binary_type);
+      AssertThrow(part.size() == sizeof(header) + cells_size +
+                                   n_cells * n_vectors * dofs_per_cell *
+                                     sizeof(double),
+                  ExcMessage("The fluid buddy checkpoint does not match the "
+                             "elements!"));
+      const char *cell_data = part.data() + sizeof(header);
+      std::vector<double> values(n_cells * n_vectors * dofs_per_cell);
+      std::memcpy(
+        values.data(), cell_data + cells_size, values.size() * sizeof(double));
+
+      // Every rank learns the saved active cells of all the parts, with the
+      // rank and the position they are saved at.
+      const auto all_cells = Utilities::MPI::all_gather(
+        mpi_communicator,
+        std::vector<char>(cell_data, cell_data + cells_size));
+      std::map<CellId, std::pair<unsigned int, unsigned int>> saved_cells;
+      for (unsigned int rank = 0; rank < all_cells.size(); ++rank)
+        {
+          for (unsigned int i = 0;
+               i < all_cells[rank].size() / sizeof(CellId::binary_type);
+               ++i)
+            {
+              CellId::binary_type id;
+              std::memcpy(&id,
+                          all_cells[rank].data() + i * sizeof(id),
+                          sizeof(id));
+              saved_cells.emplace(CellId(id), std::make_pair(rank, i));
+            }
+        }
+      refine_to_saved_cells(saved_cells);
+
+      // Ask the ranks that saved the owned cells for their values. The
+      // positions are sent as doubles, which hold them exactly.
+      std::map<unsigned int, std::vector<double>> requests;
+      std::map<unsigned int,
+               std::vector<typename DoFHandler<dim>::active_cell_iterator>>
+        requested_cells;
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          const auto saved = saved_cells.find(cell->id());
+          AssertThrow(saved != saved_cells.end(),
+                      ExcMessage("The fluid buddy checkpoint does not match "
+                                 "the mesh!"));
+          requests[saved->second.first].push_back(saved->second.second);
+          requested_cells[saved->second.first].push_back(cell);
+        }
+      std::map<unsigned int, std::vector<double>> replies;
+      for (const auto &request :
+           Utils::exchange_doubles(mpi_communicator, requests))
+        {
+          auto &reply = replies[request.first];
+          for (const double i : request.second)
+            {
+              const auto begin =
+                values.begin() +
+                static_cast<std::size_t>(i) * n_vectors * dofs_per_cell;
+              reply.insert(
+                reply.end(), begin, begin + n_vectors * dofs_per_cell);
+            }
+        }
+
+      // Only the owned dofs of the cells are written.
+      const IndexSet &owned_dofs = dof_handler.locally_owned_dofs();
+      std::vector<PETScWrappers::MPI::BlockVector> tmp(n_vectors);
+      for (auto &v : tmp)
+        {
+          v.reinit(owned_partitioning, mpi_communicator);
+        }
+      std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+      for (const auto &reply :
+           Utils::exchange_doubles(mpi_communicator, replies))
+        {
+          auto value = reply.second.begin();
+          for (const auto &cell : requested_cells[reply.first])
+            {
+              cell->get_dof_indices(dof_indices);
+              for (auto &v : tmp)
+                {
+                  for (unsigned int j = 0; j < dofs_per_cell; ++j, ++value)
+                    {
+                      if (owned_dofs.is_element(dof_indices[j]))
+                        {
+                          v(dof_indices[j]) = *value;
+                        }
+                    }
+                }
+            }
+        }
+      for (auto &v : tmp)
+        {
+          v.compress(VectorOperation::insert);
+        }
+      restore_solutions(tmp, header[2]);
+      restore_time(header);
+      pcout << "Buddy checkpoint successfully loaded from time step "
+            << time.get_timestep() << "!" << std::endl;
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::replay_time(const int latest,
+                                       const unsigned int saved_processes)
+    {
       // Update the time and names to set the current time and write
       // correct .pvd file.
 
-      for (int i = 0; i <= Utilities::string_to_int(checkpoint_file.stem());
-           ++i)
+      for (int i = 0; i <= latest; ++i)
         {
           if ((time.current() == 0 || time.time_to_output()) &&
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -566,16 +1474,16 @@ namespace Fluid
               std::string basename =
                 "fluid" + Utilities::int_to_string(time.get_timestep(), 6) +
                 "-";
-              for (unsigned int j = 0;
-                   j < Utilities::MPI::n_mpi_processes(mpi_communicator);
-                   ++j)
+              // The earlier output was written by the processes that
+              // saved the checkpoint.
+              for (unsigned int j = 0; j < saved_processes; ++j)
                 {
                   times_and_names.push_back(
                     {time.current(),
                      basename + Utilities::int_to_string(j, 4) + ".vtu"});
                 }
             }
-          if (i == Utilities::string_to_int(checkpoint_file.stem()))
+          if (i == latest)
             break;
           time.increment();
           // Update the time for hard coded boundary conditions
@@ -584,35 +1492,207 @@ namespace Fluid
               boundary_values->advance_time(time.get_delta_t());
             }
         }
+    }
 
-      pcout << "Checkpoint file successfully loaded from time step "
-            << time.get_timestep() << "!" << std::endl;
-      return true;
+    template <int dim>
+    void FluidSolver<dim>::restore_time(const CheckpointHeader &header)
+    {
+      time.set_state({static_cast<unsigned int>(header[3]),
+                      header[4],
+                      header[5],
+                      header[6]});
+      // Update the time for hard coded boundary conditions
+      if (parameters.use_hard_coded_values)
+        {
+          boundary_values->set_time(time.current());
+        }
+      // The times of the earlier output cannot be replayed if the step size
+      // has changed, so the records up to the checkpoint are taken from the
+      // .pvd file, which is written again from them with the next output.
+      if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+        {
+          return;
+        }
+      std::ifstream pvd("fluid.pvd");
+      std::string line;
+      const std::string time_key = "timestep=\"", file_key = "file=\"";
+      while (std::getline(pvd, line))
+        {
+          const auto time_begin = line.find(time_key);
+          const auto file_begin = line.find(file_key);
+          if (time_begin == std::string::npos ||
+              file_begin == std::string::npos)
+            {
+              continue;
+            }
+          const std::string file = line.substr(
+            file_begin + file_key.size(),
+            line.find('"', file_begin + file_key.size()) - file_begin -
+              file_key.size());
+          // The files are named by the time step, fluidNNNNNN-PPPP.vtu.
+          const unsigned int step = Utilities::string_to_int(
+            file.substr(std::string("fluid").size(), 6));
+          if (step > time.get_timestep())
+            {
+              break;
+            }
+          times_and_names.push_back(
+            {std::stod(line.substr(time_begin + time_key.size())), file});
+        }
     }
 
     template <int dim>
-    void FluidSolver<dim>::update_stress()
+    void FluidSolver<dim>::write_monitors()
     {
-      for (unsigned int i = 0; i < dim; ++i)
+      if ((parameters.fluid_probes.empty() &&
+           parameters.fluid_monitor_boundaries.empty()) ||
+          !time.time_to_output(parameters.monitor_interval))
+        {
+          return;
+        }
+      Utils::TimerScope timer_section(timer, "Monitors");
+      const std::string axes = "xyz";
+      std::vector<std::string> columns;
+      std::vector<double> values;
+
+      // Velocity and pressure at the probes, which are queried by rank 0.
+      if (!parameters.fluid_probes.empty())
+        {
+          if (!probe_evaluator)
+            {
+              std::vector<Point<dim>> points;
+              if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+                {
+                  for (unsigned int i = 0; i < parameters.fluid_probes.size();
+                       i += dim)
+                    {
+                      Point<dim> point;
+                      for (unsigned int d = 0; d < dim; ++d)
+                        {
+                          point[d] = parameters.fluid_probes[i + d];
+                        }
+                      points.push_back(point);
+                    }
+                }
+              probe_evaluator = std::make_unique<
+                Utils::RemotePointEvaluator<dim,
+                                            PETScWrappers::MPI::BlockVector>>(
+                dof_handler, mpi_communicator);
+              probe_evaluator->reinit(points);
+            }
+          std::vector<std::vector<Vector<double>>> probe_values;
+          probe_evaluator->point_values({&present_solution}, probe_values);
+          for (unsigned int p = 0; p < probe_values[0].size(); ++p)
+            {
+              const std::string name = "probe" + std::to_string(p) + "_";
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  columns.push_back(name + "v" + axes[d]);
+                  values.push_back(probe_values[0][p][d]);
+                }
+              columns.push_back(name + "p");
+              values.push_back(probe_values[0][p][dim]);
+            }
+        }
+
+      // The force the fluid exerts on every monitored boundary, and the
+      // volume flux out of the fluid through it.
+      const std::vector<int> &boundaries = parameters.fluid_monitor_boundaries;
+      if (!boundaries.empty())
         {
-          for (unsigned int j = 0; j < dim; ++j)
+          std::vector<double> integrals(boundaries.size() * (dim + 1), 0);
+          FEFaceValues<dim> fe_face_values(fe,
+                                           face_quad_formula,
+                                           update_values | update_gradients |
+                                             update_normal_vectors |
+                                             update_JxW_values);
+          const unsigned int n_q_points = face_quad_formula.size();
+          const FEValuesExtractors::Vector velocities(0);
+          const FEValuesExtractors::Scalar pressure(dim);
+          std::vector<Tensor<1, dim>> v(n_q_points);
+          std::vector<SymmetricTensor<2, dim>> sym_grad_v(n_q_points);
+          std::vector<double> p(n_q_points);
+          for (auto cell = dof_handler.begin_active();
+               cell != dof_handler.end();
+               ++cell)
+            {
+              if (!cell->is_locally_owned() || !cell->at_boundary())
+                {
+                  continue;
+                }
+              for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                   ++f)
+                {
+                  if (!cell->face(f)->at_boundary())
+                    {
+                      continue;
+                    }
+                  const auto it =
+                    std::find(boundaries.begin(),
+                              boundaries.end(),
+                              static_cast<int>(cell->face(f)->boundary_id()));
+                  if (it == boundaries.end())
+                    {
+                      continue;
+                    }
+                  double *integral =
+                    &integrals[(it - boundaries.begin()) * (dim + 1)];
+                  fe_face_values.reinit(cell, f);
+                  fe_face_values[velocities].get_function_values(
+                    present_solution, v);
+                  fe_face_values[velocities].get_function_symmetric_gradients(
+                    present_solution, sym_grad_v);
+                  fe_face_values[pressure].get_function_values(
+                    present_solution, p);
+                  for (unsigned int q = 0; q < n_q_points; ++q)
+                    {
+                      const Tensor<1, dim> &normal =
+                        fe_face_values.normal_vector(q);
+                      const SymmetricTensor<2, dim> sigma =
+                        -p[q] * Physics::Elasticity::StandardTensors<dim>::I +
+                        2 * parameters.viscosity * sym_grad_v[q];
+                      const Tensor<1, dim> traction = sigma * normal;
+                      for (unsigned int d = 0; d < dim; ++d)
+                        {
+                          integral[d] -= traction[d] * fe_face_values.JxW(q);
+                        }
+                      integral[dim] += v[q] * normal * fe_face_values.JxW(q);
+                    }
+                }
+            }
+          Utilities::MPI::sum(integrals, mpi_communicator, integrals);
+          for (unsigned int b = 0; b < boundaries.size(); ++b)
             {
-              stress[i][j] = 0;
+              const std::string id = std::to_string(boundaries[b]);
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  columns.push_back("force" + id + "_" + axes[d]);
+                  values.push_back(integrals[b * (dim + 1) + d]);
+                }
+              columns.push_back("flux" + id);
+              values.push_back(integrals[b * (dim + 1) + dim]);
             }
         }
+
+      monitor_file.write(time.current(), columns, values);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::update_stress() const
+    {
+      // Only the independent components of the symmetric stress are stored.
+      const unsigned int n_components =
+        SymmetricTensor<2, dim>::n_independent_components;
+      stress.assign(n_components,
+                    PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
+                                               mpi_communicator));
       PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
                                                    mpi_communicator);
       surrounding_cells = 0.0;
-      // The stress tensors are stored as 2D vectors of shape dim*dim
-      // at cell and quadrature point level.
-      std::vector<std::vector<Vector<double>>> cell_stress(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> quad_stress(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
+      std::vector<Vector<double>> cell_stress(
+        n_components, Vector<double>(scalar_fe.dofs_per_cell));
+      std::vector<Vector<double>> quad_stress(
+        n_components, Vector<double>(volume_quad_formula.size()));
 
       // The projection matrix from quadrature points to the dofs.
       FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
@@ -646,51 +1726,160 @@ namespace Fluid
           // Fluid pressure
           fe_values[pressure].get_function_values(present_solution, p);
 
-          // Loop over all quadrature points to set FSI forces.
           for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
             {
               SymmetricTensor<2, dim> sigma =
                 -p[q] * Physics::Elasticity::StandardTensors<dim>::I +
                 2 * parameters.viscosity * sym_grad_v[q];
-              for (unsigned int i = 0; i < dim; ++i)
+              for (unsigned int c = 0; c < n_components; ++c)
                 {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      quad_stress[i][j][q] = sigma[i][j];
-                    }
+                  quad_stress[c][q] = sigma.access_raw_entry(c);
                 }
             }
 
-          for (unsigned int i = 0; i < dim; ++i)
+          for (unsigned int c = 0; c < n_components; ++c)
             {
-              for (unsigned int j = 0; j < dim; ++j)
-                {
-                  qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                  scalar_cell->distribute_local_to_global(cell_stress[i][j],
-                                                          stress[i][j]);
-                }
+              qpt_to_dof.vmult(cell_stress[c], quad_stress[c]);
+              scalar_cell->distribute_local_to_global(cell_stress[c],
+                                                      stress[c]);
             }
           scalar_cell->distribute_local_to_global(local_sorrounding_cells,
                                                   surrounding_cells);
         }
       surrounding_cells.compress(VectorOperation::add);
 
-      for (unsigned int i = 0; i < dim; ++i)
+      const unsigned int local_begin = surrounding_cells.local_range().first;
+      const unsigned int local_end = surrounding_cells.local_range().second;
+      for (unsigned int c = 0; c < n_components; ++c)
         {
-          for (unsigned int j = 0; j < dim; ++j)
+          stress[c].compress(VectorOperation::add);
+          for (unsigned int k = local_begin; k < local_end; ++k)
             {
-              stress[i][j].compress(VectorOperation::add);
-              const unsigned int local_begin =
-                surrounding_cells.local_range().first;
-              const unsigned int local_end =
-                surrounding_cells.local_range().second;
-              for (unsigned int k = local_begin; k < local_end; ++k)
-                {
-                  stress[i][j][k] /= surrounding_cells[k];
-                }
-              stress[i][j].compress(VectorOperation::insert);
+              stress[c][k] /= surrounding_cells[k];
+            }
+          stress[c].compress(VectorOperation::insert);
+        }
+    }
+        }
+    }
+
+    template <int dim>
+    double FluidSolver<dim>::compute_cfl()
+    {
+      std::vector<Tensor<1, dim>> current_velocity_values(
+        volume_quad_formula.size());
+      Vector<double> current_dof_values(fe.dofs_per_cell);
+
+      double cfl = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
             }
+          cell_fe_data.reinit(cell);
+          cell->get_dof_values(present_solution, current_dof_values);
+          cell_fe_data.get_velocity_values(current_dof_values,
+                                           current_velocity_values);
+          const double h = cell->minimum_vertex_distance() /
+                           parameters.fluid_velocity_degree;
+          for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
+            {
+              cfl = std::max(cfl,
+                             current_velocity_values[q].norm() *
+                               time.get_delta_t() / h);
+            }
+        }
+      return Utilities::MPI::max(cfl, mpi_communicator);
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::adapt_time_step(const unsigned int newton_iterations)
+    {
+      // In FSI the fluid and solid steps are coupled, so leave them alone.
+      if (!parameters.adaptive_time_step ||
+          parameters.simulation_type != "Fluid")
+        {
+          return;
+        }
+      const double cfl = compute_cfl();
+      double delta_t = time_step_controller.next_delta_t(
+        time.get_delta_t(), cfl, newton_iterations);
+      // Do not step past the end time.
+      const double remaining = time.end() - time.current();
+      if (remaining > 1e-12)
+        {
+          delta_t = std::min(delta_t, remaining);
+        }
+      if (delta_t != time.get_delta_t())
+        {
+          pcout << "CFL = " << cfl << ", next time step size = " << delta_t
+                << std::endl;
+          time.set_delta_t(delta_t);
+        }
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::update_time_history()
+    {
+      if (previous_delta_t <= 0)
+        {
+          return;
         }
+      const auto a =
+        Utils::bdf2_coefficients(time.get_delta_t(), previous_delta_t);
+      // The history must be computed in a non-ghosted vector.
+      PETScWrappers::MPI::BlockVector tmp;
+      tmp.reinit(owned_partitioning, mpi_communicator);
+      tmp = present_solution;
+      tmp.sadd(1 + a[2] / a[0], -a[2] / a[0], previous_solution);
+      bdf2_history = tmp;
+    }
+
+    template <int dim>
+    const PETScWrappers::MPI::BlockVector &
+    FluidSolver<dim>::time_history() const
+    {
+      return previous_delta_t > 0 ? bdf2_history : present_solution;
+    }
+
+    template <int dim>
+    double FluidSolver<dim>::effective_delta_t() const
+    {
+      return time.get_delta_t() /
+             Utils::bdf2_coefficients(time.get_delta_t(), previous_delta_t)[0];
+    }
+
+    template <int dim>
+    void FluidSolver<dim>::record_previous_solution()
+    {
+      if (parameters.fluid_time_integration != "BDF2")
+        {
+          return;
+        }
+      previous_solution = present_solution;
+      previous_delta_t = time.get_delta_t();
+    }
+
+    template <int dim>
+    bool FluidSolver<dim>::reached_steady_state()
+    {
+      if (!steady_state.record(present_solution, time.current()))
+        {
+          return false;
+        }
+      pcout << "Steady state reached at t = " << time.current()
+            << ", rate of change = " << steady_state.rate() << std::endl;
+      if (!time.time_to_output())
+        {
+          output_results(time.get_timestep());
+        }
+      if (!time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+      return true;
     }
 
     template class FluidSolver<2>;
@@ -6,7 +6,8 @@ namespace MPI
   template <int dim>
   FSI<dim>::~FSI()
   {
-    timer.print_summary();
+    cell_weight_connection.disconnect();
+    Utils::TimingReport::instance().remove(timer);
   }
 
   template <int dim>
@@ -26,21 +27,87 @@ namespace MPI
            parameters.save_interval),
       timer(
         mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+      fluid_locator(fluid_solver.dof_handler),
+      solid_locator(solid_solver.dof_handler),
+      thread_locators(solid_locator),
+      transfer_outdated(true),
+      indicator_band_outdated(true),
+      step_fluid_previous_delta_t(0),
+      step_solid_records(0),
+      step_fluid_records(0),
+      relaxation(parameters.initial_relaxation),
+      stress_change(0),
+      coupling_log("fsi_coupling_log.csv", mpi_communicator),
+      artificial_weight(0),
       use_dirichlet_bc(use_dirichlet_bc)
   {
+    // Every process locates fluid points in the solid and reads the solid
+    // state, so the fluid must run on all the processes of the coupling and
+    // the solid on all of them or on equal groups of them, each of which
+    // solves the whole solid.
+    int fluid_result;
+    MPI_Comm_compare(
+      mpi_communicator, fluid_solver.mpi_communicator, &fluid_result);
+    AssertThrow(fluid_result == MPI_IDENT || fluid_result == MPI_CONGRUENT,
+                ExcMessage("MPI::FSI requires the fluid solver to run on "
+                           "all processes!"));
+    const unsigned int n_solid_processes =
+      Utilities::MPI::n_mpi_processes(solid_solver.mpi_communicator);
+    AssertThrow(
+      Utilities::MPI::min(n_solid_processes, mpi_communicator) ==
+          Utilities::MPI::max(n_solid_processes, mpi_communicator) &&
+        Utilities::MPI::n_mpi_processes(mpi_communicator) %
+            n_solid_processes ==
+          0,
+      ExcMessage("MPI::FSI requires the solid solver to run on all "
+                 "processes or on groups of the same size that cover them!"));
+    solid_subdomain_processes.resize(n_solid_processes);
+    const auto solid_ranks = Utilities::MPI::all_gather(
+      mpi_communicator,
+      Utilities::MPI::this_mpi_process(solid_solver.mpi_communicator));
+    for (unsigned int p = 0; p < solid_ranks.size(); ++p)
+      {
+        solid_subdomain_processes[solid_ranks[p]].push_back(p);
+      }
+    AssertThrow(parameters.coupling_iterations == 1 ||
+                  solid_solver.step_repeatable(),
+                ExcMessage("The solid solver cannot repeat a time step, which "
+                           "is required by strong coupling!"));
+    if (parameters.repartition_interval < parameters.end_time)
+      {
+        cell_weight_connection =
+          fluid_solver.triangulation.signals.cell_weight.connect(
+            [this](
+              const typename parallel::distributed::Triangulation<
+                dim>::cell_iterator &cell,
+              const typename parallel::distributed::Triangulation<
+                dim>::CellStatus status) { return cell_weight(cell, status); });
+      }
     solid_box.reinit(2 * dim);
+    solid_solver.time.set_delta_t(parameters.time_step /
+                                  parameters.solid_substeps);
+    Utils::TimingReport::instance().add(
+      "fsi", timer, mpi_communicator, parameters.timing_report);
+    Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
   }
 
   template <int dim>
   void FSI<dim>::move_solid_mesh(bool move_forward)
   {
-    TimerOutput::Scope timer_section(timer, "Move solid mesh");
+    Utils::TimerScope timer_section(timer, "Move solid mesh");
+    if (parameters.solid_eulerian_mapping)
+      {
+        if (move_forward)
+          update_solid_mapping();
+        return;
+      }
     // All gather the information so each process has the entire solution.
-    Vector<double> localized_displacement(solid_solver.current_displacement);
+    Vector<double> &localized_displacement = workspace.solid_displacement;
+    localized_displacement = solid_solver.current_displacement;
     // Exactly the same as the serial version, since we must update the
     // entire graph on every process.
-    std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
-                                     false);
+    std::vector<bool> &vertex_touched = workspace.vertex_touched;
+    vertex_touched.assign(solid_solver.triangulation.n_vertices(), false);
     for (auto cell = solid_solver.dof_handler.begin_active();
          cell != solid_solver.dof_handler.end();
          ++cell)
@@ -69,9 +136,104 @@ namespace MPI
       }
   }
 
+  template <int dim>
+  void FSI<dim>::update_solid_mapping()
+  {
+    // All gather the displacement, the mapping reads it on every cell.
+    solid_euler_displacement = solid_solver.current_displacement;
+    if (!solid_mapping)
+      {
+        solid_mapping =
+          std::make_unique<MappingQEulerian<dim, Vector<double>>>(
+            1, solid_solver.dof_handler, solid_euler_displacement);
+      }
+    // The vertices are displaced in the same way as move_solid_mesh, which
+    // is also where a degree 1 mapping puts them.
+    const std::vector<Point<dim>> &reference_vertices =
+      solid_solver.triangulation.get_vertices();
+    if (solid_vertices.size() != reference_vertices.size())
+      {
+        solid_vertices.reinit(mpi_communicator,
+                              reference_vertices.size(),
+                              parameters.node_shared_solid_geometry);
+      }
+    if (solid_vertices.is_writer())
+      {
+        std::copy(reference_vertices.begin(),
+                  reference_vertices.end(),
+                  solid_vertices.data());
+        std::vector<bool> &vertex_touched = workspace.vertex_touched;
+        vertex_touched.assign(reference_vertices.size(), false);
+        for (auto cell = solid_solver.dof_handler.begin_active();
+             cell != solid_solver.dof_handler.end();
+             ++cell)
+          {
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                const unsigned int index = cell->vertex_index(v);
+                if (!vertex_touched[index])
+                  {
+                    vertex_touched[index] = true;
+                    for (unsigned int d = 0; d < dim; ++d)
+                      {
+                        solid_vertices[index][d] += solid_euler_displacement(
+                          cell->vertex_dof_index(v, d));
+                      }
+                  }
+              }
+          }
+      }
+    solid_vertices.synchronize();
+  }
+
+  template <int dim>
+  const Point<dim> &FSI<dim>::solid_vertex(const unsigned int index) const
+  {
+    return solid_mapping ? solid_vertices[index]
+                         : solid_solver.triangulation.get_vertices()[index];
+  }
+
+  template <int dim>
+  void FSI<dim>::print_memory_usage() const
+  {
+    Utils::MemoryReport report("FSI", mpi_communicator);
+    fluid_solver.add_memory_usage(report);
+    solid_solver.add_memory_usage(report);
+    report.add("FSI transfer",
+               transfer_sparsity.memory_consumption() +
+                 transfer_matrix.memory_consumption() +
+                 transfer_displacement.memory_consumption() +
+                 MemoryConsumption::memory_consumption(transfer_support));
+    report.add("FSI coupling vectors",
+               coupled_solid_velocity.memory_consumption() +
+                 coupled_solid_acceleration.memory_consumption() +
+                 step_displacement.memory_consumption() +
+                 step_velocity.memory_consumption() +
+                 step_acceleration.memory_consumption() +
+                 step_fluid_solution.memory_consumption() +
+                 step_fluid_increment.memory_consumption() +
+                 step_fluid_previous.memory_consumption() +
+                 solid_euler_displacement.memory_consumption() +
+                 solid_vertices.memory_consumption() +
+                 MemoryConsumption::memory_consumption(relaxed_stress) +
+                 MemoryConsumption::memory_consumption(stress_residual));
+    report.add("FSI coupling workspace",
+               MemoryConsumption::memory_consumption(workspace.dof_touched) +
+                 workspace.fsi_acceleration.memory_consumption() +
+                 workspace.solid_displacement.memory_consumption() +
+                 workspace.updated_displacement.memory_consumption() +
+                 MemoryConsumption::memory_consumption(
+                   workspace.vertex_touched) +
+                 MemoryConsumption::memory_consumption(
+                   workspace.solid_values));
+    report.print(std::cout);
+  }
+
   template <int dim>
   void FSI<dim>::collect_solid_boundaries()
   {
+    Utils::StartupScope startup("fsi collect_solid_boundaries");
     if (dim == 2)
       for (auto cell = solid_solver.triangulation.begin_active();
            cell != solid_solver.triangulation.end();
@@ -91,17 +253,17 @@ namespace MPI
   void FSI<dim>::update_solid_box()
   {
     move_solid_mesh(true);
+    const unsigned int n_vertices = solid_solver.triangulation.n_vertices();
+    const Point<dim> *vertices =
+      solid_mapping ? solid_vertices.data()
+                    : solid_solver.triangulation.get_vertices().data();
     solid_box = 0;
     for (unsigned int i = 0; i < dim; ++i)
       {
-        solid_box(2 * i) =
-          solid_solver.triangulation.get_vertices().begin()->operator()(i);
-        solid_box(2 * i + 1) =
-          solid_solver.triangulation.get_vertices().begin()->operator()(i);
+        solid_box(2 * i) = vertices->operator()(i);
+        solid_box(2 * i + 1) = vertices->operator()(i);
       }
-    for (auto v = solid_solver.triangulation.get_vertices().begin();
-         v != solid_solver.triangulation.get_vertices().end();
-         ++v)
+    for (auto v = vertices; v != vertices + n_vertices; ++v)
       {
         for (unsigned int i = 0; i < dim; ++i)
           {
@@ -111,12 +273,110 @@ namespace MPI
               solid_box(2 * i + 1) = (*v)(i);
           }
       }
+    // Without the Eulerian mapping, the indices read the moved triangulation.
+    if (dim == 2)
+      boundary_index.reinit(solid_boundaries,
+                            solid_mapping ? solid_vertices.data() : nullptr);
+    else
+      solid_cell_index.reinit(solid_solver.dof_handler, solid_mapping.get());
+    update_solid_coupling_dofs();
     move_solid_mesh(false);
   }
 
+  template <int dim>
+  void FSI<dim>::update_solid_coupling_dofs()
+  {
+    // The box that contains the non-artificial fluid cells, padded by the
+    // largest fluid cell diameter to account for curved fluid cells.
+    Point<dim> lower, upper;
+    double padding = 0;
+    bool first_vertex = true;
+    for (auto f_cell : fluid_solver.dof_handler.active_cell_iterators())
+      {
+        if (f_cell->is_artificial())
+          continue;
+        padding = std::max(padding, f_cell->diameter());
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            const Point<dim> &vertex = f_cell->vertex(v);
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                if (first_vertex || vertex[d] < lower[d])
+                  lower[d] = vertex[d];
+                if (first_vertex || vertex[d] > upper[d])
+                  upper[d] = vertex[d];
+              }
+            first_vertex = false;
+          }
+      }
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        lower[d] -= padding;
+        upper[d] += padding;
+      }
+
+    IndexSet coupling_dofs(solid_solver.dof_handler.n_dofs());
+    std::vector<types::global_dof_index> dof_indices(
+      solid_solver.fe.dofs_per_cell);
+    if (!first_vertex)
+      {
+        for (auto s_cell : solid_solver.dof_handler.active_cell_iterators())
+          {
+            bool overlap = true;
+            for (unsigned int d = 0; d < dim && overlap; ++d)
+              {
+                double s_lower = solid_vertex(s_cell->vertex_index(0))[d];
+                double s_upper = s_lower;
+                for (unsigned int v = 1;
+                     v < GeometryInfo<dim>::vertices_per_cell;
+                     ++v)
+                  {
+                    const double x = solid_vertex(s_cell->vertex_index(v))[d];
+                    s_lower = std::min(s_lower, x);
+                    s_upper = std::max(s_upper, x);
+                  }
+                overlap = s_upper >= lower[d] && s_lower <= upper[d];
+              }
+            if (!overlap)
+              continue;
+            s_cell->get_dof_indices(dof_indices);
+            coupling_dofs.add_indices(dof_indices.begin(), dof_indices.end());
+          }
+      }
+    // The columns of an existing transfer operator must stay readable until
+    // it is rebuilt, even if the solid has moved away from them.
+    if (parameters.transfer_rebuild_distance > 0 && !transfer_outdated &&
+        transfer_sparsity.n_cols() == solid_solver.dof_handler.n_dofs())
+      {
+        for (auto entry = transfer_sparsity.begin();
+             entry != transfer_sparsity.end();
+             ++entry)
+          {
+            coupling_dofs.add_index(entry->column());
+          }
+      }
+    coupling_dofs.compress();
+
+    // Reallocating the ghosted vectors is only necessary when the set or the
+    // solid partition changes.
+    if (solid_coupling_dofs.size() == coupling_dofs.size() &&
+        solid_coupling_dofs == coupling_dofs &&
+        coupled_solid_velocity.locally_owned_elements() ==
+          solid_solver.locally_owned_dofs)
+      return;
+    solid_coupling_dofs = coupling_dofs;
+    coupled_solid_velocity.reinit(solid_solver.locally_owned_dofs,
+                                  solid_coupling_dofs,
+                                  solid_solver.mpi_communicator);
+    coupled_solid_acceleration.reinit(solid_solver.locally_owned_dofs,
+                                      solid_coupling_dofs,
+                                      solid_solver.mpi_communicator);
+  }
+
   template <int dim>
   void FSI<dim>::update_vertices_mask()
   {
+    Utils::StartupScope startup("fsi update_vertices_mask");
     // Initilize vertices mask
     vertices_mask.clear();
     vertices_mask.resize(fluid_solver.triangulation.n_vertices(), false);
@@ -133,10 +393,36 @@ namespace MPI
             vertices_mask[cell->vertex_index(v)] = true;
           }
       }
+
+    // An empty box if there is no locally owned cell.
+    fluid_owned_box.reinit(2 * dim);
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        fluid_owned_box(2 * i) = std::numeric_limits<double>::max();
+        fluid_owned_box(2 * i + 1) = -std::numeric_limits<double>::max();
+      }
+    const auto &vertices = fluid_solver.triangulation.get_vertices();
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+      {
+        if (!vertices_mask[v])
+          {
+            continue;
+          }
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            fluid_owned_box(2 * i) =
+              std::min(fluid_owned_box(2 * i), vertices[v](i));
+            fluid_owned_box(2 * i + 1) =
+              std::max(fluid_owned_box(2 * i + 1), vertices[v](i));
+          }
+      }
+    // The hints point to cells that may no longer exist.
+    solid_boundary_hints.clear();
+    fluid_locator.reinit();
   }
 
   template <int dim>
-  bool FSI<dim>::point_in_solid(const DoFHandler<dim> &df,
+  bool FSI<dim>::point_in_solid(const DoFHandler<dim> &,
                                 const Point<dim> &point)
   {
     // Check whether the point is in the solid box first.
@@ -146,82 +432,36 @@ namespace MPI
           return false;
       }
 
-    // Compute its angle to each boundary face
+    // Count the boundary faces crossed by a ray from the point, only the
+    // faces close to the ray are visited.
     if (dim == 2)
-      {
-        unsigned int cross_number = 0;
-        unsigned int half_cross_number = 0;
-        for (auto f = solid_boundaries.begin(); f != solid_boundaries.end();
-             ++f)
-          {
-            Point<dim> p1 = (*f)->vertex(0), p2 = (*f)->vertex(1);
-            double y_diff1 = p1(1) - point(1);
-            double y_diff2 = p2(1) - point(1);
-            double x_diff1 = p1(0) - point(0);
-            double x_diff2 = p2(0) - point(0);
-            Tensor<1, dim> r1 = p1 - p2;
-            Tensor<1, dim> r2;
-            // r1[1] == 0 if the boundary is horizontal
-            if (r1[1] != 0.0)
-              r2 = r1 * (point(1) - p2(1)) / r1[1];
-            if (y_diff1 * y_diff2 < 0)
-              {
-                // Point is on the left of the boundary
-                if (r2[0] + p2(0) > point(0))
-                  {
-                    ++cross_number;
-                  }
-                // Point is on the boundary
-                else if (r2[0] + p2(0) == point(0))
-                  {
-                    return true;
-                  }
-              }
-            // Point is on the same horizontal line with one of the vertices
-            else if (y_diff1 * y_diff2 == 0)
-              {
-                // The boundary is horizontal
-                if (y_diff1 == 0 && y_diff2 == 0)
-                  // The point is on it
-                  if (x_diff1 * x_diff2 < 0)
-                    {
-                      return true;
-                    }
-                  // The point is not on it
-                  else
-                    continue;
-                // On the left of the boundary
-                else if (r2[0] + p2(0) > point(0))
-                  { // The point must not be on the top or bottom of the box
-                    // (because it can be tangential)
-                    if (point(1) != solid_box(2) && point(1) != solid_box(3))
-                      ++half_cross_number;
-                  }
-                // Point overlaps with the vertex
-                else if (point == p1 || point == p2)
-                  {
-                    return true;
-                  }
-              }
-          }
-        cross_number += half_cross_number / 2;
-        if (cross_number % 2 == 0)
-          return false;
-        return true;
-      }
-    for (auto cell = df.begin_active(); cell != df.end(); ++cell)
-      {
-        if (cell->point_inside(point))
-          {
-            return true;
-          }
-      }
-    return false;
+      return boundary_index.point_inside(point);
+    // Otherwise only test the solid cells whose bounding boxes contain
+    // the point.
+    return solid_cell_index.point_inside(point);
+  }
+
+  template <int dim>
+  void FSI<dim>::setup_coupling_workspace()
+  {
+    // The flags only cover the locally relevant fluid dofs, which are all
+    // the dofs of the cells that are not artificial.
+    workspace.dof_touched.assign(
+      fluid_solver.locally_relevant_dofs.n_elements(), 0);
+    // The jobs hold iterators of the old mesh.
+    workspace.jobs.clear();
+    workspace.n_jobs = 0;
+    workspace.fsi_acceleration.reinit(fluid_solver.owned_partitioning,
+                                      fluid_solver.mpi_communicator);
+    // The solid mesh is not refined, so the solid buffers keep their sizes
+    // once they are used.
+    workspace.point_value.reinit(dim + 1);
   }
 
   template <int dim>
   void FSI<dim>::setup_cell_hints()
   {
+    Utils::StartupScope startup("fsi setup_cell_hints");
     unsigned int n_unit_points =
       fluid_solver.fe.get_unit_support_points().size();
     for (auto cell = fluid_solver.triangulation.begin_active();
@@ -249,9 +489,13 @@ namespace MPI
   void FSI<dim>::update_solid_displacement()
   {
     move_solid_mesh(true);
-    Vector<double> localized_solid_displacement(
-      solid_solver.current_displacement);
-    std::vector<bool> vertex_touched(solid_solver.dof_handler.n_dofs(), false);
+    // move_solid_mesh overwrites workspace.solid_displacement.
+    Vector<double> &localized_solid_displacement =
+      workspace.updated_displacement;
+    localized_solid_displacement = solid_solver.current_displacement;
+    std::vector<bool> &vertex_touched = workspace.vertex_touched;
+    vertex_touched.assign(solid_solver.triangulation.n_vertices(), false);
+    Vector<double> &tmp = workspace.point_value;
     for (auto cell : solid_solver.dof_handler.active_cell_iterators())
       {
         for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
@@ -260,8 +504,7 @@ namespace MPI
                 !solid_solver.constraints.is_constrained(cell->vertex_index(v)))
               {
                 vertex_touched[cell->vertex_index(v)] = true;
-                Point<dim> point = cell->vertex(v);
-                Vector<double> tmp(dim + 1);
+                Point<dim> point = solid_vertex(cell->vertex_index(v));
                 VectorTools::point_value(fluid_solver.dof_handler,
                                          fluid_solver.present_solution,
                                          point,
@@ -287,29 +530,96 @@ namespace MPI
   template <int dim>
   void FSI<dim>::update_indicator()
   {
-    TimerOutput::Scope timer_section(timer, "Update indicator");
+    Utils::TimerScope timer_section(timer, "Update indicator");
+    OPENIFEM_KERNEL_SCOPE("fsi_update_indicator");
     move_solid_mesh(true);
-    for (auto f_cell = fluid_solver.dof_handler.begin_active();
-         f_cell != fluid_solver.dof_handler.end();
-         ++f_cell)
+    // Every cell only writes its own indicator, so the cells are classified
+    // on multiple threads.
+    auto classify =
+      [this](const std::vector<typename DoFHandler<dim>::active_cell_iterator>
+               &cells) {
+        parallel::apply_to_subranges(
+          0u,
+          static_cast<unsigned int>(cells.size()),
+          [&](const unsigned int begin, const unsigned int end) {
+            for (unsigned int c = begin; c < end; ++c)
+              {
+                int inside_count = 0;
+                for (unsigned int v = 0;
+                     v < GeometryInfo<dim>::vertices_per_cell;
+                     ++v)
+                  {
+                    if (!point_in_solid(solid_solver.dof_handler,
+                                        cells[c]->vertex(v)))
+                      {
+                        break;
+                      }
+                    ++inside_count;
+                  }
+                fluid_solver.cell_property.set_indicator(
+                  cells[c],
+                  inside_count == GeometryInfo<dim>::vertices_per_cell ? 1 : 0);
+              }
+          },
+          64);
+      };
+    if (!parameters.narrow_band_indicator || indicator_band_outdated)
       {
-        if (!f_cell->is_locally_owned())
-          {
-            continue;
-          }
-        auto p = fluid_solver.cell_property.get_data(f_cell);
-        int inside_count = 0;
-        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+        std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+        for (auto f_cell = fluid_solver.dof_handler.begin_active();
+             f_cell != fluid_solver.dof_handler.end();
+             ++f_cell)
           {
-            if (!point_in_solid(solid_solver.dof_handler, f_cell->vertex(v)))
+            if (!f_cell->is_locally_owned())
               {
-                break;
+                continue;
               }
-            ++inside_count;
+            cells.push_back(f_cell);
+          }
+        classify(cells);
+        if (parameters.narrow_band_indicator)
+          {
+            fluid_cell_index.reinit(fluid_solver.dof_handler);
+            indicator_band.clear();
+            indicator_band_outdated = false;
+          }
+      }
+    else
+      {
+        // The cells that were in the band last time and are not any more
+        // are outside the solid box, thus outside the solid.
+        for (const auto &f_cell : indicator_band)
+          {
+            fluid_solver.cell_property.set_indicator(f_cell, 0);
           }
-        p[0]->indicator =
-          (inside_count == GeometryInfo<dim>::vertices_per_cell ? 1 : 0);
       }
+    if (parameters.narrow_band_indicator)
+      {
+        // Any fluid cell whose indicator may be 1 overlaps the solid box.
+        // The box is enlarged by the distance the solid can travel in one
+        // time step, so the band also covers the cells the solid has just
+        // swept past.
+        const double margin =
+          solid_solver.current_velocity.linfty_norm() * time.get_delta_t();
+        Point<dim> lower, upper;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            lower[d] = solid_box(2 * d) - margin;
+            upper[d] = solid_box(2 * d + 1) + margin;
+          }
+        fluid_cell_index.find_cells(lower, upper, indicator_band);
+        indicator_band.erase(
+          std::remove_if(
+            indicator_band.begin(),
+            indicator_band.end(),
+            [](const typename DoFHandler<dim>::active_cell_iterator &f_cell) {
+              return !f_cell->is_locally_owned();
+            }),
+          indicator_band.end());
+        classify(indicator_band);
+      }
+    // Only the new artificial fluid cells carry FSI terms.
+    fluid_solver.cell_property.update_band();
     move_solid_mesh(false);
   }
 
@@ -318,7 +628,8 @@ namespace MPI
   template <int dim>
   void FSI<dim>::find_fluid_bc()
   {
-    TimerOutput::Scope timer_section(timer, "Find fluid BC");
+    Utils::TimerScope timer_section(timer, "Find fluid BC");
+    OPENIFEM_KERNEL_SCOPE("fsi_find_fluid_bc");
     move_solid_mesh(true);
 
     // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
@@ -328,163 +639,191 @@ namespace MPI
     inner_zero.clear();
     inner_nonzero.reinit(fluid_solver.locally_relevant_dofs);
     inner_zero.reinit(fluid_solver.locally_relevant_dofs);
-    PETScWrappers::MPI::BlockVector tmp_fsi_acceleration;
-    tmp_fsi_acceleration.reinit(fluid_solver.owned_partitioning,
-                                fluid_solver.mpi_communicator);
-
-    Vector<double> localized_solid_velocity(solid_solver.current_velocity);
-    Vector<double> localized_solid_acceleration(
-      solid_solver.current_acceleration);
-    std::vector<std::vector<Vector<double>>> localized_stress(
-      dim, std::vector<Vector<double>>(dim));
-    for (unsigned int i = 0; i < dim; ++i)
-      {
-        for (unsigned int j = 0; j < dim; ++j)
-          {
-            localized_stress[i][j] = solid_solver.stress[i][j];
-          }
-      }
+    PETScWrappers::MPI::BlockVector &tmp_fsi_acceleration =
+      workspace.fsi_acceleration;
+    tmp_fsi_acceleration = 0;
+
+    // Only the solid dofs in solid_coupling_dofs are read, which are
+    // imported with a single ghost update.
+    coupled_solid_velocity = solid_solver.current_velocity;
+    coupled_solid_acceleration = solid_solver.current_acceleration;
 
     const std::vector<Point<dim>> &unit_points =
       fluid_solver.fe.get_unit_support_points();
 
     const FEValuesExtractors::Vector velocities(0);
-    const FEValuesExtractors::Scalar pressure(dim);
-    std::vector<SymmetricTensor<2, dim>> sym_grad_v(unit_points.size());
-    std::vector<double> p(unit_points.size());
     std::vector<Tensor<2, dim>> grad_v(unit_points.size());
     std::vector<Tensor<1, dim>> v(unit_points.size());
 
     MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
     Quadrature<dim> dummy_q(unit_points);
-    FEValues<dim> dummy_fe_values(mapping,
-                                  fluid_solver.fe,
-                                  dummy_q,
-                                  update_quadrature_points | update_values |
-                                    update_gradients);
+    const UpdateFlags flags =
+      update_quadrature_points | update_values | update_gradients;
+    FEValues<dim> dummy_fe_values(mapping, fluid_solver.fe, dummy_q, flags);
     std::vector<types::global_dof_index> dof_indices(
       fluid_solver.fe.dofs_per_cell);
-    std::vector<unsigned int> dof_touched(fluid_solver.dof_handler.n_dofs(), 0);
 
-    for (auto f_cell = fluid_solver.dof_handler.begin_active();
-         f_cell != fluid_solver.dof_handler.end();
-         ++f_cell)
+    const std::vector<const PETScWrappers::MPI::Vector *> solid_state = {
+      &coupled_solid_acceleration, &coupled_solid_velocity};
+    std::vector<std::vector<Vector<double>>> &solid_values =
+      workspace.solid_values;
+
+    if (parameters.transfer_rebuild_distance > 0)
       {
-        // Use is_artificial() instead of !is_locally_owned() because ghost
-        // elements must be taken care of to set correct Dirichlet BCs!
-        if (f_cell->is_artificial())
+        if (transfer_operator_outdated())
+          assemble_transfer_operator();
+        // Interpolate the solid acceleration and velocity to all the
+        // artificial fluid support points. This is a mat-vec with the
+        // operator, whose columns are all ghosted in the solid state.
+        Vector<double> &solid_acc = workspace.solid_acc;
+        Vector<double> &solid_vel = workspace.solid_vel;
+        solid_acc.reinit(transfer_support.size(), true);
+        solid_vel.reinit(transfer_support.size(), true);
+        solid_acc = 0;
+        solid_vel = 0;
+        for (unsigned int k = 0; k < transfer_support.size(); ++k)
           {
-            continue;
+            for (auto entry = transfer_matrix.begin(k);
+                 entry != transfer_matrix.end(k);
+                 ++entry)
+              {
+                solid_acc[k] +=
+                  entry->value() * coupled_solid_acceleration(entry->column());
+                solid_vel[k] +=
+                  entry->value() * coupled_solid_velocity(entry->column());
+              }
           }
-        // Now skip the ghost elements because it's not store in cell property.
-        if (!use_dirichlet_bc && f_cell->is_locally_owned())
+        for (unsigned int k = 0; k < transfer_support.size(); ++k)
           {
-            auto ptr = fluid_solver.cell_property.get_data(f_cell);
-            if (ptr[0]->indicator == 0)
-              continue;
-
-            auto hints = cell_hints.get_data(f_cell);
-            dummy_fe_values.reinit(f_cell);
-            f_cell->get_dof_indices(dof_indices);
-            auto support_points = dummy_fe_values.get_quadrature_points();
-            // Fluid velocity at support points
-            dummy_fe_values[velocities].get_function_values(
-              fluid_solver.present_solution, v);
-            // Fluid velocity gradient at support points
-            dummy_fe_values[velocities].get_function_gradients(
-              fluid_solver.present_solution, grad_v);
-            // Fluid symmetric velocity gradient at support points
-            dummy_fe_values[velocities].get_function_symmetric_gradients(
-              fluid_solver.present_solution, sym_grad_v);
-            // Fluid pressure at support points
-            dummy_fe_values[pressure].get_function_values(
-              fluid_solver.present_solution, p);
-            // Loop over the support points to calculate fsi acceleration.
-            for (unsigned int i = 0; i < unit_points.size(); ++i)
+            const auto &f_cell = transfer_cells[k];
+            // The rows of the same fluid cell are contiguous.
+            if (k == 0 || f_cell != transfer_cells[k - 1])
               {
-                // Skip the already-set dofs.
-                if (dof_touched[dof_indices[i]] != 0)
-                  continue;
-                auto base_index = fluid_solver.fe.system_to_base_index(i);
-                const unsigned int i_group = base_index.first.first;
-                Assert(i_group < 2,
-                       ExcMessage(
-                         "There should be only 2 groups of finite element!"));
-                if (i_group == 1)
-                  continue; // skip the pressure dofs
-                bool inside = true;
-                for (unsigned int d = 0; d < dim; ++d)
-                  if (std::abs(unit_points[i][d]) < 1e-5)
-                    {
-                      inside = false;
-                      break;
-                    }
-                if (inside)
-                  continue; // skip the in-cell support point
-                // Same as fluid_solver.fe.system_to_base_index(i).first.second;
-                const unsigned int index =
-                  fluid_solver.fe.system_to_component_index(i).first;
-                Assert(index < dim,
-                       ExcMessage("Vector component should be less than dim!"));
-                dof_touched[dof_indices[i]] = 1;
-                if (!point_in_solid(solid_solver.dof_handler,
-                                    support_points[i]))
-                  continue;
-                Utils::CellLocator<dim, DoFHandler<dim>> locator(
-                  solid_solver.dof_handler, support_points[i], *(hints[i]));
-                *(hints[i]) = locator.search();
-                Utils::GridInterpolator<dim, Vector<double>> interpolator(
-                  solid_solver.dof_handler, support_points[i], {}, *(hints[i]));
-                if (!interpolator.found_cell())
+                dummy_fe_values.reinit(f_cell);
+                f_cell->get_dof_indices(dof_indices);
+                if (!use_dirichlet_bc)
                   {
-                    std::stringstream message;
-                    message
-                      << "Cannot find point in solid: " << support_points[i]
-                      << std::endl;
-                    AssertThrow(interpolator.found_cell(),
-                                ExcMessage(message.str()));
-                  }
-                // Solid acceleration at fluid unit point
-                Vector<double> solid_acc(dim);
-                Vector<double> solid_vel(dim);
-                interpolator.point_value(localized_solid_acceleration,
-                                         solid_acc);
-                interpolator.point_value(localized_solid_velocity, solid_vel);
-                Tensor<1, dim> vs;
-                for (int j = 0; j < dim; ++j)
-                  {
-                    vs[j] = solid_vel[j];
+                    dummy_fe_values[velocities].get_function_values(
+                      fluid_solver.present_solution, v);
+                    dummy_fe_values[velocities].get_function_gradients(
+                      fluid_solver.present_solution, grad_v);
                   }
+              }
+            const unsigned int i = transfer_support[k];
+            const unsigned int index =
+              fluid_solver.fe.system_to_component_index(i).first;
+            auto line = dof_indices[i];
+            if (use_dirichlet_bc)
+              {
+                inner_nonzero.add_line(line);
+                inner_zero.add_line(line);
+                inner_nonzero.set_inhomogeneity(
+                  line, solid_vel[k] - fluid_solver.present_solution(line));
+              }
+            else
+              {
                 // Fluid total acceleration at support points
-                Tensor<1, dim> fluid_acc =
-                  (vs - v[i]) / time.get_delta_t() + grad_v[i] * v[i];
-                auto line = dof_indices[i];
-                // Note that we are setting the value of the constraint to the
-                // velocity delta!
-                tmp_fsi_acceleration(line) =
-                  fluid_acc[index] - solid_acc[index];
+                const double fluid_acc =
+                  (solid_vel[k] - v[i][index]) / time.get_delta_t() +
+                  (grad_v[i] * v[i])[index];
+                tmp_fsi_acceleration(line) = fluid_acc - solid_acc[k];
               }
           }
-        // Dirichlet BCs
-        if (use_dirichlet_bc)
+      }
+    else
+      {
+        using Job = typename CouplingWorkspace::Job;
+        // Every thread evaluates the fluid cells with its own FEValues.
+        struct ScratchData
+        {
+          ScratchData(const Mapping<dim> &mapping,
+                      const FiniteElement<dim> &fe,
+                      const Quadrature<dim> &quad,
+                      const UpdateFlags flags)
+            : fe_values(mapping, fe, quad, flags),
+              v(quad.size()),
+              grad_v(quad.size())
+          {
+          }
+          ScratchData(const ScratchData &scratch)
+            : fe_values(scratch.fe_values.get_mapping(),
+                        scratch.fe_values.get_fe(),
+                        scratch.fe_values.get_quadrature(),
+                        scratch.fe_values.get_update_flags()),
+              v(scratch.v),
+              grad_v(scratch.grad_v)
           {
-            dummy_fe_values.reinit(f_cell);
+          }
+          FEValues<dim> fe_values;
+          std::vector<Tensor<1, dim>> v;
+          std::vector<Tensor<2, dim>> grad_v;
+          std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+        };
+        // The support points of a fluid cell that are inside the solid,
+        // located in the solid but not yet evaluated.
+        struct CopyData
+        {
+          CopyData(const DoFHandler<dim> &solid_dof_handler,
+                   const Mapping<dim> *solid_mapping)
+            : interpolator(solid_dof_handler, {}, solid_mapping)
+          {
+          }
+          typename DoFHandler<dim>::active_cell_iterator cell;
+          std::vector<unsigned int> support;
+          std::vector<Point<dim>> points;
+          // Fluid velocity and convective acceleration at the points
+          std::vector<Tensor<1, dim>> v;
+          std::vector<Tensor<1, dim>> convection;
+          Utils::BatchedGridInterpolator<dim, PETScWrappers::MPI::Vector>
+            interpolator;
+        };
+
+        // Decide the support points of every fluid cell first, so that no
+        // two cells set the same dof and the cells can be processed on
+        // multiple threads. A dof is set by the first cell that sees it.
+        // The jobs of the previous step are reused with their buffers.
+        std::vector<unsigned char> &dof_touched = workspace.dof_touched;
+        std::fill(dof_touched.begin(), dof_touched.end(), 0);
+        std::vector<Job> &jobs = workspace.jobs;
+        workspace.n_jobs = 0;
+        for (auto f_cell = fluid_solver.dof_handler.begin_active();
+             f_cell != fluid_solver.dof_handler.end();
+             ++f_cell)
+          {
+            // Use is_artificial() instead of !is_locally_owned() because ghost
+            // elements must be taken care of to set correct Dirichlet BCs!
+            if (f_cell->is_artificial())
+              {
+                continue;
+              }
+            // Now skip the ghost elements because it's not store in cell
+            // property.
+            if (!use_dirichlet_bc)
+              {
+                if (!f_cell->is_locally_owned())
+                  continue;
+                if (fluid_solver.cell_property.indicator(f_cell) == 0)
+                  continue;
+              }
             f_cell->get_dof_indices(dof_indices);
-            auto support_points = dummy_fe_values.get_quadrature_points();
-            auto hints = cell_hints.get_data(f_cell);
-            // Declare the fluid velocity for interpolating BC
-            Vector<double> fluid_velocity(dim);
-            // Loop over the support points to set Dirichlet BCs.
+            if (workspace.n_jobs == jobs.size())
+              jobs.emplace_back();
+            Job &job = jobs[workspace.n_jobs];
+            job.cell = f_cell;
+            job.support.clear();
             for (unsigned int i = 0; i < unit_points.size(); ++i)
               {
+                const unsigned int relevant_index =
+                  fluid_solver.locally_relevant_dofs.index_within_set(
+                    dof_indices[i]);
                 // Skip the already-set dofs.
-                if (dof_touched[dof_indices[i]] != 0)
+                if (dof_touched[relevant_index] != 0)
                   continue;
                 auto base_index = fluid_solver.fe.system_to_base_index(i);
                 const unsigned int i_group = base_index.first.first;
                 Assert(i_group < 2,
-                       ExcMessage(
-                         "There should be only 2 groups of finite element!"));
+                       ExcMessage("There should be only 2 groups of "
+                                  "finite element!"));
                 if (i_group == 1)
                   continue; // skip the pressure dofs
                 bool inside = true;
@@ -496,41 +835,126 @@ namespace MPI
                     }
                 if (inside)
                   continue; // skip the in-cell support point
-                // Same as fluid_solver.fe.system_to_base_index(i).first.second;
-                const unsigned int index =
-                  fluid_solver.fe.system_to_component_index(i).first;
-                Assert(index < dim,
+                // Same as
+                // fluid_solver.fe.system_to_base_index(i).first.second;
+                Assert(fluid_solver.fe.system_to_component_index(i).first < dim,
                        ExcMessage("Vector component should be less than dim!"));
-                dof_touched[dof_indices[i]] = 1;
-                if (!point_in_solid(solid_solver.dof_handler,
-                                    support_points[i]))
-                  continue;
-                Utils::CellLocator<dim, DoFHandler<dim>> locator(
-                  solid_solver.dof_handler, support_points[i], *(hints[i]));
-                *(hints[i]) = locator.search();
-                Utils::GridInterpolator<dim, Vector<double>> interpolator(
-                  solid_solver.dof_handler, support_points[i], {}, *(hints[i]));
-                if (!interpolator.found_cell())
-                  {
-                    std::stringstream message;
-                    message
-                      << "Cannot find point in solid: " << support_points[i]
-                      << std::endl;
-                    AssertThrow(interpolator.found_cell(),
-                                ExcMessage(message.str()));
-                  }
-                interpolator.point_value(localized_solid_velocity,
-                                         fluid_velocity);
-                auto line = dof_indices[i];
-                inner_nonzero.add_line(line);
-                inner_zero.add_line(line);
-                // Note that we are setting the value of the constraint to the
-                // velocity delta!
-                inner_nonzero.set_inhomogeneity(
-                  line,
-                  fluid_velocity[index] - fluid_solver.present_solution(line));
+                dof_touched[relevant_index] = 1;
+                job.support.push_back(i);
               }
+            if (job.support.empty())
+              continue;
+            // PETSc vectors are not thread-safe, so the fluid solution is
+            // read here.
+            if (!use_dirichlet_bc)
+              {
+                job.fluid_values.reinit(fluid_solver.fe.dofs_per_cell, true);
+                f_cell->get_dof_values(fluid_solver.present_solution,
+                                       job.fluid_values);
+              }
+            ++workspace.n_jobs;
           }
+
+        // Locate the support points in the solid on multiple threads, the
+        // hints of a fluid cell are only touched by the thread processing it.
+        auto worker = [&](const typename std::vector<Job>::const_iterator &job,
+                          ScratchData &scratch,
+                          CopyData &copy) {
+          copy.cell = job->cell;
+          copy.support.clear();
+          copy.points.clear();
+          copy.v.clear();
+          copy.convection.clear();
+          scratch.cells.clear();
+          scratch.fe_values.reinit(job->cell);
+          const std::vector<Point<dim>> &support_points =
+            scratch.fe_values.get_quadrature_points();
+          if (!use_dirichlet_bc)
+            {
+              // Fluid velocity at support points
+              scratch.fe_values[velocities]
+                .get_function_values_from_local_dof_values(job->fluid_values,
+                                                           scratch.v);
+              // Fluid velocity gradient at support points
+              scratch.fe_values[velocities]
+                .get_function_gradients_from_local_dof_values(
+                  job->fluid_values, scratch.grad_v);
+            }
+          auto hints = cell_hints.get_data(job->cell);
+          auto &locator = thread_locators.get();
+          for (const auto i : job->support)
+            {
+              if (!point_in_solid(solid_solver.dof_handler, support_points[i]))
+                continue;
+              *(hints[i]) = locator.search(
+                support_points[i], *(hints[i]), solid_mapping.get());
+              copy.support.push_back(i);
+              copy.points.push_back(support_points[i]);
+              scratch.cells.push_back(*(hints[i]));
+              if (!use_dirichlet_bc)
+                {
+                  copy.v.push_back(scratch.v[i]);
+                  copy.convection.push_back(scratch.grad_v[i] * scratch.v[i]);
+                }
+            }
+          if (!copy.support.empty())
+            copy.interpolator.reinit(copy.points, scratch.cells);
+        };
+
+        // Interpolate the solid acceleration and velocity at the support
+        // points of one fluid cell and set the fluid BCs, in the order of
+        // the fluid cells.
+        auto copier = [&](const CopyData &copy) {
+          if (copy.support.empty())
+            return;
+          copy.interpolator.point_values(solid_state, solid_values);
+          copy.cell->get_dof_indices(dof_indices);
+          for (unsigned int k = 0; k < copy.support.size(); ++k)
+            {
+              const unsigned int i = copy.support[k];
+              if (!copy.interpolator.found_cell(k))
+                {
+                  std::stringstream message;
+                  message << "Cannot find point in solid: " << copy.points[k]
+                          << std::endl;
+                  AssertThrow(copy.interpolator.found_cell(k),
+                              ExcMessage(message.str()));
+                }
+              const unsigned int index =
+                fluid_solver.fe.system_to_component_index(i).first;
+              // Solid acceleration and velocity at fluid unit point
+              const Vector<double> &solid_acc = solid_values[0][k];
+              const Vector<double> &solid_vel = solid_values[1][k];
+              auto line = dof_indices[i];
+              if (use_dirichlet_bc)
+                {
+                  inner_nonzero.add_line(line);
+                  inner_zero.add_line(line);
+                  // Note that we are setting the value of the constraint to
+                  // the velocity delta!
+                  inner_nonzero.set_inhomogeneity(
+                    line,
+                    solid_vel[index] - fluid_solver.present_solution(line));
+                }
+              else
+                {
+                  // Fluid total acceleration at support points
+                  const double fluid_acc =
+                    (solid_vel[index] - copy.v[k][index]) /
+                      time.get_delta_t() +
+                    copy.convection[k][index];
+                  tmp_fsi_acceleration(line) = fluid_acc - solid_acc[index];
+                }
+            }
+        };
+
+        WorkStream::run(
+          jobs.cbegin(),
+          jobs.cbegin() + workspace.n_jobs,
+          worker,
+          copier,
+          ScratchData(mapping, fluid_solver.fe, dummy_q, flags),
+          CopyData(solid_solver.dof_handler, solid_mapping.get()));
       }
     tmp_fsi_acceleration.compress(VectorOperation::insert);
     fluid_solver.fsi_acceleration = tmp_fsi_acceleration;
@@ -551,7 +975,8 @@ namespace MPI
   template <int dim>
   void FSI<dim>::find_solid_bc()
   {
-    TimerOutput::Scope timer_section(timer, "Find solid BC");
+    Utils::TimerScope timer_section(timer, "Find solid BC");
+    OPENIFEM_KERNEL_SCOPE("fsi_find_solid_bc");
     // Must use the updated solid coordinates
     move_solid_mesh(true);
     // Fluid FEValues to do interpolation
@@ -563,6 +988,15 @@ namespace MPI
         solid_solver.fsi_stress_rows[d] = 0;
       }
 
+    // Collect the boundary vertices first so that the fluid solution is
+    // interpolated at all of them in one batch.
+    std::vector<Point<dim>> points;
+    std::vector<types::global_dof_index> lines;
+    // The solid subdomains that read the FSI stress at every point, i.e., the
+    // subdomains of the solid cells whose boundary faces contain the point.
+    std::vector<std::vector<unsigned int>> readers;
+    std::vector<unsigned int> point_index(solid_solver.dof_handler.n_dofs(),
+                                          numbers::invalid_unsigned_int);
     for (auto s_cell = solid_solver.dof_handler.begin_active();
          s_cell != solid_solver.dof_handler.end();
          ++s_cell)
@@ -577,63 +1011,525 @@ namespace MPI
                      ++v)
                   {
                     auto line = s_cell->face(f)->vertex_dof_index(v, 0);
-                    // Get interpolated solution from the fluid
-                    Vector<double> value(dim + 1);
-                    Utils::GridInterpolator<dim,
-                                            PETScWrappers::MPI::BlockVector>
-                      interpolator(fluid_solver.dof_handler,
-                                   s_cell->face(f)->vertex(v),
-                                   vertices_mask);
-                    interpolator.point_value(fluid_solver.present_solution,
-                                             value);
-                    std::vector<Tensor<1, dim>> gradient(dim + 1,
-                                                         Tensor<1, dim>());
-                    interpolator.point_gradient(fluid_solver.present_solution,
-                                                gradient);
-                    // Compute stress
-                    SymmetricTensor<2, dim> sym_deformation;
-                    for (unsigned int i = 0; i < dim; ++i)
-                      {
-                        for (unsigned int j = 0; j < dim; ++j)
-                          {
-                            sym_deformation[i][j] =
-                              (gradient[i][j] + gradient[j][i]) / 2;
-                          }
-                      }
-                    // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
-                    SymmetricTensor<2, dim> stress =
-                      -value[dim] *
-                        Physics::Elasticity::StandardTensors<dim>::I +
-                      2 * parameters.viscosity * sym_deformation;
-                    // Assign the cell stress to local row vectors
-                    for (unsigned int d1 = 0; d1 < dim; ++d1)
+                    if (point_index[line] == numbers::invalid_unsigned_int)
                       {
-                        for (unsigned int d2 = 0; d2 < dim; ++d2)
-                          {
-                            solid_solver.fsi_stress_rows[d1][line + d2] =
-                              stress[d1][d2];
-                          }
+                        point_index[line] = points.size();
+                        lines.push_back(line);
+                        points.push_back(
+                          solid_vertex(s_cell->face(f)->vertex_index(v)));
+                        readers.emplace_back();
                       }
-                    // End assigning local fluid stress values
-                  } // End looping support points
+                    auto &r = readers[point_index[line]];
+                    if (std::find(r.begin(), r.end(), s_cell->subdomain_id()) ==
+                        r.end())
+                      r.push_back(s_cell->subdomain_id());
+                  }
               }
           } // End looping cell faces
       }     // End looping solid cells
-    // Add up the local vectors
-    for (unsigned int d = 0; d < dim; ++d)
+
+    // The points where the fluid stress is evaluated, and the boundary
+    // vertices it is lumped to with their weights. They are either the
+    // vertices themselves, or the quadrature points of the boundary faces,
+    // whose stress is lumped to the vertices of the face with the integrals
+    // of the linear shape functions. The solid then reads the lumped stress
+    // as before.
+    std::vector<Point<dim>> eval_points;
+    std::vector<std::vector<std::pair<unsigned int, double>>> lumping;
+    if (parameters.traction_evaluation == "Vertices")
       {
-        Utilities::MPI::sum(solid_solver.fsi_stress_rows[d],
-                            solid_solver.mpi_communicator,
-                            solid_solver.fsi_stress_rows[d]);
+        eval_points = points;
+        lumping.resize(points.size());
+        for (unsigned int k = 0; k < points.size(); ++k)
+          {
+            lumping[k].emplace_back(k, 1.0);
+          }
+      }
+    else
+      {
+        const Mapping<dim> &mapping =
+          solid_mapping ? static_cast<const Mapping<dim> &>(*solid_mapping)
+                        : StaticMappingQ1<dim>::mapping;
+        const FE_Q<dim> linear_fe(1);
+        FEFaceValues<dim> fe_face_values(mapping,
+                                         linear_fe,
+                                         solid_solver.face_quad_formula,
+                                         update_values |
+                                           update_quadrature_points |
+                                           update_JxW_values);
+        std::vector<double> vertex_weights(points.size(), 0);
+        for (auto s_cell = solid_solver.dof_handler.begin_active();
+             s_cell != solid_solver.dof_handler.end();
+             ++s_cell)
+          {
+            for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                 ++f)
+              {
+                if (!s_cell->face(f)->at_boundary())
+                  {
+                    continue;
+                  }
+                // The shape functions of FE_Q(1) are numbered as the
+                // vertices.
+                fe_face_values.reinit(
+                  typename Triangulation<dim>::cell_iterator(s_cell), f);
+                for (unsigned int q = 0; q < fe_face_values.n_quadrature_points;
+                     ++q)
+                  {
+                    eval_points.push_back(fe_face_values.quadrature_point(q));
+                    lumping.emplace_back();
+                    for (unsigned int v = 0;
+                         v < GeometryInfo<dim>::vertices_per_face;
+                         ++v)
+                      {
+                        const unsigned int k =
+                          point_index[s_cell->face(f)->vertex_dof_index(v, 0)];
+                        const double weight =
+                          fe_face_values.shape_value(
+                            GeometryInfo<dim>::face_to_cell_vertices(f, v),
+                            q) *
+                          fe_face_values.JxW(q);
+                        lumping.back().emplace_back(k, weight);
+                        vertex_weights[k] += weight;
+                      }
+                  }
+              }
+          }
+        for (auto &targets : lumping)
+          {
+            for (auto &target : targets)
+              {
+                target.second /= vertex_weights[target.first];
+              }
+          }
+      }
+
+    // Only the points in the box of the locally owned fluid cells can be
+    // evaluated here. Each of them is located by a BFS from the fluid cell
+    // it was found in last time, the interpolator falls back to the masked
+    // global search if there is no hint or the BFS fails.
+    if (solid_boundary_hints.size() != eval_points.size())
+      {
+        solid_boundary_hints.assign(
+          eval_points.size(), typename DoFHandler<dim>::active_cell_iterator());
+      }
+    std::vector<unsigned int> candidates;
+    std::vector<Point<dim>> candidate_points;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator>
+      candidate_cells;
+    for (unsigned int k = 0; k < eval_points.size(); ++k)
+      {
+        bool in_box = true;
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            const double tolerance =
+              1e-10 * (fluid_owned_box(2 * i + 1) - fluid_owned_box(2 * i));
+            in_box =
+              in_box &&
+              eval_points[k](i) >= fluid_owned_box(2 * i) - tolerance &&
+              eval_points[k](i) <= fluid_owned_box(2 * i + 1) + tolerance;
+          }
+        if (!in_box)
+          {
+            continue;
+          }
+        auto &hint = solid_boundary_hints[k];
+        // The locator takes the first cell as no hint at all and searches
+        // without the mask, which the interpolator does with it.
+        if (hint.state() == IteratorState::valid &&
+            hint != fluid_solver.dof_handler.begin_active())
+          {
+            hint = fluid_locator.search(eval_points[k], hint);
+            if (!fluid_locator.found_cell())
+              {
+                hint = typename DoFHandler<dim>::active_cell_iterator();
+              }
+          }
+        candidates.push_back(k);
+        candidate_points.push_back(eval_points[k]);
+        candidate_cells.push_back(hint);
+      }
+
+    // Get interpolated solution from the fluid
+    Utils::BatchedGridInterpolator<dim, PETScWrappers::MPI::BlockVector>
+      interpolator(fluid_solver.dof_handler, vertices_mask);
+    interpolator.reinit(
+      candidate_points, candidate_cells, update_values | update_gradients);
+    std::vector<std::vector<Vector<double>>> values;
+    interpolator.point_values({&fluid_solver.present_solution}, values);
+    std::vector<std::vector<Tensor<1, dim>>> gradients;
+    interpolator.point_gradients(fluid_solver.present_solution, gradients);
+    // The stress lumped to the boundary vertices from the points found on
+    // this process, dim * dim entries per vertex.
+    std::vector<double> vertex_stress(points.size() * dim * dim, 0);
+    std::vector<bool> vertex_found(points.size(), false);
+    for (unsigned int c = 0; c < candidates.size(); ++c)
+      {
+        const unsigned int k = candidates[c];
+        solid_boundary_hints[k] =
+          interpolator.found_cell(c)
+            ? interpolator.get_cell(c)
+            : typename DoFHandler<dim>::active_cell_iterator();
+        // The stress is zero if the point is not in a locally owned
+        // fluid cell, it is evaluated by the owner of the cell.
+        if (!interpolator.found_cell(c) ||
+            !interpolator.get_cell(c)->is_locally_owned())
+          continue;
+        const Vector<double> &value = values[0][c];
+        const std::vector<Tensor<1, dim>> &gradient = gradients[c];
+        // Compute stress
+        SymmetricTensor<2, dim> sym_deformation;
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            for (unsigned int j = 0; j < dim; ++j)
+              {
+                sym_deformation[i][j] = (gradient[i][j] + gradient[j][i]) / 2;
+              }
+          }
+        // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+        SymmetricTensor<2, dim> stress =
+          -value[dim] * Physics::Elasticity::StandardTensors<dim>::I +
+          2 * parameters.viscosity * sym_deformation;
+        for (const auto &target : lumping[k])
+          {
+            vertex_found[target.first] = true;
+            double *entries = &vertex_stress[target.first * dim * dim];
+            for (unsigned int d1 = 0; d1 < dim; ++d1)
+              for (unsigned int d2 = 0; d2 < dim; ++d2)
+                entries[d1 * dim + d2] += target.second * stress[d1][d2];
+          }
+      } // End looping evaluation points
+    const bool owned_only = solid_solver.fsi_stress_rows_owned_only();
+    // The stress of the vertices found on this process, sent to the readers.
+    std::map<unsigned int, std::vector<double>> send_stress;
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        // Nothing was added to the vertex here, which does not need to be
+        // sent.
+        if (!vertex_found[k])
+          continue;
+        const double *entries = &vertex_stress[k * dim * dim];
+        if (owned_only)
+          {
+            // The dof index is exactly representable as a double.
+            for (const auto r : readers[k])
+              for (const auto p : solid_subdomain_processes[r])
+                {
+                  auto &buffer = send_stress[p];
+                  buffer.push_back(lines[k]);
+                  buffer.insert(buffer.end(), entries, entries + dim * dim);
+                }
+            continue;
+          }
+        // Assign the vertex stress to local row vectors
+        for (unsigned int d1 = 0; d1 < dim; ++d1)
+          {
+            for (unsigned int d2 = 0; d2 < dim; ++d2)
+              {
+                solid_solver.fsi_stress_rows[d1][lines[k] + d2] =
+                  entries[d1 * dim + d2];
+              }
+          }
+        // End assigning local fluid stress values
+      } // End looping boundary vertices
+    if (owned_only)
+      {
+        // Only exchange the nonzero entries with the processes that read
+        // them. Adding up the received values gives the same entries as
+        // summing up the whole vectors.
+        auto received = Utils::exchange_doubles(mpi_communicator, send_stress);
+        for (const auto &message : received)
+          {
+            const auto &buffer = message.second;
+            for (unsigned int j = 0; j < buffer.size(); j += dim * dim + 1)
+              {
+                const auto line =
+                  static_cast<types::global_dof_index>(buffer[j]);
+                for (unsigned int d1 = 0; d1 < dim; ++d1)
+                  for (unsigned int d2 = 0; d2 < dim; ++d2)
+                    solid_solver.fsi_stress_rows[d1][line + d2] +=
+                      buffer[j + 1 + d1 * dim + d2];
+              }
+          }
+      }
+    else
+      {
+        // Add up the local vectors of all the fluid processes, which are
+        // the same for every group that solves the solid.
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            Utilities::MPI::sum(solid_solver.fsi_stress_rows[d],
+                                mpi_communicator,
+                                solid_solver.fsi_stress_rows[d]);
+          }
       }
     move_solid_mesh(false);
   }
 
+  template <int dim>
+  void FSI<dim>::assemble_transfer_operator()
+  {
+    Utils::TimerScope timer_section(timer, "Assemble transfer operator");
+    OPENIFEM_KERNEL_SCOPE("fsi_transfer_operator");
+    const std::vector<Point<dim>> &unit_points =
+      fluid_solver.fe.get_unit_support_points();
+    MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
+    Quadrature<dim> dummy_q(unit_points);
+    FEValues<dim> dummy_fe_values(
+      mapping, fluid_solver.fe, dummy_q, update_quadrature_points);
+    std::vector<types::global_dof_index> dof_indices(
+      fluid_solver.fe.dofs_per_cell);
+    std::vector<unsigned char> &dof_touched = workspace.dof_touched;
+    std::fill(dof_touched.begin(), dof_touched.end(), 0);
+
+    Utils::BatchedGridInterpolator<dim, Vector<double>> interpolator(
+      solid_solver.dof_handler, {}, solid_mapping.get());
+    std::vector<unsigned int> batch_support;
+    std::vector<Point<dim>> batch_points;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> batch_cells;
+    std::vector<types::global_dof_index> solid_dofs;
+    std::vector<double> weights;
+    // The entries of row k are entries[row_begin[k], row_begin[k + 1]).
+    std::vector<unsigned int> row_begin(1, 0);
+    std::vector<std::pair<types::global_dof_index, double>> entries;
+    transfer_cells.clear();
+    transfer_support.clear();
+
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        // Same selection as find_fluid_bc: the Dirichlet BCs need the ghost
+        // cells while the FSI acceleration only needs the artificial fluid
+        // cells that are locally owned.
+        if (f_cell->is_artificial())
+          continue;
+        if (!use_dirichlet_bc)
+          {
+            if (!f_cell->is_locally_owned())
+              continue;
+            if (fluid_solver.cell_property.indicator(f_cell) == 0)
+              continue;
+          }
+        auto hints = cell_hints.get_data(f_cell);
+        dummy_fe_values.reinit(f_cell);
+        f_cell->get_dof_indices(dof_indices);
+        auto support_points = dummy_fe_values.get_quadrature_points();
+        batch_support.clear();
+        batch_points.clear();
+        batch_cells.clear();
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            const unsigned int relevant_index =
+              fluid_solver.locally_relevant_dofs.index_within_set(
+                dof_indices[i]);
+            // Skip the already-set dofs.
+            if (dof_touched[relevant_index] != 0)
+              continue;
+            auto base_index = fluid_solver.fe.system_to_base_index(i);
+            const unsigned int i_group = base_index.first.first;
+            Assert(
+              i_group < 2,
+              ExcMessage("There should be only 2 groups of finite element!"));
+            if (i_group == 1)
+              continue; // skip the pressure dofs
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            Assert(fluid_solver.fe.system_to_component_index(i).first < dim,
+                   ExcMessage("Vector component should be less than dim!"));
+            dof_touched[relevant_index] = 1;
+            if (!point_in_solid(solid_solver.dof_handler, support_points[i]))
+              continue;
+            *(hints[i]) = solid_locator.search(
+              support_points[i], *(hints[i]), solid_mapping.get());
+            batch_support.push_back(i);
+            batch_points.push_back(support_points[i]);
+            batch_cells.push_back(*(hints[i]));
+          }
+        if (batch_support.empty())
+          continue;
+        interpolator.reinit(batch_points, batch_cells);
+        for (unsigned int k = 0; k < batch_support.size(); ++k)
+          {
+            const unsigned int i = batch_support[k];
+            if (!interpolator.found_cell(k))
+              {
+                std::stringstream message;
+                message << "Cannot find point in solid: " << support_points[i]
+                        << std::endl;
+                AssertThrow(interpolator.found_cell(k),
+                            ExcMessage(message.str()));
+              }
+            const unsigned int index =
+              fluid_solver.fe.system_to_component_index(i).first;
+            interpolator.point_weights(k, index, solid_dofs, weights);
+            for (unsigned int j = 0; j < solid_dofs.size(); ++j)
+              {
+                entries.push_back({solid_dofs[j], weights[j]});
+              }
+            row_begin.push_back(entries.size());
+            transfer_cells.push_back(f_cell);
+            transfer_support.push_back(i);
+          }
+      }
+
+    DynamicSparsityPattern dsp(transfer_support.size(),
+                               solid_solver.dof_handler.n_dofs());
+    for (unsigned int k = 0; k < transfer_support.size(); ++k)
+      {
+        for (unsigned int e = row_begin[k]; e < row_begin[k + 1]; ++e)
+          {
+            dsp.add(k, entries[e].first);
+          }
+      }
+    transfer_matrix.clear();
+    transfer_sparsity.copy_from(dsp);
+    transfer_matrix.reinit(transfer_sparsity);
+    for (unsigned int k = 0; k < transfer_support.size(); ++k)
+      {
+        for (unsigned int e = row_begin[k]; e < row_begin[k + 1]; ++e)
+          {
+            transfer_matrix.set(k, entries[e].first, entries[e].second);
+          }
+      }
+    transfer_displacement.reinit(solid_solver.locally_owned_dofs,
+                                 solid_solver.mpi_communicator);
+    transfer_displacement = solid_solver.current_displacement;
+    transfer_outdated = false;
+  }
+
+  template <int dim>
+  bool FSI<dim>::transfer_operator_outdated() const
+  {
+    if (transfer_outdated)
+      return true;
+    PETScWrappers::MPI::Vector displacement(solid_solver.current_displacement);
+    displacement -= transfer_displacement;
+    return displacement.linfty_norm() > parameters.transfer_rebuild_distance;
+  }
+
+  template <int dim>
+  void FSI<dim>::save_step_state()
+  {
+    step_displacement = solid_solver.current_displacement;
+    step_velocity = solid_solver.current_velocity;
+    step_acceleration = solid_solver.current_acceleration;
+    step_fluid_solution = fluid_solver.present_solution;
+    step_fluid_increment = fluid_solver.solution_increment;
+    // The previous solution of BDF2 is replaced at the end of the step.
+    step_fluid_previous_delta_t = fluid_solver.previous_delta_t;
+    if (step_fluid_previous_delta_t > 0)
+      {
+        step_fluid_previous = fluid_solver.previous_solution;
+      }
+    step_solid_time = solid_solver.time.get_state();
+    step_fluid_time = fluid_solver.time.get_state();
+    step_solid_records = solid_solver.times_and_names.size();
+    step_fluid_records = fluid_solver.times_and_names.size();
+  }
+
+  template <int dim>
+  void FSI<dim>::restore_step_state()
+  {
+    solid_solver.previous_displacement = step_displacement;
+    solid_solver.previous_velocity = step_velocity;
+    solid_solver.previous_acceleration = step_acceleration;
+    solid_solver.current_displacement = step_displacement;
+    solid_solver.current_velocity = step_velocity;
+    solid_solver.current_acceleration = step_acceleration;
+    fluid_solver.present_solution = step_fluid_solution;
+    fluid_solver.solution_increment = step_fluid_increment;
+    fluid_solver.previous_delta_t = step_fluid_previous_delta_t;
+    if (step_fluid_previous_delta_t > 0)
+      {
+        fluid_solver.previous_solution = step_fluid_previous;
+      }
+    // The rejected fluid solution has been recorded for extrapolation.
+    fluid_solver.solution_predictor.clear();
+    solid_solver.time.set_state(step_solid_time);
+    fluid_solver.time.set_state(step_fluid_time);
+    // The output files of the repeated step are overwritten, but they must
+    // not be recorded twice.
+    solid_solver.times_and_names.resize(step_solid_records);
+    fluid_solver.times_and_names.resize(step_fluid_records);
+  }
+
+  template <int dim>
+  bool FSI<dim>::relax_interface_stress(const unsigned int iteration)
+  {
+    Utils::TimerScope timer_section(timer, "Relax interface stress");
+    auto &stress = solid_solver.fsi_stress_rows;
+    if (iteration == 0)
+      {
+        relaxed_stress = stress;
+        stress_change = 0;
+        return false;
+      }
+    // Every process only holds the entries it reads, some of which are
+    // shared, so the global products weight them by the number of readers.
+    // They are still the same on all processes.
+    std::vector<Vector<double>> residual(stress);
+    Vector<double> local_products(4);
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        residual[d] -= relaxed_stress[d];
+        local_products[0] += residual[d].norm_sqr();
+        local_products[1] += relaxed_stress[d].norm_sqr();
+        if (iteration > 1)
+          {
+            Vector<double> change(residual[d]);
+            change -= stress_residual[d];
+            local_products[2] += stress_residual[d] * change;
+            local_products[3] += change.norm_sqr();
+          }
+      }
+    Vector<double> products(4);
+    Utilities::MPI::sum(
+      local_products, solid_solver.mpi_communicator, products);
+    stress_change =
+      std::sqrt(products[0]) / std::max(std::sqrt(products[1]), 1e-12);
+    pcout << "Coupling iteration = " << iteration
+          << ", relative stress change = " << std::scientific << stress_change
+          << std::defaultfloat << std::endl;
+    if (stress_change <= parameters.coupling_tolerance)
+      {
+        return true;
+      }
+    // Dynamic Aitken relaxation, the factor is kept if the residual did not
+    // change.
+    if (iteration == 1)
+      {
+        relaxation = parameters.initial_relaxation;
+      }
+    else if (products[3] > 0)
+      {
+        relaxation = -relaxation * products[2] / products[3];
+      }
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        relaxed_stress[d].add(relaxation, residual[d]);
+        stress[d] = relaxed_stress[d];
+      }
+    stress_residual = residual;
+    return false;
+  }
+
   template <int dim>
   void FSI<dim>::refine_mesh(const unsigned int min_grid_level,
                              const unsigned int max_grid_level)
   {
-    TimerOutput::Scope timer_section(timer, "Refine mesh");
+    Utils::TimerScope timer_section(timer, "Refine mesh");
+    if (cell_weight_connection.connected())
+      {
+        update_cell_weight();
+      }
     move_solid_mesh(true);
     std::vector<Point<dim>> solid_boundary_points;
     for (auto s_cell : solid_solver.dof_handler.active_cell_iterators())
@@ -645,7 +1541,14 @@ namespace MPI
           {
             if (s_cell->face(face)->at_boundary())
               {
-                point = s_cell->face(face)->center();
+                // The center of the face at its current position.
+                for (unsigned int v = 0;
+                     v < GeometryInfo<dim>::vertices_per_face;
+                     ++v)
+                  {
+                    point += solid_vertex(s_cell->face(face)->vertex_index(v));
+                  }
+                point /= GeometryInfo<dim>::vertices_per_face;
                 is_boundary = true;
                 break;
               }
@@ -655,18 +1558,37 @@ namespace MPI
             solid_boundary_points.push_back(point);
           }
       }
+    // A fluid cell is refined if a solid boundary point is closer to its
+    // center than its diameter, otherwise it is coarsened. Such a cell is
+    // within the largest fluid cell diameter of the point, so only the
+    // cells found by the spatial index around every point are checked.
+    double max_diameter = 0;
     for (auto f_cell : fluid_solver.dof_handler.active_cell_iterators())
       {
-        auto center = f_cell->center();
-        double dist = 1000;
-        for (auto point : solid_boundary_points)
+        f_cell->set_coarsen_flag();
+        max_diameter = std::max(max_diameter, f_cell->diameter());
+      }
+    Utils::CellBucketGrid<dim> fluid_cells;
+    fluid_cells.reinit(fluid_solver.dof_handler);
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> candidates;
+    for (const auto &point : solid_boundary_points)
+      {
+        Point<dim> lower, upper;
+        for (unsigned int d = 0; d < dim; ++d)
           {
-            dist = std::min(center.distance(point), dist);
+            lower[d] = point[d] - max_diameter;
+            upper[d] = point[d] + max_diameter;
+          }
+        fluid_cells.find_cells(lower, upper, candidates);
+        for (const auto &f_cell : candidates)
+          {
+            if (!f_cell->refine_flag_set() &&
+                f_cell->center().distance(point) < f_cell->diameter())
+              {
+                f_cell->clear_coarsen_flag();
+                f_cell->set_refine_flag();
+              }
           }
-        if (dist < f_cell->diameter())
-          f_cell->set_refine_flag();
-        else
-          f_cell->set_coarsen_flag();
       }
     move_solid_mesh(false);
     if (fluid_solver.triangulation.n_levels() > max_grid_level)
@@ -709,36 +1631,171 @@ namespace MPI
     fluid_solver.nonzero_constraints.distribute(buffer);
     fluid_solver.present_solution = buffer;
     update_vertices_mask();
+    transfer_outdated = true;
+    indicator_band_outdated = true;
+    if (parameters.memory_report)
+      {
+        print_memory_usage();
+      }
+  }
+
+  template <int dim>
+  void FSI<dim>::update_cell_weight()
+  {
+    if (parameters.artificial_cell_weight > 0)
+      {
+        artificial_weight =
+          static_cast<unsigned int>(1000 * parameters.artificial_cell_weight);
+        return;
+      }
+    // The indicators are only set on the locally owned cells.
+    unsigned int n_artificial = 0, n_cells = 0;
+    for (auto f_cell = fluid_solver.triangulation.begin_active();
+         f_cell != fluid_solver.triangulation.end();
+         ++f_cell)
+      {
+        if (!f_cell->is_locally_owned())
+          {
+            continue;
+          }
+        ++n_cells;
+        if (fluid_solver.cell_property.indicator(f_cell) == 1)
+          {
+            ++n_artificial;
+          }
+      }
+    auto times = timer.get_summary_data(TimerOutput::total_wall_time);
+    Vector<double> local_cost(4), cost(4);
+    local_cost[0] = times["Update indicator"] + times["Find fluid BC"] +
+                    times["Assemble transfer operator"];
+    local_cost[1] = times["Run fluid solver"];
+    local_cost[2] = n_artificial;
+    local_cost[3] = n_cells;
+    Utilities::MPI::sum(local_cost, mpi_communicator, cost);
+    // Keep the last weight if there is nothing to measure.
+    if (cost[0] <= 0 || cost[1] <= 0 || cost[2] == 0)
+      {
+        return;
+      }
+    const double extra_cost = (cost[0] / cost[2]) / (cost[1] / cost[3]);
+    artificial_weight =
+      static_cast<unsigned int>(1000 * std::min(extra_cost, 1000.0));
+    pcout << "Extra cost of an artificial fluid cell: " << extra_cost
+          << std::endl;
+  }
+
+  template <int dim>
+  unsigned int FSI<dim>::cell_weight(
+    const typename parallel::distributed::Triangulation<dim>::cell_iterator
+      &cell,
+    const typename parallel::distributed::Triangulation<dim>::CellStatus
+      status) const
+  {
+    // Nothing to weigh, e.g., when a checkpoint is loaded before the
+    // indicators exist.
+    if (artificial_weight == 0)
+      {
+        return 0;
+      }
+    // A refined cell has its weight before the refinement, and a coarsened
+    // cell is artificial if any of its children is.
+    auto is_artificial =
+      [this](const typename parallel::distributed::Triangulation<
+             dim>::cell_iterator &f_cell) {
+        return f_cell->active() && f_cell->is_locally_owned() &&
+               fluid_solver.cell_property.indicator(f_cell) == 1;
+      };
+    if (status ==
+        parallel::distributed::Triangulation<dim>::CellStatus::CELL_COARSEN)
+      {
+        for (unsigned int c = 0; c < cell->n_children(); ++c)
+          {
+            if (is_artificial(cell->child(c)))
+              {
+                return artificial_weight;
+              }
+          }
+        return 0;
+      }
+    return is_artificial(cell) ? artificial_weight : 0;
+  }
+
+  template <int dim>
+  void FSI<dim>::repartition()
+  {
+    Utils::TimerScope timer_section(timer, "Repartition");
+    update_cell_weight();
+    fluid_solver.repartition();
+    update_vertices_mask();
+    setup_cell_hints();
+    setup_coupling_workspace();
+    transfer_outdated = true;
+    indicator_band_outdated = true;
+  }
+
+  template <int dim>
+  bool FSI<dim>::reached_steady_state()
+  {
+    // Both solutions are recorded at every step.
+    const bool fluid_steady = fluid_solver.steady_state.record(
+      fluid_solver.present_solution, time.current());
+    const bool solid_steady = solid_solver.steady_state.record(
+      solid_solver.current_displacement, time.current());
+    if (!fluid_steady || !solid_steady)
+      {
+        return false;
+      }
+    pcout << "Steady state reached at t = " << time.current() << std::endl;
+    if (!fluid_solver.time.time_to_output())
+      {
+        fluid_solver.output_results(fluid_solver.time.get_timestep());
+      }
+    if (!solid_solver.time.time_to_output())
+      {
+        solid_solver.output_results(solid_solver.time.get_timestep());
+      }
+    if (!time.time_to_save())
+      {
+        solid_solver.save_checkpoint(solid_solver.time.get_timestep());
+        fluid_solver.save_checkpoint(time.get_timestep());
+      }
+    return true;
   }
 
   template <int dim>
   void FSI<dim>::run()
   {
     pcout << "Running with PETSc on "
-          << Utilities::MPI::n_mpi_processes(mpi_communicator)
-          << " MPI rank(s)..." << std::endl;
+          << Utils::parallel_configuration(mpi_communicator) << "..."
+          << std::endl;
 
-    solid_solver.triangulation.refine_global(parameters.global_refinements[1]);
+    Utils::refine_global_cached(solid_solver.triangulation,
+                                parameters.global_refinements[1],
+                                parameters.mesh_cache);
     // Try load from previous computation.
     bool success_load =
       solid_solver.load_checkpoint() && fluid_solver.load_checkpoint();
+    // The solid time is accumulated with smaller steps if it is sub-cycled.
     AssertThrow(
-      solid_solver.time.current() == fluid_solver.time.current(),
+      std::abs(solid_solver.time.current() - fluid_solver.time.current()) <
+        1e-6 * parameters.time_step,
       ExcMessage("Solid and fluid restart files have different time steps. "
                  "Check and remove inconsistent restart files!"));
     if (!success_load)
       {
         solid_solver.setup_dofs();
         solid_solver.initialize_system();
-        fluid_solver.triangulation.refine_global(
-          parameters.global_refinements[0]);
+        Utils::refine_global_cached(fluid_solver.triangulation,
+                                    parameters.global_refinements[0],
+                                    parameters.mesh_cache);
         fluid_solver.setup_dofs();
         fluid_solver.make_constraints();
         fluid_solver.initialize_system();
       }
     else
       {
-        while (time.get_timestep() < solid_solver.time.get_timestep())
+        while (time.get_timestep() * parameters.solid_substeps <
+               solid_solver.time.get_timestep())
           {
             time.increment();
           }
@@ -746,6 +1803,7 @@ namespace MPI
 
     collect_solid_boundaries();
     setup_cell_hints();
+    setup_coupling_workspace();
     update_vertices_mask();
 
     pcout << "Number of fluid active cells and dofs: ["
@@ -754,54 +1812,127 @@ namespace MPI
           << "Number of solid active cells and dofs: ["
           << solid_solver.triangulation.n_active_cells() << ", "
           << solid_solver.dof_handler.n_dofs() << "]" << std::endl;
+    if (parameters.memory_report)
+      {
+        print_memory_usage();
+      }
     bool first_step = !success_load;
     if (parameters.refinement_interval < parameters.end_time)
       {
+        Utils::StartupScope startup("fsi initial refine_mesh");
         refine_mesh(parameters.global_refinements[0],
                     parameters.global_refinements[0] + 3);
         refine_mesh(parameters.global_refinements[0],
                     parameters.global_refinements[0] + 3);
         setup_cell_hints();
+        setup_coupling_workspace();
       }
+    const bool strong_coupling = parameters.coupling_iterations > 1;
+    const unsigned int repartition_steps = std::max(
+      1u,
+      static_cast<unsigned int>(parameters.repartition_interval /
+                                parameters.time_step));
+    Utils::StartupProfile::instance().begin_steps();
     while (time.end() - time.current() > 1e-12)
       {
-        find_solid_bc();
-        if (success_load)
+        Utils::TraceScope step_trace(
+          "Time step " + std::to_string(time.get_timestep() + 1), "fsi");
+        if (strong_coupling)
           {
-            solid_solver.assemble_system(true);
+            save_step_state();
           }
-        {
-          TimerOutput::Scope timer_section(timer, "Run solid solver");
-          solid_solver.run_one_step(first_step);
-        }
-        update_solid_box();
-        update_indicator();
-        fluid_solver.make_constraints();
-        if (!first_step)
+        // With strong coupling, the time step is repeated with the relaxed
+        // FSI stress until the stress from the new fluid solution agrees.
+        unsigned int coupling_iterations = 0;
+        for (unsigned int k = 0; k < parameters.coupling_iterations; ++k)
           {
-            fluid_solver.nonzero_constraints.clear();
-            fluid_solver.nonzero_constraints.copy_from(
-              fluid_solver.zero_constraints);
+            find_solid_bc();
+            if (k > 0)
+              {
+                if (relax_interface_stress(k))
+                  {
+                    break;
+                  }
+                restore_step_state();
+              }
+            else if (strong_coupling)
+              {
+                relax_interface_stress(0);
+              }
+            if (success_load)
+              {
+                solid_solver.assemble_system(true);
+              }
+            {
+              Utils::TimerScope timer_section(timer, "Run solid solver");
+              // The solid is sub-cycled with the fluid traction held.
+              for (unsigned int n = 0; n < parameters.solid_substeps; ++n)
+                {
+                  solid_solver.run_one_step(first_step && n == 0);
+                }
+            }
+            update_solid_box();
+            update_indicator();
+            // The constraints of the mesh are kept, the interface constraints
+            // of the step are merged into them by find_fluid_bc. The nonzero
+            // Dirichlet values are only applied at the first step.
+            fluid_solver.restore_constraints(first_step);
+            find_fluid_bc();
+            {
+              Utils::TimerScope timer_section(timer, "Run fluid solver");
+              fluid_solver.run_one_step(true);
+            }
+            ++coupling_iterations;
           }
-        find_fluid_bc();
-        {
-          TimerOutput::Scope timer_section(timer, "Run fluid solver");
-          fluid_solver.run_one_step(true);
-        }
         first_step = false;
         time.increment();
+        // The iterations that did not converge end with the stress change
+        // before the last one.
+        if (strong_coupling)
+          {
+            coupling_log.write(time.current(),
+                               {"coupling_iterations", "stress_change"},
+                               {static_cast<double>(coupling_iterations),
+                                stress_change});
+          }
         if (time.time_to_refine())
           {
+            Utils::TraceScope trace("Refine mesh", "fsi");
             refine_mesh(parameters.global_refinements[0],
                         parameters.global_refinements[0] + 3);
             setup_cell_hints();
+            setup_coupling_workspace();
+          }
+        else if (cell_weight_connection.connected() &&
+                 time.get_timestep() % repartition_steps == 0)
+          {
+            Utils::TraceScope trace("Repartition", "fsi");
+            repartition();
           }
         if (time.time_to_save())
           {
-            solid_solver.save_checkpoint(time.get_timestep());
+            Utils::TraceScope trace("Save checkpoint", "fsi");
+            // The solid checkpoint is numbered by the solid time step, which
+            // is what its load_checkpoint replays.
+            solid_solver.save_checkpoint(solid_solver.time.get_timestep());
             fluid_solver.save_checkpoint(time.get_timestep());
           }
+        if (time.time_to_save(parameters.buddy_checkpoint_interval))
+          {
+            Utils::TraceScope trace("Save buddy checkpoint", "fsi");
+            solid_solver.save_buddy_checkpoint(
+              solid_solver.time.get_timestep());
+            fluid_solver.save_buddy_checkpoint(time.get_timestep());
+          }
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
+        if (reached_steady_state())
+          {
+            break;
+          }
       }
+    Utils::Tracer::instance().write(mpi_communicator);
   }
 
   template class FSI<2>;
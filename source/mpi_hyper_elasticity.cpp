@@ -1,50 +1,5 @@
 #include "mpi_hyper_elasticity.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
-  {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
-
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
-      {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
-
 namespace Solid
 {
   namespace MPI
@@ -55,13 +10,15 @@ namespace Solid
     HyperElasticity<dim>::HyperElasticity(
       parallel::distributed::Triangulation<dim> &tria,
       const Parameters::AllParameters &params)
-      : SolidSolver<dim>(tria, params)
+      : SolidSolver<dim>(tria, params),
+        matrix_free(params.solid_tangent == "Matrix-free")
     {
     }
 
     template <int dim>
     void HyperElasticity<dim>::run_one_step(bool first_step)
     {
+      Utils::TraceScope trace("Run one step", "solid");
       double gamma = 0.5 + parameters.damping;
       double beta = gamma / 2;
 
@@ -123,10 +80,22 @@ namespace Solid
           assemble_system(false);
           mass_matrix.vmult(tmp, current_acceleration);
           system_rhs -= tmp;
+          if (matrix_free && !tangent_preconditioner)
+            {
+              Utils::TimerScope timer_section(timer, "Setup preconditioner");
+              tangent_preconditioner =
+                make_preconditioner(system_matrix,
+                                    parameters.solid_tangent_preconditioner,
+                                    dim,
+                                    true,
+                                    parameters.solid_degree > 1);
+            }
 
           // Solve linear system
           const std::pair<unsigned int, double> lin_solver_output =
-            this->solve(system_matrix, newton_update, system_rhs);
+            matrix_free
+              ? solve_matrix_free(newton_update, system_rhs)
+              : this->solve(system_matrix, newton_update, system_rhs);
 
           // Error evaluation
           {
@@ -146,6 +115,9 @@ namespace Solid
               }
             normalized_error_update = error_update / initial_error_update;
           }
+          solver_log.add_linear_solve(lin_solver_output.first,
+                                      lin_solver_output.second);
+          solver_log.add_newton_iteration(error_residual);
 
           current_displacement += newton_update;
           // Update the quadrature point history with the newest displacement
@@ -179,6 +151,7 @@ namespace Solid
             << "Relative errors:" << std::endl
             << "Displacement:\t" << normalized_error_update << std::endl
             << "Force: \t\t" << normalized_error_residual << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
 
       if (time.time_to_output())
         {
@@ -191,30 +164,28 @@ namespace Solid
     {
       SolidSolver<dim>::initialize_system();
       setup_qph();
+      if (matrix_free)
+        {
+          tangent_preconditioner.reset();
+          constrained_dofs.clear();
+          for (const auto i : locally_owned_dofs)
+            {
+              if (constraints.is_constrained(i))
+                {
+                  constrained_dofs.push_back(i);
+                }
+            }
+          tangent_owned.reinit(locally_owned_dofs, mpi_communicator);
+          tangent_ghosted.reinit(
+            locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+        }
     }
 
     template <int dim>
     void HyperElasticity<dim>::setup_qph()
     {
-      const unsigned int n_q_points = volume_quad_formula.size();
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
-        {
-          if (!cell->is_locally_owned())
-            continue;
-          unsigned int mat_id = cell->material_id();
-          if (parameters.n_solid_parts == 1)
-            mat_id = 1;
-          quad_point_history.initialize(cell, n_q_points);
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->setup(parameters, mat_id);
-            }
-        }
+      quad_point_history.initialize(
+        triangulation, parameters, volume_quad_formula.size());
     }
 
     template <int dim>
@@ -224,7 +195,6 @@ namespace Solid
       timer.enter_subsection("Update QPH data");
 
       // displacement gradient at quad points
-      const unsigned int n_q_points = volume_quad_formula.size();
       FEValuesExtractors::Vector displacement(0);
       std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
       FEValues<dim> fe_values(
@@ -239,19 +209,118 @@ namespace Solid
         {
           if (!cell->is_locally_owned())
             continue;
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
 
           fe_values.reinit(cell);
           fe_values[displacement].get_function_gradients(tmp, grad_u);
 
+          quad_point_history.update(first, grad_u);
+        }
+      timer.leave_subsection();
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::apply_tangent(
+      PETScWrappers::MPI::Vector &dst,
+      const PETScWrappers::MPI::Vector &src) const
+    {
+      OPENIFEM_KERNEL_SCOPE("hyper_elasticity_apply_tangent");
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      FEValuesExtractors::Vector displacement(0);
+      const double gamma = 0.5 + parameters.damping;
+      const double beta = gamma / 2;
+      const double dt = time.get_delta_t();
+
+      // The constrained entries do not take part, as in the assembled
+      // tangent whose constrained columns are eliminated.
+      tangent_owned = src;
+      constraints.set_zero(tangent_owned);
+      tangent_ghosted = tangent_owned;
+
+      FEValues<dim> fe_values(fe,
+                              volume_quad_formula,
+                              update_values | update_gradients |
+                                update_JxW_values);
+      std::vector<Tensor<1, dim>> du(n_q_points);
+      std::vector<Tensor<2, dim>> grad_du(n_q_points);
+      Vector<double> local_dst(dofs_per_cell);
+      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+      dst = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            continue;
+          fe_values.reinit(cell);
+          cell->get_dof_indices(local_dof_indices);
+          fe_values[displacement].get_function_values(tangent_ghosted, du);
+          fe_values[displacement].get_function_gradients(tangent_ghosted,
+                                                         grad_du);
+          local_dst = 0;
+
+          const unsigned int first = quad_point_history.first_point(cell);
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              lqph[q]->update(parameters, grad_u[q]);
+              const Tensor<2, dim> F_inv =
+                quad_point_history.get_F_inv(first + q);
+              const SymmetricTensor<2, dim> tau =
+                quad_point_history.get_tau(first + q);
+              const SymmetricTensor<4, dim> Jc =
+                quad_point_history.get_Jc(first + q);
+              const double rho = quad_point_history.get_density(first + q);
+              const double JxW = fe_values.JxW(q);
+
+              // The same terms as the assembled tangent, contracted with the
+              // increment at the quadrature point instead of the shape
+              // functions: the material part Jc : sym(grad du) and the
+              // geometric part grad du * tau, in the current configuration.
+              const Tensor<2, dim> spatial_grad_du = grad_du[q] * F_inv;
+              const Tensor<2, dim> flux =
+                Tensor<2, dim>(Jc * symmetrize(spatial_grad_du)) +
+                spatial_grad_du * tau;
+              const Tensor<1, dim> inertia = du[q] * rho / (beta * dt * dt);
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  local_dst(i) +=
+                    (fe_values[displacement].value(i, q) * inertia +
+                     scalar_product(
+                       fe_values[displacement].gradient(i, q) * F_inv, flux)) *
+                    JxW;
+                }
             }
+          constraints.distribute_local_to_global(
+            local_dst, local_dof_indices, dst);
         }
-      timer.leave_subsection();
+      dst.compress(VectorOperation::add);
+
+      for (const auto i : constrained_dofs)
+        {
+          dst(i) = src(i);
+        }
+      dst.compress(VectorOperation::insert);
+    }
+
+    template <int dim>
+    std::pair<unsigned int, double>
+    HyperElasticity<dim>::solve_matrix_free(PETScWrappers::MPI::Vector &x,
+                                            const PETScWrappers::MPI::Vector &b)
+    {
+      Utils::TimerScope timer_section(timer, "Solve linear system");
+
+      SolverControl solver_control(dof_handler.n_dofs(), 1e-8 * b.l2_norm());
+      SolverCG<PETScWrappers::MPI::Vector> cg(solver_control);
+
+      LinearOperator<PETScWrappers::MPI::Vector> tangent;
+      tangent.vmult = [this](PETScWrappers::MPI::Vector &dst,
+                             const PETScWrappers::MPI::Vector &src) {
+        apply_tangent(dst, src);
+      };
+      cg.solve(tangent, x, b, *tangent_preconditioner);
+      constraints.distribute(x);
+
+      return {solver_control.last_step(), solver_control.last_value()};
     }
 
     template <int dim>
@@ -267,12 +336,10 @@ namespace Solid
           if (!cell->is_locally_owned())
             continue;
           fe_values.reinit(cell);
-          const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-            lqph = quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const double det = lqph[q]->get_det_F();
+              const double det = quad_point_history.get_det_F(first + q);
               const double JxW = fe_values.JxW(q);
               volume += det * JxW;
             }
@@ -296,6 +363,7 @@ namespace Solid
     template <int dim>
     void HyperElasticity<dim>::assemble_system(bool initial_step)
     {
+      OPENIFEM_KERNEL_SCOPE("hyper_elasticity_assemble");
       timer.enter_subsection("Assemble tangent matrix");
 
       const unsigned int n_q_points = volume_quad_formula.size();
@@ -305,11 +373,18 @@ namespace Solid
       double gamma = 0.5 + parameters.damping;
       double beta = gamma / 2;
 
+      // The matrix-free tangent is only assembled for its preconditioner.
+      const bool assemble_tangent =
+        !initial_step && !(matrix_free && tangent_preconditioner);
+
       if (initial_step)
         {
           mass_matrix = 0.0;
         }
-      system_matrix = 0.0;
+      if (assemble_tangent)
+        {
+          system_matrix = 0.0;
+        }
       system_rhs = 0.0;
 
       FEValues<dim> fe_values(fe,
@@ -351,13 +426,12 @@ namespace Solid
           local_matrix = 0;
           local_rhs = 0;
 
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
 
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
+              const Tensor<2, dim> F_inv =
+                quad_point_history.get_F_inv(first + q);
               for (unsigned int k = 0; k < dofs_per_cell; ++k)
                 {
                   phi[q][k] = fe_values[displacement].value(k, q);
@@ -366,9 +440,11 @@ namespace Solid
                   sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
                 }
 
-              const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-              const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-              const double rho = lqph[q]->get_density();
+              const SymmetricTensor<2, dim> tau =
+                quad_point_history.get_tau(first + q);
+              const SymmetricTensor<4, dim> Jc =
+                quad_point_history.get_Jc(first + q);
+              const double rho = quad_point_history.get_density(first + q);
               const double dt = time.get_delta_t();
               const double JxW = fe_values.JxW(q);
 
@@ -376,7 +452,9 @@ namespace Solid
                 {
                   const unsigned int component_i =
                     fe.system_to_component_index(i).first;
-                  for (unsigned int j = 0; j <= i; ++j)
+                  for (unsigned int j = 0;
+                       j <= i && (initial_step || assemble_tangent);
+                       ++j)
                     {
                       if (initial_step)
                         {
@@ -445,6 +523,13 @@ namespace Solid
 
               fe_face_values.reinit(cell, face);
 
+              if (parameters.simulation_type == "FSI")
+                {
+                  // The traction comes from the fluid.
+                  this->add_fsi_traction(cell, face, fe_face_values, local_rhs);
+                  continue;
+                }
+
               Tensor<1, dim> traction;
               std::vector<double> prescribed_value;
               if (parameters.simulation_type != "FSI")
@@ -452,6 +537,7 @@ namespace Solid
                   // In stand-alone simulation, the boundary value is prescribed
                   // by the user.
                   prescribed_value = parameters.solid_neumann_bcs[id];
+                  neumann_table.value(id, time.current(), prescribed_value);
                 }
 
               if (parameters.simulation_type != "FSI" &&
@@ -492,7 +578,7 @@ namespace Solid
                                                      mass_matrix,
                                                      system_rhs);
             }
-          else
+          else if (assemble_tangent)
             {
               constraints.distribute_local_to_global(local_matrix,
                                                      local_rhs,
@@ -500,13 +586,18 @@ namespace Solid
                                                      system_matrix,
                                                      system_rhs);
             }
+          else
+            {
+              constraints.distribute_local_to_global(
+                local_rhs, local_dof_indices, system_rhs);
+            }
         }
 
       if (initial_step)
         {
           mass_matrix.compress(VectorOperation::add);
         }
-      else
+      else if (assemble_tangent)
         {
           system_matrix.compress(VectorOperation::add);
         }
@@ -19,7 +19,12 @@ namespace Fluid
       const std::vector<IndexSet> &owned_partitioning,
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       const PETScWrappers::MPI::BlockSparseMatrix &mass,
-      PETScWrappers::MPI::BlockSparseMatrix &schur)
+      const PETScWrappers::MPI::BlockSparseMatrix &schur,
+      const Parameters::PreconditionerSettings &velocity_preconditioner,
+      std::shared_ptr<PETScWrappers::PreconditionerBase> velocity_multigrid,
+      std::shared_ptr<PETScWrappers::PreconditionerBase> schur_preconditioner,
+      double velocity_tolerance,
+      bool lagged)
       : timer2(timer2),
         gamma(gamma),
         viscosity(viscosity),
@@ -28,25 +33,47 @@ namespace Fluid
         system_matrix(&system),
         mass_matrix(&mass),
         mass_schur(&schur),
-        A_inverse(dummy_sc, system_matrix->get_mpi_communicator())
+        Sm_preconditioner(schur_preconditioner),
+        A_inverse(dummy_sc, system_matrix->get_mpi_communicator()),
+        A_matrix(&system_matrix->block(0, 0)),
+        velocity_tolerance(velocity_tolerance),
+        velocity_applications(0),
+        velocity_iterations(0),
+        mp_iterations(0),
+        sm_iterations(0)
     {
-      TimerOutput::Scope timer_section(timer2, "CG for Sm");
-      // The sparsity pattern of mass_schur is already set,
-      // we calculate its value in the following.
-      PETScWrappers::MPI::BlockVector tmp1, tmp2;
-      tmp1.reinit(owned_partitioning, mass_matrix->get_mpi_communicator());
-      tmp2.reinit(owned_partitioning, mass_matrix->get_mpi_communicator());
-      tmp1 = 1;
-      tmp2 = 0;
-      // Jacobi preconditioner of matrix A is by definition inverse diag(A),
-      // this is exactly what we want to compute.
-      // Note that the mass matrix and mass schur do not include the density.
-      PETScWrappers::PreconditionJacobi jacobi(mass_matrix->block(0, 0));
-      jacobi.vmult(tmp2.block(0), tmp1.block(0));
-      // The sparsity pattern has already been set correctly, so explicitly
-      // tell mmult not to rebuild the sparsity pattern.
-      system_matrix->block(1, 0).mmult(
-        mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+      if (velocity_preconditioner.type == "GMG")
+        {
+          // The hierarchy is built by the solver.
+          A_amg = velocity_multigrid;
+        }
+      else if (velocity_preconditioner.type != "MUMPS")
+        {
+          Utils::TimerScope timer_section(timer2, "AMG setup for A_inv");
+          // The velocity block is not symmetric because of the convection,
+          // and the velocity elements are quadratic.
+          A_amg = make_preconditioner(system_matrix->block(0, 0),
+                                      velocity_preconditioner,
+                                      dim,
+                                      false,
+                                      true);
+        }
+      else if (lagged)
+        {
+          A_lagged.reinit(system_matrix->block(0, 0));
+          A_lagged.copy_from(system_matrix->block(0, 0));
+          A_matrix = &A_lagged;
+        }
+      utmp.reinit(owned_partitioning[0], system_matrix->get_mpi_communicator());
+      ptmp.reinit(owned_partitioning[1], system_matrix->get_mpi_communicator());
+    }
+
+    template <int dim>
+    std::size_t
+    InsIM<dim>::BlockSchurPreconditioner::memory_consumption() const
+    {
+      return A_lagged.memory_consumption() + utmp.memory_consumption() +
+             ptmp.memory_consumption();
     }
 
     /**
@@ -58,16 +85,13 @@ namespace Fluid
       PETScWrappers::MPI::BlockVector &dst,
       const PETScWrappers::MPI::BlockVector &src) const
     {
-      // First, buffer the velocity block of src vector (\f$v_0\f$).
-      PETScWrappers::MPI::Vector utmp(src.block(0));
-      PETScWrappers::MPI::Vector tmp(src.block(1));
-      tmp = 0;
+      ptmp = 0;
       // This function is part of "solve linear system", but it
       // is further profiled to get a better idea of how time
       // is spent on different solvers.
       // The next two blocks computes \f$u_1 = \tilde{S}^{-1} v_1\f$.
       {
-        TimerOutput::Scope timer_section(timer2, "CG for Mp");
+        Utils::TimerScope timer_section(timer2, "CG for Mp");
 
         // CG solver used for \f$M_p^{-1}\f$ and \f$S_m^{-1}\f$.
         SolverControl solver_control(
@@ -79,12 +103,13 @@ namespace Fluid
         PETScWrappers::PreconditionNone Mp_preconditioner;
         Mp_preconditioner.initialize(mass_matrix->block(1, 1));
         cg_mp.solve(
-          mass_matrix->block(1, 1), tmp, src.block(1), Mp_preconditioner);
-        tmp *= -(viscosity + gamma * rho);
+          mass_matrix->block(1, 1), ptmp, src.block(1), Mp_preconditioner);
+        mp_iterations += solver_control.last_step();
+        ptmp *= -(viscosity + gamma * rho);
       }
 
       {
-        TimerOutput::Scope timer_section(timer2, "CG for Sm");
+        Utils::TimerScope timer_section(timer2, "CG for Sm");
         SolverControl solver_control(
           src.block(1).size(), std::max(1e-10, 1e-3 * src.block(1).l2_norm()));
         // FIXME: There is a mysterious bug here. After refine_mesh is called,
@@ -95,20 +120,20 @@ namespace Fluid
         // a preconditioner here, the code runs fine, suggesting that mass_schur
         // is correct; 2. if we do not call refine_mesh, the code also runs
         // fine. So the question is, why would refine_mesh generate diagonal
-        // zeros?
+        // zeros? Hence the default is None, GMG of the pressure Laplacian
+        // does not look at the entries.
         //
         // \f$-\frac{1}{dt}S_m^{-1}v_1\f$
-        PETScWrappers::PreconditionNone Sm_preconditioner;
-        Sm_preconditioner.initialize(mass_schur->block(1, 1));
         PETScWrappers::SolverCG cg_sm(solver_control,
                                       mass_schur->get_mpi_communicator());
         cg_sm.solve(mass_schur->block(1, 1),
                     dst.block(1),
                     src.block(1),
-                    Sm_preconditioner);
+                    *Sm_preconditioner);
+        sm_iterations += solver_control.last_step();
         dst.block(1) *= -rho / dt;
         // Adding up these two, we get \f$\tilde{S}^{-1}v_1\f$.
-        dst.block(1) += tmp;
+        dst.block(1) += ptmp;
       }
 
       // This block computes \f$v_0 - B^T\tilde{S}^{-1}v_1\f$ based on
@@ -120,11 +145,226 @@ namespace Fluid
       }
 
       // Finally, compute the product of \f$\tilde{A}^{-1}\f$ and utmp with
-      // the direct solver.
-      {
-        TimerOutput::Scope timer_section(timer2, "MUMPS for A_inv");
-        A_inverse.solve(system_matrix->block(0, 0), dst.block(0), utmp);
-      }
+      // the direct solver, or approximate it with AMG.
+      ++velocity_applications;
+      if (!A_amg)
+        {
+          Utils::TimerScope timer_section(timer2, "MUMPS for A_inv");
+          A_inverse.solve(*A_matrix, dst.block(0), utmp);
+        }
+      else if (velocity_tolerance == 0)
+        {
+          Utils::TimerScope timer_section(timer2, "AMG for A_inv");
+          A_amg->vmult(dst.block(0), utmp);
+          ++velocity_iterations;
+        }
+      else
+        {
+          Utils::TimerScope timer_section(timer2, "AMG for A_inv");
+          SolverControl solver_control(
+            utmp.size(),
+            std::max(1e-12, velocity_tolerance * utmp.l2_norm()));
+          PETScWrappers::SolverGMRES gmres(
+            solver_control, system_matrix->get_mpi_communicator());
+          dst.block(0) = 0;
+          gmres.solve(system_matrix->block(0, 0), dst.block(0), utmp, *A_amg);
+          velocity_iterations += solver_control.last_step();
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::reinit(
+      const DoFHandler<dim> &dof_handler,
+      const std::vector<IndexSet> &owned_partitioning,
+      const IndexSet &locally_relevant_dofs,
+      const unsigned int velocity_degree)
+    {
+      hanging_node_constraints.clear();
+      hanging_node_constraints.reinit(locally_relevant_dofs);
+      DoFTools::make_hanging_node_constraints(dof_handler,
+                                              hanging_node_constraints);
+      hanging_node_constraints.close();
+
+      typename MatrixFree<dim, double>::AdditionalData additional_data;
+      additional_data.tasks_parallel_scheme =
+        MatrixFree<dim, double>::AdditionalData::none;
+      additional_data.mapping_update_flags =
+        update_values | update_gradients | update_JxW_values;
+      // The same quadrature as the assembly.
+      matrix_free.reinit(MappingQGeneric<dim>(1),
+                         dof_handler,
+                         hanging_node_constraints,
+                         QGauss<1>(velocity_degree + 1),
+                         additional_data);
+      matrix_free.initialize_dof_vector(src_buffer);
+      matrix_free.initialize_dof_vector(dst_buffer);
+
+      // The blocks are numbered consecutively.
+      block_indices.resize(owned_partitioning.size());
+      block_offsets.resize(owned_partitioning.size());
+      types::global_dof_index offset = 0;
+      for (unsigned int b = 0; b < owned_partitioning.size(); ++b)
+        {
+          block_offsets[b] = offset;
+          block_indices[b].clear();
+          for (const auto i : owned_partitioning[b])
+            {
+              block_indices[b].push_back(i);
+            }
+          offset += owned_partitioning[b].size();
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::update(
+      const PETScWrappers::MPI::BlockVector &evaluation_point,
+      const AffineConstraints<double> &constraints,
+      const PETScWrappers::MPI::BlockSparseMatrix &system,
+      double viscosity,
+      double gamma,
+      double rho,
+      double dt)
+    {
+      this->viscosity = viscosity;
+      this->gamma = gamma;
+      this->rho = rho;
+      this->dt = dt;
+
+      // The linearization point includes the Dirichlet values, so it is read
+      // without resolving the constraints.
+      copy_to(evaluation_point, src_buffer);
+      src_buffer.update_ghost_values();
+      FEEvaluation<dim, -1, 0, dim> velocity(matrix_free, 0, 0, 0);
+      const unsigned int n_cells = matrix_free.n_macro_cells();
+      const unsigned int n_q_points = matrix_free.get_n_q_points();
+      velocity_values.reinit(n_cells, n_q_points);
+      velocity_gradients.reinit(n_cells, n_q_points);
+      for (unsigned int cell = 0; cell < n_cells; ++cell)
+        {
+          velocity.reinit(cell);
+          velocity.read_dof_values_plain(src_buffer);
+          velocity.evaluate(true, true);
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              velocity_values(cell, q) = velocity.get_value(q);
+              velocity_gradients(cell, q) = velocity.get_gradient(q);
+            }
+        }
+      src_buffer.zero_out_ghosts();
+
+      constrained_dofs.clear();
+      constrained_diagonal.clear();
+      for (unsigned int b = 0; b < block_indices.size(); ++b)
+        {
+          for (const auto i : block_indices[b])
+            {
+              if (constraints.is_constrained(block_offsets[b] + i))
+                {
+                  constrained_dofs.push_back(block_offsets[b] + i);
+                  constrained_diagonal.push_back(
+                    system.block(b, b).diag_element(i));
+                }
+            }
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::vmult(
+      PETScWrappers::MPI::BlockVector &dst,
+      const PETScWrappers::MPI::BlockVector &src) const
+    {
+      copy_to(src, src_buffer);
+      constrained_values.resize(constrained_dofs.size());
+      for (unsigned int k = 0; k < constrained_dofs.size(); ++k)
+        {
+          constrained_values[k] = src_buffer(constrained_dofs[k]);
+          src_buffer(constrained_dofs[k]) = 0;
+        }
+      matrix_free.cell_loop(
+        &SystemOperator::local_apply, this, dst_buffer, src_buffer, true);
+      for (unsigned int k = 0; k < constrained_dofs.size(); ++k)
+        {
+          dst_buffer(constrained_dofs[k]) =
+            constrained_diagonal[k] * constrained_values[k];
+        }
+      copy_from(dst_buffer, dst);
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::local_apply(
+      const MatrixFree<dim, double> &data,
+      VectorType &dst,
+      const VectorType &src,
+      const std::pair<unsigned int, unsigned int> &range) const
+    {
+      FEEvaluation<dim, -1, 0, dim> velocity(data, 0, 0, 0);
+      FEEvaluation<dim, -1, 0, 1> pressure(data, 0, 0, dim);
+      const unsigned int n_q_points = data.get_n_q_points();
+      for (unsigned int cell = range.first; cell < range.second; ++cell)
+        {
+          velocity.reinit(cell);
+          pressure.reinit(cell);
+          velocity.read_dof_values(src);
+          velocity.evaluate(true, true);
+          pressure.read_dof_values(src);
+          pressure.evaluate(true, false);
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const auto du = velocity.get_value(q);
+              const auto grad_du = velocity.get_gradient(q);
+              const auto div_du = velocity.get_divergence(q);
+              const auto dp = pressure.get_value(q);
+              const auto &u = velocity_values(cell, q);
+              const auto &grad_u = velocity_gradients(cell, q);
+              // Convection and inertia are tested with the velocity, while
+              // diffusion, pressure and Grad-Div with its gradient.
+              velocity.submit_value(
+                rho * (grad_u * du + grad_du * u + du / dt), q);
+              Tensor<2, dim, VectorizedArray<double>> flux =
+                viscosity * grad_du;
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  flux[d][d] += gamma * rho * div_du - dp;
+                }
+              velocity.submit_gradient(flux, q);
+              pressure.submit_value(-div_du, q);
+            }
+          velocity.integrate(true, true);
+          velocity.distribute_local_to_global(dst);
+          pressure.integrate(true, false);
+          pressure.distribute_local_to_global(dst);
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::copy_to(
+      const PETScWrappers::MPI::BlockVector &src, VectorType &dst) const
+    {
+      for (unsigned int b = 0; b < block_indices.size(); ++b)
+        {
+          values_buffer.resize(block_indices[b].size());
+          src.block(b).extract_subvector_to(block_indices[b], values_buffer);
+          for (unsigned int k = 0; k < block_indices[b].size(); ++k)
+            {
+              dst(block_offsets[b] + block_indices[b][k]) = values_buffer[k];
+            }
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::SystemOperator::copy_from(
+      const VectorType &src, PETScWrappers::MPI::BlockVector &dst) const
+    {
+      for (unsigned int b = 0; b < block_indices.size(); ++b)
+        {
+          values_buffer.resize(block_indices[b].size());
+          for (unsigned int k = 0; k < block_indices[b].size(); ++k)
+            {
+              values_buffer[k] = src(block_offsets[b] + block_indices[b][k]);
+            }
+          dst.block(b).set(block_indices[b], values_buffer);
+        }
+      dst.compress(VectorOperation::insert);
     }
 
     template <int dim>
@@ -140,11 +380,84 @@ namespace Fluid
           "Velocity finite element should be one order higher than pressure!"));
     }
 
+    template <int dim>
+    void InsIM<dim>::add_memory_usage(Utils::MemoryReport &report) const
+    {
+      FluidSolver<dim>::add_memory_usage(report);
+      report.add("fluid preconditioner",
+                 preconditioner ? preconditioner->memory_consumption() : 0);
+      std::size_t multigrid_memory = 0;
+      if (velocity_multigrid)
+        {
+          multigrid_memory += velocity_multigrid->memory_consumption();
+        }
+      if (pressure_multigrid)
+        {
+          multigrid_memory += pressure_multigrid->memory_consumption();
+        }
+      report.add("fluid multigrid", multigrid_memory);
+    }
+
     template <int dim>
     void InsIM<dim>::initialize_system()
     {
       FluidSolver<dim>::initialize_system();
       preconditioner.reset();
+      if (parameters.fluid_matrix_free)
+        {
+          if (!system_operator)
+            {
+              system_operator = std::make_shared<SystemOperator>();
+            }
+          system_operator->reinit(dof_handler,
+                                  owned_partitioning,
+                                  locally_relevant_dofs,
+                                  parameters.fluid_velocity_degree);
+        }
+      if (parameters.velocity_block_preconditioner.type == "GMG")
+        {
+          Utils::StartupScope startup("fluid multigrid setup");
+          // The masked velocity components are zero on the Dirichlet
+          // boundaries of every level, 1-x, 2-y, 4-z as in
+          // make_constraints().
+          std::map<types::boundary_id, ComponentMask> dirichlet_boundaries;
+          for (const auto &bc : parameters.fluid_dirichlet_bcs)
+            {
+              std::vector<bool> mask(dim);
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  mask[d] = bc.second.first & (1u << d);
+                }
+              dirichlet_boundaries[bc.first] = ComponentMask(mask);
+            }
+          if (!velocity_multigrid)
+            {
+              velocity_multigrid =
+                std::make_shared<PreconditionGMG<dim, dim>>();
+            }
+          velocity_multigrid->reinit(
+            dof_handler, 0, owned_partitioning[0], 0, dirichlet_boundaries);
+        }
+      if (parameters.pressure_schur_preconditioner.type == "GMG")
+        {
+          Utils::StartupScope startup("fluid multigrid setup");
+          if (!pressure_multigrid)
+            {
+              pressure_multigrid = std::make_shared<PreconditionGMG<dim, 1>>();
+            }
+          pressure_multigrid->reinit(
+            dof_handler, dim, owned_partitioning[1], dofs_per_block[0], {});
+          // The pressure is only fixed by the velocity boundary conditions,
+          // so the Laplacian has natural conditions everywhere. A mass term
+          // of the order of its smallest nonzero eigenvalue,
+          // \f$(\pi/L)^2\f$ with the size L of the domain, makes it
+          // definite without changing its spectrum much. Every process
+          // knows the vertices of the coarse mesh.
+          const auto box = GridTools::compute_bounding_box(triangulation);
+          const double size = box.get_boundary_points().first.distance(
+            box.get_boundary_points().second);
+          pressure_multigrid_mass = std::pow(numbers::PI / size, 2);
+        }
       newton_update.reinit(owned_partitioning, mpi_communicator);
       evaluation_point.reinit(
         owned_partitioning, relevant_partitioning, mpi_communicator);
@@ -153,10 +466,12 @@ namespace Fluid
     template <int dim>
     void InsIM<dim>::assemble(const bool use_nonzero_constraints)
     {
-      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::TimerScope timer_section(timer, "Assemble system");
+      OPENIFEM_KERNEL_SCOPE("insim_assemble");
 
       const double viscosity = parameters.viscosity;
       const double gamma = parameters.grad_div;
+      const double delta_t = effective_delta_t();
       Tensor<1, dim> gravity;
       for (unsigned int i = 0; i < dim; ++i)
         gravity[i] = parameters.gravity[i];
@@ -165,16 +480,6 @@ namespace Fluid
       mass_matrix = 0;
       system_rhs = 0;
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
-
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
       const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -187,211 +492,404 @@ namespace Fluid
       const FEValuesExtractors::Vector velocities(0);
       const FEValuesExtractors::Scalar pressure(dim);
 
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
+      // Every thread evaluates the cells with its own copy of the cell FE
+      // data and its own buffers.
+      struct ScratchData
+      {
+        ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                    const FiniteElement<dim> &fe,
+                    const Quadrature<dim - 1> &face_quad,
+                    const unsigned int n_q_points)
+          : cell_fe_data(cell_fe_data),
+            fe_face_values(fe,
+                           face_quad,
+                           update_values | update_normal_vectors |
+                             update_quadrature_points | update_JxW_values),
+            current_velocity_values(n_q_points),
+            current_velocity_gradients(n_q_points),
+            current_pressure_values(n_q_points),
+            present_velocity_values(n_q_points),
+            fsi_acc_values(n_q_points),
+            div_phi_u(fe.dofs_per_cell),
+            phi_u(fe.dofs_per_cell),
+            grad_phi_u(fe.dofs_per_cell),
+            phi_p(fe.dofs_per_cell)
+        {
+        }
+        ScratchData(const ScratchData &scratch)
+          : cell_fe_data(scratch.cell_fe_data),
+            fe_face_values(scratch.fe_face_values.get_fe(),
+                           scratch.fe_face_values.get_quadrature(),
+                           scratch.fe_face_values.get_update_flags()),
+            current_velocity_values(scratch.current_velocity_values),
+            current_velocity_gradients(scratch.current_velocity_gradients),
+            current_pressure_values(scratch.current_pressure_values),
+            present_velocity_values(scratch.present_velocity_values),
+            fsi_acc_values(scratch.fsi_acc_values),
+            div_phi_u(scratch.div_phi_u),
+            phi_u(scratch.phi_u),
+            grad_phi_u(scratch.grad_phi_u),
+            phi_p(scratch.phi_p)
+        {
+        }
+        Utils::CellFEDataCache<dim> cell_fe_data;
+        FEFaceValues<dim> fe_face_values;
+        std::vector<Tensor<1, dim>> current_velocity_values;
+        std::vector<Tensor<2, dim>> current_velocity_gradients;
+        std::vector<double> current_pressure_values;
+        std::vector<Tensor<1, dim>> present_velocity_values;
+        std::vector<Tensor<1, dim>> fsi_acc_values;
+        std::vector<double> div_phi_u;
+        std::vector<Tensor<1, dim>> phi_u;
+        std::vector<Tensor<2, dim>> grad_phi_u;
+        std::vector<double> phi_p;
+      };
+      // The local contributions of a cell, which are distributed to the
+      // global system in the order of the cells.
+      struct CopyData
+      {
+        CopyData(const unsigned int dofs_per_cell)
+          : local_matrix(dofs_per_cell, dofs_per_cell),
+            local_mass_matrix(dofs_per_cell, dofs_per_cell),
+            local_rhs(dofs_per_cell),
+            local_dof_indices(dofs_per_cell)
+        {
+        }
+        FullMatrix<double> local_matrix;
+        FullMatrix<double> local_mass_matrix;
+        Vector<double> local_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+      };
 
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+      // The current solution, the history of the time derivative, which is
+      // the present solution unless BDF2 is used, and the FSI acceleration of
+      // the artificial fluid cells.
+      auto read = [this](
+                    const typename DoFHandler<dim>::active_cell_iterator &cell,
+                    std::vector<Vector<double>> &dof_values) {
+        cell->get_dof_values(evaluation_point, dof_values[0]);
+        cell->get_dof_values(time_history(), dof_values[1]);
+        if (cell_property.indicator(cell) == 1)
+          cell->get_dof_values(fsi_acceleration, dof_values[2]);
+      };
 
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
+      auto worker = [&](const Utils::CellJob<dim> &job,
+                        ScratchData &scratch,
+                        CopyData &copy) {
+        const auto &cell = job.cell;
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_mass_matrix = copy.local_mass_matrix;
+        Vector<double> &local_rhs = copy.local_rhs;
+        const Vector<double> &current_dof_values = job.dof_values[0];
+        const Vector<double> &present_dof_values = job.dof_values[1];
+        const Vector<double> &fsi_acc_dof_values = job.dof_values[2];
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<Tensor<1, dim>> &present_velocity_values =
+          scratch.present_velocity_values;
+        std::vector<Tensor<1, dim>> &fsi_acc_values = scratch.fsi_acc_values;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
 
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
+        // Only the artificial fluid cells have FSI terms.
+        const int ind = cell_property.indicator(cell);
+        const auto &p = cell_property.get_data(cell);
 
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
-            {
-              auto p = cell_property.get_data(cell);
+        cell_fe_data.reinit(cell);
 
-              fe_values.reinit(cell);
+        local_matrix = 0;
+        local_mass_matrix = 0;
+        local_rhs = 0;
 
-              local_matrix = 0;
-              local_mass_matrix = 0;
-              local_rhs = 0;
+        if (ind == 1)
+          {
+            cell_fe_data.get_velocity_values(fsi_acc_dof_values,
+                                             fsi_acc_values);
+          }
 
-              fe_values[velocities].get_function_values(
-                evaluation_point, current_velocity_values);
+        cell_fe_data.get_velocity_values(current_dof_values,
+                                         current_velocity_values);
 
-              fe_values[velocities].get_function_gradients(
-                evaluation_point, current_velocity_gradients);
+        cell_fe_data.get_velocity_gradients(current_dof_values,
+                                            current_velocity_gradients);
 
-              fe_values[pressure].get_function_values(evaluation_point,
-                                                      current_pressure_values);
+        cell_fe_data.get_pressure_values(current_dof_values,
+                                         current_pressure_values);
 
-              fe_values[velocities].get_function_values(
-                present_solution, present_velocity_values);
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         present_velocity_values);
 
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
+        // Assemble the system matrix and mass matrix simultaneouly.
+        // The mass matrix only uses the (0, 0) and (1, 1) blocks.
+        //
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            const double rho = parameters.fluid_rho;
+            for (unsigned int k = 0; k < dofs_per_cell; ++k)
+              {
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
+              }
 
-              // Assemble the system matrix and mass matrix simultaneouly.
-              // The mass matrix only uses the (0, 0) and (1, 1) blocks.
-              //
-              for (unsigned int q = 0; q < n_q_points; ++q)
-                {
-                  const int ind = p[0]->indicator;
-                  const double rho = parameters.fluid_rho;
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                    {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
-                    }
-
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                        {
-                          // Let the linearized diffusion, continuity and
-                          // Grad-Div
-                          // term be written as
-                          // the bilinear operator: \f$A = a((\delta{u},
-                          // \delta{p}), (\delta{v}, \delta{q}))\f$,
-                          // the linearized convection term be: \f$C =
-                          // c(u;\delta{u}, \delta{v})\f$,
-                          // and the linearized inertial term be:
-                          // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A +
-                          // C) + M/{\Delta{t}}\f$
-                          local_matrix(i, j) +=
-                            (viscosity *
-                               scalar_product(grad_phi_u[j], grad_phi_u[i]) +
-                             current_velocity_gradients[q] * phi_u[j] *
-                               phi_u[i] * rho +
-                             grad_phi_u[j] * current_velocity_values[q] *
-                               phi_u[i] * rho -
-                             div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
-                             gamma * div_phi_u[j] * div_phi_u[i] * rho +
-                             phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
-                            fe_values.JxW(q);
-                          local_mass_matrix(i, j) +=
-                            (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                            fe_values.JxW(q);
-                        }
-
-                      // RHS is \f$-(A_{current} + C_{current}) -
-                      // M_{present-current}/\Delta{t}\f$.
-                      double current_velocity_divergence =
-                        trace(current_velocity_gradients[q]);
-                      local_rhs(i) +=
-                        ((-viscosity *
-                            scalar_product(current_velocity_gradients[q],
-                                           grad_phi_u[i]) -
-                          current_velocity_gradients[q] *
-                            current_velocity_values[q] * phi_u[i] * rho +
-                          current_pressure_values[q] * div_phi_u[i] +
-                          current_velocity_divergence * phi_p[i] -
-                          gamma * current_velocity_divergence * div_phi_u[i] *
-                            rho) -
-                         (current_velocity_values[q] -
-                          present_velocity_values[q]) *
-                           phi_u[i] / time.get_delta_t() * rho +
-                         gravity * phi_u[i] * rho) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho * phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
-                    }
-                }
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                  {
+                    // Let the linearized diffusion, continuity and Grad-Div
+                    // term be written as
+                    // the bilinear operator: \f$A = a((\delta{u},
+                    // \delta{p}), (\delta{v}, \delta{q}))\f$,
+                    // the linearized convection term be: \f$C =
+                    // c(u;\delta{u}, \delta{v})\f$,
+                    // and the linearized inertial term be:
+                    // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A +
+                    // C) + M/{\Delta{t}}\f$
+                    local_matrix(i, j) +=
+                      (viscosity *
+                         scalar_product(grad_phi_u[j], grad_phi_u[i]) +
+                       current_velocity_gradients[q] * phi_u[j] * phi_u[i] *
+                         rho +
+                       grad_phi_u[j] * current_velocity_values[q] * phi_u[i] *
+                         rho -
+                       div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
+                       gamma * div_phi_u[j] * div_phi_u[i] * rho +
+                       phi_u[i] * phi_u[j] / delta_t * rho) *
+                      cell_fe_data.JxW(q);
+                    local_mass_matrix(i, j) +=
+                      (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
+                      cell_fe_data.JxW(q);
+                  }
 
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
-                {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
-                    {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
-                        {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
-                            {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
-                            }
-                        }
-                    }
-                }
+                // RHS is \f$-(A_{current} + C_{current}) -
+                // M_{present-current}/\Delta{t}\f$.
+                double current_velocity_divergence =
+                  trace(current_velocity_gradients[q]);
+                local_rhs(i) +=
+                  ((-viscosity * scalar_product(current_velocity_gradients[q],
+                                                grad_phi_u[i]) -
+                    current_velocity_gradients[q] * current_velocity_values[q] *
+                      phi_u[i] * rho +
+                    current_pressure_values[q] * div_phi_u[i] +
+                    current_velocity_divergence * phi_p[i] -
+                    gamma * current_velocity_divergence * div_phi_u[i] * rho) -
+                   (current_velocity_values[q] - present_velocity_values[q]) *
+                     phi_u[i] / delta_t * rho +
+                   gravity * phi_u[i] * rho) *
+                  cell_fe_data.JxW(q);
+                if (ind == 1)
+                  {
+                    local_rhs(i) +=
+                      (scalar_product(grad_phi_u[i], p.fsi_stress) +
+                       (fsi_acc_values[q] * rho * phi_u[i])) *
+                      cell_fe_data.JxW(q);
+                  }
+              }
+          }
 
-              cell->get_dof_indices(local_dof_indices);
-
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
-              constraints_used.distribute_local_to_global(local_matrix,
-                                                          local_rhs,
-                                                          local_dof_indices,
-                                                          system_matrix,
-                                                          system_rhs,
-                                                          true);
-              constraints_used.distribute_local_to_global(
-                local_mass_matrix, local_dof_indices, mass_matrix);
-            }
-        }
+        // Impose pressure boundary here if specified, loop over faces on the
+        // cell
+        // and apply pressure boundary conditions:
+        // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+        if (parameters.n_fluid_neumann_bcs != 0)
+          {
+            for (unsigned int face_n = 0;
+                 face_n < GeometryInfo<dim>::faces_per_cell;
+                 ++face_n)
+              {
+                if (cell->at_boundary(face_n) &&
+                    parameters.fluid_neumann_bcs.find(
+                      cell->face(face_n)->boundary_id()) !=
+                      parameters.fluid_neumann_bcs.end())
+                  {
+                    fe_face_values.reinit(cell, face_n);
+                    unsigned int p_bc_id = cell->face(face_n)->boundary_id();
+                    double boundary_values_p =
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
+                    for (unsigned int q = 0; q < n_face_q_points; ++q)
+                      {
+                        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                          {
+                            local_rhs(i) +=
+                              -(fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
+                          }
+                      }
+                  }
+              }
+          }
+
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
+
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      auto copier = [&](const CopyData &copy) {
+        constraints_used.distribute_local_to_global(copy.local_matrix,
+                                                    copy.local_rhs,
+                                                    copy.local_dof_indices,
+                                                    system_matrix,
+                                                    system_rhs,
+                                                    true);
+        constraints_used.distribute_local_to_global(
+          copy.local_mass_matrix, copy.local_dof_indices, mass_matrix);
+      };
 
-      system_matrix.compress(VectorOperation::add);
-      mass_matrix.compress(VectorOperation::add);
-      system_rhs.compress(VectorOperation::add);
+      // The interior cells only read owned values, the ghost values of the
+      // evaluation point are only needed for the other cells.
+      const ScratchData sample_scratch(
+        cell_fe_data, fe, face_quad_formula, n_q_points);
+      const CopyData sample_copy(dofs_per_cell);
+      Utils::run_on_cells<dim>(
+        interior_cells, 3, read, worker, copier, sample_scratch, sample_copy);
+      evaluation_point_update.finish();
+      Utils::run_on_cells<dim>(ghost_touching_cells,
+                               3,
+                               read,
+                               worker,
+                               copier,
+                               sample_scratch,
+                               sample_copy);
+
+      Utils::compress_add({&system_matrix, &mass_matrix}, {&system_rhs});
     }
 
     template <int dim>
     std::pair<unsigned int, double>
     InsIM<dim>::solve(const bool use_nonzero_constraints)
     {
-      TimerOutput::Scope timer_section(timer, "Solve linear system");
-      preconditioner.reset(new BlockSchurPreconditioner(timer2,
-                                                        parameters.grad_div,
-                                                        parameters.viscosity,
-                                                        parameters.fluid_rho,
-                                                        time.get_delta_t(),
-                                                        owned_partitioning,
-                                                        system_matrix,
-                                                        mass_matrix,
-                                                        mass_schur));
+      Utils::TimerScope timer_section(timer, "Solve linear system");
+      const double delta_t = effective_delta_t();
+      // A reused preconditioner keeps a copy of the velocity block for MUMPS,
+      // which would otherwise refactorize whenever the matrix changes.
+      if (!preconditioner ||
+          preconditioner_reuse.need_rebuild(delta_t, system_matrix.block(0, 0)))
+        {
+          Timer setup_timer;
+          Utils::StartupScope startup("fluid preconditioner setup");
+          // The level operators of the velocity leave out the convection, so
+          // that they are symmetric and smoothed by Chebyshev iterations.
+          if (velocity_multigrid)
+            {
+              velocity_multigrid->initialize(
+                system_matrix.block(0, 0),
+                typename PreconditionGMG<dim, dim>::AdditionalData(
+                  parameters.fluid_rho / delta_t,
+                  parameters.viscosity,
+                  parameters.grad_div * parameters.fluid_rho,
+                  parameters.velocity_block_preconditioner
+                    .gmg_smoothing_degree));
+            }
+          // The mass Schur complement and its preconditioner are kept until
+          // the mesh or the constrained dofs change.
+          if (update_mass_schur())
+            {
+              if (pressure_multigrid)
+                {
+                  pressure_multigrid->initialize(
+                    mass_schur.block(1, 1),
+                    typename PreconditionGMG<dim, 1>::AdditionalData(
+                      pressure_multigrid_mass,
+                      1,
+                      0,
+                      parameters.pressure_schur_preconditioner
+                        .gmg_smoothing_degree));
+                  schur_preconditioner = pressure_multigrid;
+                }
+              else
+                {
+                  Utils::TimerScope timer_section(timer2, "CG for Sm");
+                  schur_preconditioner = make_preconditioner(
+                    mass_schur.block(1, 1),
+                    parameters.pressure_schur_preconditioner,
+                    dim,
+                    true);
+                }
+            }
+          preconditioner.reset(new BlockSchurPreconditioner(
+            timer2,
+            parameters.grad_div,
+            parameters.viscosity,
+            parameters.fluid_rho,
+            delta_t,
+            owned_partitioning,
+            system_matrix,
+            mass_matrix,
+            mass_schur,
+            parameters.velocity_block_preconditioner,
+            velocity_multigrid,
+            schur_preconditioner,
+            parameters.velocity_block_tolerance,
+            preconditioner_reuse.lagged()));
+          preconditioner_reuse.rebuilt(delta_t, system_matrix.block(0, 0));
+          solver_log.add_preconditioner_setup(setup_timer.wall_time());
+        }
 
+      const double rhs_norm = system_rhs.l2_norm();
+      const double eta = parameters.fluid_forcing_term == "Eisenstat-Walker"
+                           ? forcing_term.next(rhs_norm)
+                           : 1e-4;
       SolverControl solver_control(
-        system_matrix.m(), std::max(1e-12, 1e-4 * system_rhs.l2_norm()), true);
+        system_matrix.m(), std::max(1e-12, eta * rhs_norm), true);
       // Because PETScWrappers::SolverGMRES requires preconditioner derived
       // from PETScWrappers::PreconditionBase, we use dealii SolverFGMRES.
       GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
       SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
                                                           vector_memory);
 
-      // The solution vector must be non-ghosted
-      gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
-
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+
+      // The inner iterations are accumulated over the life of the
+      // preconditioner.
+      const auto inner_iterations = preconditioner->inner_iterations();
+      // The solution vector must be non-ghosted
+      if (parameters.fluid_matrix_free)
+        {
+          system_operator->update(evaluation_point,
+                                  constraints_used,
+                                  system_matrix,
+                                  parameters.viscosity,
+                                  parameters.grad_div,
+                                  parameters.fluid_rho,
+                                  delta_t);
+          gmres.solve(
+            *system_operator, newton_update, system_rhs, *preconditioner);
+        }
+      else
+        {
+          gmres.solve(
+            system_matrix, newton_update, system_rhs, *preconditioner);
+        }
+      preconditioner_reuse.record(solver_control.last_step());
+      solver_log.add_linear_solve(solver_control.last_step(),
+                                  solver_control.last_value());
+      for (const auto &inner : preconditioner->inner_iterations())
+        {
+          solver_log.add_inner_iterations(
+            inner.first, inner.second - inner_iterations.at(inner.first));
+        }
+
       constraints_used.distribute(newton_update);
 
+      if (parameters.velocity_block_preconditioner.type != "MUMPS")
+        {
+          const auto statistics = preconditioner->velocity_statistics();
+          pcout << "   AMG for A_inv: " << statistics.second
+                << " iterations in " << statistics.first << " applications"
+                << std::endl;
+        }
+
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
@@ -399,6 +897,7 @@ namespace Fluid
     void InsIM<dim>::run_one_step(bool apply_nonzero_constraints,
                                   bool assemble_system)
     {
+      Utils::TraceScope trace("Run one step", "fluid");
       static_cast<void>(assemble_system);
       std::cout.precision(6);
       std::cout.width(12);
@@ -412,6 +911,7 @@ namespace Fluid
       pcout << std::string(96, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
+      update_time_history();
 
       // Resetting
       double current_residual = 1.0;
@@ -419,6 +919,19 @@ namespace Fluid
       double relative_residual = 1.0;
       unsigned int outer_iteration = 0;
       evaluation_point = present_solution;
+      // Start from the extrapolated solution unless the boundary values are
+      // applied in this step, which assumes the present solution.
+      if (!apply_nonzero_constraints)
+        {
+          PETScWrappers::MPI::BlockVector guess;
+          guess.reinit(owned_partitioning, mpi_communicator);
+          if (solution_predictor.predict(guess, time.get_delta_t()))
+            {
+              evaluation_point = guess;
+            }
+        }
+      forcing_term.reset();
+      unsigned int total_iterations = 0;
       while (relative_residual > parameters.fluid_tolerance &&
              current_residual > 1e-11)
         {
@@ -437,6 +950,8 @@ namespace Fluid
           assemble(apply_nonzero_constraints && outer_iteration == 0);
           auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
           current_residual = system_rhs.l2_norm();
+          total_iterations += state.first;
+          solver_log.add_newton_iteration(current_residual);
 
           // Update evaluation_point. Since newton_update has been set to
           // the correct bc values, there is no need to distribute the
@@ -446,7 +961,7 @@ namespace Fluid
           tmp.reinit(owned_partitioning, mpi_communicator);
           tmp = evaluation_point;
           tmp += newton_update;
-          evaluation_point = tmp;
+          evaluation_point_update.start(evaluation_point, tmp);
 
           if (outer_iteration == 0)
             {
@@ -462,6 +977,10 @@ namespace Fluid
 
           outer_iteration++;
         }
+      evaluation_point_update.finish();
+      pcout << " NEWTON_ITR = " << outer_iteration
+            << " TOTAL_GMRES_ITR = " << total_iterations << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
       // Update solution increment, which is used in FSI application.
       PETScWrappers::MPI::BlockVector tmp1, tmp2;
       tmp1.reinit(owned_partitioning, mpi_communicator);
@@ -471,14 +990,22 @@ namespace Fluid
       tmp2 -= tmp1;
       solution_increment = tmp2;
       // Newton iteration converges, update time and solution
+      record_previous_solution();
       present_solution = evaluation_point;
-      // Update stress for output
-      update_stress();
+      solution_predictor.record(tmp1, time.get_delta_t());
+      // Choose the next time step size
+      adapt_time_step(outer_iteration);
       // Output
       if (parameters.simulation_type == "Fluid" && time.time_to_save())
         {
           save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Fluid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          save_buddy_checkpoint(time.get_timestep());
+        }
+      write_monitors();
       if (time.time_to_output())
         {
           output_results(time.get_timestep());
@@ -486,7 +1013,8 @@ namespace Fluid
       if (parameters.simulation_type == "Fluid" && time.time_to_refine())
         {
           refine_mesh(parameters.global_refinements[0],
-                      parameters.global_refinements[0] + 3);
+                      parameters.global_refinements[0] +
+                        parameters.refinement_levels);
         }
     }
 
@@ -494,29 +1022,44 @@ namespace Fluid
     void InsIM<dim>::run()
     {
       pcout << "Running with PETSc on "
-            << Utilities::MPI::n_mpi_processes(mpi_communicator)
-            << " MPI rank(s)..." << std::endl;
+            << Utils::parallel_configuration(mpi_communicator) << "..."
+            << std::endl;
 
       // Try load from previous computation
       bool success_load = load_checkpoint();
       if (!success_load)
         {
-          triangulation.refine_global(parameters.global_refinements[0]);
+          Utils::refine_global_cached(triangulation,
+                                      parameters.global_refinements[0],
+                                      parameters.mesh_cache);
           setup_dofs();
           make_constraints();
           initialize_system();
         }
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
 
       // Time loop.
       // use_nonzero_constraints is set to true only at the first time step,
       // which means nonzero_constraints will be applied at the first iteration
       // in the first time step only, and never be used again.
       // This corresponds to time-independent Dirichlet BCs.
+      Utils::StartupProfile::instance().begin_steps();
       run_one_step(true);
+      Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
       while (time.end() - time.current() > 1e-12)
         {
           run_one_step(false);
+          Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                      time.current());
+          if (reached_steady_state())
+            {
+              break;
+            }
         }
+      Utils::Tracer::instance().write(mpi_communicator);
     }
 
     template class InsIM<2>;
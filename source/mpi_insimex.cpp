@@ -14,7 +14,8 @@ namespace Fluid
       const std::vector<IndexSet> &owned_partitioning,
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       const PETScWrappers::MPI::BlockSparseMatrix &mass,
-      PETScWrappers::MPI::BlockSparseMatrix &schur)
+      const PETScWrappers::MPI::BlockSparseMatrix &schur,
+      const Parameters::PreconditionerSettings &velocity_preconditioner)
       : timer2(timer2),
         gamma(gamma),
         viscosity(viscosity),
@@ -22,25 +23,20 @@ namespace Fluid
         dt(dt),
         system_matrix(&system),
         mass_matrix(&mass),
-        mass_schur(&schur)
+        mass_schur(&schur),
+        mp_iterations(0),
+        sm_iterations(0),
+        a_iterations(0)
     {
-      TimerOutput::Scope timer_section(timer2, "CG for Sm");
-      // The sparsity pattern of mass_schur is already set,
-      // we calculate its value in the following.
-      PETScWrappers::MPI::BlockVector tmp1, tmp2;
-      tmp1.reinit(owned_partitioning, mass_matrix->get_mpi_communicator());
-      tmp2.reinit(owned_partitioning, mass_matrix->get_mpi_communicator());
-      tmp1 = 1;
-      tmp2 = 0;
-      // Jacobi preconditioner of matrix A is by definition inverse diag(A),
-      // this is exactly what we want to compute.
-      // Note that the mass matrix and mass schur do not include the density.
-      PETScWrappers::PreconditionJacobi jacobi(mass_matrix->block(0, 0));
-      jacobi.vmult(tmp2.block(0), tmp1.block(0));
-      // The sparsity pattern has already been set correctly, so explicitly
-      // tell mmult not to rebuild the sparsity pattern.
-      system_matrix->block(1, 0).mmult(
-        mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+      // The velocity block is symmetric with the convection treated
+      // explicitly, and the velocity elements are quadratic.
+      A_preconditioner = make_preconditioner(system_matrix->block(0, 0),
+                                             velocity_preconditioner,
+                                             dim,
+                                             true,
+                                             true);
+      utmp.reinit(owned_partitioning[0], system_matrix->get_mpi_communicator());
+      ptmp.reinit(owned_partitioning[1], system_matrix->get_mpi_communicator());
     }
 
     /**
@@ -52,10 +48,7 @@ namespace Fluid
       PETScWrappers::MPI::BlockVector &dst,
       const PETScWrappers::MPI::BlockVector &src) const
     {
-      // Temporary vectors
-      PETScWrappers::MPI::Vector utmp(src.block(0));
-      PETScWrappers::MPI::Vector tmp(src.block(1));
-      tmp = 0;
+      ptmp = 0;
 
       // This function is part of "solve linear system", but it
       // is further profiled to get a better idea of how time
@@ -64,7 +57,7 @@ namespace Fluid
       // This block computes \f$u_1 = \tilde{S}^{-1} v_1\f$,
       // where CG solvers are used for \f$M_p^{-1}\f$ and \f$S_m^{-1}\f$.
       {
-        TimerOutput::Scope timer_section(timer2, "CG for Mp");
+        Utils::TimerScope timer_section(timer2, "CG for Mp");
         SolverControl mp_control(
           src.block(1).size(), std::max(1e-10, 1e-6 * src.block(1).l2_norm()));
         PETScWrappers::SolverCG cg_mp(mp_control,
@@ -73,8 +66,9 @@ namespace Fluid
         PETScWrappers::PreconditionNone Mp_preconditioner;
         Mp_preconditioner.initialize(mass_matrix->block(1, 1));
         cg_mp.solve(
-          mass_matrix->block(1, 1), tmp, src.block(1), Mp_preconditioner);
-        tmp *= -(viscosity + gamma * rho);
+          mass_matrix->block(1, 1), ptmp, src.block(1), Mp_preconditioner);
+        mp_iterations += mp_control.last_step();
+        ptmp *= -(viscosity + gamma * rho);
       }
 
       // FIXME: There is a mysterious bug here. After refine_mesh is called,
@@ -88,7 +82,7 @@ namespace Fluid
       //
       // \f$-\frac{1}{dt}S_m^{-1}v_1\f$
       {
-        TimerOutput::Scope timer_section(timer2, "CG for Sm");
+        Utils::TimerScope timer_section(timer2, "CG for Sm");
         SolverControl sm_control(
           src.block(1).size(), std::max(1e-10, 1e-3 * src.block(1).l2_norm()));
         PETScWrappers::SolverCG cg_sm(sm_control,
@@ -99,9 +93,10 @@ namespace Fluid
                     dst.block(1),
                     src.block(1),
                     Sm_preconditioner);
+        sm_iterations += sm_control.last_step();
         dst.block(1) *= -rho / dt;
         // Adding up these two, we get \f$\tilde{S}^{-1}v_1\f$.
-        dst.block(1) += tmp;
+        dst.block(1) += ptmp;
       }
 
       // Compute \f$v_0 - B^T\tilde{S}^{-1}v_1\f$ based on \f$u_1\f$.
@@ -112,15 +107,14 @@ namespace Fluid
       // Finally, compute the product of \f$\tilde{A}^{-1}\f$ and utmp
       // using another CG solver.
       {
-        TimerOutput::Scope timer_section(timer2, "CG for A");
+        Utils::TimerScope timer_section(timer2, "CG for A");
         SolverControl a_control(src.block(0).size(),
                                 std::max(1e-12, 1e-4 * src.block(0).l2_norm()));
         PETScWrappers::SolverCG cg_a(a_control,
                                      mass_schur->get_mpi_communicator());
-        PETScWrappers::PreconditionNone A_preconditioner;
-        A_preconditioner.initialize(system_matrix->block(0, 0));
         cg_a.solve(
-          system_matrix->block(0, 0), dst.block(0), utmp, A_preconditioner);
+          system_matrix->block(0, 0), dst.block(0), utmp, *A_preconditioner);
+        a_iterations += a_control.last_step();
       }
     }
 
@@ -128,7 +122,9 @@ namespace Fluid
     InsIMEX<dim>::InsIMEX(parallel::distributed::Triangulation<dim> &tria,
                           const Parameters::AllParameters &parameters,
                           std::shared_ptr<Function<dim>> bc)
-      : FluidSolver<dim>(tria, parameters, bc)
+      : FluidSolver<dim>(tria, parameters, bc),
+        matrix_outdated(true),
+        matrix_delta_t(0)
     {
       Assert(
         parameters.fluid_velocity_degree - parameters.fluid_pressure_degree ==
@@ -142,6 +138,7 @@ namespace Fluid
     {
       FluidSolver<dim>::initialize_system();
       preconditioner.reset();
+      matrix_outdated = true;
       // newton_update is non-ghosted because the linear solver needs
       // a completely distributed vector.
       solution_increment.reinit(owned_partitioning, mpi_communicator);
@@ -151,7 +148,8 @@ namespace Fluid
     void InsIMEX<dim>::assemble(bool use_nonzero_constraints,
                                 bool assemble_system)
     {
-      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::TimerScope timer_section(timer, "Assemble system");
+      OPENIFEM_KERNEL_SCOPE("insimex_assemble");
 
       const double viscosity = parameters.viscosity;
       const double gamma = parameters.grad_div;
@@ -166,16 +164,6 @@ namespace Fluid
         }
       system_rhs = 0;
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
-
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int n_q_points = volume_quad_formula.size();
       const unsigned int n_face_q_points = face_quad_formula.size();
@@ -183,169 +171,259 @@ namespace Fluid
       const FEValuesExtractors::Vector velocities(0);
       const FEValuesExtractors::Scalar pressure(dim);
 
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
-
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_velocity_divergences(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
-
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
-
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      // Every thread evaluates the cells with its own copy of the cell FE
+      // data and its own buffers.
+      struct ScratchData
+      {
+        ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                    const FiniteElement<dim> &fe,
+                    const Quadrature<dim - 1> &face_quad,
+                    const unsigned int n_q_points)
+          : cell_fe_data(cell_fe_data),
+            fe_face_values(fe,
+                           face_quad,
+                           update_values | update_normal_vectors |
+                             update_quadrature_points | update_JxW_values),
+            current_velocity_values(n_q_points),
+            current_velocity_gradients(n_q_points),
+            current_velocity_divergences(n_q_points),
+            current_pressure_values(n_q_points),
+            fsi_acc_values(n_q_points),
+            div_phi_u(fe.dofs_per_cell),
+            phi_u(fe.dofs_per_cell),
+            grad_phi_u(fe.dofs_per_cell),
+            phi_p(fe.dofs_per_cell)
         {
-          if (cell->is_locally_owned())
-            {
-              auto p = cell_property.get_data(cell);
-              const int ind = p[0]->indicator;
-              const double rho = parameters.fluid_rho;
-
-              fe_values.reinit(cell);
-
-              if (assemble_system)
-                {
-                  local_matrix = 0;
-                  local_mass_matrix = 0;
-                }
-              local_rhs = 0;
-
-              fe_values[velocities].get_function_values(
-                present_solution, current_velocity_values);
-
-              fe_values[velocities].get_function_gradients(
-                present_solution, current_velocity_gradients);
-
-              fe_values[velocities].get_function_divergences(
-                present_solution, current_velocity_divergences);
-
-              fe_values[pressure].get_function_values(present_solution,
-                                                      current_pressure_values);
-
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
-
-              // Assemble the system matrix and mass matrix simultaneouly.
-              // The mass matrix only uses the (0, 0) and (1, 1) blocks.
-              //
-              for (unsigned int q = 0; q < n_q_points; ++q)
-                {
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                    {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
-                    }
-
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      if (assemble_system)
-                        {
-                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                            {
-                              local_matrix(i, j) +=
-                                (viscosity * scalar_product(grad_phi_u[j],
-                                                            grad_phi_u[i]) -
-                                 div_phi_u[i] * phi_p[j] -
-                                 phi_p[i] * div_phi_u[j] +
-                                 gamma * div_phi_u[j] * div_phi_u[i] * rho +
-                                 phi_u[i] * phi_u[j] / time.get_delta_t() *
-                                   rho) *
-                                fe_values.JxW(q);
-                              local_mass_matrix(i, j) +=
-                                (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                                fe_values.JxW(q);
-                            }
-                        }
-                      local_rhs(i) -=
-                        (viscosity *
-                           scalar_product(current_velocity_gradients[q],
-                                          grad_phi_u[i]) -
-                         current_velocity_divergences[q] * phi_p[i] -
-                         current_pressure_values[q] * div_phi_u[i] +
-                         gamma * current_velocity_divergences[q] *
-                           div_phi_u[i] * rho +
-                         current_velocity_gradients[q] *
-                           current_velocity_values[q] * phi_u[i] * rho -
-                         gravity * phi_u[i] * rho) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho * phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
-                    }
-                }
-
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
-                {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
-                    {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
-                        {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
-                            {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
-                            }
-                        }
-                    }
-                }
-
-              cell->get_dof_indices(local_dof_indices);
-
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
-              if (assemble_system)
-                {
-                  constraints_used.distribute_local_to_global(local_matrix,
-                                                              local_rhs,
-                                                              local_dof_indices,
-                                                              system_matrix,
-                                                              system_rhs,
-                                                              true);
-                  constraints_used.distribute_local_to_global(
-                    local_mass_matrix, local_dof_indices, mass_matrix);
-                }
-              else
-                {
-                  constraints_used.distribute_local_to_global(
-                    local_rhs, local_dof_indices, system_rhs);
-                }
-            }
         }
+        ScratchData(const ScratchData &scratch)
+          : cell_fe_data(scratch.cell_fe_data),
+            fe_face_values(scratch.fe_face_values.get_fe(),
+                           scratch.fe_face_values.get_quadrature(),
+                           scratch.fe_face_values.get_update_flags()),
+            current_velocity_values(scratch.current_velocity_values),
+            current_velocity_gradients(scratch.current_velocity_gradients),
+            current_velocity_divergences(scratch.current_velocity_divergences),
+            current_pressure_values(scratch.current_pressure_values),
+            fsi_acc_values(scratch.fsi_acc_values),
+            div_phi_u(scratch.div_phi_u),
+            phi_u(scratch.phi_u),
+            grad_phi_u(scratch.grad_phi_u),
+            phi_p(scratch.phi_p)
+        {
+        }
+        Utils::CellFEDataCache<dim> cell_fe_data;
+        FEFaceValues<dim> fe_face_values;
+        std::vector<Tensor<1, dim>> current_velocity_values;
+        std::vector<Tensor<2, dim>> current_velocity_gradients;
+        std::vector<double> current_velocity_divergences;
+        std::vector<double> current_pressure_values;
+        std::vector<Tensor<1, dim>> fsi_acc_values;
+        std::vector<double> div_phi_u;
+        std::vector<Tensor<1, dim>> phi_u;
+        std::vector<Tensor<2, dim>> grad_phi_u;
+        std::vector<double> phi_p;
+      };
+      // The local contributions of a cell, which are distributed to the
+      // global system in the order of the cells.
+      struct CopyData
+      {
+        CopyData(const unsigned int dofs_per_cell)
+          : local_matrix(dofs_per_cell, dofs_per_cell),
+            local_mass_matrix(dofs_per_cell, dofs_per_cell),
+            local_rhs(dofs_per_cell),
+            local_dof_indices(dofs_per_cell)
+        {
+        }
+        FullMatrix<double> local_matrix;
+        FullMatrix<double> local_mass_matrix;
+        Vector<double> local_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+      };
+
+      // The present solution, and the FSI acceleration of the artificial
+      // fluid cells.
+      auto read = [this](
+                    const typename DoFHandler<dim>::active_cell_iterator &cell,
+                    std::vector<Vector<double>> &dof_values) {
+        cell->get_dof_values(present_solution, dof_values[0]);
+        if (cell_property.indicator(cell) == 1)
+          cell->get_dof_values(fsi_acceleration, dof_values[1]);
+      };
+
+      auto worker = [&](const Utils::CellJob<dim> &job,
+                        ScratchData &scratch,
+                        CopyData &copy) {
+        const auto &cell = job.cell;
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        FullMatrix<double> &local_mass_matrix = copy.local_mass_matrix;
+        Vector<double> &local_rhs = copy.local_rhs;
+        const Vector<double> &present_dof_values = job.dof_values[0];
+        const Vector<double> &fsi_acc_dof_values = job.dof_values[1];
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_velocity_divergences =
+          scratch.current_velocity_divergences;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<Tensor<1, dim>> &fsi_acc_values = scratch.fsi_acc_values;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
+
+        // Only the artificial fluid cells have FSI terms.
+        const int ind = cell_property.indicator(cell);
+        const auto &p = cell_property.get_data(cell);
+        const double rho = parameters.fluid_rho;
+
+        cell_fe_data.reinit(cell);
+
+        if (assemble_system)
+          {
+            local_matrix = 0;
+            local_mass_matrix = 0;
+          }
+        local_rhs = 0;
+
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         current_velocity_values);
+
+        cell_fe_data.get_velocity_gradients(present_dof_values,
+                                            current_velocity_gradients);
+
+        cell_fe_data.get_velocity_divergences(present_dof_values,
+                                              current_velocity_divergences);
+
+        cell_fe_data.get_pressure_values(present_dof_values,
+                                         current_pressure_values);
+
+        if (ind == 1)
+          {
+            cell_fe_data.get_velocity_values(fsi_acc_dof_values,
+                                             fsi_acc_values);
+          }
+
+        // Assemble the system matrix and mass matrix simultaneouly.
+        // The mass matrix only uses the (0, 0) and (1, 1) blocks.
+        //
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            for (unsigned int k = 0; k < dofs_per_cell; ++k)
+              {
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
+              }
+
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                if (assemble_system)
+                  {
+                    for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                      {
+                        local_matrix(i, j) +=
+                          (viscosity *
+                             scalar_product(grad_phi_u[j], grad_phi_u[i]) -
+                           div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
+                           gamma * div_phi_u[j] * div_phi_u[i] * rho +
+                           phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
+                          cell_fe_data.JxW(q);
+                        local_mass_matrix(i, j) +=
+                          (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
+                          cell_fe_data.JxW(q);
+                      }
+                  }
+                local_rhs(i) -=
+                  (viscosity * scalar_product(current_velocity_gradients[q],
+                                              grad_phi_u[i]) -
+                   current_velocity_divergences[q] * phi_p[i] -
+                   current_pressure_values[q] * div_phi_u[i] +
+                   gamma * current_velocity_divergences[q] * div_phi_u[i] *
+                     rho +
+                   current_velocity_gradients[q] * current_velocity_values[q] *
+                     phi_u[i] * rho -
+                   gravity * phi_u[i] * rho) *
+                  cell_fe_data.JxW(q);
+                if (ind == 1)
+                  {
+                    local_rhs(i) +=
+                      (scalar_product(grad_phi_u[i], p.fsi_stress) +
+                       (fsi_acc_values[q] * rho * phi_u[i])) *
+                      cell_fe_data.JxW(q);
+                  }
+              }
+          }
+
+        // Impose pressure boundary here if specified, loop over faces on the
+        // cell
+        // and apply pressure boundary conditions:
+        // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+        if (parameters.n_fluid_neumann_bcs != 0)
+          {
+            for (unsigned int face_n = 0;
+                 face_n < GeometryInfo<dim>::faces_per_cell;
+                 ++face_n)
+              {
+                if (cell->at_boundary(face_n) &&
+                    parameters.fluid_neumann_bcs.find(
+                      cell->face(face_n)->boundary_id()) !=
+                      parameters.fluid_neumann_bcs.end())
+                  {
+                    fe_face_values.reinit(cell, face_n);
+                    unsigned int p_bc_id = cell->face(face_n)->boundary_id();
+                    double boundary_values_p =
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
+                    for (unsigned int q = 0; q < n_face_q_points; ++q)
+                      {
+                        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                          {
+                            local_rhs(i) +=
+                              -(fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
+                          }
+                      }
+                  }
+              }
+          }
+
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
+
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      auto copier = [&](const CopyData &copy) {
+        if (assemble_system)
+          {
+            constraints_used.distribute_local_to_global(copy.local_matrix,
+                                                        copy.local_rhs,
+                                                        copy.local_dof_indices,
+                                                        system_matrix,
+                                                        system_rhs,
+                                                        true);
+            constraints_used.distribute_local_to_global(
+              copy.local_mass_matrix, copy.local_dof_indices, mass_matrix);
+          }
+        else
+          {
+            constraints_used.distribute_local_to_global(
+              copy.local_rhs, copy.local_dof_indices, system_rhs);
+          }
+      };
+
+      Utils::run_on_locally_owned_cells(
+        dof_handler,
+        2,
+        read,
+        worker,
+        copier,
+        ScratchData(cell_fe_data, fe, face_quad_formula, n_q_points),
+        CopyData(dofs_per_cell));
 
       if (assemble_system)
         {
@@ -359,19 +437,32 @@ namespace Fluid
     std::pair<unsigned int, double>
     InsIMEX<dim>::solve(bool use_nonzero_constraints, bool assemble_system)
     {
-      TimerOutput::Scope timer_section(timer, "Solve linear system");
-      if (assemble_system)
+      Utils::TimerScope timer_section(timer, "Solve linear system");
+      // The preconditioner is only rebuilt with a new matrix.
+      if (!preconditioner ||
+          (assemble_system &&
+           preconditioner_reuse.need_rebuild(time.get_delta_t(),
+                                             system_matrix.block(0, 0))))
         {
-          preconditioner.reset(
-            new BlockSchurPreconditioner(timer2,
-                                         parameters.grad_div,
-                                         parameters.viscosity,
-                                         parameters.fluid_rho,
-                                         time.get_delta_t(),
-                                         owned_partitioning,
-                                         system_matrix,
-                                         mass_matrix,
-                                         mass_schur));
+          Timer setup_timer;
+          Utils::StartupScope startup("fluid preconditioner setup");
+          // The mass Schur complement is kept until the mesh or the
+          // constrained dofs change.
+          update_mass_schur();
+          preconditioner.reset(new BlockSchurPreconditioner(
+            timer2,
+            parameters.grad_div,
+            parameters.viscosity,
+            parameters.fluid_rho,
+            time.get_delta_t(),
+            owned_partitioning,
+            system_matrix,
+            mass_matrix,
+            mass_schur,
+            parameters.imex_velocity_block_preconditioner));
+          preconditioner_reuse.rebuilt(time.get_delta_t(),
+                                       system_matrix.block(0, 0));
+          solver_log.add_preconditioner_setup(setup_timer.wall_time());
         }
 
       SolverControl solver_control(
@@ -382,9 +473,20 @@ namespace Fluid
       SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
                                                           vector_memory);
 
+      // The inner iterations are accumulated over the life of the
+      // preconditioner.
+      const auto inner_iterations = preconditioner->inner_iterations();
       // The solution vector must be non-ghosted
       gmres.solve(
         system_matrix, solution_increment, system_rhs, *preconditioner);
+      preconditioner_reuse.record(solver_control.last_step());
+      solver_log.add_linear_solve(solver_control.last_step(),
+                                  solver_control.last_value());
+      for (const auto &inner : preconditioner->inner_iterations())
+        {
+          solver_log.add_inner_iterations(
+            inner.first, inner.second - inner_iterations.at(inner.first));
+        }
 
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
@@ -397,6 +499,7 @@ namespace Fluid
     void InsIMEX<dim>::run_one_step(bool apply_nonzero_constraints,
                                     bool assemble_system)
     {
+      Utils::TraceScope trace("Run one step", "fluid");
       std::cout.precision(6);
       std::cout.width(12);
 
@@ -412,10 +515,27 @@ namespace Fluid
 
       // Resetting
       solution_increment = 0;
-      assemble(apply_nonzero_constraints,
-               assemble_system || (parameters.simulation_type == "Fluid" &&
-                                   time.time_to_refine()));
-      auto state = solve(apply_nonzero_constraints, assemble_system);
+      // Start from the extrapolated increment unless the boundary values are
+      // applied in this step.
+      if (!apply_nonzero_constraints &&
+          solution_predictor.predict(solution_increment, time.get_delta_t()))
+        {
+          PETScWrappers::MPI::BlockVector tmp;
+          tmp.reinit(owned_partitioning, mpi_communicator);
+          tmp = present_solution;
+          solution_increment -= tmp;
+        }
+      static_cast<void>(assemble_system);
+      const bool assemble_matrix = matrix_outdated ||
+                                   apply_nonzero_constraints ||
+                                   time.get_delta_t() != matrix_delta_t;
+      assemble(apply_nonzero_constraints, assemble_matrix);
+      if (assemble_matrix)
+        {
+          matrix_outdated = false;
+          matrix_delta_t = time.get_delta_t();
+        }
+      auto state = solve(apply_nonzero_constraints, assemble_matrix);
 
       // Note we have to use a non-ghosted vector in order to do addition.
       PETScWrappers::MPI::BlockVector tmp;
@@ -423,18 +543,26 @@ namespace Fluid
       tmp = present_solution;
       tmp += solution_increment;
       present_solution = tmp;
+      solution_predictor.record(tmp, time.get_delta_t());
 
       pcout << std::scientific << std::left << " GMRES_ITR = " << std::setw(3)
             << state.first << " GMRES_RES = " << state.second << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
 
-      // Update stress for output
-      update_stress();
+      // Choose the next time step size
+      adapt_time_step(0);
 
       // Output
       if (parameters.simulation_type == "Fluid" && time.time_to_save())
         {
           save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Fluid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          save_buddy_checkpoint(time.get_timestep());
+        }
+      write_monitors();
       if (time.time_to_output())
         {
           output_results(time.get_timestep());
@@ -442,7 +570,8 @@ namespace Fluid
       if (parameters.simulation_type == "Fluid" && time.time_to_refine())
         {
           refine_mesh(parameters.global_refinements[0],
-                      parameters.global_refinements[0] + 3);
+                      parameters.global_refinements[0] +
+                        parameters.refinement_levels);
         }
     }
 
@@ -450,28 +579,42 @@ namespace Fluid
     void InsIMEX<dim>::run()
     {
       pcout << "Running with PETSc on "
-            << Utilities::MPI::n_mpi_processes(mpi_communicator)
-            << " MPI rank(s)..." << std::endl;
+            << Utils::parallel_configuration(mpi_communicator) << "..."
+            << std::endl;
 
       // Try load from previous computation
       bool success_load = load_checkpoint();
       if (!success_load)
         {
-          triangulation.refine_global(parameters.global_refinements[0]);
+          Utils::refine_global_cached(triangulation,
+                                      parameters.global_refinements[0],
+                                      parameters.mesh_cache);
           setup_dofs();
           make_constraints();
           initialize_system();
         }
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
 
       // Time loop.
+      Utils::StartupProfile::instance().begin_steps();
       while (time.end() - time.current() > 1e-12)
         {
-          // Only use nonzero constraints at the very first time step
-          // We have to assemble the LHS twice: once using nonzero_constraints,
-          // once using zero_constraints.
-          run_one_step(time.get_timestep() == 0,
-                       time.get_timestep() < 2 || success_load);
+          // Only use nonzero constraints at the very first time step.
+          // The LHS is only assembled at that step and after the mesh
+          // changes.
+          run_one_step(time.get_timestep() == 0);
+          Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                      time.current());
+          Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
+          if (reached_steady_state())
+            {
+              break;
+            }
         }
+      Utils::Tracer::instance().write(mpi_communicator);
     }
 
     template class InsIMEX<2>;
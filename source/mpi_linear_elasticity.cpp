@@ -24,7 +24,8 @@ namespace Solid
     template <int dim>
     void LinearElasticity<dim>::assemble_system(const bool is_initial)
     {
-      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::TimerScope timer_section(timer, "Assemble system");
+      OPENIFEM_KERNEL_SCOPE("linear_elasticity_assemble");
 
       double gamma = 0.5 + parameters.damping;
       double beta = gamma / 2;
@@ -44,7 +45,6 @@ namespace Solid
         update_values | update_quadrature_points | update_normal_vectors |
           update_JxW_values);
 
-      SymmetricTensor<4, dim> elasticity;
       const double rho = material[0].get_density();
       const double dt = time.get_delta_t();
 
@@ -82,7 +82,8 @@ namespace Solid
               int mat_id = cell->material_id();
               if (material.size() == 1)
                 mat_id = 1;
-              elasticity = material[mat_id - 1].get_elasticity();
+              const LinearElasticMaterial<dim> &cell_material =
+                material[mat_id - 1];
 
               // Loop over quadrature points
               for (unsigned int q = 0; q < n_q_points; ++q)
@@ -106,14 +107,15 @@ namespace Solid
                             }
                           else
                             {
+                              const double stiffness =
+                                cell_material.get_stiffness(
+                                  symmetric_grad_phi[i], symmetric_grad_phi[j]);
                               local_matrix[i][j] +=
                                 (rho * phi[i] * phi[j] +
-                                 symmetric_grad_phi[i] * elasticity *
-                                   symmetric_grad_phi[j] * beta * dt * dt) *
+                                 stiffness * beta * dt * dt) *
                                 fe_values.JxW(q);
                               local_stiffness[i][j] +=
-                                symmetric_grad_phi[i] * elasticity *
-                                symmetric_grad_phi[j] * fe_values.JxW(q);
+                                stiffness * fe_values.JxW(q);
                             }
                         }
                       // zero body force
@@ -132,11 +134,19 @@ namespace Solid
                   if (cell->face(face)->at_boundary())
                     {
                       unsigned int id = cell->face(face)->boundary_id();
-                      if (parameters.solid_neumann_bcs.find(id) !=
-                          parameters.solid_neumann_bcs.end())
+                      if (parameters.simulation_type == "FSI")
+                        {
+                          // The traction comes from the fluid.
+                          fe_face_values.reinit(cell, face);
+                          this->add_fsi_traction(
+                            cell, face, fe_face_values, local_rhs);
+                        }
+                      else if (parameters.solid_neumann_bcs.find(id) !=
+                               parameters.solid_neumann_bcs.end())
                         {
                           std::vector<double> value =
                             parameters.solid_neumann_bcs[id];
+                          neumann_table.value(id, time.current(), value);
                           Tensor<1, dim> traction;
                           if (parameters.solid_neumann_bc_type == "Traction")
                             {
@@ -192,6 +202,7 @@ namespace Solid
     template <int dim>
     void LinearElasticity<dim>::run_one_step(bool first_step)
     {
+      Utils::TraceScope trace("Run one step", "solid");
       std::cout.precision(6);
       std::cout.width(12);
 
@@ -208,6 +219,11 @@ namespace Solid
           assemble_system(false);
           this->output_results(time.get_timestep());
         }
+      else if (parameters.simulation_type == "FSI")
+        {
+          // The rhs changes with the fluid traction.
+          assemble_system(false);
+        }
 
       const double dt = time.get_delta_t();
 
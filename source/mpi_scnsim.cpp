@@ -12,8 +12,9 @@ namespace Fluid
                          const PETScWrappers::PreconditionerBase &Pvvinv)
       : timer2(timer2), system_matrix(&system), Pvv_inverse(&Pvvinv)
     {
-      dumb_vector.reinit(owned_partitioning,
-                         system_matrix->get_mpi_communicator());
+      tmp1.reinit(owned_partitioning[0], system_matrix->get_mpi_communicator());
+      tmp2.reinit(owned_partitioning[0], system_matrix->get_mpi_communicator());
+      tmp3.reinit(owned_partitioning[1], system_matrix->get_mpi_communicator());
     }
 
     template <int dim>
@@ -22,8 +23,6 @@ namespace Fluid
       const PETScWrappers::MPI::Vector &src) const
     {
       // this is the exact representation of Tpp = App - Apv * Pvv * Avp.
-      PETScWrappers::MPI::Vector tmp1(dumb_vector.block(0)),
-        tmp2(dumb_vector.block(0)), tmp3(src);
       system_matrix->block(0, 1).vmult(tmp1, src);
       Pvv_inverse->vmult(tmp2, tmp1);
       system_matrix->block(1, 0).vmult(tmp3, tmp2);
@@ -38,7 +37,9 @@ namespace Fluid
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       PETScWrappers::MPI::SparseMatrix &absA,
       PETScWrappers::MPI::SparseMatrix &schur,
-      PETScWrappers::MPI::SparseMatrix &B2pp)
+      PETScWrappers::MPI::SparseMatrix &B2pp,
+      const Parameters::PreconditionerSettings &velocity_preconditioner,
+      const Parameters::PreconditionerSettings &pressure_preconditioner)
       : timer2(timer2),
         system_matrix(&system),
         Abs_A_matrix(&absA),
@@ -46,11 +47,19 @@ namespace Fluid
         B2pp_matrix(&B2pp),
         Tpp_itr(0)
     {
-      // Initialize the Pvv inverse (the ILU(0) factorization of Avv)
-      Pvv_inverse.initialize(system_matrix->block(0, 0));
+      const MPI_Comm &mpi_communicator = system_matrix->get_mpi_communicator();
+      utmp1.reinit(owned_partitioning[0], mpi_communicator);
+      utmp2.reinit(owned_partitioning[0], mpi_communicator);
+      ptmp.reinit(owned_partitioning[1], mpi_communicator);
+      guess.reinit(owned_partitioning[1], mpi_communicator);
+      Tpp_guess.reinit(owned_partitioning[1], mpi_communicator);
+      // Initialize the Pvv inverse (by default the Euclid ILU factorization
+      // of Avv)
+      Pvv_inverse = make_preconditioner(
+        system_matrix->block(0, 0), velocity_preconditioner, dim, false, true);
       // Initialize Tpp
       Tpp.reset(new SchurComplementTpp(
-        timer2, owned_partitioning, *system_matrix, Pvv_inverse));
+        timer2, owned_partitioning, *system_matrix, *Pvv_inverse));
 
       // Compute B2pp matrix App - Apv*rowsum(|Avv|)^(-1)*Avp
       // as the preconditioner to solve Tpp^-1
@@ -127,7 +136,8 @@ namespace Fluid
       B2pp_matrix->add(-1, *schur_matrix);
       B2pp_matrix->add(1, system_matrix->block(1, 1));
       B2pp_matrix->compress(VectorOperation::add);
-      B2pp_inverse.initialize(*B2pp_matrix);
+      B2pp_inverse = make_preconditioner(
+        *B2pp_matrix, pressure_preconditioner, dim, false, false);
     }
 
     /**
@@ -143,9 +153,8 @@ namespace Fluid
       //      |I           0|*|src(0)| = |src(0)|
       //      |-ApvPvv^-1  I| |src(1)|   |ptmp  |
       /////////////////////////////////////////
-      PETScWrappers::MPI::Vector ptmp1(src.block(0)), ptmp(src.block(1));
-      Pvv_inverse.vmult(ptmp1, src.block(0));
-      this->Apv().vmult(ptmp, ptmp1);
+      Pvv_inverse->vmult(utmp1, src.block(0));
+      this->Apv().vmult(ptmp, utmp1);
       ptmp *= -1.0;
       ptmp += src.block(1);
 
@@ -158,11 +167,11 @@ namespace Fluid
       // Compute Tpp^-1 * ptmp first, which is equal to the problem Tpp*x = ptmp
       // Set up initial guess first
       {
-        PETScWrappers::MPI::Vector c(ptmp), Sc(ptmp);
-        Tpp->vmult(Sc, c);
-        double alpha = (ptmp * c) / (Sc * c);
-        c *= alpha;
-        dst.block(1) = c;
+        guess = ptmp;
+        Tpp->vmult(Tpp_guess, guess);
+        double alpha = (ptmp * guess) / (Tpp_guess * guess);
+        guess *= alpha;
+        dst.block(1) = guess;
       }
       // Compute the multiplication
       timer2.enter_subsection("Solving Tpp");
@@ -173,7 +182,7 @@ namespace Fluid
         solver_control,
         vector_memory,
         SolverGMRES<PETScWrappers::MPI::Vector>::AdditionalData(200));
-      gmres.solve(*Tpp, dst.block(1), ptmp, B2pp_inverse);
+      gmres.solve(*Tpp, dst.block(1), ptmp, *B2pp_inverse);
       // B2pp_inverse.vmult(dst.block(1), ptmp);
       // Count iterations for this solver solving Tpp inverse
       Tpp_itr += solver_control.last_step();
@@ -181,10 +190,9 @@ namespace Fluid
       timer2.leave_subsection("Solving Tpp");
 
       // Compute Pvv^-1*src(0) - Pvv^-1*Avp*dst(1)
-      PETScWrappers::MPI::Vector utmp1(src.block(0)), utmp2(src.block(0));
       this->Avp().vmult(utmp1, dst.block(1));
-      Pvv_inverse.vmult(utmp2, utmp1);
-      Pvv_inverse.vmult(dst.block(0), src.block(0));
+      Pvv_inverse->vmult(utmp2, utmp1);
+      Pvv_inverse->vmult(dst.block(0), src.block(0));
       dst.block(0) -= utmp2;
     }
 
@@ -214,7 +222,21 @@ namespace Fluid
 
       BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
       DoFTools::make_sparsity_pattern(dof_handler, dsp, nonzero_constraints);
-      sparsity_pattern.copy_from(dsp);
+
+      // Compute the sparsity pattern for mass schur in advance.
+      // The only nonzero block is (1, 1), which is the same as \f$BB^T\f$.
+      // It is computed from the local rows directly, compressing them first
+      // would allocate row offsets for all the dofs on every process.
+      DynamicSparsityPattern schur_dsp(dofs_per_block[1], dofs_per_block[1]);
+      schur_dsp.compute_mmult_pattern(dsp.block(1, 0), dsp.block(0, 1));
+
+      // Compute the pattern for B2pp perconditioner
+      for (auto itr = dsp.block(1, 1).begin(); itr != dsp.block(1, 1).end();
+           ++itr)
+        {
+          schur_dsp.add(itr->row(), itr->column());
+        }
+
       SparsityTools::distribute_sparsity_pattern(
         dsp,
         dof_handler.locally_owned_dofs_per_processor(),
@@ -227,20 +249,6 @@ namespace Fluid
                           dsp.block(0, 0),
                           mpi_communicator);
 
-      // Compute the sparsity pattern for mass schur in advance.
-      // The only nonzero block is (1, 1), which is the same as \f$BB^T\f$.
-      DynamicSparsityPattern schur_dsp(dofs_per_block[1], dofs_per_block[1]);
-      schur_dsp.compute_mmult_pattern(sparsity_pattern.block(1, 0),
-                                      sparsity_pattern.block(0, 1));
-
-      // Compute the pattern for B2pp perconditioner
-      for (auto itr = sparsity_pattern.block(1, 1).begin();
-           itr != sparsity_pattern.block(1, 1).end();
-           ++itr)
-        {
-          schur_dsp.add(itr->row(), itr->column());
-        }
-
       B2pp_matrix.reinit(owned_partitioning[1],
                          owned_partitioning[1],
                          schur_dsp,
@@ -268,25 +276,58 @@ namespace Fluid
 
       fsi_acceleration.reinit(
         owned_partitioning, relevant_partitioning, mpi_communicator);
+      // The previous solution is lost unless it is transferred.
+      previous_delta_t = 0;
+      if (parameters.fluid_time_integration == "BDF2")
+        {
+          previous_solution.reinit(
+            owned_partitioning, relevant_partitioning, mpi_communicator);
+          bdf2_history.reinit(
+            owned_partitioning, relevant_partitioning, mpi_communicator);
+        }
 
       // Cell property
       setup_cell_property();
 
-      stress = std::vector<std::vector<PETScWrappers::MPI::Vector>>(
-        dim,
-        std::vector<PETScWrappers::MPI::Vector>(
-          dim,
-          PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
-                                     mpi_communicator)));
+      // The cells have changed, so must the PML values.
+      setup_pml();
+
+      stress.clear();
 
       // Hard-coded initial condition, only for VF cases!
       // apply_initial_condition();
     }
 
+    template <int dim>
+    void SCnsIM<dim>::setup_pml()
+    {
+      cell_sigma_pml.assign(triangulation.n_active_cells(),
+                            std::vector<double>());
+      std::vector<double> sigma_pml(volume_quad_formula.size());
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          cell_fe_data.reinit(cell);
+          sigma_pml_field->value_list(
+            cell_fe_data.get_quadrature_points(), sigma_pml, 0);
+          if (std::any_of(sigma_pml.begin(), sigma_pml.end(), [](double s) {
+                return s != 0;
+              }))
+            {
+              cell_sigma_pml[cell->active_cell_index()] = sigma_pml;
+            }
+        }
+    }
+
     template <int dim>
     void SCnsIM<dim>::assemble(const bool use_nonzero_constraints)
     {
-      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::TimerScope timer_section(timer, "Assemble system");
+      OPENIFEM_KERNEL_SCOPE("scnsim_assemble");
 
       Tensor<1, dim> gravity;
       for (unsigned int i = 0; i < dim; ++i)
@@ -299,16 +340,6 @@ namespace Fluid
 
       system_rhs = 0;
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
-
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
       const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -321,401 +352,524 @@ namespace Fluid
       const FEValuesExtractors::Vector velocities(0);
       const FEValuesExtractors::Scalar pressure(dim);
 
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
-
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-      // For the linearized system, we create temporary storage for current
-      // velocity
-      // and gradient, current pressure, and present velocity. In practice, they
-      // are
-      // all obtained through their shape functions at quadrature points.
-
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> current_pressure_gradients(n_q_points);
-      std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-      std::vector<double> present_pressure_values(n_q_points);
-      std::vector<double> sigma_pml(n_q_points);
-      std::vector<Tensor<1, dim>> artificial_bf(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
-
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
-      std::vector<Tensor<1, dim>> grad_phi_p(dofs_per_cell);
+      // Every thread evaluates the cells with its own copy of the cell FE
+      // data and its own buffers.
+      struct ScratchData
+      {
+        ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                    const FiniteElement<dim> &fe,
+                    const Quadrature<dim - 1> &face_quad,
+                    const unsigned int n_q_points)
+          : cell_fe_data(cell_fe_data),
+            fe_face_values(fe,
+                           face_quad,
+                           update_values | update_normal_vectors |
+                             update_quadrature_points | update_JxW_values),
+            current_velocity_values(n_q_points),
+            current_velocity_gradients(n_q_points),
+            current_pressure_values(n_q_points),
+            current_pressure_gradients(n_q_points),
+            present_velocity_values(n_q_points),
+            present_pressure_values(n_q_points),
+            sigma_pml(n_q_points),
+            artificial_bf(n_q_points),
+            fsi_acc_values(n_q_points),
+            div_phi_u(fe.dofs_per_cell),
+            phi_u(fe.dofs_per_cell),
+            grad_phi_u(fe.dofs_per_cell),
+            phi_p(fe.dofs_per_cell),
+            grad_phi_p(fe.dofs_per_cell)
+        {
+        }
+        ScratchData(const ScratchData &scratch)
+          : cell_fe_data(scratch.cell_fe_data),
+            fe_face_values(scratch.fe_face_values.get_fe(),
+                           scratch.fe_face_values.get_quadrature(),
+                           scratch.fe_face_values.get_update_flags()),
+            current_velocity_values(scratch.current_velocity_values),
+            current_velocity_gradients(scratch.current_velocity_gradients),
+            current_pressure_values(scratch.current_pressure_values),
+            current_pressure_gradients(scratch.current_pressure_gradients),
+            present_velocity_values(scratch.present_velocity_values),
+            present_pressure_values(scratch.present_pressure_values),
+            sigma_pml(scratch.sigma_pml),
+            artificial_bf(scratch.artificial_bf),
+            fsi_acc_values(scratch.fsi_acc_values),
+            div_phi_u(scratch.div_phi_u),
+            phi_u(scratch.phi_u),
+            grad_phi_u(scratch.grad_phi_u),
+            phi_p(scratch.phi_p),
+            grad_phi_p(scratch.grad_phi_p)
+        {
+        }
+        Utils::CellFEDataCache<dim> cell_fe_data;
+        FEFaceValues<dim> fe_face_values;
+        // For the linearized system, we create temporary storage for current
+        // velocity and gradient, current pressure, and present velocity. In
+        // practice, they are all obtained through their shape functions at
+        // quadrature points.
+        std::vector<Tensor<1, dim>> current_velocity_values;
+        std::vector<Tensor<2, dim>> current_velocity_gradients;
+        std::vector<double> current_pressure_values;
+        std::vector<Tensor<1, dim>> current_pressure_gradients;
+        std::vector<Tensor<1, dim>> present_velocity_values;
+        std::vector<double> present_pressure_values;
+        std::vector<double> sigma_pml;
+        std::vector<Tensor<1, dim>> artificial_bf;
+        std::vector<Tensor<1, dim>> fsi_acc_values;
+        std::vector<double> div_phi_u;
+        std::vector<Tensor<1, dim>> phi_u;
+        std::vector<Tensor<2, dim>> grad_phi_u;
+        std::vector<double> phi_p;
+        std::vector<Tensor<1, dim>> grad_phi_p;
+      };
+      // The local contributions of a cell, which are distributed to the
+      // global system in the order of the cells.
+      struct CopyData
+      {
+        CopyData(const unsigned int dofs_per_cell)
+          : local_matrix(dofs_per_cell, dofs_per_cell),
+            local_rhs(dofs_per_cell),
+            local_dof_indices(dofs_per_cell)
+        {
+        }
+        FullMatrix<double> local_matrix;
+        Vector<double> local_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+      };
 
       // The parameters that is used in isentropic continuity equation:
       // heat capacity ratio and atmospheric pressure.
       const double cp_to_cv = 1.4;
       const double atm = 1013250;
       const double kappa_s = 1e4;
-
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
-            {
-              auto p = cell_property.get_data(cell);
-              const int ind = p[0]->indicator;
-
-              fe_values.reinit(cell);
-
-              local_matrix = 0;
-              local_rhs = 0;
-
-              fe_values[velocities].get_function_values(
-                evaluation_point, current_velocity_values);
-
-              fe_values[velocities].get_function_gradients(
-                evaluation_point, current_velocity_gradients);
-
-              fe_values[pressure].get_function_values(evaluation_point,
-                                                      current_pressure_values);
-
-              fe_values[pressure].get_function_gradients(
-                evaluation_point, current_pressure_gradients);
-
-              fe_values[velocities].get_function_values(
-                present_solution, present_velocity_values);
-
-              fe_values[pressure].get_function_values(present_solution,
-                                                      present_pressure_values);
-
-              sigma_pml_field->value_list(
-                fe_values.get_quadrature_points(), sigma_pml, 0);
-              body_force->value_list(fe_values.get_quadrature_points(),
-                                     artificial_bf);
-
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
-
-              for (unsigned int q = 0; q < n_q_points; ++q)
-                {
-                  const double rho = parameters.fluid_rho *
-                                       (1 + present_pressure_values[q] / atm) *
-                                       (1 - ind) +
-                                     ind * parameters.solid_rho;
-                  const double viscosity =
-                    (ind == 1 ? 1 : parameters.viscosity);
-
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                    {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
-                      grad_phi_p[k] = fe_values[pressure].gradient(k, q);
-                    }
-
-                  // Define the UGN based SUPG parameters (Tezduyar):
-                  // tau_SUPG and tau_PSPG. They are
-                  // evaluated based on the results from the last Newton
-                  // iteration.
-                  double tau_SUPG, tau_PSPG, tau_LSIC;
-                  // the length scale h is the length of the element in the
-                  // direction
-                  // of convection
-                  double h = 0;
-                  for (unsigned int a = 0;
-                       a < dofs_per_cell / fe.dofs_per_vertex;
-                       ++a)
-                    {
-                      h += abs(present_velocity_values[q] *
-                               fe_values.shape_grad(a, q));
-                    }
-                  if (h)
-                    h = 2 * present_velocity_values[q].norm() / h;
-                  else
-                    h = 0;
-                  double nu = viscosity / rho;
-                  double v_norm = present_velocity_values[q].norm();
-                  if (h)
-                    tau_SUPG = 1 / sqrt((pow(2 / time.get_delta_t(), 2) +
-                                         pow(2 * v_norm / h, 2) +
-                                         pow(4 * nu / pow(h, 2), 2)));
-                  else
-                    tau_SUPG = time.get_delta_t() / 2;
-                  tau_PSPG = tau_SUPG / rho;
-                  double localRe = v_norm * h / (2 * nu);
-                  double z = localRe <= 3 ? (localRe / 3) : 1;
-                  tau_LSIC = h / 2 * v_norm * z;
-
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      double current_velocity_divergence =
-                        trace(current_velocity_gradients[q]);
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                        {
-                          // Let the linearized diffusion, continuity
-                          // terms be written as
-                          // the bilinear operator: \f$A = a((\delta{u},
-                          // \delta{p}), (\delta{v}, \delta{q}))\f$,
-                          // the linearized convection term be: \f$C =
-                          // c(u;\delta{u}, \delta{v})\f$,
-                          // and the linearized inertial term be:
-                          // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A
-                          // +
-                          // C) + M/{\Delta{t}}\f$
-                          local_matrix(i, j) +=
-                            ((viscosity *
-                                scalar_product(grad_phi_u[j], grad_phi_u[i]) +
-                              rho * current_velocity_gradients[q] * phi_u[j] *
-                                phi_u[i] +
-                              rho * grad_phi_u[j] * current_velocity_values[q] *
-                                phi_u[i] -
-                              div_phi_u[i] * phi_p[j]) +
-                             rho * phi_u[i] * phi_u[j] / time.get_delta_t()) *
-                            fe_values.JxW(q);
-                          // PML attenuation
-                          local_matrix(i, j) +=
-                            (rho * sigma_pml[q] * phi_u[j] * phi_u[i] +
-                             sigma_pml[q] * phi_p[j] * phi_p[i] / atm) *
-                            fe_values.JxW(q);
-                          // Add SUPG and PSPG stabilization
-                          local_matrix(i, j) +=
-                            // SUPG Convection
-                            (tau_SUPG * rho *
-                               (current_velocity_values[q] * grad_phi_u[i]) *
-                               (phi_u[j] * current_velocity_gradients[q]) +
-                             tau_SUPG * rho *
-                               (current_velocity_values[q] * grad_phi_u[i]) *
-                               (current_velocity_values[q] * grad_phi_u[j]) +
-                             tau_SUPG * rho * (phi_u[j] * grad_phi_u[i]) *
-                               (current_velocity_values[q] *
+      const double delta_t = effective_delta_t();
+
+      // The current solution, the history of the time derivative, which is
+      // the present solution unless BDF2 is used, and the FSI acceleration of
+      // the artificial fluid cells. With BDF2 the density and the SUPG
+      // parameters are lagged to the history, which differs from the present
+      // solution by O(dt) like the lagging itself.
+      auto read = [this](
+                    const typename DoFHandler<dim>::active_cell_iterator &cell,
+                    std::vector<Vector<double>> &dof_values) {
+        cell->get_dof_values(evaluation_point, dof_values[0]);
+        cell->get_dof_values(time_history(), dof_values[1]);
+        if (cell_property.indicator(cell) == 1)
+          cell->get_dof_values(fsi_acceleration, dof_values[2]);
+      };
+
+      auto worker = [&](const Utils::CellJob<dim> &job,
+                        ScratchData &scratch,
+                        CopyData &copy) {
+        const auto &cell = job.cell;
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = copy.local_matrix;
+        Vector<double> &local_rhs = copy.local_rhs;
+        const Vector<double> &current_dof_values = job.dof_values[0];
+        const Vector<double> &present_dof_values = job.dof_values[1];
+        const Vector<double> &fsi_acc_dof_values = job.dof_values[2];
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<Tensor<1, dim>> &current_pressure_gradients =
+          scratch.current_pressure_gradients;
+        std::vector<Tensor<1, dim>> &present_velocity_values =
+          scratch.present_velocity_values;
+        std::vector<double> &present_pressure_values =
+          scratch.present_pressure_values;
+        std::vector<double> &sigma_pml = scratch.sigma_pml;
+        std::vector<Tensor<1, dim>> &artificial_bf = scratch.artificial_bf;
+        std::vector<Tensor<1, dim>> &fsi_acc_values = scratch.fsi_acc_values;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
+        std::vector<Tensor<1, dim>> &grad_phi_p = scratch.grad_phi_p;
+
+        // Only the artificial fluid cells have FSI terms.
+        const int ind = cell_property.indicator(cell);
+        const auto &p = cell_property.get_data(cell);
+
+        cell_fe_data.reinit(cell);
+
+        local_matrix = 0;
+        local_rhs = 0;
+
+        cell_fe_data.get_velocity_values(current_dof_values,
+                                         current_velocity_values);
+
+        cell_fe_data.get_velocity_gradients(current_dof_values,
+                                            current_velocity_gradients);
+
+        cell_fe_data.get_pressure_values(current_dof_values,
+                                         current_pressure_values);
+
+        cell_fe_data.get_pressure_gradients(current_dof_values,
+                                            current_pressure_gradients);
+
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         present_velocity_values);
+
+        cell_fe_data.get_pressure_values(present_dof_values,
+                                         present_pressure_values);
+
+        const std::vector<double> &cell_sigma =
+          cell_sigma_pml[cell->active_cell_index()];
+        if (cell_sigma.empty())
+          {
+            std::fill(sigma_pml.begin(), sigma_pml.end(), 0.0);
+          }
+        else
+          {
+            sigma_pml = cell_sigma;
+          }
+        body_force->value_list(cell_fe_data.get_quadrature_points(),
+                               artificial_bf);
+
+        if (ind == 1)
+          {
+            cell_fe_data.get_velocity_values(fsi_acc_dof_values,
+                                             fsi_acc_values);
+          }
+
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            const double rho = parameters.fluid_rho *
+                                 (1 + present_pressure_values[q] / atm) *
+                                 (1 - ind) +
+                               ind * parameters.solid_rho;
+            const double viscosity =
+              (ind == 1 ? 1 : parameters.viscosity);
+
+            for (unsigned int k = 0; k < dofs_per_cell; ++k)
+              {
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
+                grad_phi_p[k] = cell_fe_data.pressure_gradient(k, q);
+              }
+
+            // Define the UGN based SUPG parameters (Tezduyar):
+            // tau_SUPG and tau_PSPG. They are
+            // evaluated based on the results from the last Newton
+            // iteration.
+            double tau_SUPG, tau_PSPG, tau_LSIC;
+            // the length scale h is the length of the element in the
+            // direction
+            // of convection
+            double h = 0;
+            for (unsigned int a = 0;
+                 a < dofs_per_cell / fe.dofs_per_vertex;
+                 ++a)
+              {
+                h += abs(present_velocity_values[q] *
+                         cell_fe_data.shape_grad(a, q));
+              }
+            if (h)
+              h = 2 * present_velocity_values[q].norm() / h;
+            else
+              h = 0;
+            double nu = viscosity / rho;
+            double v_norm = present_velocity_values[q].norm();
+            if (h)
+              tau_SUPG = 1 / sqrt((pow(2 / time.get_delta_t(), 2) +
+                                   pow(2 * v_norm / h, 2) +
+                                   pow(4 * nu / pow(h, 2), 2)));
+            else
+              tau_SUPG = time.get_delta_t() / 2;
+            tau_PSPG = tau_SUPG / rho;
+            double localRe = v_norm * h / (2 * nu);
+            double z = localRe <= 3 ? (localRe / 3) : 1;
+            tau_LSIC = h / 2 * v_norm * z;
+
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                double current_velocity_divergence =
+                  trace(current_velocity_gradients[q]);
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                  {
+                    // Let the linearized diffusion, continuity
+                    // terms be written as
+                    // the bilinear operator: \f$A = a((\delta{u},
+                    // \delta{p}), (\delta{v}, \delta{q}))\f$,
+                    // the linearized convection term be: \f$C =
+                    // c(u;\delta{u}, \delta{v})\f$,
+                    // and the linearized inertial term be:
+                    // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A
+                    // +
+                    // C) + M/{\Delta{t}}\f$
+                    local_matrix(i, j) +=
+                      ((viscosity *
+                          scalar_product(grad_phi_u[j], grad_phi_u[i]) +
+                        rho * current_velocity_gradients[q] * phi_u[j] *
+                          phi_u[i] +
+                        rho * grad_phi_u[j] * current_velocity_values[q] *
+                          phi_u[i] -
+                        div_phi_u[i] * phi_p[j]) +
+                       rho * phi_u[i] * phi_u[j] / delta_t) *
+                      cell_fe_data.JxW(q);
+                    // PML attenuation
+                    local_matrix(i, j) +=
+                      (rho * sigma_pml[q] * phi_u[j] * phi_u[i] +
+                       sigma_pml[q] * phi_p[j] * phi_p[i] / atm) *
+                      cell_fe_data.JxW(q);
+                    // Add SUPG and PSPG stabilization
+                    local_matrix(i, j) +=
+                      // SUPG Convection
+                      (tau_SUPG * rho *
+                         (current_velocity_values[q] * grad_phi_u[i]) *
+                         (phi_u[j] * current_velocity_gradients[q]) +
+                       tau_SUPG * rho *
+                         (current_velocity_values[q] * grad_phi_u[i]) *
+                         (current_velocity_values[q] * grad_phi_u[j]) +
+                       tau_SUPG * rho * (phi_u[j] * grad_phi_u[i]) *
+                         (current_velocity_values[q] *
+                          current_velocity_gradients[q]) +
+                       // SUPG Acceleration
+                       tau_SUPG * rho * current_velocity_values[q] *
+                         grad_phi_u[i] * phi_u[j] / delta_t +
+                       tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
+                         (current_velocity_values[q] -
+                          present_velocity_values[q]) /
+                         delta_t +
+                       // SUPG Pressure
+                       tau_SUPG * current_velocity_values[q] *
+                         grad_phi_u[i] * grad_phi_p[j] +
+                       tau_SUPG * phi_u[j] * grad_phi_u[i] *
+                         current_pressure_gradients[q] -
+                       // SUPG body force
+                       tau_SUPG * phi_u[j] * grad_phi_u[i] * rho *
+                         (gravity + artificial_bf[q]) +
+                       // SUPG PML
+                       tau_SUPG * rho * current_velocity_values[q] *
+                         grad_phi_u[i] * sigma_pml[q] * phi_u[j] +
+                       tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
+                         sigma_pml[q] * current_velocity_values[q] +
+                       // PSPG Convection
+                       tau_PSPG * rho * grad_phi_p[i] *
+                         (phi_u[j] * current_velocity_gradients[q]) +
+                       tau_PSPG * rho * grad_phi_p[i] *
+                         (current_velocity_values[q] * grad_phi_u[j]) +
+                       // PSPG Acceleration
+                       tau_PSPG * rho * grad_phi_p[i] * phi_u[j] / delta_t +
+                       // PSPG Pressure
+                       tau_PSPG * grad_phi_p[i] * grad_phi_p[j] +
+                       // PSPG PML
+                       tau_PSPG * rho * grad_phi_p[i] * sigma_pml[q] *
+                         phi_u[j] +
+                       // LSIC acceleration
+                       tau_LSIC * rho * div_phi_u[i] * phi_p[j] /
+                         delta_t * (1 - ind) / atm +
+                       // LSIC bulk acceleration in artificial fluid
+                       tau_LSIC * rho * 1 / kappa_s * div_phi_u[i] *
+                         phi_p[j] / delta_t * ind +
+                       // LSIC velocity divergence
+                       tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                         div_phi_u[j] +
+                       tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                         current_pressure_values[q] * (1 - ind) *
+                         div_phi_u[j] / atm +
+                       tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                         phi_p[j] * (1 - ind) *
+                         current_velocity_divergence / atm +
+                       // LSIC pressure gradients
+                       tau_LSIC * rho * div_phi_u[i] *
+                         current_velocity_values[q] * grad_phi_p[j] /
+                         atm * (1 - ind) +
+                       tau_LSIC * rho * div_phi_u[i] * phi_u[j] *
+                         current_pressure_gradients[q] / atm *
+                         (1 - ind)) *
+                      cell_fe_data.JxW(q);
+                    // For more clear demonstration, write continuity
+                    // equation
+                    // separately.
+                    // The original strong form is:
+                    // \f$p_{,t} + \frac{C_p}{C_v} * (p_0 + p) * (\nabla
+                    // \times u) + u (\nabla p) = 0\f$
+                    local_matrix(i, j) +=
+                      (cp_to_cv *
+                         (atm + current_pressure_values[q] * (1 - ind)) *
+                         div_phi_u[j] * phi_p[i] +
+                       phi_p[j] * current_velocity_divergence * phi_p[i] *
+                         (1 - ind) +
+                       current_velocity_values[q] * grad_phi_p[j] *
+                         phi_p[i] * (1 - ind) +
+                       phi_u[j] * current_pressure_gradients[q] *
+                         phi_p[i] * (1 - ind) +
+                       phi_p[i] * phi_p[j] / delta_t * (1 - ind)) /
+                        atm * cell_fe_data.JxW(q) +
+                      1 / kappa_s * phi_p[i] * phi_p[j] * ind /
+                        delta_t * cell_fe_data.JxW(q);
+                    if (ind == 1)
+                      {
+                        local_matrix(i, j) +=
+                          -(tau_SUPG * phi_u[j] * grad_phi_u[i] *
+                            (fsi_acc_values[q] * rho)) *
+                          cell_fe_data.JxW(q);
+                      }
+                  }
+
+                // RHS is \f$-(A_{current} + C_{current}) -
+                // M_{present-current}/\Delta{t}\f$.
+                local_rhs(i) +=
+                  ((-viscosity *
+                      scalar_product(current_velocity_gradients[q],
+                                     grad_phi_u[i]) -
+                    rho * current_velocity_gradients[q] *
+                      current_velocity_values[q] * phi_u[i] +
+                    current_pressure_values[q] * div_phi_u[i]) -
+                   rho *
+                     (current_velocity_values[q] -
+                      present_velocity_values[q]) *
+                     phi_u[i] / delta_t +
+                   (gravity + artificial_bf[q]) * phi_u[i] * rho) *
+                  cell_fe_data.JxW(q);
+                local_rhs(i) +=
+                  -(rho * sigma_pml[q] * current_velocity_values[q] *
+                      phi_u[i] +
+                    sigma_pml[q] * current_pressure_values[q] * phi_p[i] /
+                      atm) *
+                  cell_fe_data.JxW(q);
+                local_rhs(i) +=
+                  -(cp_to_cv *
+                      (atm + current_pressure_values[q] * (1 - ind)) *
+                      current_velocity_divergence * phi_p[i] +
+                    current_velocity_values[q] *
+                      current_pressure_gradients[q] * phi_p[i] *
+                      (1 - ind) +
+                    (current_pressure_values[q] -
+                     present_pressure_values[q]) *
+                      phi_p[i] / delta_t * (1 - ind)) /
+                    atm * cell_fe_data.JxW(q) -
+                  1 / kappa_s *
+                    (current_pressure_values[q] -
+                     present_pressure_values[q]) *
+                    phi_p[i] * ind / delta_t *
+                    cell_fe_data.JxW(q);
+                // Add SUPG and PSPS rhs terms.
+                local_rhs(i) +=
+                  -((tau_SUPG * current_velocity_values[q] *
+                     grad_phi_u[i]) *
+                      (rho * ((current_velocity_values[q] -
+                               present_velocity_values[q]) /
+                                delta_t +
+                              current_velocity_values[q] *
                                 current_velocity_gradients[q]) +
-                             // SUPG Acceleration
-                             tau_SUPG * rho * current_velocity_values[q] *
-                               grad_phi_u[i] * phi_u[j] / time.get_delta_t() +
-                             tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
-                               (current_velocity_values[q] -
-                                present_velocity_values[q]) /
-                               time.get_delta_t() +
-                             // SUPG Pressure
-                             tau_SUPG * current_velocity_values[q] *
-                               grad_phi_u[i] * grad_phi_p[j] +
-                             tau_SUPG * phi_u[j] * grad_phi_u[i] *
-                               current_pressure_gradients[q] -
-                             // SUPG body force
-                             tau_SUPG * phi_u[j] * grad_phi_u[i] * rho *
-                               (gravity + artificial_bf[q]) +
-                             // SUPG PML
-                             tau_SUPG * rho * current_velocity_values[q] *
-                               grad_phi_u[i] * sigma_pml[q] * phi_u[j] +
-                             tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
-                               sigma_pml[q] * current_velocity_values[q] +
-                             // PSPG Convection
-                             tau_PSPG * rho * grad_phi_p[i] *
-                               (phi_u[j] * current_velocity_gradients[q]) +
-                             tau_PSPG * rho * grad_phi_p[i] *
-                               (current_velocity_values[q] * grad_phi_u[j]) +
-                             // PSPG Acceleration
-                             tau_PSPG * rho * grad_phi_p[i] * phi_u[j] /
-                               time.get_delta_t() +
-                             // PSPG Pressure
-                             tau_PSPG * grad_phi_p[i] * grad_phi_p[j] +
-                             // PSPG PML
-                             tau_PSPG * rho * grad_phi_p[i] * sigma_pml[q] *
-                               phi_u[j] +
-                             // LSIC acceleration
-                             tau_LSIC * rho * div_phi_u[i] * phi_p[j] /
-                               time.get_delta_t() * (1 - ind) / atm +
-                             // LSIC bulk acceleration in artificial fluid
-                             tau_LSIC * rho * 1 / kappa_s * div_phi_u[i] *
-                               phi_p[j] / time.get_delta_t() * ind +
-                             // LSIC velocity divergence
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               div_phi_u[j] +
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               current_pressure_values[q] * (1 - ind) *
-                               div_phi_u[j] / atm +
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               phi_p[j] * (1 - ind) *
-                               current_velocity_divergence / atm +
-                             // LSIC pressure gradients
-                             tau_LSIC * rho * div_phi_u[i] *
-                               current_velocity_values[q] * grad_phi_p[j] /
-                               atm * (1 - ind) +
-                             tau_LSIC * rho * div_phi_u[i] * phi_u[j] *
-                               current_pressure_gradients[q] / atm *
-                               (1 - ind)) *
-                            fe_values.JxW(q);
-                          // For more clear demonstration, write continuity
-                          // equation
-                          // separately.
-                          // The original strong form is:
-                          // \f$p_{,t} + \frac{C_p}{C_v} * (p_0 + p) * (\nabla
-                          // \times u) + u (\nabla p) = 0\f$
-                          local_matrix(i, j) +=
-                            (cp_to_cv *
-                               (atm + current_pressure_values[q] * (1 - ind)) *
-                               div_phi_u[j] * phi_p[i] +
-                             phi_p[j] * current_velocity_divergence * phi_p[i] *
-                               (1 - ind) +
-                             current_velocity_values[q] * grad_phi_p[j] *
-                               phi_p[i] * (1 - ind) +
-                             phi_u[j] * current_pressure_gradients[q] *
-                               phi_p[i] * (1 - ind) +
-                             phi_p[i] * phi_p[j] / time.get_delta_t() *
-                               (1 - ind)) /
-                              atm * fe_values.JxW(q) +
-                            1 / kappa_s * phi_p[i] * phi_p[j] * ind /
-                              time.get_delta_t() * fe_values.JxW(q);
-                          if (ind == 1)
-                            {
-                              local_matrix(i, j) +=
-                                -(tau_SUPG * phi_u[j] * grad_phi_u[i] *
-                                  (fsi_acc_values[q] * rho)) *
-                                fe_values.JxW(q);
-                            }
-                        }
-
-                      // RHS is \f$-(A_{current} + C_{current}) -
-                      // M_{present-current}/\Delta{t}\f$.
-                      local_rhs(i) +=
-                        ((-viscosity *
-                            scalar_product(current_velocity_gradients[q],
-                                           grad_phi_u[i]) -
-                          rho * current_velocity_gradients[q] *
-                            current_velocity_values[q] * phi_u[i] +
-                          current_pressure_values[q] * div_phi_u[i]) -
-                         rho *
-                           (current_velocity_values[q] -
-                            present_velocity_values[q]) *
-                           phi_u[i] / time.get_delta_t() +
-                         (gravity + artificial_bf[q]) * phi_u[i] * rho) *
-                        fe_values.JxW(q);
-                      local_rhs(i) +=
-                        -(rho * sigma_pml[q] * current_velocity_values[q] *
-                            phi_u[i] +
-                          sigma_pml[q] * current_pressure_values[q] * phi_p[i] /
-                            atm) *
-                        fe_values.JxW(q);
-                      local_rhs(i) +=
-                        -(cp_to_cv *
-                            (atm + current_pressure_values[q] * (1 - ind)) *
-                            current_velocity_divergence * phi_p[i] +
-                          current_velocity_values[q] *
-                            current_pressure_gradients[q] * phi_p[i] *
-                            (1 - ind) +
-                          (current_pressure_values[q] -
-                           present_pressure_values[q]) *
-                            phi_p[i] / time.get_delta_t() * (1 - ind)) /
-                          atm * fe_values.JxW(q) -
-                        1 / kappa_s *
-                          (current_pressure_values[q] -
-                           present_pressure_values[q]) *
-                          phi_p[i] * ind / time.get_delta_t() *
-                          fe_values.JxW(q);
-                      // Add SUPG and PSPS rhs terms.
-                      local_rhs(i) +=
-                        -((tau_SUPG * current_velocity_values[q] *
-                           grad_phi_u[i]) *
-                            (rho * ((current_velocity_values[q] -
-                                     present_velocity_values[q]) /
-                                      time.get_delta_t() +
-                                    current_velocity_values[q] *
-                                      current_velocity_gradients[q]) +
-                             current_pressure_gradients[q] -
-                             rho * (gravity + artificial_bf[q]) +
-                             rho * sigma_pml[q] * current_velocity_values[q]) +
-                          (tau_PSPG * grad_phi_p[i]) *
-                            (rho * ((current_velocity_values[q] -
-                                     present_velocity_values[q]) /
-                                      time.get_delta_t() +
-                                    current_velocity_values[q] *
-                                      current_velocity_gradients[q]) +
-                             current_pressure_gradients[q] -
-                             rho * (gravity + artificial_bf[q]) +
-                             rho * sigma_pml[q] * current_velocity_values[q])) *
-                        fe_values.JxW(q);
-                      // Add LSIC rhs terms.
-                      local_rhs(i) +=
-                        -((tau_LSIC * rho * div_phi_u[i]) *
-                            ((current_pressure_values[q] -
-                              present_pressure_values[q]) /
-                               time.get_delta_t() * (1 - ind) +
-                             cp_to_cv * atm * current_velocity_divergence +
-                             cp_to_cv * current_pressure_values[q] *
-                               current_velocity_divergence * (1 - ind) +
-                             current_velocity_values[q] *
-                               current_pressure_gradients[q] * (1 - ind)) /
-                            atm +
-                          (tau_LSIC * rho * div_phi_u[i]) *
-                            (1 / kappa_s *
-                             (current_pressure_values[q] -
-                              present_pressure_values[q]) /
-                             time.get_delta_t()) *
-                            ind) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho) *
-                               (phi_u[i] + tau_PSPG * grad_phi_p[i] +
-                                tau_SUPG * current_velocity_values[q] *
-                                  grad_phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
-                    }
-                }
-
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
-                {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
-                    {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
-                        {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
-                            {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
-                            }
-                        }
-                    }
-                }
-
-              cell->get_dof_indices(local_dof_indices);
-
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
-
-              constraints_used.distribute_local_to_global(local_matrix,
-                                                          local_rhs,
-                                                          local_dof_indices,
-                                                          system_matrix,
-                                                          system_rhs,
-                                                          true);
-            }
-        }
+                       current_pressure_gradients[q] -
+                       rho * (gravity + artificial_bf[q]) +
+                       rho * sigma_pml[q] * current_velocity_values[q]) +
+                    (tau_PSPG * grad_phi_p[i]) *
+                      (rho * ((current_velocity_values[q] -
+                               present_velocity_values[q]) /
+                                delta_t +
+                              current_velocity_values[q] *
+                                current_velocity_gradients[q]) +
+                       current_pressure_gradients[q] -
+                       rho * (gravity + artificial_bf[q]) +
+                       rho * sigma_pml[q] * current_velocity_values[q])) *
+                  cell_fe_data.JxW(q);
+                // Add LSIC rhs terms.
+                local_rhs(i) +=
+                  -((tau_LSIC * rho * div_phi_u[i]) *
+                      ((current_pressure_values[q] -
+                        present_pressure_values[q]) /
+                         delta_t * (1 - ind) +
+                       cp_to_cv * atm * current_velocity_divergence +
+                       cp_to_cv * current_pressure_values[q] *
+                         current_velocity_divergence * (1 - ind) +
+                       current_velocity_values[q] *
+                         current_pressure_gradients[q] * (1 - ind)) /
+                      atm +
+                    (tau_LSIC * rho * div_phi_u[i]) *
+                      (1 / kappa_s *
+                       (current_pressure_values[q] -
+                        present_pressure_values[q]) /
+                       delta_t) *
+                      ind) *
+                  cell_fe_data.JxW(q);
+                if (ind == 1)
+                  {
+                    local_rhs(i) +=
+                      (scalar_product(grad_phi_u[i], p.fsi_stress) +
+                       (fsi_acc_values[q] * rho) *
+                         (phi_u[i] + tau_PSPG * grad_phi_p[i] +
+                          tau_SUPG * current_velocity_values[q] *
+                            grad_phi_u[i])) *
+                      cell_fe_data.JxW(q);
+                  }
+              }
+          }
+
+        // Impose pressure boundary here if specified, loop over faces on the
+        // cell
+        // and apply pressure boundary conditions:
+        // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+        if (parameters.n_fluid_neumann_bcs != 0)
+          {
+            for (unsigned int face_n = 0;
+                 face_n < GeometryInfo<dim>::faces_per_cell;
+                 ++face_n)
+              {
+                if (cell->at_boundary(face_n) &&
+                    parameters.fluid_neumann_bcs.find(
+                      cell->face(face_n)->boundary_id()) !=
+                      parameters.fluid_neumann_bcs.end())
+                  {
+                    fe_face_values.reinit(cell, face_n);
+                    unsigned int p_bc_id = cell->face(face_n)->boundary_id();
+                    double boundary_values_p =
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
+                    for (unsigned int q = 0; q < n_face_q_points; ++q)
+                      {
+                        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                          {
+                            local_rhs(i) +=
+                              -(fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
+                          }
+                      }
+                  }
+              }
+          }
+
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
 
-      system_matrix.compress(VectorOperation::add);
-      system_rhs.compress(VectorOperation::add);
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      auto copier = [&](const CopyData &copy) {
+        constraints_used.distribute_local_to_global(copy.local_matrix,
+                                                    copy.local_rhs,
+                                                    copy.local_dof_indices,
+                                                    system_matrix,
+                                                    system_rhs,
+                                                    true);
+      };
+
+      // The interior cells only read owned values, the ghost values of the
+      // evaluation point are only needed for the other cells.
+      const ScratchData sample_scratch(
+        cell_fe_data, fe, face_quad_formula, n_q_points);
+      const CopyData sample_copy(dofs_per_cell);
+      Utils::run_on_cells<dim>(
+        interior_cells, 3, read, worker, copier, sample_scratch, sample_copy);
+      evaluation_point_update.finish();
+      Utils::run_on_cells<dim>(ghost_touching_cells,
+                               3,
+                               read,
+                               worker,
+                               copier,
+                               sample_scratch,
+                               sample_copy);
+
+      Utils::compress_add({&system_matrix}, {&system_rhs});
     }
 
     template <int dim>
@@ -724,17 +878,31 @@ namespace Fluid
     {
       // This section includes the work done in the preconditioner
       // and GMRES solver.
-      TimerOutput::Scope timer_section(timer, "Solve linear system");
-      preconditioner.reset(
-        new BlockIncompSchurPreconditioner(timer2,
-                                           owned_partitioning,
-                                           system_matrix,
-                                           Abs_A_matrix,
-                                           schur_matrix,
-                                           B2pp_matrix));
+      Utils::TimerScope timer_section(timer, "Solve linear system");
+      const double delta_t = effective_delta_t();
+      if (!preconditioner ||
+          preconditioner_reuse.need_rebuild(delta_t, system_matrix.block(0, 0)))
+        {
+          Timer setup_timer;
+          Utils::StartupScope startup("fluid preconditioner setup");
+          preconditioner.reset(new BlockIncompSchurPreconditioner(
+            timer2,
+            owned_partitioning,
+            system_matrix,
+            Abs_A_matrix,
+            schur_matrix,
+            B2pp_matrix,
+            parameters.scnsim_velocity_block_preconditioner,
+            parameters.scnsim_pressure_block_preconditioner));
+          preconditioner_reuse.rebuilt(delta_t, system_matrix.block(0, 0));
+          solver_log.add_preconditioner_setup(setup_timer.wall_time());
+        }
 
-      SolverControl solver_control(
-        system_matrix.m(), 1e-6 * system_rhs.l2_norm(), true);
+      const double rhs_norm = system_rhs.l2_norm();
+      const double eta = parameters.fluid_forcing_term == "Eisenstat-Walker"
+                           ? forcing_term.next(rhs_norm)
+                           : 1e-6;
+      SolverControl solver_control(system_matrix.m(), eta * rhs_norm, true);
 
       // Because PETScWrappers::SolverGMRES requires preconditioner derived
       // from PETScWrappers::PreconditionBase, we use dealii SolverFGMRES.
@@ -742,8 +910,16 @@ namespace Fluid
       SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
                                                           vector_memory);
 
+      // The Tpp iterations are accumulated over the life of the
+      // preconditioner.
+      const int Tpp_iterations = preconditioner->get_Tpp_itr_count();
       // The solution vector must be non-ghosted
       gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
+      preconditioner_reuse.record(solver_control.last_step());
+      solver_log.add_linear_solve(solver_control.last_step(),
+                                  solver_control.last_value());
+      solver_log.add_inner_iterations(
+        "Tpp", preconditioner->get_Tpp_itr_count() - Tpp_iterations);
 
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
@@ -756,6 +932,7 @@ namespace Fluid
     void SCnsIM<dim>::run_one_step(bool apply_nonzero_constraints,
                                    bool assemble_system)
     {
+      Utils::TraceScope trace("Run one step", "fluid");
       (void)assemble_system;
       std::cout.precision(6);
       std::cout.width(12);
@@ -769,6 +946,7 @@ namespace Fluid
       pcout << std::string(96, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
+      update_time_history();
 
       // Resetting
       double current_residual = 1.0;
@@ -776,6 +954,19 @@ namespace Fluid
       double relative_residual = 1.0;
       unsigned int outer_iteration = 0;
       evaluation_point = present_solution;
+      // Start from the extrapolated solution unless the boundary values are
+      // applied in this step, which assumes the present solution.
+      if (!apply_nonzero_constraints)
+        {
+          PETScWrappers::MPI::BlockVector guess;
+          guess.reinit(owned_partitioning, mpi_communicator);
+          if (solution_predictor.predict(guess, time.get_delta_t()))
+            {
+              evaluation_point = guess;
+            }
+        }
+      forcing_term.reset();
+      unsigned int total_iterations = 0;
       while (relative_residual > parameters.fluid_tolerance &&
              current_residual > 1e-14)
         {
@@ -794,6 +985,8 @@ namespace Fluid
           assemble(apply_nonzero_constraints && outer_iteration == 0);
           auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
           current_residual = system_rhs.l2_norm();
+          total_iterations += state.first;
+          solver_log.add_newton_iteration(current_residual);
 
           // Update evaluation_point. Since newton_update has been set to
           // the correct bc values, there is no need to distribute the
@@ -803,7 +996,7 @@ namespace Fluid
           tmp.reinit(owned_partitioning, mpi_communicator);
           tmp = evaluation_point;
           tmp += newton_update;
-          evaluation_point = tmp;
+          evaluation_point_update.start(evaluation_point, tmp);
 
           if (outer_iteration == 0)
             {
@@ -820,6 +1013,10 @@ namespace Fluid
                 << preconditioner->get_Tpp_itr_count() << std::endl;
           outer_iteration++;
         }
+      evaluation_point_update.finish();
+      pcout << " NEWTON_ITR = " << outer_iteration
+            << " TOTAL_GMRES_ITR = " << total_iterations << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
       // Update solution increment, which is used in FSI application.
       PETScWrappers::MPI::BlockVector tmp1, tmp2;
       tmp1.reinit(owned_partitioning, mpi_communicator);
@@ -829,10 +1026,13 @@ namespace Fluid
       tmp2 -= tmp1;
       solution_increment = tmp2;
       // Newton iteration converges, update time and solution
+      record_previous_solution();
       present_solution = evaluation_point;
-      // Update stress for output
-      update_stress();
+      solution_predictor.record(tmp1, time.get_delta_t());
+      // Choose the next time step size
+      adapt_time_step(outer_iteration);
       // Output
+      write_monitors();
       if (time.time_to_output())
         {
           output_results(time.get_timestep());
@@ -842,10 +1042,16 @@ namespace Fluid
         {
           save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Fluid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          save_buddy_checkpoint(time.get_timestep());
+        }
       if (parameters.simulation_type == "Fluid" && time.time_to_refine())
         {
           refine_mesh(parameters.global_refinements[0],
-                      parameters.global_refinements[0] + 3);
+                      parameters.global_refinements[0] +
+                        parameters.refinement_levels);
         }
     }
 
@@ -907,26 +1113,34 @@ namespace Fluid
     void SCnsIM<dim>::run()
     {
       pcout << "Running with PETSc on "
-            << Utilities::MPI::n_mpi_processes(mpi_communicator)
-            << " MPI rank(s)..." << std::endl;
+            << Utils::parallel_configuration(mpi_communicator) << "..."
+            << std::endl;
 
       // Try load from previous computation.
       bool success_load = load_checkpoint();
       if (!success_load)
         {
-          triangulation.refine_global(parameters.global_refinements[0]);
+          Utils::refine_global_cached(triangulation,
+                                      parameters.global_refinements[0],
+                                      parameters.mesh_cache);
           setup_dofs();
           make_constraints();
           initialize_system();
         }
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
 
       // Time loop.
       // use_nonzero_constraints is set to true only at the first time step,
       // which means nonzero_constraints will be applied at the first iteration
       // in the first time step only, and never be used again.
       // This corresponds to time-independent Dirichlet BCs.
+      Utils::StartupProfile::instance().begin_steps();
       if (!success_load)
         run_one_step(true);
+      Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
       while (time.end() - time.current() > 1e-12)
         {
           if (parameters.use_hard_coded_values)
@@ -939,7 +1153,14 @@ namespace Fluid
             }
           else
             run_one_step(false);
+          Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                      time.current());
+          if (reached_steady_state())
+            {
+              break;
+            }
         }
+      Utils::Tracer::instance().write(mpi_communicator);
     }
     template class SCnsIM<2>;
     template class SCnsIM<3>;
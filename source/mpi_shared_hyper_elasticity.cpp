@@ -1,50 +1,5 @@
 #include "mpi_shared_hyper_elasticity.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
-  {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
-
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
-      {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
-
 namespace Solid
 {
   namespace MPI
@@ -53,14 +8,27 @@ namespace Solid
 
     template <int dim>
     SharedHyperElasticity<dim>::SharedHyperElasticity(
-      Triangulation<dim> &tria, const Parameters::AllParameters &params)
-      : SharedSolidSolver<dim>(tria, params)
+      Triangulation<dim> &tria,
+      const Parameters::AllParameters &params,
+      MPI_Comm communicator)
+      : SharedSolidSolver<dim>(tria, params, communicator),
+        tangent_reuse(params.solid_newton_method == "Modified"
+                        ? params.solid_tangent_max_age
+                        : 1,
+                      0)
     {
     }
 
     template <int dim>
     void SharedHyperElasticity<dim>::run_one_step(bool first_step)
     {
+      Utils::TraceScope trace("Run one step", "solid");
+      if (parameters.solid_time_integrator == "Central difference")
+        {
+          this->run_one_explicit_step(first_step);
+          return;
+        }
+
       double alpha = -parameters.damping;
       double gamma = 0.5 - alpha;
       double beta = pow((1 - alpha), 2) / 4;
@@ -70,6 +38,7 @@ namespace Solid
           // Solve for the initial acceleration
           assemble_system(true);
           this->solve(mass_matrix, previous_acceleration, system_rhs);
+          tangent_reuse.invalidate();
           this->output_results(time.get_timestep());
         }
 
@@ -104,6 +73,15 @@ namespace Solid
 
       pcout << std::string(100, '_') << std::endl;
 
+      // The quadrature point history may be left by a step that the FSI
+      // solver repeats, so it is evaluated with the initial guess.
+      update_qph(current_displacement);
+
+      unsigned int n_tangent_assemblies = 0;
+      unsigned int n_residual_assemblies = 0;
+      unsigned int n_linear_solves = 0;
+      double previous_error_residual = 0;
+
       while ((normalized_error_update > parameters.tol_d ||
               normalized_error_residual > parameters.tol_f) &&
              error_update > 1e-12 && error_update > 1e-12)
@@ -122,14 +100,27 @@ namespace Solid
                                current_acceleration);
 
           // Assemble the system, and modify the RHS to account for
-          // the time-discretization.
-          assemble_system(false);
+          // the time-discretization. The modified Newton method keeps the
+          // tangent of a previous iteration.
+          const bool new_tangent = tangent_reuse.need_rebuild(dt);
+          assemble(false, new_tangent);
+          if (new_tangent)
+            {
+              tangent_reuse.rebuilt(dt);
+              ++n_tangent_assemblies;
+            }
+          else
+            {
+              ++n_residual_assemblies;
+            }
           mass_matrix.vmult(tmp, current_acceleration);
           system_rhs -= tmp;
 
           // Solve linear system
           const std::pair<unsigned int, double> lin_solver_output =
             this->solve(system_matrix, newton_update, system_rhs);
+          tangent_reuse.record(lin_solver_output.first);
+          ++n_linear_solves;
 
           // Error evaluation
           {
@@ -149,17 +140,30 @@ namespace Solid
               }
             normalized_error_update = error_update / initial_error_update;
           }
+          solver_log.add_newton_iteration(error_residual);
 
-          current_displacement += newton_update;
-          // Update the quadrature point history with the newest displacement
-          update_qph(current_displacement);
+          // A reused tangent is rebuilt once the convergence slows down.
+          if (newton_iteration > 0 &&
+              error_residual > 0.5 * previous_error_residual)
+            {
+              tangent_reuse.invalidate();
+            }
+          previous_error_residual = error_residual;
+
+          const double step = line_search(
+            predicted_displacement, newton_update, n_residual_assemblies);
 
           pcout << "Newton iteration = " << newton_iteration
                 << ", CG itr = " << lin_solver_output.first << std::fixed
                 << std::setprecision(3) << std::setw(7) << std::scientific
                 << ", CG res = " << lin_solver_output.second
                 << ", res_F = " << error_residual
-                << ", res_U = " << error_update << std::endl;
+                << ", res_U = " << error_update;
+          if (parameters.solid_line_search_steps > 0)
+            {
+              pcout << ", step = " << step;
+            }
+          pcout << std::endl;
 
           newton_iteration++;
         }
@@ -179,13 +183,15 @@ namespace Solid
       previous_displacement = current_displacement;
 
       pcout << std::string(100, '_') << std::endl
+            << "Tangent assemblies = " << n_tangent_assemblies
+            << ", residual assemblies = " << n_residual_assemblies
+            << ", linear solves = " << n_linear_solves << std::endl
             << "Relative errors:" << std::endl
             << "Displacement:\t" << normalized_error_update << std::endl
             << "Force: \t\t" << normalized_error_residual << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
 
-      // strain and stress
-      update_strain_and_stress();
-
+      this->write_monitors();
       if (time.time_to_output())
         {
           this->output_results(time.get_timestep());
@@ -194,6 +200,11 @@ namespace Solid
         {
           this->save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Solid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          this->save_buddy_checkpoint(time.get_timestep());
+        }
     }
 
     template <int dim>
@@ -201,30 +212,57 @@ namespace Solid
     {
       SharedSolidSolver<dim>::initialize_system();
       setup_qph();
+      tangent_reuse.invalidate();
     }
 
     template <int dim>
-    void SharedHyperElasticity<dim>::setup_qph()
+    double SharedHyperElasticity<dim>::line_search(
+      const PETScWrappers::MPI::Vector &predicted_displacement,
+      const PETScWrappers::MPI::Vector &newton_update,
+      unsigned int &n_residual_assemblies)
     {
-      const unsigned int n_q_points = volume_quad_formula.size();
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
+      const double alpha = -parameters.damping;
+      const double beta = pow((1 - alpha), 2) / 4;
+      const double dt = time.get_delta_t();
+      const PETScWrappers::MPI::Vector start_displacement(current_displacement);
+      PETScWrappers::MPI::Vector tmp(current_displacement);
+
+      double step = 1.0;
+      for (unsigned int i = 0;; ++i)
         {
-          if (cell->subdomain_id() != this_mpi_process)
-            continue;
-          unsigned int mat_id = cell->material_id();
-          if (parameters.n_solid_parts == 1)
-            mat_id = 1;
-          quad_point_history.initialize(cell, n_q_points);
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
-          for (unsigned int q = 0; q < n_q_points; ++q)
+          current_displacement = start_displacement;
+          current_displacement.add(step, newton_update);
+          // Update the quadrature point history with the newest displacement
+          update_qph(current_displacement);
+          if (i == parameters.solid_line_search_steps)
+            {
+              break;
+            }
+
+          // Accept the step if it sufficiently decreases the residual.
+          current_acceleration = current_displacement;
+          current_acceleration -= predicted_displacement;
+          current_acceleration /= (beta * dt * dt);
+          assemble_rhs();
+          ++n_residual_assemblies;
+          mass_matrix.vmult(tmp, current_acceleration);
+          system_rhs -= tmp;
+          if (get_error(system_rhs) <= (1 - 1e-4 * step) * error_residual)
             {
-              lqph[q]->setup(parameters, mat_id);
+              break;
             }
+          step *= 0.5;
         }
+      return step;
+    }
+
+    template <int dim>
+    void SharedHyperElasticity<dim>::setup_qph()
+    {
+      quad_point_history.initialize(triangulation,
+                                    parameters,
+                                    volume_quad_formula.size(),
+                                    this_mpi_process);
     }
 
     template <int dim>
@@ -234,30 +272,26 @@ namespace Solid
       timer.enter_subsection("Update QPH data");
 
       // displacement gradient at quad points
-      const unsigned int n_q_points = volume_quad_formula.size();
       FEValuesExtractors::Vector displacement(0);
       std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
       FEValues<dim> fe_values(
         fe, volume_quad_formula, update_values | update_gradients);
 
-      Vector<double> tmp(evaluation_point);
+      PETScWrappers::MPI::Vector tmp(
+        locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+      tmp = evaluation_point;
 
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
           if (cell->subdomain_id() != this_mpi_process)
             continue;
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
 
           fe_values.reinit(cell);
           fe_values[displacement].get_function_gradients(tmp, grad_u);
 
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->update(parameters, grad_u[q]);
-            }
+          quad_point_history.update(first, grad_u);
         }
       timer.leave_subsection();
     }
@@ -275,12 +309,10 @@ namespace Solid
           if (cell->subdomain_id() != this_mpi_process)
             continue;
           fe_values.reinit(cell);
-          const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-            lqph = quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const double det = lqph[q]->get_det_F();
+              const double det = quad_point_history.get_det_F(first + q);
               const double JxW = fe_values.JxW(q);
               volume += det * JxW;
             }
@@ -295,7 +327,7 @@ namespace Solid
     double SharedHyperElasticity<dim>::get_error(
       const PETScWrappers::MPI::Vector &v) const
     {
-      Vector<double> tmp(v);
+      PETScWrappers::MPI::Vector tmp(v);
       constraints.distribute(tmp);
       return tmp.l2_norm();
     }
@@ -303,7 +335,29 @@ namespace Solid
     template <int dim>
     void SharedHyperElasticity<dim>::assemble_system(bool initial_step)
     {
-      timer.enter_subsection("Assemble tangent matrix");
+      assemble(initial_step, true);
+    }
+
+    template <int dim>
+    void SharedHyperElasticity<dim>::assemble_rhs()
+    {
+      assemble(false, false);
+    }
+
+    template <int dim>
+    void SharedHyperElasticity<dim>::assemble_explicit_rhs()
+    {
+      update_qph(current_displacement);
+      assemble_rhs();
+    }
+
+    template <int dim>
+    void SharedHyperElasticity<dim>::assemble(bool initial_step,
+                                              bool assemble_matrix)
+    {
+      OPENIFEM_KERNEL_SCOPE("hyper_elasticity_assemble");
+      Assert(assemble_matrix || !initial_step, ExcInternalError());
+      timer.enter_subsection(\"Assemble tangent matrix\");
 
       const unsigned int n_q_points = volume_quad_formula.size();
       const unsigned int n_f_q_points = face_quad_formula.size();
@@ -316,7 +370,10 @@ namespace Solid
         {
           mass_matrix = 0.0;
         }
-      system_matrix = 0.0;
+      if (assemble_matrix)
+        {
+          system_matrix = 0.0;
+        }
       system_rhs = 0.0;
 
       FEValues<dim> fe_values(fe,
@@ -340,7 +397,9 @@ namespace Solid
       Vector<double> local_rhs(dofs_per_cell);
       std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
-      Vector<double> localized_displacement(current_displacement);
+      PETScWrappers::MPI::Vector localized_displacement(
+        locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+      localized_displacement = current_displacement;
 
       std::vector<std::vector<Tensor<1, dim>>> fsi_stress_rows_values(dim);
       for (unsigned int d = 0; d < dim; ++d)
@@ -366,13 +425,12 @@ namespace Solid
           local_matrix = 0;
           local_rhs = 0;
 
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first = quad_point_history.first_point(cell);
 
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
+              const Tensor<2, dim> F_inv =
+                quad_point_history.get_F_inv(first + q);
               for (unsigned int k = 0; k < dofs_per_cell; ++k)
                 {
                   phi[q][k] = fe_values[displacement].value(k, q);
@@ -381,9 +439,11 @@ namespace Solid
                   sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
                 }
 
-              const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-              const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-              const double rho = lqph[q]->get_density();
+              const SymmetricTensor<2, dim> tau =
+                quad_point_history.get_tau(first + q);
+              const SymmetricTensor<4, dim> Jc =
+                quad_point_history.get_Jc(first + q);
+              const double rho = quad_point_history.get_density(first + q);
               const double dt = time.get_delta_t();
               const double JxW = fe_values.JxW(q);
 
@@ -391,7 +451,8 @@ namespace Solid
                 {
                   const unsigned int component_i =
                     fe.system_to_component_index(i).first;
-                  for (unsigned int j = 0; j <= i; ++j)
+                  // Only the rhs is needed if the matrices are not assembled.
+                  for (unsigned int j = 0; assemble_matrix && j <= i; ++j)
                     {
                       if (initial_step)
                         {
@@ -463,6 +524,7 @@ namespace Solid
                   // In stand-alone simulation, the boundary value is prescribed
                   // by the user.
                   prescribed_value = parameters.solid_neumann_bcs[id];
+                  neumann_table.value(id, time.current(), prescribed_value);
                 }
 
               if (parameters.simulation_type != "FSI" &&
@@ -555,7 +617,7 @@ namespace Solid
                                                      mass_matrix,
                                                      system_rhs);
             }
-          else
+          else if (assemble_matrix)
             {
               constraints.distribute_local_to_global(local_matrix,
                                                      local_rhs,
@@ -563,13 +625,18 @@ namespace Solid
                                                      system_matrix,
                                                      system_rhs);
             }
+          else
+            {
+              constraints.distribute_local_to_global(
+                local_rhs, local_dof_indices, system_rhs);
+            }
         }
 
       if (initial_step)
         {
           mass_matrix.compress(VectorOperation::add);
         }
-      else
+      else if (assemble_matrix)
         {
           system_matrix.compress(VectorOperation::add);
         }
@@ -578,121 +645,31 @@ namespace Solid
     }
 
     template <int dim>
-    void SharedHyperElasticity<dim>::update_strain_and_stress()
+    void SharedHyperElasticity<dim>::add_memory_usage(
+      Utils::MemoryReport &report) const
     {
-      for (unsigned int i = 0; i < dim; ++i)
-        {
-          for (unsigned int j = 0; j < dim; ++j)
-            {
-              strain[i][j] = 0.0;
-              stress[i][j] = 0.0;
-            }
-        }
-      PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
-                                                   mpi_communicator);
-      surrounding_cells = 0.0;
-      // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-      // at cell and quadrature point level.
-      std::vector<std::vector<Vector<double>>> cell_strain(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> cell_stress(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> quad_strain(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-      std::vector<std::vector<Vector<double>>> quad_stress(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-
-      // Displacement gradients at quadrature points.
-      std::vector<Tensor<2, dim>> current_displacement_gradients(
-        volume_quad_formula.size());
-
-      // The projection matrix from quadrature points to the dofs.
-      FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                    volume_quad_formula.size());
-      FETools::compute_projection_from_quadrature_points_matrix(
-        scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
-      const FEValuesExtractors::Vector displacement(0);
-
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_gradients |
-                                update_quadrature_points | update_JxW_values);
-      auto cell = dof_handler.begin_active();
-      auto scalar_cell = scalar_dof_handler.begin_active();
-      Vector<double> local_sorrounding_cells(scalar_fe.dofs_per_cell);
-      local_sorrounding_cells = 1.0;
-
-      Vector<double> localized_current_displacement(current_displacement);
-
-      for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
-        {
-          if (cell->subdomain_id() == this_mpi_process)
-            {
-              fe_values.reinit(cell);
-              const std::vector<std::shared_ptr<Internal::PointHistory<dim>>>
-                lqph = quad_point_history.get_data(cell);
-
-              for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
-                {
-                  const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-                  const Tensor<2, dim> F = invert(lqph[q]->get_F_inv());
-                  const double J = lqph[q]->get_det_F();
-                  for (unsigned int i = 0; i < dim; ++i)
-                    {
-                      for (unsigned int j = 0; j < dim; ++j)
-                        {
-                          quad_strain[i][j][q] = F[i][j];
-                          quad_stress[i][j][q] = tau[i][j] / J;
-                        }
-                    }
-                }
-
-              for (unsigned int i = 0; i < dim; ++i)
-                {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                      qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_strain[i][j],
-                                                              strain[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_stress[i][j],
-                                                              stress[i][j]);
-                    }
-                }
-              scalar_cell->distribute_local_to_global(local_sorrounding_cells,
-                                                      surrounding_cells);
-            }
-        }
-      surrounding_cells.compress(VectorOperation::add);
+      SharedSolidSolver<dim>::add_memory_usage(report);
+      report.add("solid point history",
+                 quad_point_history.memory_consumption());
+    }
 
-      for (unsigned int i = 0; i < dim; ++i)
-        {
-          for (unsigned int j = 0; j < dim; ++j)
+    template <int dim>
+    void SharedHyperElasticity<dim>::update_strain_and_stress()
+    {
+      OPENIFEM_KERNEL_SCOPE("hyper_elasticity_stress");
+      recover_strain_and_stress(
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            FEValues<dim> &,
+            std::vector<Tensor<2, dim>> &quad_strain,
+            std::vector<Tensor<2, dim>> &quad_stress) {
+          const unsigned int first = quad_point_history.first_point(cell);
+          for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
             {
-              strain[i][j].compress(VectorOperation::add);
-              stress[i][j].compress(VectorOperation::add);
-              const unsigned int local_begin =
-                surrounding_cells.local_range().first;
-              const unsigned int local_end =
-                surrounding_cells.local_range().second;
-              for (unsigned int k = local_begin; k < local_end; ++k)
-                {
-                  strain[i][j][k] /= surrounding_cells[k];
-                  stress[i][j][k] /= surrounding_cells[k];
-                }
-              strain[i][j].compress(VectorOperation::insert);
-              stress[i][j].compress(VectorOperation::insert);
+              quad_strain[q] = invert(quad_point_history.get_F_inv(first + q));
+              quad_stress[q] = quad_point_history.get_tau(first + q) /
+                               quad_point_history.get_det_F(first + q);
             }
-        }
+        });
     }
 
     template class SharedHyperElasticity<2>;
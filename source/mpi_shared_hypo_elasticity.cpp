@@ -42,24 +42,23 @@ namespace Solid
       Triangulation<dim> &tria,
       const Parameters::AllParameters &params,
       double dx,
-      double hdx)
-      : SharedSolidSolver<dim>(tria, params), dx(dx), hdx(hdx)
+      double hdx,
+      MPI_Comm communicator)
+      : SharedSolidSolver<dim>(tria, params, communicator), dx(dx), hdx(hdx)
     {
     }
 
     template <int dim>
     void SharedHypoElasticity<dim>::run_one_step(bool first_step)
     {
-      // Not parallelized yet, only rank 0 does work!
+      // Every process steps the particles of its own cells with a halo, and
+      // the halo is updated from the owners after the step.
       if (first_step)
         {
-          if (this_mpi_process == 0)
+          construct_particles();
+          if (writes_output)
             {
-              construct_particles();
-              utilities<dim>::vtk_write_particle(m_body->get_particles(),
-                                                 m_body->get_num_part(),
-                                                 time.get_timestep(),
-                                                 "particles");
+              output_particles();
             }
           this->output_results(time.get_timestep());
         }
@@ -67,47 +66,121 @@ namespace Solid
       pcout << std::endl
             << "Timestep " << time.get_timestep() << " @ " << time.current()
             << "s" << std::endl;
-      if (this_mpi_process == 0)
-        {
-          m_body->step();
-          synchronize();
-        }
-      // distribute
-      Vector<double> displacement(dof_handler.n_dofs());
-      Vector<double> velocity(dof_handler.n_dofs());
-      Vector<double> acceleration(dof_handler.n_dofs());
-      Utilities::MPI::sum(
-        serialized_displacement, mpi_communicator, displacement);
-      Utilities::MPI::sum(serialized_velocity, mpi_communicator, velocity);
-      Utilities::MPI::sum(
-        serialized_acceleration, mpi_communicator, acceleration);
-      current_displacement = displacement;
-      current_velocity = velocity;
-      current_acceleration = acceleration;
+      m_body->step();
+      update_halo();
+      synchronize();
+      distribute();
+      this->write_monitors();
       if (time.time_to_output())
         {
           this->output_results(time.get_timestep());
-          if (this_mpi_process == 0)
+          if (writes_output)
             {
-              utilities<dim>::vtk_write_particle(m_body->get_particles(),
-                                                 m_body->get_num_part(),
-                                                 time.get_timestep(),
-                                                 "particles");
+              output_particles();
             }
         }
       if (parameters.simulation_type == "Solid" && time.time_to_save())
         {
           this->save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Solid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          this->save_buddy_checkpoint(time.get_timestep());
+        }
+    }
+
+    template <int dim>
+    void SharedHypoElasticity<dim>::output_particles() const
+    {
+      utilities<dim>::vtk_write_particle(
+        m_body->get_particles(),
+        m_body->get_num_part(),
+        time.get_timestep(),
+        n_mpi_processes > 1
+          ? "particles-" + Utilities::int_to_string(this_mpi_process, 4)
+          : "particles");
+    }
+
+    template <int dim>
+    void SharedHypoElasticity<dim>::update_halo()
+    {
+      // The state of the particles is the one the checkpoints keep.
+      std::map<unsigned int, std::vector<double>> values;
+      for (const auto &part : halo_sent)
+        {
+          auto &message = values[part.first];
+          for (const unsigned int id : part.second.particles)
+            {
+              const auto *p = m_body->get_particles()[id];
+              for (unsigned int n = 0; n < dim; ++n)
+                {
+                  message.push_back(p->x[n]);
+                  message.push_back(p->v[n]);
+                  message.push_back(p->a[n]);
+                }
+            }
+          for (const unsigned int id : part.second.quad_points)
+            {
+              const auto *q = m_body->get_quad_points()[id];
+              for (unsigned int r = 0; r < dim; ++r)
+                for (unsigned int c = 0; c < dim; ++c)
+                  message.push_back(q->S(r, c));
+              message.push_back(q->p);
+            }
+        }
+      for (const auto &message :
+           Utils::exchange_doubles(mpi_communicator, values))
+        {
+          const HaloPart &part = halo_received.at(message.first);
+          AssertThrow(message.second.size() ==
+                        part.particles.size() * 3 * dim +
+                          part.quad_points.size() * (dim * dim + 1),
+                      ExcMessage("The particle halo does not match!"));
+          auto value = message.second.cbegin();
+          for (const unsigned int id : part.particles)
+            {
+              auto *p = m_body->get_particles()[id];
+              auto *cur = m_body->get_cur_particles()[id];
+              for (unsigned int n = 0; n < dim; ++n)
+                {
+                  p->x[n] = cur->x[n] = *value++;
+                  p->v[n] = cur->v[n] = *value++;
+                  p->a[n] = cur->a[n] = *value++;
+                }
+            }
+          for (const unsigned int id : part.quad_points)
+            {
+              auto *q = m_body->get_quad_points()[id];
+              for (unsigned int r = 0; r < dim; ++r)
+                for (unsigned int c = 0; c < dim; ++c)
+                  q->S(r, c) = *value++;
+              q->p = *value++;
+            }
+        }
     }
 
     template <int dim>
-    void SharedHypoElasticity<dim>::initialize_system()
+    void SharedHypoElasticity<dim>::distribute()
     {
-      SharedSolidSolver<dim>::initialize_system();
-      serialized_displacement = Vector<double>(dof_handler.n_dofs());
-      serialized_velocity = Vector<double>(dof_handler.n_dofs());
-      serialized_acceleration = Vector<double>(dof_handler.n_dofs());
+      std::vector<double> displacement(owned_dofs.size());
+      std::vector<double> velocity(owned_dofs.size());
+      std::vector<double> acceleration(owned_dofs.size());
+      for (unsigned int i = 0; i < owned_dofs.size(); ++i)
+        {
+          const auto *p = m_body->get_particles()[owned_dof_particles[i].first];
+          const unsigned int n = owned_dof_particles[i].second;
+          displacement[i] = p->x[n] - p->X[n];
+          velocity[i] = p->v[n];
+          acceleration[i] = p->a[n];
+        }
+      // Every process only writes the entries it owns.
+      current_displacement.set(owned_dofs, displacement);
+      current_displacement.compress(VectorOperation::insert);
+      current_velocity.set(owned_dofs, velocity);
+      current_velocity.compress(VectorOperation::insert);
+      current_acceleration.set(owned_dofs, acceleration);
+      current_acceleration.compress(VectorOperation::insert);
     }
 
     template <int dim>
@@ -126,8 +199,6 @@ namespace Solid
     template <int dim>
     void SharedHypoElasticity<dim>::synchronize()
     {
-      std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
-      const unsigned int dofs_per_cell = fe.dofs_per_cell;
       unsigned int n_face_q_points = face_quad_formula.size();
       unsigned int face_quad_point_id = 0;
 
@@ -141,40 +212,21 @@ namespace Solid
         update_values | update_quadrature_points | update_normal_vectors |
           update_JxW_values);
 
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
       std::vector<std::vector<Tensor<1, dim>>> fsi_stress_rows_values(dim);
       for (unsigned int d = 0; d < dim; ++d)
         {
           fsi_stress_rows_values[d].resize(n_face_q_points);
         }
 
+      // The face quadrature points of the body are those of the boundary
+      // faces of its cells, in order.
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
-          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
-               ++v)
+          if (!local_cells[cell->active_cell_index()])
             {
-              if (!vertex_touched[cell->vertex_index(v)])
-                {
-                  vertex_touched[cell->vertex_index(v)] = true;
-                  int id = vertex_mapping[cell->vertex_index(v)];
-                  auto disp = m_body->get_particles()[id]->x -
-                              m_body->get_particles()[id]->X;
-                  auto vel = m_body->get_particles()[id]->v;
-                  auto acc = m_body->get_particles()[id]->a;
-                  for (unsigned int n = 0; n < dim; ++n)
-                    {
-                      serialized_displacement(cell->vertex_dof_index(v, n)) =
-                        disp[n];
-                      serialized_velocity(cell->vertex_dof_index(v, n)) =
-                        vel[n];
-                      serialized_acceleration(cell->vertex_dof_index(v, n)) =
-                        acc[n];
-                    }
-                }
+              continue;
             }
-          cell->get_dof_indices(local_dof_indices);
           for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
             {
               if (cell->face(f)->at_boundary())
@@ -185,10 +237,12 @@ namespace Solid
                        v < GeometryInfo<dim>::vertices_per_face;
                        ++v)
                     {
+                      const unsigned int id =
+                        vertex_mapping[cell->face(f)->vertex_index(v)];
+                      const auto *p = m_body->get_particles()[id];
                       for (unsigned int d = 0; d < dim; ++d)
                         {
-                          vertex_displacement[v][d] = serialized_displacement(
-                            cell->face(f)->vertex_dof_index(v, d));
+                          vertex_displacement[v][d] = p->x[d] - p->X[d];
                         }
                       cell->face(f)->vertex(v) += vertex_displacement[v];
                     }
@@ -234,17 +288,67 @@ namespace Solid
     template <int dim>
     void SharedHypoElasticity<dim>::construct_particles()
     {
+      // The particles of the own cells are stepped as in the whole body if
+      // the halo holds everything they depend on. In each of the four
+      // Runge-Kutta stages the nodes read the quadrature points within the
+      // support and these read the nodes within the support, and the
+      // corrected kernels at the edge of the halo miss some neighbors, so the
+      // halo spans 9 supports around the bounding box of the own cells.
+      const double halo_depth = (2 * 4 + 1) * hdx * dx;
+      Point<dim> lower, upper;
+      bool has_cells = false;
+      for (const auto &cell : triangulation.active_cell_iterators())
+        {
+          if (cell->subdomain_id() != this_mpi_process)
+            {
+              continue;
+            }
+          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  const double x = cell->vertex(v)[d];
+                  lower[d] = has_cells ? std::min(lower[d], x) : x;
+                  upper[d] = has_cells ? std::max(upper[d], x) : x;
+                }
+              has_cells = true;
+            }
+        }
+      local_cells.assign(triangulation.n_active_cells(), false);
+      unsigned int n_local_cells = 0;
+      for (const auto &cell : triangulation.active_cell_iterators())
+        {
+          for (unsigned int v = 0;
+               has_cells && v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              bool inside = true;
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  inside = inside &&
+                           cell->vertex(v)[d] >= lower[d] - halo_depth &&
+                           cell->vertex(v)[d] <= upper[d] + halo_depth;
+                }
+              if (inside)
+                {
+                  local_cells[cell->active_cell_index()] = true;
+                  ++n_local_cells;
+                  break;
+                }
+            }
+        }
+
       FEValues<dim> fe_values(
         fe, volume_quad_formula, update_quadrature_points | update_JxW_values);
       unsigned int n_q_points = volume_quad_formula.size();
-      // Particles
-      unsigned int n_particles = triangulation.n_vertices();
-      particle<dim> **particles = new particle<dim> *[n_particles];
+      // Particles, at most one per vertex
+      particle<dim> **particles =
+        new particle<dim> *[triangulation.n_vertices()];
       unsigned int particle_id = 0;
       vertex_mapping = std::vector<int>(triangulation.n_vertices(), -1);
       // Volume quadrature points, assuming 2nd order integration
-      unsigned int n_vol_quad =
-        volume_quad_formula.size() * triangulation.n_active_cells();
+      unsigned int n_vol_quad = volume_quad_formula.size() * n_local_cells;
       particle<dim> **vol_quad_points = new particle<dim> *[n_vol_quad];
       unsigned int vol_quad_point_id = 0;
       // Face quadrature points, assuming 2nd order integration
@@ -255,6 +359,10 @@ namespace Solid
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
+          if (!local_cells[cell->active_cell_index()])
+            {
+              continue;
+            }
           // Vertex
           for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
                ++v)
@@ -303,8 +411,7 @@ namespace Solid
                 }
             }
         }
-      AssertThrow(triangulation.n_vertices() == particle_id,
-                  ExcMessage("Vertices do not match!"));
+      const unsigned int n_particles = particle_id;
       AssertThrow(n_vol_quad == vol_quad_point_id,
                   ExcMessage("Volume quadrature points do not match!"));
       particle<dim> **face_quad_points = new particle<dim> *[n_face_quad];
@@ -314,6 +421,10 @@ namespace Solid
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
+          if (!local_cells[cell->active_cell_index()])
+            {
+              continue;
+            }
           // Then set face quad points
           for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
             {
@@ -409,6 +520,114 @@ namespace Solid
                                            face_quad_points,
                                            n_face_quad,
                                            parameters.damping);
+
+      // The owned dofs are those of the vertices of the own cells, whose
+      // particles need no update. The other particles and the quadrature
+      // points of the cells of other processes are received from the owner
+      // of their first dof and of their cell, identified by the vertex and
+      // by the cell and quadrature point.
+      const std::vector<IndexSet> owned_dofs_per_process =
+        DoFTools::locally_owned_dofs_per_subdomain(dof_handler);
+      std::vector<bool> own_vertices(triangulation.n_vertices(), false);
+      for (const auto &cell : triangulation.active_cell_iterators())
+        {
+          if (cell->subdomain_id() == this_mpi_process)
+            {
+              for (unsigned int v = 0;
+                   v < GeometryInfo<dim>::vertices_per_cell;
+                   ++v)
+                {
+                  own_vertices[cell->vertex_index(v)] = true;
+                }
+            }
+        }
+      owned_dofs.clear();
+      owned_dof_particles.clear();
+      halo_sent.clear();
+      halo_received.clear();
+      std::map<unsigned int, std::vector<double>> requested_vertices;
+      std::map<unsigned int, std::vector<double>> requested_quad_points;
+      std::vector<int> quad_point_mapping(
+        n_q_points * triangulation.n_active_cells(), -1);
+      std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
+      vol_quad_point_id = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!local_cells[cell->active_cell_index()])
+            {
+              continue;
+            }
+          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              const unsigned int vertex = cell->vertex_index(v);
+              if (vertex_touched[vertex])
+                {
+                  continue;
+                }
+              vertex_touched[vertex] = true;
+              const unsigned int id = vertex_mapping[vertex];
+              if (own_vertices[vertex])
+                {
+                  for (unsigned int n = 0; n < dim; ++n)
+                    {
+                      const auto dof = cell->vertex_dof_index(v, n);
+                      if (locally_owned_dofs.is_element(dof))
+                        {
+                          owned_dofs.push_back(dof);
+                          owned_dof_particles.emplace_back(id, n);
+                        }
+                    }
+                  continue;
+                }
+              unsigned int owner = 0;
+              while (!owned_dofs_per_process[owner].is_element(
+                cell->vertex_dof_index(v, 0)))
+                {
+                  ++owner;
+                }
+              halo_received[owner].particles.push_back(id);
+              requested_vertices[owner].push_back(vertex);
+            }
+          for (unsigned int q = 0; q < n_q_points; ++q, ++vol_quad_point_id)
+            {
+              const unsigned int global_id =
+                cell->active_cell_index() * n_q_points + q;
+              quad_point_mapping[global_id] = vol_quad_point_id;
+              if (cell->subdomain_id() != this_mpi_process)
+                {
+                  halo_received[cell->subdomain_id()].quad_points.push_back(
+                    vol_quad_point_id);
+                  requested_quad_points[cell->subdomain_id()].push_back(
+                    global_id);
+                }
+            }
+        }
+      // The owners learn what they send to whom.
+      for (const auto &request :
+           Utils::exchange_doubles(mpi_communicator, requested_vertices))
+        {
+          for (const double vertex : request.second)
+            {
+              const int id = vertex_mapping[static_cast<unsigned int>(vertex)];
+              AssertThrow(id >= 0,
+                          ExcMessage("The particle halo does not match!"));
+              halo_sent[request.first].particles.push_back(id);
+            }
+        }
+      for (const auto &request :
+           Utils::exchange_doubles(mpi_communicator, requested_quad_points))
+        {
+          for (const double global_id : request.second)
+            {
+              const int id =
+                quad_point_mapping[static_cast<unsigned int>(global_id)];
+              AssertThrow(id >= 0,
+                          ExcMessage("The particle halo does not match!"));
+              halo_sent[request.first].quad_points.push_back(id);
+            }
+        }
     }
 
     template <int dim>
@@ -419,13 +638,27 @@ namespace Solid
           return false;
         }
       construct_particles();
-      std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
       Vector<double> localized_displacement(current_displacement);
       Vector<double> localized_velocity(current_velocity);
       Vector<double> localized_acceleration(current_acceleration);
+      // The stress is saved after the solution, by cell and quadrature
+      // point.
+      AssertThrow(restored_state.size() == 4,
+                  ExcMessage("Could not find restart files for stress!"));
+      const Vector<double> &stress = restored_state[3];
+      const unsigned int n_q_points = volume_quad_formula.size();
+      AssertDimension(stress.size(),
+                      triangulation.n_active_cells() * n_q_points *
+                        (dim * dim + 1));
+      std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
+      unsigned int quad_point_id = 0;
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
+          if (!local_cells[cell->active_cell_index()])
+            {
+              continue;
+            }
           for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
                ++v)
             {
@@ -450,74 +683,53 @@ namespace Solid
                     }
                 }
             }
-        }
-      fs::path local_path = fs::current_path();
-      fs::path checkpoint_file(local_path);
-      for (const auto &p : fs::directory_iterator(local_path))
-        {
-          if (p.path().extension() == ".solid_checkpoint_stress" &&
-              (std::string(p.path().stem()) >
-                 std::string(checkpoint_file.stem()) ||
-               checkpoint_file == local_path))
+          for (unsigned int q = 0; q < n_q_points; ++q, ++quad_point_id)
             {
-              checkpoint_file = p.path();
+              unsigned int iter = (cell->active_cell_index() * n_q_points + q) *
+                                  (dim * dim + 1);
+              auto *quad_point = m_body->get_quad_points()[quad_point_id];
+              for (unsigned int r = 0; r < dim; ++r)
+                for (unsigned int c = 0; c < dim; ++c)
+                  quad_point->S(r, c) = stress[iter++];
+              quad_point->p = stress[iter++];
             }
         }
-      AssertThrow(checkpoint_file != local_path,
-                  ExcMessage("Could not find restart files for stress!"));
-      // set time step load the checkpoint file
-      Vector<double> stress(m_body->get_num_quad_points() * (dim * dim + 1));
-      std::ifstream fs_stress(checkpoint_file);
-      stress.block_read(fs_stress);
-      unsigned int iter = 0;
-      for (unsigned int i = 0; i < m_body->get_num_quad_points(); ++i)
-        {
-          for (unsigned int r = 0; r < dim; ++r)
-            for (unsigned int c = 0; c < dim; ++c)
-              m_body->get_quad_points()[i]->S(r, c) = stress[iter++];
-          m_body->get_quad_points()[i]->p = stress[iter++];
-        }
       return true;
     }
 
     template <int dim>
-    void SharedHypoElasticity<dim>::save_checkpoint(const int output_index)
+    void SharedHypoElasticity<dim>::stage_checkpoint(
+      std::vector<Vector<double>> &state) const
     {
-      SharedSolidSolver<dim>::save_checkpoint(output_index);
-      // Stress at quad points
-      if (this_mpi_process == 0)
+      // Stress at quad points, by cell and quadrature point. Every process
+      // adds those of its own cells.
+      const unsigned int n_q_points = volume_quad_formula.size();
+      Vector<double> stress(triangulation.n_active_cells() * n_q_points *
+                            (dim * dim + 1));
+      unsigned int quad_point_id = 0;
+      for (const auto &cell : triangulation.active_cell_iterators())
         {
-          Vector<double> stress(m_body->get_num_quad_points() *
-                                (dim * dim + 1));
-          unsigned int iter = 0;
-          for (unsigned int i = 0; i < m_body->get_num_quad_points(); ++i)
+          if (!local_cells[cell->active_cell_index()])
             {
-              for (unsigned int r = 0; r < dim; ++r)
-                for (unsigned int c = 0; c < dim; ++c)
-                  stress[iter++] = m_body->get_quad_points()[i]->S(r, c);
-              stress[iter++] = m_body->get_quad_points()[i]->p;
+              continue;
             }
-          fs::path local_path = fs::current_path();
-          std::set<fs::path> checkpoints;
-          for (const auto &p : fs::directory_iterator(local_path))
+          for (unsigned int q = 0; q < n_q_points; ++q, ++quad_point_id)
             {
-              if (p.path().extension() == ".solid_checkpoint_S")
+              if (cell->subdomain_id() != this_mpi_process)
                 {
-                  checkpoints.insert(p.path());
+                  continue;
                 }
+              unsigned int iter = (cell->active_cell_index() * n_q_points + q) *
+                                  (dim * dim + 1);
+              const auto *quad_point = m_body->get_quad_points()[quad_point_id];
+              for (unsigned int r = 0; r < dim; ++r)
+                for (unsigned int c = 0; c < dim; ++c)
+                  stress[iter++] = quad_point->S(r, c);
+              stress[iter++] = quad_point->p;
             }
-          while (checkpoints.size() > 1)
-            {
-              fs::path to_be_removed(*checkpoints.begin());
-              fs::remove(to_be_removed);
-              checkpoints.erase(checkpoints.begin());
-            }
-          fs::path checkpoint_file(local_path);
-          checkpoint_file.append(Utilities::int_to_string(output_index, 6));
-          checkpoint_file.replace_extension(".solid_checkpoint_stress");
-          std::ofstream fs_stress(checkpoint_file);
-          stress.block_write(fs_stress);
         }
+      Utilities::MPI::sum(stress, mpi_communicator, stress);
+      state.push_back(std::move(stress));
     }
 
     template class SharedHypoElasticity<2>;
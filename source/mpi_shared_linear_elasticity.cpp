@@ -8,8 +8,11 @@ namespace Solid
 
     template <int dim>
     SharedLinearElasticity<dim>::SharedLinearElasticity(
-      Triangulation<dim> &tria, const Parameters::AllParameters &parameters)
-      : SharedSolidSolver<dim>(tria, parameters)
+      Triangulation<dim> &tria,
+      const Parameters::AllParameters &parameters,
+      MPI_Comm communicator)
+      : SharedSolidSolver<dim>(tria, parameters, communicator),
+        factorized_delta_t(0)
     {
       material.resize(parameters.n_solid_parts, LinearElasticMaterial<dim>());
       for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
@@ -21,15 +24,25 @@ namespace Solid
     }
 
     template <int dim>
-    void SharedLinearElasticity<dim>::assemble_system(const bool is_initial)
+    void SharedLinearElasticity<dim>::assemble(const bool is_initial,
+                                               const bool assemble_matrix)
     {
-      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::TimerScope timer_section(timer, "Assemble system");
+      OPENIFEM_KERNEL_SCOPE("linear_elasticity_assemble");
 
       double alpha = parameters.damping;
       double beta = pow((1 + alpha), 2) / 4;
 
-      system_matrix = 0;
-      stiffness_matrix = 0;
+      // The explicit integrator moves the internal force to the rhs.
+      const bool internal_force =
+        !assemble_matrix &&
+        parameters.solid_time_integrator == "Central difference";
+
+      if (assemble_matrix)
+        {
+          system_matrix = 0;
+          stiffness_matrix = 0;
+        }
       system_rhs = 0;
 
       FEValues<dim> fe_values(fe,
@@ -43,7 +56,6 @@ namespace Solid
         update_values | update_quadrature_points | update_normal_vectors |
           update_JxW_values);
 
-      SymmetricTensor<4, dim> elasticity;
       const double rho = material[0].get_density();
       const double dt = time.get_delta_t();
 
@@ -57,7 +69,9 @@ namespace Solid
 
       std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
-      Vector<double> localized_displacement(current_displacement);
+      PETScWrappers::MPI::Vector localized_displacement(
+        locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+      localized_displacement = current_displacement;
 
       // The symmetric gradients of the displacement shape functions at a
       // certain point. There are dofs_per_cell shape functions so the size is
@@ -65,6 +79,8 @@ namespace Solid
       std::vector<SymmetricTensor<2, dim>> symmetric_grad_phi(dofs_per_cell);
       // The shape functions at a certain point.
       std::vector<Tensor<1, dim>> phi(dofs_per_cell);
+      // The strain at the quadrature points, only for the internal force.
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_u(n_q_points);
       // A "viewer" to describe the nodal dofs as a vector.
       FEValuesExtractors::Vector displacements(0);
 
@@ -84,12 +100,18 @@ namespace Solid
               int mat_id = cell->material_id();
               if (material.size() == 1)
                 mat_id = 1;
-              elasticity = material[mat_id - 1].get_elasticity();
+              const LinearElasticMaterial<dim> &cell_material =
+                material[mat_id - 1];
               local_matrix = 0;
               local_stiffness = 0;
               local_rhs = 0;
 
               fe_values.reinit(cell);
+              if (internal_force)
+                {
+                  fe_values[displacements].get_function_symmetric_gradients(
+                    localized_displacement, symmetric_grad_u);
+                }
 
               // Loop over quadrature points
               for (unsigned int q = 0; q < n_q_points; ++q)
@@ -101,10 +123,16 @@ namespace Solid
                         fe_values[displacements].symmetric_gradient(k, q);
                       phi[k] = fe_values[displacements].value(k, q);
                     }
+                  const SymmetricTensor<2, dim> sigma =
+                    internal_force
+                      ? cell_material.get_stress(symmetric_grad_u[q])
+                      : SymmetricTensor<2, dim>();
                   // Loop over the dofs again, to assemble
                   for (unsigned int i = 0; i < dofs_per_cell; ++i)
                     {
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                      for (unsigned int j = 0;
+                           assemble_matrix && j < dofs_per_cell;
+                           ++j)
                         {
                           if (is_initial)
                             {
@@ -113,19 +141,26 @@ namespace Solid
                             }
                           else
                             {
+                              const double stiffness =
+                                cell_material.get_stiffness(
+                                  symmetric_grad_phi[i], symmetric_grad_phi[j]);
                               local_matrix[i][j] +=
                                 (rho * phi[i] * phi[j] +
-                                 symmetric_grad_phi[i] * elasticity *
-                                   symmetric_grad_phi[j] * beta * dt * dt) *
+                                 stiffness * beta * dt * dt) *
                                 fe_values.JxW(q);
                               local_stiffness[i][j] +=
-                                symmetric_grad_phi[i] * elasticity *
-                                symmetric_grad_phi[j] * fe_values.JxW(q);
+                                stiffness * fe_values.JxW(q);
                             }
                         }
                       // zero body force
                       Tensor<1, dim> gravity;
                       local_rhs[i] += phi[i] * gravity * rho * fe_values.JxW(q);
+                      if (internal_force)
+                        {
+                          // -internal force
+                          local_rhs[i] -=
+                            symmetric_grad_phi[i] * sigma * fe_values.JxW(q);
+                        }
                     }
                 }
 
@@ -159,6 +194,7 @@ namespace Solid
                           // In stand-alone simulation, the boundary value
                           // is prescribed by the user.
                           value = parameters.solid_neumann_bcs[id];
+                          neumann_table.value(id, time.current(), value);
                         }
                       Tensor<1, dim> traction;
                       if (parameters.simulation_type != "FSI" &&
@@ -250,27 +286,63 @@ namespace Solid
 
               // Now distribute local data to the system, and apply the
               // hanging node constraints at the same time.
-              constraints.distribute_local_to_global(local_matrix,
-                                                     local_rhs,
-                                                     local_dof_indices,
-                                                     system_matrix,
-                                                     system_rhs);
-              constraints.distribute_local_to_global(
-                local_stiffness, local_dof_indices, stiffness_matrix);
+              if (assemble_matrix)
+                {
+                  constraints.distribute_local_to_global(local_matrix,
+                                                         local_rhs,
+                                                         local_dof_indices,
+                                                         system_matrix,
+                                                         system_rhs);
+                  constraints.distribute_local_to_global(
+                    local_stiffness, local_dof_indices, stiffness_matrix);
+                }
+              else
+                {
+                  constraints.distribute_local_to_global(
+                    local_rhs, local_dof_indices, system_rhs);
+                }
             }
         }
       // Synchronize with other processors.
-      system_matrix.compress(VectorOperation::add);
+      if (assemble_matrix)
+        {
+          system_matrix.compress(VectorOperation::add);
+          stiffness_matrix.compress(VectorOperation::add);
+        }
       system_rhs.compress(VectorOperation::add);
-      stiffness_matrix.compress(VectorOperation::add);
+    }
+
+    template <int dim>
+    void SharedLinearElasticity<dim>::assemble_system(const bool is_initial)
+    {
+      assemble(is_initial, true);
+    }
+
+    template <int dim>
+    void SharedLinearElasticity<dim>::assemble_explicit_rhs()
+    {
+      assemble(false, false);
     }
 
     template <int dim>
     void SharedLinearElasticity<dim>::run_one_step(bool first_step)
     {
+      Utils::TraceScope trace("Run one step", "solid");
       std::cout.precision(6);
       std::cout.width(12);
 
+      if (parameters.solid_time_integrator == "Central difference")
+        {
+          this->run_one_explicit_step(first_step);
+          if (parameters.simulation_type == "Solid" && time.time_to_refine())
+            {
+              this->refine_mesh(parameters.global_refinements[1],
+                                parameters.global_refinements[1] + 3);
+              this->assemble_lumped_mass();
+            }
+          return;
+        }
+
       double alpha = -parameters.damping;
       double gamma = 0.5 - alpha;
       double beta = pow((1 - alpha), 2) / 4;
@@ -283,6 +355,7 @@ namespace Solid
           this->solve(system_matrix, previous_acceleration, system_rhs);
           // Update the system_matrix
           assemble_system(false);
+          factorized_delta_t = 0;
           this->output_results(time.get_timestep());
         }
 
@@ -311,7 +384,7 @@ namespace Solid
       stiffness_matrix.vmult(tmp3, tmp2);
       tmp1 -= tmp3;
 
-      auto state = this->solve(system_matrix, current_acceleration, tmp1);
+      auto state = solve_effective_system(tmp1);
 
       // update the current velocity
       // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
@@ -337,10 +410,9 @@ namespace Solid
 
       pcout << std::scientific << std::left << " CG iteration: " << std::setw(3)
             << state.first << " CG residual: " << state.second << std::endl;
+      solver_log.write_step(time.get_timestep(), time.current());
 
-      // strain and stress
-      update_strain_and_stress();
-
+      this->write_monitors();
       if (time.time_to_output())
         {
           this->output_results(time.get_timestep());
@@ -354,144 +426,79 @@ namespace Solid
           tmp2.reinit(locally_owned_dofs, mpi_communicator);
           tmp3.reinit(locally_owned_dofs, mpi_communicator);
           assemble_system(false);
+          factorized_delta_t = 0;
         }
 
       if (parameters.simulation_type == "Solid" && time.time_to_save())
         {
           this->save_checkpoint(time.get_timestep());
         }
+      if (parameters.simulation_type == "Solid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          this->save_buddy_checkpoint(time.get_timestep());
+        }
     }
 
     template <int dim>
-    void SharedLinearElasticity<dim>::update_strain_and_stress()
+    std::pair<unsigned int, double>
+    SharedLinearElasticity<dim>::solve_effective_system(
+      const PETScWrappers::MPI::Vector &rhs)
     {
-      for (unsigned int i = 0; i < dim; ++i)
+      if (!parameters.solid_factorize_linear_system)
         {
-          for (unsigned int j = 0; j < dim; ++j)
-            {
-              strain[i][j] = 0.0;
-              stress[i][j] = 0.0;
-            }
+          return this->solve(system_matrix, current_acceleration, rhs);
         }
-      PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
-                                                   mpi_communicator);
-      surrounding_cells = 0.0;
-      // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-      // at cell and quadrature point level.
-      std::vector<std::vector<Vector<double>>> cell_strain(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> cell_stress(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> quad_strain(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-      std::vector<std::vector<Vector<double>>> quad_stress(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-
-      // Displacement gradients at quadrature points.
-      std::vector<Tensor<2, dim>> current_displacement_gradients(
-        volume_quad_formula.size());
-
-      // The projection matrix from quadrature points to the dofs.
-      FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                    volume_quad_formula.size());
-      FETools::compute_projection_from_quadrature_points_matrix(
-        scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
-      SymmetricTensor<4, dim> elasticity;
-      const FEValuesExtractors::Vector displacements(0);
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_gradients |
-                                update_quadrature_points | update_JxW_values);
-      auto cell = dof_handler.begin_active();
-      auto scalar_cell = scalar_dof_handler.begin_active();
-      Vector<double> local_sorrounding_cells(scalar_fe.dofs_per_cell);
-      local_sorrounding_cells = 1.0;
-
-      Vector<double> localized_current_displacement(current_displacement);
-
-      for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
+      Utils::TimerScope timer_section(timer, "Solve linear system");
+      // In FSI the matrix is reassembled at every step, but with the same
+      // values, so the factorization remains valid.
+      if (factorized_delta_t != time.get_delta_t())
         {
-          if (cell->subdomain_id() == this_mpi_process)
-            {
-              fe_values.reinit(cell);
-              fe_values[displacements].get_function_gradients(
-                localized_current_displacement, current_displacement_gradients);
-              int mat_id = cell->material_id();
-              if (parameters.n_solid_parts == 1)
-                mat_id = 1;
-              elasticity = material[mat_id - 1].get_elasticity();
-
-              for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
-                {
-                  SymmetricTensor<2, dim> tmp_strain, tmp_stress;
-                  for (unsigned int i = 0; i < dim; ++i)
-                    {
-                      for (unsigned int j = 0; j < dim; ++j)
-                        {
-                          tmp_strain[i][j] =
-                            (current_displacement_gradients[q][i][j] +
-                             current_displacement_gradients[q][j][i]) /
-                            2;
-                          quad_strain[i][j][q] = tmp_strain[i][j];
-                        }
-                    }
-                  tmp_stress = elasticity * tmp_strain;
-                  for (unsigned int i = 0; i < dim; ++i)
-                    {
-                      for (unsigned int j = 0; j < dim; ++j)
-                        {
-                          quad_stress[i][j][q] = tmp_stress[i][j];
-                        }
-                    }
-                }
-
-              for (unsigned int i = 0; i < dim; ++i)
-                {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                      qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_strain[i][j],
-                                                              strain[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_stress[i][j],
-                                                              stress[i][j]);
-                    }
-                }
-              scalar_cell->distribute_local_to_global(local_sorrounding_cells,
-                                                      surrounding_cells);
-            }
+          Timer setup_timer;
+          Utils::StartupScope startup("solid factorization");
+          system_factorization.initialize(system_matrix);
+          factorized_delta_t = time.get_delta_t();
+          solver_log.add_preconditioner_setup(setup_timer.wall_time());
         }
-      surrounding_cells.compress(VectorOperation::add);
+      system_factorization.vmult(current_acceleration, rhs);
+      constraints.distribute(current_acceleration);
+      solver_log.add_linear_solve(0, 0);
 
-      for (unsigned int i = 0; i < dim; ++i)
-        {
-          for (unsigned int j = 0; j < dim; ++j)
+      return {0, 0.0};
+    }
+
+    template <int dim>
+    void SharedLinearElasticity<dim>::update_strain_and_stress()
+    {
+      OPENIFEM_KERNEL_SCOPE("linear_elasticity_stress");
+      const FEValuesExtractors::Vector displacements(0);
+      PETScWrappers::MPI::Vector localized_current_displacement(
+        locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+      localized_current_displacement = current_displacement;
+
+      recover_strain_and_stress(
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            FEValues<dim> &fe_values,
+            std::vector<Tensor<2, dim>> &quad_strain,
+            std::vector<Tensor<2, dim>> &quad_stress) {
+          // The displacement gradients are read into quad_strain first.
+          fe_values.reinit(cell);
+          fe_values[displacements].get_function_gradients(
+            localized_current_displacement, quad_strain);
+          int mat_id = cell->material_id();
+          if (parameters.n_solid_parts == 1)
+            mat_id = 1;
+          const LinearElasticMaterial<dim> &cell_material =
+            material[mat_id - 1];
+          for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
             {
-              strain[i][j].compress(VectorOperation::add);
-              stress[i][j].compress(VectorOperation::add);
-              const unsigned int local_begin =
-                surrounding_cells.local_range().first;
-              const unsigned int local_end =
-                surrounding_cells.local_range().second;
-              for (unsigned int k = local_begin; k < local_end; ++k)
-                {
-                  strain[i][j][k] /= surrounding_cells[k];
-                  stress[i][j][k] /= surrounding_cells[k];
-                }
-              strain[i][j].compress(VectorOperation::insert);
-              stress[i][j].compress(VectorOperation::insert);
+              const SymmetricTensor<2, dim> tmp_strain =
+                symmetrize(quad_strain[q]);
+              quad_strain[q] = tmp_strain;
+              quad_stress[q] = cell_material.get_stress(tmp_strain);
             }
-        }
+        });
     }
 
     template class SharedLinearElasticity<2>;
@@ -9,7 +9,8 @@ namespace Solid
     template <int dim, int spacedim>
     SharedSolidSolver<dim, spacedim>::SharedSolidSolver(
       Triangulation<dim, spacedim> &tria,
-      const Parameters::AllParameters &parameters)
+      const Parameters::AllParameters &parameters,
+      MPI_Comm communicator)
       : triangulation(tria),
         parameters(parameters),
         dof_handler(triangulation),
@@ -18,18 +19,45 @@ namespace Solid
         scalar_fe(parameters.solid_degree),
         volume_quad_formula(parameters.solid_degree + 1),
         face_quad_formula(parameters.solid_degree + 1),
-        mpi_communicator(MPI_COMM_WORLD),
+        mpi_communicator(communicator),
         n_mpi_processes(Utilities::MPI::n_mpi_processes(mpi_communicator)),
         this_mpi_process(Utilities::MPI::this_mpi_process(mpi_communicator)),
-        pcout(std::cout, (this_mpi_process == 0)),
+        writes_output(Utilities::MPI::max(
+                        Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0
+                          ? 1u
+                          : 0u,
+                        mpi_communicator) == 1),
+        pcout(std::cout, (this_mpi_process == 0 && writes_output)),
         time(parameters.end_time,
              parameters.time_step,
              parameters.output_interval,
              parameters.refinement_interval,
              parameters.save_interval),
         timer(
-          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times)
+          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        preconditioned_matrix(nullptr),
+        preconditioner_reuse(parameters.solid_preconditioner_max_age,
+                             parameters.solid_preconditioner_max_iterations,
+                             parameters.solid_preconditioner_rebuild_threshold),
+        checkpoint_index("solid"),
+        buddy_checkpoint("solid",
+                         parameters.buddy_checkpoint_directory,
+                         checkpoint_communicator()),
+        xdmf_output("solid", parameters.output_mesh_once),
+        pvd_record("solid.pvd"),
+        output_control(parameters),
+        output_writer(parameters.output_queue_depth),
+        neumann_table(parameters.solid_neumann_table),
+        steady_state(parameters.steady_state_tolerance,
+                     parameters.steady_state_steps),
+        monitor_file("solid_monitor.csv", mpi_communicator),
+        solver_log("solid_solver_log.csv",
+                   mpi_communicator,
+                   parameters.solver_log && writes_output)
     {
+      Utils::TimingReport::instance().add(
+        "solid", timer, mpi_communicator, parameters.timing_report);
+      Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
     }
 
     template <int dim, int spacedim>
@@ -37,20 +65,71 @@ namespace Solid
     {
       scalar_dof_handler.clear();
       dof_handler.clear();
-      timer.print_summary();
+      Utils::TimingReport::instance().remove(timer);
     }
 
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::setup_dofs()
     {
-      TimerOutput::Scope timer_section(timer, "Setup system");
+      Utils::TimerScope timer_section(timer, "Setup system");
+      Utils::StartupScope startup("solid setup_dofs");
 
-      // Because in mpi solid solver we take serial triangulation,
-      // here we partition it.
-      GridTools::partition_triangulation(n_mpi_processes, triangulation);
-
-      dof_handler.distribute_dofs(fe);
-      DoFRenumbering::subdomain_wise(dof_handler);
+      if (setup_cache.valid)
+        {
+          // Restore the partition and the numbering of a previous run.
+          for (auto cell = triangulation.begin_active();
+               cell != triangulation.end();
+               ++cell)
+            {
+              cell->set_subdomain_id(
+                setup_cache.subdomains[cell->active_cell_index()]);
+            }
+          dof_handler.distribute_dofs(fe);
+          dof_handler.renumber_dofs(setup_cache.dof_numbering);
+        }
+      else
+        {
+          // Because in mpi solid solver we take serial triangulation,
+          // here we partition it.
+          GridTools::partition_triangulation(n_mpi_processes, triangulation);
+
+          dof_handler.distribute_dofs(fe);
+          std::vector<types::global_dof_index> initial_dofs(
+            triangulation.n_active_cells() * fe.dofs_per_cell);
+          std::vector<types::global_dof_index> local_dofs(fe.dofs_per_cell);
+          for (auto cell = dof_handler.begin_active();
+               cell != dof_handler.end();
+               ++cell)
+            {
+              cell->get_dof_indices(local_dofs);
+              std::copy(local_dofs.begin(),
+                        local_dofs.end(),
+                        initial_dofs.begin() +
+                          cell->active_cell_index() * fe.dofs_per_cell);
+            }
+          // subdomain_wise keeps the relative order within each subdomain.
+          Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
+          DoFRenumbering::subdomain_wise(dof_handler);
+
+          // Record the setup so that it can be cached.
+          setup_cache.subdomains.resize(triangulation.n_active_cells());
+          setup_cache.dof_numbering.resize(dof_handler.n_dofs());
+          for (auto cell = dof_handler.begin_active();
+               cell != dof_handler.end();
+               ++cell)
+            {
+              const unsigned int c = cell->active_cell_index();
+              setup_cache.subdomains[c] = cell->subdomain_id();
+              cell->get_dof_indices(local_dofs);
+              for (unsigned int i = 0; i < fe.dofs_per_cell; ++i)
+                {
+                  setup_cache.dof_numbering
+                    [initial_dofs[c * fe.dofs_per_cell + i]] = local_dofs[i];
+                }
+            }
+        }
+      xdmf_output.invalidate_mesh();
+      probe_cells.clear();
       scalar_dof_handler.distribute_dofs(scalar_fe);
       DoFRenumbering::subdomain_wise(scalar_dof_handler);
 
@@ -64,6 +143,28 @@ namespace Solid
       locally_owned_scalar_dofs =
         locally_owned_scalar_dofs_per_proc[this_mpi_process];
 
+      // Every process holds the whole mesh but only reads the dofs of its own
+      // cells, which are the ghosts of the distributed vectors.
+      locally_relevant_dofs = locally_owned_dofs;
+      {
+        std::vector<types::global_dof_index> cell_dofs(fe.dofs_per_cell);
+        std::vector<types::global_dof_index> relevant;
+        for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+             ++cell)
+          {
+            if (cell->subdomain_id() != this_mpi_process)
+              {
+                continue;
+              }
+            cell->get_dof_indices(cell_dofs);
+            relevant.insert(relevant.end(), cell_dofs.begin(), cell_dofs.end());
+          }
+        std::sort(relevant.begin(), relevant.end());
+        relevant.erase(std::unique(relevant.begin(), relevant.end()),
+                       relevant.end());
+        locally_relevant_dofs.add_indices(relevant.begin(), relevant.end());
+      }
+
       // The Dirichlet boundary conditions are stored in the AffineConstraints
       // object. It does not need to modify the sparse matrix after assembly,
       // because it is applied in the assembly process,
@@ -114,18 +215,39 @@ namespace Solid
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::initialize_system()
     {
-      DynamicSparsityPattern dsp(dof_handler.n_dofs(), dof_handler.n_dofs());
+      Utils::StartupScope startup("solid initialize_system");
+      if (setup_cache.valid)
+        {
+          const SparsityPattern &sp = setup_cache.sparsity;
+          system_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, sp, mpi_communicator);
+          mass_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, sp, mpi_communicator);
+          stiffness_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, sp, mpi_communicator);
+        }
+      else
+        {
+          DynamicSparsityPattern dsp(dof_handler.n_dofs(),
+                                     dof_handler.n_dofs());
+
+          DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+
+          system_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
 
-      DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+          mass_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
 
-      system_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+          stiffness_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
 
-      mass_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+          write_setup_cache(dsp);
+        }
+      setup_cache = SetupCache();
 
-      stiffness_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+      preconditioner.reset();
+      preconditioner_reuse.invalidate();
 
       system_rhs.reinit(locally_owned_dofs, mpi_communicator);
 
@@ -159,6 +281,208 @@ namespace Solid
           spacedim,
           PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
                                      mpi_communicator)));
+
+      // The recovery vector interleaves all the components of a scalar dof,
+      // so it owns the same range of scalar dofs as strain and stress.
+      AssertThrow(locally_owned_scalar_dofs.is_contiguous(),
+                  ExcMessage("The scalar dofs must be contiguous!"));
+      const unsigned int n_components = 2 * spacedim * spacedim + 1;
+      const unsigned int n_owned = locally_owned_scalar_dofs.n_elements();
+      const types::global_dof_index first_owned =
+        n_owned > 0 ? locally_owned_scalar_dofs.nth_index_in_set(0) : 0;
+      IndexSet locally_owned_recovery_dofs(scalar_dof_handler.n_dofs() *
+                                           n_components);
+      locally_owned_recovery_dofs.add_range(
+        first_owned * n_components, (first_owned + n_owned) * n_components);
+      recovery_values.reinit(locally_owned_recovery_dofs, mpi_communicator);
+
+      qpt_to_dof.reinit(scalar_fe.dofs_per_cell, volume_quad_formula.size());
+      FETools::compute_projection_from_quadrature_points_matrix(
+        scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
+      owned_scalar_indices.resize(n_owned);
+      owned_recovery_indices.resize(n_owned * n_components);
+      for (unsigned int k = 0; k < n_owned; ++k)
+        {
+          owned_scalar_indices[k] = first_owned + k;
+        }
+      for (unsigned int k = 0; k < n_owned * n_components; ++k)
+        {
+          owned_recovery_indices[k] = first_owned * n_components + k;
+        }
+      owned_recovery_entries.resize(n_owned * n_components);
+      owned_component_values.resize(n_owned);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::recover_strain_and_stress(
+      const QuadratureEvaluator &evaluate)
+    {
+      const unsigned int n_components = 2 * spacedim * spacedim + 1;
+      const unsigned int weight = n_components - 1;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const unsigned int dofs_per_cell = scalar_fe.dofs_per_cell;
+      const bool lumped =
+        (parameters.solid_stress_recovery == "Lumped projection");
+
+      // Averaging weights every cell by 1, the lumped projection by the
+      // integral of the shape function, which is the row sum of L.
+      struct ScratchData
+      {
+        ScratchData(const FiniteElement<dim, spacedim> &fe,
+                    const FiniteElement<dim, spacedim> &scalar_fe,
+                    const Quadrature<dim> &quad,
+                    const unsigned int n_components)
+          : fe_values(fe, quad, update_gradients),
+            scalar_fe_values(scalar_fe, quad, update_values | update_JxW_values),
+            cell_projection(scalar_fe.dofs_per_cell, quad.size()),
+            quad_recovery_values(quad.size(), n_components),
+            quad_strain(quad.size()),
+            quad_stress(quad.size())
+        {
+        }
+        ScratchData(const ScratchData &scratch)
+          : fe_values(scratch.fe_values.get_fe(),
+                      scratch.fe_values.get_quadrature(),
+                      scratch.fe_values.get_update_flags()),
+            scalar_fe_values(scratch.scalar_fe_values.get_fe(),
+                             scratch.scalar_fe_values.get_quadrature(),
+                             scratch.scalar_fe_values.get_update_flags()),
+            cell_projection(scratch.cell_projection),
+            quad_recovery_values(scratch.quad_recovery_values),
+            quad_strain(scratch.quad_strain),
+            quad_stress(scratch.quad_stress)
+        {
+        }
+        FEValues<dim, spacedim> fe_values;
+        FEValues<dim, spacedim> scalar_fe_values;
+        FullMatrix<double> cell_projection;
+        FullMatrix<double> quad_recovery_values;
+        std::vector<Tensor<2, spacedim>> quad_strain, quad_stress;
+      };
+      struct CopyData
+      {
+        CopyData(const unsigned int dofs_per_cell,
+                 const unsigned int n_components)
+          : cell_recovery_values(dofs_per_cell, n_components),
+            local_dof_indices(dofs_per_cell),
+            cell_recovery_indices(dofs_per_cell * n_components),
+            cell_recovery_entries(dofs_per_cell * n_components)
+        {
+        }
+        FullMatrix<double> cell_recovery_values;
+        std::vector<types::global_dof_index> local_dof_indices;
+        std::vector<PETScWrappers::MPI::Vector::size_type>
+          cell_recovery_indices;
+        std::vector<PetscScalar> cell_recovery_entries;
+      };
+
+      auto worker =
+        [&](const typename DoFHandler<dim, spacedim>::active_cell_iterator
+              &cell,
+            ScratchData &scratch,
+            CopyData &copy) {
+          // The scalar dof handler shares the triangulation.
+          const typename DoFHandler<dim, spacedim>::active_cell_iterator
+            scalar_cell(&triangulation,
+                        cell->level(),
+                        cell->index(),
+                        &scalar_dof_handler);
+          evaluate(
+            cell, scratch.fe_values, scratch.quad_strain, scratch.quad_stress);
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int i = 0; i < spacedim; ++i)
+                {
+                  for (unsigned int j = 0; j < spacedim; ++j)
+                    {
+                      const unsigned int c = i * spacedim + j;
+                      scratch.quad_recovery_values(q, c) =
+                        scratch.quad_strain[q][i][j];
+                      scratch.quad_recovery_values(q, spacedim * spacedim + c) =
+                        scratch.quad_stress[q][i][j];
+                    }
+                }
+              scratch.quad_recovery_values(q, weight) = 1.0;
+            }
+
+          if (lumped)
+            {
+              scratch.scalar_fe_values.reinit(scalar_cell);
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                {
+                  for (unsigned int q = 0; q < n_q_points; ++q)
+                    {
+                      scratch.cell_projection(k, q) =
+                        scratch.scalar_fe_values.shape_value(k, q) *
+                        scratch.scalar_fe_values.JxW(q);
+                    }
+                }
+            }
+          const FullMatrix<double> &projection =
+            lumped ? scratch.cell_projection : qpt_to_dof;
+          projection.mmult(copy.cell_recovery_values,
+                           scratch.quad_recovery_values);
+          if (!lumped)
+            {
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                {
+                  copy.cell_recovery_values(k, weight) = 1.0;
+                }
+            }
+
+          scalar_cell->get_dof_indices(copy.local_dof_indices);
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              for (unsigned int c = 0; c < n_components; ++c)
+                {
+                  copy.cell_recovery_indices[k * n_components + c] =
+                    copy.local_dof_indices[k] * n_components + c;
+                  copy.cell_recovery_entries[k * n_components + c] =
+                    copy.cell_recovery_values(k, c);
+                }
+            }
+        };
+
+      // The PETSc vector is only written by the copier, in the order of the
+      // cells.
+      auto copier = [this](const CopyData &copy) {
+        recovery_values.add(copy.cell_recovery_indices,
+                            copy.cell_recovery_entries);
+      };
+
+      recovery_values = 0.0;
+      const auto owned_cells =
+        filter_iterators(dof_handler.active_cell_iterators(),
+                         IteratorFilters::SubdomainEqualTo(this_mpi_process));
+      WorkStream::run(
+        owned_cells.begin(),
+        owned_cells.end(),
+        worker,
+        copier,
+        ScratchData(fe, scalar_fe, volume_quad_formula, n_components),
+        CopyData(dofs_per_cell, n_components));
+      recovery_values.compress(VectorOperation::add);
+
+      // All the owned components are read at once, and every strain and
+      // stress vector is written at once.
+      recovery_values.extract_subvector_to(owned_recovery_indices,
+                                           owned_recovery_entries);
+      const unsigned int n_owned = owned_scalar_indices.size();
+      for (unsigned int c = 0; c < weight; ++c)
+        {
+          for (unsigned int k = 0; k < n_owned; ++k)
+            {
+              const unsigned int offset = k * n_components;
+              const double w = owned_recovery_entries[offset + weight];
+              owned_component_values[k] =
+                (w != 0.0 ? owned_recovery_entries[offset + c] / w : 0.0);
+            }
+          const unsigned int i = (c % (spacedim * spacedim)) / spacedim;
+          const unsigned int j = c % spacedim;
+          auto &target = (c < spacedim * spacedim ? strain : stress);
+          target[i][j].set(owned_scalar_indices, owned_component_values);
+          target[i][j].compress(VectorOperation::insert);
+        }
     }
 
     // Solve linear system \f$Ax = b\f$ using CG solver.
@@ -168,140 +492,535 @@ namespace Solid
       PETScWrappers::MPI::Vector &x,
       const PETScWrappers::MPI::Vector &b)
     {
-      TimerOutput::Scope timer_section(timer, "Solve linear system");
+      Utils::TimerScope timer_section(timer, "Solve linear system");
 
       SolverControl solver_control(dof_handler.n_dofs() * 2,
                                    1e-8 * b.l2_norm());
 
-      PETScWrappers::SolverCG cg(solver_control, mpi_communicator);
+      if (parameters.solid_preconditioner.type == "Direct")
+        {
+          // The factorization is part of every solve.
+          Timer setup_timer;
+          PETScWrappers::SparseDirectMUMPS solver(solver_control,
+                                                  mpi_communicator);
+          solver.solve(A, x, b);
+          solver_log.add_preconditioner_setup(setup_timer.wall_time());
+        }
+      else
+        {
+          // The mass matrix and the system matrix are solved with the same
+          // function, a preconditioner is only reused for the same matrix.
+          if (!preconditioner || preconditioned_matrix != &A ||
+              preconditioner_reuse.need_rebuild(time.get_delta_t(), A))
+            {
+              Timer setup_timer;
+              Utils::StartupScope startup("solid preconditioner setup");
+              setup_preconditioner(A);
+              solver_log.add_preconditioner_setup(setup_timer.wall_time());
+            }
+          // PETScWrappers::SolverCG would take the operator from the
+          // preconditioner, which is the lagged copy if it is reused.
+          GrowingVectorMemory<PETScWrappers::MPI::Vector> vector_memory;
+          SolverCG<PETScWrappers::MPI::Vector> cg(solver_control,
+                                                  vector_memory);
+          cg.solve(A, x, b, *preconditioner);
+          preconditioner_reuse.record(solver_control.last_step());
+        }
 
-      PETScWrappers::PreconditionNone preconditioner(A);
+      // The constraints only import the entries they need.
+      constraints.distribute(x);
+      solver_log.add_linear_solve(solver_control.last_step(),
+                                  solver_control.last_value());
 
-      cg.solve(A, x, b, preconditioner);
+      return {solver_control.last_step(), solver_control.last_value()};
+    }
 
-      Vector<double> localized_x(x);
-      constraints.distribute(localized_x);
-      x = localized_x;
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::setup_preconditioner(
+      const PETScWrappers::MPI::SparseMatrix &A)
+    {
+      const PETScWrappers::MPI::SparseMatrix *matrix = &A;
+      if (preconditioner_reuse.lagged())
+        {
+          lagged_matrix.reinit(A);
+          lagged_matrix.copy_from(A);
+          matrix = &lagged_matrix;
+        }
 
-      return {solver_control.last_step(), solver_control.last_value()};
+      preconditioner = make_preconditioner(*matrix,
+                                           parameters.solid_preconditioner,
+                                           spacedim,
+                                           true,
+                                           parameters.solid_degree > 1);
+      preconditioned_matrix = &A;
+      preconditioner_reuse.rebuilt(time.get_delta_t(), A);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::assemble_explicit_rhs()
+    {
+      AssertThrow(false,
+                  ExcMessage("The solid solver has no explicit integrator!"));
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::assemble_lumped_mass()
+    {
+      Utils::TimerScope timer_section(timer, "Assemble lumped mass");
+
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const double rho = parameters.solid_rho;
+
+      FEValues<dim, spacedim> fe_values(
+        fe, volume_quad_formula, update_values | update_JxW_values);
+      Vector<double> local_mass(dofs_per_cell);
+      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+      PETScWrappers::MPI::Vector lumped_mass(locally_owned_dofs,
+                                             mpi_communicator);
+
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (cell->subdomain_id() != this_mpi_process)
+            {
+              continue;
+            }
+          fe_values.reinit(cell);
+          local_mass = 0;
+          // The shape functions of a component sum up to one, so the row
+          // sum of the consistent mass matrix is the integral of a shape
+          // function.
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  const unsigned int component_i =
+                    fe.system_to_component_index(i).first;
+                  local_mass[i] += rho *
+                                   fe_values.shape_value_component(
+                                     i, q, component_i) *
+                                   fe_values.JxW(q);
+                }
+            }
+          cell->get_dof_indices(local_dof_indices);
+          constraints.distribute_local_to_global(
+            local_mass, local_dof_indices, lumped_mass);
+        }
+      lumped_mass.compress(VectorOperation::add);
+
+      inverse_lumped_mass.reinit(locally_owned_dofs, mpi_communicator);
+      const auto range = lumped_mass.local_range();
+      for (auto i = range.first; i < range.second; ++i)
+        {
+          const double m = lumped_mass[i];
+          if (m > 0)
+            {
+              inverse_lumped_mass[i] = 1.0 / m;
+            }
+        }
+      inverse_lumped_mass.compress(VectorOperation::insert);
+    }
+
+    template <int dim, int spacedim>
+    double SharedSolidSolver<dim, spacedim>::estimate_stable_time_step() const
+    {
+      // The dilatational (P-wave) modulus is the stiffest mode of every part.
+      double modulus = 0;
+      for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
+        {
+          if (parameters.solid_type == "LinearElastic")
+            {
+              const double E = parameters.E[i], nu = parameters.nu[i];
+              AssertThrow(nu < 0.5,
+                          ExcMessage("Incompressible solids are unsupported "
+                                     "by the explicit integrator!"));
+              modulus = std::max(modulus,
+                                 E * (1 - nu) / ((1 + nu) * (1 - 2 * nu)));
+            }
+          else if (parameters.solid_type == "NeoHookean")
+            {
+              // The shear modulus is 2 * C1, the bulk modulus kappa.
+              modulus = std::max(modulus,
+                                 parameters.C[i][1] +
+                                   4.0 / 3.0 * 2 * parameters.C[i][0]);
+            }
+          else
+            {
+              AssertThrow(false, ExcNotImplemented());
+            }
+        }
+      const double wave_speed = std::sqrt(modulus / parameters.solid_rho);
+
+      // Every process holds the whole triangulation.
+      double h = std::numeric_limits<double>::max();
+      for (auto cell = triangulation.begin_active();
+           cell != triangulation.end();
+           ++cell)
+        {
+          h = std::min(h, cell->minimum_vertex_distance());
+        }
+      // Higher order elements have nodes degree times closer.
+      return h / (parameters.solid_degree * wave_speed);
+    }
+
+    template <int dim, int spacedim>
+    void
+    SharedSolidSolver<dim, spacedim>::run_one_explicit_step(bool first_step)
+    {
+      // \f$\gamma = \frac{1}{2}\f$ is central difference, damping increases
+      // it the same way as in the implicit solvers.
+      const double gamma = 0.5 + parameters.damping;
+
+      if (first_step)
+        {
+          assemble_lumped_mass();
+          const double stable_dt = estimate_stable_time_step();
+          pcout << "Estimated stable time step = " << stable_dt << std::endl;
+          if (time.get_delta_t() > stable_dt)
+            {
+              pcout << "Warning: the time step is larger than the "
+                       "estimated stable time step!"
+                    << std::endl;
+            }
+          // Compute the initial acceleration, \f$ M_La_n = F - F_{int} \f$.
+          current_displacement = previous_displacement;
+          assemble_explicit_rhs();
+          previous_acceleration = system_rhs;
+          previous_acceleration.scale(inverse_lumped_mass);
+          constraints.distribute(previous_acceleration);
+          output_results(time.get_timestep());
+        }
+
+      const double dt = time.get_delta_t();
+
+      time.increment();
+      pcout << std::string(91, '*') << std::endl
+            << "Time step = " << time.get_timestep()
+            << ", at t = " << std::scientific << time.current() << std::endl;
+
+      // \f$ u_{n+1} = u_n + \Delta{t}v_n + \frac{1}{2}\Delta{t}^2a_n \f$
+      current_displacement = previous_displacement;
+      current_displacement.add(
+        dt, previous_velocity, 0.5 * dt * dt, previous_acceleration);
+
+      // The acceleration only needs the diagonal lumped mass.
+      assemble_explicit_rhs();
+      current_acceleration = system_rhs;
+      current_acceleration.scale(inverse_lumped_mass);
+      constraints.distribute(current_acceleration);
+
+      // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
+      // \f$
+      current_velocity = previous_velocity;
+      current_velocity.add(dt * (1 - gamma),
+                           previous_acceleration,
+                           dt * gamma,
+                           current_acceleration);
+
+      previous_acceleration = current_acceleration;
+      previous_velocity = current_velocity;
+      previous_displacement = current_displacement;
+
+      write_monitors();
+      if (time.time_to_output())
+        {
+          output_results(time.get_timestep());
+        }
+      if (parameters.simulation_type == "Solid" && time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+      if (parameters.simulation_type == "Solid" &&
+          time.time_to_save(parameters.buddy_checkpoint_interval))
+        {
+          save_buddy_checkpoint(time.get_timestep());
+        }
     }
 
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::output_results(
       const unsigned int output_index)
     {
-      TimerOutput::Scope timer_section(timer, "Output results");
+      if (!writes_output)
+        {
+          return;
+        }
+      Utils::TimerScope timer_section(timer, "Output results");
       pcout << "Writing solid results..." << std::endl;
 
-      // Since only process 0 writes the output, we want all the others
-      // to sned their data to process 0, which is automatically done
-      // in this copy constructor.
-      Vector<double> displacement(current_displacement);
-      Vector<double> velocity(current_velocity);
+      // With VTU output only process 0 writes, so we want all the others
+      // to send their data to process 0. This is done by ghosting the
+      // entire solution on process 0 and nothing on the others. With HDF5
+      // output every process writes its own subdomain, which only needs
+      // the dofs on its cells.
+      const bool hdf5 = parameters.output_format == "HDF5";
+      const IndexSet output_dofs =
+        hdf5 ? DoFTools::dof_indices_with_subdomain_association(
+                 dof_handler, this_mpi_process)
+             : this_mpi_process == 0 ? complete_index_set(dof_handler.n_dofs())
+                                     : IndexSet(dof_handler.n_dofs());
+      const IndexSet output_scalar_dofs =
+        hdf5 ? DoFTools::dof_indices_with_subdomain_association(
+                 scalar_dof_handler, this_mpi_process)
+             : this_mpi_process == 0
+                 ? complete_index_set(scalar_dof_handler.n_dofs())
+                 : IndexSet(scalar_dof_handler.n_dofs());
+      // Only the written fields are gathered.
+      const bool write_displacement =
+        output_control.write_field("displacement");
+      const bool write_velocity = output_control.write_field("velocity");
+      const bool write_stress = output_control.write_stress(time);
+      PETScWrappers::MPI::Vector displacement;
+      PETScWrappers::MPI::Vector velocity;
+      if (write_displacement)
+        {
+          displacement.reinit(
+            locally_owned_dofs, output_dofs, mpi_communicator);
+          displacement = current_displacement;
+        }
+      if (write_velocity)
+        {
+          velocity.reinit(locally_owned_dofs, output_dofs, mpi_communicator);
+          velocity = current_velocity;
+        }
 
-      std::vector<std::vector<Vector<double>>> localized_strain(
-        spacedim, std::vector<Vector<double>>(spacedim));
-      std::vector<std::vector<Vector<double>>> localized_stress(
-        spacedim, std::vector<Vector<double>>(spacedim));
-      for (unsigned int i = 0; i < dim; ++i)
+      std::vector<std::vector<PETScWrappers::MPI::Vector>> localized_strain;
+      std::vector<std::vector<PETScWrappers::MPI::Vector>> localized_stress;
+      if (write_stress)
         {
-          for (unsigned int j = 0; j < dim; ++j)
+          // Only recovered for the outputs that write them.
+          update_strain_and_stress();
+          localized_strain = std::vector<
+            std::vector<PETScWrappers::MPI::Vector>>(
+            spacedim,
+            std::vector<PETScWrappers::MPI::Vector>(
+              spacedim,
+              PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
+                                         output_scalar_dofs,
+                                         mpi_communicator)));
+          localized_stress = localized_strain;
+          for (unsigned int i = 0; i < dim; ++i)
             {
-              localized_strain[i][j] = strain[i][j];
-              localized_stress[i][j] = stress[i][j];
+              for (unsigned int j = 0; j < dim; ++j)
+                {
+                  localized_strain[i][j] = strain[i][j];
+                  localized_stress[i][j] = stress[i][j];
+                }
             }
         }
-      if (this_mpi_process == 0)
+      if (hdf5 || this_mpi_process == 0)
         {
           std::vector<std::string> solution_names(spacedim, "displacements");
           std::vector<DataComponentInterpretation::DataComponentInterpretation>
             data_component_interpretation(
               spacedim,
               DataComponentInterpretation::component_is_part_of_vector);
-          DataOut<dim, DoFHandler<dim, spacedim>> data_out;
+          const types::subdomain_id subdomain_id =
+            hdf5 ? this_mpi_process : numbers::invalid_subdomain_id;
+          Utils::FilteredDataOut<dim, spacedim> data_out(
+            [this, subdomain_id](const auto &cell) {
+              return (subdomain_id == numbers::invalid_subdomain_id ||
+                      cell->subdomain_id() == subdomain_id) &&
+                     output_control.write_cell(cell);
+            });
           data_out.attach_dof_handler(dof_handler);
 
           // displacements
-          data_out.add_data_vector(
-            displacement,
-            solution_names,
-            DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
-            data_component_interpretation);
+          if (write_displacement)
+            {
+              data_out.add_data_vector(
+                displacement,
+                solution_names,
+                DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
+                data_component_interpretation);
+            }
 
           // velocity
-          solution_names = std::vector<std::string>(spacedim, "velocities");
-          data_out.add_data_vector(
-            velocity,
-            solution_names,
-            DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
-            data_component_interpretation);
+          if (write_velocity)
+            {
+              solution_names =
+                std::vector<std::string>(spacedim, "velocities");
+              data_out.add_data_vector(
+                velocity,
+                solution_names,
+                DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
+                data_component_interpretation);
+            }
 
           std::vector<unsigned int> subdomain_int(
             triangulation.n_active_cells());
           GridTools::get_subdomain_association(triangulation, subdomain_int);
           Vector<float> subdomain(subdomain_int.begin(), subdomain_int.end());
-          data_out.add_data_vector(subdomain, "subdomain");
+          if (output_control.write_field("subdomain"))
+            {
+              data_out.add_data_vector(subdomain, "subdomain");
+            }
 
           // material ID
           Vector<float> mat(triangulation.n_active_cells());
-          int i = 0;
-          for (auto cell = triangulation.begin_active();
-               cell != triangulation.end();
-               ++cell)
+          if (output_control.write_field("material_id"))
             {
-              mat[i++] = cell->material_id();
+              int i = 0;
+              for (auto cell = triangulation.begin_active();
+                   cell != triangulation.end();
+                   ++cell)
+                {
+                  mat[i++] = cell->material_id();
+                }
+              data_out.add_data_vector(mat, "material_id");
             }
-          data_out.add_data_vector(mat, "material_id");
 
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[0][0], "Exx");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[0][1], "Exy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[1][1], "Eyy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[0][0], "Sxx");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[0][1], "Sxy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[1][1], "Syy");
-          if (spacedim == 3)
+          if (write_stress)
             {
               data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[0][2], "Exz");
+                scalar_dof_handler, localized_strain[0][0], "Exx");
               data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[1][2], "Eyz");
+                scalar_dof_handler, localized_strain[0][1], "Exy");
               data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[2][2], "Ezz");
+                scalar_dof_handler, localized_strain[1][1], "Eyy");
               data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[0][2], "Sxz");
+                scalar_dof_handler, localized_stress[0][0], "Sxx");
               data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[1][2], "Syz");
+                scalar_dof_handler, localized_stress[0][1], "Sxy");
               data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[2][2], "Szz");
+                scalar_dof_handler, localized_stress[1][1], "Syy");
+              if (spacedim == 3)
+                {
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_strain[0][2], "Exz");
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_strain[1][2], "Eyz");
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_strain[2][2], "Ezz");
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_stress[0][2], "Sxz");
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_stress[1][2], "Syz");
+                  data_out.add_data_vector(
+                    scalar_dof_handler, localized_stress[2][2], "Szz");
+                }
             }
 
           data_out.build_patches();
 
+          if (hdf5)
+            {
+              xdmf_output.write(
+                data_out, output_index, time.current(), mpi_communicator);
+              return;
+            }
+
           std::string basename =
             "solid-" + Utilities::int_to_string(output_index, 6);
 
           std::string filename = basename + ".vtu";
 
-          std::ofstream output(filename);
-          data_out.write_vtu(output);
-
+          // The patches are formatted and written by the writer, the record
+          // after the file.
           times_and_names.push_back({time.current(), filename});
-          std::ofstream pvd_output("solid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
+          auto write_vtu =
+            data_out.vtu_task(filename, output_control.vtk_flags());
+          output_writer.push([this, write_vtu, records = times_and_names]() {
+            write_vtu();
+            pvd_record.write(records);
+          });
         }
     }
 
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::write_monitors()
+    {
+      if (!writes_output || parameters.solid_probes.empty() ||
+          !time.time_to_output(parameters.monitor_interval))
+        {
+          return;
+        }
+      Utils::TimerScope timer_section(timer, "Monitors");
+      AssertThrow(parameters.solid_probes.size() % spacedim == 0,
+                  ExcMessage("Inconsistent dimension of the solid probes!"));
+      const unsigned int n_probes = parameters.solid_probes.size() / spacedim;
+
+      // Every process holds the whole triangulation, so the probes are
+      // located the same way on all of them.
+      if (probe_cells.empty())
+        {
+          MappingQ1<dim, spacedim> mapping;
+          for (unsigned int i = 0; i < n_probes; ++i)
+            {
+              Point<spacedim> point;
+              for (unsigned int d = 0; d < spacedim; ++d)
+                {
+                  point[d] = parameters.solid_probes[i * spacedim + d];
+                }
+              try
+                {
+                  probe_cells.push_back(
+                    GridTools::find_active_cell_around_point(
+                      mapping, dof_handler, point));
+                }
+              catch (GridTools::ExcPointNotFound<spacedim> &e)
+                {
+                  probe_cells.emplace_back(dof_handler.end(), Point<dim>());
+                }
+            }
+        }
+
+      // A probe is evaluated by the owner of its cell, which only needs the
+      // dofs on that cell.
+      IndexSet probe_dofs(dof_handler.n_dofs());
+      std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+      for (const auto &cell_point : probe_cells)
+        {
+          if (cell_point.first != dof_handler.end() &&
+              cell_point.first->subdomain_id() == this_mpi_process)
+            {
+              cell_point.first->get_dof_indices(dof_indices);
+              probe_dofs.add_indices(dof_indices.begin(), dof_indices.end());
+            }
+        }
+      PETScWrappers::MPI::Vector displacement(
+        locally_owned_dofs, probe_dofs, mpi_communicator);
+      displacement = current_displacement;
+
+      std::vector<double> values(n_probes * spacedim, 0);
+      std::vector<Vector<double>> u(1, Vector<double>(spacedim));
+      for (unsigned int i = 0; i < n_probes; ++i)
+        {
+          const auto &cell_point = probe_cells[i];
+          if (cell_point.first == dof_handler.end() ||
+              cell_point.first->subdomain_id() != this_mpi_process)
+            {
+              continue;
+            }
+          FEValues<dim, spacedim> fe_values(
+            fe, Quadrature<dim>(cell_point.second), update_values);
+          fe_values.reinit(cell_point.first);
+          fe_values.get_function_values(displacement, u);
+          for (unsigned int d = 0; d < spacedim; ++d)
+            {
+              values[i * spacedim + d] = u[0][d];
+            }
+        }
+      Utilities::MPI::sum(values, mpi_communicator, values);
+
+      const std::string axes = "xyz";
+      std::vector<std::string> columns;
+      for (unsigned int i = 0; i < n_probes; ++i)
+        {
+          for (unsigned int d = 0; d < spacedim; ++d)
+            {
+              columns.push_back("probe" + std::to_string(i) + "_u" + axes[d]);
+            }
+        }
+      monitor_file.write(time.current(), columns, values);
+    }
+
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::refine_mesh(
       const unsigned int min_grid_level, const unsigned int max_grid_level)
     {
-      TimerOutput::Scope timer_section(timer, "Refine mesh");
+      Utils::TimerScope timer_section(timer, "Refine mesh");
       pcout << "Refining mesh..." << std::endl;
 
       Vector<float> estimated_error_per_cell(triangulation.n_active_cells());
@@ -377,29 +1096,51 @@ namespace Solid
       constraints.distribute(previous_displacement);
       constraints.distribute(previous_velocity);
       constraints.distribute(previous_acceleration);
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
     }
 
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::run()
     {
-      triangulation.refine_global(parameters.global_refinements[1]);
+      pcout << "Running with PETSc on "
+            << Utils::parallel_configuration(mpi_communicator) << "..."
+            << std::endl;
+
+      Utils::refine_global_cached(
+        triangulation, parameters.global_refinements[1], parameters.mesh_cache);
       bool success_load = load_checkpoint();
       if (!success_load)
         {
           setup_dofs();
           initialize_system();
         }
+      if (parameters.memory_report)
+        {
+          print_memory_usage();
+        }
 
       // Time loop
+      Utils::StartupProfile::instance().begin_steps();
       if (!success_load)
         run_one_step(true);
       else
         // If we load from previous task, we need to assemble the mass matrix
         assemble_system(true);
+      Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
       while (time.end() - time.current() > 1e-12)
         {
           run_one_step(false);
+          Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                      time.current());
+          if (reached_steady_state())
+            {
+              break;
+            }
         }
+      Utils::Tracer::instance().write(mpi_communicator);
     }
 
     template <int dim, int spacedim>
@@ -409,81 +1150,229 @@ namespace Solid
       return current_displacement;
     }
 
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::print_memory_usage() const
+    {
+      Utils::MemoryReport report("Solid", mpi_communicator);
+      add_memory_usage(report);
+      report.print(std::cout);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::add_memory_usage(
+      Utils::MemoryReport &report) const
+    {
+      // The triangulation is not distributed, every rank has all of it.
+      report.add("solid triangulation", triangulation.memory_consumption());
+      report.add("solid dof handlers",
+                 dof_handler.memory_consumption() +
+                   scalar_dof_handler.memory_consumption());
+      report.add("solid constraints", constraints.memory_consumption());
+      report.add("solid matrices",
+                 system_matrix.memory_consumption() +
+                   mass_matrix.memory_consumption() +
+                   stiffness_matrix.memory_consumption() +
+                   lagged_matrix.memory_consumption());
+      report.add("solid vectors",
+                 system_rhs.memory_consumption() +
+                   current_acceleration.memory_consumption() +
+                   current_velocity.memory_consumption() +
+                   current_displacement.memory_consumption() +
+                   previous_acceleration.memory_consumption() +
+                   previous_velocity.memory_consumption() +
+                   previous_displacement.memory_consumption() +
+                   inverse_lumped_mass.memory_consumption());
+      report.add("solid strain and stress",
+                 MemoryConsumption::memory_consumption(strain) +
+                   MemoryConsumption::memory_consumption(stress) +
+                   recovery_values.memory_consumption());
+      report.add("solid FSI stress",
+                 MemoryConsumption::memory_consumption(fsi_stress_rows));
+      report.add("solid setup cache",
+                 setup_cache.sparsity.memory_consumption() +
+                   MemoryConsumption::memory_consumption(
+                     setup_cache.subdomains) +
+                   MemoryConsumption::memory_consumption(
+                     setup_cache.dof_numbering));
+    }
+
     template <int dim, int spacedim>
     void
     SharedSolidSolver<dim, spacedim>::save_checkpoint(const int output_index)
     {
-      // Save the solution
-      Vector<double> localized_disp(current_displacement);
-      Vector<double> localized_vel(current_velocity);
-      Vector<double> localized_acc(current_acceleration);
+      if (!writes_output)
+        {
+          return;
+        }
+      // Save the solution. The localization is collective, the file is
+      // written by rank 0 from the staged copies, in the background if the
+      // checkpoints are asynchronous.
+      std::vector<Vector<double>> state = checkpoint_state();
 
       if (this_mpi_process == 0)
         {
-          // Specify the current working path
-          fs::path local_path = fs::current_path();
-          // A set to store all the filenames for checkpoints
-          std::set<fs::path> checkpoints;
-          // Find the checkpoints and remove excess ones
-          // Only keep the latest one
-          for (const auto &p : fs::directory_iterator(local_path))
+          auto write = [this, output_index, state = std::move(state)]() {
+            // All the vectors go to one file, which becomes the latest
+            // checkpoint once it is complete.
+            const std::string checkpoint_file =
+              Utilities::int_to_string(output_index, 6) + ".solid_checkpoint";
+            pcout << "Prepare to save to " << checkpoint_file << std::endl;
             {
-              if (p.path().extension() == ".solid_checkpoint_displacement")
+              std::ofstream out(checkpoint_file, std::ios::binary);
+              for (const auto &v : state)
                 {
-                  checkpoints.insert(p.path());
+                  v.block_write(out);
                 }
+              AssertThrow(out,
+                          ExcMessage("Cannot write " + checkpoint_file + "!"));
             }
-          while (checkpoints.size() > 1)
-            {
-              pcout << "Removing " << *checkpoints.begin() << std::endl;
-              fs::path to_be_removed(*checkpoints.begin());
-              fs::remove(to_be_removed);
-              to_be_removed.replace_extension(".solid_checkpoint_velocity");
-              fs::remove(to_be_removed);
-              to_be_removed.replace_extension(".solid_checkpoint_acceleration");
-              fs::remove(to_be_removed);
-              checkpoints.erase(checkpoints.begin());
-            }
-          // Name the checkpoint file
-          fs::path checkpoint_file(local_path);
-          checkpoint_file.append(Utilities::int_to_string(output_index, 6));
-          checkpoint_file.replace_extension(".solid_checkpoint_displacement");
-          pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          std::ofstream disp(checkpoint_file);
-          checkpoint_file.replace_extension(".solid_checkpoint_velocity");
-          pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          std::ofstream vel(checkpoint_file);
-          checkpoint_file.replace_extension(".solid_checkpoint_acceleration");
-          std::ofstream acc(checkpoint_file);
-          pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          localized_disp.block_write(disp);
-          localized_vel.block_write(vel);
-          localized_acc.block_write(acc);
-        }
-
-      pcout << "Checkpoint file successfully saved at time step "
-            << output_index << "!" << std::endl;
+            const int previous = checkpoint_index.record(output_index);
+            if (previous >= 0 && previous != output_index)
+              {
+                fs::path to_be_removed(Utilities::int_to_string(previous, 6) +
+                                       ".solid_checkpoint");
+                pcout << "Removing " << to_be_removed << std::endl;
+                fs::remove(to_be_removed);
+              }
+          };
+          checkpoint_writer.run(std::move(write), parameters.async_checkpoint);
+        }
+
+      if (parameters.async_checkpoint)
+        {
+          pcout << "Checkpoint file being saved at time step "
+                << output_index << "!" << std::endl;
+        }
+      else
+        {
+          pcout << "Checkpoint file successfully saved at time step "
+                << output_index << "!" << std::endl;
+        }
     }
 
     template <int dim, int spacedim>
-    bool SharedSolidSolver<dim, spacedim>::load_checkpoint()
+    std::vector<Vector<double>>
+    SharedSolidSolver<dim, spacedim>::checkpoint_state() const
+    {
+      std::vector<Vector<double>> state;
+      state.emplace_back(current_displacement);
+      state.emplace_back(current_velocity);
+      state.emplace_back(current_acceleration);
+      // The dof numbering depends on the partition, so the vectors are
+      // saved in a numbering that does not.
+      const auto numbering = checkpoint_numbering();
+      Vector<double> tmp(dof_handler.n_dofs());
+      for (auto &v : state)
+        {
+          for (types::global_dof_index i = 0; i < v.size(); ++i)
+            {
+              tmp[numbering[i]] = v[i];
+            }
+          v.swap(tmp);
+        }
+      stage_checkpoint(state);
+      return state;
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::save_buddy_checkpoint(
+      const int output_index)
     {
-      // Specify the current working path
-      fs::path local_path = fs::current_path();
-      fs::path checkpoint_file(local_path);
-      // Find the latest checkpoint
-      for (const auto &p : fs::directory_iterator(local_path))
+      const std::vector<Vector<double>> state = checkpoint_state();
+      // The part starts with the number and the sizes of the vectors,
+      // followed by the slice of their concatenation kept by this rank.
+      std::vector<double> slice{static_cast<double>(state.size())};
+      std::size_t total = 0;
+      for (const auto &v : state)
+        {
+          slice.push_back(v.size());
+          total += v.size();
+        }
+      const std::size_t n_ranks =
+        Utilities::MPI::n_mpi_processes(checkpoint_communicator());
+      const std::size_t rank =
+        Utilities::MPI::this_mpi_process(checkpoint_communicator());
+      const std::size_t begin = total * rank / n_ranks;
+      const std::size_t end = total * (rank + 1) / n_ranks;
+      std::size_t offset = 0;
+      for (const auto &v : state)
         {
-          if (p.path().extension() == ".solid_checkpoint_displacement" &&
-              (std::string(p.path().stem()) >
-                 std::string(checkpoint_file.stem()) ||
-               checkpoint_file == local_path))
+          for (std::size_t i = std::max(begin, offset);
+               i < std::min(end, offset + v.size());
+               ++i)
             {
-              checkpoint_file = p.path();
+              slice.push_back(v[i - offset]);
             }
+          offset += v.size();
+        }
+      std::vector<char> part(slice.size() * sizeof(double));
+      std::memcpy(part.data(), slice.data(), part.size());
+      buddy_checkpoint.save(output_index, part);
+    }
+
+    template <int dim, int spacedim>
+    MPI_Comm SharedSolidSolver<dim, spacedim>::checkpoint_communicator() const
+    {
+      return parameters.concurrent_solid_processes > 0 ? mpi_communicator
+                                                       : MPI_COMM_WORLD;
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::load_buddy_checkpoint(
+      const int latest)
+    {
+      pcout << "Loading the buddy checkpoint of time step " << latest << "!"
+            << std::endl;
+      const auto parts = Utilities::MPI::all_gather(
+        checkpoint_communicator(), buddy_checkpoint.load(latest));
+      std::vector<std::size_t> sizes;
+      std::vector<double> values;
+      for (const auto &part : parts)
+        {
+          std::vector<double> slice(part.size() / sizeof(double));
+          std::memcpy(slice.data(), part.data(), part.size());
+          AssertThrow(!slice.empty() && slice.size() > slice[0],
+                      ExcMessage("Incomplete solid buddy checkpoint!"));
+          const auto first_value =
+            slice.begin() + 1 + static_cast<std::size_t>(slice[0]);
+          sizes.assign(slice.begin() + 1, first_value);
+          values.insert(values.end(), first_value, slice.end());
+        }
+      std::size_t total = 0;
+      for (const std::size_t size : sizes)
+        {
+          total += size;
         }
+      AssertThrow(values.size() == total,
+                  ExcMessage("Incomplete solid buddy checkpoint!"));
+      restored_state.clear();
+      auto value = values.cbegin();
+      for (const std::size_t size : sizes)
+        {
+          restored_state.emplace_back(size);
+          std::copy(value, value + size, restored_state.back().begin());
+          value += size;
+        }
+    }
+
+    template <int dim, int spacedim>
+    bool SharedSolidSolver<dim, spacedim>::load_checkpoint()
+    {
+      Utils::StartupScope startup("solid load_checkpoint");
+      int disk_latest = checkpoint_index.latest(mpi_communicator);
+      // Checkpoints saved before the index existed are found by their names.
+      bool legacy = false;
+      if (disk_latest < 0)
+        {
+          disk_latest = find_legacy_checkpoint();
+          legacy = disk_latest >= 0;
+        }
+      const int buddy_latest = parameters.buddy_checkpoint_interval > 0
+                                 ? buddy_checkpoint.latest()
+                                 : -1;
+      const int latest = std::max(disk_latest, buddy_latest);
       // if no restart file is found, return false
-      if (checkpoint_file == local_path)
+      if (latest < 0)
         {
           pcout
             << "Did not find solid checkpoint files. Start from the beginning !"
@@ -491,31 +1380,65 @@ namespace Solid
           return false;
         }
       // set time step load the checkpoint file
+      read_setup_cache();
       setup_dofs();
       initialize_system();
-      Vector<double> localized_disp(current_displacement);
-      Vector<double> localized_vel(current_velocity);
-      Vector<double> localized_acc(current_acceleration);
-      std::ifstream disp(checkpoint_file);
-      checkpoint_file.replace_extension(".solid_checkpoint_velocity");
-      std::ifstream vel(checkpoint_file);
-      checkpoint_file.replace_extension(".solid_checkpoint_acceleration");
-      std::ifstream acc(checkpoint_file);
-      localized_disp.block_read(disp);
-      localized_vel.block_read(vel);
-      localized_acc.block_read(acc);
-
-      current_displacement = localized_disp;
-      current_velocity = localized_vel;
-      current_acceleration = localized_acc;
+      if (buddy_latest > disk_latest)
+        {
+          legacy = false;
+          load_buddy_checkpoint(buddy_latest);
+        }
+      else if (legacy)
+        {
+          read_legacy_checkpoint(latest);
+        }
+      else
+        {
+          const std::string checkpoint_file =
+            Utilities::int_to_string(latest, 6) + ".solid_checkpoint";
+          std::ifstream in(checkpoint_file, std::ios::binary);
+          AssertThrow(in, ExcMessage("Cannot open " + checkpoint_file + "!"));
+          restored_state.clear();
+          while (in.peek() != std::ifstream::traits_type::eof())
+            {
+              restored_state.emplace_back();
+              restored_state.back().block_read(in);
+            }
+        }
+      AssertThrow(restored_state.size() >= 3,
+                  ExcMessage("Incomplete solid checkpoint!"));
+      // The partition may differ from the one that saved, the vectors are
+      // renumbered to this one and every process takes its owned range.
+      // Legacy checkpoints are already in the dof numbering.
+      const auto numbering = checkpoint_numbering();
+      Vector<double> tmp(dof_handler.n_dofs());
+      for (unsigned int k = 0; k < 3; ++k)
+        {
+          Vector<double> &v = restored_state[k];
+          AssertThrow(v.size() == dof_handler.n_dofs(),
+                      ExcMessage("The solid checkpoint does not match the "
+                                 "mesh!"));
+          if (legacy)
+            {
+              continue;
+            }
+          for (types::global_dof_index i = 0; i < v.size(); ++i)
+            {
+              tmp[i] = v[numbering[i]];
+            }
+          v.swap(tmp);
+        }
+
+      current_displacement = restored_state[0];
+      current_velocity = restored_state[1];
+      current_acceleration = restored_state[2];
       previous_displacement = current_displacement;
       previous_velocity = current_velocity;
       previous_acceleration = current_acceleration;
       // Update the time and names to set the current time and write
       // correct .pvd file.
 
-      for (int i = 0; i <= Utilities::string_to_int(checkpoint_file.stem());
-           ++i)
+      for (int i = 0; i <= latest; ++i)
         {
           if ((time.current() == 0 || time.time_to_output()) &&
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -526,7 +1449,7 @@ namespace Solid
 
               times_and_names.push_back({time.current(), filename});
             }
-          if (i == Utilities::string_to_int(checkpoint_file.stem()))
+          if (i == latest)
             break;
           time.increment();
         }
@@ -536,6 +1459,201 @@ namespace Solid
       return true;
     }
 
+    template <int dim, int spacedim>
+    int SharedSolidSolver<dim, spacedim>::find_legacy_checkpoint() const
+    {
+      int latest = -1;
+      if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+        {
+          for (const auto &p : fs::directory_iterator(fs::current_path()))
+            {
+              if (p.path().extension() == ".solid_checkpoint_displacement")
+                {
+                  latest = std::max(
+                    latest, Utilities::string_to_int(p.path().stem()));
+                }
+            }
+        }
+      MPI_Bcast(&latest, 1, MPI_INT, 0, mpi_communicator);
+      return latest;
+    }
+
+    template <int dim, int spacedim>
+    void
+    SharedSolidSolver<dim, spacedim>::read_legacy_checkpoint(const int step)
+    {
+      pcout << "Loading the legacy solid checkpoint of step " << step
+            << std::endl;
+      restored_state.clear();
+      for (const std::string field :
+           {"displacement", "velocity", "acceleration", "stress"})
+        {
+          const std::string checkpoint_file =
+            Utilities::int_to_string(step, 6) + ".solid_checkpoint_" + field;
+          std::ifstream in(checkpoint_file, std::ios::binary);
+          // Only the hypoelastic solver saved the stress.
+          if (field == "stress" && !in)
+            {
+              break;
+            }
+          AssertThrow(in, ExcMessage("Cannot open " + checkpoint_file + "!"));
+          restored_state.emplace_back();
+          restored_state.back().block_read(in);
+        }
+    }
+
+    template <int dim, int spacedim>
+    std::vector<types::global_dof_index>
+    SharedSolidSolver<dim, spacedim>::checkpoint_numbering() const
+    {
+      // Every process has the entire mesh, whose active cells are in the
+      // same order regardless of the partition.
+      std::vector<types::global_dof_index> numbering(
+        dof_handler.n_dofs(), numbers::invalid_dof_index);
+      std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+      types::global_dof_index next = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          cell->get_dof_indices(dof_indices);
+          for (const auto i : dof_indices)
+            {
+              if (numbering[i] == numbers::invalid_dof_index)
+                {
+                  numbering[i] = next++;
+                }
+            }
+        }
+      return numbering;
+    }
+
+    template <int dim, int spacedim>
+    std::uint64_t SharedSolidSolver<dim, spacedim>::setup_checksum() const
+    {
+      // Everything the partition, numbering and sparsity depend on.
+      Utils::Checksum checksum;
+      checksum.add(n_mpi_processes);
+      checksum.add(fe.degree);
+      checksum.add(fe.dofs_per_cell);
+      checksum.add(parameters.dof_renumbering.data(),
+                   parameters.dof_renumbering.size());
+      for (const auto &bc : parameters.solid_dirichlet_bcs)
+        {
+          checksum.add(bc.first);
+          checksum.add(bc.second);
+        }
+      for (const auto &v : triangulation.get_vertices())
+        {
+          for (unsigned int d = 0; d < spacedim; ++d)
+            {
+              checksum.add(v[d]);
+            }
+        }
+      for (auto cell = triangulation.begin_active();
+           cell != triangulation.end();
+           ++cell)
+        {
+          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              checksum.add(cell->vertex_index(v));
+            }
+        }
+      return checksum.value();
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::read_setup_cache()
+    {
+      setup_cache = SetupCache();
+      std::ifstream in("solid.setup_cache", std::ios::binary);
+      if (!in)
+        {
+          return;
+        }
+      // Reading a mismatched cache is harmless, it is simply not used.
+      std::uint64_t size = 0;
+      in.read(reinterpret_cast<char *>(&setup_cache.checksum),
+              sizeof(setup_cache.checksum));
+      if (!in || setup_cache.checksum != setup_checksum())
+        {
+          pcout << "The solid setup cache does not match, recomputing."
+                << std::endl;
+          return;
+        }
+      in.read(reinterpret_cast<char *>(&size), sizeof(size));
+      setup_cache.subdomains.resize(size);
+      in.read(reinterpret_cast<char *>(setup_cache.subdomains.data()),
+              size * sizeof(types::subdomain_id));
+      in.read(reinterpret_cast<char *>(&size), sizeof(size));
+      setup_cache.dof_numbering.resize(size);
+      in.read(reinterpret_cast<char *>(setup_cache.dof_numbering.data()),
+              size * sizeof(types::global_dof_index));
+      setup_cache.sparsity.block_read(in);
+      setup_cache.valid =
+        in && setup_cache.subdomains.size() == triangulation.n_active_cells();
+      if (setup_cache.valid)
+        {
+          pcout << "Reusing the cached solid partition and sparsity."
+                << std::endl;
+        }
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::write_setup_cache(
+      const DynamicSparsityPattern &dsp) const
+    {
+      // Only worth it if the run can be restarted.
+      if (this_mpi_process != 0 || !writes_output ||
+          parameters.save_interval > time.end())
+        {
+          return;
+        }
+      SparsityPattern sparsity;
+      sparsity.copy_from(dsp);
+      // Written to a temporary file first so that a crash never leaves a
+      // truncated cache that matches the checksum.
+      const std::string tmp_file = "solid.setup_cache.tmp";
+      {
+        std::ofstream out(tmp_file, std::ios::binary);
+        const std::uint64_t checksum = setup_checksum();
+        out.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+        std::uint64_t size = setup_cache.subdomains.size();
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        out.write(
+          reinterpret_cast<const char *>(setup_cache.subdomains.data()),
+          size * sizeof(types::subdomain_id));
+        size = setup_cache.dof_numbering.size();
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        out.write(
+          reinterpret_cast<const char *>(setup_cache.dof_numbering.data()),
+          size * sizeof(types::global_dof_index));
+        sparsity.block_write(out);
+        AssertThrow(out, ExcMessage("Cannot write " + tmp_file + "!"));
+      }
+      fs::rename(tmp_file, "solid.setup_cache");
+    }
+
+    template <int dim, int spacedim>
+    bool SharedSolidSolver<dim, spacedim>::reached_steady_state()
+    {
+      if (!steady_state.record(current_displacement, time.current()))
+        {
+          return false;
+        }
+      pcout << "Steady state reached at t = " << time.current()
+            << ", rate of change = " << steady_state.rate() << std::endl;
+      if (!time.time_to_output())
+        {
+          output_results(time.get_timestep());
+        }
+      if (!time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+      return true;
+    }
+
     template class SharedSolidSolver<2>;
     template class SharedSolidSolver<3>;
     template class SharedSolidSolver<2, 3>;
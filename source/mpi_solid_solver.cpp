@@ -18,7 +18,7 @@ namespace Solid
         dg_fe(FE_DGQ<dim>(parameters.solid_degree)),
         volume_quad_formula(parameters.solid_degree + 1),
         face_quad_formula(parameters.solid_degree + 1),
-        mpi_communicator(MPI_COMM_WORLD),
+        mpi_communicator(tria.get_communicator()),
         pcout(std::cout,
               (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)),
         time(parameters.end_time,
@@ -27,8 +27,18 @@ namespace Solid
              parameters.refinement_interval,
              parameters.save_interval),
         timer(
-          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times)
+          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        xdmf_output("solid", parameters.output_mesh_once),
+        output_control(parameters),
+        neumann_table(parameters.solid_neumann_table),
+        steady_state(parameters.steady_state_tolerance,
+                     parameters.steady_state_steps),
+        solver_log(
+          "solid_solver_log.csv", mpi_communicator, parameters.solver_log)
     {
+      Utils::TimingReport::instance().add(
+        "solid", timer, mpi_communicator, parameters.timing_report);
+      Utils::Tracer::instance().enable(parameters.trace, mpi_communicator);
     }
 
     template <int dim>
@@ -36,17 +46,19 @@ namespace Solid
     {
       dg_dof_handler.clear();
       dof_handler.clear();
-      timer.print_summary();
+      Utils::TimingReport::instance().remove(timer);
     }
 
     template <int dim>
     void SolidSolver<dim>::setup_dofs()
     {
-      TimerOutput::Scope timer_section(timer, "Setup system");
+      Utils::TimerScope timer_section(timer, "Setup system");
+      Utils::StartupScope startup("solid setup_dofs");
 
       dof_handler.distribute_dofs(fe);
-      DoFRenumbering::Cuthill_McKee(dof_handler);
+      Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
       dg_dof_handler.distribute_dofs(dg_fe);
+      xdmf_output.invalidate_mesh();
 
       // Extract the locally owned and relevant dofs
       locally_owned_dofs = dof_handler.locally_owned_dofs();
@@ -95,6 +107,11 @@ namespace Solid
 
       constraints.close();
 
+      if (parameters.simulation_type == "FSI")
+        {
+          setup_fsi_traction();
+        }
+
       pcout << "  Number of active solid cells: "
             << triangulation.n_global_active_cells() << std::endl
             << "  Number of degrees of freedom: " << dof_handler.n_dofs()
@@ -104,6 +121,7 @@ namespace Solid
     template <int dim>
     void SolidSolver<dim>::initialize_system()
     {
+      Utils::StartupScope startup("solid initialize_system");
       DynamicSparsityPattern dsp(locally_relevant_dofs);
 
       DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
@@ -145,7 +163,7 @@ namespace Solid
                             PETScWrappers::MPI::Vector &x,
                             const PETScWrappers::MPI::Vector &b)
     {
-      TimerOutput::Scope timer_section(timer, "Solve linear system");
+      Utils::TimerScope timer_section(timer, "Solve linear system");
 
       SolverControl solver_control(dof_handler.n_dofs(), 1e-8 * b.l2_norm());
 
@@ -162,47 +180,64 @@ namespace Solid
     template <int dim>
     void SolidSolver<dim>::output_results(const unsigned int output_index) const
     {
-      TimerOutput::Scope timer_section(timer, "Output results");
+      Utils::TimerScope timer_section(timer, "Output results");
       pcout << "Writing solid results..." << std::endl;
 
       std::vector<std::string> solution_names(dim, "displacements");
       std::vector<DataComponentInterpretation::DataComponentInterpretation>
         data_component_interpretation(
           dim, DataComponentInterpretation::component_is_part_of_vector);
-      DataOut<dim> data_out;
+      Utils::FilteredDataOut<dim> data_out([this](const auto &cell) {
+        return output_control.write_cell(cell);
+      });
       data_out.attach_dof_handler(dof_handler);
 
       // DataOut needs more than locally owned dofs, so we have to construct a
       // ghosted vector to store the solution.
       PETScWrappers::MPI::Vector solution(
         locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
-      solution = current_displacement;
-
-      data_out.add_data_vector(solution,
-                               solution_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
+      if (output_control.write_field("displacement"))
+        {
+          solution = current_displacement;
+          data_out.add_data_vector(solution,
+                                   solution_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
+        }
 
       Vector<float> subdomain(triangulation.n_active_cells());
-      for (unsigned int i = 0; i < subdomain.size(); ++i)
+      if (output_control.write_field("subdomain"))
         {
-          subdomain(i) = triangulation.locally_owned_subdomain();
+          for (unsigned int i = 0; i < subdomain.size(); ++i)
+            {
+              subdomain(i) = triangulation.locally_owned_subdomain();
+            }
+          data_out.add_data_vector(subdomain, "subdomain");
         }
-      data_out.add_data_vector(subdomain, "subdomain");
 
       // material ID
       Vector<float> mat(triangulation.n_active_cells());
-      int i = 0;
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
+      if (output_control.write_field("material_id"))
         {
-          mat[i++] = cell->material_id();
+          int i = 0;
+          for (auto cell = triangulation.begin_active();
+               cell != triangulation.end();
+               ++cell)
+            {
+              mat[i++] = cell->material_id();
+            }
+          data_out.add_data_vector(mat, "material_id");
         }
-      data_out.add_data_vector(mat, "material_id");
 
       data_out.build_patches();
 
+      if (parameters.output_format == "HDF5")
+        {
+          xdmf_output.write(
+            data_out, output_index, time.current(), mpi_communicator);
+          return;
+        }
+
       std::string basename =
         "solid-" + Utilities::int_to_string(output_index, 6) + "-";
 
@@ -212,10 +247,12 @@ namespace Solid
         ".vtu";
 
       std::ofstream output(filename);
+      output_control.set_flags(data_out);
       data_out.write_vtu(output);
 
       // Processor 0 writes the pvd file that tells ParaView filenames and time.
       static std::vector<std::pair<double, std::string>> times_and_names;
+      static Utils::PVDRecord pvd_record("solid.pvd");
       if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
           for (unsigned int i = 0;
@@ -226,8 +263,7 @@ namespace Solid
                 {time.current(),
                  basename + Utilities::int_to_string(i, 4) + ".vtu"});
             }
-          std::ofstream pvd_output("solid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
+          pvd_record.write(times_and_names);
         }
     }
 
@@ -235,7 +271,7 @@ namespace Solid
     void SolidSolver<dim>::refine_mesh(const unsigned int min_grid_level,
                                        const unsigned int max_grid_level)
     {
-      TimerOutput::Scope timer_section(timer, "Refine mesh");
+      Utils::TimerScope timer_section(timer, "Refine mesh");
       pcout << "Refining mesh..." << std::endl;
 
       Vector<float> estimated_error_per_cell(triangulation.n_active_cells());
@@ -311,19 +347,85 @@ namespace Solid
       constraints.distribute(previous_acceleration);
     }
 
+    template <int dim>
+    void SolidSolver<dim>::setup_fsi_traction()
+    {
+      const unsigned int faces_per_cell = GeometryInfo<dim>::faces_per_cell;
+      fsi_traction_offset.assign(triangulation.n_active_cells() *
+                                   faces_per_cell,
+                                 numbers::invalid_unsigned_int);
+      unsigned int n_points = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            continue;
+          for (unsigned int f = 0; f < faces_per_cell; ++f)
+            {
+              if (!cell->face(f)->at_boundary())
+                continue;
+              fsi_traction_offset[cell->active_cell_index() * faces_per_cell +
+                                  f] = n_points;
+              n_points += face_quad_formula.size();
+            }
+        }
+      fsi_traction.assign(n_points, Tensor<1, dim>());
+    }
+
+    template <int dim>
+    void SolidSolver<dim>::add_fsi_traction(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      const unsigned int face,
+      const FEFaceValues<dim> &fe_face_values,
+      Vector<double> &local_rhs) const
+    {
+      const unsigned int offset =
+        fsi_traction_offset[cell->active_cell_index() *
+                              GeometryInfo<dim>::faces_per_cell +
+                            face];
+      Assert(offset != numbers::invalid_unsigned_int,
+             ExcMessage("The face is not on the FSI interface!"));
+      for (unsigned int q = 0; q < face_quad_formula.size(); ++q)
+        {
+          // The area element is already in the traction.
+          const Tensor<1, dim> &traction = fsi_traction[offset + q];
+          for (unsigned int j = 0; j < fe.dofs_per_cell; ++j)
+            {
+              const unsigned int component_j =
+                fe.system_to_component_index(j).first;
+              local_rhs(j) +=
+                fe_face_values.shape_value(j, q) * traction[component_j];
+            }
+        }
+    }
+
     template <int dim>
     void SolidSolver<dim>::run()
     {
-      triangulation.refine_global(parameters.global_refinements[1]);
+      pcout << "Running with PETSc on "
+            << Utils::parallel_configuration(mpi_communicator) << "..."
+            << std::endl;
+
+      Utils::refine_global_cached(
+        triangulation, parameters.global_refinements[1], parameters.mesh_cache);
       setup_dofs();
       initialize_system();
 
       // Time loop
+      Utils::StartupProfile::instance().begin_steps();
       run_one_step(true);
+      Utils::StartupProfile::instance().report(mpi_communicator, std::cout);
       while (time.end() - time.current() > 1e-12)
         {
           run_one_step(false);
+          Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                      time.current());
+          if (reached_steady_state())
+            {
+              break;
+            }
         }
+      Utils::Tracer::instance().write(mpi_communicator);
     }
 
     template <int dim>
@@ -332,6 +434,22 @@ namespace Solid
       return current_displacement;
     }
 
+    template <int dim>
+    bool SolidSolver<dim>::reached_steady_state()
+    {
+      if (!steady_state.record(current_displacement, time.current()))
+        {
+          return false;
+        }
+      pcout << "Steady state reached at t = " << time.current()
+            << ", rate of change = " << steady_state.rate() << std::endl;
+      if (!time.time_to_output())
+        {
+          output_results(time.get_timestep());
+        }
+      return true;
+    }
+
     template class SolidSolver<2>;
     template class SolidSolver<3>;
   } // namespace MPI
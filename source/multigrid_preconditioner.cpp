@@ -0,0 +1,401 @@
+#include "multigrid_preconditioner.h"
+#include <deal.II/base/exceptions.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/mapping_q_generic.h>
+#include <deal.II/lac/affine_constraints.h>
+#include <deal.II/lac/exceptions.h>
+
+namespace
+{
+  // The Grad-Div term only exists if the field is a vector of dim components.
+  template <int dim, typename Number>
+  void add_grad_div(Tensor<1, dim, Number> &,
+                    const Tensor<1, dim, Number> &,
+                    const float)
+  {
+  }
+
+  template <int dim, typename Number>
+  void add_grad_div(Tensor<2, dim, Number> &flux,
+                    const Tensor<2, dim, Number> &gradient,
+                    const float coefficient)
+  {
+    Number divergence = gradient[0][0];
+    for (unsigned int d = 1; d < dim; ++d)
+      {
+        divergence += gradient[d][d];
+      }
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        flux[d][d] += coefficient * divergence;
+      }
+  }
+} // namespace
+
+/* ----------------- MultigridLevelOperator ------------------------ */
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::set_coefficients(
+  const double mass, const double laplace, const double grad_div)
+{
+  mass_coefficient = mass;
+  laplace_coefficient = laplace;
+  grad_div_coefficient = grad_div;
+}
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::compute_diagonal()
+{
+  this->inverse_diagonal_entries.reset(new DiagonalMatrix<VectorType>());
+  VectorType &inverse_diagonal = this->inverse_diagonal_entries->get_vector();
+  this->data->initialize_dof_vector(inverse_diagonal);
+  unsigned int dummy = 0;
+  this->data->cell_loop(&MultigridLevelOperator::local_compute_diagonal,
+                        this,
+                        inverse_diagonal,
+                        dummy);
+  this->set_constrained_entries_to_one(inverse_diagonal);
+  for (unsigned int i = 0; i < inverse_diagonal.local_size(); ++i)
+    {
+      Assert(inverse_diagonal.local_element(i) > 0,
+             ExcMessage("The level operator must be positive definite!"));
+      inverse_diagonal.local_element(i) =
+        1. / inverse_diagonal.local_element(i);
+    }
+}
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::apply_add(
+  VectorType &dst, const VectorType &src) const
+{
+  this->data->cell_loop(&MultigridLevelOperator::local_apply, this, dst, src);
+}
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::local_apply(
+  const MatrixFree<dim, float> &data,
+  VectorType &dst,
+  const VectorType &src,
+  const std::pair<unsigned int, unsigned int> &range) const
+{
+  FEEvaluation<dim, -1, 0, n_components, float> phi(data);
+  for (unsigned int cell = range.first; cell < range.second; ++cell)
+    {
+      phi.reinit(cell);
+      phi.read_dof_values(src);
+      phi.evaluate(true, true);
+      apply_quadrature(phi);
+      phi.integrate(true, true);
+      phi.distribute_local_to_global(dst);
+    }
+}
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::local_compute_diagonal(
+  const MatrixFree<dim, float> &data,
+  VectorType &dst,
+  const unsigned int &,
+  const std::pair<unsigned int, unsigned int> &range) const
+{
+  FEEvaluation<dim, -1, 0, n_components, float> phi(data);
+  AlignedVector<VectorizedArray<float>> diagonal(phi.dofs_per_cell);
+  for (unsigned int cell = range.first; cell < range.second; ++cell)
+    {
+      phi.reinit(cell);
+      // Apply the operator to every unit vector of the cell and keep the
+      // diagonal entry, all components at once.
+      for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+        {
+          for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+            {
+              phi.begin_dof_values()[j] = 0.f;
+            }
+          phi.begin_dof_values()[i] = 1.f;
+          phi.evaluate(true, true);
+          apply_quadrature(phi);
+          phi.integrate(true, true);
+          diagonal[i] = phi.begin_dof_values()[i];
+        }
+      for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+        {
+          phi.begin_dof_values()[i] = diagonal[i];
+        }
+      phi.distribute_local_to_global(dst);
+    }
+}
+
+template <int dim, int n_components>
+void MultigridLevelOperator<dim, n_components>::apply_quadrature(
+  FEEvaluation<dim, -1, 0, n_components, float> &phi) const
+{
+  for (unsigned int q = 0; q < phi.n_q_points; ++q)
+    {
+      const auto gradient = phi.get_gradient(q);
+      auto flux = gradient * laplace_coefficient;
+      add_grad_div(flux, gradient, grad_div_coefficient);
+      phi.submit_value(phi.get_value(q) * mass_coefficient, q);
+      phi.submit_gradient(flux, q);
+    }
+}
+
+/* ----------------- PreconditionGMG ------------------------ */
+
+template <int dim, int n_components>
+PreconditionGMG<dim, n_components>::AdditionalData::AdditionalData(
+  const double mass_coefficient,
+  const double laplace_coefficient,
+  const double grad_div_coefficient,
+  const unsigned int smoothing_degree)
+  : mass_coefficient(mass_coefficient),
+    laplace_coefficient(laplace_coefficient),
+    grad_div_coefficient(grad_div_coefficient),
+    smoothing_degree(smoothing_degree)
+{
+}
+
+template <int dim, int n_components>
+void PreconditionGMG<dim, n_components>::reinit(
+  const DoFHandler<dim> &system_dof_handler,
+  const unsigned int first_component,
+  const IndexSet &owned_block_dofs,
+  const types::global_dof_index block_offset,
+  const std::map<types::boundary_id, ComponentMask> &dirichlet_boundaries)
+{
+  // The shell and the multigrid refer to the hierarchy being rebuilt.
+  clear();
+  preconditioner.reset();
+  multigrid.reset();
+
+  const auto *triangulation =
+    dynamic_cast<const parallel::distributed::Triangulation<dim> *>(
+      &system_dof_handler.get_triangulation());
+  AssertThrow(triangulation &&
+                triangulation->is_multilevel_hierarchy_constructed(),
+              ExcMessage("Geometric multigrid requires a parallel "
+                         "triangulation created with the "
+                         "construct_multigrid_hierarchy flag!"));
+  const MPI_Comm comm = triangulation->get_communicator();
+
+  const FiniteElement<dim> &system_fe = system_dof_handler.get_fe();
+  fe = std::make_unique<FESystem<dim>>(
+    system_fe.base_element(
+      system_fe.component_to_base_index(first_component).first),
+    n_components);
+  dof_handler.initialize(*triangulation, *fe);
+  dof_handler.distribute_mg_dofs();
+
+  mg_constrained_dofs.clear();
+  mg_constrained_dofs.initialize(dof_handler);
+  for (const auto &boundary : dirichlet_boundaries)
+    {
+      mg_constrained_dofs.make_zero_boundary_constraints(
+        dof_handler, {boundary.first}, boundary.second);
+    }
+
+  const unsigned int n_levels = triangulation->n_global_levels();
+  level_operators.resize(0, n_levels - 1);
+  for (unsigned int level = 0; level < n_levels; ++level)
+    {
+      IndexSet relevant_dofs;
+      DoFTools::extract_locally_relevant_level_dofs(
+        dof_handler, level, relevant_dofs);
+      AffineConstraints<double> level_constraints;
+      level_constraints.reinit(relevant_dofs);
+      level_constraints.add_lines(
+        mg_constrained_dofs.get_boundary_indices(level));
+      level_constraints.close();
+
+      typename MatrixFree<dim, float>::AdditionalData data;
+      data.tasks_parallel_scheme = MatrixFree<dim, float>::AdditionalData::none;
+      data.mapping_update_flags =
+        update_values | update_gradients | update_JxW_values;
+      data.mg_level = level;
+      auto level_matrix_free = std::make_shared<MatrixFree<dim, float>>();
+      // The same quadrature as the assembly of the system.
+      level_matrix_free->reinit(MappingQGeneric<dim>(1),
+                                dof_handler,
+                                level_constraints,
+                                QGauss<1>(fe->degree + 1),
+                                data);
+      level_operators[level].initialize(
+        level_matrix_free, mg_constrained_dofs, level);
+    }
+
+  mg_transfer.clear();
+  mg_transfer.initialize_constraints(mg_constrained_dofs);
+  mg_transfer.build(dof_handler);
+
+  IndexSet relevant_dofs;
+  DoFTools::extract_locally_relevant_dofs(dof_handler, relevant_dofs);
+  src_buffer.reinit(dof_handler.locally_owned_dofs(), relevant_dofs, comm);
+  dst_buffer.reinit(src_buffer);
+
+  // Both dof handlers give a dof to the same process, so the locally owned
+  // dofs of the block are found on the locally owned cells.
+  petsc_to_mg.assign(owned_block_dofs.n_elements(),
+                     numbers::invalid_unsigned_int);
+  std::vector<types::global_dof_index> system_indices(system_fe.dofs_per_cell);
+  std::vector<types::global_dof_index> mg_indices(fe->dofs_per_cell);
+  auto mg_cell = dof_handler.begin_active();
+  for (auto cell = system_dof_handler.begin_active();
+       cell != system_dof_handler.end();
+       ++cell, ++mg_cell)
+    {
+      if (!cell->is_locally_owned())
+        {
+          continue;
+        }
+      cell->get_dof_indices(system_indices);
+      mg_cell->get_dof_indices(mg_indices);
+      for (unsigned int i = 0; i < system_fe.dofs_per_cell; ++i)
+        {
+          const auto component = system_fe.system_to_component_index(i);
+          if (component.first < first_component ||
+              component.first >= first_component + n_components)
+            {
+              continue;
+            }
+          const types::global_dof_index index =
+            system_indices[i] - block_offset;
+          if (!owned_block_dofs.is_element(index))
+            {
+              continue;
+            }
+          const types::global_dof_index mg_index =
+            mg_indices[fe->component_to_system_index(
+              component.first - first_component, component.second)];
+          AssertThrow(src_buffer.in_local_range(mg_index),
+                      ExcMessage("Inconsistent ownership of the multigrid "
+                                 "dofs!"));
+          petsc_to_mg[owned_block_dofs.index_within_set(index)] =
+            src_buffer.get_partitioner()->global_to_local(mg_index);
+        }
+    }
+}
+
+template <int dim, int n_components>
+void PreconditionGMG<dim, n_components>::initialize(
+  const PETScWrappers::MatrixBase &matrix_,
+  const AdditionalData &additional_data_)
+{
+  clear();
+  preconditioner.reset();
+  multigrid.reset();
+
+  matrix = static_cast<Mat>(matrix_);
+  additional_data = additional_data_;
+
+  const unsigned int n_levels = level_operators.max_level() + 1;
+  MGLevelObject<typename SmootherType::AdditionalData> smoother_data(
+    0, n_levels - 1);
+  interface_operators.resize(0, n_levels - 1);
+  for (unsigned int level = 0; level < n_levels; ++level)
+    {
+      level_operators[level].set_coefficients(
+        additional_data.mass_coefficient,
+        additional_data.laplace_coefficient,
+        additional_data.grad_div_coefficient);
+      level_operators[level].compute_diagonal();
+      if (level > 0)
+        {
+          smoother_data[level].smoothing_range = 15.;
+          smoother_data[level].degree = additional_data.smoothing_degree;
+          smoother_data[level].eig_cg_n_iterations = 10;
+        }
+      else
+        {
+          smoother_data[0].smoothing_range = 1e-3;
+          smoother_data[0].degree = numbers::invalid_unsigned_int;
+          smoother_data[0].eig_cg_n_iterations = level_operators[0].m();
+        }
+      smoother_data[level].preconditioner =
+        level_operators[level].get_matrix_diagonal_inverse();
+      interface_operators[level].initialize(level_operators[level]);
+    }
+  mg_smoother.initialize(level_operators, smoother_data);
+  mg_coarse.initialize(mg_smoother);
+  mg_matrix.initialize(level_operators);
+  mg_interface.initialize(interface_operators);
+  multigrid = std::make_unique<Multigrid<VectorType>>(
+    mg_matrix, mg_coarse, mg_transfer, mg_smoother, mg_smoother);
+  multigrid->set_edge_matrices(mg_interface, mg_interface);
+  preconditioner = std::make_unique<
+    PreconditionMG<dim, VectorType, MGTransferMatrixFree<dim, float>>>(
+    dof_handler, *multigrid, mg_transfer);
+
+  PetscErrorCode ierr = PCCreate(matrix_.get_mpi_communicator(), &pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetOperators(pc, matrix, matrix);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetType(pc, const_cast<char *>(PCSHELL));
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCShellSetContext(pc, this);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCShellSetApply(pc, &PreconditionGMG::apply);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+}
+
+template <int dim, int n_components>
+std::size_t PreconditionGMG<dim, n_components>::memory_consumption() const
+{
+  std::size_t memory = mg_transfer.memory_consumption() +
+                       src_buffer.memory_consumption() +
+                       dst_buffer.memory_consumption();
+  for (unsigned int level = level_operators.min_level();
+       level <= level_operators.max_level();
+       ++level)
+    {
+      memory += level_operators[level].memory_consumption();
+    }
+  return memory;
+}
+
+template <int dim, int n_components>
+PetscErrorCode
+PreconditionGMG<dim, n_components>::apply(PC pc, Vec src, Vec dst)
+{
+  PetscFunctionBegin;
+  void *context;
+  PetscErrorCode ierr = PCShellGetContext(pc, &context);
+  CHKERRQ(ierr);
+  const auto *self = static_cast<const PreconditionGMG *>(context);
+
+  const PetscScalar *src_values;
+  ierr = VecGetArrayRead(src, &src_values);
+  CHKERRQ(ierr);
+  for (unsigned int k = 0; k < self->petsc_to_mg.size(); ++k)
+    {
+      self->src_buffer.local_element(self->petsc_to_mg[k]) = src_values[k];
+    }
+  ierr = VecRestoreArrayRead(src, &src_values);
+  CHKERRQ(ierr);
+
+  self->preconditioner->vmult(self->dst_buffer, self->src_buffer);
+
+  PetscScalar *dst_values;
+  ierr = VecGetArray(dst, &dst_values);
+  CHKERRQ(ierr);
+  for (unsigned int k = 0; k < self->petsc_to_mg.size(); ++k)
+    {
+      dst_values[k] = self->dst_buffer.local_element(self->petsc_to_mg[k]);
+    }
+  ierr = VecRestoreArray(dst, &dst_values);
+  CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+template class MultigridLevelOperator<2, 1>;
+template class MultigridLevelOperator<2, 2>;
+template class MultigridLevelOperator<3, 1>;
+template class MultigridLevelOperator<3, 3>;
+template class PreconditionGMG<2, 1>;
+template class PreconditionGMG<2, 2>;
+template class PreconditionGMG<3, 1>;
+template class PreconditionGMG<3, 3>;
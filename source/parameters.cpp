@@ -18,6 +18,10 @@ namespace Parameters
                         "",
                         Patterns::List(dealii::Patterns::Integer()),
                         "Level of global refinements");
+      prm.declare_entry("Mesh cache",
+                        "",
+                        Patterns::Anything(),
+                        "Directory to cache the globally refined meshes in");
       prm.declare_entry("End time", "1.0", Patterns::Double(0.0), "End time");
       prm.declare_entry(
         "Time step size", "1.0", Patterns::Double(0.0), "Time step size");
@@ -27,13 +31,133 @@ namespace Parameters
                         "1.0",
                         Patterns::Double(0.0),
                         "Refinement interval");
+      prm.declare_entry("Refinement indicator",
+                        "Kelly",
+                        Patterns::Selection("Kelly|Vorticity"),
+                        "Error indicator of the adaptive fluid refinement");
+      prm.declare_entry("Refinement fraction",
+                        "0.6",
+                        Patterns::Double(0.0, 1.0),
+                        "Fraction of the estimated error to refine");
+      prm.declare_entry("Coarsening fraction",
+                        "0.4",
+                        Patterns::Double(0.0, 1.0),
+                        "Fraction of the estimated error to coarsen");
+      prm.declare_entry("Refinement levels",
+                        "3",
+                        Patterns::Integer(0),
+                        "Levels of refinement above the global refinement");
+      prm.declare_entry("Target fluid cells",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of fluid cells to refine up to, 0 for none");
       prm.declare_entry(
         "Save interval", "1.0", Patterns::Double(0.0), "Save interval");
+      prm.declare_entry("Steady state tolerance",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Relative rate of change to stop the run at");
+      prm.declare_entry("Steady state steps",
+                        "10",
+                        Patterns::Integer(1),
+                        "Consecutive steady steps to stop the run after");
+      prm.declare_entry("Asynchronous checkpoints",
+                        "false",
+                        Patterns::Bool(),
+                        "Write the checkpoint files on a background thread");
+      prm.declare_entry("Buddy checkpoint interval",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Interval of the node-local checkpoints, 0 for none");
+      prm.declare_entry("Buddy checkpoint directory",
+                        "/dev/shm/openifem",
+                        Patterns::Anything(),
+                        "Node-local directory of the buddy checkpoints");
+      prm.declare_entry("Output queue depth",
+                        "0",
+                        Patterns::Integer(0),
+                        "VTU outputs pending on the writer thread, 0 for none");
+      prm.declare_entry("Output format",
+                        "VTU",
+                        Patterns::Selection("VTU|HDF5"),
+                        "VTU files per rank or collective HDF5 with XDMF");
+      prm.declare_entry("Write mesh once",
+                        "true",
+                        Patterns::Bool(),
+                        "Write the HDF5 mesh only when it changes");
+      prm.declare_entry("Output fields",
+                        "",
+                        Patterns::List(Patterns::Anything()),
+                        "Fields to write, all of them if empty");
+      prm.declare_entry("Stress output interval",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Output interval of the stress and strain");
+      prm.declare_entry("Output box",
+                        "",
+                        Patterns::List(Patterns::Double()),
+                        "Corners of the box the output is clipped to");
+      prm.declare_entry("Output material ids",
+                        "",
+                        Patterns::List(Patterns::Integer(0)),
+                        "Material ids the output is clipped to");
+      prm.declare_entry("Output compression",
+                        "Default",
+                        Patterns::Selection(
+                          "None|Best speed|Default|Best compression"),
+                        "Compression level of the VTU output");
       prm.declare_entry(
         "Gravity",
         "",
         Patterns::List(dealii::Patterns::Double()),
         "Gravity acceleration that applies to both fluid and solid");
+      prm.declare_entry("DoF renumbering",
+                        "Cuthill-McKee",
+                        Patterns::Selection(
+                          "None|Cuthill-McKee|Hierarchical|Hilbert"),
+                        "Renumbering of the dofs of all the solvers");
+      prm.declare_entry("Adaptive time step",
+                        "false",
+                        Patterns::Bool(),
+                        "Choose the time step size from the CFL number");
+      prm.declare_entry(
+        "Target CFL", "1.0", Patterns::Double(0.0), "Target CFL number");
+      prm.declare_entry("Time step growth",
+                        "1.2",
+                        Patterns::Double(1.0),
+                        "Largest ratio between successive time steps");
+      prm.declare_entry("Time step shrink",
+                        "0.5",
+                        Patterns::Double(0.0, 1.0),
+                        "Smallest ratio between successive time steps");
+      prm.declare_entry("Minimum time step size",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Minimum adaptive time step size");
+      prm.declare_entry("Maximum time step size",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Maximum adaptive time step size, 0 for unlimited");
+      prm.declare_entry("Target Newton iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Newton iterations above which the step shrinks");
+      prm.declare_entry("Timing report",
+                        "false",
+                        Patterns::Bool(),
+                        "Write the timer sections over the ranks to files");
+      prm.declare_entry("Memory report",
+                        "false",
+                        Patterns::Bool(),
+                        "Print the memory of the solver components");
+      prm.declare_entry("Solver log",
+                        "false",
+                        Patterns::Bool(),
+                        "Write the solver statistics of every step to files");
+      prm.declare_entry("Trace",
+                        "false",
+                        Patterns::Bool(),
+                        "Write the solver phases of every rank to trace.json");
     }
     prm.leave_subsection();
   }
@@ -50,16 +174,59 @@ namespace Parameters
       global_refinements = Utilities::string_to_int(parsed_input);
       AssertThrow(static_cast<int>(global_refinements.size()) == 2,
                   ExcMessage("Incorrect dimension of global_refinements!"));
+      mesh_cache = prm.get("Mesh cache");
       end_time = prm.get_double("End time");
       time_step = prm.get_double("Time step size");
       output_interval = prm.get_double("Output interval");
       refinement_interval = prm.get_double("Refinement interval");
+      refinement_indicator = prm.get("Refinement indicator");
+      refinement_fraction = prm.get_double("Refinement fraction");
+      coarsening_fraction = prm.get_double("Coarsening fraction");
+      AssertThrow(refinement_fraction + coarsening_fraction <= 1,
+                  ExcMessage("Refinement and coarsening fractions above 1!"));
+      refinement_levels = prm.get_integer("Refinement levels");
+      target_fluid_cells = prm.get_integer("Target fluid cells");
       save_interval = prm.get_double("Save interval");
+      steady_state_tolerance = prm.get_double("Steady state tolerance");
+      steady_state_steps = prm.get_integer("Steady state steps");
+      async_checkpoint = prm.get_bool("Asynchronous checkpoints");
+      buddy_checkpoint_interval = prm.get_double("Buddy checkpoint interval");
+      buddy_checkpoint_directory = prm.get("Buddy checkpoint directory");
+      output_queue_depth = prm.get_integer("Output queue depth");
+      output_format = prm.get("Output format");
+      output_mesh_once = prm.get_bool("Write mesh once");
+      output_fields = Utilities::split_string_list(prm.get("Output fields"));
+      stress_output_interval = prm.get_double("Stress output interval");
+      AssertThrow(stress_output_interval == 0 ||
+                    stress_output_interval >= output_interval,
+                  ExcMessage("Stress output interval below Output interval!"));
+      output_box = Utilities::string_to_double(
+        Utilities::split_string_list(prm.get("Output box")));
+      AssertThrow(output_box.empty() ||
+                    static_cast<int>(output_box.size()) == 2 * dimension,
+                  ExcMessage("Inconsistent dimension of the output box!"));
+      output_material_ids = Utilities::string_to_int(
+        Utilities::split_string_list(prm.get("Output material ids")));
+      output_compression = prm.get("Output compression");
       raw_input = prm.get("Gravity");
       parsed_input = Utilities::split_string_list(raw_input);
       gravity = Utilities::string_to_double(parsed_input);
       AssertThrow(static_cast<int>(gravity.size()) == dimension,
                   ExcMessage("Inconsistent dimension of gravity!"));
+      dof_renumbering = prm.get("DoF renumbering");
+      adaptive_time_step = prm.get_bool("Adaptive time step");
+      target_cfl = prm.get_double("Target CFL");
+      time_step_growth = prm.get_double("Time step growth");
+      time_step_shrink = prm.get_double("Time step shrink");
+      min_time_step = prm.get_double("Minimum time step size");
+      max_time_step = prm.get_double("Maximum time step size");
+      target_newton_iterations = prm.get_integer("Target Newton iterations");
+      timing_report = prm.get_bool("Timing report");
+      memory_report = prm.get_bool("Memory report");
+      solver_log = prm.get_bool("Solver log");
+      trace = prm.get_bool("Trace");
+      AssertThrow(!adaptive_time_step || target_cfl > 0,
+                  ExcMessage("Target CFL must be positive!"));
     }
     prm.leave_subsection();
   }
@@ -131,6 +298,91 @@ namespace Parameters
         "1e-10",
         Patterns::Double(0.0),
         "The absolute tolerance of the nonlinear system residual");
+      prm.declare_entry("Matrix-free operator",
+                        "false",
+                        Patterns::Bool(),
+                        "Apply the linearized system operator cell by cell "
+                        "in the Krylov solver");
+      prm.declare_entry("Velocity block tolerance",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Relative tolerance of the GMRES preconditioned by "
+                        "the velocity block preconditioner of InsIM, 0 means "
+                        "a single application");
+      prm.declare_entry("Preconditioner max age",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of linear solves the block preconditioner is "
+                        "reused for, 1 means rebuilding it for every solve");
+      prm.declare_entry("Preconditioner max iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of Krylov iterations above which a reused "
+                        "preconditioner is rebuilt, 0 means no limit");
+      prm.declare_entry("Preconditioner rebuild threshold",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Relative change of the norm of the velocity block "
+                        "above which a reused preconditioner is rebuilt, 0 "
+                        "means no limit");
+      prm.declare_entry("Cache cell FE data",
+                        "false",
+                        Patterns::Bool(),
+                        "Cache the JxW values and shape function gradients "
+                        "of the fluid cells between refinements");
+      prm.declare_entry("Forcing term",
+                        "Constant",
+                        Patterns::Selection("Constant|Eisenstat-Walker"),
+                        "Relative tolerance of the linear solves in the "
+                        "Newton iterations of the parallel implicit solvers");
+      prm.declare_entry("Minimum forcing term",
+                        "1e-6",
+                        Patterns::Double(0.0, 1.0),
+                        "Lower bound of the Eisenstat-Walker forcing term");
+      prm.declare_entry("Maximum forcing term",
+                        "0.9",
+                        Patterns::Double(0.0, 1.0),
+                        "Upper bound of the Eisenstat-Walker forcing term");
+      prm.declare_entry("Single precision preconditioner",
+                        "false",
+                        Patterns::Bool(),
+                        "Store and apply the ILU factors and the inner Schur "
+                        "complement solve of the serial SCnsIM "
+                        "preconditioner in single precision");
+      prm.declare_entry("Solution predictor order",
+                        "0",
+                        Patterns::Integer(0, 2),
+                        "Order of the extrapolation of the initial guess "
+                        "from the previous time steps, 0 to disable");
+      prm.declare_entry("Time integration",
+                        "Backward Euler",
+                        Patterns::Selection("Backward Euler|BDF2"),
+                        "Time discretization of the implicit InsIM and "
+                        "SCnsIM solvers");
+      prm.declare_entry("Reduced order",
+                        "None",
+                        Patterns::Selection("None|Offline|Online"),
+                        "Collect the solutions of the serial SCnsIM into a "
+                        "POD basis, or solve in the space of the basis");
+      prm.declare_entry("Reduced basis file",
+                        "pod_basis.bin",
+                        Patterns::Anything(),
+                        "File the POD basis is saved to and loaded from");
+      prm.declare_entry("Reduced basis size",
+                        "20",
+                        Patterns::Integer(1),
+                        "Maximum number of POD modes");
+      prm.declare_entry("Reduced basis energy",
+                        "0.9999",
+                        Patterns::Double(0.0, 1.0),
+                        "Fraction of the energy of the snapshots the POD "
+                        "modes hold");
+      prm.declare_entry("Reduced order tolerance",
+                        "1e-2",
+                        Patterns::Double(0.0),
+                        "Full residual of a reduced step relative to the one "
+                        "at its start, above which the step is redone by the "
+                        "full solver");
     }
     prm.leave_subsection();
   }
@@ -142,6 +394,27 @@ namespace Parameters
       grad_div = prm.get_double("Grad-Div stabilization");
       fluid_max_iterations = prm.get_integer("Max Newton iterations");
       fluid_tolerance = prm.get_double("Nonlinear system tolerance");
+      fluid_matrix_free = prm.get_bool("Matrix-free operator");
+      velocity_block_tolerance = prm.get_double("Velocity block tolerance");
+      preconditioner_max_age = prm.get_integer("Preconditioner max age");
+      preconditioner_max_iterations =
+        prm.get_integer("Preconditioner max iterations");
+      preconditioner_rebuild_threshold =
+        prm.get_double("Preconditioner rebuild threshold");
+      fluid_cache_fe_data = prm.get_bool("Cache cell FE data");
+      fluid_forcing_term = prm.get("Forcing term");
+      fluid_min_forcing_term = prm.get_double("Minimum forcing term");
+      fluid_max_forcing_term = prm.get_double("Maximum forcing term");
+      fluid_single_precision = prm.get_bool("Single precision preconditioner");
+      fluid_predictor_order = prm.get_integer("Solution predictor order");
+      fluid_time_integration = prm.get("Time integration");
+      fluid_reduced_order = prm.get("Reduced order");
+      fluid_reduced_basis = prm.get("Reduced basis file");
+      fluid_reduced_modes = prm.get_integer("Reduced basis size");
+      fluid_reduced_energy = prm.get_double("Reduced basis energy");
+      fluid_reduced_tolerance = prm.get_double("Reduced order tolerance");
+      AssertThrow(fluid_min_forcing_term <= fluid_max_forcing_term,
+                  ExcMessage("Inconsistent bounds of the forcing term!"));
     }
     prm.leave_subsection();
   }
@@ -398,6 +671,60 @@ namespace Parameters
                         "1e-10",
                         Patterns::Double(0.0),
                         "The tolerance of the force equilibrium");
+      prm.declare_entry("Preconditioner max age",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of linear solves the solid preconditioner is "
+                        "reused for, 1 means rebuilding it for every solve");
+      prm.declare_entry("Preconditioner max iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of CG iterations above which a reused solid "
+                        "preconditioner is rebuilt, 0 means no limit");
+      prm.declare_entry("Preconditioner rebuild threshold",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Relative change of the norm of the matrix above "
+                        "which a reused solid preconditioner is rebuilt, 0 "
+                        "means no limit");
+      prm.declare_entry("Factorize linear elastic system",
+                        "true",
+                        Patterns::Bool(),
+                        "Factorize the system matrix of the linear elastic "
+                        "solvers once and reuse it while the time step size "
+                        "and the mesh do not change");
+      prm.declare_entry("Newton method",
+                        "Full",
+                        Patterns::Selection("Full|Modified"),
+                        "Reassemble the tangent at every Newton iteration of "
+                        "the hyperelastic solvers, or reuse it");
+      prm.declare_entry("Tangent max age",
+                        "5",
+                        Patterns::Integer(1),
+                        "Number of Newton iterations, counted across time "
+                        "steps, a tangent is reused for in the modified "
+                        "Newton method");
+      prm.declare_entry("Line search steps",
+                        "0",
+                        Patterns::Integer(0),
+                        "Maximum number of halvings of a Newton step in the "
+                        "backtracking line search, 0 disables it");
+      prm.declare_entry("Stress recovery",
+                        "Averaging",
+                        Patterns::Selection("Averaging|Lumped projection"),
+                        "How the nodal strain and stress of the parallel "
+                        "shared memory solid solvers are recovered from "
+                        "the quadrature points");
+      prm.declare_entry("Time integrator",
+                        "Newmark",
+                        Patterns::Selection("Newmark|Central difference"),
+                        "Implicit Newmark-beta, or explicit central "
+                        "difference with a lumped mass matrix");
+      prm.declare_entry("Tangent",
+                        "Assembled",
+                        Patterns::Selection("Assembled|Matrix-free"),
+                        "Assemble the Newton tangent of the parallel "
+                        "hyperelastic solver, or apply it cell by cell");
     }
     prm.leave_subsection();
   }
@@ -410,6 +737,20 @@ namespace Parameters
       solid_max_iterations = prm.get_integer("Max Newton iterations");
       tol_d = prm.get_double("Displacement tolerance");
       tol_f = prm.get_double("Force tolerance");
+      solid_preconditioner_max_age =
+        prm.get_integer("Preconditioner max age");
+      solid_preconditioner_max_iterations =
+        prm.get_integer("Preconditioner max iterations");
+      solid_preconditioner_rebuild_threshold =
+        prm.get_double("Preconditioner rebuild threshold");
+      solid_factorize_linear_system =
+        prm.get_bool("Factorize linear elastic system");
+      solid_newton_method = prm.get("Newton method");
+      solid_tangent_max_age = prm.get_integer("Tangent max age");
+      solid_line_search_steps = prm.get_integer("Line search steps");
+      solid_stress_recovery = prm.get("Stress recovery");
+      solid_time_integrator = prm.get("Time integrator");
+      solid_tangent = prm.get("Tangent");
     }
     prm.leave_subsection();
   }
@@ -479,6 +820,10 @@ namespace Parameters
                         "",
                         Patterns::List(dealii::Patterns::Double()),
                         "Neumann boundary values");
+      prm.declare_entry("Neumann boundary table",
+                        "",
+                        Patterns::Anything(),
+                        "Binary table of time-varying Neumann values");
     }
     prm.leave_subsection();
   }
@@ -513,15 +858,286 @@ namespace Parameters
             }
           solid_neumann_bcs[ids[i]] = value;
         }
+      solid_neumann_table = prm.get("Neumann boundary table");
+    }
+    prm.leave_subsection();
+  }
+
+  void FSISolver::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("FSI solver control");
+    {
+      prm.declare_entry(
+        "Transfer rebuild distance",
+        "0.0",
+        Patterns::Double(0.0),
+        "The solid displacement since the last build of the solid-to-fluid "
+        "transfer operator, beyond which the operator is rebuilt");
+      prm.declare_entry("Narrow band indicator",
+                        "false",
+                        Patterns::Bool(),
+                        "Only re-classify the fluid cells around the solid "
+                        "when updating the indicator field");
+      prm.declare_entry("Solid Eulerian mapping",
+                        "false",
+                        Patterns::Bool(),
+                        "Evaluate the deformed solid geometry through an "
+                        "Eulerian mapping instead of moving its vertices");
+      prm.declare_entry("Node shared solid geometry",
+                        "false",
+                        Patterns::Bool(),
+                        "Store the deformed solid vertices of the Eulerian "
+                        "mapping once per node in shared memory");
+      prm.declare_entry("Solid group size",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of consecutive ranks of every group that "
+                        "solves the solid, 0 means all the ranks");
+      prm.declare_entry("Concurrent solid processes",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of first ranks that solve the solid at the "
+                        "same time as the other ranks solve the fluid, 0 "
+                        "means all the ranks solve both one after the other");
+      prm.declare_entry("Solid substeps",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of solid time steps within one fluid time "
+                        "step, the fluid traction is held during them");
+      prm.declare_entry("Traction evaluation",
+                        "Vertices",
+                        Patterns::Selection("Vertices|Quadrature points"),
+                        "Evaluate the fluid stress on the solid at the "
+                        "boundary vertices, or at the quadrature points of "
+                        "the boundary faces and lump it to the vertices");
+      prm.declare_entry("Coupling iterations",
+                        "1",
+                        Patterns::Integer(1),
+                        "Maximum number of strongly coupled iterations in "
+                        "every time step, 1 means the staggered scheme");
+      prm.declare_entry("Coupling tolerance",
+                        "1e-6",
+                        Patterns::Double(0.0),
+                        "Relative change of the interface stress below which "
+                        "the coupling iterations are converged");
+      prm.declare_entry("Initial relaxation",
+                        "0.5",
+                        Patterns::Double(0.0, 1.0),
+                        "Relaxation factor of the first Aitken iteration");
+      prm.declare_entry("Repartition interval",
+                        "1e10",
+                        Patterns::Double(0.0),
+                        "Interval of repartitioning the fluid mesh with the "
+                        "coupling cost of the artificial fluid cells");
+      prm.declare_entry("Artificial cell weight",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Extra cost of an artificial fluid cell relative to a "
+                        "plain fluid cell, 0 means measured from the timings");
+    }
+    prm.leave_subsection();
+  }
+
+  void FSISolver::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("FSI solver control");
+    {
+      transfer_rebuild_distance = prm.get_double("Transfer rebuild distance");
+      narrow_band_indicator = prm.get_bool("Narrow band indicator");
+      solid_eulerian_mapping = prm.get_bool("Solid Eulerian mapping");
+      node_shared_solid_geometry = prm.get_bool("Node shared solid geometry");
+      solid_group_size = prm.get_integer("Solid group size");
+      concurrent_solid_processes =
+        prm.get_integer("Concurrent solid processes");
+      solid_substeps = prm.get_integer("Solid substeps");
+      traction_evaluation = prm.get("Traction evaluation");
+      coupling_iterations = prm.get_integer("Coupling iterations");
+      coupling_tolerance = prm.get_double("Coupling tolerance");
+      initial_relaxation = prm.get_double("Initial relaxation");
+      repartition_interval = prm.get_double("Repartition interval");
+      artificial_cell_weight = prm.get_double("Artificial cell weight");
+    }
+    prm.leave_subsection();
+  }
+
+  void PreconditionerSettings::declareParameters(
+    ParameterHandler &prm,
+    const std::string &subsection,
+    const std::string &default_type,
+    const std::string &types)
+  {
+    prm.enter_subsection(subsection);
+    {
+      prm.declare_entry(
+        "Type", default_type, Patterns::Selection(types), "Preconditioner");
+      prm.declare_entry("ILU levels",
+                        "1",
+                        Patterns::Integer(0),
+                        "Fill levels of the parallel ILU(k) of Euclid");
+      prm.declare_entry("AMG strong threshold",
+                        "0",
+                        Patterns::Double(0.0, 1.0),
+                        "Strength of connection threshold of BoomerAMG, 0 "
+                        "chooses 0.25 in 2D and 0.5 in 3D");
+      prm.declare_entry("AMG aggregation threshold",
+                        "1e-4",
+                        Patterns::Double(0.0),
+                        "Aggregation threshold of ML and MueLu");
+      prm.declare_entry("Pilut max iterations",
+                        "20",
+                        Patterns::Integer(1),
+                        "Maximum number of iterations of Pilut");
+      prm.declare_entry("Pilut row size",
+                        "20",
+                        Patterns::Integer(1),
+                        "Maximum number of nonzeros per row of the Pilut "
+                        "factors");
+      prm.declare_entry("Pilut tolerance",
+                        "1e-4",
+                        Patterns::Double(0.0),
+                        "Drop tolerance of Pilut");
+      prm.declare_entry("GMG smoothing degree",
+                        "5",
+                        Patterns::Integer(1),
+                        "Degree of the Chebyshev smoother on the levels of "
+                        "the geometric multigrid");
+    }
+    prm.leave_subsection();
+  }
+
+  void PreconditionerSettings::parseParameters(ParameterHandler &prm,
+                                               const std::string &subsection)
+  {
+    prm.enter_subsection(subsection);
+    {
+      type = prm.get("Type");
+      ilu_levels = prm.get_integer("ILU levels");
+      amg_strong_threshold = prm.get_double("AMG strong threshold");
+      amg_aggregation_threshold = prm.get_double("AMG aggregation threshold");
+      pilut_max_iterations = prm.get_integer("Pilut max iterations");
+      pilut_row_size = prm.get_integer("Pilut row size");
+      pilut_tolerance = prm.get_double("Pilut tolerance");
+      gmg_smoothing_degree = prm.get_integer("GMG smoothing degree");
+    }
+    prm.leave_subsection();
+  }
+
+  void Preconditioners::declareParameters(ParameterHandler &prm)
+  {
+    const std::string types =
+      "None|Jacobi|Block Jacobi|Pilut|Euclid|AMG|ML|MueLu|MUMPS";
+    prm.enter_subsection("Preconditioners");
+    {
+      PreconditionerSettings::declareParameters(
+        prm, "Solid", "None", types + "|Direct");
+      PreconditionerSettings::declareParameters(
+        prm, "Velocity block", "MUMPS", types + "|GMG");
+      PreconditionerSettings::declareParameters(
+        prm, "IMEX velocity block", "None", types);
+      PreconditionerSettings::declareParameters(
+        prm, "SCnsIM velocity block", "Euclid", types);
+      PreconditionerSettings::declareParameters(
+        prm, "SCnsIM pressure block", "Euclid", types);
+      PreconditionerSettings::declareParameters(
+        prm, "Pressure Schur", "None", types + "|GMG");
+      PreconditionerSettings::declareParameters(
+        prm, "Solid tangent", "AMG", types);
+    }
+    prm.leave_subsection();
+  }
+
+  void Preconditioners::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Preconditioners");
+    {
+      solid_preconditioner.parseParameters(prm, "Solid");
+      velocity_block_preconditioner.parseParameters(prm, "Velocity block");
+      imex_velocity_block_preconditioner.parseParameters(
+        prm, "IMEX velocity block");
+      scnsim_velocity_block_preconditioner.parseParameters(
+        prm, "SCnsIM velocity block");
+      scnsim_pressure_block_preconditioner.parseParameters(
+        prm, "SCnsIM pressure block");
+      pressure_schur_preconditioner.parseParameters(prm, "Pressure Schur");
+      solid_tangent_preconditioner.parseParameters(prm, "Solid tangent");
+    }
+    prm.leave_subsection();
+  }
+
+  void Monitors::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Monitors");
+    {
+      prm.declare_entry("Monitor interval",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Interval of the monitors, 0 means every time step");
+      prm.declare_entry("Fluid probes",
+                        "",
+                        Patterns::List(Patterns::Double()),
+                        "Coordinates of the points where the fluid velocity "
+                        "and pressure are monitored");
+      prm.declare_entry("Fluid boundaries",
+                        "",
+                        Patterns::List(Patterns::Integer(0)),
+                        "Boundary ids whose fluid force and flux are "
+                        "monitored");
+      prm.declare_entry("Solid probes",
+                        "",
+                        Patterns::List(Patterns::Double()),
+                        "Coordinates of the points in the reference "
+                        "configuration where the solid displacement is "
+                        "monitored");
+    }
+    prm.leave_subsection();
+  }
+
+  void Monitors::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Monitors");
+    {
+      monitor_interval = prm.get_double("Monitor interval");
+      fluid_probes = Utilities::string_to_double(
+        Utilities::split_string_list(prm.get("Fluid probes")));
+      fluid_monitor_boundaries = Utilities::string_to_int(
+        Utilities::split_string_list(prm.get("Fluid boundaries")));
+      solid_probes = Utilities::string_to_double(
+        Utilities::split_string_list(prm.get("Solid probes")));
+      AssertThrow(fluid_probes.size() % monitor_dim == 0 &&
+                    solid_probes.size() % monitor_dim == 0,
+                  ExcMessage("Inconsistent dimension of the probes!"));
     }
     prm.leave_subsection();
   }
 
-  AllParameters::AllParameters(const std::string &infile)
+  AllParameters::AllParameters(const std::string &infile,
+                               const std::vector<std::string> &overrides)
   {
     ParameterHandler prm;
     declareParameters(prm);
     prm.parse_input(infile);
+    for (const auto &entry : overrides)
+      {
+        const auto equal = entry.find('=');
+        AssertThrow(equal != std::string::npos,
+                    ExcMessage("Override \"" + entry +
+                               "\" is not of the form Subsection/Entry = "
+                               "value!"));
+        const auto path = Utilities::split_string_list(
+          Utilities::trim(entry.substr(0, equal)), '/');
+        AssertThrow(path.size() > 1,
+                    ExcMessage("Override \"" + entry +
+                               "\" does not name a subsection!"));
+        for (unsigned int i = 0; i + 1 < path.size(); ++i)
+          {
+            prm.enter_subsection(path[i]);
+          }
+        prm.set(path.back(), Utilities::trim(entry.substr(equal + 1)));
+        for (unsigned int i = 0; i + 1 < path.size(); ++i)
+          {
+            prm.leave_subsection();
+          }
+      }
     parseParameters(prm);
   }
 
@@ -538,6 +1154,9 @@ namespace Parameters
     SolidSolver::declareParameters(prm);
     SolidDirichlet::declareParameters(prm);
     SolidNeumann::declareParameters(prm);
+    FSISolver::declareParameters(prm);
+    Preconditioners::declareParameters(prm);
+    Monitors::declareParameters(prm);
   }
 
   void AllParameters::parseParameters(ParameterHandler &prm)
@@ -555,5 +1174,9 @@ namespace Parameters
     // Set the dummy member in Solid Neumann BCs subsection
     solid_neumann_bc_dim = dimension;
     SolidNeumann::parseParameters(prm);
+    FSISolver::parseParameters(prm);
+    Preconditioners::parseParameters(prm);
+    monitor_dim = dimension;
+    Monitors::parseParameters(prm);
   }
 } // namespace Parameters
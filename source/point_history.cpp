@@ -0,0 +1,145 @@
+#include "point_history.h"
+
+#include <algorithm>
+
+namespace Internal
+{
+  using namespace dealii;
+
+  template <int dim, typename MaterialType>
+  void HyperElasticPointHistory<dim, MaterialType>::initialize(
+    const Triangulation<dim> &triangulation,
+    const Parameters::AllParameters &parameters,
+    const unsigned int n_q_points,
+    const types::subdomain_id subdomain)
+  {
+    AssertThrow(parameters.solid_type == "NeoHookean", ExcNotImplemented());
+    materials.clear();
+    densities.clear();
+    kappas.clear();
+    for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
+      {
+        Assert(parameters.C[i].size() >= 2, ExcInternalError());
+        materials.emplace_back(
+          parameters.C[i][0], parameters.C[i][1], parameters.solid_rho);
+        densities.push_back(materials.back().get_density());
+        kappas.push_back(materials.back().get_d2Psi_vol_dJ2());
+      }
+    AssertThrow(materials.size() <= 256,
+                ExcMessage("Too many solid parts for the point history!"));
+
+    cell_first_point.assign(triangulation.n_active_cells(),
+                            numbers::invalid_unsigned_int);
+    point_part.clear();
+    unsigned int n_points = 0;
+    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
+         ++cell)
+      {
+        if (!cell->is_locally_owned() ||
+            (subdomain != numbers::invalid_subdomain_id &&
+             cell->subdomain_id() != subdomain))
+          {
+            continue;
+          }
+        unsigned int mat_id = cell->material_id();
+        if (parameters.n_solid_parts == 1)
+          mat_id = 1;
+        Assert(mat_id >= 1 && mat_id <= materials.size(), ExcInternalError());
+        cell_first_point[cell->active_cell_index()] = n_points;
+        point_part.insert(point_part.end(), n_q_points, mat_id - 1);
+        n_points += n_q_points;
+      }
+
+    F_inv.resize(n_points);
+    tau.resize(n_points);
+    Jc.resize(n_points);
+    det_F.resize(n_points);
+    dPsi_vol_dJ.resize(n_points);
+    for (unsigned int point = 0; point < n_points; ++point)
+      {
+        update(point, Tensor<2, dim>());
+      }
+  }
+
+  template <int dim, typename MaterialType>
+  void HyperElasticPointHistory<dim, MaterialType>::update(
+    const unsigned int point, const Tensor<2, dim> &Grad_u)
+  {
+    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
+    materials[point_part[point]].evaluate(
+      F, det_F[point], dPsi_vol_dJ[point], tau[point], Jc[point]);
+    Assert(det_F[point] > 0, ExcInternalError());
+    F_inv[point] = invert(F);
+  }
+
+  template <int dim, typename MaterialType>
+  void HyperElasticPointHistory<dim, MaterialType>::update(
+    const unsigned int first, const std::vector<Tensor<2, dim>> &Grad_u)
+  {
+    const unsigned int width = VectorizedArray<double>::size();
+    const unsigned int n_points = Grad_u.size();
+    Assert(first + n_points <= det_F.size(), ExcInternalError());
+    if (n_points == 0)
+      {
+        return;
+      }
+    // All the points of a cell belong to the same part.
+    const MaterialType &material = materials[point_part[first]];
+
+    Tensor<2, dim, VectorizedArray<double>> F;
+    VectorizedArray<double> J, p;
+    SymmetricTensor<2, dim, VectorizedArray<double>> batch_tau;
+    SymmetricTensor<4, dim, VectorizedArray<double>> batch_Jc;
+    for (unsigned int start = 0; start < n_points; start += width)
+      {
+        const unsigned int n_lanes = std::min(width, n_points - start);
+        // The unused lanes are padded with the last point of the batch.
+        for (unsigned int v = 0; v < width; ++v)
+          {
+            const Tensor<2, dim> F_v = Physics::Elasticity::Kinematics::F(
+              Grad_u[start + std::min(v, n_lanes - 1)]);
+            for (unsigned int i = 0; i < dim; ++i)
+              for (unsigned int j = 0; j < dim; ++j)
+                F[i][j][v] = F_v[i][j];
+          }
+        material.evaluate(F, J, p, batch_tau, batch_Jc);
+        const Tensor<2, dim, VectorizedArray<double>> batch_F_inv = invert(F);
+
+        for (unsigned int v = 0; v < n_lanes; ++v)
+          {
+            const unsigned int point = first + start + v;
+            Assert(J[v] > 0, ExcInternalError());
+            det_F[point] = J[v];
+            dPsi_vol_dJ[point] = p[v];
+            for (unsigned int i = 0; i < dim; ++i)
+              for (unsigned int j = 0; j < dim; ++j)
+                {
+                  F_inv[point][i][j] = batch_F_inv[i][j][v];
+                  if (j < i)
+                    continue;
+                  tau[point][i][j] = batch_tau[i][j][v];
+                  for (unsigned int k = 0; k < dim; ++k)
+                    for (unsigned int l = k; l < dim; ++l)
+                      Jc[point][i][j][k][l] = batch_Jc[i][j][k][l][v];
+                }
+          }
+      }
+  }
+
+  template <int dim, typename MaterialType>
+  std::size_t
+  HyperElasticPointHistory<dim, MaterialType>::memory_consumption() const
+  {
+    return MemoryConsumption::memory_consumption(cell_first_point) +
+           MemoryConsumption::memory_consumption(point_part) +
+           MemoryConsumption::memory_consumption(F_inv) +
+           MemoryConsumption::memory_consumption(tau) +
+           MemoryConsumption::memory_consumption(Jc) +
+           MemoryConsumption::memory_consumption(det_F) +
+           MemoryConsumption::memory_consumption(dPsi_vol_dJ) +
+           materials.capacity() * sizeof(MaterialType);
+  }
+
+  template class HyperElasticPointHistory<2>;
+  template class HyperElasticPointHistory<3>;
+} // namespace Internal
@@ -196,12 +196,14 @@ void PreconditionPilut::initialize(const PETScWrappers::MatrixBase &matrix_,
 
 /* ----------------- PreconditionEuclid ------------------------ */
 
-PreconditionEuclid::PreconditionEuclid(const PETScWrappers::MatrixBase &matrix)
+PreconditionEuclid::PreconditionEuclid(const PETScWrappers::MatrixBase &matrix,
+                                       const unsigned int levels)
 {
-  initialize(matrix);
+  initialize(matrix, levels);
 }
 
-void PreconditionEuclid::initialize(const PETScWrappers::MatrixBase &matrix_)
+void PreconditionEuclid::initialize(const PETScWrappers::MatrixBase &matrix_,
+                                    const unsigned int levels)
 {
   clear();
 
@@ -220,6 +222,9 @@ void PreconditionEuclid::initialize(const PETScWrappers::MatrixBase &matrix_)
 
   ierr = PCHYPRESetType_Euclid(pc);
 
+  PETScWrappers::set_option_value("-pc_hypre_euclid_levels",
+                                  Utilities::to_string(levels));
+
   ierr = PCSetFromOptions(pc);
   AssertThrow(ierr == 0, ExcPETScError(ierr));
 
@@ -227,4 +232,273 @@ void PreconditionEuclid::initialize(const PETScWrappers::MatrixBase &matrix_)
   AssertThrow(ierr == 0, ExcPETScError(ierr));
 }
 
-/* ----------------- PreconditionEuclid ------------------------ */
+/* ----------------- PreconditionMUMPS ------------------------ */
+
+PreconditionMUMPS::PreconditionMUMPS(const PETScWrappers::MatrixBase &matrix)
+{
+  initialize(matrix);
+}
+
+void PreconditionMUMPS::initialize(const PETScWrappers::MatrixBase &matrix_)
+{
+  clear();
+
+  matrix = static_cast<Mat>(matrix_);
+
+  MPI_Comm comm = matrix_.get_mpi_communicator();
+
+  PetscErrorCode ierr = PCCreate(comm, &pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetOperators(pc, matrix, matrix);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetType(pc, const_cast<char *>(PCLU));
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+#if DEAL_II_PETSC_VERSION_LT(3, 9, 0)
+  ierr = PCFactorSetMatSolverPackage(pc, MATSOLVERMUMPS);
+#else
+  ierr = PCFactorSetMatSolverType(pc, MATSOLVERMUMPS);
+#endif
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  // Otherwise PETSc refactorizes whenever the matrix is reassembled.
+  ierr = PCSetReusePreconditioner(pc, PETSC_TRUE);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+}
+
+#ifdef OPENIFEM_WITH_TRILINOS
+/* ----------------- PreconditionTrilinosAMG ------------------------ */
+
+PreconditionTrilinosAMG::AdditionalData::AdditionalData(
+  const bool muelu,
+  const bool elliptic,
+  const bool higher_order_elements,
+  const double aggregation_threshold)
+  : muelu(muelu),
+    elliptic(elliptic),
+    higher_order_elements(higher_order_elements),
+    aggregation_threshold(aggregation_threshold)
+{
+}
+
+PreconditionTrilinosAMG::PreconditionTrilinosAMG(
+  const PETScWrappers::MatrixBase &matrix,
+  const AdditionalData &additional_data)
+{
+  initialize(matrix, additional_data);
+}
+
+void PreconditionTrilinosAMG::initialize(
+  const PETScWrappers::MatrixBase &matrix_,
+  const AdditionalData &additional_data_)
+{
+  clear();
+
+  matrix = static_cast<Mat>(matrix_);
+  additional_data = additional_data_;
+
+  MPI_Comm comm = matrix_.get_mpi_communicator();
+
+  // Both the rows and the columns are partitioned contiguously, so the
+  // local entries of the vectors are in the same order in PETSc and Epetra.
+  PetscInt row_begin, row_end, column_begin, column_end;
+  PetscErrorCode ierr = MatGetOwnershipRange(matrix, &row_begin, &row_end);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  ierr = MatGetOwnershipRangeColumn(matrix, &column_begin, &column_end);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  IndexSet owned_rows(matrix_.m()), owned_columns(matrix_.n());
+  owned_rows.add_range(row_begin, row_end);
+  owned_columns.add_range(column_begin, column_end);
+
+  // Copy the locally owned rows, first the pattern, then the values.
+  TrilinosWrappers::SparsityPattern sparsity(
+    owned_rows, owned_columns, owned_rows, comm);
+  std::vector<types::global_dof_index> row_columns;
+  for (PetscInt row = row_begin; row < row_end; ++row)
+    {
+      PetscInt n_columns;
+      const PetscInt *columns;
+      ierr = MatGetRow(matrix, row, &n_columns, &columns, nullptr);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      row_columns.assign(columns, columns + n_columns);
+      sparsity.add_entries(row, row_columns.begin(), row_columns.end(), true);
+      ierr = MatRestoreRow(matrix, row, &n_columns, &columns, nullptr);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  sparsity.compress();
+  trilinos_matrix.reinit(sparsity);
+  for (PetscInt row = row_begin; row < row_end; ++row)
+    {
+      PetscInt n_columns;
+      const PetscInt *columns;
+      const PetscScalar *values;
+      ierr = MatGetRow(matrix, row, &n_columns, &columns, &values);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      row_columns.assign(columns, columns + n_columns);
+      trilinos_matrix.set(row, n_columns, row_columns.data(), values, false);
+      ierr = MatRestoreRow(matrix, row, &n_columns, &columns, &values);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  trilinos_matrix.compress(VectorOperation::insert);
+
+  if (additional_data.muelu)
+    {
+#ifdef DEAL_II_TRILINOS_WITH_MUELU
+      TrilinosWrappers::PreconditionAMGMueLu::AdditionalData data;
+      data.elliptic = additional_data.elliptic;
+      data.higher_order_elements = additional_data.higher_order_elements;
+      data.aggregation_threshold = additional_data.aggregation_threshold;
+      auto muelu = std::make_unique<TrilinosWrappers::PreconditionAMGMueLu>();
+      muelu->initialize(trilinos_matrix, data);
+      amg = std::move(muelu);
+#else
+      AssertThrow(false,
+                  ExcMessage("deal.II was configured without MueLu!"));
+#endif
+    }
+  else
+    {
+      TrilinosWrappers::PreconditionAMG::AdditionalData data;
+      data.elliptic = additional_data.elliptic;
+      data.higher_order_elements = additional_data.higher_order_elements;
+      data.aggregation_threshold = additional_data.aggregation_threshold;
+      auto ml = std::make_unique<TrilinosWrappers::PreconditionAMG>();
+      ml->initialize(trilinos_matrix, data);
+      amg = std::move(ml);
+    }
+
+  ierr = PCCreate(comm, &pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetOperators(pc, matrix, matrix);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetType(pc, const_cast<char *>(PCSHELL));
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCShellSetContext(pc, this);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCShellSetApply(pc, &PreconditionTrilinosAMG::apply);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+}
+
+std::size_t PreconditionTrilinosAMG::memory_consumption() const
+{
+  return trilinos_matrix.memory_consumption();
+}
+
+PetscErrorCode PreconditionTrilinosAMG::apply(PC pc, Vec src, Vec dst)
+{
+  PetscFunctionBegin;
+  void *context;
+  PetscErrorCode ierr = PCShellGetContext(pc, &context);
+  CHKERRQ(ierr);
+  const auto *self = static_cast<const PreconditionTrilinosAMG *>(context);
+
+  // The local entries are in the same order in PETSc and Epetra, so Epetra
+  // works on views of the PETSc arrays.
+  const PetscScalar *src_values;
+  ierr = VecGetArrayRead(src, &src_values);
+  CHKERRQ(ierr);
+  PetscScalar *dst_values;
+  ierr = VecGetArray(dst, &dst_values);
+  CHKERRQ(ierr);
+
+  Epetra_Operator &amg = self->amg->trilinos_operator();
+  Epetra_Vector epetra_src(
+    View, amg.OperatorRangeMap(), const_cast<PetscScalar *>(src_values));
+  Epetra_Vector epetra_dst(View, amg.OperatorDomainMap(), dst_values);
+  const int error = amg.ApplyInverse(epetra_src, epetra_dst);
+
+  ierr = VecRestoreArray(dst, &dst_values);
+  CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(src, &src_values);
+  CHKERRQ(ierr);
+  if (error != 0)
+    {
+      SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "Trilinos AMG failed");
+    }
+  PetscFunctionReturn(0);
+}
+#endif
+
+/* ----------------- make_preconditioner ------------------------ */
+
+std::unique_ptr<PETScWrappers::PreconditionerBase>
+make_preconditioner(const PETScWrappers::MatrixBase &matrix,
+                    const Parameters::PreconditionerSettings &settings,
+                    const unsigned int dim,
+                    const bool symmetric,
+                    const bool higher_order_elements)
+{
+  const std::string &type = settings.type;
+  if (type == "Jacobi")
+    {
+      return std::make_unique<PETScWrappers::PreconditionJacobi>(matrix);
+    }
+  if (type == "Block Jacobi")
+    {
+      return std::make_unique<PETScWrappers::PreconditionBlockJacobi>(matrix);
+    }
+  if (type == "Pilut")
+    {
+      return std::make_unique<PreconditionPilut>(
+        matrix,
+        PreconditionPilut::AdditionalData(settings.pilut_max_iterations,
+                                          settings.pilut_row_size,
+                                          settings.pilut_tolerance));
+    }
+  if (type == "Euclid")
+    {
+      return std::make_unique<PreconditionEuclid>(matrix, settings.ilu_levels);
+    }
+  if (type == "AMG")
+    {
+      PETScWrappers::PreconditionBoomerAMG::AdditionalData data;
+      data.symmetric_operator = symmetric;
+      // Stronger coupling threshold recommended for 3D elasticity.
+      data.strong_threshold = settings.amg_strong_threshold > 0
+                                ? settings.amg_strong_threshold
+                                : (dim == 3 ? 0.5 : 0.25);
+      return std::make_unique<PETScWrappers::PreconditionBoomerAMG>(matrix,
+                                                                     data);
+    }
+  if (type == "ML" || type == "MueLu")
+    {
+#ifdef OPENIFEM_WITH_TRILINOS
+      // A nonsymmetric operator is not elliptic either, which selects ILU
+      // smoothers.
+      return std::make_unique<PreconditionTrilinosAMG>(
+        matrix,
+        PreconditionTrilinosAMG::AdditionalData(
+          type == "MueLu",
+          symmetric,
+          higher_order_elements,
+          settings.amg_aggregation_threshold));
+#else
+      (void)higher_order_elements;
+      AssertThrow(false,
+                  ExcMessage("The Trilinos preconditioners require "
+                             "OPENIFEM_WITH_TRILINOS!"));
+#endif
+    }
+  if (type == "MUMPS")
+    {
+      return std::make_unique<PreconditionMUMPS>(matrix);
+    }
+  AssertThrow(type != "GMG",
+              ExcMessage("Geometric multigrid needs the mesh hierarchy and is "
+                         "built by the solver!"));
+  AssertThrow(type == "None",
+              ExcMessage("Unknown preconditioner type " + type + "!"));
+  return std::make_unique<PETScWrappers::PreconditionNone>(matrix);
+}
@@ -1,4 +1,5 @@
 #include "scnsim.h"
+#include <deal.II/lac/lapack_full_matrix.h>
 
 namespace Fluid
 {
@@ -10,26 +11,35 @@ namespace Fluid
    * this to iterative solvers.
    */
   template <int dim>
-  SCnsIM<dim>::BlockIncompSchurPreconditioner::SchurComplementTpp::
+  template <typename number>
+  SCnsIM<dim>::BlockIncompSchurPreconditioner::SchurComplementTpp<number>::
     SchurComplementTpp(TimerOutput &timer,
-                       const BlockSparseMatrix<double> &system,
-                       const SparseILU<double> &Pvvinv)
-    : timer(timer), system_matrix(&system), Pvv_inverse(&Pvvinv)
+                       const SparseMatrix<number> &Avp,
+                       const SparseMatrix<number> &Apv,
+                       const SparseMatrix<number> &App,
+                       const SparseILU<number> &Pvvinv)
+    : timer(timer),
+      Avp(&Avp),
+      Apv(&Apv),
+      App(&App),
+      Pvv_inverse(&Pvvinv),
+      tmp1(Avp.m()),
+      tmp2(Avp.m()),
+      tmp3(App.m())
   {
   }
 
   template <int dim>
-  void SCnsIM<dim>::BlockIncompSchurPreconditioner::SchurComplementTpp::vmult(
-    Vector<double> &dst, const Vector<double> &src) const
+  template <typename number>
+  void SCnsIM<dim>::BlockIncompSchurPreconditioner::SchurComplementTpp<
+    number>::vmult(Vector<number> &dst, const Vector<number> &src) const
   {
     TimerOutput::Scope timer_section(timer, "Tpp vmult");
     // this is the exact representation of Tpp = App - Apv * Avv * Avp.
-    Vector<double> tmp1(this->Avv().m()), tmp2(this->Avv().m()),
-      tmp3(src.size());
-    this->Avp().vmult(tmp1, src);
+    Avp->vmult(tmp1, src);
     Pvv_inverse->vmult(tmp2, tmp1);
-    this->Apv().vmult(tmp3, tmp2);
-    this->App().vmult(dst, src);
+    Apv->vmult(tmp3, tmp2);
+    App->vmult(dst, src);
     dst -= tmp3;
   }
 
@@ -38,17 +48,35 @@ namespace Fluid
     TimerOutput &timer,
     const BlockSparseMatrix<double> &system,
     SparseMatrix<double> &schur,
-    SparseMatrix<double> &B2pp)
+    SparseMatrix<double> &B2pp,
+    const bool single_precision)
     : timer(timer),
       system_matrix(&system),
       schur_matrix(&schur),
       B2pp_matrix(&B2pp),
+      single_precision(single_precision),
       Tpp_itr(0)
   {
     // Initialize the Pvv inverse (the ILU(0) factorization of Avv)
-    Pvv_inverse.initialize(this->Avv());
-    // Initialize Tpp
-    Tpp.reset(new SchurComplementTpp(timer, *system_matrix, Pvv_inverse));
+    // and Tpp in the chosen precision
+    if (single_precision)
+      {
+        Pvv_inverse_float.initialize(this->Avv());
+        Avp_float.reinit(this->Avp().get_sparsity_pattern());
+        Avp_float.copy_from(this->Avp());
+        Apv_float.reinit(this->Apv().get_sparsity_pattern());
+        Apv_float.copy_from(this->Apv());
+        App_float.reinit(this->App().get_sparsity_pattern());
+        App_float.copy_from(this->App());
+        Tpp_float.reset(new SchurComplementTpp<float>(
+          timer, Avp_float, Apv_float, App_float, Pvv_inverse_float));
+      }
+    else
+      {
+        Pvv_inverse.initialize(this->Avv());
+        Tpp.reset(new SchurComplementTpp<double>(
+          timer, this->Avp(), this->Apv(), this->App(), Pvv_inverse));
+      }
     // Compute B2pp matrix App - Apv*rowsum(|Avv|)^(-1)*Avp
     // as the preconditioner to solve Tpp^-1
     Vector<double> RowSumAvv(this->Avv().m());
@@ -81,7 +109,62 @@ namespace Fluid
       {
         B2pp_matrix->add(itr->row(), itr->column(), itr->value());
       }
-    B2pp_inverse.initialize(*B2pp_matrix);
+    if (single_precision)
+      {
+        B2pp_inverse_float.initialize(*B2pp_matrix);
+      }
+    else
+      {
+        B2pp_inverse.initialize(*B2pp_matrix);
+      }
+  }
+
+  template <int dim>
+  void SCnsIM<dim>::BlockIncompSchurPreconditioner::apply_Pvv_inverse(
+    Vector<double> &dst, const Vector<double> &src) const
+  {
+    if (single_precision)
+      {
+        Pvv_inverse_float.vmult(dst, src);
+      }
+    else
+      {
+        Pvv_inverse.vmult(dst, src);
+      }
+  }
+
+  template <int dim>
+  template <typename number>
+  void SCnsIM<dim>::BlockIncompSchurPreconditioner::solve_Tpp(
+    const SchurComplementTpp<number> &Tpp_operator,
+    const SparseILU<number> &B2pp_preconditioner,
+    const double tolerance,
+    Vector<number> &dst,
+    const Vector<number> &src) const
+  {
+    // Set up initial guess first
+    {
+      Vector<number> c(src), Sc;
+      Sc.reinit(c);
+      Tpp_operator.vmult(Sc, c);
+      number alpha = (src * c) / (Sc * c);
+      c *= alpha;
+      dst = c;
+    }
+
+    // Compute the multiplication
+    timer.enter_subsection("Solving Tpp");
+
+    SolverControl solver_control(
+      src.size(), tolerance * src.l2_norm(), true, true);
+    SolverGMRES<Vector<number>> gmres(
+      solver_control,
+      typename SolverGMRES<Vector<number>>::AdditionalData(200));
+    gmres.solve(Tpp_operator, dst, src, B2pp_preconditioner);
+    // Count iterations for this solver solving Tpp inverse
+    Tpp_itr += solver_control.last_step();
+
+    timer.leave_subsection("Solving Tpp");
   }
 
   template <int dim>
@@ -93,7 +176,7 @@ namespace Fluid
     //      |-ApvPvv^-1  I| |src(1)|   |ptmp  |
     /////////////////////////////////////////
     Vector<double> ptmp1(src.block(0).size()), ptmp(src.block(1).size());
-    Pvv_inverse.vmult(ptmp1, src.block(0));
+    apply_Pvv_inverse(ptmp1, src.block(0));
     this->Apv().vmult(ptmp, ptmp1);
     ptmp *= -1.0;
     ptmp += src.block(1);
@@ -103,35 +186,24 @@ namespace Fluid
     //                        =   |Pvv^-1*src(0) - Pvv^-1*Avp*Tpp^-1*ptmp|
     //                            |Tpp^-1 * ptmp                         |
     //////////////////////////////////////////
-    // Compute Tpp^-1 * ptmp first, which is equal to the problem Tpp*x = ptmp
-    // Set up initial guess first
-    {
-      Vector<double> c(ptmp), Sc;
-      Sc.reinit(c);
-      Tpp->vmult(Sc, c);
-      double alpha = (ptmp * c) / (Sc * c);
-      c *= alpha;
-      dst.block(1) = c;
-    }
-
-    // Compute the multiplication
-    timer.enter_subsection("Solving Tpp");
-
-    SolverControl solver_control(
-      ptmp.size(), 1e-6 * ptmp.l2_norm(), true, true);
-    SolverGMRES<Vector<double>> gmres(
-      solver_control, SolverGMRES<Vector<double>>::AdditionalData(200));
-    gmres.solve(*Tpp, dst.block(1), ptmp, B2pp_inverse);
-    // Count iterations for this solver solving Tpp inverse
-    Tpp_itr += solver_control.last_step();
-
-    timer.leave_subsection("Solving Tpp");
+    // Compute Tpp^-1 * ptmp first, which is equal to the problem Tpp*x = ptmp.
+    // Float cannot resolve much below 1e-6, hence the looser tolerance.
+    if (single_precision)
+      {
+        Vector<float> src_float(ptmp), dst_float(ptmp.size());
+        solve_Tpp(*Tpp_float, B2pp_inverse_float, 1e-4, dst_float, src_float);
+        dst.block(1) = dst_float;
+      }
+    else
+      {
+        solve_Tpp(*Tpp, B2pp_inverse, 1e-6, dst.block(1), ptmp);
+      }
 
     // Compute Pvv^-1*src(0) - Pvv^-1*Avp*dst(1)
     Vector<double> utmp1(src.block(0).size()), utmp2(src.block(0).size());
     this->Avp().vmult(utmp1, dst.block(1));
-    Pvv_inverse.vmult(utmp2, utmp1);
-    Pvv_inverse.vmult(dst.block(0), src.block(0));
+    apply_Pvv_inverse(utmp2, utmp1);
+    apply_Pvv_inverse(dst.block(0), src.block(0));
     dst.block(0) -= utmp2;
   }
 
@@ -166,16 +238,21 @@ namespace Fluid
     solution_increment.reinit(dofs_per_block);
     evaluation_point.reinit(dofs_per_block);
     system_rhs.reinit(dofs_per_block);
+    // The previous solution is lost unless it is transferred.
+    previous_delta_t = 0;
+    if (parameters.fluid_time_integration == "BDF2")
+      {
+        previous_solution.reinit(dofs_per_block);
+        bdf2_history.reinit(dofs_per_block);
+      }
 
     // Compute the sparsity pattern for schur in advance.
     // It should be the same as \f$BC^T\f$.
     DynamicSparsityPattern schur_dsp(dofs_per_block[1], dofs_per_block[1]);
     schur_dsp.compute_mmult_pattern(sparsity_pattern.block(1, 0),
                                     sparsity_pattern.block(0, 1));
-    schur_pattern.copy_from(schur_dsp);
-    schur_matrix.reinit(schur_pattern);
 
-    // Compute the pattern for Tpp
+    // Compute the pattern for Tpp, which is shared with the Schur matrix
     for (auto itr = sparsity_pattern.block(1, 1).begin();
          itr != sparsity_pattern.block(1, 1).end();
          ++itr)
@@ -183,21 +260,47 @@ namespace Fluid
         schur_dsp.add(itr->row(), itr->column());
       }
     Tpp_pattern.copy_from(schur_dsp);
+    schur_matrix.reinit(Tpp_pattern);
     B2pp_matrix.reinit(Tpp_pattern);
 
     // Cell property
     setup_cell_property();
 
+    // The cells have changed, so must the PML values.
+    setup_pml();
+
     stress = std::vector<std::vector<Vector<double>>>(
       dim,
       std::vector<Vector<double>>(dim,
                                   Vector<double>(scalar_dof_handler.n_dofs())));
   }
 
+  template <int dim>
+  void SCnsIM<dim>::setup_pml()
+  {
+    cell_sigma_pml.assign(triangulation.n_active_cells(),
+                          std::vector<double>());
+    std::vector<double> sigma_pml(volume_quad_formula.size());
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        cell_fe_data.reinit(cell);
+        sigma_pml_field->value_list(
+          cell_fe_data.get_quadrature_points(), sigma_pml, 0);
+        if (std::any_of(sigma_pml.begin(), sigma_pml.end(), [](double s) {
+              return s != 0;
+            }))
+          {
+            cell_sigma_pml[cell->active_cell_index()] = sigma_pml;
+          }
+      }
+  }
+
   template <int dim>
   void SCnsIM<dim>::assemble(const bool use_nonzero_constraints)
   {
     TimerOutput::Scope timer_section(timer, "Assemble system");
+    OPENIFEM_KERNEL_SCOPE("scnsim_assemble");
 
     const double viscosity = parameters.viscosity;
     const double kappa_s = 1e4;
@@ -208,97 +311,197 @@ namespace Fluid
     system_matrix = 0;
     system_rhs = 0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_quadrature_points |
-                              update_JxW_values | update_gradients);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_quadrature_points |
-                                       update_JxW_values);
-
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
     const unsigned int n_q_points = volume_quad_formula.size();
     const unsigned int n_face_q_points = face_quad_formula.size();
 
     const FEValuesExtractors::Vector velocities(0);
-    const FEValuesExtractors::Scalar pressure(dim);
-
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
-
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-    // For the linearized system, we create temporary storage for current
-    // velocity
-    // and gradient, current pressure, and present velocity. In practice, they
-    // are
-    // all obtained through their shape functions at quadrature points.
-
-    std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-    std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-    std::vector<double> current_pressure_values(n_q_points);
-    std::vector<Tensor<1, dim>> current_pressure_gradients(n_q_points);
-    std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-    std::vector<double> present_pressure_values(n_q_points);
-    std::vector<double> sigma_pml(n_q_points);
-
-    std::vector<double> div_phi_u(dofs_per_cell);
-    std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-    std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-    std::vector<double> phi_p(dofs_per_cell);
-    std::vector<Tensor<1, dim>> grad_phi_p(dofs_per_cell);
 
     // The parameters that is used in isentropic continuity equation:
     // heat capacity ratio and atmospheric pressure.
     double cp_to_cv = 1.4;
     double atm = 1013250;
-
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    const double delta_t = effective_delta_t();
+
+    // Every thread evaluates the cells with its own copy of the cell FE data
+    // and its own buffers.
+    // For the linearized system, they hold the current velocity and
+    // gradient, current pressure and gradient, and present velocity and
+    // pressure at the quadrature points.
+    struct ScratchData
+    {
+      ScratchData(const Utils::CellFEDataCache<dim> &cell_fe_data,
+                  const FiniteElement<dim> &fe,
+                  const Quadrature<dim - 1> &face_quad,
+                  const unsigned int n_q_points)
+        : cell_fe_data(cell_fe_data),
+          local_matrix(fe.dofs_per_cell, fe.dofs_per_cell),
+          local_rhs(fe.dofs_per_cell),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_normal_vectors |
+                           update_quadrature_points | update_JxW_values),
+          current_dof_values(fe.dofs_per_cell),
+          present_dof_values(fe.dofs_per_cell),
+          current_velocity_values(n_q_points),
+          current_velocity_gradients(n_q_points),
+          current_pressure_values(n_q_points),
+          current_pressure_gradients(n_q_points),
+          present_velocity_values(n_q_points),
+          present_pressure_values(n_q_points),
+          sigma_pml(n_q_points),
+          div_phi_u(fe.dofs_per_cell),
+          phi_u(fe.dofs_per_cell),
+          grad_phi_u(fe.dofs_per_cell),
+          phi_p(fe.dofs_per_cell),
+          grad_phi_p(fe.dofs_per_cell)
+      {
+      }
+      ScratchData(const ScratchData &scratch)
+        : cell_fe_data(scratch.cell_fe_data),
+          local_matrix(scratch.local_matrix),
+          local_rhs(scratch.local_rhs),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          current_dof_values(scratch.current_dof_values),
+          present_dof_values(scratch.present_dof_values),
+          current_velocity_values(scratch.current_velocity_values),
+          current_velocity_gradients(scratch.current_velocity_gradients),
+          current_pressure_values(scratch.current_pressure_values),
+          current_pressure_gradients(scratch.current_pressure_gradients),
+          present_velocity_values(scratch.present_velocity_values),
+          present_pressure_values(scratch.present_pressure_values),
+          sigma_pml(scratch.sigma_pml),
+          div_phi_u(scratch.div_phi_u),
+          phi_u(scratch.phi_u),
+          grad_phi_u(scratch.grad_phi_u),
+          phi_p(scratch.phi_p),
+          grad_phi_p(scratch.grad_phi_p)
       {
+      }
+      Utils::CellFEDataCache<dim> cell_fe_data;
+      FullMatrix<double> local_matrix;
+      Vector<double> local_rhs;
+      FEFaceValues<dim> fe_face_values;
+      Vector<double> current_dof_values;
+      Vector<double> present_dof_values;
+      std::vector<Tensor<1, dim>> current_velocity_values;
+      std::vector<Tensor<2, dim>> current_velocity_gradients;
+      std::vector<double> current_pressure_values;
+      std::vector<Tensor<1, dim>> current_pressure_gradients;
+      std::vector<Tensor<1, dim>> present_velocity_values;
+      std::vector<double> present_pressure_values;
+      std::vector<double> sigma_pml;
+      std::vector<double> div_phi_u;
+      std::vector<Tensor<1, dim>> phi_u;
+      std::vector<Tensor<2, dim>> grad_phi_u;
+      std::vector<double> phi_p;
+      std::vector<Tensor<1, dim>> grad_phi_p;
+    };
+    // The local contributions of a cell, which are distributed to the global
+    // system in the order of the cells.
+    // The local system is distributed after every quadrature point, so the
+    // partial sums are kept for each of them.
+    struct CopyData
+    {
+      CopyData(const unsigned int dofs_per_cell, const unsigned int n_q_points)
+        : local_matrices(n_q_points,
+                         FullMatrix<double>(dofs_per_cell, dofs_per_cell)),
+          local_rhs(n_q_points, Vector<double>(dofs_per_cell)),
+          local_dof_indices(dofs_per_cell)
+      {
+      }
+      std::vector<FullMatrix<double>> local_matrices;
+      std::vector<Vector<double>> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
+
+    auto worker =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &copy) {
+        Utils::CellFEDataCache<dim> &cell_fe_data = scratch.cell_fe_data;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        FullMatrix<double> &local_matrix = scratch.local_matrix;
+        Vector<double> &local_rhs = scratch.local_rhs;
+        Vector<double> &current_dof_values = scratch.current_dof_values;
+        Vector<double> &present_dof_values = scratch.present_dof_values;
+        std::vector<Tensor<1, dim>> &current_velocity_values =
+          scratch.current_velocity_values;
+        std::vector<Tensor<2, dim>> &current_velocity_gradients =
+          scratch.current_velocity_gradients;
+        std::vector<double> &current_pressure_values =
+          scratch.current_pressure_values;
+        std::vector<Tensor<1, dim>> &current_pressure_gradients =
+          scratch.current_pressure_gradients;
+        std::vector<Tensor<1, dim>> &present_velocity_values =
+          scratch.present_velocity_values;
+        std::vector<double> &present_pressure_values =
+          scratch.present_pressure_values;
+        std::vector<double> &sigma_pml = scratch.sigma_pml;
+        std::vector<double> &div_phi_u = scratch.div_phi_u;
+        std::vector<Tensor<1, dim>> &phi_u = scratch.phi_u;
+        std::vector<Tensor<2, dim>> &grad_phi_u = scratch.grad_phi_u;
+        std::vector<double> &phi_p = scratch.phi_p;
+        std::vector<Tensor<1, dim>> &grad_phi_p = scratch.grad_phi_p;
+
         auto p = cell_property.get_data(cell);
         const int ind = p[0]->indicator;
         const double rho = parameters.fluid_rho +
                            ind * (parameters.solid_rho - parameters.fluid_rho);
 
-        fe_values.reinit(cell);
+        cell_fe_data.reinit(cell);
 
         local_matrix = 0;
         local_rhs = 0;
 
-        fe_values[velocities].get_function_values(evaluation_point,
-                                                  current_velocity_values);
+        cell->get_dof_values(evaluation_point, current_dof_values);
+        // The history of the time derivative, which is the present solution
+        // unless BDF2 is used. With BDF2 the SUPG parameters are lagged to the
+        // history, which differs from the present solution by O(dt) like the
+        // lagging itself.
+        cell->get_dof_values(time_history(), present_dof_values);
 
-        fe_values[velocities].get_function_gradients(
-          evaluation_point, current_velocity_gradients);
+        cell_fe_data.get_velocity_values(current_dof_values,
+                                         current_velocity_values);
 
-        fe_values[pressure].get_function_values(evaluation_point,
-                                                current_pressure_values);
+        cell_fe_data.get_velocity_gradients(current_dof_values,
+                                            current_velocity_gradients);
 
-        fe_values[pressure].get_function_gradients(evaluation_point,
-                                                   current_pressure_gradients);
+        cell_fe_data.get_pressure_values(current_dof_values,
+                                         current_pressure_values);
 
-        fe_values[velocities].get_function_values(present_solution,
-                                                  present_velocity_values);
+        cell_fe_data.get_pressure_gradients(current_dof_values,
+                                            current_pressure_gradients);
 
-        fe_values[pressure].get_function_values(present_solution,
-                                                present_pressure_values);
+        cell_fe_data.get_velocity_values(present_dof_values,
+                                         present_velocity_values);
 
-        sigma_pml_field->value_list(
-          fe_values.get_quadrature_points(), sigma_pml, 0);
+        cell_fe_data.get_pressure_values(present_dof_values,
+                                         present_pressure_values);
+
+        const std::vector<double> &cell_sigma =
+          cell_sigma_pml[cell->active_cell_index()];
+        if (cell_sigma.empty())
+          {
+            std::fill(sigma_pml.begin(), sigma_pml.end(), 0.0);
+          }
+        else
+          {
+            sigma_pml = cell_sigma;
+          }
 
         // Assemble the system matrix
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
-                div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                phi_u[k] = fe_values[velocities].value(k, q);
-                phi_p[k] = fe_values[pressure].value(k, q);
-                grad_phi_p[k] = fe_values[pressure].gradient(k, q);
+                div_phi_u[k] = cell_fe_data.velocity_divergence(k, q);
+                grad_phi_u[k] = cell_fe_data.velocity_gradient(k, q);
+                phi_u[k] = cell_fe_data.velocity_value(k, q);
+                phi_p[k] = cell_fe_data.pressure_value(k, q);
+                grad_phi_p[k] = cell_fe_data.pressure_gradient(k, q);
               }
             double current_velocity_divergence =
               trace(current_velocity_gradients[q]);
@@ -313,8 +516,8 @@ namespace Fluid
             for (unsigned int a = 0; a < dofs_per_cell / fe.dofs_per_vertex;
                  ++a)
               {
-                h +=
-                  abs(present_velocity_values[q] * fe_values.shape_grad(a, q));
+                h += abs(present_velocity_values[q] *
+                         cell_fe_data.shape_grad(a, q));
               }
             if (h)
               h = 2 * present_velocity_values[q].norm() / h;
@@ -344,13 +547,13 @@ namespace Fluid
                         rho * grad_phi_u[j] * current_velocity_values[q] *
                           phi_u[i] -
                         div_phi_u[i] * phi_p[j]) +
-                       rho * phi_u[i] * phi_u[j] / time.get_delta_t()) *
-                      fe_values.JxW(q);
+                       rho * phi_u[i] * phi_u[j] / delta_t) *
+                      cell_fe_data.JxW(q);
                     // PML attenuation
                     local_matrix(i, j) +=
                       (rho * sigma_pml[q] * phi_u[j] * phi_u[i] +
                        sigma_pml[q] * phi_p[j] * phi_p[i] / (cp_to_cv * atm)) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                     // Add SUPG and PSPG stabilization
                     local_matrix(i, j) +=
                       // SUPG Convection
@@ -365,11 +568,11 @@ namespace Fluid
                           current_velocity_gradients[q]) +
                        // SUPG Acceleration
                        tau_SUPG * rho * current_velocity_values[q] *
-                         grad_phi_u[i] * phi_u[j] / time.get_delta_t() +
+                         grad_phi_u[i] * phi_u[j] / delta_t +
                        tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
                          (current_velocity_values[q] -
                           present_velocity_values[q]) /
-                         time.get_delta_t() +
+                         delta_t +
                        // SUPG Pressure
                        tau_SUPG * current_velocity_values[q] * grad_phi_u[i] *
                          grad_phi_p[j] +
@@ -386,14 +589,13 @@ namespace Fluid
                        tau_PSPG * rho * grad_phi_p[i] *
                          (current_velocity_values[q] * grad_phi_u[j]) +
                        // PSPG Acceleration
-                       tau_PSPG * rho * grad_phi_p[i] * phi_u[j] /
-                         time.get_delta_t() +
+                       tau_PSPG * rho * grad_phi_p[i] * phi_u[j] / delta_t +
                        // PSPG Pressure
                        tau_PSPG * grad_phi_p[i] * grad_phi_p[j] +
                        // PSPG PML
                        tau_PSPG * rho * grad_phi_p[i] * sigma_pml[q] *
                          phi_u[j]) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                     // For more clear demonstration, write continuity
                     // equation
                     // separately.
@@ -408,9 +610,9 @@ namespace Fluid
                        current_velocity_values[q] * grad_phi_p[j] * phi_p[i] *
                          (1 - ind) +
                        phi_u[j] * current_pressure_gradients[q] * phi_p[i] +
-                       phi_p[i] * phi_p[j] / time.get_delta_t() *
+                       phi_p[i] * phi_p[j] / delta_t *
                          (1 - ind + cp_to_cv * atm / kappa_s * ind)) /
-                      (cp_to_cv * atm) * fe_values.JxW(q);
+                      (cp_to_cv * atm) * cell_fe_data.JxW(q);
                   }
 
                 // RHS is \f$-(A_{current} + C_{current}) -
@@ -423,29 +625,29 @@ namespace Fluid
                     current_pressure_values[q] * div_phi_u[i]) -
                    rho *
                      (current_velocity_values[q] - present_velocity_values[q]) *
-                     phi_u[i] / time.get_delta_t() +
+                     phi_u[i] / delta_t +
                    gravity * phi_u[i] * rho) *
-                  fe_values.JxW(q);
+                  cell_fe_data.JxW(q);
                 local_rhs(i) +=
                   -(rho * sigma_pml[q] * current_velocity_values[q] * phi_u[i] +
                     sigma_pml[q] * current_pressure_values[q] * phi_p[i] /
                       (cp_to_cv * atm)) *
-                  fe_values.JxW(q);
+                  cell_fe_data.JxW(q);
                 local_rhs(i) +=
                   -(cp_to_cv * (atm + current_pressure_values[q]) *
                       current_velocity_divergence * phi_p[i] +
                     current_velocity_values[q] * current_pressure_gradients[q] *
                       phi_p[i] * (1 - ind) +
                     (current_pressure_values[q] - present_pressure_values[q]) *
-                      phi_p[i] / time.get_delta_t() *
+                      phi_p[i] / delta_t *
                       (1 - ind + cp_to_cv * atm / kappa_s * ind)) /
-                  (cp_to_cv * atm) * fe_values.JxW(q);
+                  (cp_to_cv * atm) * cell_fe_data.JxW(q);
                 // Add SUPG and PSPS rhs terms.
                 local_rhs(i) +=
                   -((tau_SUPG * current_velocity_values[q] * grad_phi_u[i]) *
                       (rho * ((current_velocity_values[q] -
                                present_velocity_values[q]) /
-                                time.get_delta_t() +
+                                delta_t +
                               current_velocity_values[q] *
                                 current_velocity_gradients[q]) +
                        current_pressure_gradients[q] +
@@ -453,18 +655,18 @@ namespace Fluid
                     (tau_PSPG * grad_phi_p[i]) *
                       (rho * ((current_velocity_values[q] -
                                present_velocity_values[q]) /
-                                time.get_delta_t() +
+                                delta_t +
                               current_velocity_values[q] *
                                 current_velocity_gradients[q]) +
                        current_pressure_gradients[q] +
                        rho * sigma_pml[q] * current_velocity_values[q])) *
-                  fe_values.JxW(q);
+                  cell_fe_data.JxW(q);
                 if (ind == 1)
                   {
                     local_rhs(i) +=
                       (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
                        (p[0]->fsi_acceleration * rho * phi_u[i])) *
-                      fe_values.JxW(q);
+                      cell_fe_data.JxW(q);
                   }
               }
 
@@ -486,34 +688,51 @@ namespace Fluid
                         unsigned int p_bc_id =
                           cell->face(face_n)->boundary_id();
                         double boundary_values_p =
-                          parameters.fluid_neumann_bcs[p_bc_id];
-                        for (unsigned int q = 0; q < n_face_q_points; ++q)
+                          parameters.fluid_neumann_bcs.at(p_bc_id);
+                        for (unsigned int f_q = 0; f_q < n_face_q_points;
+                             ++f_q)
                           {
                             for (unsigned int i = 0; i < dofs_per_cell; ++i)
                               {
                                 local_rhs(i) +=
-                                  -(fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
+                                  -(fe_face_values[velocities].value(i, f_q) *
+                                    fe_face_values.normal_vector(f_q) *
+                                    boundary_values_p *
+                                    fe_face_values.JxW(f_q));
                               }
                           }
                       }
                   }
               }
 
-            cell->get_dof_indices(local_dof_indices);
+            copy.local_matrices[q] = local_matrix;
+            copy.local_rhs[q] = local_rhs;
+          }
 
-            const AffineConstraints<double> &constraints_used =
-              use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+        cell->get_dof_indices(copy.local_dof_indices);
+      };
 
-            constraints_used.distribute_local_to_global(local_matrix,
-                                                        local_rhs,
-                                                        local_dof_indices,
-                                                        system_matrix,
-                                                        system_rhs,
-                                                        true);
-          }
-      }
+    const AffineConstraints<double> &constraints_used =
+      use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+    auto copier = [&](const CopyData &copy) {
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          constraints_used.distribute_local_to_global(copy.local_matrices[q],
+                                                      copy.local_rhs[q],
+                                                      copy.local_dof_indices,
+                                                      system_matrix,
+                                                      system_rhs,
+                                                      true);
+        }
+    };
+
+    WorkStream::run(
+      dof_handler.begin_active(),
+      dof_handler.end(),
+      worker,
+      copier,
+      ScratchData(cell_fe_data, fe, face_quad_formula, n_q_points),
+      CopyData(dofs_per_cell, n_q_points));
   }
 
   template <int dim>
@@ -521,9 +740,19 @@ namespace Fluid
   SCnsIM<dim>::solve(const bool use_nonzero_constraints)
   {
     TimerOutput::Scope timer_section(timer, "Solve linear system");
+    const double delta_t = effective_delta_t();
 
-    preconditioner.reset(new BlockIncompSchurPreconditioner(
-      timer, system_matrix, schur_matrix, B2pp_matrix));
+    if (!preconditioner ||
+        preconditioner_reuse.need_rebuild(delta_t, system_matrix.block(0, 0)))
+      {
+        preconditioner.reset(new BlockIncompSchurPreconditioner(
+          timer,
+          system_matrix,
+          schur_matrix,
+          B2pp_matrix,
+          parameters.fluid_single_precision));
+        preconditioner_reuse.rebuilt(delta_t, system_matrix.block(0, 0));
+      }
 
     // NOTE: SolverFGMRES only applies the preconditioner from the right,
     // as opposed to SolverGMRES which allows both left and right
@@ -534,6 +763,7 @@ namespace Fluid
     SolverFGMRES<BlockVector<double>> gmres(solver_control, vector_memory);
 
     gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
+    preconditioner_reuse.record(solver_control.last_step());
 
     const AffineConstraints<double> &constraints_used =
       use_nonzero_constraints ? nonzero_constraints : zero_constraints;
@@ -542,6 +772,83 @@ namespace Fluid
     return {solver_control.last_step(), solver_control.last_value()};
   }
 
+  template <int dim>
+  bool SCnsIM<dim>::run_reduced_step(const bool apply_nonzero_constraints,
+                                     unsigned int &iterations)
+  {
+    // The basis does not survive a refinement.
+    if (!pod_basis.matches(present_solution))
+      {
+        return false;
+      }
+    const unsigned int n_modes = pod_basis.n_modes();
+    Vector<double> reduced_rhs(n_modes);
+    std::vector<BlockVector<double>> jacobian_modes(n_modes,
+                                                    present_solution);
+    double initial_full_residual = 1.0;
+    double initial_reduced_residual = 1.0;
+    for (iterations = 0; iterations < parameters.fluid_max_iterations;
+         ++iterations)
+      {
+        assemble(apply_nonzero_constraints && iterations == 0);
+        const double full_residual = system_rhs.l2_norm();
+        for (unsigned int i = 0; i < n_modes; ++i)
+          {
+            reduced_rhs[i] = pod_basis.mode(i) * system_rhs;
+          }
+        const double reduced_residual = reduced_rhs.l2_norm();
+        if (iterations == 0)
+          {
+            initial_full_residual = full_residual;
+            initial_reduced_residual = reduced_residual;
+          }
+        std::cout << std::scientific << std::left << " ROM_ITR = "
+                  << std::setw(2) << iterations
+                  << " ABS_RES = " << full_residual
+                  << " REDUCED_RES = " << reduced_residual << std::endl;
+
+        if (iterations > 0 &&
+            (reduced_residual <
+               parameters.fluid_tolerance * initial_reduced_residual ||
+             reduced_residual < 1e-14))
+          {
+            if (full_residual >
+                parameters.fluid_reduced_tolerance * initial_full_residual)
+              {
+                std::cout << " Reduced step rejected, ABS_RES / "
+                             "INITIAL_ABS_RES = "
+                          << full_residual / initial_full_residual
+                          << std::endl;
+                return false;
+              }
+            return true;
+          }
+
+        // Galerkin projection of the Jacobian onto the modes.
+        TimerOutput::Scope timer_section(timer, "Solve reduced system");
+        for (unsigned int j = 0; j < n_modes; ++j)
+          {
+            system_matrix.vmult(jacobian_modes[j], pod_basis.mode(j));
+          }
+        LAPACKFullMatrix<double> reduced_matrix(n_modes, n_modes);
+        for (unsigned int i = 0; i < n_modes; ++i)
+          {
+            for (unsigned int j = 0; j < n_modes; ++j)
+              {
+                reduced_matrix(i, j) = pod_basis.mode(i) * jacobian_modes[j];
+              }
+          }
+        reduced_matrix.compute_lu_factorization();
+        reduced_matrix.solve(reduced_rhs);
+        for (unsigned int j = 0; j < n_modes; ++j)
+          {
+            evaluation_point.add(reduced_rhs[j], pod_basis.mode(j));
+          }
+      }
+    std::cout << " Reduced step rejected, too many iterations" << std::endl;
+    return false;
+  }
+
   template <int dim>
   void SCnsIM<dim>::run_one_step(bool apply_nonzero_constraints,
                                  bool assemble_system)
@@ -559,6 +866,7 @@ namespace Fluid
     std::cout << std::string(96, '*') << std::endl
               << "Time step = " << time.get_timestep()
               << ", at t = " << std::scientific << time.current() << std::endl;
+    update_time_history();
 
     // Resetting
     double current_residual = 1.0;
@@ -566,6 +874,24 @@ namespace Fluid
     double relative_residual = 1.0;
     unsigned int outer_iteration = 0;
     evaluation_point = present_solution;
+    // An accepted reduced step leaves nothing to the full iterations.
+    if (parameters.fluid_reduced_order == "Online" &&
+        run_reduced_step(apply_nonzero_constraints, outer_iteration))
+      {
+        relative_residual = 0;
+      }
+    else
+      {
+        outer_iteration = 0;
+        evaluation_point = present_solution;
+        // Start from the extrapolated solution unless the boundary values
+        // are applied in this step, which assumes the present solution.
+        if (!apply_nonzero_constraints)
+          {
+            solution_predictor.predict(evaluation_point, time.get_delta_t());
+          }
+      }
+    unsigned int total_iterations = 0;
     while (relative_residual > parameters.fluid_tolerance &&
            current_residual > 1e-14)
       {
@@ -584,6 +910,7 @@ namespace Fluid
         assemble(apply_nonzero_constraints && outer_iteration == 0);
         auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
         current_residual = system_rhs.l2_norm();
+        total_iterations += state.first;
 
         // Update evaluation_point. Since newton_update has been set to
         // the correct bc values, there is no need to distribute the
@@ -607,13 +934,23 @@ namespace Fluid
 
         outer_iteration++;
       }
+    std::cout << " NEWTON_ITR = " << outer_iteration
+              << " TOTAL_GMRES_ITR = " << total_iterations << std::endl;
     // Update solution increment, which is used in FSI application.
     solution_increment = evaluation_point;
     solution_increment -= present_solution;
     // Newton iteration converges, update time and solution
+    record_previous_solution();
     present_solution = evaluation_point;
+    solution_predictor.record(present_solution, time.get_delta_t());
+    if (parameters.fluid_reduced_order == "Offline")
+      {
+        pod_basis.add_snapshot(present_solution);
+      }
     // Update stress for output
     update_stress();
+    // Choose the next time step size
+    adapt_time_step(outer_iteration);
     // Output
     if (time.time_to_output())
       {
@@ -628,11 +965,22 @@ namespace Fluid
   template <int dim>
   void SCnsIM<dim>::run()
   {
-    triangulation.refine_global(parameters.global_refinements[0]);
+    Utils::refine_global_cached(
+      triangulation, parameters.global_refinements[0], parameters.mesh_cache);
     setup_dofs();
     make_constraints();
     initialize_system();
 
+    if (parameters.fluid_reduced_order == "Online")
+      {
+        AssertThrow(
+          pod_basis.load(parameters.fluid_reduced_basis, present_solution),
+          ExcMessage("Cannot load a POD basis of this mesh from " +
+                     parameters.fluid_reduced_basis + "!"));
+        std::cout << "Loaded " << pod_basis.n_modes() << " POD modes"
+                  << std::endl;
+      }
+
     // Time loop.
     // use_nonzero_constraints is set to true only at the first time step,
     // which means nonzero_constraints will be applied at the first iteration
@@ -651,6 +999,21 @@ namespace Fluid
           }
         else
           run_one_step(false);
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        if (reached_steady_state())
+          {
+            break;
+          }
+      }
+
+    if (parameters.fluid_reduced_order == "Offline")
+      {
+        pod_basis.compute(parameters.fluid_reduced_energy,
+                          parameters.fluid_reduced_modes);
+        pod_basis.save(parameters.fluid_reduced_basis);
+        std::cout << "Saved " << pod_basis.n_modes() << " POD modes to "
+                  << parameters.fluid_reduced_basis << std::endl;
       }
   }
 
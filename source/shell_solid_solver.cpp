@@ -54,6 +54,29 @@ namespace Solid
     cell_property.initialize(triangulation.begin_active(),
                              triangulation.end(),
                              GeometryInfo<2>::faces_per_cell);
+
+    vertex_dofs.assign(triangulation.n_vertices(),
+                       {{numbers::invalid_dof_index,
+                         numbers::invalid_dof_index,
+                         numbers::invalid_dof_index}});
+    vertex_scalar_dofs.assign(triangulation.n_vertices(),
+                              numbers::invalid_dof_index);
+    auto scalar_cell = scalar_dof_handler.begin_active();
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell, ++scalar_cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+          {
+            for (unsigned int n : {0, 1, 2})
+              {
+                vertex_dofs[cell->vertex_index(v)][n] =
+                  cell->vertex_dof_index(v, n);
+              }
+            vertex_scalar_dofs[scalar_cell->vertex_index(v)] =
+              scalar_cell->vertex_dof_index(v, 0);
+          }
+      }
+    pushed_solution.assign(current_displacement.size() * 2, 0);
   }
 
   void ShellSolidSolver::setup_dofs()
@@ -139,78 +162,48 @@ namespace Solid
 
   void ShellSolidSolver::grab_solution()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
+    // The solution is read in place, 15 values per node.
     const std::vector<libMesh::Number> &solution(m_shell->get_solution());
     AssertThrow(solution.size() == current_displacement.size() * 5,
                 ExcMessage("Inconsistent solution size!"));
-    // Copy the solutions
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    for (unsigned int node = 0; node < vertex_dofs.size(); ++node)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        const libMesh::Number *values = &solution[15 * node];
+        for (unsigned int n : {0, 1, 2})
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int n : {0, 1, 2})
-                  {
-                    current_displacement(cell->vertex_dof_index(v, n)) =
-                      solution[15 * cell->vertex_index(v) + n];
-                    current_drilling(cell->vertex_dof_index(v, n)) =
-                      solution[15 * cell->vertex_index(v) + 3 + n];
-                  }
-              }
+            current_displacement(vertex_dofs[node][n]) = values[n];
+            current_drilling(vertex_dofs[node][n]) = values[3 + n];
           }
       }
   }
 
   void ShellSolidSolver::push_solution()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
-    std::vector<libMesh::Number> solution(current_displacement.size() * 2);
-    // Copy the solutions
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    AssertDimension(pushed_solution.size(), current_displacement.size() * 2);
+    // 6 values per node, the drillings are left zero.
+    for (unsigned int node = 0; node < vertex_dofs.size(); ++node)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        for (unsigned int n : {0, 1, 2})
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int n : {0, 1, 2})
-                  {
-                    solution[6 * cell->vertex_index(v) + n] =
-                      current_displacement(cell->vertex_dof_index(v, n));
-                  }
-              }
+            pushed_solution[6 * node + n] =
+              current_displacement(vertex_dofs[node][n]);
           }
       }
-    this->m_shell->set_solution(solution);
+    this->m_shell->set_solution(pushed_solution);
   }
 
   void ShellSolidSolver::grab_stress()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
     const std::vector<libMesh::Number> &solution(m_shell->get_solution());
     AssertThrow(solution.size() == current_displacement.size() * 5,
                 ExcMessage("Inconsistent solution size!"));
-    // Copy the solutions
-    for (auto cell = scalar_dof_handler.begin_active();
-         cell != scalar_dof_handler.end();
-         ++cell)
+    for (unsigned int node = 0; node < vertex_scalar_dofs.size(); ++node)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        const libMesh::Number *values = &solution[15 * node];
+        for (unsigned int i : {0, 1, 2})
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int i : {0, 1, 2})
-                  {
-                    for (unsigned int j : {0, 1, 2})
-                      stress[i][j](cell->vertex_dof_index(v, 0)) =
-                        solution[15 * cell->vertex_index(v) + 3 * i + j];
-                  }
-              }
+            for (unsigned int j : {0, 1, 2})
+              stress[i][j](vertex_scalar_dofs[node]) = values[3 * i + j];
           }
       }
   }
@@ -224,28 +217,35 @@ namespace Solid
     std::vector<DataComponentInterpretation::DataComponentInterpretation>
       data_component_interpretation(
         3, DataComponentInterpretation::component_is_part_of_vector);
-    DataOut<2, DoFHandler<2, 3>> data_out;
+    Utils::FilteredDataOut<2, 3> data_out(
+      [this](const auto &cell) { return output_control.write_cell(cell); });
     data_out.attach_dof_handler(dof_handler);
 
     // displacements
-    data_out.add_data_vector(dof_handler,
-                             current_displacement,
-                             solution_names,
-                             data_component_interpretation);
-    // velocity
-    solution_names = std::vector<std::string>(3, "drillings");
-    data_out.add_data_vector(dof_handler,
-                             current_drilling,
-                             solution_names,
-                             data_component_interpretation);
+    if (output_control.write_field("displacement"))
+      {
+        data_out.add_data_vector(dof_handler,
+                                 current_displacement,
+                                 solution_names,
+                                 data_component_interpretation);
+        // The drillings go with the displacements.
+        solution_names = std::vector<std::string>(3, "drillings");
+        data_out.add_data_vector(dof_handler,
+                                 current_drilling,
+                                 solution_names,
+                                 data_component_interpretation);
+      }
 
     // strain and stress
-    data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
-    data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
-    data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
-    data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
-    data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
-    data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+    if (output_control.write_stress(time))
+      {
+        data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
+        data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
+        data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
+        data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+      }
 
     data_out.build_patches();
 
@@ -254,11 +254,12 @@ namespace Solid
       basename + "-" + Utilities::int_to_string(output_index, 6) + ".vtu";
 
     std::ofstream output(filename);
+    output_control.set_flags(data_out);
     data_out.write_vtu(output);
 
     static std::vector<std::pair<double, std::string>> times_and_names;
+    static Utils::PVDRecord pvd_record(basename + ".pvd");
     times_and_names.push_back({time.current(), filename});
-    std::ofstream pvd_output(basename + ".pvd");
-    DataOutBase::write_pvd_record(pvd_output, times_and_names);
+    pvd_record.write(times_and_names);
   }
 } // namespace Solid
\ No newline at end of file
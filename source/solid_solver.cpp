@@ -21,8 +21,14 @@ namespace Solid
            parameters.output_interval,
            parameters.refinement_interval,
            parameters.save_interval),
-      timer(std::cout, TimerOutput::never, TimerOutput::wall_times)
+      timer(std::cout, TimerOutput::never, TimerOutput::wall_times),
+      output_control(parameters),
+      neumann_table(parameters.solid_neumann_table),
+      steady_state(parameters.steady_state_tolerance,
+                   parameters.steady_state_steps)
   {
+    Utils::TimingReport::instance().add(
+      "solid", timer, MPI_COMM_SELF, parameters.timing_report);
   }
 
   template <int dim, int spacedim>
@@ -30,7 +36,7 @@ namespace Solid
   {
     scalar_dof_handler.clear();
     dof_handler.clear();
-    timer.print_summary();
+    Utils::TimingReport::instance().remove(timer);
   }
 
   template <int dim, int spacedim>
@@ -39,7 +45,7 @@ namespace Solid
     TimerOutput::Scope timer_section(timer, "Setup system");
 
     dof_handler.distribute_dofs(fe);
-    DoFRenumbering::Cuthill_McKee(dof_handler);
+    Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
     scalar_dof_handler.distribute_dofs(scalar_fe);
 
     // The Dirichlet boundary conditions are stored in the
@@ -137,6 +143,168 @@ namespace Solid
     return {solver_control.last_step(), solver_control.last_value()};
   }
 
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::assemble_explicit_rhs()
+  {
+    AssertThrow(false,
+                ExcMessage("The solid solver has no explicit integrator!"));
+  }
+
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::assemble_lumped_mass()
+  {
+    TimerOutput::Scope timer_section(timer, "Assemble lumped mass");
+
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    const unsigned int n_q_points = volume_quad_formula.size();
+    const double rho = parameters.solid_rho;
+
+    FEValues<dim, spacedim> fe_values(
+      fe, volume_quad_formula, update_values | update_JxW_values);
+    Vector<double> local_mass(dofs_per_cell);
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    Vector<double> lumped_mass(dof_handler.n_dofs());
+
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        fe_values.reinit(cell);
+        local_mass = 0;
+        // The shape functions of a component sum up to one, so the row sum
+        // of the consistent mass matrix is the integral of a shape function.
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                const unsigned int component_i =
+                  fe.system_to_component_index(i).first;
+                local_mass[i] += rho *
+                                 fe_values.shape_value_component(
+                                   i, q, component_i) *
+                                 fe_values.JxW(q);
+              }
+          }
+        cell->get_dof_indices(local_dof_indices);
+        constraints.distribute_local_to_global(
+          local_mass, local_dof_indices, lumped_mass);
+      }
+
+    inverse_lumped_mass.reinit(dof_handler.n_dofs());
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      {
+        if (lumped_mass[i] > 0)
+          {
+            inverse_lumped_mass[i] = 1.0 / lumped_mass[i];
+          }
+      }
+  }
+
+  template <int dim, int spacedim>
+  double SolidSolver<dim, spacedim>::estimate_stable_time_step() const
+  {
+    // The dilatational (P-wave) modulus is the stiffest mode of every part.
+    double modulus = 0;
+    for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
+      {
+        if (parameters.solid_type == "LinearElastic")
+          {
+            const double E = parameters.E[i], nu = parameters.nu[i];
+            AssertThrow(nu < 0.5,
+                        ExcMessage("Incompressible solids are unsupported by "
+                                   "the explicit integrator!"));
+            modulus = std::max(modulus,
+                               E * (1 - nu) / ((1 + nu) * (1 - 2 * nu)));
+          }
+        else if (parameters.solid_type == "NeoHookean")
+          {
+            // The shear modulus is 2 * C1, the bulk modulus kappa.
+            modulus = std::max(modulus,
+                               parameters.C[i][1] +
+                                 4.0 / 3.0 * 2 * parameters.C[i][0]);
+          }
+        else
+          {
+            AssertThrow(false, ExcNotImplemented());
+          }
+      }
+    const double wave_speed = std::sqrt(modulus / parameters.solid_rho);
+
+    double h = std::numeric_limits<double>::max();
+    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
+         ++cell)
+      {
+        h = std::min(h, cell->minimum_vertex_distance());
+      }
+    // Higher order elements have nodes degree times closer.
+    return h / (parameters.solid_degree * wave_speed);
+  }
+
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::run_one_explicit_step(bool first_step)
+  {
+    // \f$\gamma = \frac{1}{2}\f$ is central difference, damping increases
+    // it the same way as in the implicit solvers.
+    const double gamma = 0.5 + parameters.damping;
+
+    if (first_step)
+      {
+        assemble_lumped_mass();
+        const double stable_dt = estimate_stable_time_step();
+        std::cout << "Estimated stable time step = " << stable_dt
+                  << std::endl;
+        if (time.get_delta_t() > stable_dt)
+          {
+            std::cout << "Warning: the time step is larger than the "
+                         "estimated stable time step!"
+                      << std::endl;
+          }
+        // Compute the initial acceleration, \f$ M_La_n = F - F_{int} \f$.
+        current_displacement = previous_displacement;
+        assemble_explicit_rhs();
+        previous_acceleration = system_rhs;
+        previous_acceleration.scale(inverse_lumped_mass);
+        constraints.distribute(previous_acceleration);
+        output_results(time.get_timestep());
+      }
+
+    const double dt = time.get_delta_t();
+
+    time.increment();
+    std::cout << std::string(91, '*') << std::endl
+              << "Time step = " << time.get_timestep()
+              << ", at t = " << std::scientific << time.current() << std::endl;
+
+    // \f$ u_{n+1} = u_n + \Delta{t}v_n + \frac{1}{2}\Delta{t}^2a_n \f$
+    current_displacement = previous_displacement;
+    current_displacement.add(
+      dt, previous_velocity, 0.5 * dt * dt, previous_acceleration);
+
+    // The acceleration only needs the diagonal lumped mass.
+    assemble_explicit_rhs();
+    current_acceleration = system_rhs;
+    current_acceleration.scale(inverse_lumped_mass);
+    constraints.distribute(current_acceleration);
+
+    // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
+    // \f$
+    current_velocity = previous_velocity;
+    current_velocity.add(dt * (1 - gamma),
+                         previous_acceleration,
+                         dt * gamma,
+                         current_acceleration);
+
+    previous_acceleration = current_acceleration;
+    previous_velocity = current_velocity;
+    previous_displacement = current_displacement;
+
+    update_strain_and_stress();
+
+    if (time.time_to_output())
+      {
+        output_results(time.get_timestep());
+      }
+  }
+
   template <int dim, int spacedim>
   void
   SolidSolver<dim, spacedim>::output_results(const unsigned int output_index)
@@ -148,46 +316,60 @@ namespace Solid
     std::vector<DataComponentInterpretation::DataComponentInterpretation>
       data_component_interpretation(
         spacedim, DataComponentInterpretation::component_is_part_of_vector);
-    DataOut<dim, DoFHandler<dim, spacedim>> data_out;
+    Utils::FilteredDataOut<dim, spacedim> data_out(
+      [this](const auto &cell) { return output_control.write_cell(cell); });
     data_out.attach_dof_handler(dof_handler);
 
     // displacements
-    data_out.add_data_vector(dof_handler,
-                             current_displacement,
-                             solution_names,
-                             data_component_interpretation);
+    if (output_control.write_field("displacement"))
+      {
+        data_out.add_data_vector(dof_handler,
+                                 current_displacement,
+                                 solution_names,
+                                 data_component_interpretation);
+      }
     // velocity
-    solution_names = std::vector<std::string>(spacedim, "velocities");
-    data_out.add_data_vector(dof_handler,
-                             current_velocity,
-                             solution_names,
-                             data_component_interpretation);
+    if (output_control.write_field("velocity"))
+      {
+        solution_names = std::vector<std::string>(spacedim, "velocities");
+        data_out.add_data_vector(dof_handler,
+                                 current_velocity,
+                                 solution_names,
+                                 data_component_interpretation);
+      }
 
     // material ID
     Vector<float> mat(triangulation.n_active_cells());
-    int i = 0;
-    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
-         ++cell)
+    if (output_control.write_field("material_id"))
       {
-        mat[i++] = cell->material_id();
+        int i = 0;
+        for (auto cell = triangulation.begin_active();
+             cell != triangulation.end();
+             ++cell)
+          {
+            mat[i++] = cell->material_id();
+          }
+        data_out.add_data_vector(mat, "material_id");
       }
-    data_out.add_data_vector(mat, "material_id");
 
     // strain and stress
-    data_out.add_data_vector(scalar_dof_handler, strain[0][0], "Exx");
-    data_out.add_data_vector(scalar_dof_handler, strain[0][1], "Exy");
-    data_out.add_data_vector(scalar_dof_handler, strain[1][1], "Eyy");
-    data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
-    data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
-    data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
-    if (spacedim == 3)
+    if (output_control.write_stress(time))
       {
-        data_out.add_data_vector(scalar_dof_handler, strain[0][2], "Exz");
-        data_out.add_data_vector(scalar_dof_handler, strain[1][2], "Eyz");
-        data_out.add_data_vector(scalar_dof_handler, strain[2][2], "Ezz");
-        data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
-        data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
-        data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+        data_out.add_data_vector(scalar_dof_handler, strain[0][0], "Exx");
+        data_out.add_data_vector(scalar_dof_handler, strain[0][1], "Exy");
+        data_out.add_data_vector(scalar_dof_handler, strain[1][1], "Eyy");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][0], "Sxx");
+        data_out.add_data_vector(scalar_dof_handler, stress[0][1], "Sxy");
+        data_out.add_data_vector(scalar_dof_handler, stress[1][1], "Syy");
+        if (spacedim == 3)
+          {
+            data_out.add_data_vector(scalar_dof_handler, strain[0][2], "Exz");
+            data_out.add_data_vector(scalar_dof_handler, strain[1][2], "Eyz");
+            data_out.add_data_vector(scalar_dof_handler, strain[2][2], "Ezz");
+            data_out.add_data_vector(scalar_dof_handler, stress[0][2], "Sxz");
+            data_out.add_data_vector(scalar_dof_handler, stress[1][2], "Syz");
+            data_out.add_data_vector(scalar_dof_handler, stress[2][2], "Szz");
+          }
       }
 
     data_out.build_patches();
@@ -197,12 +379,13 @@ namespace Solid
       basename + "-" + Utilities::int_to_string(output_index, 6) + ".vtu";
 
     std::ofstream output(filename);
+    output_control.set_flags(data_out);
     data_out.write_vtu(output);
 
     static std::vector<std::pair<double, std::string>> times_and_names;
+    static Utils::PVDRecord pvd_record(basename + ".pvd");
     times_and_names.push_back({time.current(), filename});
-    std::ofstream pvd_output(basename + ".pvd");
-    DataOutBase::write_pvd_record(pvd_output, times_and_names);
+    pvd_record.write(times_and_names);
   }
 
   template <int dim, int spacedim>
@@ -272,7 +455,8 @@ namespace Solid
   template <int dim, int spacedim>
   void SolidSolver<dim, spacedim>::run()
   {
-    triangulation.refine_global(parameters.global_refinements[1]);
+    Utils::refine_global_cached(
+      triangulation, parameters.global_refinements[1], parameters.mesh_cache);
     setup_dofs();
     initialize_system();
 
@@ -281,6 +465,12 @@ namespace Solid
     while (time.end() - time.current() > 1e-12)
       {
         run_one_step(false);
+        Utils::TimingReport::instance().record_step(time.get_timestep(),
+                                                    time.current());
+        if (reached_steady_state())
+          {
+            break;
+          }
       }
   }
 
@@ -290,6 +480,22 @@ namespace Solid
     return current_displacement;
   }
 
+  template <int dim, int spacedim>
+  bool SolidSolver<dim, spacedim>::reached_steady_state()
+  {
+    if (!steady_state.record(current_displacement, time.current()))
+      {
+        return false;
+      }
+    std::cout << "Steady state reached at t = " << time.current()
+              << ", rate of change = " << steady_state.rate() << std::endl;
+    if (!time.time_to_output())
+      {
+        output_results(time.get_timestep());
+      }
+    return true;
+  }
+
   template class SolidSolver<2>;
   template class SolidSolver<3>;
   template class SolidSolver<2, 3>;
@@ -1,33 +1,1846 @@
 #include "utilities.h"
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_tools.h>
+#include <deal.II/lac/lapack_full_matrix.h>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
 #include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <experimental/filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Utils
 {
-  bool Time::time_to_output() const
+  bool Time::reached(const double interval) const
+  {
+    if (timestep == 0)
+      {
+        return false;
+      }
+    if (interval <= 0)
+      {
+        return true;
+      }
+    // The tolerance makes a fixed step size that divides the interval hit
+    // its multiples despite the round-off in time_current.
+    const double tolerance = 1e-6;
+    return std::floor(time_current / interval + tolerance) >
+           std::floor(time_previous / interval + tolerance);
+  }
+
+  bool Time::time_to_output() const { return reached(output_interval); }
+
+  bool Time::time_to_refine() const { return reached(refinement_interval); }
+
+  bool Time::time_to_save() const { return reached(save_interval); }
+
+  bool Time::time_to_save(const double interval) const
+  {
+    return interval > 0 && reached(interval);
+  }
+
+  bool Time::time_to_output(const double interval) const
+  {
+    return timestep == 0 || interval <= 0 || reached(interval);
+  }
+
+  void Time::increment()
+  {
+    time_previous = time_current;
+    time_current += delta_t;
+    ++timestep;
+  }
+
+  void Time::set_delta_t(double delta) { delta_t = delta; }
+
+  void Time::set_state(const State &state)
+  {
+    timestep = state.timestep;
+    time_current = state.time_current;
+    time_previous = state.time_previous;
+    delta_t = state.delta_t;
+  }
+
+  double TimeStepController::next_delta_t(const double delta_t,
+                                          const double cfl,
+                                          const unsigned int iterations) const
+  {
+    double factor = cfl > 0 ? target_cfl / cfl : max_factor;
+    if (target_iterations > 0 && iterations > target_iterations)
+      {
+        factor *= static_cast<double>(target_iterations) / iterations;
+      }
+    factor = std::max(min_factor, std::min(max_factor, factor));
+    double next = std::max(min_delta_t, factor * delta_t);
+    if (max_delta_t > 0)
+      {
+        next = std::min(max_delta_t, next);
+      }
+    return next;
+  }
+
+  std::array<double, 3> bdf2_coefficients(const double delta_t,
+                                          const double previous_delta_t)
+  {
+    if (previous_delta_t <= 0)
+      {
+        return {{1, -1, 0}};
+      }
+    const double w = delta_t / previous_delta_t;
+    return {{(1 + 2 * w) / (1 + w), -(1 + w), w * w / (1 + w)}};
+  }
+
+  double ForcingTerm::next(const double residual)
+  {
+    const double gamma = 0.9;
+    const double alpha = 0.5 * (1 + std::sqrt(5.0));
+    if (previous_residual <= 0)
+      {
+        initial_residual = residual;
+        eta = std::min(0.3, max_eta);
+      }
+    else
+      {
+        const double safeguard = gamma * std::pow(eta, alpha);
+        eta = gamma * std::pow(residual / previous_residual, alpha);
+        if (safeguard > 0.1)
+          {
+            eta = std::max(eta, safeguard);
+          }
+        // Do not oversolve the last iteration.
+        if (residual > 0)
+          {
+            eta = std::max(
+              eta, 0.5 * nonlinear_tolerance * initial_residual / residual);
+          }
+      }
+    previous_residual = residual;
+    eta = std::max(min_eta, std::min(max_eta, eta));
+    return eta;
+  }
+
+  template <typename VectorType>
+  void SolutionPredictor<VectorType>::record(const VectorType &solution,
+                                             const double delta_t)
+  {
+    if (order == 0)
+      {
+        return;
+      }
+    history.push_front(solution);
+    step_sizes.push_front(delta_t);
+    if (history.size() > order + 1)
+      {
+        history.pop_back();
+        step_sizes.pop_back();
+      }
+  }
+
+  template <typename VectorType>
+  bool SolutionPredictor<VectorType>::predict(VectorType &guess,
+                                              const double delta_t) const
+  {
+    if (order == 0 || history.size() < order + 1)
+      {
+        return false;
+      }
+    // The Lagrange weights of the solutions at the end of the step, the
+    // times being counted from the latest solution.
+    auto solution = history.begin();
+    auto step = step_sizes.begin();
+    guess = *solution++;
+    if (order == 1)
+      {
+        const double ratio = delta_t / *step;
+        guess *= 1 + ratio;
+        guess.add(-ratio, *solution);
+      }
+    else
+      {
+        const double a = *step++;
+        const double b = *step;
+        guess *= (delta_t + a) * (delta_t + a + b) / (a * (a + b));
+        guess.add(-delta_t * (delta_t + a + b) / (a * b), *solution++);
+        guess.add(delta_t * (delta_t + a) / ((a + b) * b), *solution);
+      }
+    return true;
+  }
+
+  namespace
+  {
+    // Non-ghosted copies of the solutions of the steady state monitor.
+    void copy_owned(Vector<double> &dst, const Vector<double> &src)
+    {
+      dst = src;
+    }
+
+    void copy_owned(BlockVector<double> &dst, const BlockVector<double> &src)
+    {
+      dst.reinit(src, true);
+      dst = src;
+    }
+
+    void copy_owned(PETScWrappers::MPI::Vector &dst,
+                    const PETScWrappers::MPI::Vector &src)
+    {
+      dst.reinit(src.locally_owned_elements(), src.get_mpi_communicator());
+      dst = src;
+    }
+
+    void copy_owned(PETScWrappers::MPI::BlockVector &dst,
+                    const PETScWrappers::MPI::BlockVector &src)
+    {
+      std::vector<IndexSet> partitioning;
+      for (unsigned int b = 0; b < src.n_blocks(); ++b)
+        {
+          partitioning.push_back(src.block(b).locally_owned_elements());
+        }
+      dst.reinit(partitioning, src.block(0).get_mpi_communicator());
+      dst = src;
+    }
+
+    // Whether a copy still has the layout of the solution, which is checked
+    // without building index sets.
+    bool same_layout(const Vector<double> &copy, const Vector<double> &src)
+    {
+      return copy.size() == src.size();
+    }
+
+    bool same_layout(const BlockVector<double> &copy,
+                     const BlockVector<double> &src)
+    {
+      return copy.get_block_indices() == src.get_block_indices();
+    }
+
+    bool same_layout(const PETScWrappers::MPI::Vector &copy,
+                     const PETScWrappers::MPI::Vector &src)
+    {
+      return copy.size() == src.size() &&
+             copy.local_range() == src.local_range();
+    }
+
+    bool same_layout(const PETScWrappers::MPI::BlockVector &copy,
+                     const PETScWrappers::MPI::BlockVector &src)
+    {
+      if (copy.n_blocks() != src.n_blocks())
+        {
+          return false;
+        }
+      for (unsigned int b = 0; b < src.n_blocks(); ++b)
+        {
+          if (!same_layout(copy.block(b), src.block(b)))
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  } // namespace
+
+  template <typename VectorType>
+  bool SteadyStateMonitor<VectorType>::record(const VectorType &solution,
+                                              const double time)
+  {
+    if (tolerance <= 0)
+      {
+        return false;
+      }
+    // The first step, or the dofs have changed since the last one. Only then
+    // are the copies allocated, the other steps reuse them.
+    if (previous.size() == 0 || !same_layout(previous, solution))
+      {
+        copy_owned(previous, solution);
+        copy_owned(change, solution);
+        previous_time = time;
+        count = 0;
+        return false;
+      }
+    change = solution;
+    change -= previous;
+    previous = solution;
+    const double norm = previous.l2_norm();
+    last_rate = change.l2_norm() /
+                ((time - previous_time) * (norm > 0 ? norm : 1.0));
+    previous_time = time;
+    count = last_rate < tolerance ? count + 1 : 0;
+    return count >= n_steps;
+  }
+
+  void PODBasis::add_snapshot(const BlockVector<double> &snapshot)
+  {
+    AssertThrow(snapshots.empty() ||
+                  snapshots[0].get_block_indices() ==
+                    snapshot.get_block_indices(),
+                ExcMessage("The snapshots must be on the same mesh!"));
+    snapshots.push_back(snapshot);
+  }
+
+  void PODBasis::compute(const double energy, const unsigned int max_modes)
+  {
+    const unsigned int n = snapshots.size();
+    AssertThrow(n > 0, ExcMessage("There are no snapshots!"));
+    LAPACKFullMatrix<double> correlation(n, n);
+    double trace = 0;
+    for (unsigned int i = 0; i < n; ++i)
+      {
+        for (unsigned int j = 0; j <= i; ++j)
+          {
+            correlation(i, j) = snapshots[i] * snapshots[j];
+            correlation(j, i) = correlation(i, j);
+          }
+        trace += correlation(i, i);
+      }
+    Vector<double> eigenvalues;
+    FullMatrix<double> eigenvectors;
+    correlation.compute_eigenvalues_symmetric(
+      0, 2 * trace + 1, 0, eigenvalues, eigenvectors);
+
+    // The eigenvalues are in ascending order.
+    modes.clear();
+    double kept = 0;
+    for (int k = eigenvalues.size() - 1;
+         k >= 0 && modes.size() < max_modes && kept < energy * trace;
+         --k)
+      {
+        // Drop the directions lost to the round-off of the snapshots.
+        if (eigenvalues[k] <= 1e-12 * trace)
+          {
+            break;
+          }
+        BlockVector<double> mode;
+        mode.reinit(snapshots[0]);
+        for (unsigned int i = 0; i < n; ++i)
+          {
+            mode.add(eigenvectors(i, k), snapshots[i]);
+          }
+        mode /= std::sqrt(eigenvalues[k]);
+        modes.push_back(std::move(mode));
+        kept += eigenvalues[k];
+      }
+    snapshots.clear();
+  }
+
+  bool PODBasis::matches(const BlockVector<double> &layout) const
+  {
+    return !modes.empty() &&
+           modes[0].get_block_indices() == layout.get_block_indices();
+  }
+
+  void PODBasis::save(const std::string &filename) const
+  {
+    std::ofstream out(filename, std::ios::binary);
+    const auto write = [&out](const std::uint64_t value) {
+      out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    write(modes.size());
+    if (!modes.empty())
+      {
+        write(modes[0].n_blocks());
+        for (unsigned int b = 0; b < modes[0].n_blocks(); ++b)
+          {
+            write(modes[0].block(b).size());
+          }
+      }
+    for (const auto &mode : modes)
+      {
+        for (unsigned int b = 0; b < mode.n_blocks(); ++b)
+          {
+            out.write(reinterpret_cast<const char *>(mode.block(b).begin()),
+                      mode.block(b).size() * sizeof(double));
+          }
+      }
+    AssertThrow(out, ExcMessage("Cannot write " + filename + "!"));
+  }
+
+  bool PODBasis::load(const std::string &filename,
+                      const BlockVector<double> &layout)
+  {
+    modes.clear();
+    std::ifstream in(filename, std::ios::binary);
+    std::uint64_t value = 0;
+    const auto read = [&in, &value]() {
+      return static_cast<bool>(
+        in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    };
+    if (!read())
+      {
+        return false;
+      }
+    const std::uint64_t n = value;
+    if (!read() || value != layout.n_blocks())
+      {
+        return false;
+      }
+    for (unsigned int b = 0; b < layout.n_blocks(); ++b)
+      {
+        if (!read() || value != layout.block(b).size())
+          {
+            return false;
+          }
+      }
+    modes.resize(n, layout);
+    for (auto &mode : modes)
+      {
+        for (unsigned int b = 0; b < mode.n_blocks(); ++b)
+          {
+            in.read(reinterpret_cast<char *>(mode.block(b).begin()),
+                    mode.block(b).size() * sizeof(double));
+          }
+      }
+    if (!in)
+      {
+        modes.clear();
+        return false;
+      }
+    return true;
+  }
+
+  Ensemble::Ensemble(const std::string &case_file,
+                     const MPI_Comm comm,
+                     const unsigned int n_groups)
+    : n_groups(n_groups)
+  {
+    const unsigned int n_processes = Utilities::MPI::n_mpi_processes(comm);
+    AssertThrow(n_groups > 0 && n_groups <= n_processes,
+                ExcMessage("There must be between 1 and " +
+                           std::to_string(n_processes) + " groups!"));
+    std::ifstream in(case_file);
+    AssertThrow(in, ExcMessage("Cannot open " + case_file + "!"));
+    std::string line;
+    while (std::getline(in, line))
+      {
+        line = Utilities::trim(line);
+        if (line.empty() || line[0] == '#')
+          {
+            continue;
+          }
+        cases.push_back(Utilities::split_string_list(line, ';'));
+      }
+    // Contiguous ranks form a group, which keeps the groups within nodes.
+    group = Utilities::MPI::this_mpi_process(comm) * n_groups / n_processes;
+    MPI_Comm_split(comm,
+                   group,
+                   Utilities::MPI::this_mpi_process(comm),
+                   &group_communicator);
+  }
+
+  Ensemble::~Ensemble() { MPI_Comm_free(&group_communicator); }
+
+  void Ensemble::run(
+    const std::string &infile,
+    const std::function<void(const Parameters::AllParameters &,
+                             const unsigned int)> &runner) const
+  {
+    namespace fs = std::experimental::filesystem;
+    const fs::path root = fs::absolute(fs::current_path());
+    const bool group_root =
+      Utilities::MPI::this_mpi_process(group_communicator) == 0;
+    fs::path previous;
+    for (unsigned int k = group; k < cases.size(); k += n_groups)
+      {
+        Parameters::AllParameters params(fs::absolute(infile).string(),
+                                         cases[k]);
+        // Concurrent groups must not write the same cache files.
+        const fs::path mesh_cache =
+          params.mesh_cache.empty()
+            ? root / "mesh_cache" / ("group_" + std::to_string(group))
+            : fs::absolute(params.mesh_cache) /
+                ("group_" + std::to_string(group));
+        params.mesh_cache = mesh_cache.string();
+        const fs::path directory = root / ("case_" + std::to_string(k));
+        if (group_root)
+          {
+            fs::create_directories(directory);
+            if (!previous.empty() &&
+                fs::exists(previous / "solid.setup_cache"))
+              {
+                fs::copy_file(previous / "solid.setup_cache",
+                              directory / "solid.setup_cache",
+                              fs::copy_options::overwrite_existing);
+              }
+          }
+        MPI_Barrier(group_communicator);
+        fs::current_path(directory);
+        try
+          {
+            runner(params, k);
+          }
+        catch (...)
+          {
+            fs::current_path(root);
+            throw;
+          }
+        fs::current_path(root);
+        previous = directory;
+      }
+  }
+
+  bool PreconditionerReuse::need_rebuild(const double delta) const
+  {
+    return outdated || age >= max_age || delta != delta_t;
+  }
+
+  void PreconditionerReuse::rebuilt(const double delta)
+  {
+    age = 0;
+    delta_t = delta;
+    outdated = false;
+  }
+
+  void PreconditionerReuse::record(const unsigned int iterations)
+  {
+    ++age;
+    if (max_iterations > 0 && iterations > max_iterations)
+      {
+        outdated = true;
+      }
+  }
+
+  BackgroundTask::~BackgroundTask()
+  {
+    if (worker.joinable())
+      {
+        worker.join();
+      }
+  }
+
+  void BackgroundTask::run(std::function<void()> task, const bool asynchronous)
+  {
+    wait();
+    if (!asynchronous)
+      {
+        task();
+        return;
+      }
+    worker = std::thread([this, task]() {
+      try
+        {
+          task();
+        }
+      catch (...)
+        {
+          error = std::current_exception();
+        }
+    });
+  }
+
+  void BackgroundTask::wait()
+  {
+    if (worker.joinable())
+      {
+        worker.join();
+      }
+    if (error)
+      {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+      }
+  }
+
+  WriterQueue::WriterQueue(const unsigned int depth) : depth(depth), stop(false)
+  {
+  }
+
+  WriterQueue::~WriterQueue()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    changed.notify_all();
+    if (worker.joinable())
+      {
+        worker.join();
+      }
+  }
+
+  void WriterQueue::push(std::function<void()> task)
+  {
+    if (depth == 0)
+      {
+        task();
+        return;
+      }
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable())
+      {
+        worker = std::thread([this]() { work(); });
+      }
+    changed.wait(lock, [this]() { return tasks.size() < depth || error; });
+    if (error)
+      {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+      }
+    tasks.push_back(std::move(task));
+    changed.notify_all();
+  }
+
+  void WriterQueue::wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return tasks.empty(); });
+    if (error)
+      {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+      }
+  }
+
+  void WriterQueue::work()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+      {
+        changed.wait(lock, [this]() { return stop || !tasks.empty(); });
+        if (tasks.empty())
+          {
+            return;
+          }
+        // The task stays in the queue while it runs, so that it counts
+        // towards the depth.
+        std::function<void()> &task = tasks.front();
+        lock.unlock();
+        std::exception_ptr e;
+        try
+          {
+            task();
+          }
+        catch (...)
+          {
+            e = std::current_exception();
+          }
+        lock.lock();
+        if (e)
+          {
+            error = e;
+          }
+        tasks.pop_front();
+        changed.notify_all();
+      }
+  }
+
+  CheckpointIndex::CheckpointIndex(const std::string &name)
+    : filename(name + ".checkpoint_index")
+  {
+  }
+
+  int CheckpointIndex::latest(const MPI_Comm &mpi_communicator) const
+  {
+    int output_index = -1;
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        std::ifstream in(filename);
+        if (!(in >> output_index))
+          {
+            output_index = -1;
+          }
+      }
+    MPI_Bcast(&output_index, 1, MPI_INT, 0, mpi_communicator);
+    return output_index;
+  }
+
+  int CheckpointIndex::record(const int output_index) const
+  {
+    int previous = -1;
+    {
+      std::ifstream in(filename);
+      if (!(in >> previous))
+        {
+          previous = -1;
+        }
+    }
+    // Write a temporary file and rename it, which replaces the old index
+    // in one step.
+    const std::string staged = filename + ".tmp";
+    {
+      std::ofstream out(staged);
+      out << output_index << std::endl;
+      AssertThrow(out, ExcMessage("Cannot write " + staged + "!"));
+    }
+    AssertThrow(std::rename(staged.c_str(), filename.c_str()) == 0,
+                ExcMessage("Cannot update " + filename + "!"));
+    return previous;
+  }
+
+  BuddyCheckpoint::BuddyCheckpoint(const std::string &name,
+                                   const std::string &directory,
+                                   const MPI_Comm &mpi_communicator)
+    : name(name),
+      directory(directory),
+      mpi_communicator(mpi_communicator),
+      rank(Utilities::MPI::this_mpi_process(mpi_communicator))
+  {
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    MPI_Comm node_communicator;
+    const int ierr = MPI_Comm_split_type(mpi_communicator,
+                                         MPI_COMM_TYPE_SHARED,
+                                         0,
+                                         MPI_INFO_NULL,
+                                         &node_communicator);
+    AssertThrowMPI(ierr);
+    // The ranks are placed on the nodes in consecutive blocks, so the rank
+    // one node further is the largest node size away.
+    const unsigned int node_size = Utilities::MPI::max(
+      Utilities::MPI::n_mpi_processes(node_communicator), mpi_communicator);
+    MPI_Comm_free(&node_communicator);
+    keeper = (rank + node_size) % n_ranks;
+    kept = (rank + n_ranks - node_size % n_ranks) % n_ranks;
+  }
+
+  std::string BuddyCheckpoint::filename(const unsigned int owner,
+                                        const int step) const
+  {
+    return directory + "/" + name + ".buddy." + std::to_string(owner) + "." +
+           std::to_string(step);
+  }
+
+  std::vector<int> BuddyCheckpoint::find(const unsigned int owner) const
+  {
+    namespace fs = std::experimental::filesystem;
+    std::vector<int> steps;
+    if (!fs::is_directory(directory))
+      {
+        return steps;
+      }
+    const std::string prefix = name + ".buddy." + std::to_string(owner) + ".";
+    for (const auto &entry : fs::directory_iterator(directory))
+      {
+        const std::string file = entry.path().filename().string();
+        if (file.compare(0, prefix.size(), prefix) != 0)
+          {
+            continue;
+          }
+        // Skip the temporary files of an interrupted save.
+        const std::string step = file.substr(prefix.size());
+        if (step.empty() ||
+            step.find_first_not_of("0123456789") != std::string::npos)
+          {
+            continue;
+          }
+        steps.push_back(std::stoi(step));
+      }
+    return steps;
+  }
+
+  void BuddyCheckpoint::save(const int step,
+                             const std::vector<char> &part) const
+  {
+    namespace fs = std::experimental::filesystem;
+    fs::create_directories(directory);
+    auto write = [this, step](const unsigned int owner,
+                              const std::vector<char> &data) {
+      const std::string file = filename(owner, step);
+      {
+        std::ofstream out(file + ".tmp", std::ios::binary);
+        out.write(data.data(), data.size());
+        AssertThrow(out, ExcMessage("Cannot write " + file + "!"));
+      }
+      fs::rename(file + ".tmp", file);
+    };
+    write(rank, part);
+    // On a single node the copy would be lost with the part itself.
+    if (keeper != rank)
+      {
+        const std::map<unsigned int, std::vector<char>> to_keeper{
+          {keeper, part}};
+        for (const auto &copy :
+             Utilities::MPI::some_to_some(mpi_communicator, to_keeper))
+          {
+            write(copy.first, copy.second);
+          }
+      }
+    // The older checkpoint is only removed once all the parts of the new
+    // one are complete.
+    MPI_Barrier(mpi_communicator);
+    for (const unsigned int owner : {rank, kept})
+      {
+        for (const int old : find(owner))
+          {
+            if (old != step)
+              {
+                fs::remove(filename(owner, old));
+              }
+          }
+      }
+  }
+
+  int BuddyCheckpoint::latest() const
+  {
+    // The part of this rank is on this node or on the node of its keeper,
+    // which reports the copies it holds.
+    std::vector<int> steps = find(rank);
+    if (keeper != rank)
+      {
+        const std::map<unsigned int, std::vector<int>> to_kept{
+          {kept, find(kept)}};
+        for (const auto &copies :
+             Utilities::MPI::some_to_some(mpi_communicator, to_kept))
+          {
+            steps.insert(
+              steps.end(), copies.second.begin(), copies.second.end());
+          }
+      }
+    std::sort(steps.begin(), steps.end());
+    const auto all_steps = Utilities::MPI::all_gather(mpi_communicator, steps);
+    // The latest step whose parts are all available.
+    int latest = -1;
+    for (const int step : steps)
+      {
+        if (step > latest &&
+            std::all_of(all_steps.begin(),
+                        all_steps.end(),
+                        [step](const std::vector<int> &s) {
+                          return std::binary_search(s.begin(), s.end(), step);
+                        }))
+          {
+            latest = step;
+          }
+      }
+    return latest;
+  }
+
+  std::vector<char> BuddyCheckpoint::load(const int step) const
+  {
+    auto read = [this, step](const unsigned int owner,
+                             std::vector<char> &data) {
+      std::ifstream in(filename(owner, step), std::ios::binary);
+      if (!in)
+        {
+          return false;
+        }
+      data.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+      return true;
+    };
+    std::vector<char> part;
+    bool found = read(rank, part);
+    if (keeper != rank)
+      {
+        // Ask the keeper for the copy if the part is not on this node.
+        const std::map<unsigned int, int> to_keeper{{keeper, found ? 0 : 1}};
+        const auto requests =
+          Utilities::MPI::some_to_some(mpi_communicator, to_keeper);
+        std::map<unsigned int, std::vector<char>> to_kept;
+        if (requests.at(kept) == 1)
+          {
+            AssertThrow(read(kept, to_kept[kept]),
+                        ExcMessage("Cannot read " + filename(kept, step) +
+                                   "!"));
+          }
+        for (auto &copy :
+             Utilities::MPI::some_to_some(mpi_communicator, to_kept))
+          {
+            part = std::move(copy.second);
+            found = true;
+          }
+      }
+    AssertThrow(found, ExcMessage("Cannot read " + filename(rank, step) + "!"));
+    return part;
+  }
+
+  XDMFOutput::XDMFOutput(const std::string &name, const bool reuse_mesh)
+    : name(name), reuse_mesh(reuse_mesh)
+  {
+  }
+
+  template <int dim, int spacedim>
+  void XDMFOutput::write(const DataOutInterface<dim, spacedim> &data_out,
+                         const unsigned int output_index,
+                         const double time,
+                         const MPI_Comm &mpi_communicator)
+  {
+    // Merge the duplicated vertices, XDMF needs the filtered layout.
+    DataOutBase::DataOutFilter data_filter(
+      DataOutBase::DataOutFilterFlags(true, true));
+    data_out.write_filtered_data(data_filter);
+
+    const std::string suffix = Utilities::int_to_string(output_index, 6);
+    const std::string solution_filename = name + "-" + suffix + ".h5";
+    const bool write_mesh = !reuse_mesh || mesh_filename.empty();
+    if (write_mesh)
+      {
+        // A mesh that is not reused goes to the same file as the fields.
+        mesh_filename =
+          reuse_mesh ? name + "-mesh-" + suffix + ".h5" : solution_filename;
+      }
+    data_out.write_hdf5_parallel(data_filter,
+                                 write_mesh,
+                                 mesh_filename,
+                                 solution_filename,
+                                 mpi_communicator);
+    entries.push_back(data_out.create_xdmf_entry(
+      data_filter, mesh_filename, solution_filename, time, mpi_communicator));
+    data_out.write_xdmf_file(entries, name + ".xdmf", mpi_communicator);
+  }
+
+  MonitorFile::MonitorFile(const std::string &filename,
+                           const MPI_Comm &mpi_communicator)
+    : filename(filename),
+      writer(Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+  {
+  }
+
+  void MonitorFile::write(const double time,
+                          const std::vector<std::string> &columns,
+                          const std::vector<double> &values)
+  {
+    if (!writer)
+      {
+        return;
+      }
+    Assert(columns.size() == values.size(),
+           ExcDimensionMismatch(columns.size(), values.size()));
+    if (!out.is_open())
+      {
+        const bool exists = std::ifstream(filename).good();
+        out.open(filename, std::ios::app);
+        AssertThrow(out, ExcMessage("Cannot open " + filename + "!"));
+        out.precision(10);
+        if (!exists)
+          {
+            out << "time";
+            for (const auto &column : columns)
+              {
+                out << "," << column;
+              }
+            out << "\n";
+          }
+      }
+    out << time;
+    for (const double value : values)
+      {
+        out << "," << value;
+      }
+    out << std::endl;
+  }
+
+  SolverLog::SolverLog(const std::string &filename,
+                       const MPI_Comm &mpi_communicator,
+                       const bool enabled)
+    : active(enabled),
+      file(filename, mpi_communicator),
+      newton_iterations(0),
+      linear_solves(0),
+      linear_iterations(0),
+      preconditioner_setups(0),
+      preconditioner_setup_time(0),
+      linear_residual(0),
+      residual(0)
+  {
+  }
+
+  void SolverLog::add_newton_iteration(const double value)
+  {
+    ++newton_iterations;
+    residual = value;
+  }
+
+  void SolverLog::add_linear_solve(const unsigned int iterations,
+                                   const double value)
+  {
+    ++linear_solves;
+    linear_iterations += iterations;
+    linear_residual = value;
+  }
+
+  void SolverLog::add_inner_iterations(const std::string &solve,
+                                       const unsigned int iterations)
+  {
+    auto inner = std::find_if(
+      inner_iterations.begin(),
+      inner_iterations.end(),
+      [&solve](const std::pair<std::string, unsigned int> &entry) {
+        return entry.first == solve;
+      });
+    if (inner == inner_iterations.end())
+      {
+        inner_iterations.emplace_back(solve, iterations);
+      }
+    else
+      {
+        inner->second += iterations;
+      }
+  }
+
+  void SolverLog::add_preconditioner_setup(const double wall_time)
+  {
+    ++preconditioner_setups;
+    preconditioner_setup_time += wall_time;
+  }
+
+  void SolverLog::write_step(const unsigned int timestep, const double time)
+  {
+    if (active)
+      {
+        std::vector<std::string> columns{"timestep",
+                                         "newton_iterations",
+                                         "linear_solves",
+                                         "linear_iterations"};
+        std::vector<double> values{static_cast<double>(timestep),
+                                   static_cast<double>(newton_iterations),
+                                   static_cast<double>(linear_solves),
+                                   static_cast<double>(linear_iterations)};
+        for (auto &inner : inner_iterations)
+          {
+            columns.push_back(inner.first + "_iterations");
+            values.push_back(inner.second);
+            inner.second = 0;
+          }
+        columns.insert(columns.end(),
+                       {"preconditioner_setups",
+                        "preconditioner_setup_time",
+                        "linear_residual",
+                        "residual"});
+        values.insert(values.end(),
+                      {static_cast<double>(preconditioner_setups),
+                       preconditioner_setup_time,
+                       linear_residual,
+                       residual});
+        file.write(time, columns, values);
+      }
+    newton_iterations = 0;
+    linear_solves = 0;
+    linear_iterations = 0;
+    preconditioner_setups = 0;
+    preconditioner_setup_time = 0;
+    linear_residual = 0;
+    residual = 0;
+  }
+
+  TimingReport &TimingReport::instance()
+  {
+    static TimingReport report;
+    return report;
+  }
+
+  void TimingReport::add(const std::string &name,
+                         const TimerOutput &timer,
+                         const MPI_Comm &mpi_communicator,
+                         const bool enabled)
+  {
+    entries.push_back({name, &timer, mpi_communicator, enabled, {}});
+  }
+
+  std::map<std::string, Utilities::MPI::MinMaxAvg>
+  TimingReport::statistics(const std::map<std::string, double> &values,
+                           const MPI_Comm &mpi_communicator)
+  {
+    // The sections are the same on all the ranks, and so is their order.
+    std::vector<double> local;
+    for (const auto &value : values)
+      {
+        local.push_back(value.second);
+      }
+    const std::vector<Utilities::MPI::MinMaxAvg> global =
+      Utilities::MPI::min_max_avg(local, mpi_communicator);
+    std::map<std::string, Utilities::MPI::MinMaxAvg> result;
+    unsigned int i = 0;
+    for (const auto &value : values)
+      {
+        result[value.first] = global[i++];
+      }
+    return result;
+  }
+
+  void TimingReport::remove(const TimerOutput &timer)
+  {
+    auto entry = std::find_if(
+      entries.begin(), entries.end(), [&timer](const Entry &e) {
+        return e.timer == &timer;
+      });
+    timer.print_summary();
+    if (entry == entries.end())
+      {
+        return;
+      }
+    if (entry->enabled)
+      {
+        const auto wall_times = statistics(
+          timer.get_summary_data(TimerOutput::total_wall_time),
+          entry->mpi_communicator);
+        const auto n_calls = timer.get_summary_data(TimerOutput::n_calls);
+        if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+          {
+            std::ofstream out("timing-" + entry->name + ".json");
+            out.precision(6);
+            out << "{\n  \"name\": \"" << entry->name << "\",\n"
+                << "  \"ranks\": "
+                << Utilities::MPI::n_mpi_processes(entry->mpi_communicator)
+                << ",\n  \"sections\": {";
+            bool first = true;
+            for (const auto &section : wall_times)
+              {
+                out << (first ? "\n" : ",\n") << "    \"" << section.first
+                    << "\": {\"calls\": " << n_calls.at(section.first)
+                    << ", \"min\": " << section.second.min
+                    << ", \"max\": " << section.second.max
+                    << ", \"mean\": " << section.second.avg << "}";
+                first = false;
+              }
+            out << "\n  }\n}\n";
+          }
+      }
+    entries.erase(entry);
+  }
+
+  std::string TimingReport::name(const TimerOutput &timer) const
+  {
+    for (const auto &entry : entries)
+      {
+        if (entry.timer == &timer)
+          {
+            return entry.name;
+          }
+      }
+    return "";
+  }
+
+  Tracer &Tracer::instance()
+  {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  void Tracer::enable(const bool requested, const MPI_Comm &mpi_communicator)
+  {
+    if (!requested || active)
+      {
+        return;
+      }
+    MPI_Barrier(mpi_communicator);
+    start = std::chrono::steady_clock::now();
+    active = true;
+  }
+
+  double Tracer::now() const
+  {
+    return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+  }
+
+  void Tracer::record(const std::string &name,
+                      const std::string &category,
+                      const double begin,
+                      const double end)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto thread =
+      threads.emplace(std::this_thread::get_id(), threads.size()).first;
+    events.push_back({name, category, begin, end - begin, thread->second});
+  }
+
+  void Tracer::write(const MPI_Comm &mpi_communicator) const
+  {
+    if (!active)
+      {
+        return;
+      }
+    const unsigned int rank =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    // Every rank formats its own events, rank 0 joins them.
+    std::ostringstream out;
+    out.precision(3);
+    out << std::fixed;
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank
+        << ", \"args\": {\"name\": \"rank " << rank << "\"}}";
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const auto &event : events)
+        {
+          out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \""
+              << event.category << "\", \"ph\": \"X\", \"ts\": "
+              << event.begin << ", \"dur\": " << event.duration
+              << ", \"pid\": " << rank << ", \"tid\": " << event.thread
+              << "}";
+        }
+    }
+    const std::vector<std::string> ranks =
+      Utilities::MPI::gather(mpi_communicator, out.str(), 0);
+    if (rank == 0)
+      {
+        std::ofstream file("trace.json");
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        for (unsigned int i = 0; i < ranks.size(); ++i)
+          {
+            file << (i == 0 ? "" : ",\n") << ranks[i];
+          }
+        file << "\n]}\n";
+      }
+  }
+
+  TraceScope::TraceScope(const std::string &name, const std::string &category)
+    : active(Tracer::instance().enabled())
+  {
+    if (active)
+      {
+        this->name = name;
+        this->category = category;
+        begin = Tracer::instance().now();
+      }
+  }
+
+  TraceScope::~TraceScope()
+  {
+    if (active)
+      {
+        Tracer &tracer = Tracer::instance();
+        tracer.record(name, category, begin, tracer.now());
+      }
+  }
+
+  namespace
+  {
+    /// Whether a point is inside a cell as mapped by the mapping, the same
+    /// test as CellAccessor::point_inside without a mapping.
+    template <int dim, typename Iterator>
+    bool point_inside_cell(const Mapping<dim> *mapping,
+                           const Iterator &cell,
+                           const Point<dim> &point)
+    {
+      if (!mapping)
+        return cell->point_inside(point);
+      try
+        {
+          return GeometryInfo<dim>::is_inside_unit_cell(
+            mapping->transform_real_to_unit_cell(cell, point));
+        }
+      catch (const typename Mapping<dim>::ExcTransformationFailed &)
+        {
+          return false;
+        }
+    }
+
+    /// Initialized when the library is loaded, before main().
+    const std::chrono::steady_clock::time_point program_start =
+      std::chrono::steady_clock::now();
+  } // namespace
+
+  StartupProfile::StartupProfile()
+    : start(program_start), depth(0), steps_begin(-1), reported(false)
+  {
+  }
+
+  StartupProfile &StartupProfile::instance()
+  {
+    static StartupProfile profile;
+    return profile;
+  }
+
+  double StartupProfile::elapsed() const
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+      .count();
+  }
+
+  unsigned int StartupProfile::enter() { return depth++; }
+
+  void StartupProfile::leave(const std::string &section,
+                             const unsigned int section_depth,
+                             const double wall_time)
+  {
+    --depth;
+    const bool in_first_step = steps_begin >= 0;
+    auto entry = std::find_if(
+      sections.begin(), sections.end(), [&](const Section &s) {
+        return s.name == section && s.in_first_step == in_first_step;
+      });
+    if (entry == sections.end())
+      {
+        sections.push_back({section, section_depth, in_first_step, 0, 0.});
+        entry = std::prev(sections.end());
+      }
+    ++entry->calls;
+    entry->wall_time += wall_time;
+  }
+
+  void StartupProfile::begin_steps()
+  {
+    if (steps_begin < 0)
+      {
+        steps_begin = elapsed();
+      }
+  }
+
+  void StartupProfile::report(const MPI_Comm &mpi_communicator,
+                              std::ostream &out)
+  {
+    if (reported)
+      {
+        return;
+      }
+    reported = true;
+    const double first_step = elapsed() - steps_begin;
+    // The sections are followed by the unmarked rest of the startup, the
+    // startup and the first step.
+    std::vector<double> local;
+    double marked = 0;
+    for (const auto &section : sections)
+      {
+        local.push_back(section.wall_time);
+        if (!section.in_first_step && section.depth == 0)
+          {
+            marked += section.wall_time;
+          }
+      }
+    local.insert(local.end(), {steps_begin - marked, steps_begin, first_step});
+    const std::vector<Utilities::MPI::MinMaxAvg> global =
+      Utilities::MPI::min_max_avg(local, mpi_communicator);
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      {
+        return;
+      }
+
+    std::vector<std::string> names;
+    std::vector<unsigned int> calls;
+    for (const auto &section : sections)
+      {
+        names.push_back(std::string(2 * section.depth, ' ') + section.name);
+        calls.push_back(section.calls);
+      }
+    unsigned int width = std::string("unmarked, incl. main()").size();
+    for (const auto &name : names)
+      {
+        width = std::max(width, static_cast<unsigned int>(name.size()) + 2);
+      }
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    auto print = [&](const std::string &name,
+                     const unsigned int n_calls,
+                     const Utilities::MPI::MinMaxAvg &time) {
+      out << "  " << std::left << std::setw(width) << name << std::right
+          << std::setw(8) << (n_calls > 0 ? std::to_string(n_calls) : "")
+          << std::setw(12) << time.min << std::setw(12) << time.max << "\n";
+    };
+    out << "Startup [s] over "
+        << Utilities::MPI::n_mpi_processes(mpi_communicator) << " rank(s):\n"
+        << "  " << std::left << std::setw(width) << "section" << std::right
+        << std::setw(8) << "calls" << std::setw(12) << "min" << std::setw(12)
+        << "max" << "\n"
+        << std::fixed << std::setprecision(3);
+    const unsigned int n = sections.size();
+    for (unsigned int i = 0; i < n; ++i)
+      {
+        if (!sections[i].in_first_step)
+          {
+            print("  " + names[i], calls[i], global[i]);
+          }
+      }
+    print("  unmarked, incl. main()", 0, global[n]);
+    print("to the first step", 0, global[n + 1]);
+    for (unsigned int i = 0; i < n; ++i)
+      {
+        if (sections[i].in_first_step)
+          {
+            print("  " + names[i], calls[i], global[i]);
+          }
+      }
+    print("first step", 0, global[n + 2]);
+    out << std::flush;
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+  StartupScope::StartupScope(const std::string &section)
+    : active(StartupProfile::instance().recording()),
+      section(section),
+      depth(active ? StartupProfile::instance().enter() : 0),
+      trace(section, "startup")
+  {
+  }
+
+  StartupScope::~StartupScope()
+  {
+    if (active)
+      {
+        StartupProfile::instance().leave(section, depth, timer.wall_time());
+      }
+  }
+
+  TimerScope::TimerScope(TimerOutput &timer, const std::string &section)
+    : scope(timer, section),
+      trace(section, TimingReport::instance().name(timer))
+  {
+#ifdef PETSC_USE_LOG
+    const std::string timer_name = TimingReport::instance().name(timer);
+    const PetscErrorCode ierr = PetscLogStagePush(
+      stage(timer_name.empty() ? section : timer_name + ": " + section));
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+#endif
+  }
+
+  TimerScope::~TimerScope()
+  {
+#ifdef PETSC_USE_LOG
+    PetscLogStagePop();
+#endif
+  }
+
+#ifdef PETSC_USE_LOG
+  PetscLogStage TimerScope::stage(const std::string &name)
+  {
+    static std::map<std::string, PetscLogStage> stages;
+    auto it = stages.find(name);
+    if (it == stages.end())
+      {
+        PetscLogStage stage;
+        const PetscErrorCode ierr =
+          PetscLogStageRegister(name.c_str(), &stage);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        it = stages.emplace(name, stage).first;
+      }
+    return it->second;
+  }
+#endif
+
+  void TimingReport::record_step(const unsigned int timestep,
+                                 const double time)
+  {
+    const bool writer = Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0;
+    for (auto &entry : entries)
+      {
+        if (!entry.enabled)
+          {
+            continue;
+          }
+        std::map<std::string, double> step_times =
+          entry.timer->get_summary_data(TimerOutput::total_wall_time);
+        const std::map<std::string, double> totals = step_times;
+        for (auto &section : step_times)
+          {
+            section.second -= entry.recorded[section.first];
+          }
+        entry.recorded = totals;
+        const auto step_statistics =
+          statistics(step_times, entry.mpi_communicator);
+        if (!writer)
+          {
+            continue;
+          }
+        if (!steps.is_open())
+          {
+            steps.open("timing_steps.csv");
+            steps << "timestep,time,timer,section,min,max,mean\n";
+          }
+        for (const auto &section : step_statistics)
+          {
+            steps << timestep << "," << time << "," << entry.name << ","
+                  << section.first << "," << section.second.min << ","
+                  << section.second.max << "," << section.second.avg << "\n";
+          }
+      }
+    if (steps.is_open())
+      {
+        steps.flush();
+      }
+  }
+
+  MemoryReport::MemoryReport(const std::string &title,
+                             const MPI_Comm &mpi_communicator)
+    : title(title), mpi_communicator(mpi_communicator)
+  {
+  }
+
+  void MemoryReport::add(const std::string &component,
+                         const std::size_t bytes)
+  {
+    components.emplace_back(component, static_cast<double>(bytes));
+  }
+
+  namespace
+  {
+    // The proportional set size of this process in bytes, read from
+    // /proc/self/smaps_rollup, or the given resident set size if it is not
+    // available.
+    double proportional_set_size(const double rss)
+    {
+      std::ifstream smaps("/proc/self/smaps_rollup");
+      std::string key;
+      double kb;
+      while (smaps >> key)
+        {
+          if (key == "Pss:" && smaps >> kb)
+            {
+              return 1024. * kb;
+            }
+          smaps.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+      return rss;
+    }
+  } // namespace
+
+  void MemoryReport::print(std::ostream &out) const
+  {
+    const double mb = 1024. * 1024.;
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats(stats);
+    // The statistics are in kB.
+    const double rss = 1024. * stats.VmRSS;
+
+    // The resident sets of the ranks of a node count the pages they share,
+    // such as a NodeSharedArray, once per rank. The proportional set sizes
+    // split them, so their sum over a node is the memory of the node.
+    MPI_Comm node_communicator;
+    int ierr = MPI_Comm_split_type(mpi_communicator,
+                                   MPI_COMM_TYPE_SHARED,
+                                   0,
+                                   MPI_INFO_NULL,
+                                   &node_communicator);
+    AssertThrowMPI(ierr);
+    const double node_memory =
+      Utilities::MPI::sum(proportional_set_size(rss), node_communicator) / mb;
+    const bool node_leader =
+      Utilities::MPI::this_mpi_process(node_communicator) == 0;
+    ierr = MPI_Comm_free(&node_communicator);
+    AssertThrowMPI(ierr);
+    const double n_nodes =
+      Utilities::MPI::sum(node_leader ? 1. : 0., mpi_communicator);
+    const double node_min = Utilities::MPI::min(
+      node_leader ? node_memory : std::numeric_limits<double>::max(),
+      mpi_communicator);
+    const double node_max =
+      Utilities::MPI::max(node_leader ? node_memory : 0., mpi_communicator);
+    const double node_total =
+      Utilities::MPI::sum(node_leader ? node_memory : 0., mpi_communicator);
+    std::vector<double> local;
+    double tracked = 0;
+    for (const auto &component : components)
+      {
+        local.push_back(component.second / mb);
+        tracked += component.second;
+      }
+    local.push_back(std::max(rss - tracked, 0.) / mb);
+    local.push_back(rss / mb);
+    local.push_back(1024. * stats.VmHWM / mb);
+    const std::vector<Utilities::MPI::MinMaxAvg> global =
+      Utilities::MPI::min_max_avg(local, mpi_communicator);
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      {
+        return;
+      }
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    std::vector<std::string> names;
+    for (const auto &component : components)
+      {
+        names.push_back(component.first);
+      }
+    names.insert(names.end(), {"untracked", "resident set", "peak resident"});
+    unsigned int width = 0;
+    for (const auto &name : names)
+      {
+        width = std::max(width, static_cast<unsigned int>(name.size()));
+      }
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << title << " memory [MB] over " << n_ranks << " rank(s):\n"
+        << "  " << std::left << std::setw(width) << "component" << std::right
+        << std::setw(12) << "min" << std::setw(12) << "max" << std::setw(12)
+        << "total" << "\n"
+        << std::fixed << std::setprecision(2);
+    for (unsigned int i = 0; i < names.size(); ++i)
+      {
+        out << "  " << std::left << std::setw(width) << names[i] << std::right
+            << std::setw(12) << global[i].min << std::setw(12)
+            << global[i].max << std::setw(12) << global[i].sum << "\n";
+      }
+    out << "  " << std::left << std::setw(width) << "node memory" << std::right
+        << std::setw(12) << node_min << std::setw(12) << node_max
+        << std::setw(12) << node_total << "  over "
+        << static_cast<unsigned int>(n_nodes) << " node(s)\n";
+    out << std::flush;
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+  PVDRecord::PVDRecord(const std::string &filename) : filename(filename) {}
+
+  void PVDRecord::write(
+    const std::vector<std::pair<double, std::string>> &times_and_names)
+  {
+    // The same layout as DataOutBase::write_pvd_record.
+    const std::string closing = "  </Collection>\n</VTKFile>\n";
+    std::ostringstream records;
+    records.precision(12);
+    const bool start = offsets.empty();
+    if (start)
+      {
+        records << "<?xml version=\"1.0\"?>\n"
+                << "<VTKFile type=\"Collection\" version=\"0.1\" "
+                << "ByteOrder=\"LittleEndian\">\n"
+                << "  <Collection>\n";
+        offsets.push_back(static_cast<std::streamoff>(records.tellp()));
+      }
+    const std::size_t kept =
+      std::min(offsets.size() - 1, times_and_names.size());
+    offsets.resize(kept + 1);
+    const std::uint64_t first = start ? 0 : offsets.back();
+    for (std::size_t i = kept; i < times_and_names.size(); ++i)
+      {
+        records << "    <DataSet timestep=\"" << times_and_names[i].first
+                << "\" group=\"\" part=\"0\" file=\""
+                << times_and_names[i].second << "\"/>\n";
+        offsets.push_back(first +
+                          static_cast<std::streamoff>(records.tellp()));
+      }
+    records << closing;
+
+    {
+      std::fstream out;
+      if (start)
+        {
+          out.open(filename, std::ios::out | std::ios::trunc);
+        }
+      else
+        {
+          out.open(filename, std::ios::in | std::ios::out);
+          out.seekp(first);
+        }
+      out << records.str();
+      AssertThrow(out, ExcMessage("Cannot write " + filename + "!"));
+    }
+    // Drop what is left of the records that were cut.
+    std::experimental::filesystem::resize_file(
+      filename, offsets.back() + closing.size());
+  }
+
+  BoundaryDataTable::BoundaryDataTable(const std::string &filename)
+  {
+    if (filename.empty())
+      {
+        return;
+      }
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    AssertThrow(fd >= 0, ExcMessage("Cannot open " + filename + "!"));
+    struct stat status;
+    AssertThrow(fstat(fd, &status) == 0,
+                ExcMessage("Cannot read the size of " + filename + "!"));
+    mapping_size = status.st_size;
+    const std::size_t header_size = 8 + 3 * sizeof(std::uint64_t);
+    AssertThrow(mapping_size >= header_size,
+                ExcMessage(filename + " is not a boundary data table!"));
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    AssertThrow(mapping != MAP_FAILED,
+                ExcMessage("Cannot map " + filename + "!"));
+
+    const char *data = static_cast<const char *>(mapping);
+    AssertThrow(std::string(data, 8) == "OIFEMBDT",
+                ExcMessage(filename + " is not a boundary data table!"));
+    const std::uint64_t *sizes =
+      reinterpret_cast<const std::uint64_t *>(data + 8);
+    const std::uint64_t n_boundaries = sizes[0];
+    components = sizes[1];
+    n_times = sizes[2];
+    AssertThrow(n_times > 0 && components > 0,
+                ExcMessage(filename + " is empty!"));
+    AssertThrow(mapping_size ==
+                  header_size + n_boundaries * sizeof(std::uint64_t) +
+                    n_times * (1 + n_boundaries * components) *
+                      sizeof(double),
+                ExcMessage(filename + " is truncated!"));
+    for (unsigned int b = 0; b < n_boundaries; ++b)
+      {
+        boundaries[sizes[3 + b]] = b;
+      }
+    times = reinterpret_cast<const double *>(sizes + 3 + n_boundaries);
+    values = times + n_times;
+    AssertThrow(std::is_sorted(times, times + n_times),
+                ExcMessage("The times in " + filename + " must increase!"));
+  }
+
+  BoundaryDataTable::~BoundaryDataTable()
+  {
+    if (mapping)
+      {
+        munmap(mapping, mapping_size);
+      }
+  }
+
+  bool BoundaryDataTable::has_boundary(const unsigned int boundary_id) const
   {
-    auto delta = static_cast<unsigned int>(output_interval / delta_t);
-    return (timestep >= delta && timestep % delta == 0);
+    return boundaries.find(boundary_id) != boundaries.end();
   }
 
-  bool Time::time_to_refine() const
+  void BoundaryDataTable::value(const unsigned int boundary_id,
+                                const double time,
+                                std::vector<double> &result) const
   {
-    auto delta = static_cast<unsigned int>(refinement_interval / delta_t);
-    return (timestep >= delta && timestep % delta == 0);
+    auto boundary = boundaries.find(boundary_id);
+    if (boundary == boundaries.end())
+      {
+        return;
+      }
+    // The values given in the parameters have the expected size.
+    AssertThrow(result.size() == components,
+                ExcDimensionMismatch(result.size(), components));
+    const std::size_t offset = boundary->second * components;
+    const std::size_t stride = boundaries.size() * components;
+    if (n_times == 1 || time <= times[0] || time >= times[n_times - 1])
+      {
+        const std::size_t t = time <= times[0] ? 0 : n_times - 1;
+        std::copy(values + t * stride + offset,
+                  values + t * stride + offset + components,
+                  result.begin());
+        return;
+      }
+    // Search only if the time is not in the last interval or the next one.
+    std::size_t i = interval.load(std::memory_order_relaxed);
+    if (!(times[i] <= time && time < times[i + 1]))
+      {
+        if (i + 2 < n_times && times[i + 1] <= time && time < times[i + 2])
+          {
+            ++i;
+          }
+        else
+          {
+            i = std::upper_bound(times, times + n_times, time) - times - 1;
+          }
+        interval.store(i, std::memory_order_relaxed);
+      }
+    const double w = (time - times[i]) / (times[i + 1] - times[i]);
+    const double *lower = values + i * stride + offset;
+    const double *upper = lower + stride;
+    for (unsigned int c = 0; c < components; ++c)
+      {
+        result[c] = (1 - w) * lower[c] + w * upper[c];
+      }
   }
 
-  bool Time::time_to_save() const
+  void BoundaryDataTable::write(const std::string &filename,
+                                const std::vector<unsigned int> &boundary_ids,
+                                const std::vector<double> &times,
+                                const std::vector<double> &values)
   {
-    auto delta = static_cast<unsigned int>(save_interval / delta_t);
-    return (timestep >= delta && timestep % delta == 0);
+    AssertThrow(!boundary_ids.empty() && !times.empty() &&
+                  values.size() % (boundary_ids.size() * times.size()) == 0,
+                ExcMessage("Inconsistent boundary data table!"));
+    const std::uint64_t sizes[] = {
+      boundary_ids.size(),
+      values.size() / (boundary_ids.size() * times.size()),
+      times.size()};
+    std::ofstream out(filename, std::ios::binary);
+    out.write("OIFEMBDT", 8);
+    out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+    for (const unsigned int id : boundary_ids)
+      {
+        const std::uint64_t id_64 = id;
+        out.write(reinterpret_cast<const char *>(&id_64), sizeof(id_64));
+      }
+    out.write(reinterpret_cast<const char *>(times.data()),
+              times.size() * sizeof(double));
+    out.write(reinterpret_cast<const char *>(values.data()),
+              values.size() * sizeof(double));
+    AssertThrow(out, ExcMessage("Cannot write " + filename + "!"));
   }
 
-  void Time::increment()
+  template <int dim, int spacedim>
+  typename FilteredDataOut<dim, spacedim>::cell_iterator
+  FilteredDataOut<dim, spacedim>::first_cell()
   {
-    time_current += delta_t;
-    ++timestep;
+    return skip(this->triangulation->begin_active());
   }
 
-  void Time::set_delta_t(double delta) { delta_t = delta; }
+  template <int dim, int spacedim>
+  typename FilteredDataOut<dim, spacedim>::cell_iterator
+  FilteredDataOut<dim, spacedim>::next_cell(const cell_iterator &cell)
+  {
+    typename Triangulation<dim, spacedim>::active_cell_iterator next = cell;
+    return skip(++next);
+  }
+
+  template <int dim, int spacedim>
+  typename FilteredDataOut<dim, spacedim>::cell_iterator
+  FilteredDataOut<dim, spacedim>::skip(
+    typename Triangulation<dim, spacedim>::active_cell_iterator cell) const
+  {
+    while (cell != this->triangulation->end() && !filter(cell))
+      {
+        ++cell;
+      }
+    return cell;
+  }
+
+  template <int dim, int spacedim>
+  std::function<void()>
+  FilteredDataOut<dim, spacedim>::vtu_task(
+    const std::string &filename, const DataOutBase::VtkFlags &flags) const
+  {
+    return [filename,
+            flags,
+            patches = this->get_patches(),
+            names = this->get_dataset_names(),
+            ranges = this->get_nonscalar_data_ranges()]() {
+      std::ofstream output(filename);
+      DataOutBase::write_vtu(patches, names, ranges, flags, output);
+      AssertThrow(output, ExcMessage("Cannot write " + filename + "!"));
+    };
+  }
+
+  OutputControl::OutputControl(const Parameters::AllParameters &parameters)
+    : fields(parameters.output_fields),
+      box(parameters.output_box),
+      material_ids(parameters.output_material_ids),
+      compression(parameters.output_compression),
+      stress_interval(parameters.stress_output_interval)
+  {
+  }
+
+  bool OutputControl::write_field(const std::string &name) const
+  {
+    return fields.empty() ||
+           std::find(fields.begin(), fields.end(), name) != fields.end();
+  }
+
+  bool OutputControl::write_stress(const Time &time) const
+  {
+    return write_field("stress") && time.time_to_output(stress_interval);
+  }
+
+  DataOutBase::VtkFlags OutputControl::vtk_flags() const
+  {
+    DataOutBase::VtkFlags flags;
+    if (compression == "None")
+      {
+        flags.compression_level = DataOutBase::VtkFlags::no_compression;
+      }
+    else if (compression == "Best speed")
+      {
+        flags.compression_level = DataOutBase::VtkFlags::best_speed;
+      }
+    else if (compression == "Best compression")
+      {
+        flags.compression_level = DataOutBase::VtkFlags::best_compression;
+      }
+    return flags;
+  }
+
+  template <int dim, int spacedim>
+  void OutputControl::set_flags(DataOutInterface<dim, spacedim> &data_out) const
+  {
+    data_out.set_flags(vtk_flags());
+  }
 
   template <int dim, typename VectorType>
   SPHInterpolator<dim, VectorType>::SPHInterpolator(
@@ -48,10 +1861,28 @@ namespace Utils
       }
   }
 
+  template <int dim, typename VectorType>
+  SPHInterpolator<dim, VectorType>::SPHInterpolator(
+    const DoFHandler<dim> &dof_handler,
+    const Point<dim> &point,
+    const CellCenterHash<dim> &cell_hash)
+    : dof_handler(dof_handler), target(point)
+  {
+    cell_hash.find_sources(target, sources);
+  }
+
   template <int dim, typename VectorType>
   double SPHInterpolator<dim, VectorType>::cubic_spline(const Point<dim> &pi,
                                                         const Point<dim> &pj,
                                                         double h)
+  {
+    return CellCenterHash<dim>::cubic_spline(pi, pj, h);
+  }
+
+  template <int dim>
+  double CellCenterHash<dim>::cubic_spline(const Point<dim> &pi,
+                                           const Point<dim> &pj,
+                                           const double h)
   {
     double w(0.);
     double q = pi.distance(pj) / h;
@@ -68,7 +1899,572 @@ namespace Utils
             w = coef * (1 - 1.5 * q * q + 0.75 * q * q * q);
           }
       }
-    return w;
+    return w;
+  }
+
+  void GhostUpdate::start(PETScWrappers::MPI::BlockVector &ghosted,
+                          const PETScWrappers::MPI::BlockVector &owned)
+  {
+    AssertThrow(vector == nullptr,
+                ExcMessage("A ghost update is already in flight!"));
+    for (unsigned int b = 0; b < ghosted.n_blocks(); ++b)
+      {
+        // The global form of a ghosted vector holds the owned values only.
+        PetscErrorCode ierr = VecCopy(owned.block(b), ghosted.block(b));
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = VecGhostUpdateBegin(
+          ghosted.block(b), INSERT_VALUES, SCATTER_FORWARD);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    vector = &ghosted;
+  }
+
+  void GhostUpdate::finish()
+  {
+    if (!vector)
+      return;
+    for (unsigned int b = 0; b < vector->n_blocks(); ++b)
+      {
+        const PetscErrorCode ierr = VecGhostUpdateEnd(
+          vector->block(b), INSERT_VALUES, SCATTER_FORWARD);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    vector = nullptr;
+  }
+
+  void compress_add(
+    std::initializer_list<PETScWrappers::MPI::BlockSparseMatrix *> matrices,
+    std::initializer_list<PETScWrappers::MPI::BlockVector *> vectors)
+  {
+    std::vector<Mat> mats;
+    for (auto matrix : matrices)
+      {
+        for (unsigned int i = 0; i < matrix->n_block_rows(); ++i)
+          {
+            for (unsigned int j = 0; j < matrix->n_block_cols(); ++j)
+              {
+                mats.push_back(matrix->block(i, j));
+              }
+          }
+      }
+    std::vector<Vec> vecs;
+    for (auto vector : vectors)
+      {
+        for (unsigned int b = 0; b < vector->n_blocks(); ++b)
+          {
+            vecs.push_back(vector->block(b));
+          }
+      }
+    PetscErrorCode ierr;
+    for (auto mat : mats)
+      {
+        ierr = MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    for (auto vec : vecs)
+      {
+        ierr = VecAssemblyBegin(vec);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    for (auto mat : mats)
+      {
+        ierr = MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    for (auto vec : vecs)
+      {
+        ierr = VecAssemblyEnd(vec);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+  }
+
+  unsigned int extract_n_threads(int &argc, char **argv)
+  {
+    unsigned int n_threads = 1;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i)
+      {
+        const std::string arg(argv[i]);
+        std::string value;
+        if (arg == "--threads")
+          {
+            AssertThrow(i + 1 < argc,
+                        ExcMessage("--threads needs a number of threads!"));
+            value = argv[++i];
+          }
+        else if (arg.compare(0, 10, "--threads=") == 0)
+          {
+            value = arg.substr(10);
+          }
+        else
+          {
+            argv[kept++] = argv[i];
+            continue;
+          }
+        const int n = Utilities::string_to_int(value);
+        AssertThrow(n >= 0,
+                    ExcMessage("The number of threads must not be negative!"));
+        n_threads = (n == 0 ? numbers::invalid_unsigned_int : n);
+      }
+    argc = kept;
+    argv[argc] = nullptr;
+    return n_threads;
+  }
+
+  std::string parallel_configuration(const MPI_Comm &mpi_communicator)
+  {
+    std::ostringstream out;
+    out << Utilities::MPI::n_mpi_processes(mpi_communicator)
+        << " MPI rank(s) with " << MultithreadInfo::n_threads()
+        << " thread(s) each";
+    return out.str();
+  }
+
+  MPI_Comm group_communicator(const MPI_Comm &mpi_communicator,
+                              const unsigned int group_size)
+  {
+    const unsigned int n_mpi_processes =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    const unsigned int this_mpi_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const unsigned int size = (group_size == 0 || group_size > n_mpi_processes)
+                                ? n_mpi_processes
+                                : group_size;
+    AssertThrow(n_mpi_processes % size == 0,
+                ExcMessage("The number of processes must be a multiple of "
+                           "the group size!"));
+    MPI_Comm group;
+    const int ierr = MPI_Comm_split(
+      mpi_communicator, this_mpi_process / size, this_mpi_process, &group);
+    AssertThrowMPI(ierr);
+    return group;
+  }
+
+  MPI_Comm split_communicator(const MPI_Comm &mpi_communicator,
+                              const unsigned int n_first)
+  {
+    const unsigned int this_mpi_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    AssertThrow(n_first > 0 &&
+                  n_first < Utilities::MPI::n_mpi_processes(mpi_communicator),
+                ExcMessage("Both parts of the communicator must be nonempty!"));
+    MPI_Comm part;
+    const int ierr = MPI_Comm_split(mpi_communicator,
+                                    this_mpi_process < n_first ? 0 : 1,
+                                    this_mpi_process,
+                                    &part);
+    AssertThrowMPI(ierr);
+    return part;
+  }
+
+  std::map<unsigned int, std::vector<double>>
+  exchange_doubles(MPI_Comm mpi_communicator,
+                   const std::map<unsigned int, std::vector<double>> &send)
+  {
+    const unsigned int this_mpi_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    std::map<unsigned int, std::vector<double>> to_others(send), received;
+    auto self = to_others.find(this_mpi_process);
+    if (self != to_others.end())
+      {
+        received[this_mpi_process] = self->second;
+        to_others.erase(self);
+      }
+    for (auto &message :
+         Utilities::MPI::some_to_some(mpi_communicator, to_others))
+      {
+        received[message.first] = std::move(message.second);
+      }
+    return received;
+  }
+
+  template <int dim, typename VectorType>
+  RemotePointEvaluator<dim, VectorType>::RemotePointEvaluator(
+    const DoFHandler<dim> &dof_handler, MPI_Comm mpi_communicator)
+    : dof_handler(&dof_handler),
+      n_components(dof_handler.get_fe().n_components()),
+      mpi_communicator(mpi_communicator),
+      this_mpi_process(Utilities::MPI::this_mpi_process(mpi_communicator))
+  {
+  }
+
+  template <int dim, typename VectorType>
+  RemotePointEvaluator<dim, VectorType>::RemotePointEvaluator(
+    const unsigned int n_components, MPI_Comm mpi_communicator)
+    : dof_handler(nullptr),
+      n_components(n_components),
+      mpi_communicator(mpi_communicator),
+      this_mpi_process(Utilities::MPI::this_mpi_process(mpi_communicator))
+  {
+  }
+
+  template <int dim, typename VectorType>
+  bool RemotePointEvaluator<dim, VectorType>::found_locally(
+    const unsigned int k) const
+  {
+    return interpolator->found_cell(k) &&
+           interpolator->get_cell(k)->is_locally_owned();
+  }
+
+  template <int dim, typename VectorType>
+  void RemotePointEvaluator<dim, VectorType>::reinit(
+    const std::vector<Point<dim>> &points, const UpdateFlags flags)
+  {
+    const unsigned int n_mpi_processes =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    // The bounding box of the locally owned cells, which is empty
+    // (lower > upper) if there is no such cell or no mesh.
+    std::vector<bool> owned_vertices;
+    std::vector<double> box(2 * dim);
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        box[d] = std::numeric_limits<double>::max();
+        box[dim + d] = std::numeric_limits<double>::lowest();
+      }
+    if (dof_handler)
+      {
+        owned_vertices.assign(dof_handler->get_triangulation().n_vertices(),
+                              false);
+        for (auto cell = dof_handler->begin_active();
+             cell != dof_handler->end();
+             ++cell)
+          {
+            if (!cell->is_locally_owned())
+              continue;
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                owned_vertices[cell->vertex_index(v)] = true;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    box[d] = std::min(box[d], cell->vertex(v)[d]);
+                    box[dim + d] = std::max(box[dim + d], cell->vertex(v)[d]);
+                  }
+              }
+          }
+      }
+    std::vector<double> all_boxes(2 * dim * n_mpi_processes);
+    MPI_Allgather(box.data(),
+                  2 * dim,
+                  MPI_DOUBLE,
+                  all_boxes.data(),
+                  2 * dim,
+                  MPI_DOUBLE,
+                  mpi_communicator);
+    rank_boxes.resize(n_mpi_processes);
+    for (unsigned int r = 0; r < n_mpi_processes; ++r)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            rank_boxes[r].first[d] = all_boxes[2 * dim * r + d];
+            rank_boxes[r].second[d] = all_boxes[2 * dim * r + dim + d];
+          }
+        // Slightly enlarge the non-empty boxes for the points on the boundary.
+        const double padding =
+          1e-8 * rank_boxes[r].first.distance(rank_boxes[r].second);
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            if (rank_boxes[r].first[d] <= rank_boxes[r].second[d])
+              {
+                rank_boxes[r].first[d] -= padding;
+                rank_boxes[r].second[d] += padding;
+              }
+          }
+      }
+
+    // Send every point to the ranks whose boxes contain it.
+    requested.clear();
+    std::map<unsigned int, std::vector<double>> send_points;
+    for (unsigned int i = 0; i < points.size(); ++i)
+      {
+        for (unsigned int r = 0; r < n_mpi_processes; ++r)
+          {
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                if (points[i][d] < rank_boxes[r].first[d] ||
+                    points[i][d] > rank_boxes[r].second[d])
+                  {
+                    inside = false;
+                    break;
+                  }
+              }
+            if (!inside)
+              continue;
+            requested[r].push_back(i);
+            for (unsigned int d = 0; d < dim; ++d)
+              send_points[r].push_back(points[i][d]);
+          }
+      }
+    auto received = exchange_doubles(mpi_communicator, send_points);
+
+    // Locate the received points in the locally owned cells.
+    std::vector<Point<dim>> served_points;
+    served_begin.clear();
+    served_size.clear();
+    for (const auto &message : received)
+      {
+        served_begin[message.first] = served_points.size();
+        served_size[message.first] = message.second.size() / dim;
+        for (unsigned int k = 0; k < message.second.size() / dim; ++k)
+          {
+            Point<dim> p;
+            for (unsigned int d = 0; d < dim; ++d)
+              p[d] = message.second[k * dim + d];
+            served_points.push_back(p);
+          }
+      }
+    // Nothing is sent to a rank without the mesh.
+    if (dof_handler)
+      {
+        interpolator.reset(new BatchedGridInterpolator<dim, VectorType>(
+          *dof_handler, owned_vertices));
+        interpolator->reinit(served_points, {}, flags);
+      }
+
+    // Report which points are found.
+    std::map<unsigned int, std::vector<double>> send_found;
+    for (const auto &begin : served_begin)
+      {
+        auto &found = send_found[begin.first];
+        for (unsigned int k = 0; k < served_size[begin.first]; ++k)
+          found.push_back(found_locally(begin.second + k) ? 1 : 0);
+      }
+    auto found = exchange_doubles(mpi_communicator, send_found);
+
+    // The lowest rank that finds a point owns it, note that std::map
+    // is sorted by rank.
+    point_owner.assign(points.size(), numbers::invalid_unsigned_int);
+    point_position.assign(points.size(), 0);
+    for (const auto &message : found)
+      {
+        const auto &indices = requested[message.first];
+        unsigned int position = 0;
+        for (unsigned int k = 0; k < message.second.size(); ++k)
+          {
+            if (message.second[k] == 0)
+              continue;
+            const unsigned int i = indices[k];
+            if (point_owner[i] == numbers::invalid_unsigned_int)
+              {
+                point_owner[i] = message.first;
+                point_position[i] = position;
+              }
+            ++position;
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void RemotePointEvaluator<dim, VectorType>::point_values(
+    const std::vector<const VectorType *> &fe_functions,
+    std::vector<std::vector<Vector<double>>> &values)
+  {
+    Assert(interpolator || !dof_handler,
+           ExcMessage("reinit must be called first!"));
+    const unsigned int n_values = fe_functions.size() * n_components;
+    std::vector<std::vector<Vector<typename VectorType::value_type>>>
+      served_values;
+    if (interpolator)
+      interpolator->point_values(fe_functions, served_values);
+
+    // Send back the values at the points found on this rank.
+    std::map<unsigned int, std::vector<double>> send_values;
+    for (const auto &begin : served_begin)
+      {
+        auto &buffer = send_values[begin.first];
+        for (unsigned int k = begin.second;
+             k < begin.second + served_size[begin.first];
+             ++k)
+          {
+            if (!found_locally(k))
+              continue;
+            for (unsigned int f = 0; f < fe_functions.size(); ++f)
+              for (unsigned int c = 0; c < n_components; ++c)
+                buffer.push_back(served_values[f][k][c]);
+          }
+      }
+    auto received = exchange_doubles(mpi_communicator, send_values);
+
+    values.resize(fe_functions.size());
+    for (auto &v : values)
+      {
+        v.resize(point_owner.size());
+        for (auto &point_value : v)
+          point_value.reinit(n_components);
+      }
+    for (unsigned int i = 0; i < point_owner.size(); ++i)
+      {
+        if (!found_cell(i))
+          continue;
+        const auto &buffer = received.at(point_owner[i]);
+        const unsigned int offset = point_position[i] * n_values;
+        for (unsigned int f = 0; f < fe_functions.size(); ++f)
+          for (unsigned int c = 0; c < n_components; ++c)
+            values[f][i][c] = buffer[offset + f * n_components + c];
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void RemotePointEvaluator<dim, VectorType>::point_gradients(
+    const VectorType *fe_function,
+    std::vector<std::vector<Tensor<1, dim>>> &gradients)
+  {
+    Assert(interpolator || !dof_handler,
+           ExcMessage("reinit must be called first!"));
+    const unsigned int n_values = n_components * dim;
+    std::vector<std::vector<Tensor<1, dim, typename VectorType::value_type>>>
+      served_gradients;
+    if (interpolator)
+      interpolator->point_gradients(*fe_function, served_gradients);
+
+    // Send back the gradients at the points found on this rank, in the same
+    // order as the values.
+    std::map<unsigned int, std::vector<double>> send_gradients;
+    for (const auto &begin : served_begin)
+      {
+        auto &buffer = send_gradients[begin.first];
+        for (unsigned int k = begin.second;
+             k < begin.second + served_size[begin.first];
+             ++k)
+          {
+            if (!found_locally(k))
+              continue;
+            for (unsigned int c = 0; c < n_components; ++c)
+              for (unsigned int d = 0; d < dim; ++d)
+                buffer.push_back(served_gradients[k][c][d]);
+          }
+      }
+    auto received = exchange_doubles(mpi_communicator, send_gradients);
+
+    gradients.assign(point_owner.size(),
+                     std::vector<Tensor<1, dim>>(n_components));
+    for (unsigned int i = 0; i < point_owner.size(); ++i)
+      {
+        if (!found_cell(i))
+          continue;
+        const auto &buffer = received.at(point_owner[i]);
+        const unsigned int offset = point_position[i] * n_values;
+        for (unsigned int c = 0; c < n_components; ++c)
+          for (unsigned int d = 0; d < dim; ++d)
+            gradients[i][c][d] = buffer[offset + c * dim + d];
+      }
+  }
+
+  template <int dim>
+  void CellCenterHash<dim>::reinit(const DoFHandler<dim> &dof_handler)
+  {
+    cells.clear();
+    centers.clear();
+    diameters.clear();
+    spacing = 0;
+    for (auto cell : dof_handler.active_cell_iterators())
+      {
+        if (!cell->is_locally_owned())
+          continue;
+        cells.push_back(cell);
+        centers.push_back(cell->center());
+        diameters.push_back(cell->diameter());
+        spacing = std::max(spacing, 2 * diameters.back());
+      }
+    // A power of 2 table size so that the hash is a bit mask.
+    unsigned int table_size = 1;
+    while (table_size < cells.size())
+      table_size *= 2;
+    table_begin.assign(table_size + 1, 0);
+    std::vector<unsigned int> cell_hash(cells.size());
+    for (unsigned int c = 0; c < cells.size(); ++c)
+      {
+        std::array<int, dim> index;
+        for (unsigned int d = 0; d < dim; ++d)
+          index[d] = static_cast<int>(std::floor(centers[c][d] / spacing));
+        cell_hash[c] = hash(index);
+        ++table_begin[cell_hash[c] + 1];
+      }
+    for (unsigned int h = 0; h < table_size; ++h)
+      table_begin[h + 1] += table_begin[h];
+    table_cells.resize(cells.size());
+    std::vector<unsigned int> fill(table_begin.begin(), table_begin.end() - 1);
+    for (unsigned int c = 0; c < cells.size(); ++c)
+      table_cells[fill[cell_hash[c]]++] = c;
+  }
+
+  template <int dim>
+  unsigned int
+  CellCenterHash<dim>::hash(const std::array<int, dim> &index) const
+  {
+    static const unsigned int primes[3] = {73856093, 19349663, 83492791};
+    unsigned int h = 0;
+    for (unsigned int d = 0; d < dim; ++d)
+      h ^= static_cast<unsigned int>(index[d]) * primes[d];
+    return h & (table_begin.size() - 2);
+  }
+
+  template <int dim>
+  void CellCenterHash<dim>::append_sources(
+    const Point<dim> &target,
+    std::vector<
+      std::pair<typename DoFHandler<dim>::active_cell_iterator, double>>
+      &sources) const
+  {
+    if (cells.empty())
+      return;
+    std::array<int, dim> base;
+    for (unsigned int d = 0; d < dim; ++d)
+      base[d] = static_cast<int>(std::floor(target[d] / spacing));
+    // Visit the 3^dim buckets around the target. Different buckets can be
+    // hashed to the same entry, which must be visited only once.
+    const unsigned int n_neighbors = Utilities::fixed_power<dim>(3);
+    std::array<unsigned int, 27> visited;
+    unsigned int n_visited = 0;
+    for (unsigned int n = 0; n < n_neighbors; ++n)
+      {
+        std::array<int, dim> index = base;
+        for (unsigned int d = 0, m = n; d < dim; ++d, m /= 3)
+          index[d] += static_cast<int>(m % 3) - 1;
+        const unsigned int h = hash(index);
+        if (std::find(visited.begin(), visited.begin() + n_visited, h) !=
+            visited.begin() + n_visited)
+          continue;
+        visited[n_visited++] = h;
+        for (unsigned int k = table_begin[h]; k < table_begin[h + 1]; ++k)
+          {
+            const unsigned int c = table_cells[k];
+            double kernel_value =
+              cubic_spline(centers[c], target, diameters[c]);
+            if (kernel_value > 1e-12)
+              sources.push_back({cells[c], kernel_value});
+          }
+      }
+  }
+
+  template <int dim>
+  void CellCenterHash<dim>::find_sources(
+    const Point<dim> &target,
+    std::vector<
+      std::pair<typename DoFHandler<dim>::active_cell_iterator, double>>
+      &sources) const
+  {
+    sources.clear();
+    append_sources(target, sources);
+  }
+
+  template <int dim>
+  void CellCenterHash<dim>::kernel_weights(
+    const std::vector<Point<dim>> &targets,
+    std::vector<unsigned int> &offsets,
+    std::vector<
+      std::pair<typename DoFHandler<dim>::active_cell_iterator, double>>
+      &sources) const
+  {
+    sources.clear();
+    offsets.resize(targets.size() + 1);
+    offsets[0] = 0;
+    for (unsigned int i = 0; i < targets.size(); ++i)
+      {
+        append_sources(targets[i], sources);
+        offsets[i + 1] = sources.size();
+      }
   }
 
   template <int dim, typename VectorType>
@@ -138,6 +2534,135 @@ namespace Utils
       }
   }
 
+  namespace
+  {
+    // The 1D Lagrange polynomials on the equidistant points of the degree
+    // and their derivatives at x.
+    template <int degree>
+    void lagrange_1d(const double x, double *values, double *derivatives);
+
+    template <>
+    void lagrange_1d<1>(const double x, double *values, double *derivatives)
+    {
+      values[0] = 1 - x;
+      values[1] = x;
+      derivatives[0] = -1;
+      derivatives[1] = 1;
+    }
+
+    template <>
+    void lagrange_1d<2>(const double x, double *values, double *derivatives)
+    {
+      values[0] = (2 * x - 1) * (x - 1);
+      values[1] = 4 * x * (1 - x);
+      values[2] = x * (2 * x - 1);
+      derivatives[0] = 4 * x - 3;
+      derivatives[1] = 4 - 8 * x;
+      derivatives[2] = 4 * x - 1;
+    }
+  } // namespace
+
+  template <int dim>
+  bool TensorProductShapes<dim>::reinit(const FiniteElement<dim> &element)
+  {
+    if (fe == &element)
+      {
+        return true;
+      }
+    fe = nullptr;
+    degrees.resize(element.dofs_per_cell);
+    indices.resize(element.dofs_per_cell);
+    std::vector<std::vector<unsigned int>> numberings(
+      element.n_base_elements());
+    for (unsigned int j = 0; j < element.dofs_per_cell; ++j)
+      {
+        const auto base_index = element.system_to_base_index(j);
+        const unsigned int base = base_index.first.first;
+        const FiniteElement<dim> &base_element = element.base_element(base);
+        if (dynamic_cast<const FE_Q<dim> *>(&base_element) == nullptr ||
+            base_element.degree < 1 || base_element.degree > 2)
+          {
+            return false;
+          }
+        if (numberings[base].empty())
+          {
+            numberings[base] =
+              FETools::hierarchic_to_lexicographic_numbering<dim>(
+                base_element.degree);
+          }
+        degrees[j] = base_element.degree;
+        unsigned int lexicographic = numberings[base][base_index.second];
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            indices[j][d] = lexicographic % (degrees[j] + 1);
+            lexicographic /= degrees[j] + 1;
+          }
+      }
+    // FE_Q may have been built on other points, so the closed forms are
+    // checked against the element at a point inside the cell.
+    fe = &element;
+    Point<dim> p;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        p[d] = 0.2 + 0.25 * d;
+      }
+    std::vector<double> values(element.dofs_per_cell);
+    std::vector<Tensor<1, dim>> gradients(element.dofs_per_cell);
+    evaluate(p, values.data(), gradients.data());
+    for (unsigned int j = 0; j < element.dofs_per_cell; ++j)
+      {
+        if (std::abs(values[j] - element.shape_value(j, p)) > 1e-12 ||
+            (gradients[j] - element.shape_grad(j, p)).norm() > 1e-12)
+          {
+            fe = nullptr;
+            return false;
+          }
+      }
+    return true;
+  }
+
+  template <int dim>
+  void TensorProductShapes<dim>::evaluate(const Point<dim> &p,
+                                          double *values,
+                                          Tensor<1, dim> *gradients) const
+  {
+    Assert(supported(), ExcMessage("The element is not supported!"));
+    // The 1D values and derivatives of both degrees in every direction.
+    double values_1d[3][dim][3], derivatives_1d[3][dim][3];
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        lagrange_1d<1>(p[d], values_1d[1][d], derivatives_1d[1][d]);
+        lagrange_1d<2>(p[d], values_1d[2][d], derivatives_1d[2][d]);
+      }
+    for (unsigned int j = 0; j < degrees.size(); ++j)
+      {
+        const auto &v = values_1d[degrees[j]];
+        const auto &dv = derivatives_1d[degrees[j]];
+        const auto &index = indices[j];
+        if (values)
+          {
+            double value = 1;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                value *= v[d][index[d]];
+              }
+            values[j] = value;
+          }
+        if (gradients)
+          {
+            for (unsigned int k = 0; k < dim; ++k)
+              {
+                double derivative = 1;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    derivative *= d == k ? dv[d][index[d]] : v[d][index[d]];
+                  }
+                gradients[j][k] = derivative;
+              }
+          }
+      }
+  }
+
   template <int dim, typename VectorType>
   GridInterpolator<dim, VectorType>::GridInterpolator(
     const DoFHandler<dim> &dof_handler,
@@ -212,87 +2737,736 @@ namespace Utils
     if (cell_point.first == dof_handler.end() ||
         !cell_point.first->is_locally_owned())
       {
-        for (auto &v : gradient)
+        for (auto &v : gradient)
+          {
+            v = 0;
+          }
+        return;
+      }
+    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
+           ExcInternalError());
+
+    const Quadrature<dim> quadrature(
+      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
+    FEValues<dim> fe_values(mapping, fe, quadrature, update_gradients);
+    fe_values.reinit(cell_point.first);
+    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
+      1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
+    fe_values.get_function_gradients(fe_function, u_gradient);
+    gradient = u_gradient[0];
+  }
+
+  template <int dim, typename VectorType>
+  const typename DoFHandler<dim>::active_cell_iterator
+  GridInterpolator<dim, VectorType>::get_cell() const
+  {
+    return cell_point.first;
+  }
+
+  template <int dim, typename VectorType>
+  BatchedGridInterpolator<dim, VectorType>::BatchedGridInterpolator(
+    const DoFHandler<dim> &dof_handler,
+    const std::vector<bool> &mask,
+    const Mapping<dim> *mapping)
+    : dof_handler(dof_handler),
+      mask(mask),
+      mapping(mapping),
+      update_flags(update_default)
+  {
+  }
+
+  template <int dim, typename VectorType>
+  void BatchedGridInterpolator<dim, VectorType>::reinit(
+    const std::vector<Point<dim>> &points,
+    const std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells,
+    const UpdateFlags flags)
+  {
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(fe.is_primitive(),
+           ExcMessage("Only primitive finite elements are supported!"));
+    Assert(cells.empty() || cells.size() == points.size(),
+           ExcDimensionMismatch(cells.size(), points.size()));
+    update_flags = flags;
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    shape_components.resize(dofs_per_cell);
+    for (unsigned int j = 0; j < dofs_per_cell; ++j)
+      {
+        shape_components[j] = fe.system_to_component_index(j).first;
+      }
+
+    // Locate the points in the same way as GridInterpolator. The points are
+    // independent of each other, so they are located on multiple threads.
+    cell_points.resize(points.size());
+    parallel::apply_to_subranges(
+      0u,
+      static_cast<unsigned int>(points.size()),
+      [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+          {
+            if (!cells.empty() &&
+                cells[i].state() == IteratorState::IteratorStates::valid)
+              {
+                cell_points[i].first = cells[i];
+                cell_points[i].second =
+                  transform_real_to_unit_cell(cells[i], points[i]);
+                continue;
+              }
+            try
+              {
+                cell_points[i] = GridTools::find_active_cell_around_point(
+                  get_mapping(), dof_handler, points[i], mask);
+              }
+            catch (GridTools::ExcPointNotFound<dim> &e)
+              {
+                cell_points[i].first = dof_handler.end();
+                cell_points[i].second = points[i];
+              }
+          }
+      },
+      32);
+
+    // Group the points that have values by their cells.
+    grouped_points.clear();
+    for (unsigned int i = 0; i < points.size(); ++i)
+      {
+        if (found_cell(i) && cell_points[i].first->is_locally_owned())
+          grouped_points.push_back(i);
+      }
+    std::sort(grouped_points.begin(),
+              grouped_points.end(),
+              [this](const unsigned int a, const unsigned int b) {
+                const auto &ca = cell_points[a].first;
+                const auto &cb = cell_points[b].first;
+                if (ca->level() != cb->level())
+                  return ca->level() < cb->level();
+                if (ca->index() != cb->index())
+                  return ca->index() < cb->index();
+                return a < b;
+              });
+    group_begin.clear();
+    for (unsigned int k = 0; k < grouped_points.size(); ++k)
+      {
+        if (k == 0 || cell_points[grouped_points[k]].first !=
+                        cell_points[grouped_points[k - 1]].first)
+          group_begin.push_back(k);
+      }
+    group_begin.push_back(grouped_points.size());
+
+    // Evaluate the shape functions on the reference cell.
+    if (flags & update_values)
+      shape_values.resize(points.size() * dofs_per_cell);
+    if (flags & update_gradients)
+      shape_gradients.resize(points.size() * dofs_per_cell);
+    const bool tensor_product = tensor_product_shapes.reinit(fe);
+    // Every point writes its own slice of the shape function arrays.
+    auto evaluate_shape = [&](const unsigned int begin,
+                              const unsigned int end) {
+      std::vector<Tensor<1, dim>> unit_gradients(
+        tensor_product && (flags & update_gradients) ? dofs_per_cell : 0);
+      for (unsigned int k = begin; k < end; ++k)
+        {
+          const unsigned int i = grouped_points[k];
+          const auto &cell = cell_points[i].first;
+          Assert(GeometryInfo<dim>::distance_to_unit_cell(
+                   cell_points[i].second) < 1e-10,
+                 ExcInternalError());
+          const Point<dim> unit_point =
+            GeometryInfo<dim>::project_to_unit_cell(cell_points[i].second);
+          if (tensor_product)
+            {
+              tensor_product_shapes.evaluate(
+                unit_point,
+                flags & update_values ? &shape_values[i * dofs_per_cell]
+                                      : nullptr,
+                flags & update_gradients ? unit_gradients.data() : nullptr);
+            }
+          if ((flags & update_values) && !tensor_product)
+            {
+              for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                {
+                  shape_values[i * dofs_per_cell + j] =
+                    fe.shape_value(j, unit_point);
+                }
+            }
+          if (flags & update_gradients)
+            {
+              // The Jacobian of a degree 1 mapping only depends on the
+              // mapped vertices.
+              const auto vertices = get_mapping().get_vertices(cell);
+              Tensor<2, dim> jacobian;
+              for (unsigned int v = 0;
+                   v < GeometryInfo<dim>::vertices_per_cell;
+                   ++v)
+                {
+                  jacobian += outer_product(
+                    vertices[v],
+                    GeometryInfo<dim>::d_linear_shape_function_gradient(
+                      unit_point, v));
+                }
+              const Tensor<2, dim> inverse_transpose =
+                transpose(invert(jacobian));
+              for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                {
+                  shape_gradients[i * dofs_per_cell + j] =
+                    inverse_transpose *
+                    (tensor_product ? unit_gradients[j]
+                                    : fe.shape_grad(j, unit_point));
+                }
+            }
+        }
+    };
+    parallel::apply_to_subranges(
+      0u,
+      static_cast<unsigned int>(grouped_points.size()),
+      evaluate_shape,
+      32);
+  }
+
+  template <int dim, typename VectorType>
+  Point<dim>
+  BatchedGridInterpolator<dim, VectorType>::transform_real_to_unit_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const Point<dim> &point) const
+  {
+    // The vertices of an affine cell are the first one plus the sums of the
+    // edges from it, the edge of direction d ends at vertex 2^d.
+    const auto vertices = get_mapping().get_vertices(cell);
+    Tensor<2, dim> jacobian;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        const Tensor<1, dim> edge = vertices[1 << d] - vertices[0];
+        for (unsigned int c = 0; c < dim; ++c)
+          {
+            jacobian[c][d] = edge[c];
+          }
+      }
+    const double tolerance = 1e-12 * cell->diameter();
+    for (unsigned int v = 3; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+      {
+        Point<dim> affine_vertex = vertices[0];
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            if (v & (1 << d))
+              {
+                affine_vertex += vertices[1 << d] - vertices[0];
+              }
+          }
+        if (affine_vertex.distance(vertices[v]) > tolerance)
+          {
+            return get_mapping().transform_real_to_unit_cell(cell, point);
+          }
+      }
+    return Point<dim>(invert(jacobian) * (point - vertices[0]));
+  }
+
+  template <int dim, typename VectorType>
+  void BatchedGridInterpolator<dim, VectorType>::point_values(
+    const std::vector<const VectorType *> &fe_functions,
+    std::vector<std::vector<Vector<Number>>> &values) const
+  {
+    Assert(update_flags & update_values,
+           ExcMessage("The shape values are not computed in reinit!"));
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    values.resize(fe_functions.size());
+    for (auto &v : values)
+      {
+        v.resize(n_points());
+        for (auto &point_value : v)
+          {
+            point_value.reinit(fe.n_components());
+          }
+      }
+    Vector<Number> local_values(dofs_per_cell);
+    for (unsigned int g = 0; g + 1 < group_begin.size(); ++g)
+      {
+        const auto &cell = cell_points[grouped_points[group_begin[g]]].first;
+        for (unsigned int f = 0; f < fe_functions.size(); ++f)
+          {
+            cell->get_dof_values(*fe_functions[f], local_values);
+            for (unsigned int k = group_begin[g]; k < group_begin[g + 1]; ++k)
+              {
+                const unsigned int i = grouped_points[k];
+                const double *shape = &shape_values[i * dofs_per_cell];
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                  {
+                    values[f][i][shape_components[j]] +=
+                      shape[j] * local_values[j];
+                  }
+              }
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void BatchedGridInterpolator<dim, VectorType>::point_weights(
+    const unsigned int i,
+    const unsigned int component,
+    std::vector<types::global_dof_index> &dofs,
+    std::vector<double> &weights) const
+  {
+    Assert(update_flags & update_values,
+           ExcMessage("The shape values are not computed in reinit!"));
+    dofs.clear();
+    weights.clear();
+    if (!found_cell(i) || !cell_points[i].first->is_locally_owned())
+      return;
+    const unsigned int dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
+    std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+    cell_points[i].first->get_dof_indices(dof_indices);
+    for (unsigned int j = 0; j < dofs_per_cell; ++j)
+      {
+        if (shape_components[j] == component)
+          {
+            dofs.push_back(dof_indices[j]);
+            weights.push_back(shape_values[i * dofs_per_cell + j]);
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void BatchedGridInterpolator<dim, VectorType>::point_gradients(
+    const VectorType &fe_function,
+    std::vector<std::vector<Tensor<1, dim, Number>>> &gradients) const
+  {
+    Assert(update_flags & update_gradients,
+           ExcMessage("The shape gradients are not computed in reinit!"));
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    gradients.resize(n_points());
+    for (auto &g : gradients)
+      {
+        g.assign(fe.n_components(), Tensor<1, dim, Number>());
+      }
+    Vector<Number> local_values(dofs_per_cell);
+    for (unsigned int g = 0; g + 1 < group_begin.size(); ++g)
+      {
+        const auto &cell = cell_points[grouped_points[group_begin[g]]].first;
+        cell->get_dof_values(fe_function, local_values);
+        for (unsigned int k = group_begin[g]; k < group_begin[g + 1]; ++k)
+          {
+            const unsigned int i = grouped_points[k];
+            const Tensor<1, dim> *shape = &shape_gradients[i * dofs_per_cell];
+            for (unsigned int j = 0; j < dofs_per_cell; ++j)
+              {
+                gradients[i][shape_components[j]] += shape[j] * local_values[j];
+              }
+          }
+      }
+  }
+
+  template <int dim, typename MeshType>
+  CellLocator<dim, MeshType>::CellLocator(DoFHandler<dim> &dh)
+    : dof_handler(dh), cell_found(true), generation(0)
+  {
+  }
+
+  template <int dim, typename MeshType>
+  void CellLocator<dim, MeshType>::reinit()
+  {
+    const unsigned int n_cells =
+      dof_handler.get_triangulation().n_active_cells();
+    generation = 0;
+    visited.assign(n_cells, 0);
+    neighbor_cache.resize(n_cells);
+    neighbor_cached.assign(n_cells, false);
+  }
+
+  template <int dim, typename MeshType>
+  const std::vector<typename MeshType::active_cell_iterator> &
+  CellLocator<dim, MeshType>::get_neighbors(
+    const typename MeshType::active_cell_iterator &cell)
+  {
+    const unsigned int index = cell->active_cell_index();
+    if (!neighbor_cached[index])
+      {
+        GridTools::get_active_neighbors<MeshType>(cell, neighbor_cache[index]);
+        neighbor_cached[index] = true;
+      }
+    return neighbor_cache[index];
+  }
+
+  template <int dim, typename MeshType>
+  const typename MeshType::active_cell_iterator
+  CellLocator<dim, MeshType>::search(
+    const Point<dim> &point,
+    const typename MeshType::active_cell_iterator &hint,
+    const Mapping<dim> *mapping)
+  {
+    cell_found = true;
+    // If the hint is the begin iterator we do not use BFS.
+    if (hint == dof_handler.begin_active())
+      {
+        MappingQ1<dim> q1_mapping;
+        return (GridTools::find_active_cell_around_point(
+                  mapping ? *mapping : q1_mapping, dof_handler, point))
+          .first;
+      }
+    if (visited.size() != dof_handler.get_triangulation().n_active_cells())
+      {
+        reinit();
+      }
+    // Start a new generation so that all the cells are unvisited.
+    if (++generation == 0)
+      {
+        std::fill(visited.begin(), visited.end(), 0);
+        generation = 1;
+      }
+    // The queue is a vector that is never popped, head points to the front.
+    cell_queue.clear();
+    cell_queue.push_back(hint);
+    visited[hint->active_cell_index()] = generation;
+    for (unsigned int head = 0; head < cell_queue.size(); ++head)
+      {
+        // Copy the iterator since pushing to the queue may reallocate.
+        const auto current_cell = cell_queue[head];
+        // If the point is inside current cell then we are done.
+        if (point_inside_cell(mapping, current_cell, point))
+          {
+            return current_cell;
+          }
+        // Push all the unflagged active neighbors into the queue
+        for (const auto &neighbor : get_neighbors(current_cell))
+          {
+            const unsigned int index = neighbor->active_cell_index();
+            if (visited[index] != generation)
+              {
+                visited[index] = generation;
+                cell_queue.push_back(neighbor);
+              }
+          }
+      }
+    // If the queue is already empty, we failed in finding the cell
+    cell_found = false;
+    // Return an invalid iterator
+    typename MeshType::active_cell_iterator invalid_itr;
+    return invalid_itr;
+  }
+
+  template <int dim>
+  BoundaryCrossingIndex<dim>::BoundaryCrossingIndex()
+    : y_min(0), y_max(0), slab_height(0)
+  {
+  }
+
+  template <int dim>
+  void BoundaryCrossingIndex<dim>::reinit(
+    const std::list<typename Triangulation<dim>::face_iterator> &faces,
+    const Point<dim> *vertices)
+  {
+    AssertThrow(dim == 2, ExcNotImplemented());
+    segments.clear();
+    slab_begin.clear();
+    slab_faces.clear();
+    if (faces.empty())
+      return;
+    segments.reserve(faces.size());
+    auto vertex = [vertices](const typename Triangulation<dim>::face_iterator
+                               &face,
+                             const unsigned int v) {
+      return vertices ? vertices[face->vertex_index(v)] : face->vertex(v);
+    };
+    y_min = vertex(faces.front(), 0)(1);
+    y_max = y_min;
+    for (auto f = faces.begin(); f != faces.end(); ++f)
+      {
+        segments.push_back({vertex(*f, 0), vertex(*f, 1)});
+        for (unsigned int v = 0; v < 2; ++v)
+          {
+            y_min = std::min(y_min, vertex(*f, v)(1));
+            y_max = std::max(y_max, vertex(*f, v)(1));
+          }
+      }
+    // One slab per face keeps the number of faces per slab small when the
+    // boundary is evenly discretized.
+    const unsigned int n_slabs = segments.size();
+    slab_height = (y_max - y_min) / n_slabs;
+    // Count the faces in every slab first, then fill in the face indices.
+    slab_begin.resize(n_slabs + 1, 0);
+    for (const auto &s : segments)
+      {
+        auto range = std::minmax(s.first(1), s.second(1));
+        for (unsigned int i = slab_index(range.first);
+             i <= slab_index(range.second);
+             ++i)
+          ++slab_begin[i + 1];
+      }
+    for (unsigned int i = 0; i < n_slabs; ++i)
+      slab_begin[i + 1] += slab_begin[i];
+    slab_faces.resize(slab_begin.back());
+    std::vector<unsigned int> fill(slab_begin.begin(), slab_begin.end() - 1);
+    for (unsigned int f = 0; f < segments.size(); ++f)
+      {
+        auto range = std::minmax(segments[f].first(1), segments[f].second(1));
+        for (unsigned int i = slab_index(range.first);
+             i <= slab_index(range.second);
+             ++i)
+          slab_faces[fill[i]++] = f;
+      }
+  }
+
+  template <int dim>
+  unsigned int BoundaryCrossingIndex<dim>::slab_index(const double y) const
+  {
+    const unsigned int n_slabs = slab_begin.size() - 1;
+    if (slab_height <= 0 || y <= y_min)
+      return 0;
+    return std::min(static_cast<unsigned int>((y - y_min) / slab_height),
+                    n_slabs - 1);
+  }
+
+  template <int dim>
+  bool BoundaryCrossingIndex<dim>::point_inside(const Point<dim> &point) const
+  {
+    if (segments.empty() || point(1) < y_min || point(1) > y_max)
+      return false;
+    const unsigned int slab = slab_index(point(1));
+    unsigned int cross_number = 0;
+    unsigned int half_cross_number = 0;
+    for (unsigned int k = slab_begin[slab]; k < slab_begin[slab + 1]; ++k)
+      {
+        const Point<dim> &p1 = segments[slab_faces[k]].first;
+        const Point<dim> &p2 = segments[slab_faces[k]].second;
+        double y_diff1 = p1(1) - point(1);
+        double y_diff2 = p2(1) - point(1);
+        double x_diff1 = p1(0) - point(0);
+        double x_diff2 = p2(0) - point(0);
+        Tensor<1, dim> r1 = p1 - p2;
+        Tensor<1, dim> r2;
+        // r1[1] == 0 if the boundary is horizontal
+        if (r1[1] != 0.0)
+          r2 = r1 * (point(1) - p2(1)) / r1[1];
+        if (y_diff1 * y_diff2 < 0)
+          {
+            // Point is on the left of the boundary
+            if (r2[0] + p2(0) > point(0))
+              {
+                ++cross_number;
+              }
+            // Point is on the boundary
+            else if (r2[0] + p2(0) == point(0))
+              {
+                return true;
+              }
+          }
+        // Point is on the same horizontal line with one of the vertices
+        else if (y_diff1 * y_diff2 == 0)
+          {
+            // The boundary is horizontal
+            if (y_diff1 == 0 && y_diff2 == 0)
+              {
+                // The point is on it
+                if (x_diff1 * x_diff2 < 0)
+                  {
+                    return true;
+                  }
+                // The point is not on it
+                else
+                  continue;
+              }
+            // On the left of the boundary
+            else if (r2[0] + p2(0) > point(0))
+              {
+                // The point must not be on the top or bottom of the box
+                // (because it can be tangential)
+                if (point(1) != y_min && point(1) != y_max)
+                  ++half_cross_number;
+              }
+            // Point overlaps with the vertex
+            else if (point == p1 || point == p2)
+              {
+                return true;
+              }
+          }
+      }
+    cross_number += half_cross_number / 2;
+    return (cross_number % 2 == 1);
+  }
+
+  template <int dim>
+  void CellBucketGrid<dim>::reinit(const DoFHandler<dim> &dof_handler,
+                                   const Mapping<dim> *mapping)
+  {
+    this->mapping = mapping;
+    cells.clear();
+    boxes.clear();
+    bucket_begin.clear();
+    bucket_cells.clear();
+    n_per_dim = 0;
+    // Bounding box of every cell, slightly enlarged so that points found by
+    // the tolerance of point_inside are not missed.
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        std::array<Point<dim>, GeometryInfo<dim>::vertices_per_cell> vertices;
+        if (mapping)
+          vertices = mapping->get_vertices(cell);
+        else
+          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            vertices[v] = cell->vertex(v);
+        Point<dim> lo = vertices[0], hi = vertices[0];
+        for (unsigned int v = 1; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          for (unsigned int d = 0; d < dim; ++d)
+            {
+              lo[d] = std::min(lo[d], vertices[v][d]);
+              hi[d] = std::max(hi[d], vertices[v][d]);
+            }
+        const double padding = 1e-8 * lo.distance(hi);
+        for (unsigned int d = 0; d < dim; ++d)
           {
-            v = 0;
+            lo[d] -= padding;
+            hi[d] += padding;
           }
-        return;
+        if (cells.empty())
+          {
+            lower = lo;
+            upper = hi;
+          }
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            lower[d] = std::min(lower[d], lo[d]);
+            upper[d] = std::max(upper[d], hi[d]);
+          }
+        cells.push_back(cell);
+        boxes.push_back({lo, hi});
       }
-    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
-           ExcInternalError());
+    if (cells.empty())
+      return;
 
-    const Quadrature<dim> quadrature(
-      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
-    FEValues<dim> fe_values(mapping, fe, quadrature, update_gradients);
-    fe_values.reinit(cell_point.first);
-    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
-      1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
-    fe_values.get_function_gradients(fe_function, u_gradient);
-    gradient = u_gradient[0];
-  }
+    // Roughly one cell per bucket.
+    n_per_dim = std::max(
+      1u,
+      static_cast<unsigned int>(std::pow(cells.size(), 1.0 / dim) + 0.5));
+    for (unsigned int d = 0; d < dim; ++d)
+      bucket_size[d] = (upper[d] - lower[d]) / n_per_dim;
+    const unsigned int n_buckets = Utilities::fixed_power<dim>(n_per_dim);
 
-  template <int dim, typename VectorType>
-  const typename DoFHandler<dim>::active_cell_iterator
-  GridInterpolator<dim, VectorType>::get_cell() const
-  {
-    return cell_point.first;
+    // Visit all the buckets that overlap a box.
+    auto for_each_bucket = [this](const std::pair<Point<dim>, Point<dim>> &box,
+                                  const std::function<void(unsigned int)> &f) {
+      unsigned int begin[3] = {0, 0, 0}, end[3] = {1, 1, 1};
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          begin[d] = clamped_index(box.first[d], d);
+          end[d] = clamped_index(box.second[d], d) + 1;
+        }
+      for (unsigned int k = begin[2]; k < end[2]; ++k)
+        for (unsigned int j = begin[1]; j < end[1]; ++j)
+          for (unsigned int i = begin[0]; i < end[0]; ++i)
+            f(i + n_per_dim * (j + n_per_dim * k));
+    };
+
+    // Count the cells in every bucket first, then fill in the cell indices.
+    bucket_begin.resize(n_buckets + 1, 0);
+    for (const auto &box : boxes)
+      for_each_bucket(box, [this](unsigned int b) { ++bucket_begin[b + 1]; });
+    for (unsigned int b = 0; b < n_buckets; ++b)
+      bucket_begin[b + 1] += bucket_begin[b];
+    bucket_cells.resize(bucket_begin.back());
+    std::vector<unsigned int> fill(bucket_begin.begin(),
+                                   bucket_begin.end() - 1);
+    for (unsigned int c = 0; c < boxes.size(); ++c)
+      for_each_bucket(boxes[c], [&](unsigned int b) {
+        bucket_cells[fill[b]++] = c;
+      });
   }
 
-  template <int dim, typename MeshType>
-  CellLocator<dim, MeshType>::CellLocator(
-    DoFHandler<dim> &dh,
-    const Point<dim> &p,
-    const typename MeshType::active_cell_iterator &hint)
-    : dof_handler(dh), point(p), hint(hint), cell_found(true)
+  template <int dim>
+  unsigned int CellBucketGrid<dim>::clamped_index(const double x,
+                                                  const unsigned int d) const
   {
+    if (bucket_size[d] <= 0 || x <= lower[d])
+      return 0;
+    return std::min(static_cast<unsigned int>((x - lower[d]) / bucket_size[d]),
+                    n_per_dim - 1);
   }
 
-  template <int dim, typename MeshType>
-  const typename MeshType::active_cell_iterator
-  CellLocator<dim, MeshType>::search()
+  template <int dim>
+  int CellBucketGrid<dim>::bucket_index(const Point<dim> &p) const
   {
-    // If the hint is the begin iterator we do not use BFS.
-    if (hint == dof_handler.begin_active())
+    if (n_per_dim == 0)
+      return -1;
+    int index = 0;
+    for (int d = dim - 1; d >= 0; --d)
       {
-        MappingQ1<dim> mapping;
-        return (GridTools::find_active_cell_around_point(
-                  mapping, dof_handler, point))
-          .first;
+        if (p[d] < lower[d] || p[d] > upper[d])
+          return -1;
+        index = index * n_per_dim + clamped_index(p[d], d);
       }
-    // Create an unordered set to store the flagged cells
-    std::unordered_set<std::string> flag_table;
-    std::queue<typename MeshType::active_cell_iterator> cell_queue;
-    // Start with the hint cell
-    cell_queue.push(hint);
-    while (!cell_queue.empty())
+    return index;
+  }
+
+  template <int dim>
+  typename DoFHandler<dim>::active_cell_iterator
+  CellBucketGrid<dim>::find_cell(const Point<dim> &p) const
+  {
+    const int b = bucket_index(p);
+    if (b >= 0)
       {
-        auto current_cell = cell_queue.front();
-        flag_table.insert(current_cell->id().to_string());
-        cell_queue.pop();
-        // If the point is inside current cell then we are done.
-        if (current_cell->point_inside(point))
+        for (unsigned int k = bucket_begin[b]; k < bucket_begin[b + 1]; ++k)
           {
-            return current_cell;
+            const unsigned int c = bucket_cells[k];
+            bool in_box = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              in_box = in_box && p[d] >= boxes[c].first[d] &&
+                       p[d] <= boxes[c].second[d];
+            if (in_box && point_inside_cell(mapping, cells[c], p))
+              return cells[c];
           }
-        std::vector<typename MeshType::active_cell_iterator> neightbors;
-        // Get all the active neighbors!
-        GridTools::get_active_neighbors<MeshType>(current_cell, neightbors);
-        for (unsigned int i = 0; i < neightbors.size(); ++i)
+      }
+    return typename DoFHandler<dim>::active_cell_iterator();
+  }
+
+  template <int dim>
+  void CellBucketGrid<dim>::find_cells(
+    const Point<dim> &box_lower,
+    const Point<dim> &box_upper,
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> &found) const
+  {
+    found.clear();
+    if (n_per_dim == 0)
+      return;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        if (box_upper[d] < lower[d] || box_lower[d] > upper[d])
+          return;
+      }
+    unsigned int begin[3] = {0, 0, 0}, end[3] = {1, 1, 1};
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        begin[d] = clamped_index(box_lower[d], d);
+        end[d] = clamped_index(box_upper[d], d) + 1;
+      }
+    // A cell can be in several buckets, so the indices are deduplicated.
+    std::vector<unsigned int> indices;
+    for (unsigned int k = begin[2]; k < end[2]; ++k)
+      for (unsigned int j = begin[1]; j < end[1]; ++j)
+        for (unsigned int i = begin[0]; i < end[0]; ++i)
           {
-            // Push all the unflagged cells into the queue
-            if (flag_table.find(neightbors[i]->id().to_string()) ==
-                flag_table.end())
+            const unsigned int b = i + n_per_dim * (j + n_per_dim * k);
+            for (unsigned int n = bucket_begin[b]; n < bucket_begin[b + 1]; ++n)
               {
-                cell_queue.push(neightbors[i]);
-                flag_table.insert(neightbors[i]->id().to_string());
+                const auto &box = boxes[bucket_cells[n]];
+                bool overlap = true;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    if (box.second[d] < box_lower[d] ||
+                        box.first[d] > box_upper[d])
+                      {
+                        overlap = false;
+                        break;
+                      }
+                  }
+                if (overlap)
+                  indices.push_back(bucket_cells[n]);
               }
           }
-      }
-    // If the queue is already empty, we failed in finding the cell
-    cell_found = false;
-    // Return an invalid iterator
-    typename MeshType::active_cell_iterator invalid_itr;
-    return invalid_itr;
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    found.reserve(indices.size());
+    for (const auto c : indices)
+      found.push_back(cells[c]);
   }
 
   // Written by Davis Wells on dealii mailing list.
@@ -587,6 +3761,562 @@ namespace Utils
     tria.set_manifold(0, CylindricalManifold<3>(2));
   }
 
+  template <int dim>
+  CellFEDataCache<dim>::CellFEDataCache(const FiniteElement<dim> &fe,
+                                        const Quadrature<dim> &quad)
+    : fe_values(fe,
+                quad,
+                update_values | update_gradients | update_quadrature_points |
+                  update_JxW_values),
+      dofs_per_cell(fe.dofs_per_cell),
+      n_q_points(quad.size()),
+      components(dofs_per_cell),
+      base_function(dofs_per_cell),
+      shape_values(dofs_per_cell * n_q_points),
+      storage(std::make_shared<Storage>()),
+      current_JxW(nullptr),
+      current_gradients(nullptr),
+      current_points(n_q_points)
+  {
+    std::vector<unsigned int> base_offset(fe.n_base_elements(), 0);
+    for (unsigned int b = 1; b < fe.n_base_elements(); ++b)
+      {
+        base_offset[b] =
+          base_offset[b - 1] + fe.base_element(b - 1).dofs_per_cell;
+      }
+    representative.resize(base_offset.back() +
+                          fe.base_element(fe.n_base_elements() - 1)
+                            .dofs_per_cell);
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        AssertThrow(fe.is_primitive(k),
+                    ExcMessage("Shape functions must be primitive!"));
+        components[k] = fe.system_to_component_index(k).first;
+        const auto base = fe.system_to_base_index(k);
+        base_function[k] = base_offset[base.first.first] + base.second;
+        representative[base_function[k]] = k;
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            shape_values[k * n_q_points + q] =
+              fe.shape_value(k, quad.point(q));
+          }
+      }
+    scratch_JxW.resize(n_q_points);
+    scratch_gradients.resize(representative.size() * n_q_points);
+  }
+
+  template <int dim>
+  CellFEDataCache<dim>::CellFEDataCache(const CellFEDataCache<dim> &cache)
+    : fe_values(cache.fe_values.get_mapping(),
+                cache.fe_values.get_fe(),
+                cache.fe_values.get_quadrature(),
+                cache.fe_values.get_update_flags()),
+      dofs_per_cell(cache.dofs_per_cell),
+      n_q_points(cache.n_q_points),
+      components(cache.components),
+      base_function(cache.base_function),
+      representative(cache.representative),
+      shape_values(cache.shape_values),
+      storage(cache.storage),
+      scratch_JxW(cache.scratch_JxW.size()),
+      scratch_gradients(cache.scratch_gradients.size()),
+      current_JxW(nullptr),
+      current_gradients(nullptr),
+      current_points(n_q_points)
+  {
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::clear()
+  {
+    storage = std::make_shared<Storage>();
+  }
+
+  template <int dim>
+  std::size_t CellFEDataCache<dim>::memory_consumption() const
+  {
+    return MemoryConsumption::memory_consumption(storage->cell_slot) +
+           MemoryConsumption::memory_consumption(storage->JxW) +
+           MemoryConsumption::memory_consumption(storage->points) +
+           MemoryConsumption::memory_consumption(storage->gradients);
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::reinit(const DoFHandler<dim> &dof_handler)
+  {
+    auto data = std::make_shared<Storage>();
+    const unsigned int n_base = representative.size();
+    data->cell_slot.resize(dof_handler.get_triangulation().n_active_cells(),
+                           numbers::invalid_unsigned_int);
+    unsigned int n_slots = 0;
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        if (cell->is_locally_owned())
+          {
+            data->cell_slot[cell->active_cell_index()] = n_slots++;
+          }
+      }
+    data->JxW.resize(n_slots * n_q_points);
+    data->points.resize(n_slots * n_q_points);
+    data->gradients.resize(n_slots * n_base * n_q_points);
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        if (cell->is_locally_owned())
+          {
+            const unsigned int slot =
+              data->cell_slot[cell->active_cell_index()];
+            fe_values.reinit(cell);
+            copy_from_fe_values(&data->JxW[slot * n_q_points],
+                                &data->gradients[slot * n_base * n_q_points]);
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                data->points[slot * n_q_points + q] =
+                  fe_values.quadrature_point(q);
+              }
+          }
+      }
+    storage = data;
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::reinit(
+    const typename DoFHandler<dim>::active_cell_iterator &cell)
+  {
+    unsigned int slot = numbers::invalid_unsigned_int;
+    if (cell->active_cell_index() < storage->cell_slot.size())
+      {
+        slot = storage->cell_slot[cell->active_cell_index()];
+      }
+    if (slot == numbers::invalid_unsigned_int)
+      {
+        // The cell is not stored, compute its data into the scratch space.
+        fe_values.reinit(cell);
+        copy_from_fe_values(scratch_JxW.data(), scratch_gradients.data());
+        current_JxW = scratch_JxW.data();
+        current_gradients = scratch_gradients.data();
+        current_points = fe_values.get_quadrature_points();
+        return;
+      }
+    current_JxW = &storage->JxW[slot * n_q_points];
+    current_gradients =
+      &storage->gradients[slot * representative.size() * n_q_points];
+    std::copy(storage->points.begin() + slot * n_q_points,
+              storage->points.begin() + (slot + 1) * n_q_points,
+              current_points.begin());
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::copy_from_fe_values(
+    double *JxW_values, Tensor<1, dim> *gradients) const
+  {
+    for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        JxW_values[q] = fe_values.JxW(q);
+      }
+    for (unsigned int j = 0; j < representative.size(); ++j)
+      {
+        const unsigned int k = representative[j];
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            gradients[j * n_q_points + q] =
+              fe_values.shape_grad_component(k, q, components[k]);
+          }
+      }
+  }
+
+  template <int dim>
+  Tensor<1, dim>
+  CellFEDataCache<dim>::velocity_value(const unsigned int k,
+                                       const unsigned int q) const
+  {
+    Tensor<1, dim> value;
+    if (components[k] < dim)
+      {
+        value[components[k]] = shape_value(k, q);
+      }
+    return value;
+  }
+
+  template <int dim>
+  Tensor<2, dim>
+  CellFEDataCache<dim>::velocity_gradient(const unsigned int k,
+                                          const unsigned int q) const
+  {
+    Tensor<2, dim> gradient;
+    if (components[k] < dim)
+      {
+        gradient[components[k]] = shape_grad(k, q);
+      }
+    return gradient;
+  }
+
+  template <int dim>
+  double CellFEDataCache<dim>::velocity_divergence(const unsigned int k,
+                                                   const unsigned int q) const
+  {
+    return components[k] < dim ? shape_grad(k, q)[components[k]] : 0;
+  }
+
+  template <int dim>
+  double CellFEDataCache<dim>::pressure_value(const unsigned int k,
+                                              const unsigned int q) const
+  {
+    return components[k] == dim ? shape_value(k, q) : 0;
+  }
+
+  template <int dim>
+  Tensor<1, dim>
+  CellFEDataCache<dim>::pressure_gradient(const unsigned int k,
+                                          const unsigned int q) const
+  {
+    return components[k] == dim ? shape_grad(k, q) : Tensor<1, dim>();
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::get_velocity_values(
+    const Vector<double> &dof_values,
+    std::vector<Tensor<1, dim>> &values) const
+  {
+    std::fill(values.begin(), values.end(), Tensor<1, dim>());
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        if (components[k] < dim)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            values[q][components[k]] += dof_values[k] * shape_value(k, q);
+      }
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::get_velocity_gradients(
+    const Vector<double> &dof_values,
+    std::vector<Tensor<2, dim>> &gradients) const
+  {
+    std::fill(gradients.begin(), gradients.end(), Tensor<2, dim>());
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        if (components[k] < dim)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            gradients[q][components[k]] += dof_values[k] * shape_grad(k, q);
+      }
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::get_velocity_divergences(
+    const Vector<double> &dof_values, std::vector<double> &divergences) const
+  {
+    std::fill(divergences.begin(), divergences.end(), 0.0);
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        if (components[k] < dim)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            divergences[q] += dof_values[k] * shape_grad(k, q)[components[k]];
+      }
+  }
+
+  template <int dim>
+  void
+  CellFEDataCache<dim>::get_pressure_values(const Vector<double> &dof_values,
+                                            std::vector<double> &values) const
+  {
+    std::fill(values.begin(), values.end(), 0.0);
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        if (components[k] == dim)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            values[q] += dof_values[k] * shape_value(k, q);
+      }
+  }
+
+  template <int dim>
+  void CellFEDataCache<dim>::get_pressure_gradients(
+    const Vector<double> &dof_values,
+    std::vector<Tensor<1, dim>> &gradients) const
+  {
+    std::fill(gradients.begin(), gradients.end(), Tensor<1, dim>());
+    for (unsigned int k = 0; k < dofs_per_cell; ++k)
+      {
+        if (components[k] == dim)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            gradients[q] += dof_values[k] * shape_grad(k, q);
+      }
+  }
+
+  template <int dim, int spacedim>
+  void renumber_dofs(DoFHandler<dim, spacedim> &dof_handler,
+                     const std::string &scheme)
+  {
+    const bool distributed =
+      dynamic_cast<
+        const parallel::distributed::Triangulation<dim, spacedim> *>(
+        &dof_handler.get_triangulation()) != nullptr;
+    if (scheme == "Cuthill-McKee")
+      {
+        DoFRenumbering::Cuthill_McKee(dof_handler);
+      }
+    else if (scheme == "Hierarchical" || (scheme == "Hilbert" && distributed))
+      {
+        DoFRenumbering::hierarchical(dof_handler);
+      }
+    else if (scheme == "Hilbert")
+      {
+        // Quantize the cell centers in their bounding box and sort the cells
+        // by the Hilbert index of the quantized centers, computed with the
+        // transpose algorithm of Skilling (2004).
+        const unsigned int bits = 64 / spacedim;
+        Point<spacedim> lower, upper;
+        bool first = true;
+        for (auto cell : dof_handler.active_cell_iterators())
+          {
+            const Point<spacedim> center = cell->center();
+            for (unsigned int d = 0; d < spacedim; ++d)
+              {
+                lower[d] = first ? center[d] : std::min(lower[d], center[d]);
+                upper[d] = first ? center[d] : std::max(upper[d], center[d]);
+              }
+            first = false;
+          }
+        std::vector<std::pair<std::uint64_t,
+                              typename DoFHandler<dim, spacedim>::
+                                active_cell_iterator>>
+          keys;
+        keys.reserve(dof_handler.get_triangulation().n_active_cells());
+        const double max_coordinate =
+          static_cast<double>((std::uint64_t(1) << bits) - 1);
+        for (auto cell : dof_handler.active_cell_iterators())
+          {
+            std::array<std::uint64_t, spacedim> x;
+            const Point<spacedim> center = cell->center();
+            for (unsigned int d = 0; d < spacedim; ++d)
+              {
+                const double extent = upper[d] - lower[d];
+                x[d] = static_cast<std::uint64_t>(
+                  extent > 0 ? (center[d] - lower[d]) / extent * max_coordinate
+                             : 0);
+              }
+            // Inverse undo
+            for (std::uint64_t q = std::uint64_t(1) << (bits - 1); q > 1;
+                 q >>= 1)
+              {
+                const std::uint64_t p = q - 1;
+                for (unsigned int d = 0; d < spacedim; ++d)
+                  {
+                    if (x[d] & q)
+                      {
+                        x[0] ^= p;
+                      }
+                    else
+                      {
+                        const std::uint64_t t = (x[0] ^ x[d]) & p;
+                        x[0] ^= t;
+                        x[d] ^= t;
+                      }
+                  }
+              }
+            // Gray encode
+            for (unsigned int d = 1; d < spacedim; ++d)
+              {
+                x[d] ^= x[d - 1];
+              }
+            std::uint64_t t = 0;
+            for (std::uint64_t q = std::uint64_t(1) << (bits - 1); q > 1;
+                 q >>= 1)
+              {
+                if (x[spacedim - 1] & q)
+                  {
+                    t ^= q - 1;
+                  }
+              }
+            // Interleave the transposed bits into the index
+            std::uint64_t key = 0;
+            for (int b = bits - 1; b >= 0; --b)
+              {
+                for (unsigned int d = 0; d < spacedim; ++d)
+                  {
+                    key = (key << 1) | (((x[d] ^ t) >> b) & 1);
+                  }
+              }
+            keys.emplace_back(key, cell);
+          }
+        std::stable_sort(
+          keys.begin(),
+          keys.end(),
+          [](const auto &a, const auto &b) { return a.first < b.first; });
+        std::vector<typename DoFHandler<dim, spacedim>::active_cell_iterator>
+          cell_order;
+        cell_order.reserve(keys.size());
+        for (const auto &key : keys)
+          {
+            cell_order.push_back(key.second);
+          }
+        DoFRenumbering::cell_wise(dof_handler, cell_order);
+      }
+    else
+      {
+        AssertThrow(scheme == "None",
+                    ExcMessage("Unknown renumbering scheme " + scheme + "!"));
+      }
+  }
+
+  template void renumber_dofs(DoFHandler<2, 2> &, const std::string &);
+  template void renumber_dofs(DoFHandler<3, 3> &, const std::string &);
+  template void renumber_dofs(DoFHandler<2, 3> &, const std::string &);
+
+  template <int dim, int spacedim>
+  void refine_global_cached(Triangulation<dim, spacedim> &tria,
+                            const unsigned int n_refinements,
+                            const std::string &cache_directory)
+  {
+    StartupScope startup("refine_global");
+    if (cache_directory.empty() || n_refinements == 0)
+      {
+        tria.refine_global(n_refinements);
+        return;
+      }
+    AssertThrow(tria.n_levels() == 1,
+                ExcMessage("Only coarse meshes can be refined from cache!"));
+
+    // The key covers everything the refined mesh is built from.
+    Checksum checksum;
+    checksum.add(dim);
+    checksum.add(spacedim);
+    checksum.add(n_refinements);
+    for (const auto &vertex : tria.get_vertices())
+      {
+        for (unsigned int d = 0; d < spacedim; ++d)
+          {
+            checksum.add(vertex[d]);
+          }
+      }
+    for (auto cell = tria.begin_active(); cell != tria.end(); ++cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            checksum.add(cell->vertex_index(v));
+          }
+        checksum.add(cell->material_id());
+        checksum.add(cell->manifold_id());
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            checksum.add(cell->face(f)->boundary_id());
+            checksum.add(cell->face(f)->manifold_id());
+          }
+      }
+    std::ostringstream name;
+    name << cache_directory << "/" << std::hex << std::setw(16)
+         << std::setfill('0') << checksum.value() << ".tria";
+    const std::string filename = name.str();
+    namespace fs = std::experimental::filesystem;
+
+    auto *distributed =
+      dynamic_cast<parallel::distributed::Triangulation<dim, spacedim> *>(
+        &tria);
+    if (distributed)
+      {
+        // The forest is written to several files, the marker is only
+        // created once all of them are complete.
+        const MPI_Comm &mpi_communicator = distributed->get_communicator();
+        int cached = 0;
+        if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+          {
+            fs::create_directories(cache_directory);
+            cached = fs::exists(filename + ".done");
+          }
+        MPI_Bcast(&cached, 1, MPI_INT, 0, mpi_communicator);
+        if (cached)
+          {
+            distributed->load(filename);
+            return;
+          }
+        distributed->refine_global(n_refinements);
+        distributed->save(filename);
+        MPI_Barrier(mpi_communicator);
+        if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+          {
+            std::ofstream(filename + ".done");
+          }
+        return;
+      }
+
+    // A serial triangulation may be shared by all the ranks, each of them
+    // reads the cache and rank 0 writes it.
+    std::vector<Point<spacedim>> vertices;
+    {
+      std::ifstream in(filename, std::ios::binary);
+      std::uint64_t n_vertices = 0;
+      if (in.read(reinterpret_cast<char *>(&n_vertices), sizeof(n_vertices)))
+        {
+          vertices.resize(n_vertices);
+          in.read(reinterpret_cast<char *>(vertices.data()),
+                  n_vertices * sizeof(Point<spacedim>));
+          if (!in)
+            {
+              vertices.clear();
+            }
+        }
+    }
+    if (vertices.empty())
+      {
+        tria.refine_global(n_refinements);
+        if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+          {
+            fs::create_directories(cache_directory);
+            const std::string staged = filename + ".tmp";
+            {
+              std::ofstream out(staged, std::ios::binary);
+              const std::uint64_t n_vertices = tria.n_vertices();
+              out.write(reinterpret_cast<const char *>(&n_vertices),
+                        sizeof(n_vertices));
+              out.write(
+                reinterpret_cast<const char *>(tria.get_vertices().data()),
+                n_vertices * sizeof(Point<spacedim>));
+              AssertThrow(out, ExcMessage("Cannot write " + staged + "!"));
+            }
+            fs::rename(staged, filename);
+          }
+        return;
+      }
+
+    // The numbering of the new vertices does not depend on the manifolds,
+    // only their positions do, which are taken from the cache.
+    std::vector<std::pair<types::manifold_id,
+                          std::unique_ptr<Manifold<dim, spacedim>>>>
+      manifolds;
+    for (const auto id : tria.get_manifold_ids())
+      {
+        if (id != numbers::flat_manifold_id)
+          {
+            manifolds.emplace_back(id, tria.get_manifold(id).clone());
+            tria.set_manifold(id, FlatManifold<dim, spacedim>());
+          }
+      }
+    tria.refine_global(n_refinements);
+    AssertThrow(tria.n_vertices() == vertices.size(),
+                ExcMessage("The cached mesh " + filename + " is corrupted!"));
+    for (auto cell = tria.begin_active(); cell != tria.end(); ++cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            cell->vertex(v) = vertices[cell->vertex_index(v)];
+          }
+      }
+    for (const auto &manifold : manifolds)
+      {
+        tria.set_manifold(manifold.first, *manifold.second);
+      }
+  }
+
+  template void refine_global_cached(Triangulation<2, 2> &,
+                                     const unsigned int,
+                                     const std::string &);
+  template void refine_global_cached(Triangulation<3, 3> &,
+                                     const unsigned int,
+                                     const std::string &);
+  template void refine_global_cached(Triangulation<2, 3> &,
+                                     const unsigned int,
+                                     const std::string &);
+
   template class GridCreator<2>;
   template class GridCreator<3>;
   template class GridInterpolator<2, Vector<double>>;
@@ -595,10 +4325,58 @@ namespace Utils
   template class GridInterpolator<3, BlockVector<double>>;
   template class GridInterpolator<2, PETScWrappers::MPI::BlockVector>;
   template class GridInterpolator<3, PETScWrappers::MPI::BlockVector>;
+  template class TensorProductShapes<2>;
+  template class TensorProductShapes<3>;
+  template class BatchedGridInterpolator<2, Vector<double>>;
+  template class BatchedGridInterpolator<3, Vector<double>>;
+  template class BatchedGridInterpolator<2, BlockVector<double>>;
+  template class BatchedGridInterpolator<3, BlockVector<double>>;
+  template class BatchedGridInterpolator<2, PETScWrappers::MPI::BlockVector>;
+  template class BatchedGridInterpolator<3, PETScWrappers::MPI::BlockVector>;
+  template class BatchedGridInterpolator<2, PETScWrappers::MPI::Vector>;
+  template class BatchedGridInterpolator<3, PETScWrappers::MPI::Vector>;
+  template class RemotePointEvaluator<2, Vector<double>>;
+  template class RemotePointEvaluator<3, Vector<double>>;
+  template class RemotePointEvaluator<2, PETScWrappers::MPI::Vector>;
+  template class RemotePointEvaluator<3, PETScWrappers::MPI::Vector>;
+  template class RemotePointEvaluator<2, PETScWrappers::MPI::BlockVector>;
+  template class RemotePointEvaluator<3, PETScWrappers::MPI::BlockVector>;
+  template class CellCenterHash<2>;
+  template class CellCenterHash<3>;
   template class SPHInterpolator<2, Vector<double>>;
   template class SPHInterpolator<3, Vector<double>>;
   template class SPHInterpolator<2, PETScWrappers::MPI::BlockVector>;
   template class SPHInterpolator<3, PETScWrappers::MPI::BlockVector>;
+  template void XDMFOutput::write(const DataOutInterface<2, 2> &,
+                                  const unsigned int,
+                                  const double,
+                                  const MPI_Comm &);
+  template void XDMFOutput::write(const DataOutInterface<3, 3> &,
+                                  const unsigned int,
+                                  const double,
+                                  const MPI_Comm &);
+  template void XDMFOutput::write(const DataOutInterface<2, 3> &,
+                                  const unsigned int,
+                                  const double,
+                                  const MPI_Comm &);
+  template class FilteredDataOut<2>;
+  template class FilteredDataOut<3>;
+  template class FilteredDataOut<2, 3>;
+  template void OutputControl::set_flags(DataOutInterface<2, 2> &) const;
+  template void OutputControl::set_flags(DataOutInterface<3, 3> &) const;
+  template void OutputControl::set_flags(DataOutInterface<2, 3> &) const;
   template class Utils::CellLocator<2, DoFHandler<2, 2>>;
   template class Utils::CellLocator<3, DoFHandler<3, 3>>;
+  template class BoundaryCrossingIndex<2>;
+  template class BoundaryCrossingIndex<3>;
+  template class CellBucketGrid<2>;
+  template class CellBucketGrid<3>;
+  template class CellFEDataCache<2>;
+  template class CellFEDataCache<3>;
+  template class SolutionPredictor<BlockVector<double>>;
+  template class SolutionPredictor<PETScWrappers::MPI::BlockVector>;
+  template class SteadyStateMonitor<Vector<double>>;
+  template class SteadyStateMonitor<BlockVector<double>>;
+  template class SteadyStateMonitor<PETScWrappers::MPI::Vector>;
+  template class SteadyStateMonitor<PETScWrappers::MPI::BlockVector>;
 } // namespace Utils
@@ -71,7 +71,8 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
 
       std::string infile("parameters.prm");
       if (argc > 1)
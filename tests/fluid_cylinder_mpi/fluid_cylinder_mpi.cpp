@@ -60,7 +60,8 @@ int main(int argc, char *argv[])
 {
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
 
       std::string infile("parameters.prm");
       if (argc > 1)
@@ -76,6 +77,7 @@ int main(int argc, char *argv[])
           auto ptr = std::make_shared<BoundaryValues<2>>(BoundaryValues<2>());
           Fluid::MPI::InsIM<2> flow(tria, params, ptr);
           flow.run();
+#ifndef OPENIFEM_BENCHMARK
           // Check the max values of velocity and pressure
           auto solution = flow.get_current_solution();
           auto v = solution.block(0), p = solution.block(1);
@@ -85,6 +87,7 @@ int main(int argc, char *argv[])
           double perror = std::abs(pmax - 46.5226) / 46.5226;
           AssertThrow(verror < 1e-3 && perror < 1e-3,
                       ExcMessage("Maximum velocity or pressure is incorrect!"));
+#endif
         }
       else if (params.dimension == 3)
         {
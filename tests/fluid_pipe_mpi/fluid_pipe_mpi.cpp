@@ -21,49 +21,70 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
 
       std::string infile("parameters.prm");
       if (argc > 1)
         {
           infile = argv[1];
         }
-      Parameters::AllParameters params(infile);
 
       double L = 2.0, D = 0.2, h = 0.04;
 
-      if (params.dimension == 2)
-        {
-          parallel::distributed::Triangulation<2> tria(MPI_COMM_WORLD);
-          dealii::GridGenerator::subdivided_hyper_rectangle(
-            tria,
-            {static_cast<unsigned int>(L / h),
-             static_cast<unsigned int>(D / (2 * h))},
-            Point<2>(0, 0),
-            Point<2>(L, D / 2),
-            true);
-          Fluid::MPI::InsIM<2> flow(tria, params);
-          flow.run();
-          auto solution = flow.get_current_solution();
-          // Assuming the mass is conserved and final velocity profile is
-          // parabolic,
-          // vmax should equal 1.5 times inlet velocity.
-          auto v = solution.block(0);
-          double vmax = v.max();
-          double verror = std::abs(vmax - 1.5) / 1.5;
-          AssertThrow(verror < 1e-2,
-                      ExcMessage("Maximum velocity is incorrect!"));
-        }
-      else if (params.dimension == 3)
+      auto run = [&](const Parameters::AllParameters &params,
+                     const MPI_Comm comm) {
+        if (params.dimension == 2)
+          {
+            parallel::distributed::Triangulation<2> tria(comm);
+            dealii::GridGenerator::subdivided_hyper_rectangle(
+              tria,
+              {static_cast<unsigned int>(L / h),
+               static_cast<unsigned int>(D / (2 * h))},
+              Point<2>(0, 0),
+              Point<2>(L, D / 2),
+              true);
+            Fluid::MPI::InsIM<2> flow(tria, params);
+            flow.run();
+            auto solution = flow.get_current_solution();
+            // Assuming the mass is conserved and final velocity profile is
+            // parabolic,
+            // vmax should equal 1.5 times inlet velocity.
+            auto v = solution.block(0);
+            double vmax = v.max();
+            double verror = std::abs(vmax - 1.5) / 1.5;
+            AssertThrow(verror < 1e-2,
+                        ExcMessage("Maximum velocity is incorrect!"));
+          }
+        else if (params.dimension == 3)
+          {
+            parallel::distributed::Triangulation<3> tria(comm);
+            Utils::GridCreator<3>::cylinder(tria, D / 2, L);
+            Fluid::MPI::InsIMEX<3> flow(tria, params);
+            flow.run();
+          }
+        else
+          {
+            AssertThrow(false, ExcNotImplemented());
+          }
+      };
+
+      // An optional case file sweeps the parameters, e.g. the viscosity,
+      // with the cases spread over the given number of groups of ranks.
+      if (argc > 2)
         {
-          parallel::distributed::Triangulation<3> tria(MPI_COMM_WORLD);
-          Utils::GridCreator<3>::cylinder(tria, D / 2, L);
-          Fluid::MPI::InsIMEX<3> flow(tria, params);
-          flow.run();
+          Utils::Ensemble ensemble(
+            argv[2], MPI_COMM_WORLD, argc > 3 ? std::stoi(argv[3]) : 1);
+          ensemble.run(infile,
+                       [&](const Parameters::AllParameters &params,
+                           const unsigned int) {
+                         run(params, ensemble.get_communicator());
+                       });
         }
       else
         {
-          AssertThrow(false, ExcNotImplemented());
+          Parameters::AllParameters params(infile);
+          run(params, MPI_COMM_WORLD);
         }
     }
   catch (std::exception &exc)
@@ -0,0 +1,141 @@
+/**
+ * This program tests the recovery of the parallel NavierStokes solver from
+ * the buddy checkpoints, with the BDF2 pipe flow of fluid_pipe_mpi_bdf2. The
+ * flow is run through to the end time in the reference directory. In the
+ * recovery directory it is run to the time of the first buddy checkpoint,
+ * without any checkpoint on disk, and then restarted from the buddy
+ * checkpoint up to the end time. Both runs must end with the same solution.
+ * On a single node no rank keeps a copy of another one, so the recovery of
+ * lost parts from their keepers is not tested.
+ */
+#include "mpi_insim.h"
+#include "parameters.h"
+#include "utilities.h"
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+
+namespace
+{
+  using namespace dealii;
+
+  const double L = 2.0, D = 0.2, h = 0.04;
+
+  // Run the pipe flow in the current directory, where it finds and saves
+  // its checkpoints, and return the number of dofs and the norms of the
+  // final velocity and pressure.
+  std::array<double, 3> run(const Parameters::AllParameters &params)
+  {
+    parallel::distributed::Triangulation<2> tria(MPI_COMM_WORLD);
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      tria,
+      {static_cast<unsigned int>(L / h),
+       static_cast<unsigned int>(D / (2 * h))},
+      Point<2>(0, 0),
+      Point<2>(L, D / 2),
+      true);
+    Fluid::MPI::InsIM<2> flow(tria, params);
+    flow.run();
+    auto solution = flow.get_current_solution();
+    return {{static_cast<double>(solution.size()),
+             solution.block(0).l2_norm(),
+             solution.block(1).l2_norm()}};
+  }
+
+  // Make an empty directory for a run and enter it on all the processes.
+  void enter(const fs::path &directory)
+  {
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+      {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+      }
+    MPI_Barrier(MPI_COMM_WORLD);
+    fs::current_path(directory);
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  using namespace dealii;
+
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(params.buddy_checkpoint_interval > 0 &&
+                    params.buddy_checkpoint_interval < params.end_time &&
+                    params.save_interval > params.end_time,
+                  ExcMessage("This test should only save buddy checkpoints, "
+                             "before the end time!"));
+      const fs::path start = fs::current_path();
+      const double end_time = params.end_time;
+
+      enter(start / "reference");
+      const std::array<double, 3> reference = run(params);
+
+      // The buddy checkpoint is saved at the last step of the first run.
+      enter(start / "recovery");
+      params.end_time = params.buddy_checkpoint_interval;
+      run(params);
+      // Every process keeps its part, named by the time step.
+      const std::string part =
+        params.buddy_checkpoint_directory + "/fluid.buddy." +
+        std::to_string(Utilities::MPI::this_mpi_process(MPI_COMM_WORLD)) +
+        "." +
+        std::to_string(
+          static_cast<int>(std::round(params.end_time / params.time_step)));
+      AssertThrow(fs::exists(part),
+                  ExcMessage("The buddy checkpoint is missing!"));
+
+      // The mesh is only refined if no checkpoint is loaded, which would
+      // then give another number of dofs.
+      params.end_time = end_time;
+      params.global_refinements[0] = 0;
+      const std::array<double, 3> recovered = run(params);
+      AssertThrow(recovered[0] == reference[0],
+                  ExcMessage("The buddy checkpoint was not loaded!"));
+      for (unsigned int i = 1; i < 3; ++i)
+        {
+          AssertThrow(std::abs(recovered[i] - reference[i]) <
+                        1e-4 * reference[i],
+                      ExcMessage("The recovered solution is incorrect!"));
+        }
+      fs::current_path(start);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
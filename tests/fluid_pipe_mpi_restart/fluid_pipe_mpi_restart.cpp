@@ -0,0 +1,141 @@
+/**
+ * This program tests restarting the parallel NavierStokes solver from a
+ * checkpoint on a different number of processes, with the BDF2 pipe flow of
+ * fluid_pipe_mpi_bdf2. The flow is run through to the end time on all the
+ * processes in the reference directory. In the restart directory it is run
+ * to half the end time on all the processes, which saves a checkpoint, and
+ * then restarted on the first process alone up to the end time. Both runs
+ * must end with the same solution.
+ */
+#include "mpi_insim.h"
+#include "parameters.h"
+#include "utilities.h"
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+
+namespace
+{
+  using namespace dealii;
+
+  const double L = 2.0, D = 0.2, h = 0.04;
+
+  // Run the pipe flow on the processes of the communicator in the current
+  // directory, where it finds and saves its checkpoints, and return the
+  // number of dofs and the norms of the final velocity and pressure.
+  std::array<double, 3> run(const MPI_Comm &communicator,
+                            const Parameters::AllParameters &params)
+  {
+    parallel::distributed::Triangulation<2> tria(communicator);
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      tria,
+      {static_cast<unsigned int>(L / h),
+       static_cast<unsigned int>(D / (2 * h))},
+      Point<2>(0, 0),
+      Point<2>(L, D / 2),
+      true);
+    Fluid::MPI::InsIM<2> flow(tria, params);
+    flow.run();
+    auto solution = flow.get_current_solution();
+    return {{static_cast<double>(solution.size()),
+             solution.block(0).l2_norm(),
+             solution.block(1).l2_norm()}};
+  }
+
+  // Make an empty directory for a run and enter it on all the processes.
+  void enter(const fs::path &directory)
+  {
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+      {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+      }
+    MPI_Barrier(MPI_COMM_WORLD);
+    fs::current_path(directory);
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  using namespace dealii;
+
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) > 1,
+                  ExcMessage("This test should be run on several processes!"));
+      const fs::path start = fs::current_path();
+      const double end_time = params.end_time;
+
+      enter(start / "reference");
+      const std::array<double, 3> reference = run(MPI_COMM_WORLD, params);
+
+      // The checkpoint is saved at the last step of the first run.
+      enter(start / "restart");
+      params.end_time = end_time / 2;
+      params.save_interval = end_time / 2;
+      run(MPI_COMM_WORLD, params);
+
+      const unsigned int this_process =
+        Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+      MPI_Comm first_process;
+      MPI_Comm_split(MPI_COMM_WORLD,
+                     this_process == 0 ? 0 : MPI_UNDEFINED,
+                     0,
+                     &first_process);
+      if (this_process == 0)
+        {
+          // The mesh is only refined if no checkpoint is loaded, which would
+          // then give another number of dofs.
+          params.end_time = end_time;
+          params.global_refinements[0] = 0;
+          const std::array<double, 3> restarted = run(first_process, params);
+          AssertThrow(restarted[0] == reference[0],
+                      ExcMessage("The checkpoint was not loaded!"));
+          for (unsigned int i = 1; i < 3; ++i)
+            {
+              AssertThrow(std::abs(restarted[i] - reference[i]) <
+                            1e-4 * reference[i],
+                          ExcMessage("The restarted solution is incorrect!"));
+            }
+          MPI_Comm_free(&first_process);
+        }
+      fs::current_path(start);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -18,7 +18,8 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
 
       std::string infile("parameters.prm");
       if (argc > 1)
@@ -26,6 +27,8 @@ int main(int argc, char *argv[])
           infile = argv[1];
         }
       Parameters::AllParameters params(infile);
+      MPI_Comm solid_communicator =
+        Utils::group_communicator(MPI_COMM_WORLD, params.solid_group_size);
 
       if (params.dimension == 3)
         {
@@ -58,7 +61,7 @@ int main(int argc, char *argv[])
 
           Fluid::MPI::SCnsIM<3> fluid(tria_fluid, params);
           Solid::MPI::SharedHypoElasticity<3> solid(
-            tria_solid, params, 0.05, 1.3);
+            tria_solid, params, 0.05, 1.3, solid_communicator);
           MPI::FSI<3> fsi(fluid, solid, params);
           fsi.run();
         }
@@ -66,6 +69,7 @@ int main(int argc, char *argv[])
         {
           AssertThrow(false, ExcNotImplemented());
         }
+      MPI_Comm_free(&solid_communicator);
     }
   catch (std::exception &exc)
     {
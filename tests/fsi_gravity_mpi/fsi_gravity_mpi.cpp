@@ -18,13 +18,16 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
       std::string infile("parameters.prm");
       if (argc > 1)
         {
           infile = argv[1];
         }
       Parameters::AllParameters params(infile);
+      MPI_Comm solid_communicator =
+        Utils::group_communicator(MPI_COMM_WORLD, params.solid_group_size);
 
       double L = 1, W = 2, H = 5, R = 0.125, h = 0.25;
 
@@ -53,7 +56,8 @@ int main(int argc, char *argv[])
           Triangulation<2> solid_tria;
           Point<2> center(L, -L);
           Utils::GridCreator<2>::sphere(solid_tria, center, R);
-          Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params);
+          Solid::MPI::SharedHyperElasticity<2> solid(
+            solid_tria, params, solid_communicator);
 
           MPI::FSI<2> fsi(fluid, solid, params, true);
           fsi.run();
@@ -74,11 +78,13 @@ int main(int argc, char *argv[])
           Triangulation<3> solid_tria;
           Point<3> center(L, L, -L);
           Utils::GridCreator<3>::sphere(solid_tria, center, R);
-          Solid::MPI::SharedHyperElasticity<3> solid(solid_tria, params);
+          Solid::MPI::SharedHyperElasticity<3> solid(
+            solid_tria, params, solid_communicator);
 
           MPI::FSI<3> fsi(fluid, solid, params, true);
           fsi.run();
         }
+      MPI_Comm_free(&solid_communicator);
     }
   catch (std::exception &exc)
     {
@@ -63,13 +63,16 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
       std::string infile("parameters.prm");
       if (argc > 1)
         {
           infile = argv[1];
         }
       Parameters::AllParameters params(infile);
+      MPI_Comm solid_communicator =
+        Utils::group_communicator(MPI_COMM_WORLD, params.solid_group_size);
 
       if (params.dimension == 2)
         {
@@ -104,7 +107,8 @@ int main(int argc, char *argv[])
             Point<2>(L / 4, 0),
             Point<2>(a + L / 4, b),
             true);
-          Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params);
+          Solid::MPI::SharedHyperElasticity<2> solid(
+            solid_tria, params, solid_communicator);
 
           MPI::FSI<2> fsi(fluid, solid, params, true);
           fsi.run();
@@ -132,11 +136,13 @@ int main(int argc, char *argv[])
             Point<3>(0, (H - a) / 2, L / 4),
             Point<3>(b, (H + a) / 2, a + L / 4),
             true);
-          Solid::MPI::SharedHyperElasticity<3> solid(solid_tria, params);
+          Solid::MPI::SharedHyperElasticity<3> solid(
+            solid_tria, params, solid_communicator);
 
           MPI::FSI<3> fsi(fluid, solid, params, true);
           fsi.run();
         }
+      MPI_Comm_free(&solid_communicator);
     }
   catch (std::exception &exc)
     {
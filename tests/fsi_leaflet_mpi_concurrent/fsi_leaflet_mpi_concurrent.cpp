@@ -0,0 +1,208 @@
+/**
+ * This program tests solving the solid and the fluid at the same time with
+ * the 2D leaflet case of fsi_leaflet_mpi. The first process solves the solid
+ * while the others solve the fluid, and the two groups exchange the interface
+ * data every time step. The case is also run with the solid and the fluid
+ * solved one after the other on all the processes. The concurrent fluid is
+ * coupled to the predicted solid instead of the new one, so the two runs
+ * only agree up to the coupling error.
+ */
+#include "mpi_concurrent_fsi.h"
+#include "mpi_fsi.h"
+#include "mpi_scnsim.h"
+#include "mpi_shared_hyper_elasticity.h"
+
+extern template class Fluid::MPI::SCnsIM<2>;
+extern template class Fluid::MPI::SCnsIM<3>;
+extern template class Solid::MPI::SharedHyperElasticity<2>;
+extern template class Solid::MPI::SharedHyperElasticity<3>;
+extern template class MPI::FSI<2>;
+extern template class MPI::FSI<3>;
+extern template class MPI::ConcurrentFSI<2>;
+extern template class MPI::ConcurrentFSI<3>;
+
+namespace
+{
+  using namespace dealii;
+
+  const double L = 4, H = 1, a = 0.1, b = 0.4, h = 0.05, U = 1.5;
+
+  class BoundaryValues : public Function<2>
+  {
+  public:
+    BoundaryValues() : Function<2>(3) {}
+    virtual double value(const Point<2> &p,
+                         const unsigned int component) const
+    {
+      if (component == 0 && std::abs(p[0]) < 1e-10 && std::abs(p[1]) > 1e-10)
+        {
+          return U;
+        }
+      return 0;
+    }
+    virtual void vector_value(const Point<2> &p, Vector<double> &values) const
+    {
+      for (unsigned int c = 0; c < this->n_components; ++c)
+        values(c) = value(p, c);
+    }
+  };
+
+  void make_fluid_mesh(parallel::distributed::Triangulation<2> &fluid_tria)
+  {
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      fluid_tria,
+      {static_cast<unsigned int>(L / h), static_cast<unsigned int>(H / h)},
+      Point<2>(0, 0),
+      Point<2>(L, H),
+      true);
+    // Refine the middle part
+    for (auto cell : fluid_tria.active_cell_iterators())
+      {
+        auto center = cell->center();
+        if (center[0] >= L / 4 - 2 * a && center[0] <= L / 4 + 3 * a &&
+            cell->is_locally_owned())
+          {
+            cell->set_refine_flag();
+          }
+      }
+    fluid_tria.execute_coarsening_and_refinement();
+  }
+
+  void make_solid_mesh(Triangulation<2> &solid_tria)
+  {
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      solid_tria,
+      {static_cast<unsigned int>(a / h), static_cast<unsigned int>(b / h)},
+      Point<2>(L / 4, 0),
+      Point<2>(a + L / 4, b),
+      true);
+  }
+
+  // Run the leaflet case with the solid and the fluid on all the processes,
+  // and return the norms of the final solid displacement and fluid velocity.
+  std::array<double, 2> run_sequential(const Parameters::AllParameters &params)
+  {
+    parallel::distributed::Triangulation<2> fluid_tria(MPI_COMM_WORLD);
+    make_fluid_mesh(fluid_tria);
+    Fluid::MPI::SCnsIM<2> fluid(
+      fluid_tria, params, std::make_shared<BoundaryValues>());
+    Triangulation<2> solid_tria;
+    make_solid_mesh(solid_tria);
+    Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params);
+
+    MPI::FSI<2> fsi(fluid, solid, params, true);
+    fsi.run();
+    return {{solid.get_current_solution().l2_norm(),
+             fluid.get_current_solution().block(0).l2_norm()}};
+  }
+
+  // Run the leaflet case with the solid and the fluid on disjoint processes,
+  // and return the same norms on all the processes.
+  std::array<double, 2> run_concurrent(const Parameters::AllParameters &params)
+  {
+    MPI_Comm group = Utils::split_communicator(
+      MPI_COMM_WORLD, params.concurrent_solid_processes);
+    std::array<double, 2> norms{{0, 0}};
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) <
+        params.concurrent_solid_processes)
+      {
+        Triangulation<2> solid_tria;
+        make_solid_mesh(solid_tria);
+        Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params, group);
+        MPI::ConcurrentFSI<2> fsi(nullptr, &solid, params, true);
+        fsi.run();
+        norms[0] = solid.get_current_solution().l2_norm();
+      }
+    else
+      {
+        parallel::distributed::Triangulation<2> fluid_tria(group);
+        make_fluid_mesh(fluid_tria);
+        Fluid::MPI::SCnsIM<2> fluid(
+          fluid_tria, params, std::make_shared<BoundaryValues>());
+        MPI::ConcurrentFSI<2> fsi(&fluid, nullptr, params, true);
+        fsi.run();
+        norms[1] = fluid.get_current_solution().block(0).l2_norm();
+      }
+    MPI_Comm_free(&group);
+    return {{Utilities::MPI::max(norms[0], MPI_COMM_WORLD),
+             Utilities::MPI::max(norms[1], MPI_COMM_WORLD)}};
+  }
+
+  // Make an empty directory for a run and enter it on all the processes.
+  void enter(const fs::path &directory)
+  {
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+      {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+      }
+    MPI_Barrier(MPI_COMM_WORLD);
+    fs::current_path(directory);
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  using namespace dealii;
+
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) > 1,
+                  ExcMessage("This test should be run on several processes!"));
+      const fs::path start = fs::current_path();
+
+      enter(start / "concurrent");
+      const std::array<double, 2> concurrent = run_concurrent(params);
+      AssertThrow(concurrent[0] > 0,
+                  ExcMessage("The fluid does not load the solid!"));
+
+      enter(start / "sequential");
+      const std::array<double, 2> sequential = run_sequential(params);
+      // The fluid is dominated by the inflow, while the small deflection of
+      // the leaflet is affected by the error of the predicted solid.
+      AssertThrow(std::abs(concurrent[0] - sequential[0]) <
+                    0.2 * sequential[0],
+                  ExcMessage("The concurrent solid is incorrect!"));
+      AssertThrow(std::abs(concurrent[1] - sequential[1]) <
+                    1e-2 * sequential[1],
+                  ExcMessage("The concurrent fluid is incorrect!"));
+      fs::current_path(start);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * This program tests coupling a distributed solid with the 2D leaflet case of
+ * fsi_leaflet_mpi, where the leaflet is a parallel::distributed mesh solved
+ * by the distributed linear elastic solver. The case is run on all the
+ * processes, so the interface points fall into the cells of other processes,
+ * and on the first process alone. Both runs must deflect the leaflet and end
+ * with the same solutions.
+ */
+#include "mpi_distributed_fsi.h"
+#include "mpi_linear_elasticity.h"
+#include "mpi_scnsim.h"
+
+extern template class Fluid::MPI::SCnsIM<2>;
+extern template class Fluid::MPI::SCnsIM<3>;
+extern template class Solid::MPI::LinearElasticity<2>;
+extern template class Solid::MPI::LinearElasticity<3>;
+extern template class MPI::DistributedFSI<2>;
+extern template class MPI::DistributedFSI<3>;
+
+namespace
+{
+  using namespace dealii;
+
+  const double L = 4, H = 1, a = 0.1, b = 0.4, h = 0.05, U = 1.5;
+
+  class BoundaryValues : public Function<2>
+  {
+  public:
+    BoundaryValues() : Function<2>(3) {}
+    virtual double value(const Point<2> &p,
+                         const unsigned int component) const
+    {
+      if (component == 0 && std::abs(p[0]) < 1e-10 && std::abs(p[1]) > 1e-10)
+        {
+          return U;
+        }
+      return 0;
+    }
+    virtual void vector_value(const Point<2> &p, Vector<double> &values) const
+    {
+      for (unsigned int c = 0; c < this->n_components; ++c)
+        values(c) = value(p, c);
+    }
+  };
+
+  // Run the leaflet case on the processes of the communicator in the current
+  // directory, and return the norms of the final solid displacement, fluid
+  // velocity and fluid pressure.
+  std::array<double, 3> run(const MPI_Comm &communicator,
+                            const Parameters::AllParameters &params)
+  {
+    parallel::distributed::Triangulation<2> fluid_tria(communicator);
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      fluid_tria,
+      {static_cast<unsigned int>(L / h), static_cast<unsigned int>(H / h)},
+      Point<2>(0, 0),
+      Point<2>(L, H),
+      true);
+    // Refine the middle part
+    for (auto cell : fluid_tria.active_cell_iterators())
+      {
+        auto center = cell->center();
+        if (center[0] >= L / 4 - 2 * a && center[0] <= L / 4 + 3 * a &&
+            cell->is_locally_owned())
+          {
+            cell->set_refine_flag();
+          }
+      }
+    fluid_tria.execute_coarsening_and_refinement();
+    Fluid::MPI::SCnsIM<2> fluid(
+      fluid_tria, params, std::make_shared<BoundaryValues>());
+
+    parallel::distributed::Triangulation<2> solid_tria(communicator);
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      solid_tria,
+      {static_cast<unsigned int>(a / h), static_cast<unsigned int>(b / h)},
+      Point<2>(L / 4, 0),
+      Point<2>(a + L / 4, b),
+      true);
+    Solid::MPI::LinearElasticity<2> solid(solid_tria, params);
+
+    MPI::DistributedFSI<2> fsi(fluid, solid, params, true);
+    fsi.run();
+    auto solution = fluid.get_current_solution();
+    return {{solid.get_current_solution().l2_norm(),
+             solution.block(0).l2_norm(),
+             solution.block(1).l2_norm()}};
+  }
+
+  // Make an empty directory for a run and enter it on all the processes.
+  void enter(const fs::path &directory)
+  {
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+      {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+      }
+    MPI_Barrier(MPI_COMM_WORLD);
+    fs::current_path(directory);
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  using namespace dealii;
+
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) > 1,
+                  ExcMessage("This test should be run on several processes!"));
+      const fs::path start = fs::current_path();
+
+      enter(start / "distributed");
+      const std::array<double, 3> distributed = run(MPI_COMM_WORLD, params);
+      AssertThrow(distributed[0] > 0,
+                  ExcMessage("The fluid does not load the solid!"));
+
+      const unsigned int this_process =
+        Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+      MPI_Comm first_process;
+      MPI_Comm_split(MPI_COMM_WORLD,
+                     this_process == 0 ? 0 : MPI_UNDEFINED,
+                     0,
+                     &first_process);
+      enter(start / "serial");
+      if (this_process == 0)
+        {
+          // The partitions only change the preconditioners of the solids
+          // and fluids, so the solutions agree up to the solver tolerances.
+          const std::array<double, 3> serial = run(first_process, params);
+          for (unsigned int i = 0; i < 3; ++i)
+            {
+              AssertThrow(std::abs(serial[i] - distributed[i]) <
+                            1e-3 * serial[i],
+                          ExcMessage("The distributed solution is incorrect!"));
+            }
+          MPI_Comm_free(&first_process);
+        }
+      fs::current_path(start);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
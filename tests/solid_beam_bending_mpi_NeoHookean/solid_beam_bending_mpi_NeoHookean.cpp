@@ -16,7 +16,8 @@ int main(int argc, char *argv[])
 
   try
     {
-      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, Utils::extract_n_threads(argc, argv));
 
       std::string infile("parameters.prm");
       if (argc > 1)
@@ -56,6 +57,7 @@ int main(int argc, char *argv[])
         {
           AssertThrow(false, ExcNotImplemented());
         }
+#ifndef OPENIFEM_BENCHMARK
       double umin = u.min(), umax = u.max();
       double umin_expected = (params.dimension == 2 ? -0.0616287 : -0.0617214);
       double umax_expected = (params.dimension == 2 ? 0.00867069 : 0.00867507);
@@ -65,6 +67,7 @@ int main(int argc, char *argv[])
       uerror = std::abs((umax - umax_expected) / umax_expected);
       AssertThrow(uerror < 1e-3,
                   ExcMessage("Maximum displacemet is incorrect"));
+#endif
     }
   catch (std::exception &exc)
     {
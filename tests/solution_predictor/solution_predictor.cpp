@@ -0,0 +1,94 @@
+/**
+ * This program tests the extrapolation of the solution predictor with time
+ * step sizes that change from step to step. The recorded solutions are
+ * sampled from polynomials in time, which the predictor of the same order
+ * reproduces exactly at the end of the next step. The input file is not used.
+ */
+#include "utilities.h"
+
+extern template class Utils::SolutionPredictor<dealii::BlockVector<double>>;
+
+namespace
+{
+  using namespace dealii;
+
+  // A solution of two blocks whose entries are polynomials in time of the
+  // given degree.
+  BlockVector<double> sample(const double t, const unsigned int degree)
+  {
+    BlockVector<double> u(std::vector<types::global_dof_index>{2, 1});
+    u(0) = 1 + 2 * t;
+    u(1) = (degree > 1 ? 3 * t * t : 0) - t;
+    u(2) = -2 + (degree > 1 ? 0.5 * t * t : 4 * t);
+    return u;
+  }
+
+  // Record the samples at the given times, then compare the prediction of
+  // the given order with the sample at the next time.
+  void check(const unsigned int order,
+             const std::vector<double> &times,
+             const double next_time)
+  {
+    Utils::SolutionPredictor<BlockVector<double>> predictor(order);
+    BlockVector<double> guess = sample(0, order);
+    for (unsigned int i = 1; i < times.size(); ++i)
+      {
+        const double delta_t = times[i] - times[i - 1];
+        AssertThrow(predictor.predict(guess, delta_t) == (i > order + 1),
+                    ExcMessage("The history has the wrong length!"));
+        predictor.record(sample(times[i], order), delta_t);
+      }
+    AssertThrow(predictor.predict(guess, next_time - times.back()),
+                ExcMessage("The history should be long enough!"));
+    BlockVector<double> error = sample(next_time, order);
+    error -= guess;
+    AssertThrow(error.linfty_norm() < 1e-12,
+                ExcMessage("The prediction of order " +
+                           std::to_string(order) + " is incorrect!"));
+
+    // Clearing the history disables the prediction.
+    predictor.clear();
+    AssertThrow(!predictor.predict(guess, next_time - times.back()),
+                ExcMessage("The history should have been cleared!"));
+  }
+} // namespace
+
+int main()
+{
+  using namespace dealii;
+
+  try
+    {
+      // The step sizes are 0.1, 0.15 and 0.05, then 0.2, so that neither
+      // guess would be exact with a constant step size.
+      const std::vector<double> times{0, 0.1, 0.25, 0.3};
+      check(1, times, 0.5);
+      check(2, times, 0.5);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}